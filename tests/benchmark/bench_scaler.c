@@ -0,0 +1,232 @@
+/**
+ * bench_scaler.c - Throughput of the software scalers
+ *
+ * Scales a noisy frame at common handheld sizes and reports the average
+ * time per frame. Integer scalers are compared with a per-pixel loop and
+ * also reported in output megapixels per second. Numbers are only comparable on the same
+ * machine; run on the device for real budgets. Large integer scales are also
+ * run through the scaler pool, comparing single-threaded and banded frames
+ * as timed by the pool's own gate.
+ *
+ * Usage: ./tests/bench_scaler [frames]
+ */
+
+#include "../../workspace/all/common/scaler.h"
+#include "../../workspace/all/common/scaler_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct BenchSize {
+	const char* name;
+	uint32_t sw;
+	uint32_t sh;
+	uint32_t dw;
+	uint32_t dh;
+} BenchSize;
+
+static const BenchSize sizes[] = {
+    {"GBA aspect", 240, 160, 640, 426},
+    {"GB aspect", 160, 144, 533, 480},
+    {"SNES fullscreen", 256, 224, 640, 480},
+    {"PS1 fullscreen", 320, 240, 1024, 768},
+};
+
+typedef struct BenchInteger {
+	const char* name;
+	uint32_t sw;
+	uint32_t sh;
+	uint32_t xmul;
+	uint32_t ymul;
+	uint32_t bpp;
+} BenchInteger;
+
+static const BenchInteger integers[] = {
+    {"GB 3x", 160, 144, 3, 3, 2},     {"GBA 2x", 240, 160, 2, 2, 2},
+    {"GBA 4x", 240, 160, 4, 4, 2},    {"SNES 5x3", 256, 224, 5, 3, 2},
+    {"GB 5x 720p", 160, 144, 5, 5, 2}, {"GB 7x 1080p", 160, 144, 7, 7, 2},
+    {"GB 9x 4K", 160, 144, 9, 9, 2},   {"NES 2x 32bpp", 256, 240, 2, 2, 4},
+    {"GB 7x 32bpp", 160, 144, 7, 7, 4}, {"GB 12x 32bpp", 160, 144, 12, 12, 4},
+};
+
+static const BenchInteger banded[] = {
+    {"GBA 4x", 240, 160, 4, 4, 2},      {"NES 4x 1024w", 256, 240, 4, 4, 2},
+    {"PS1 3x 720p", 320, 240, 3, 3, 2}, {"SNES 5x 1280w", 256, 224, 5, 5, 2},
+    {"GB 7x 1080p", 160, 144, 7, 7, 2},
+};
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static AAScaler aa;
+
+static void run_aa(void* src, void* dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw,
+                   uint32_t dh, uint32_t dp) {
+	scaleAA_c16(&aa, src, sp, dst, dp);
+}
+
+/**
+ * Average milliseconds per frame.
+ */
+static double bench(scaler_t scaler, const BenchSize* size, uint16_t* src, uint16_t* dst,
+                    int frames) {
+	scaler(src, dst, size->sw, size->sh, 0, size->dw, size->dh, 0); // warm up
+	double start = now();
+	for (int i = 0; i < frames; i++)
+		scaler(src, dst, size->sw, size->sh, 0, size->dw, size->dh, 0);
+	return (now() - start) * 1000.0 / frames;
+}
+
+/**
+ * Nearest neighbor integer scale, one pixel at a time.
+ */
+static void naive_integer(const BenchInteger* c, const uint8_t* src, uint8_t* dst) {
+	uint32_t dp = c->sw * c->xmul * c->bpp;
+	for (uint32_t y = 0; y < c->sh * c->ymul; y++) {
+		const uint8_t* s = src + (y / c->ymul) * c->sw * c->bpp;
+		uint8_t* d = dst + y * dp;
+		for (uint32_t x = 0; x < c->sw * c->xmul; x++)
+			memcpy(d + x * c->bpp, s + (x / c->xmul) * c->bpp, c->bpp);
+	}
+}
+
+/**
+ * Average milliseconds per frame of scaler_n/c at the case's factors,
+ * or of naive_integer.
+ */
+static double bench_integer(const BenchInteger* c, uint8_t* src, uint8_t* dst, int naive,
+                            int frames) {
+	uint32_t dw = c->sw * c->xmul;
+	uint32_t dh = c->sh * c->ymul;
+	double start = 0;
+	for (int i = -1; i < frames; i++) { // first pass warms up
+		if (i == 0)
+			start = now();
+		if (naive)
+			naive_integer(c, src, dst);
+#ifdef HAS_NEON
+		else if (c->bpp == 2)
+			scaler_n16(c->xmul, c->ymul, src, dst, c->sw, c->sh, 0, dw, dh, 0);
+		else
+			scaler_n32(c->xmul, c->ymul, src, dst, c->sw, c->sh, 0, dw, dh, 0);
+#else
+		else if (c->bpp == 2)
+			scaler_c16(c->xmul, c->ymul, src, dst, c->sw, c->sh, 0, dw, dh, 0);
+		else
+			scaler_c32(c->xmul, c->ymul, src, dst, c->sw, c->sh, 0, dw, dh, 0);
+#endif
+	}
+	return (now() - start) * 1000.0 / frames;
+}
+
+/**
+ * Runs full gate measurements of a case through ScalerPool_scale and
+ * returns the average single-threaded and banded milliseconds per frame.
+ */
+static void bench_banded(const BenchInteger* c, uint8_t* src, uint8_t* dst, int frames,
+                         double* serial_ms, double* banded_ms) {
+	enum { MEASURE = SCALER_POOL_WARMUP_FRAMES + 2 * SCALER_POOL_SAMPLE_FRAMES };
+#ifdef HAS_NEON
+	scaler_t scaler = scaler_find_n16(c->xmul, c->ymul);
+#else
+	scaler_t scaler = scaler_find_c16(c->xmul, c->ymul);
+#endif
+	uint32_t dw = c->sw * c->xmul;
+	uint32_t dh = c->sh * c->ymul;
+	uint64_t serial_us = 0, banded_us = 0;
+	int runs = frames / MEASURE > 0 ? frames / MEASURE : 1;
+	for (int run = 0; run < runs; run++) {
+		ScalerPoolGate gate = {0};
+		for (int i = 0; i < MEASURE; i++)
+			ScalerPool_scale(&gate, scaler, c->ymul, src, dst, c->sw, c->sh, c->sw * 2, dw, dh,
+			                 dw * 2);
+		serial_us += gate.serial_us;
+		banded_us += gate.threaded_us;
+	}
+	*serial_ms = serial_us / 1000.0 / runs / SCALER_POOL_SAMPLE_FRAMES;
+	*banded_ms = banded_us / 1000.0 / runs / SCALER_POOL_SAMPLE_FRAMES;
+}
+
+int main(int argc, char* argv[]) {
+	int frames = argc > 1 ? atoi(argv[1]) : 300;
+	if (frames < 1)
+		frames = 1;
+
+	printf("%-16s %12s %12s\n", "size", "scaleAA", "sharp");
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		const BenchSize* size = &sizes[s];
+		uint16_t* src = malloc(size->sw * size->sh * sizeof(uint16_t));
+		uint16_t* dst = malloc(size->dw * size->dh * sizeof(uint16_t));
+		srand(1);
+		for (uint32_t i = 0; i < size->sw * size->sh; i++)
+			src[i] = (uint16_t)rand();
+
+		memset(&aa, 0, sizeof(aa));
+		scaleAA_init(&aa, size->sw, size->sh, size->dw, size->dh);
+		double aa_ms = bench(run_aa, size, src, dst, frames);
+		scaleAA_free(&aa);
+
+#ifdef HAS_NEON
+		double sharp_ms = bench(scaleSharpBilinear_n16, size, src, dst, frames);
+#else
+		double sharp_ms = bench(scaleSharpBilinear_c16, size, src, dst, frames);
+#endif
+		printf("%-16s %9.3f ms %9.3f ms\n", size->name, aa_ms, sharp_ms);
+
+		free(src);
+		free(dst);
+	}
+
+	printf("\n%-16s %12s %12s %12s\n", "integer", "per-pixel", "scaler", "Mpix/s");
+	for (size_t i = 0; i < sizeof(integers) / sizeof(integers[0]); i++) {
+		const BenchInteger* c = &integers[i];
+		size_t src_size = (size_t)c->sw * c->sh * c->bpp;
+		size_t dst_size = src_size * c->xmul * c->ymul;
+		uint8_t* src = malloc(src_size);
+		uint8_t* dst = malloc(dst_size);
+		srand(1);
+		for (size_t j = 0; j < src_size; j++)
+			src[j] = (uint8_t)rand();
+
+		double naive_ms = bench_integer(c, src, dst, 1, frames);
+		double scaler_ms = bench_integer(c, src, dst, 0, frames);
+		double mpix = (double)(dst_size / c->bpp) / (scaler_ms * 1000.0);
+		printf("%-16s %9.3f ms %9.3f ms %12.0f\n", c->name, naive_ms, scaler_ms, mpix);
+
+		free(src);
+		free(dst);
+	}
+
+	int threads = ScalerPool_threads();
+	if (threads < 2) {
+		printf("\nbanded: single core, skipped\n");
+		return 0;
+	}
+	char label[16];
+	snprintf(label, sizeof(label), "%i threads", threads);
+	printf("\n%-16s %12s %12s %12s\n", "banded", "1 thread", label, "speedup");
+	for (size_t i = 0; i < sizeof(banded) / sizeof(banded[0]); i++) {
+		const BenchInteger* c = &banded[i];
+		size_t src_size = (size_t)c->sw * c->sh * c->bpp;
+		uint8_t* src = malloc(src_size);
+		uint8_t* dst = malloc(src_size * c->xmul * c->ymul);
+		srand(1);
+		for (size_t j = 0; j < src_size; j++)
+			src[j] = (uint8_t)rand();
+
+		double serial_ms, banded_ms;
+		bench_banded(c, src, dst, frames, &serial_ms, &banded_ms);
+		printf("%-16s %9.3f ms %9.3f ms %11.2fx\n", c->name, serial_ms, banded_ms,
+		       serial_ms / banded_ms);
+
+		free(src);
+		free(dst);
+	}
+	ScalerPool_quit();
+	return 0;
+}
@@ -21,12 +21,13 @@ DEFINE_FAKE_VALUE_FUNC(int, SDL_PollEvent, SDL_Event*);
 ///////////////////////////////
 
 DEFINE_FAKE_VALUE_FUNC(int, TTF_SizeUTF8, TTF_Font*, const char*, int*, int*);
+DEFINE_FAKE_VALUE_FUNC(SDL_Surface*, TTF_RenderUTF8_Blended, TTF_Font*, const char*, SDL_Color);
 
 ///////////////////////////////
-// Surface Management Fake Definitions (future)
+// Surface Management Fake Definitions
 ///////////////////////////////
 
-// Will be added later if needed
+DEFINE_FAKE_VOID_FUNC(SDL_FreeSurface, SDL_Surface*);
 
 ///////////////////////////////
 // Audio Fake Definitions (future)
@@ -48,13 +48,26 @@ DECLARE_FAKE_VALUE_FUNC(int, SDL_PollEvent, SDL_Event*);
  */
 DECLARE_FAKE_VALUE_FUNC(int, TTF_SizeUTF8, TTF_Font*, const char*, int*, int*);
 
+/**
+ * Fake for TTF_RenderUTF8_Blended - Renders text to a new surface
+ *
+ * Usage:
+ *   TTF_RenderUTF8_Blended_fake.custom_fake = my_render_mock;
+ *   // Custom function can return a heap-allocated SDL_Surface
+ */
+DECLARE_FAKE_VALUE_FUNC(SDL_Surface*, TTF_RenderUTF8_Blended, TTF_Font*, const char*, SDL_Color);
+
 ///////////////////////////////
 // Surface Management Fakes (for future GFX testing)
 ///////////////////////////////
 
+/**
+ * Fake for SDL_FreeSurface - Used by the rendered text cache on eviction
+ */
+DECLARE_FAKE_VOID_FUNC(SDL_FreeSurface, SDL_Surface*);
+
 // Will be added later if needed:
 // DECLARE_FAKE_VALUE_FUNC(SDL_Surface*, SDL_CreateRGBSurface, ...);
-// DECLARE_FAKE_VOID_FUNC(SDL_FreeSurface, SDL_Surface*);
 
 ///////////////////////////////
 // Audio Fakes (for future SND testing)
@@ -59,6 +59,17 @@ typedef struct SDL_Surface {
 	int refcount;
 } SDL_Surface;
 
+///////////////////////////////
+// SDL_Color
+///////////////////////////////
+
+typedef struct SDL_Color {
+	Uint8 r;
+	Uint8 g;
+	Uint8 b;
+	Uint8 a;
+} SDL_Color;
+
 ///////////////////////////////
 // SDL_Rect
 ///////////////////////////////
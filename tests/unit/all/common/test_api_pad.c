@@ -8,6 +8,7 @@
  * Test coverage:
  * - PAD_reset() - Clearing all button states
  * - PAD_setAnalog() - Analog stick to digital button conversion
+ * - PAD_setButton() - Single button press and release
  * - PAD_anyJustPressed/anyPressed/anyJustReleased() - Query functions
  * - PAD_justPressed/isPressed/justReleased/justRepeated() - Button-specific queries
  * - PAD_tappedMenu() - Menu tap detection with timing
@@ -188,6 +189,45 @@ void test_PAD_setAnalog_release_with_multiple_buttons_repeated(void) {
 	TEST_ASSERT_TRUE(pad.just_repeated & BTN_SELECT);
 }
 
+///////////////////////////////
+// PAD_setButton tests
+///////////////////////////////
+
+void test_PAD_setButton_press_sets_pressed_and_just_pressed(void) {
+	PAD_setButton(BTN_ID_SELECT, 1, 500);
+
+	TEST_ASSERT_TRUE(pad.is_pressed & BTN_SELECT);
+	TEST_ASSERT_TRUE(pad.just_pressed & BTN_SELECT);
+	TEST_ASSERT_TRUE(pad.just_repeated & BTN_SELECT);
+	TEST_ASSERT_EQUAL_UINT32(500, pad.repeat_at[BTN_ID_SELECT]);
+}
+
+void test_PAD_setButton_holding_doesnt_trigger_just_pressed_again(void) {
+	pad.is_pressed = BTN_SELECT;
+
+	PAD_setButton(BTN_ID_SELECT, 1, 500);
+
+	TEST_ASSERT_FALSE(pad.just_pressed & BTN_SELECT);
+	TEST_ASSERT_EQUAL_UINT32(0, pad.repeat_at[BTN_ID_SELECT]);
+}
+
+void test_PAD_setButton_release_sets_just_released(void) {
+	pad.is_pressed = BTN_SELECT | BTN_A;
+	pad.just_repeated = BTN_SELECT;
+
+	PAD_setButton(BTN_ID_SELECT, 0, 0);
+
+	TEST_ASSERT_EQUAL_INT(BTN_A, pad.is_pressed);
+	TEST_ASSERT_FALSE(pad.just_repeated & BTN_SELECT);
+	TEST_ASSERT_TRUE(pad.just_released & BTN_SELECT);
+}
+
+void test_PAD_setButton_release_of_unpressed_button_does_nothing(void) {
+	PAD_setButton(BTN_ID_SELECT, 0, 0);
+
+	TEST_ASSERT_EQUAL_INT(BTN_NONE, pad.just_released);
+}
+
 ///////////////////////////////
 // PAD query function tests
 ///////////////////////////////
@@ -363,6 +403,12 @@ int main(void) {
 	RUN_TEST(test_PAD_setAnalog_release_clears_just_repeated);
 	RUN_TEST(test_PAD_setAnalog_release_with_multiple_buttons_repeated);
 
+	// PAD_setButton tests
+	RUN_TEST(test_PAD_setButton_press_sets_pressed_and_just_pressed);
+	RUN_TEST(test_PAD_setButton_holding_doesnt_trigger_just_pressed_again);
+	RUN_TEST(test_PAD_setButton_release_sets_just_released);
+	RUN_TEST(test_PAD_setButton_release_of_unpressed_button_does_nothing);
+
 	// PAD query function tests
 	RUN_TEST(test_PAD_anyJustPressed_returns_true_when_button_just_pressed);
 	RUN_TEST(test_PAD_anyJustPressed_returns_false_when_no_buttons_just_pressed);
@@ -0,0 +1,238 @@
+/**
+ * test_asset_cache.c - Tests for the scaled UI asset atlas cache
+ *
+ * Round-trips atlases through real files in a temp directory and verifies
+ * that entries built for a different source, scale or format are rejected.
+ *
+ * Test coverage:
+ * - AssetCache_hashFile - Content hashing
+ * - AssetCache_save/load - Round trip, alignment, private mapping
+ * - Invalidation on key, rect count and truncation
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/asset_cache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define RECT_COUNT 3
+
+static char temp_dir[] = "/tmp/assetcache_XXXXXX";
+static char cache_file[256];
+static char source_file[256];
+
+// 3x2 RGBA8888 atlas with one pixel of row padding
+static uint32_t pixels[4 * 2];
+static const AssetCacheRect rects[RECT_COUNT] = {{0, 0, 1, 1}, {1, 0, 2, 1}, {0, 1, 3, 1}};
+
+static void write_file(const char* path, const char* contents) {
+	FILE* file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs(contents, file);
+	fclose(file);
+}
+
+static AssetCacheKey make_key(void) {
+	AssetCacheKey key;
+	memset(&key, 0, sizeof(key));
+	key.source_hash = 0x0123456789ABCDEFULL;
+	key.dp_scale = 2.5f;
+	key.asset_scale = 4;
+	key.pill_px = 75;
+	key.button_px = 50;
+	key.option_px = 55;
+	key.bpp = 32;
+	key.rmask = 0x00FF0000;
+	key.gmask = 0x0000FF00;
+	key.bmask = 0x000000FF;
+	key.amask = 0xFF000000;
+	return key;
+}
+
+static int save(const AssetCacheKey* key) {
+	return AssetCache_save(cache_file, key, rects, RECT_COUNT, pixels, 3, 2, 16);
+}
+
+void setUp(void) {
+	strcpy(temp_dir, "/tmp/assetcache_XXXXXX");
+	TEST_ASSERT_NOT_NULL(mkdtemp(temp_dir));
+	snprintf(cache_file, sizeof(cache_file), "%s/assets-640x480.cache", temp_dir);
+	snprintf(source_file, sizeof(source_file), "%s/assets@4x.png", temp_dir);
+	for (int i = 0; i < 8; i++)
+		pixels[i] = 0x01020304u * (uint32_t)(i + 1);
+}
+
+void tearDown(void) {
+	unlink(cache_file);
+	unlink(source_file);
+	rmdir(temp_dir);
+}
+
+///////////////////////////////
+// Hash Tests
+///////////////////////////////
+
+void test_AssetCache_hashFile_depends_on_contents(void) {
+	write_file(source_file, "PNG one");
+	uint64_t a = AssetCache_hashFile(source_file);
+	uint64_t b = AssetCache_hashFile(source_file);
+	write_file(source_file, "PNG two");
+	uint64_t c = AssetCache_hashFile(source_file);
+
+	TEST_ASSERT_TRUE(a != 0);
+	TEST_ASSERT_TRUE(a == b);
+	TEST_ASSERT_TRUE(a != c);
+}
+
+void test_AssetCache_hashFile_missing_file_is_zero(void) {
+	TEST_ASSERT_TRUE(AssetCache_hashFile(source_file) == 0);
+}
+
+///////////////////////////////
+// Round Trip Tests
+///////////////////////////////
+
+void test_AssetCache_round_trip(void) {
+	AssetCacheKey key = make_key();
+	TEST_ASSERT_TRUE(save(&key));
+
+	AssetCache* cache = AssetCache_load(cache_file, &key, RECT_COUNT);
+	TEST_ASSERT_NOT_NULL(cache);
+	TEST_ASSERT_EQUAL_INT(3, cache->w);
+	TEST_ASSERT_EQUAL_INT(2, cache->h);
+	TEST_ASSERT_EQUAL_INT(16, cache->pitch);
+	TEST_ASSERT_EQUAL_MEMORY(rects, cache->rects, sizeof(rects));
+	TEST_ASSERT_EQUAL_MEMORY(pixels, cache->pixels, sizeof(pixels));
+	AssetCache_free(cache);
+}
+
+void test_AssetCache_pixels_are_aligned(void) {
+	AssetCacheKey key = make_key();
+	save(&key);
+
+	AssetCache* cache = AssetCache_load(cache_file, &key, RECT_COUNT);
+	TEST_ASSERT_NOT_NULL(cache);
+	TEST_ASSERT_EQUAL_INT(0, (int)((uintptr_t)cache->pixels % 16));
+	AssetCache_free(cache);
+}
+
+void test_AssetCache_writes_to_pixels_stay_private(void) {
+	AssetCacheKey key = make_key();
+	save(&key);
+
+	AssetCache* cache = AssetCache_load(cache_file, &key, RECT_COUNT);
+	TEST_ASSERT_NOT_NULL(cache);
+	((uint32_t*)cache->pixels)[0] = 0xDEADBEEF;
+	AssetCache_free(cache);
+
+	cache = AssetCache_load(cache_file, &key, RECT_COUNT);
+	TEST_ASSERT_NOT_NULL(cache);
+	TEST_ASSERT_EQUAL_HEX32(pixels[0], ((uint32_t*)cache->pixels)[0]);
+	AssetCache_free(cache);
+}
+
+void test_AssetCache_save_leaves_no_temp_file(void) {
+	AssetCacheKey key = make_key();
+	save(&key);
+
+	int entries = 0;
+	DIR* dir = opendir(temp_dir);
+	TEST_ASSERT_NOT_NULL(dir);
+	struct dirent* entry;
+	while ((entry = readdir(dir)))
+		if (entry->d_name[0] != '.')
+			entries += 1;
+	closedir(dir);
+	TEST_ASSERT_EQUAL_INT(1, entries);
+}
+
+///////////////////////////////
+// Invalidation Tests
+///////////////////////////////
+
+void test_AssetCache_missing_file_misses(void) {
+	AssetCacheKey key = make_key();
+	TEST_ASSERT_NULL(AssetCache_load(cache_file, &key, RECT_COUNT));
+}
+
+void test_AssetCache_changed_source_misses(void) {
+	AssetCacheKey key = make_key();
+	save(&key);
+
+	key.source_hash ^= 1;
+	TEST_ASSERT_NULL(AssetCache_load(cache_file, &key, RECT_COUNT));
+}
+
+void test_AssetCache_changed_scale_misses(void) {
+	AssetCacheKey key = make_key();
+	save(&key);
+
+	key.dp_scale = 2.25f;
+	TEST_ASSERT_NULL(AssetCache_load(cache_file, &key, RECT_COUNT));
+
+	key = make_key();
+	key.pill_px += 1;
+	TEST_ASSERT_NULL(AssetCache_load(cache_file, &key, RECT_COUNT));
+}
+
+void test_AssetCache_changed_format_misses(void) {
+	AssetCacheKey key = make_key();
+	save(&key);
+
+	key.rmask = 0x000000FF;
+	key.bmask = 0x00FF0000;
+	TEST_ASSERT_NULL(AssetCache_load(cache_file, &key, RECT_COUNT));
+}
+
+void test_AssetCache_changed_rect_count_misses(void) {
+	AssetCacheKey key = make_key();
+	save(&key);
+
+	TEST_ASSERT_NULL(AssetCache_load(cache_file, &key, RECT_COUNT + 1));
+}
+
+void test_AssetCache_truncated_file_misses(void) {
+	AssetCacheKey key = make_key();
+	save(&key);
+	TEST_ASSERT_EQUAL_INT(0, truncate(cache_file, 100));
+
+	TEST_ASSERT_NULL(AssetCache_load(cache_file, &key, RECT_COUNT));
+}
+
+void test_AssetCache_free_null_is_safe(void) {
+	AssetCache_free(NULL);
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Hash
+	RUN_TEST(test_AssetCache_hashFile_depends_on_contents);
+	RUN_TEST(test_AssetCache_hashFile_missing_file_is_zero);
+
+	// Round trip
+	RUN_TEST(test_AssetCache_round_trip);
+	RUN_TEST(test_AssetCache_pixels_are_aligned);
+	RUN_TEST(test_AssetCache_writes_to_pixels_stay_private);
+	RUN_TEST(test_AssetCache_save_leaves_no_temp_file);
+
+	// Invalidation
+	RUN_TEST(test_AssetCache_missing_file_misses);
+	RUN_TEST(test_AssetCache_changed_source_misses);
+	RUN_TEST(test_AssetCache_changed_scale_misses);
+	RUN_TEST(test_AssetCache_changed_format_misses);
+	RUN_TEST(test_AssetCache_changed_rect_count_misses);
+	RUN_TEST(test_AssetCache_truncated_file_misses);
+	RUN_TEST(test_AssetCache_free_null_is_safe);
+
+	return UNITY_END();
+}
@@ -0,0 +1,380 @@
+/**
+ * test_battery.c - Tests for shared battery telemetry
+ *
+ * The filter is fed synthetic readings with explicit timestamps. The
+ * shared segment tests use a per-process shm name and a fake reader.
+ *
+ * Test coverage:
+ * - Battery_quantize - Bucket boundaries
+ * - BatteryFilter_update - Smoothing, outliers, charger changes, hysteresis
+ * - BatteryFilter_status - Time left estimate
+ * - BatteryFilter_interval - Adaptive sampling rate
+ * - Battery_open/update/get - Sampling only when due, history across opens
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/battery.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static char shm_name[64];
+
+static int read_calls;
+static int read_charging;
+static int read_percent;
+
+static void fake_read(int* is_charging, int* percent) {
+	read_calls += 1;
+	*is_charging = read_charging;
+	*percent = read_percent;
+}
+
+void setUp(void) {
+	snprintf(shm_name, sizeof(shm_name), "/battery_test_%d", (int)getpid());
+	shm_unlink(shm_name);
+	read_calls = 0;
+	read_charging = 0;
+	read_percent = 50;
+}
+
+void tearDown(void) {
+	Battery_close();
+	shm_unlink(shm_name);
+}
+
+/**
+ * Feeds a constant reading every 5 seconds for a while.
+ */
+static uint64_t feed(BatteryFilter* filter, int is_charging, int percent, uint64_t now,
+                     uint64_t duration) {
+	for (uint64_t end = now + duration; now < end;) {
+		now += 5000;
+		BatteryFilter_update(filter, is_charging, percent, now);
+	}
+	return now;
+}
+
+///////////////////////////////
+// Quantize Tests
+///////////////////////////////
+
+void test_Battery_quantize_matches_ui_buckets(void) {
+	TEST_ASSERT_EQUAL_INT(100, Battery_quantize(100));
+	TEST_ASSERT_EQUAL_INT(100, Battery_quantize(81));
+	TEST_ASSERT_EQUAL_INT(80, Battery_quantize(80));
+	TEST_ASSERT_EQUAL_INT(60, Battery_quantize(41));
+	TEST_ASSERT_EQUAL_INT(40, Battery_quantize(40));
+	TEST_ASSERT_EQUAL_INT(20, Battery_quantize(11));
+	TEST_ASSERT_EQUAL_INT(10, Battery_quantize(10));
+	TEST_ASSERT_EQUAL_INT(10, Battery_quantize(0));
+}
+
+///////////////////////////////
+// Filter Tests
+///////////////////////////////
+
+void test_BatteryFilter_first_sample_is_taken_as_is(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	BatteryFilter_update(&filter, 0, 73, 1000);
+	BatteryFilter_status(&filter, &status);
+
+	TEST_ASSERT_EQUAL_INT(0, status.is_charging);
+	TEST_ASSERT_EQUAL_INT(73, status.percent);
+	TEST_ASSERT_EQUAL_INT(80, status.level);
+	TEST_ASSERT_EQUAL_INT(-1, status.minutes);
+}
+
+void test_BatteryFilter_status_before_first_sample(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	BatteryFilter_status(&filter, &status);
+	TEST_ASSERT_EQUAL_INT(10, status.level);
+	TEST_ASSERT_EQUAL_INT(-1, status.minutes);
+}
+
+void test_BatteryFilter_clamps_readings(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	BatteryFilter_update(&filter, 0, 120, 1000);
+	BatteryFilter_status(&filter, &status);
+	TEST_ASSERT_EQUAL_INT(100, status.percent);
+}
+
+void test_BatteryFilter_smooths_small_changes(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	BatteryFilter_update(&filter, 0, 50, 0);
+	BatteryFilter_update(&filter, 0, 40, 5000);
+	BatteryFilter_status(&filter, &status);
+
+	TEST_ASSERT_TRUE(status.percent < 50);
+	TEST_ASSERT_TRUE(status.percent > 45);
+
+	// Converges after a few time constants
+	feed(&filter, 0, 40, 5000, 5 * BATTERY_SMOOTH_MS);
+	BatteryFilter_status(&filter, &status);
+	TEST_ASSERT_EQUAL_INT(40, status.percent);
+}
+
+void test_BatteryFilter_drops_single_outlier(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	BatteryFilter_update(&filter, 0, 70, 0);
+	BatteryFilter_update(&filter, 0, 5, 5000);
+	BatteryFilter_status(&filter, &status);
+	TEST_ASSERT_EQUAL_INT(70, status.percent);
+
+	BatteryFilter_update(&filter, 0, 70, 10000);
+	BatteryFilter_status(&filter, &status);
+	TEST_ASSERT_EQUAL_INT(70, status.percent);
+}
+
+void test_BatteryFilter_accepts_confirmed_jump(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	BatteryFilter_update(&filter, 0, 70, 0);
+	BatteryFilter_update(&filter, 0, 30, 5000);
+	BatteryFilter_update(&filter, 0, 30, 10000);
+	BatteryFilter_status(&filter, &status);
+
+	TEST_ASSERT_EQUAL_INT(30, status.percent);
+	TEST_ASSERT_EQUAL_INT(40, status.level);
+}
+
+void test_BatteryFilter_accepts_jump_after_long_gap(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	// e.g. waking up after a night asleep
+	BatteryFilter_update(&filter, 0, 70, 0);
+	BatteryFilter_update(&filter, 0, 30, 8 * 3600 * 1000ULL);
+	BatteryFilter_status(&filter, &status);
+
+	TEST_ASSERT_TRUE(status.percent < 32);
+}
+
+void test_BatteryFilter_charger_change_is_not_an_outlier(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	BatteryFilter_update(&filter, 0, 50, 0);
+	BatteryFilter_update(&filter, 1, 75, 5000);
+	BatteryFilter_status(&filter, &status);
+
+	TEST_ASSERT_EQUAL_INT(1, status.is_charging);
+	TEST_ASSERT_TRUE(status.percent > 50);
+}
+
+void test_BatteryFilter_level_has_hysteresis(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	uint64_t now = 0;
+	BatteryFilter_update(&filter, 0, 80, now);
+	TEST_ASSERT_EQUAL_INT(80, filter.level);
+
+	// Hovering just over the boundary keeps the level
+	now = feed(&filter, 0, 81, now, 5 * BATTERY_SMOOTH_MS);
+	BatteryFilter_status(&filter, &status);
+	TEST_ASSERT_EQUAL_INT(81, status.percent);
+	TEST_ASSERT_EQUAL_INT(80, status.level);
+
+	// Clearly past it moves
+	now = feed(&filter, 0, 84, now, 5 * BATTERY_SMOOTH_MS);
+	TEST_ASSERT_EQUAL_INT(100, filter.level);
+
+	// And coming back just under doesn't move it back
+	now = feed(&filter, 0, 80, now, 5 * BATTERY_SMOOTH_MS);
+	TEST_ASSERT_EQUAL_INT(100, filter.level);
+
+	feed(&filter, 0, 77, now, 5 * BATTERY_SMOOTH_MS);
+	TEST_ASSERT_EQUAL_INT(80, filter.level);
+}
+
+void test_BatteryFilter_estimates_time_to_empty(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	// 10% an hour for an hour, one reading every 5 seconds
+	uint64_t now = 0;
+	for (int i = 0; i <= 720; i++, now += 5000)
+		BatteryFilter_update(&filter, 0, 80 - i / 72, now);
+	BatteryFilter_status(&filter, &status);
+
+	// About 70% left at 10% an hour
+	TEST_ASSERT_INT_WITHIN(60, 420, status.minutes);
+}
+
+void test_BatteryFilter_estimates_time_to_full(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	// 30% an hour
+	uint64_t now = 0;
+	for (int i = 0; i <= 720; i++, now += 5000)
+		BatteryFilter_update(&filter, 1, 40 + i / 24, now);
+	BatteryFilter_status(&filter, &status);
+
+	// About 30% to go at 30% an hour
+	TEST_ASSERT_INT_WITHIN(20, 60, status.minutes);
+}
+
+void test_BatteryFilter_needs_history_for_estimate(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	uint64_t now = 0;
+	for (int i = 0; i <= 720; i++, now += 5000)
+		BatteryFilter_update(&filter, 0, 80 - i / 72, now);
+
+	// Plugging in starts a new trend
+	BatteryFilter_update(&filter, 1, 70, now);
+	BatteryFilter_status(&filter, &status);
+	TEST_ASSERT_EQUAL_INT(-1, status.minutes);
+}
+
+void test_BatteryFilter_steady_charge_has_no_estimate(void) {
+	BatteryFilter filter = {0};
+	BatteryStatus status;
+
+	feed(&filter, 0, 60, 0, BATTERY_TREND_MS * 2);
+	BatteryFilter_status(&filter, &status);
+	TEST_ASSERT_EQUAL_INT(-1, status.minutes);
+}
+
+///////////////////////////////
+// Interval Tests
+///////////////////////////////
+
+void test_BatteryFilter_interval_adapts(void) {
+	BatteryFilter filter = {0};
+	TEST_ASSERT_EQUAL_INT(BATTERY_INTERVAL_FAST, BatteryFilter_interval(&filter, 0));
+
+	BatteryFilter_update(&filter, 0, 70, 0);
+	TEST_ASSERT_EQUAL_INT(BATTERY_INTERVAL_MENU, BatteryFilter_interval(&filter, 0));
+	TEST_ASSERT_EQUAL_INT(BATTERY_INTERVAL_GAME, BatteryFilter_interval(&filter, 1));
+
+	BatteryFilter_update(&filter, 1, 70, 5000);
+	TEST_ASSERT_EQUAL_INT(BATTERY_INTERVAL_FAST, BatteryFilter_interval(&filter, 1));
+
+	memset(&filter, 0, sizeof(filter));
+	BatteryFilter_update(&filter, 0, 15, 0);
+	TEST_ASSERT_EQUAL_INT(BATTERY_INTERVAL_FAST, BatteryFilter_interval(&filter, 1));
+}
+
+///////////////////////////////
+// Shared Segment Tests
+///////////////////////////////
+
+void test_Battery_open_creates_segment(void) {
+	TEST_ASSERT_EQUAL_INT(0, Battery_open(shm_name));
+
+	BatteryStatus status;
+	Battery_get(&status);
+	TEST_ASSERT_EQUAL_INT(10, status.level);
+	TEST_ASSERT_EQUAL_INT(0, Battery_untilDue(0));
+}
+
+void test_Battery_update_samples_only_when_due(void) {
+	Battery_open(shm_name);
+
+	TEST_ASSERT_EQUAL_INT(1, Battery_update(fake_read, 0, 0));
+	TEST_ASSERT_EQUAL_INT(1, read_calls);
+
+	TEST_ASSERT_EQUAL_INT(0, Battery_update(fake_read, 0, 0));
+	TEST_ASSERT_EQUAL_INT(1, read_calls);
+	TEST_ASSERT_TRUE(Battery_untilDue(0) > 0);
+	TEST_ASSERT_TRUE(Battery_untilDue(0) <= BATTERY_INTERVAL_MENU);
+	TEST_ASSERT_TRUE(Battery_untilDue(1) > BATTERY_INTERVAL_MENU);
+
+	TEST_ASSERT_EQUAL_INT(1, Battery_update(fake_read, 0, 1));
+	TEST_ASSERT_EQUAL_INT(2, read_calls);
+}
+
+void test_Battery_get_reads_published_status(void) {
+	Battery_open(shm_name);
+	read_charging = 1;
+	read_percent = 55;
+	Battery_update(fake_read, 0, 1);
+
+	BatteryStatus status;
+	Battery_get(&status);
+	TEST_ASSERT_EQUAL_INT(1, status.is_charging);
+	TEST_ASSERT_EQUAL_INT(55, status.percent);
+	TEST_ASSERT_EQUAL_INT(60, status.level);
+}
+
+void test_Battery_history_survives_reopen(void) {
+	Battery_open(shm_name);
+	read_percent = 90;
+	Battery_update(fake_read, 0, 1);
+	Battery_close();
+
+	// The next process sees the sample without reading the hardware
+	TEST_ASSERT_EQUAL_INT(0, Battery_open(shm_name));
+	TEST_ASSERT_EQUAL_INT(0, Battery_update(fake_read, 0, 0));
+	TEST_ASSERT_EQUAL_INT(1, read_calls);
+
+	BatteryStatus status;
+	Battery_get(&status);
+	TEST_ASSERT_EQUAL_INT(90, status.percent);
+	TEST_ASSERT_EQUAL_INT(100, status.level);
+}
+
+void test_Battery_works_without_segment(void) {
+	// Not opened, so the process keeps a private filter
+	read_percent = 35;
+	TEST_ASSERT_EQUAL_INT(1, Battery_update(fake_read, 0, 1));
+
+	BatteryStatus status;
+	Battery_get(&status);
+	TEST_ASSERT_EQUAL_INT(35, status.percent);
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Quantize
+	RUN_TEST(test_Battery_quantize_matches_ui_buckets);
+
+	// Filter
+	RUN_TEST(test_BatteryFilter_first_sample_is_taken_as_is);
+	RUN_TEST(test_BatteryFilter_status_before_first_sample);
+	RUN_TEST(test_BatteryFilter_clamps_readings);
+	RUN_TEST(test_BatteryFilter_smooths_small_changes);
+	RUN_TEST(test_BatteryFilter_drops_single_outlier);
+	RUN_TEST(test_BatteryFilter_accepts_confirmed_jump);
+	RUN_TEST(test_BatteryFilter_accepts_jump_after_long_gap);
+	RUN_TEST(test_BatteryFilter_charger_change_is_not_an_outlier);
+	RUN_TEST(test_BatteryFilter_level_has_hysteresis);
+	RUN_TEST(test_BatteryFilter_estimates_time_to_empty);
+	RUN_TEST(test_BatteryFilter_estimates_time_to_full);
+	RUN_TEST(test_BatteryFilter_needs_history_for_estimate);
+	RUN_TEST(test_BatteryFilter_steady_charge_has_no_estimate);
+
+	// Interval
+	RUN_TEST(test_BatteryFilter_interval_adapts);
+
+	// Shared segment
+	RUN_TEST(test_Battery_open_creates_segment);
+	RUN_TEST(test_Battery_update_samples_only_when_due);
+	RUN_TEST(test_Battery_get_reads_published_status);
+	RUN_TEST(test_Battery_history_survives_reopen);
+	RUN_TEST(test_Battery_works_without_segment);
+
+	return UNITY_END();
+}
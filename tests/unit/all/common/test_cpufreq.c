@@ -0,0 +1,239 @@
+/**
+ * test_cpufreq.c - Tests for in-process CPU frequency control
+ *
+ * Plain files in a temp directory stand in for the cpufreq sysfs nodes.
+ * The test table uses seven digit frequencies throughout because the
+ * module rewrites from offset 0 without truncating, as sysfs expects.
+ *
+ * Test coverage:
+ * - CPUFreq_init - Governor write, missing nodes
+ * - CPUFreq_setSpeed/setKHz - Table lookup, redundant transitions, apply hook
+ * - CPUFreq_quit - Resets state
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/cpufreq.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char temp_dir[] = "/tmp/cpufreq_XXXXXX";
+static char governor_path[256];
+static char setspeed_path[256];
+
+static int apply_calls;
+static int apply_khz;
+static int apply_result;
+
+static int fake_apply(int khz) {
+	apply_calls += 1;
+	apply_khz = khz;
+	return apply_result;
+}
+
+static void write_file(const char* path, const char* contents) {
+	FILE* file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs(contents, file);
+	fclose(file);
+}
+
+static void read_file(const char* path, char* out, size_t size) {
+	FILE* file = fopen(path, "r");
+	TEST_ASSERT_NOT_NULL(file);
+	size_t count = fread(out, 1, size - 1, file);
+	out[count] = '\0';
+	fclose(file);
+}
+
+static CPUFreqConfig make_config(void) {
+	CPUFreqConfig config = {
+	    .khz = {1008000, 1104000, 1296000, 1488000},
+	    .governor_path = governor_path,
+	    .setspeed_path = setspeed_path,
+	    .apply = fake_apply,
+	};
+	return config;
+}
+
+void setUp(void) {
+	strcpy(temp_dir, "/tmp/cpufreq_XXXXXX");
+	TEST_ASSERT_NOT_NULL(mkdtemp(temp_dir));
+	snprintf(governor_path, sizeof(governor_path), "%s/scaling_governor", temp_dir);
+	snprintf(setspeed_path, sizeof(setspeed_path), "%s/scaling_setspeed", temp_dir);
+	write_file(governor_path, "ondemand\n");
+	write_file(setspeed_path, "");
+
+	apply_calls = 0;
+	apply_khz = 0;
+	apply_result = 0;
+}
+
+void tearDown(void) {
+	CPUFreq_quit();
+	unlink(governor_path);
+	unlink(setspeed_path);
+	rmdir(temp_dir);
+}
+
+///////////////////////////////
+// Init Tests
+///////////////////////////////
+
+void test_CPUFreq_init_sets_userspace_governor(void) {
+	CPUFreqConfig config = make_config();
+	TEST_ASSERT_EQUAL_INT(0, CPUFreq_init(&config));
+
+	char value[32];
+	read_file(governor_path, value, sizeof(value));
+	TEST_ASSERT_EQUAL_STRING_LEN("userspace", value, 9);
+}
+
+void test_CPUFreq_init_fails_without_setspeed_node(void) {
+	unlink(setspeed_path);
+	CPUFreqConfig config = make_config();
+	TEST_ASSERT_EQUAL_INT(-1, CPUFreq_init(&config));
+}
+
+void test_CPUFreq_setSpeed_before_init_fails(void) {
+	TEST_ASSERT_EQUAL_INT(-1, CPUFreq_setSpeed(0));
+	TEST_ASSERT_EQUAL_INT(-1, CPUFreq_setKHz(1008000));
+}
+
+void test_CPUFreq_setSpeedWith_initializes_once(void) {
+	CPUFreqConfig config = make_config();
+	TEST_ASSERT_EQUAL_INT(1, CPUFreq_setSpeedWith(&config, 2));
+	TEST_ASSERT_EQUAL_INT(1296000, CPUFreq_getKHz());
+
+	// Later calls reuse the open node and the known frequency
+	config.khz[2] = 1;
+	TEST_ASSERT_EQUAL_INT(0, CPUFreq_setSpeedWith(&config, 2));
+	TEST_ASSERT_EQUAL_INT(1, apply_calls);
+}
+
+///////////////////////////////
+// Transition Tests
+///////////////////////////////
+
+void test_CPUFreq_setSpeed_writes_table_frequency(void) {
+	CPUFreqConfig config = make_config();
+	CPUFreq_init(&config);
+
+	TEST_ASSERT_EQUAL_INT(1, CPUFreq_setSpeed(2));
+
+	char value[32];
+	read_file(setspeed_path, value, sizeof(value));
+	TEST_ASSERT_EQUAL_STRING("1296000", value);
+	TEST_ASSERT_EQUAL_INT(1296000, CPUFreq_getKHz());
+	TEST_ASSERT_EQUAL_INT(1, apply_calls);
+	TEST_ASSERT_EQUAL_INT(1296000, apply_khz);
+}
+
+void test_CPUFreq_setSpeed_skips_redundant_transition(void) {
+	CPUFreqConfig config = make_config();
+	CPUFreq_init(&config);
+
+	TEST_ASSERT_EQUAL_INT(1, CPUFreq_setSpeed(3));
+	TEST_ASSERT_EQUAL_INT(0, CPUFreq_setSpeed(3));
+	TEST_ASSERT_EQUAL_INT(0, CPUFreq_setKHz(1488000));
+	TEST_ASSERT_EQUAL_INT(1, apply_calls);
+}
+
+void test_CPUFreq_setSpeed_switches_between_levels(void) {
+	CPUFreqConfig config = make_config();
+	CPUFreq_init(&config);
+
+	CPUFreq_setSpeed(3);
+	CPUFreq_setSpeed(0);
+
+	char value[32];
+	read_file(setspeed_path, value, sizeof(value));
+	TEST_ASSERT_EQUAL_STRING("1008000", value);
+	TEST_ASSERT_EQUAL_INT(2, apply_calls);
+}
+
+void test_CPUFreq_setSpeed_rejects_invalid_level(void) {
+	CPUFreqConfig config = make_config();
+	CPUFreq_init(&config);
+
+	TEST_ASSERT_EQUAL_INT(-1, CPUFreq_setSpeed(-1));
+	TEST_ASSERT_EQUAL_INT(-1, CPUFreq_setSpeed(CPUFREQ_LEVELS));
+	TEST_ASSERT_EQUAL_INT(0, apply_calls);
+}
+
+void test_CPUFreq_failed_apply_is_retried(void) {
+	CPUFreqConfig config = make_config();
+	CPUFreq_init(&config);
+
+	apply_result = -1;
+	TEST_ASSERT_EQUAL_INT(-1, CPUFreq_setSpeed(1));
+	TEST_ASSERT_EQUAL_INT(0, CPUFreq_getKHz());
+
+	apply_result = 0;
+	TEST_ASSERT_EQUAL_INT(1, CPUFreq_setSpeed(1));
+	TEST_ASSERT_EQUAL_INT(2, apply_calls);
+}
+
+void test_CPUFreq_apply_only_config(void) {
+	CPUFreqConfig config = make_config();
+	config.governor_path = NULL;
+	config.setspeed_path = NULL;
+	TEST_ASSERT_EQUAL_INT(0, CPUFreq_init(&config));
+
+	TEST_ASSERT_EQUAL_INT(1, CPUFreq_setSpeed(1));
+	TEST_ASSERT_EQUAL_INT(1104000, apply_khz);
+}
+
+void test_CPUFreq_getSpeedKHz_reads_table(void) {
+	TEST_ASSERT_EQUAL_INT(0, CPUFreq_getSpeedKHz(1));
+
+	CPUFreqConfig config = make_config();
+	CPUFreq_init(&config);
+	TEST_ASSERT_EQUAL_INT(1104000, CPUFreq_getSpeedKHz(1));
+	TEST_ASSERT_EQUAL_INT(0, CPUFreq_getSpeedKHz(CPUFREQ_LEVELS));
+	TEST_ASSERT_EQUAL_INT(0, apply_calls);
+}
+
+///////////////////////////////
+// Quit Tests
+///////////////////////////////
+
+void test_CPUFreq_quit_forgets_current_frequency(void) {
+	CPUFreqConfig config = make_config();
+	CPUFreq_init(&config);
+	CPUFreq_setSpeed(2);
+
+	CPUFreq_quit();
+	TEST_ASSERT_EQUAL_INT(0, CPUFreq_getKHz());
+	TEST_ASSERT_EQUAL_INT(-1, CPUFreq_setSpeed(2));
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Init
+	RUN_TEST(test_CPUFreq_init_sets_userspace_governor);
+	RUN_TEST(test_CPUFreq_init_fails_without_setspeed_node);
+	RUN_TEST(test_CPUFreq_setSpeed_before_init_fails);
+	RUN_TEST(test_CPUFreq_setSpeedWith_initializes_once);
+
+	// Transitions
+	RUN_TEST(test_CPUFreq_setSpeed_writes_table_frequency);
+	RUN_TEST(test_CPUFreq_setSpeed_skips_redundant_transition);
+	RUN_TEST(test_CPUFreq_setSpeed_switches_between_levels);
+	RUN_TEST(test_CPUFreq_setSpeed_rejects_invalid_level);
+	RUN_TEST(test_CPUFreq_failed_apply_is_retried);
+	RUN_TEST(test_CPUFreq_apply_only_config);
+	RUN_TEST(test_CPUFreq_getSpeedKHz_reads_table);
+
+	// Quit
+	RUN_TEST(test_CPUFreq_quit_forgets_current_frequency);
+
+	return UNITY_END();
+}
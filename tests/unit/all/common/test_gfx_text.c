@@ -7,6 +7,7 @@
  * Test coverage:
  * - GFX_truncateText() - Text truncation with ellipsis
  * - GFX_wrapText() - Multi-line text wrapping
+ * - GFX_getText() - Rendered text cache
  */
 
 #include "../../../support/unity/unity.h"
@@ -15,6 +16,7 @@
 #include "../../../support/sdl_fakes.h"
 #include "../../../../workspace/all/common/gfx_text.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 // Note: DEFINE_FFF_GLOBALS is in sdl_fakes.c, not here
@@ -38,17 +40,42 @@ int mock_TTF_SizeUTF8(TTF_Font* font, const char* text, int* w, int* h) {
 	return 0;
 }
 
+/**
+ * Fake rendering: allocates a surface 10px per byte wide and remembers the text
+ */
+static char last_rendered[256];
+SDL_Surface* mock_TTF_RenderUTF8_Blended(TTF_Font* font, const char* text, SDL_Color fg) {
+	SDL_Surface* surface = calloc(1, sizeof(SDL_Surface));
+	surface->w = strlen(text) * 10;
+	surface->h = font->point_size;
+	surface->pitch = surface->w * 4;
+	strcpy(last_rendered, text);
+	return surface;
+}
+
+void mock_SDL_FreeSurface(SDL_Surface* surface) {
+	free(surface);
+}
+
+static const SDL_Color white = {255, 255, 255, 255};
+static const SDL_Color black = {0, 0, 0, 255};
+
 void setUp(void) {
 	// Reset fff fakes
 	RESET_FAKE(TTF_SizeUTF8);
+	RESET_FAKE(TTF_RenderUTF8_Blended);
+	RESET_FAKE(SDL_FreeSurface);
 	FFF_RESET_HISTORY();
 
-	// Use our simple mock by default
+	// Use our simple mocks by default
 	TTF_SizeUTF8_fake.custom_fake = mock_TTF_SizeUTF8;
+	TTF_RenderUTF8_Blended_fake.custom_fake = mock_TTF_RenderUTF8_Blended;
+	SDL_FreeSurface_fake.custom_fake = mock_SDL_FreeSurface;
+	last_rendered[0] = '\0';
 }
 
 void tearDown(void) {
-	// Nothing to clean up
+	GFX_clearTextCache();
 }
 
 ///////////////////////////////
@@ -137,6 +164,127 @@ void test_truncateText_one_char_over_truncates(void) {
 	TEST_ASSERT_LESS_OR_EQUAL(50, width);
 }
 
+void test_truncateText_keeps_longest_prefix_that_fits(void) {
+	char output[256];
+
+	// "ABCDEFGHIJ" = 100px, max = 75px -> "ABCD..." (70px) is the longest fit
+	int width = GFX_truncateText(&mock_font, "ABCDEFGHIJ", output, 75, 0);
+
+	TEST_ASSERT_EQUAL_STRING("ABCD...", output);
+	TEST_ASSERT_EQUAL_INT(70, width);
+}
+
+void test_truncateText_uses_logarithmic_measurements(void) {
+	char output[256];
+	char input[201];
+	memset(input, 'x', 200);
+	input[200] = '\0';
+
+	GFX_truncateText(&mock_font, input, output, 500, 0);
+
+	// 1 full measure + ~8 binary search probes + 1 final, not ~150 linear steps
+	TEST_ASSERT_LESS_OR_EQUAL(12, TTF_SizeUTF8_fake.call_count);
+	TEST_ASSERT_EQUAL_STRING("xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx...", output);
+}
+
+void test_truncateText_does_not_split_utf8_characters(void) {
+	char output[256];
+
+	// "Pokémon Édition" - é and É are two bytes each
+	GFX_truncateText(&mock_font, "Pok\xc3\xa9mon \xc3\x89" "dition", output, 75, 0);
+
+	// 75px allows 4 bytes + "...", but the 4th byte is only half of "é", so cut before it
+	TEST_ASSERT_EQUAL_STRING("Pok...", output);
+}
+
+void test_truncateText_nothing_fits_returns_ellipsis(void) {
+	char output[256];
+
+	int width = GFX_truncateText(&mock_font, "Hello World", output, 20, 0);
+
+	TEST_ASSERT_EQUAL_STRING("...", output);
+	TEST_ASSERT_EQUAL_INT(30, width);
+}
+
+///////////////////////////////
+// GFX_getText() Tests
+///////////////////////////////
+
+void test_getText_renders_and_reports_width(void) {
+	int width = 0;
+	SDL_Surface* text = GFX_getText(&mock_font, "Hello", white, 0, 0, &width);
+
+	TEST_ASSERT_NOT_NULL(text);
+	TEST_ASSERT_EQUAL_INT(50, text->w);
+	TEST_ASSERT_EQUAL_INT(50, width);
+	TEST_ASSERT_EQUAL_INT(1, TTF_RenderUTF8_Blended_fake.call_count);
+}
+
+void test_getText_second_call_hits_cache(void) {
+	SDL_Surface* first = GFX_getText(&mock_font, "Hello", white, 200, 20, NULL);
+	int size_calls = TTF_SizeUTF8_fake.call_count;
+
+	int width = 0;
+	SDL_Surface* second = GFX_getText(&mock_font, "Hello", white, 200, 20, &width);
+
+	TEST_ASSERT_EQUAL_PTR(first, second);
+	TEST_ASSERT_EQUAL_INT(70, width); // cached measurement still includes padding
+	TEST_ASSERT_EQUAL_INT(1, TTF_RenderUTF8_Blended_fake.call_count);
+	TEST_ASSERT_EQUAL_INT(size_calls, TTF_SizeUTF8_fake.call_count);
+}
+
+void test_getText_key_includes_color_and_width(void) {
+	GFX_getText(&mock_font, "Hello World", white, 0, 0, NULL);
+	GFX_getText(&mock_font, "Hello World", black, 0, 0, NULL);
+	GFX_getText(&mock_font, "Hello World", white, 80, 0, NULL);
+
+	TEST_ASSERT_EQUAL_INT(3, TTF_RenderUTF8_Blended_fake.call_count);
+}
+
+void test_getText_renders_truncated_text(void) {
+	int width = 0;
+	GFX_getText(&mock_font, "The Legend of Zelda", white, 100, 0, &width);
+
+	TEST_ASSERT_EQUAL_STRING("The Leg...", last_rendered);
+	TEST_ASSERT_EQUAL_INT(100, width);
+}
+
+void test_getText_empty_string_returns_null(void) {
+	int width = -1;
+	TEST_ASSERT_NULL(GFX_getText(&mock_font, "", white, 100, 12, &width));
+	TEST_ASSERT_EQUAL_INT(12, width);
+	TEST_ASSERT_EQUAL_INT(0, TTF_RenderUTF8_Blended_fake.call_count);
+}
+
+void test_getText_evicts_least_recently_used(void) {
+	char name[32];
+	for (int i = 0; i < 200; i++) {
+		sprintf(name, "Row %d", i);
+		GFX_getText(&mock_font, name, white, 0, 0, NULL);
+	}
+
+	// Entry count is bounded, so older rows were released
+	TEST_ASSERT_GREATER_THAN(0, SDL_FreeSurface_fake.call_count);
+
+	// The most recent row is still cached
+	int renders = TTF_RenderUTF8_Blended_fake.call_count;
+	GFX_getText(&mock_font, "Row 199", white, 0, 0, NULL);
+	TEST_ASSERT_EQUAL_INT(renders, TTF_RenderUTF8_Blended_fake.call_count);
+
+	// The first row was evicted and has to be rendered again
+	GFX_getText(&mock_font, "Row 0", white, 0, 0, NULL);
+	TEST_ASSERT_EQUAL_INT(renders + 1, TTF_RenderUTF8_Blended_fake.call_count);
+}
+
+void test_clearTextCache_frees_surfaces(void) {
+	GFX_getText(&mock_font, "One", white, 0, 0, NULL);
+	GFX_getText(&mock_font, "Two", white, 0, 0, NULL);
+
+	GFX_clearTextCache();
+
+	TEST_ASSERT_EQUAL_INT(2, SDL_FreeSurface_fake.call_count);
+}
+
 ///////////////////////////////
 // GFX_wrapText() Tests
 ///////////////////////////////
@@ -434,6 +582,19 @@ int main(void) {
 	RUN_TEST(test_truncateText_short_text_unchanged);
 	RUN_TEST(test_truncateText_exact_fit_no_truncation);
 	RUN_TEST(test_truncateText_one_char_over_truncates);
+	RUN_TEST(test_truncateText_keeps_longest_prefix_that_fits);
+	RUN_TEST(test_truncateText_uses_logarithmic_measurements);
+	RUN_TEST(test_truncateText_does_not_split_utf8_characters);
+	RUN_TEST(test_truncateText_nothing_fits_returns_ellipsis);
+
+	// GFX_getText tests
+	RUN_TEST(test_getText_renders_and_reports_width);
+	RUN_TEST(test_getText_second_call_hits_cache);
+	RUN_TEST(test_getText_key_includes_color_and_width);
+	RUN_TEST(test_getText_renders_truncated_text);
+	RUN_TEST(test_getText_empty_string_returns_null);
+	RUN_TEST(test_getText_evicts_least_recently_used);
+	RUN_TEST(test_clearTextCache_frees_surfaces);
 
 	// GFX_wrapText tests
 	RUN_TEST(test_wrapText_null_string_returns_zero);
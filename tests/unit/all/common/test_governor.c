@@ -0,0 +1,226 @@
+/**
+ * test_governor.c - Tests for the Auto CPU speed governor
+ *
+ * Drives the governor with synthetic frame timings at 60fps. Busy time is
+ * given as a percent of the frame budget so the thresholds read directly.
+ *
+ * Test coverage:
+ * - Governor_init - Starting level and clamping
+ * - Governor_update - Stepping up, stepping down, hysteresis, thrash backoff
+ * - Governor_settle - Ignoring frames after a pause
+ * - Time-at-level accounting
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/governor.h"
+
+#include <string.h>
+
+#define BUDGET_US 16667
+
+static const int khz[GOVERNOR_LEVELS] = {1104000, 1296000, 1488000};
+static Governor governor;
+
+/**
+ * Reports one frame with busy given as a percent of the budget.
+ */
+static int frame(int busy_percent, int audio_fill) {
+	return Governor_update(&governor, (uint32_t)(BUDGET_US * busy_percent / 100), BUDGET_US,
+	                       audio_fill);
+}
+
+/**
+ * Reports count identical frames and returns the final level.
+ */
+static int frames(int count, int busy_percent, int audio_fill) {
+	int level = governor.level;
+	for (int i = 0; i < count; i++)
+		level = frame(busy_percent, audio_fill);
+	return level;
+}
+
+void setUp(void) {
+	Governor_init(&governor, khz, GOVERNOR_LEVELS - 1);
+}
+
+void tearDown(void) {
+}
+
+///////////////////////////////
+// Init Tests
+///////////////////////////////
+
+void test_Governor_init_clamps_level(void) {
+	Governor_init(&governor, khz, 99);
+	TEST_ASSERT_EQUAL_INT(GOVERNOR_LEVELS - 1, governor.level);
+	Governor_init(&governor, NULL, -1);
+	TEST_ASSERT_EQUAL_INT(0, governor.level);
+}
+
+///////////////////////////////
+// Step Down Tests
+///////////////////////////////
+
+void test_Governor_light_load_steps_down_slowly(void) {
+	int windows = GOVERNOR_DOWN_WINDOWS * GOVERNOR_WINDOW_FRAMES;
+	TEST_ASSERT_EQUAL_INT(2, frames(windows - 1, 30, 60));
+	TEST_ASSERT_EQUAL_INT(1, frame(30, 60));
+}
+
+void test_Governor_light_load_reaches_lowest_level(void) {
+	frames(GOVERNOR_WINDOW_FRAMES * 20, 30, 60);
+	TEST_ASSERT_EQUAL_INT(0, governor.level);
+	TEST_ASSERT_EQUAL_INT(2, governor.transitions);
+}
+
+void test_Governor_holds_when_lower_level_would_be_too_busy(void) {
+	// 65% at 1488MHz predicts ~75% at 1296MHz, over the down threshold
+	frames(GOVERNOR_WINDOW_FRAMES * 20, 65, 60);
+	TEST_ASSERT_EQUAL_INT(2, governor.level);
+}
+
+void test_Governor_single_spike_resets_calm_windows(void) {
+	frames(GOVERNOR_WINDOW_FRAMES * (GOVERNOR_DOWN_WINDOWS - 1), 30, 60);
+	frame(80, 60); // not enough to step up, but not calm either
+	frames(GOVERNOR_WINDOW_FRAMES * 2, 30, 60);
+	TEST_ASSERT_EQUAL_INT(2, governor.level);
+}
+
+void test_Governor_low_audio_blocks_step_down(void) {
+	frames(GOVERNOR_WINDOW_FRAMES * 20, 30, GOVERNOR_AUDIO_OK - 1);
+	TEST_ASSERT_EQUAL_INT(2, governor.level);
+}
+
+void test_Governor_unknown_frequencies_use_default_ratio(void) {
+	Governor_init(&governor, NULL, 2);
+	// 50% * 1.5 = 75%, over the down threshold
+	frames(GOVERNOR_WINDOW_FRAMES * 20, 50, 60);
+	TEST_ASSERT_EQUAL_INT(2, governor.level);
+	// 40% * 1.5 = 60%
+	frames(GOVERNOR_WINDOW_FRAMES * GOVERNOR_DOWN_WINDOWS, 40, 60);
+	TEST_ASSERT_EQUAL_INT(1, governor.level);
+}
+
+///////////////////////////////
+// Step Up Tests
+///////////////////////////////
+
+void test_Governor_heavy_frame_steps_up_immediately(void) {
+	Governor_init(&governor, khz, 0);
+	TEST_ASSERT_EQUAL_INT(1, frame(GOVERNOR_UP_THRESHOLD + 5, 60));
+}
+
+void test_Governor_starved_audio_steps_up(void) {
+	Governor_init(&governor, khz, 0);
+	TEST_ASSERT_EQUAL_INT(1, frame(10, GOVERNOR_AUDIO_LOW - 1));
+}
+
+void test_Governor_unknown_audio_is_ignored(void) {
+	Governor_init(&governor, khz, 0);
+	TEST_ASSERT_EQUAL_INT(0, frame(10, -1));
+}
+
+void test_Governor_waits_for_new_level_to_settle(void) {
+	Governor_init(&governor, khz, 0);
+	frame(95, 60);
+	TEST_ASSERT_EQUAL_INT(1, frames(GOVERNOR_SETTLE_FRAMES, 95, 60));
+	TEST_ASSERT_EQUAL_INT(2, frame(95, 60));
+}
+
+void test_Governor_stays_at_top_level(void) {
+	TEST_ASSERT_EQUAL_INT(2, frames(10, 150, 0));
+	TEST_ASSERT_EQUAL_INT(0, governor.transitions);
+}
+
+///////////////////////////////
+// Hysteresis Tests
+///////////////////////////////
+
+void test_Governor_thrash_doubles_required_calm_windows(void) {
+	frames(GOVERNOR_WINDOW_FRAMES * GOVERNOR_DOWN_WINDOWS, 30, 60);
+	TEST_ASSERT_EQUAL_INT(1, governor.level);
+
+	frames(GOVERNOR_SETTLE_FRAMES, 30, 60);
+	frame(95, 60); // stepped down too far
+	TEST_ASSERT_EQUAL_INT(2, governor.level);
+	TEST_ASSERT_EQUAL_INT(GOVERNOR_DOWN_WINDOWS * 2, governor.down_windows);
+
+	// The old number of calm windows is no longer enough
+	frames(GOVERNOR_SETTLE_FRAMES + GOVERNOR_WINDOW_FRAMES * GOVERNOR_DOWN_WINDOWS, 30, 60);
+	TEST_ASSERT_EQUAL_INT(2, governor.level);
+}
+
+void test_Governor_thrash_backoff_is_capped(void) {
+	for (int i = 0; i < 10; i++) {
+		frames(GOVERNOR_WINDOW_FRAMES * GOVERNOR_DOWN_WINDOWS_MAX + GOVERNOR_SETTLE_FRAMES, 30,
+		       60);
+		frames(GOVERNOR_SETTLE_FRAMES, 30, 60);
+		frame(95, 60);
+		frames(GOVERNOR_SETTLE_FRAMES, 30, 60);
+	}
+	TEST_ASSERT_TRUE(governor.down_windows <= GOVERNOR_DOWN_WINDOWS_MAX);
+}
+
+///////////////////////////////
+// Settle and Accounting Tests
+///////////////////////////////
+
+void test_Governor_settle_ignores_next_frames(void) {
+	Governor_init(&governor, khz, 0);
+	Governor_settle(&governor);
+	TEST_ASSERT_EQUAL_INT(0, frames(GOVERNOR_SETTLE_FRAMES, 200, 60));
+	TEST_ASSERT_EQUAL_INT(1, frame(200, 60));
+}
+
+void test_Governor_tracks_time_at_level(void) {
+	Governor_init(&governor, khz, 0);
+	frames(10, 30, 60);
+	frame(95, 60);
+	frames(4, 30, 60);
+
+	TEST_ASSERT_EQUAL_UINT64(11 * BUDGET_US, governor.time_at_level[0]);
+	TEST_ASSERT_EQUAL_UINT64(4 * BUDGET_US, governor.time_at_level[1]);
+	TEST_ASSERT_EQUAL_UINT64(0, governor.time_at_level[2]);
+}
+
+void test_Governor_zero_budget_is_ignored(void) {
+	TEST_ASSERT_EQUAL_INT(2, Governor_update(&governor, 1000, 0, 60));
+	TEST_ASSERT_EQUAL_UINT64(0, governor.time_at_level[2]);
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Init
+	RUN_TEST(test_Governor_init_clamps_level);
+
+	// Step down
+	RUN_TEST(test_Governor_light_load_steps_down_slowly);
+	RUN_TEST(test_Governor_light_load_reaches_lowest_level);
+	RUN_TEST(test_Governor_holds_when_lower_level_would_be_too_busy);
+	RUN_TEST(test_Governor_single_spike_resets_calm_windows);
+	RUN_TEST(test_Governor_low_audio_blocks_step_down);
+	RUN_TEST(test_Governor_unknown_frequencies_use_default_ratio);
+
+	// Step up
+	RUN_TEST(test_Governor_heavy_frame_steps_up_immediately);
+	RUN_TEST(test_Governor_starved_audio_steps_up);
+	RUN_TEST(test_Governor_unknown_audio_is_ignored);
+	RUN_TEST(test_Governor_waits_for_new_level_to_settle);
+	RUN_TEST(test_Governor_stays_at_top_level);
+
+	// Hysteresis
+	RUN_TEST(test_Governor_thrash_doubles_required_calm_windows);
+	RUN_TEST(test_Governor_thrash_backoff_is_capped);
+
+	// Settle and accounting
+	RUN_TEST(test_Governor_settle_ignores_next_frames);
+	RUN_TEST(test_Governor_tracks_time_at_level);
+	RUN_TEST(test_Governor_zero_budget_is_ignored);
+
+	return UNITY_END();
+}
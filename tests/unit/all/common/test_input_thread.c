@@ -0,0 +1,287 @@
+/**
+ * test_input_thread.c - Tests for the dedicated evdev reader
+ *
+ * Non-blocking pipes stand in for the evdev devices; the test writes
+ * struct input_event records into them. Pipes don't take EVIOCSCLOCKID,
+ * so timestamps are whatever the test writes.
+ *
+ * Test coverage:
+ * - InputThread_read - Direct reads without the thread, queued reads with it
+ * - Frame pairing - One change per digital control per frame, analog passes,
+ *   sticks near center stay analog
+ * - InputThread_wait - Wakes on queued input, times out otherwise
+ * - InputThread_getAge - Age of the latest press
+ * - InputThread_stop - Falls back to direct reads
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/input_thread.h"
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEVICES 2
+
+static int pipes[DEVICES][2];
+static int fds[DEVICES];
+
+void setUp(void) {
+	for (int i = 0; i < DEVICES; i++) {
+		TEST_ASSERT_EQUAL_INT(0, pipe2(pipes[i], O_NONBLOCK | O_CLOEXEC));
+		fds[i] = pipes[i][0];
+	}
+}
+
+void tearDown(void) {
+	InputThread_stop();
+	for (int i = 0; i < DEVICES; i++) {
+		close(pipes[i][0]);
+		close(pipes[i][1]);
+	}
+}
+
+static uint64_t now_us(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void send_at(int device, int type, int code, int value, uint64_t time_us) {
+	struct input_event event;
+	memset(&event, 0, sizeof(event));
+	event.input_event_sec = time_us / 1000000;
+	event.input_event_usec = time_us % 1000000;
+	event.type = type;
+	event.code = code;
+	event.value = value;
+	TEST_ASSERT_EQUAL_INT(sizeof(event), write(pipes[device][1], &event, sizeof(event)));
+}
+
+static void send(int device, int type, int code, int value) {
+	send_at(device, type, code, value, now_us());
+}
+
+/**
+ * Waits for the thread to queue everything written so far.
+ */
+static void settle(void) {
+	InputThread_wait(100);
+	usleep(20000);
+}
+
+/**
+ * Reads every event a frame hands out on one device.
+ */
+static int drain(int device, InputEvent* events, int max) {
+	int count = 0;
+	InputEvent event;
+	while (count < max && InputThread_read(device, fds[device], &event))
+		events[count++] = event;
+	return count;
+}
+
+///////////////////////////////
+// Direct Tests
+///////////////////////////////
+
+void test_InputThread_read_without_thread_reads_fd(void) {
+	send_at(0, EV_KEY, KEY_A, 1, 1500000);
+
+	InputEvent events[4];
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(1, drain(0, events, 4));
+	TEST_ASSERT_EQUAL_INT(EV_KEY, events[0].type);
+	TEST_ASSERT_EQUAL_INT(KEY_A, events[0].code);
+	TEST_ASSERT_EQUAL_INT(1, events[0].value);
+	TEST_ASSERT_EQUAL_UINT64(1500000, events[0].time_us);
+	TEST_ASSERT_EQUAL_UINT32(0, InputThread_getAge());
+}
+
+void test_InputThread_read_without_thread_keeps_taps_together(void) {
+	// Without the thread there's nothing to hold the release back
+	send(0, EV_KEY, KEY_A, 1);
+	send(0, EV_KEY, KEY_A, 0);
+
+	InputEvent events[4];
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(2, drain(0, events, 4));
+}
+
+///////////////////////////////
+// Thread Tests
+///////////////////////////////
+
+void test_InputThread_start_and_stop(void) {
+	TEST_ASSERT_EQUAL_INT(0, InputThread_start(fds, DEVICES));
+	TEST_ASSERT_EQUAL_INT(1, InputThread_isRunning());
+
+	InputThread_stop();
+	TEST_ASSERT_EQUAL_INT(0, InputThread_isRunning());
+}
+
+void test_InputThread_queues_events_in_order(void) {
+	InputThread_start(fds, DEVICES);
+	send(0, EV_KEY, KEY_A, 1);
+	send(0, EV_KEY, KEY_B, 1);
+	send(1, EV_KEY, KEY_C, 1);
+	settle();
+
+	InputEvent events[4];
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(2, drain(0, events, 4));
+	TEST_ASSERT_EQUAL_INT(KEY_A, events[0].code);
+	TEST_ASSERT_EQUAL_INT(KEY_B, events[1].code);
+	TEST_ASSERT_EQUAL_INT(1, drain(1, events, 4));
+	TEST_ASSERT_EQUAL_INT(KEY_C, events[0].code);
+}
+
+void test_InputThread_holds_release_of_tap_to_next_frame(void) {
+	InputThread_start(fds, DEVICES);
+	send(0, EV_KEY, KEY_A, 1);
+	send(0, EV_KEY, KEY_A, 0);
+	send(0, EV_KEY, KEY_B, 1);
+	settle();
+
+	InputEvent events[4];
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(1, drain(0, events, 4));
+	TEST_ASSERT_EQUAL_INT(1, events[0].value);
+
+	// Everything behind the release waits with it
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(2, drain(0, events, 4));
+	TEST_ASSERT_EQUAL_INT(KEY_A, events[0].code);
+	TEST_ASSERT_EQUAL_INT(0, events[0].value);
+	TEST_ASSERT_EQUAL_INT(KEY_B, events[1].code);
+}
+
+void test_InputThread_pairs_are_per_device(void) {
+	InputThread_start(fds, DEVICES);
+	send(0, EV_KEY, KEY_A, 1);
+	send(1, EV_KEY, KEY_A, 1);
+	settle();
+
+	InputEvent events[4];
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(1, drain(0, events, 4));
+	TEST_ASSERT_EQUAL_INT(1, drain(1, events, 4));
+}
+
+void test_InputThread_autorepeat_does_not_hold_queue(void) {
+	InputThread_start(fds, DEVICES);
+	send(0, EV_KEY, KEY_A, 1);
+	send(0, EV_KEY, KEY_A, 2);
+	send(0, EV_KEY, KEY_A, 2);
+	settle();
+
+	InputEvent events[4];
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(3, drain(0, events, 4));
+}
+
+void test_InputThread_holds_hat_return_to_next_frame(void) {
+	InputThread_start(fds, DEVICES);
+	send(0, EV_ABS, ABS_HAT0X, -1);
+	send(0, EV_ABS, ABS_HAT0X, 0);
+	settle();
+
+	InputEvent events[4];
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(1, drain(0, events, 4));
+	TEST_ASSERT_EQUAL_INT(-1, events[0].value);
+
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(1, drain(0, events, 4));
+	TEST_ASSERT_EQUAL_INT(0, events[0].value);
+}
+
+void test_InputThread_passes_analog_axes(void) {
+	InputThread_start(fds, DEVICES);
+	send(0, EV_ABS, ABS_X, 1000);
+	send(0, EV_ABS, ABS_X, 2000);
+	send(0, EV_ABS, ABS_X, 3000);
+	settle();
+
+	InputEvent events[4];
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(3, drain(0, events, 4));
+	TEST_ASSERT_EQUAL_INT(3000, events[2].value);
+}
+
+void test_InputThread_passes_stick_near_center(void) {
+	InputThread_start(fds, DEVICES);
+	send(0, EV_ABS, ABS_X, 1);
+	send(0, EV_ABS, ABS_X, 0);
+	send(0, EV_ABS, ABS_X, -1);
+	settle();
+
+	InputEvent events[4];
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(3, drain(0, events, 4));
+	TEST_ASSERT_EQUAL_INT(-1, events[2].value);
+}
+
+void test_InputThread_wait_wakes_on_input(void) {
+	InputThread_start(fds, DEVICES);
+	send(1, EV_KEY, KEY_A, 1);
+	TEST_ASSERT_EQUAL_INT(1, InputThread_wait(1000));
+}
+
+void test_InputThread_wait_times_out(void) {
+	InputThread_start(fds, DEVICES);
+	TEST_ASSERT_EQUAL_INT(0, InputThread_wait(20));
+}
+
+void test_InputThread_measures_press_age(void) {
+	InputThread_start(fds, DEVICES);
+	send_at(0, EV_KEY, KEY_A, 1, now_us() - 5000);
+	settle();
+
+	InputEvent events[4];
+	InputThread_beginFrame();
+	drain(0, events, 4);
+	TEST_ASSERT_TRUE(InputThread_getAge() >= 5000);
+	TEST_ASSERT_TRUE(InputThread_getAge() < 1000000);
+}
+
+void test_InputThread_stop_falls_back_to_direct_reads(void) {
+	InputThread_start(fds, DEVICES);
+	InputThread_stop();
+
+	send(0, EV_KEY, KEY_A, 1);
+	InputEvent events[4];
+	InputThread_beginFrame();
+	TEST_ASSERT_EQUAL_INT(1, drain(0, events, 4));
+	TEST_ASSERT_EQUAL_UINT32(0, InputThread_getAge());
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Direct
+	RUN_TEST(test_InputThread_read_without_thread_reads_fd);
+	RUN_TEST(test_InputThread_read_without_thread_keeps_taps_together);
+
+	// Thread
+	RUN_TEST(test_InputThread_start_and_stop);
+	RUN_TEST(test_InputThread_queues_events_in_order);
+	RUN_TEST(test_InputThread_holds_release_of_tap_to_next_frame);
+	RUN_TEST(test_InputThread_pairs_are_per_device);
+	RUN_TEST(test_InputThread_autorepeat_does_not_hold_queue);
+	RUN_TEST(test_InputThread_holds_hat_return_to_next_frame);
+	RUN_TEST(test_InputThread_passes_analog_axes);
+	RUN_TEST(test_InputThread_passes_stick_near_center);
+	RUN_TEST(test_InputThread_wait_wakes_on_input);
+	RUN_TEST(test_InputThread_wait_times_out);
+	RUN_TEST(test_InputThread_measures_press_age);
+	RUN_TEST(test_InputThread_stop_falls_back_to_direct_reads);
+
+	return UNITY_END();
+}
@@ -0,0 +1,398 @@
+/**
+ * test_keymon_core.c - Tests for the event-driven keymon core
+ *
+ * KeymonKeys is driven with synthetic timestamps. The main loop is driven
+ * for real: a FIFO stands in for the evdev device (the test writes
+ * struct input_event into it) and plain files in a temp directory stand
+ * in for sysfs. Plain files can't signal POLLPRI, so every port falls back
+ * to polling here. The msettings calls are stubbed below.
+ *
+ * Test coverage:
+ * - KeymonKeys_event - Press, release, MENU modifier, kernel autorepeat
+ * - KeymonKeys_repeat/deadline - Delay, interval, late wakeups
+ * - Keymon_step - Buttons, limits, held repeat, EV_SW switches
+ * - Ports - Initial state, polled changes, missing files, GPIO fallback
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/keymon_core.h"
+
+#include <fcntl.h>
+#include <linux/input.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+///////////////////////////////
+// msettings stubs
+///////////////////////////////
+
+static int volume;
+static int brightness;
+static int volume_sets;
+
+int GetVolume(void) {
+	return volume;
+}
+void SetVolume(int value) {
+	volume = value;
+	volume_sets += 1;
+}
+int GetBrightness(void) {
+	return brightness;
+}
+void SetBrightness(int value) {
+	brightness = value;
+}
+
+static int jack_calls;
+static int jack_value;
+static int hdmi_calls;
+static int hdmi_value;
+
+static void fake_jack(int value) {
+	jack_calls += 1;
+	jack_value = value;
+}
+static void fake_hdmi(int value) {
+	hdmi_calls += 1;
+	hdmi_value = value;
+}
+static int parse_inverted(const char* value) {
+	return !Keymon_parseInt(value);
+}
+
+///////////////////////////////
+// Fixtures
+///////////////////////////////
+
+#define CODE_MENU 1
+#define CODE_PLUS 115
+#define CODE_MINUS 114
+#define CODE_JACK 2
+
+static char temp_dir[] = "/tmp/keymon_XXXXXX";
+static char input_path[256];
+static char jack_path[256];
+static char hdmi_path[256];
+static int input_writer = -1;
+
+static const KeymonButton buttons[] = {
+    {CODE_MENU, KEYMON_MENU},
+    {CODE_PLUS, KEYMON_PLUS},
+    {CODE_MINUS, KEYMON_MINUS},
+};
+static const KeymonSwitch switches[] = {
+    {CODE_JACK, fake_jack},
+};
+static KeymonPort ports[2];
+static KeymonConfig config;
+
+static void write_file(const char* path, const char* contents) {
+	FILE* file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs(contents, file);
+	fclose(file);
+}
+
+static uint64_t now_ms(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * Starts the loop and opens the write end of the input FIFO.
+ */
+static void start(void) {
+	TEST_ASSERT_EQUAL_INT(0, Keymon_init(&config));
+	input_writer = open(input_path, O_WRONLY | O_NONBLOCK);
+	TEST_ASSERT_TRUE(input_writer >= 0);
+}
+
+static void send_event(int type, int code, int value) {
+	struct input_event event = {0};
+	event.type = type;
+	event.code = code;
+	event.value = value;
+	TEST_ASSERT_EQUAL_INT(sizeof(event), write(input_writer, &event, sizeof(event)));
+}
+
+/**
+ * Steps the loop until nothing happens for idle_ms.
+ */
+static void settle(int idle_ms) {
+	while (Keymon_step(idle_ms) > 0)
+		;
+}
+
+/**
+ * Steps the loop for at least duration_ms.
+ */
+static void run_for(int duration_ms) {
+	uint64_t until = now_ms() + duration_ms;
+	uint64_t now;
+	while ((now = now_ms()) < until)
+		Keymon_step((int)(until - now));
+}
+
+void setUp(void) {
+	strcpy(temp_dir, "/tmp/keymon_XXXXXX");
+	TEST_ASSERT_NOT_NULL(mkdtemp(temp_dir));
+	snprintf(input_path, sizeof(input_path), "%s/event0", temp_dir);
+	snprintf(jack_path, sizeof(jack_path), "%s/value", temp_dir);
+	snprintf(hdmi_path, sizeof(hdmi_path), "%s/status", temp_dir);
+	TEST_ASSERT_EQUAL_INT(0, mkfifo(input_path, 0600));
+	write_file(jack_path, "1\n");
+	write_file(hdmi_path, "0\n");
+
+	ports[0] = (KeymonPort){.path = jack_path,
+	                        .parse = parse_inverted,
+	                        .apply = fake_jack,
+	                        .notify = KEYMON_GPIO,
+	                        .interval_ms = 20};
+	ports[1] = (KeymonPort){.path = hdmi_path, .apply = fake_hdmi, .interval_ms = 20};
+
+	memset(&config, 0, sizeof(config));
+	config.inputs[0] = input_path;
+	config.buttons = buttons;
+	config.button_count = sizeof(buttons) / sizeof(buttons[0]);
+	config.switches = switches;
+	config.switch_count = sizeof(switches) / sizeof(switches[0]);
+	config.ports = ports;
+	config.port_count = 2;
+
+	volume = 10;
+	brightness = 5;
+	volume_sets = 0;
+	jack_calls = jack_value = 0;
+	hdmi_calls = hdmi_value = 0;
+	input_writer = -1;
+}
+
+void tearDown(void) {
+	if (input_writer >= 0)
+		close(input_writer);
+	Keymon_quit();
+	unlink(input_path);
+	unlink(jack_path);
+	unlink(hdmi_path);
+	rmdir(temp_dir);
+}
+
+///////////////////////////////
+// KeymonKeys Tests
+///////////////////////////////
+
+void test_KeymonKeys_press_acts_immediately(void) {
+	KeymonKeys keys;
+	KeymonKeys_reset(&keys);
+	TEST_ASSERT_EQUAL_INT(KEYMON_VOLUME_UP, KeymonKeys_event(&keys, KEYMON_PLUS, 1, 1000));
+	TEST_ASSERT_EQUAL_INT(KEYMON_ACTION_NONE, KeymonKeys_event(&keys, KEYMON_PLUS, 0, 1050));
+	TEST_ASSERT_EQUAL_INT(KEYMON_VOLUME_DOWN, KeymonKeys_event(&keys, KEYMON_MINUS, 1, 1100));
+}
+
+void test_KeymonKeys_menu_switches_to_brightness(void) {
+	KeymonKeys keys;
+	KeymonKeys_reset(&keys);
+	TEST_ASSERT_EQUAL_INT(KEYMON_ACTION_NONE, KeymonKeys_event(&keys, KEYMON_MENU, 1, 1000));
+	TEST_ASSERT_EQUAL_INT(KEYMON_BRIGHTNESS_UP, KeymonKeys_event(&keys, KEYMON_PLUS, 1, 1010));
+	TEST_ASSERT_EQUAL_INT(KEYMON_BRIGHTNESS_DOWN, KeymonKeys_event(&keys, KEYMON_MINUS, 1, 1020));
+	KeymonKeys_event(&keys, KEYMON_MENU, 0, 1030);
+	TEST_ASSERT_EQUAL_INT(KEYMON_VOLUME_UP, KeymonKeys_event(&keys, KEYMON_PLUS, 1, 1040));
+}
+
+void test_KeymonKeys_ignores_other_roles_and_values(void) {
+	KeymonKeys keys;
+	KeymonKeys_reset(&keys);
+	TEST_ASSERT_EQUAL_INT(KEYMON_ACTION_NONE, KeymonKeys_event(&keys, KEYMON_NONE, 1, 1000));
+	TEST_ASSERT_EQUAL_INT(KEYMON_ACTION_NONE, KeymonKeys_event(&keys, KEYMON_PLUS, 3, 1000));
+	TEST_ASSERT_EQUAL_UINT64(0, KeymonKeys_deadline(&keys));
+}
+
+void test_KeymonKeys_repeats_after_delay_then_interval(void) {
+	KeymonKeys keys;
+	KeymonAction actions[2];
+	KeymonKeys_reset(&keys);
+	KeymonKeys_event(&keys, KEYMON_PLUS, 1, 1000);
+
+	TEST_ASSERT_EQUAL_UINT64(1000 + KEYMON_REPEAT_DELAY, KeymonKeys_deadline(&keys));
+	TEST_ASSERT_EQUAL_INT(0, KeymonKeys_repeat(&keys, 1000 + KEYMON_REPEAT_DELAY - 1, actions));
+	TEST_ASSERT_EQUAL_INT(1, KeymonKeys_repeat(&keys, 1000 + KEYMON_REPEAT_DELAY, actions));
+	TEST_ASSERT_EQUAL_INT(KEYMON_VOLUME_UP, actions[0]);
+	TEST_ASSERT_EQUAL_UINT64(1000 + KEYMON_REPEAT_DELAY + KEYMON_REPEAT_INTERVAL,
+	                         KeymonKeys_deadline(&keys));
+
+	KeymonKeys_event(&keys, KEYMON_PLUS, 0, 1400);
+	TEST_ASSERT_EQUAL_UINT64(0, KeymonKeys_deadline(&keys));
+	TEST_ASSERT_EQUAL_INT(0, KeymonKeys_repeat(&keys, 5000, actions));
+}
+
+void test_KeymonKeys_late_repeat_does_not_burst(void) {
+	KeymonKeys keys;
+	KeymonAction actions[2];
+	KeymonKeys_reset(&keys);
+	KeymonKeys_event(&keys, KEYMON_MINUS, 1, 1000);
+
+	TEST_ASSERT_EQUAL_INT(1, KeymonKeys_repeat(&keys, 3000, actions));
+	TEST_ASSERT_EQUAL_INT(KEYMON_VOLUME_DOWN, actions[0]);
+	TEST_ASSERT_EQUAL_UINT64(3000 + KEYMON_REPEAT_INTERVAL, KeymonKeys_deadline(&keys));
+}
+
+void test_KeymonKeys_repeats_both_buttons(void) {
+	KeymonKeys keys;
+	KeymonAction actions[2];
+	KeymonKeys_reset(&keys);
+	KeymonKeys_event(&keys, KEYMON_PLUS, 1, 1000);
+	KeymonKeys_event(&keys, KEYMON_MINUS, 1, 1050);
+
+	TEST_ASSERT_EQUAL_UINT64(1000 + KEYMON_REPEAT_DELAY, KeymonKeys_deadline(&keys));
+	TEST_ASSERT_EQUAL_INT(2, KeymonKeys_repeat(&keys, 1400, actions));
+	TEST_ASSERT_EQUAL_INT(KEYMON_VOLUME_UP, actions[0]);
+	TEST_ASSERT_EQUAL_INT(KEYMON_VOLUME_DOWN, actions[1]);
+}
+
+void test_KeymonKeys_autorepeat_restarts_delay(void) {
+	KeymonKeys keys;
+	KeymonKeys_reset(&keys);
+	KeymonKeys_event(&keys, KEYMON_PLUS, 1, 1000);
+	TEST_ASSERT_EQUAL_INT(KEYMON_VOLUME_UP, KeymonKeys_event(&keys, KEYMON_PLUS, 2, 1250));
+	TEST_ASSERT_EQUAL_UINT64(1250 + KEYMON_REPEAT_DELAY, KeymonKeys_deadline(&keys));
+}
+
+///////////////////////////////
+// Loop Tests
+///////////////////////////////
+
+void test_Keymon_step_handles_buttons(void) {
+	start();
+
+	send_event(EV_KEY, CODE_PLUS, 1);
+	send_event(EV_KEY, CODE_PLUS, 0);
+	send_event(EV_SYN, SYN_REPORT, 0);
+	settle(10);
+	TEST_ASSERT_EQUAL_INT(11, volume);
+
+	send_event(EV_KEY, CODE_MENU, 1);
+	send_event(EV_KEY, CODE_MINUS, 1);
+	send_event(EV_KEY, CODE_MINUS, 0);
+	send_event(EV_KEY, CODE_MENU, 0);
+	settle(10);
+	TEST_ASSERT_EQUAL_INT(4, brightness);
+	TEST_ASSERT_EQUAL_INT(11, volume);
+}
+
+void test_Keymon_step_respects_limits(void) {
+	volume = KEYMON_VOLUME_MAX;
+	brightness = KEYMON_BRIGHTNESS_MIN;
+	start();
+
+	send_event(EV_KEY, CODE_PLUS, 1);
+	send_event(EV_KEY, CODE_PLUS, 0);
+	send_event(EV_KEY, CODE_MENU, 1);
+	send_event(EV_KEY, CODE_MINUS, 1);
+	send_event(EV_KEY, CODE_MINUS, 0);
+	settle(10);
+	TEST_ASSERT_EQUAL_INT(KEYMON_VOLUME_MAX, volume);
+	TEST_ASSERT_EQUAL_INT(KEYMON_BRIGHTNESS_MIN, brightness);
+	TEST_ASSERT_EQUAL_INT(0, volume_sets);
+}
+
+void test_Keymon_step_repeats_held_button(void) {
+	start();
+
+	send_event(EV_KEY, CODE_PLUS, 1);
+	run_for(KEYMON_REPEAT_DELAY + KEYMON_REPEAT_INTERVAL / 2);
+	TEST_ASSERT_EQUAL_INT(12, volume);
+
+	send_event(EV_KEY, CODE_PLUS, 0);
+	run_for(KEYMON_REPEAT_INTERVAL * 2);
+	TEST_ASSERT_EQUAL_INT(12, volume);
+}
+
+void test_Keymon_step_applies_switches(void) {
+	start();
+	jack_calls = 0;
+
+	send_event(EV_SW, CODE_JACK, 1);
+	settle(10);
+	TEST_ASSERT_EQUAL_INT(1, jack_calls);
+	TEST_ASSERT_EQUAL_INT(1, jack_value);
+}
+
+///////////////////////////////
+// Port Tests
+///////////////////////////////
+
+void test_Keymon_init_applies_port_state(void) {
+	start();
+	TEST_ASSERT_EQUAL_INT(1, jack_calls);
+	TEST_ASSERT_EQUAL_INT(0, jack_value);
+	TEST_ASSERT_EQUAL_INT(1, hdmi_calls);
+	TEST_ASSERT_EQUAL_INT(0, hdmi_value);
+}
+
+void test_Keymon_step_polls_port_changes(void) {
+	start();
+
+	write_file(hdmi_path, "1\n");
+	run_for(60);
+	TEST_ASSERT_EQUAL_INT(2, hdmi_calls);
+	TEST_ASSERT_EQUAL_INT(1, hdmi_value);
+
+	run_for(60);
+	TEST_ASSERT_EQUAL_INT(2, hdmi_calls);
+}
+
+void test_Keymon_step_gpio_falls_back_to_polling(void) {
+	start();
+
+	write_file(jack_path, "0\n");
+	run_for(60);
+	TEST_ASSERT_EQUAL_INT(2, jack_calls);
+	TEST_ASSERT_EQUAL_INT(1, jack_value);
+}
+
+void test_Keymon_init_missing_port_reads_as_empty(void) {
+	unlink(hdmi_path);
+	unlink(jack_path);
+	start();
+	TEST_ASSERT_EQUAL_INT(1, hdmi_calls);
+	TEST_ASSERT_EQUAL_INT(0, hdmi_value);
+	TEST_ASSERT_EQUAL_INT(1, jack_calls);
+	TEST_ASSERT_EQUAL_INT(1, jack_value);
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Button state
+	RUN_TEST(test_KeymonKeys_press_acts_immediately);
+	RUN_TEST(test_KeymonKeys_menu_switches_to_brightness);
+	RUN_TEST(test_KeymonKeys_ignores_other_roles_and_values);
+	RUN_TEST(test_KeymonKeys_repeats_after_delay_then_interval);
+	RUN_TEST(test_KeymonKeys_late_repeat_does_not_burst);
+	RUN_TEST(test_KeymonKeys_repeats_both_buttons);
+	RUN_TEST(test_KeymonKeys_autorepeat_restarts_delay);
+
+	// Loop
+	RUN_TEST(test_Keymon_step_handles_buttons);
+	RUN_TEST(test_Keymon_step_respects_limits);
+	RUN_TEST(test_Keymon_step_repeats_held_button);
+	RUN_TEST(test_Keymon_step_applies_switches);
+
+	// Ports
+	RUN_TEST(test_Keymon_init_applies_port_state);
+	RUN_TEST(test_Keymon_step_polls_port_changes);
+	RUN_TEST(test_Keymon_step_gpio_falls_back_to_polling);
+	RUN_TEST(test_Keymon_init_missing_port_reads_as_empty);
+
+	return UNITY_END();
+}
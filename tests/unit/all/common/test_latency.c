@@ -0,0 +1,215 @@
+/**
+ * test_latency.c - Tests for the input-to-photon latency probe
+ *
+ * Drives the probe with made-up timestamps the way minarch does: poll,
+ * core reads the button, frame gets marked, flip starts and returns.
+ *
+ * Test coverage:
+ * - Latency_poll - Press schedule, hold and release, timeouts
+ * - Latency_seen/markFrame - One marked frame per press, only after a read
+ * - Latency_flipStart/flipEnd - Samples timed from the scheduled press
+ * - Latency_getStats - Distribution of completed samples
+ * - Latency_isDone - Run ends after the requested presses
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/latency.h"
+
+#define MS 1000ULL
+#define START 1000000ULL
+
+void setUp(void) {
+	Latency_start(3, START);
+}
+
+void tearDown(void) {
+}
+
+/**
+ * Polls every microsecond until the probe presses the button, so the
+ * returned time is exactly when the press was due.
+ */
+static uint64_t press(uint64_t now) {
+	while (!Latency_poll(now))
+		now += 1;
+	return now;
+}
+
+/**
+ * Runs one press through the whole path. Returns the time the flip ended.
+ */
+static uint64_t measure(uint64_t now, uint64_t read, uint64_t flip, uint64_t vsync) {
+	now = press(now);
+	Latency_seen(now + read);
+	TEST_ASSERT_EQUAL_INT(1, Latency_markFrame());
+	Latency_flipStart(now + flip);
+	Latency_flipEnd(now + vsync);
+	return now + vsync;
+}
+
+///////////////////////////////
+// Schedule Tests
+///////////////////////////////
+
+void test_Latency_is_active_after_start(void) {
+	TEST_ASSERT_EQUAL_INT(1, Latency_isActive());
+	TEST_ASSERT_EQUAL_INT(0, Latency_isDone());
+}
+
+void test_Latency_poll_waits_for_the_gap(void) {
+	TEST_ASSERT_EQUAL_INT(0, Latency_poll(START));
+	TEST_ASSERT_EQUAL_INT(0, Latency_poll(START + LATENCY_GAP_MS * MS - 1));
+	TEST_ASSERT_EQUAL_INT(1, Latency_poll(START + LATENCY_GAP_MS * MS));
+}
+
+void test_Latency_poll_holds_until_flipped(void) {
+	uint64_t now = press(START);
+	TEST_ASSERT_EQUAL_INT(1, Latency_poll(now + 16 * MS));
+
+	Latency_seen(now + 17 * MS);
+	TEST_ASSERT_EQUAL_INT(1, Latency_poll(now + 33 * MS));
+	Latency_markFrame();
+	Latency_flipStart(now + 34 * MS);
+	Latency_flipEnd(now + 40 * MS);
+
+	TEST_ASSERT_EQUAL_INT(0, Latency_poll(now + 50 * MS));
+}
+
+void test_Latency_next_press_is_jittered_after_the_gap(void) {
+	uint64_t end = measure(START, 1 * MS, 2 * MS, 3 * MS);
+
+	uint64_t next = press(end);
+	TEST_ASSERT_TRUE(next >= end + LATENCY_GAP_MS * MS);
+	TEST_ASSERT_TRUE(next <= end + (LATENCY_GAP_MS + LATENCY_JITTER_MS) * MS);
+}
+
+///////////////////////////////
+// Marker Tests
+///////////////////////////////
+
+void test_Latency_markFrame_needs_a_read(void) {
+	press(START);
+	TEST_ASSERT_EQUAL_INT(0, Latency_markFrame());
+}
+
+void test_Latency_markFrame_marks_one_frame_per_press(void) {
+	uint64_t now = press(START);
+	Latency_seen(now);
+	Latency_seen(now + 5 * MS);
+	TEST_ASSERT_EQUAL_INT(1, Latency_markFrame());
+	TEST_ASSERT_EQUAL_INT(0, Latency_markFrame());
+}
+
+void test_Latency_ignores_flips_of_unmarked_frames(void) {
+	uint64_t now = press(START);
+	Latency_flipStart(now + 1 * MS);
+	Latency_flipEnd(now + 2 * MS);
+
+	LatencyStats stats;
+	Latency_getStats(LATENCY_VSYNC, &stats);
+	TEST_ASSERT_EQUAL_INT(0, stats.count);
+}
+
+///////////////////////////////
+// Measurement Tests
+///////////////////////////////
+
+void test_Latency_times_each_stage_from_the_press(void) {
+	// Polled 4ms late: the press still counts from when it was due
+	uint64_t due = START + LATENCY_GAP_MS * MS;
+	TEST_ASSERT_EQUAL_INT(1, Latency_poll(due + 4 * MS));
+	Latency_seen(due + 6 * MS);
+	Latency_markFrame();
+	Latency_flipStart(due + 20 * MS);
+	Latency_flipEnd(due + 33 * MS);
+
+	LatencyStats stats;
+	Latency_getStats(LATENCY_SEEN, &stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.count);
+	TEST_ASSERT_EQUAL_UINT32(6000, stats.min);
+	Latency_getStats(LATENCY_FLIP, &stats);
+	TEST_ASSERT_EQUAL_UINT32(20000, stats.median);
+	Latency_getStats(LATENCY_VSYNC, &stats);
+	TEST_ASSERT_EQUAL_UINT32(33000, stats.max);
+}
+
+void test_Latency_getStats_reports_distribution(void) {
+	Latency_start(5, START);
+	uint64_t now = START;
+	now = measure(now, 1 * MS, 2 * MS, 30 * MS);
+	now = measure(now, 1 * MS, 2 * MS, 10 * MS);
+	now = measure(now, 1 * MS, 2 * MS, 50 * MS);
+	now = measure(now, 1 * MS, 2 * MS, 20 * MS);
+	now = measure(now, 1 * MS, 2 * MS, 40 * MS);
+
+	LatencyStats stats;
+	Latency_getStats(LATENCY_VSYNC, &stats);
+	TEST_ASSERT_EQUAL_INT(5, stats.count);
+	TEST_ASSERT_EQUAL_UINT32(10000, stats.min);
+	TEST_ASSERT_EQUAL_UINT32(30000, stats.median);
+	TEST_ASSERT_EQUAL_UINT32(50000, stats.p95);
+	TEST_ASSERT_EQUAL_UINT32(50000, stats.max);
+	TEST_ASSERT_EQUAL_UINT32(30000, stats.mean);
+}
+
+void test_Latency_times_out_unread_press(void) {
+	uint64_t now = press(START);
+	TEST_ASSERT_EQUAL_INT(1, Latency_poll(now + LATENCY_TIMEOUT_MS * MS));
+	TEST_ASSERT_EQUAL_INT(0, Latency_poll(now + LATENCY_TIMEOUT_MS * MS + 1));
+	TEST_ASSERT_EQUAL_INT(1, Latency_getMisses());
+
+	// A late read of the released press doesn't count
+	Latency_seen(now + LATENCY_TIMEOUT_MS * MS + 2);
+	TEST_ASSERT_EQUAL_INT(0, Latency_markFrame());
+}
+
+void test_Latency_is_done_after_requested_presses(void) {
+	uint64_t now = START;
+	now = measure(now, 1 * MS, 2 * MS, 3 * MS);
+	now = measure(now, 1 * MS, 2 * MS, 3 * MS);
+	TEST_ASSERT_EQUAL_INT(0, Latency_isDone());
+	now = measure(now, 1 * MS, 2 * MS, 3 * MS);
+
+	TEST_ASSERT_EQUAL_INT(1, Latency_isDone());
+	TEST_ASSERT_EQUAL_INT(0, Latency_isActive());
+	TEST_ASSERT_EQUAL_INT(0, Latency_poll(now + 10000 * MS));
+}
+
+void test_Latency_misses_count_toward_the_run(void) {
+	uint64_t now = START;
+	for (int i = 0; i < 3; i++) {
+		now = press(now);
+		now += LATENCY_TIMEOUT_MS * MS + 1;
+		Latency_poll(now);
+	}
+	TEST_ASSERT_EQUAL_INT(1, Latency_isDone());
+	TEST_ASSERT_EQUAL_INT(3, Latency_getMisses());
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Schedule
+	RUN_TEST(test_Latency_is_active_after_start);
+	RUN_TEST(test_Latency_poll_waits_for_the_gap);
+	RUN_TEST(test_Latency_poll_holds_until_flipped);
+	RUN_TEST(test_Latency_next_press_is_jittered_after_the_gap);
+
+	// Marker
+	RUN_TEST(test_Latency_markFrame_needs_a_read);
+	RUN_TEST(test_Latency_markFrame_marks_one_frame_per_press);
+	RUN_TEST(test_Latency_ignores_flips_of_unmarked_frames);
+
+	// Measurement
+	RUN_TEST(test_Latency_times_each_stage_from_the_press);
+	RUN_TEST(test_Latency_getStats_reports_distribution);
+	RUN_TEST(test_Latency_times_out_unread_press);
+	RUN_TEST(test_Latency_is_done_after_requested_presses);
+	RUN_TEST(test_Latency_misses_count_toward_the_run);
+
+	return UNITY_END();
+}
@@ -7,6 +7,9 @@
  * - errno translation
  * - File rotation
  * - Thread safety
+ * - Runtime level filtering
+ * - Asynchronous writer thread
+ * - Timeline tracing (Chrome trace-event output)
  */
 
 #include "unity.h"
@@ -14,6 +17,7 @@
 #include "../../../../workspace/all/common/log_internal.h"
 #include <errno.h>
 #include <pthread.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -30,6 +34,7 @@ void setUp(void) {
 	unlink("/tmp/test_log.log.1");
 	unlink("/tmp/test_log.log.2");
 	unlink("/tmp/test_log.log.3");
+	unlink("/tmp/test_trace.json");
 }
 
 void tearDown(void) {
@@ -38,6 +43,7 @@ void tearDown(void) {
 	unlink("/tmp/test_log.log.1");
 	unlink("/tmp/test_log.log.2");
 	unlink("/tmp/test_log.log.3");
+	unlink("/tmp/test_trace.json");
 }
 
 ///////////////////////////////
@@ -454,6 +460,270 @@ void test_log_levels_in_output(void) {
 	free(content);
 }
 
+///////////////////////////////
+// Runtime Level Tests
+///////////////////////////////
+
+static int argument_evaluations;
+
+static int count_evaluation(void) {
+	argument_evaluations += 1;
+	return 0;
+}
+
+void test_log_disabled_level_skips_arguments(void) {
+	argument_evaluations = 0;
+	log_set_level(LOG_LEVEL_ERROR);
+	LOG_warn("skipped %d", count_evaluation());
+	log_set_level(LOG_LEVEL_DEBUG);
+
+	TEST_ASSERT_EQUAL(0, argument_evaluations);
+}
+
+void test_log_set_level_clamps(void) {
+	log_set_level((LogLevel)99);
+	TEST_ASSERT_EQUAL(LOG_LEVEL_DEBUG, log_level);
+	log_set_level((LogLevel)-1);
+	TEST_ASSERT_EQUAL(LOG_LEVEL_ERROR, log_level);
+	log_set_level(LOG_LEVEL_DEBUG);
+}
+
+///////////////////////////////
+// Asynchronous Output Tests
+///////////////////////////////
+
+void test_log_async_flush_writes_queued_lines(void) {
+	TEST_ASSERT_TRUE(log_async_start());
+	LogFile* lf = log_file_open("/tmp/test_log.log", 0, 0);
+	TEST_ASSERT_NOT_NULL(lf);
+
+	for (int i = 0; i < 100; i++)
+		log_file_write(lf, LOG_LEVEL_INFO, "Line %d", i);
+	log_async_flush();
+
+	TEST_ASSERT_EQUAL(100, count_lines("/tmp/test_log.log"));
+
+	log_file_close(lf);
+	log_async_stop();
+}
+
+void test_log_async_close_writes_pending_lines(void) {
+	TEST_ASSERT_TRUE(log_async_start());
+	LogFile* lf = log_file_open("/tmp/test_log.log", 0, 0);
+	TEST_ASSERT_NOT_NULL(lf);
+
+	log_file_write(lf, LOG_LEVEL_INFO, "First");
+	log_file_write(lf, LOG_LEVEL_DEBUG, "Second");
+	log_file_close(lf);
+
+	char* content = read_file("/tmp/test_log.log");
+	TEST_ASSERT_NOT_NULL(content);
+	char* first = strstr(content, "First\n");
+	char* second = strstr(content, "Second\n");
+	TEST_ASSERT_NOT_NULL(first);
+	TEST_ASSERT_NOT_NULL(second);
+	TEST_ASSERT_TRUE(first < second);
+	free(content);
+
+	log_async_stop();
+}
+
+void test_log_async_error_written_before_return(void) {
+	TEST_ASSERT_TRUE(log_async_start());
+	LogFile* lf = log_file_open("/tmp/test_log.log", 0, 0);
+	TEST_ASSERT_NOT_NULL(lf);
+
+	log_file_write(lf, LOG_LEVEL_INFO, "Before");
+	log_file_write(lf, LOG_LEVEL_ERROR, "Failure");
+
+	// No flush: the error must already be on disk, after the queued line
+	char* content = read_file("/tmp/test_log.log");
+	TEST_ASSERT_NOT_NULL(content);
+	char* before = strstr(content, "Before");
+	char* failure = strstr(content, "Failure");
+	TEST_ASSERT_NOT_NULL(before);
+	TEST_ASSERT_NOT_NULL(failure);
+	TEST_ASSERT_TRUE(before < failure);
+	free(content);
+
+	log_file_close(lf);
+	log_async_stop();
+}
+
+void test_log_async_thread_safety(void) {
+	TEST_ASSERT_TRUE(log_async_start());
+	LogFile* lf = log_file_open("/tmp/test_log.log", 0, 0);
+	TEST_ASSERT_NOT_NULL(lf);
+
+	pthread_t threads[THREAD_COUNT];
+	ThreadData thread_data[THREAD_COUNT];
+	for (int i = 0; i < THREAD_COUNT; i++) {
+		thread_data[i].lf = lf;
+		thread_data[i].thread_id = i;
+		pthread_create(&threads[i], NULL, thread_write_logs, &thread_data[i]);
+	}
+	for (int i = 0; i < THREAD_COUNT; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	log_file_close(lf);
+	log_async_stop();
+
+	TEST_ASSERT_EQUAL(THREAD_COUNT * MESSAGES_PER_THREAD, count_lines("/tmp/test_log.log"));
+}
+
+void test_log_async_rotation(void) {
+	TEST_ASSERT_TRUE(log_async_start());
+	LogFile* lf = log_file_open("/tmp/test_log.log", 200, 2);
+	TEST_ASSERT_NOT_NULL(lf);
+
+	for (int i = 0; i < 20; i++)
+		log_file_write(lf, LOG_LEVEL_INFO, "Rotating message number %d", i);
+	log_file_close(lf);
+	log_async_stop();
+
+	TEST_ASSERT_TRUE(access("/tmp/test_log.log.1", F_OK) == 0);
+	TEST_ASSERT_TRUE(get_file_size("/tmp/test_log.log") <= 200);
+	TEST_ASSERT_TRUE(get_file_size("/tmp/test_log.log.1") <= 200);
+}
+
+void test_log_async_stop_returns_to_sync(void) {
+	TEST_ASSERT_TRUE(log_async_start());
+	log_async_stop();
+
+	LogFile* lf = log_file_open("/tmp/test_log.log", 0, 0);
+	TEST_ASSERT_NOT_NULL(lf);
+	log_file_write(lf, LOG_LEVEL_INFO, "Direct");
+
+	// Written on this thread, so visible without a flush
+	TEST_ASSERT_EQUAL(1, count_lines("/tmp/test_log.log"));
+
+	log_file_close(lf);
+}
+
+///////////////////////////////
+// Tracing Tests
+///////////////////////////////
+
+/**
+ * Counts non-overlapping occurrences of needle in haystack.
+ */
+static int count_occurrences(const char* haystack, const char* needle) {
+	int count = 0;
+	for (const char* p = strstr(haystack, needle); p; p = strstr(p + strlen(needle), needle))
+		count += 1;
+	return count;
+}
+
+// Must run before anything calls trace_start()
+void test_trace_disabled_records_nothing(void) {
+	TEST_ASSERT_EQUAL_INT(0, trace_enabled);
+	TRACE_begin("disabled");
+	trace_flush();
+
+	TEST_ASSERT_NULL(read_file("/tmp/test_trace.json"));
+}
+
+void test_trace_flush_writes_chrome_json(void) {
+	trace_start("/tmp/test_trace.json", "test");
+	TEST_ASSERT_EQUAL_INT(1, trace_enabled);
+
+	TRACE_begin("alpha");
+	TRACE_end("alpha");
+	TRACE_instant("mark");
+	trace_flush();
+
+	char* content = read_file("/tmp/test_trace.json");
+	TEST_ASSERT_NOT_NULL(content);
+	TEST_ASSERT_EQUAL_INT(0, strncmp(content, "[\n", 2));
+	TEST_ASSERT_NOT_NULL(strstr(content, "{\"name\":\"alpha\",\"ph\":\"B\",\"ts\":"));
+	TEST_ASSERT_NOT_NULL(strstr(content, "{\"name\":\"alpha\",\"ph\":\"E\",\"ts\":"));
+	TEST_ASSERT_NOT_NULL(strstr(content, "{\"name\":\"mark\",\"ph\":\"i\""));
+	TEST_ASSERT_NOT_NULL(strstr(content, "\"args\":{\"name\":\"test\"}"));
+	TEST_ASSERT_NULL(strstr(content, "disabled"));
+	free(content);
+}
+
+void test_trace_flush_only_writes_new_events(void) {
+	TRACE_instant("first");
+	trace_flush();
+	TRACE_instant("second");
+	trace_flush();
+
+	char* content = read_file("/tmp/test_trace.json");
+	TEST_ASSERT_NOT_NULL(content);
+	TEST_ASSERT_EQUAL_INT(1, count_occurrences(content, "\"first\""));
+	TEST_ASSERT_EQUAL_INT(1, count_occurrences(content, "\"second\""));
+	TEST_ASSERT_EQUAL_INT(1, count_occurrences(content, "[\n"));
+	free(content);
+}
+
+void test_trace_timestamps_are_ordered(void) {
+	TRACE_begin("span");
+	usleep(2000);
+	TRACE_end("span");
+	trace_flush();
+
+	char* content = read_file("/tmp/test_trace.json");
+	TEST_ASSERT_NOT_NULL(content);
+	char* begin = strstr(content, "\"ph\":\"B\",\"ts\":");
+	char* end = strstr(content, "\"ph\":\"E\",\"ts\":");
+	TEST_ASSERT_NOT_NULL(begin);
+	TEST_ASSERT_NOT_NULL(end);
+
+	unsigned long long begin_ts = strtoull(begin + 16, NULL, 10);
+	unsigned long long end_ts = strtoull(end + 16, NULL, 10);
+	TEST_ASSERT_TRUE(end_ts >= begin_ts + 2000);
+	free(content);
+}
+
+static void* trace_thread_func(void* arg) {
+	TRACE_instant("from_thread");
+	return NULL;
+}
+
+void test_trace_threads_record_separately(void) {
+	pthread_t thread;
+	pthread_create(&thread, NULL, trace_thread_func, NULL);
+	pthread_join(thread, NULL);
+	TRACE_instant("from_main");
+	trace_flush();
+
+	char* content = read_file("/tmp/test_trace.json");
+	TEST_ASSERT_NOT_NULL(content);
+	char* thread_event = strstr(content, "\"from_thread\"");
+	char* main_event = strstr(content, "\"from_main\"");
+	TEST_ASSERT_NOT_NULL(thread_event);
+	TEST_ASSERT_NOT_NULL(main_event);
+
+	char* thread_tid = strstr(thread_event, "\"tid\":");
+	char* main_tid = strstr(main_event, "\"tid\":");
+	TEST_ASSERT_TRUE(atoi(thread_tid + 6) != atoi(main_tid + 6));
+	free(content);
+}
+
+void test_trace_ring_keeps_newest_events(void) {
+	TRACE_instant("oldest");
+	for (int i = 0; i < TRACE_BUFFER_EVENTS; i++)
+		TRACE_instant("filler");
+	trace_flush();
+
+	char* content = read_file("/tmp/test_trace.json");
+	TEST_ASSERT_NOT_NULL(content);
+	TEST_ASSERT_NULL(strstr(content, "\"oldest\""));
+	TEST_ASSERT_EQUAL_INT(TRACE_BUFFER_EVENTS, count_occurrences(content, "\"filler\""));
+	free(content);
+}
+
+void test_trace_flushes_on_sigusr1(void) {
+	TRACE_instant("signalled");
+	raise(SIGUSR1);
+
+	char* content = read_file("/tmp/test_trace.json");
+	TEST_ASSERT_NOT_NULL(content);
+	TEST_ASSERT_NOT_NULL(strstr(content, "\"signalled\""));
+	free(content);
+}
+
 ///////////////////////////////
 // Main Test Runner
 ///////////////////////////////
@@ -494,5 +764,26 @@ int main(void) {
 	RUN_TEST(test_log_errno_includes_error_message);
 	RUN_TEST(test_log_levels_in_output);
 
+	// Runtime level tests
+	RUN_TEST(test_log_disabled_level_skips_arguments);
+	RUN_TEST(test_log_set_level_clamps);
+
+	// Asynchronous output tests
+	RUN_TEST(test_log_async_flush_writes_queued_lines);
+	RUN_TEST(test_log_async_close_writes_pending_lines);
+	RUN_TEST(test_log_async_error_written_before_return);
+	RUN_TEST(test_log_async_thread_safety);
+	RUN_TEST(test_log_async_rotation);
+	RUN_TEST(test_log_async_stop_returns_to_sync);
+
+	// Tracing tests (order matters: tracing can't be turned off once started)
+	RUN_TEST(test_trace_disabled_records_nothing);
+	RUN_TEST(test_trace_flush_writes_chrome_json);
+	RUN_TEST(test_trace_flush_only_writes_new_events);
+	RUN_TEST(test_trace_timestamps_are_ordered);
+	RUN_TEST(test_trace_threads_record_separately);
+	RUN_TEST(test_trace_ring_keeps_newest_events);
+	RUN_TEST(test_trace_flushes_on_sigusr1);
+
 	return UNITY_END();
 }
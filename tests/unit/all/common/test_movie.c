@@ -0,0 +1,206 @@
+/**
+ * test_movie.c - Tests for input movie recording and playback
+ *
+ * Records into a temp file and plays it back.
+ *
+ * Test coverage:
+ * - Movie_startRecording/recordFrame/stop - File layout and run-length encoding
+ * - Movie_startPlayback/playFrame - Same input back, then end of movie
+ * - Movie_getState - Starting state round trip
+ * - Truncated and invalid files
+ */
+
+#define _DEFAULT_SOURCE // mkstemp
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/movie.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char path[] = "/tmp/movie_XXXXXX";
+
+void setUp(void) {
+	strcpy(path, "/tmp/movie_XXXXXX");
+	int fd = mkstemp(path);
+	TEST_ASSERT_TRUE(fd >= 0);
+	close(fd);
+}
+
+void tearDown(void) {
+	Movie_stop();
+	unlink(path);
+}
+
+static MovieInput input(uint32_t buttons, int16_t lx) {
+	MovieInput in = {.buttons = buttons, .axes = {lx, 0, 0, 0}};
+	return in;
+}
+
+static long file_size(void) {
+	FILE* file = fopen(path, "rb");
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fclose(file);
+	return size;
+}
+
+static void record(const MovieInput* inputs, int count) {
+	TEST_ASSERT_EQUAL_INT(0, Movie_startRecording(path, NULL, 0));
+	for (int i = 0; i < count; i++)
+		Movie_recordFrame(&inputs[i]);
+	Movie_stop();
+}
+
+///////////////////////////////
+// Recording Tests
+///////////////////////////////
+
+void test_Movie_records_header_with_frame_count(void) {
+	MovieInput inputs[] = {input(1, 0), input(2, 0)};
+	record(inputs, 2);
+
+	FILE* file = fopen(path, "rb");
+	MovieHeader header;
+	TEST_ASSERT_EQUAL_INT(1, fread(&header, sizeof(header), 1, file));
+	fclose(file);
+	TEST_ASSERT_EQUAL_HEX32(MOVIE_MAGIC, header.magic);
+	TEST_ASSERT_EQUAL_UINT32(MOVIE_VERSION, header.version);
+	TEST_ASSERT_EQUAL_UINT32(2, header.frames);
+	TEST_ASSERT_EQUAL_UINT32(0, header.state_size);
+}
+
+void test_Movie_repeated_input_is_one_run(void) {
+	MovieInput inputs[100];
+	for (int i = 0; i < 100; i++)
+		inputs[i] = input(i < 60 ? 0 : 4, 0);
+	record(inputs, 100);
+
+	TEST_ASSERT_EQUAL_INT(sizeof(MovieHeader) + 2 * sizeof(MovieRun), file_size());
+}
+
+void test_Movie_axis_change_starts_a_run(void) {
+	MovieInput inputs[] = {input(0, 0), input(0, 100), input(0, 100)};
+	record(inputs, 3);
+
+	TEST_ASSERT_EQUAL_INT(sizeof(MovieHeader) + 2 * sizeof(MovieRun), file_size());
+}
+
+void test_Movie_recordFrame_ignored_when_not_recording(void) {
+	MovieInput in = input(1, 0);
+	Movie_recordFrame(&in);
+	TEST_ASSERT_EQUAL_INT(0, Movie_isRecording());
+}
+
+void test_Movie_startRecording_fails_for_bad_path(void) {
+	TEST_ASSERT_EQUAL_INT(-1, Movie_startRecording("/nonexistent/dir/game.mov", NULL, 0));
+	TEST_ASSERT_EQUAL_INT(0, Movie_isRecording());
+}
+
+///////////////////////////////
+// Playback Tests
+///////////////////////////////
+
+void test_Movie_plays_back_recorded_input(void) {
+	MovieInput inputs[] = {input(1, 0), input(1, 0), input(8, -300), input(0, 0)};
+	record(inputs, 4);
+
+	TEST_ASSERT_EQUAL_INT(0, Movie_startPlayback(path));
+	TEST_ASSERT_EQUAL_INT(1, Movie_isPlaying());
+	TEST_ASSERT_EQUAL_UINT32(4, Movie_getFrameCount());
+
+	MovieInput in;
+	for (int i = 0; i < 4; i++) {
+		TEST_ASSERT_EQUAL_INT(1, Movie_playFrame(&in));
+		TEST_ASSERT_EQUAL_UINT32(inputs[i].buttons, in.buttons);
+		TEST_ASSERT_EQUAL_INT16(inputs[i].axes[0], in.axes[0]);
+	}
+	TEST_ASSERT_EQUAL_INT(0, Movie_playFrame(&in));
+	TEST_ASSERT_EQUAL_UINT32(4, Movie_getFrame());
+}
+
+void test_Movie_state_round_trips(void) {
+	char state[] = "emulator state";
+	TEST_ASSERT_EQUAL_INT(0, Movie_startRecording(path, state, sizeof(state)));
+	MovieInput in = input(1, 0);
+	Movie_recordFrame(&in);
+	Movie_stop();
+
+	TEST_ASSERT_EQUAL_INT(0, Movie_startPlayback(path));
+	size_t size;
+	const void* loaded = Movie_getState(&size);
+	TEST_ASSERT_EQUAL_INT(sizeof(state), size);
+	TEST_ASSERT_EQUAL_MEMORY(state, loaded, sizeof(state));
+	TEST_ASSERT_EQUAL_INT(1, Movie_playFrame(&in));
+}
+
+void test_Movie_without_state_has_none(void) {
+	MovieInput inputs[] = {input(1, 0)};
+	record(inputs, 1);
+
+	TEST_ASSERT_EQUAL_INT(0, Movie_startPlayback(path));
+	size_t size;
+	TEST_ASSERT_NULL(Movie_getState(&size));
+	TEST_ASSERT_EQUAL_INT(0, size);
+}
+
+void test_Movie_plays_unfinished_recording(void) {
+	// Simulate a crash: the header never gets its frame count and the
+	// last run is only partly written
+	MovieInput inputs[] = {input(1, 0), input(2, 0), input(3, 0)};
+	record(inputs, 3);
+	truncate(path, file_size() - sizeof(MovieRun) / 2);
+
+	TEST_ASSERT_EQUAL_INT(0, Movie_startPlayback(path));
+	TEST_ASSERT_EQUAL_UINT32(2, Movie_getFrameCount());
+}
+
+void test_Movie_rejects_other_files(void) {
+	FILE* file = fopen(path, "wb");
+	fputs("not a movie at all", file);
+	fclose(file);
+
+	TEST_ASSERT_EQUAL_INT(-1, Movie_startPlayback(path));
+	TEST_ASSERT_EQUAL_INT(0, Movie_isPlaying());
+}
+
+void test_Movie_rejects_truncated_state(void) {
+	char state[64] = {0};
+	TEST_ASSERT_EQUAL_INT(0, Movie_startRecording(path, state, sizeof(state)));
+	Movie_stop();
+	truncate(path, sizeof(MovieHeader) + 10);
+
+	TEST_ASSERT_EQUAL_INT(-1, Movie_startPlayback(path));
+}
+
+void test_Movie_startPlayback_fails_for_missing_file(void) {
+	unlink(path);
+	TEST_ASSERT_EQUAL_INT(-1, Movie_startPlayback(path));
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Recording
+	RUN_TEST(test_Movie_records_header_with_frame_count);
+	RUN_TEST(test_Movie_repeated_input_is_one_run);
+	RUN_TEST(test_Movie_axis_change_starts_a_run);
+	RUN_TEST(test_Movie_recordFrame_ignored_when_not_recording);
+	RUN_TEST(test_Movie_startRecording_fails_for_bad_path);
+
+	// Playback
+	RUN_TEST(test_Movie_plays_back_recorded_input);
+	RUN_TEST(test_Movie_state_round_trips);
+	RUN_TEST(test_Movie_without_state_has_none);
+	RUN_TEST(test_Movie_plays_unfinished_recording);
+	RUN_TEST(test_Movie_rejects_other_files);
+	RUN_TEST(test_Movie_rejects_truncated_state);
+	RUN_TEST(test_Movie_startPlayback_fails_for_missing_file);
+
+	return UNITY_END();
+}
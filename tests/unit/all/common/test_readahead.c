@@ -0,0 +1,211 @@
+/**
+ * test_readahead.c - Tests for ROM and core readahead
+ *
+ * Uses real files in a temp directory. The page cache itself can't be
+ * observed from here, so Readahead_file is checked through the number of
+ * bytes it reports and how it responds to cancellation.
+ *
+ * Test coverage:
+ * - Readahead_file - Size limits, missing files, cancellation
+ * - Readahead_getEmuExe - Parsing emulator pak launch scripts
+ * - Readahead_getCueFiles - Parsing cue sheet FILE entries
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/readahead.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char temp_dir[] = "/tmp/readahead_XXXXXX";
+static char file_path[READAHEAD_PATH_MAX];
+
+static void write_file(const char* path, const char* contents) {
+	FILE* file = fopen(path, "w");
+	TEST_ASSERT_NOT_NULL(file);
+	fputs(contents, file);
+	fclose(file);
+}
+
+static void write_zeros(const char* path, size_t size) {
+	FILE* file = fopen(path, "wb");
+	TEST_ASSERT_NOT_NULL(file);
+	char block[4096] = {0};
+	while (size > 0) {
+		size_t count = size < sizeof(block) ? size : sizeof(block);
+		fwrite(block, 1, count, file);
+		size -= count;
+	}
+	fclose(file);
+}
+
+static int cancel_after_calls;
+
+static int cancel_after(void* userdata) {
+	int* calls = userdata;
+	*calls += 1;
+	return *calls > cancel_after_calls;
+}
+
+void setUp(void) {
+	strcpy(temp_dir, "/tmp/readahead_XXXXXX");
+	TEST_ASSERT_NOT_NULL(mkdtemp(temp_dir));
+	snprintf(file_path, sizeof(file_path), "%s/file", temp_dir);
+}
+
+void tearDown(void) {
+	unlink(file_path);
+	rmdir(temp_dir);
+}
+
+///////////////////////////////
+// Readahead_file Tests
+///////////////////////////////
+
+void test_Readahead_file_reads_whole_small_file(void) {
+	write_zeros(file_path, 10000);
+	TEST_ASSERT_EQUAL_INT64(10000, Readahead_file(file_path, 1024 * 1024, NULL, NULL));
+}
+
+void test_Readahead_file_stops_at_max_bytes(void) {
+	write_zeros(file_path, READAHEAD_CHUNK_SIZE * 2);
+	TEST_ASSERT_EQUAL_INT64(4096, Readahead_file(file_path, 4096, NULL, NULL));
+}
+
+void test_Readahead_file_missing_file(void) {
+	TEST_ASSERT_EQUAL_INT64(-1, Readahead_file("/nonexistent/rom.gb", 4096, NULL, NULL));
+}
+
+void test_Readahead_file_empty_file(void) {
+	write_zeros(file_path, 0);
+	TEST_ASSERT_EQUAL_INT64(0, Readahead_file(file_path, 4096, NULL, NULL));
+}
+
+void test_Readahead_file_cancelled_before_start(void) {
+	write_zeros(file_path, 10000);
+	int calls = 0;
+	cancel_after_calls = 0;
+	TEST_ASSERT_EQUAL_INT64(0, Readahead_file(file_path, 1024 * 1024, cancel_after, &calls));
+	TEST_ASSERT_EQUAL_INT(1, calls);
+}
+
+void test_Readahead_file_cancelled_between_chunks(void) {
+	write_zeros(file_path, READAHEAD_CHUNK_SIZE * 3);
+	int calls = 0;
+	cancel_after_calls = 1;
+	TEST_ASSERT_EQUAL_INT64(READAHEAD_CHUNK_SIZE,
+	                        Readahead_file(file_path, READAHEAD_CHUNK_SIZE * 3, cancel_after, &calls));
+	TEST_ASSERT_EQUAL_INT(2, calls);
+}
+
+///////////////////////////////
+// Readahead_getEmuExe Tests
+///////////////////////////////
+
+void test_Readahead_getEmuExe_reads_template_line(void) {
+	write_file(file_path, "#!/bin/sh\n\nEMU_EXE=gambatte\n"
+	                      "###############################\n");
+	char exe[64];
+	TEST_ASSERT_TRUE(Readahead_getEmuExe(file_path, exe, sizeof(exe)));
+	TEST_ASSERT_EQUAL_STRING("gambatte", exe);
+}
+
+void test_Readahead_getEmuExe_strips_trailing_comment(void) {
+	write_file(file_path, "EMU_EXE=pcsx_rearmed # PS\r\n");
+	char exe[64];
+	TEST_ASSERT_TRUE(Readahead_getEmuExe(file_path, exe, sizeof(exe)));
+	TEST_ASSERT_EQUAL_STRING("pcsx_rearmed", exe);
+}
+
+void test_Readahead_getEmuExe_missing_line(void) {
+	write_file(file_path, "#!/bin/sh\n./custom.elf \"$1\"\n");
+	char exe[64];
+	TEST_ASSERT_FALSE(Readahead_getEmuExe(file_path, exe, sizeof(exe)));
+}
+
+void test_Readahead_getEmuExe_missing_file(void) {
+	char exe[64];
+	TEST_ASSERT_FALSE(Readahead_getEmuExe("/nonexistent/launch.sh", exe, sizeof(exe)));
+}
+
+///////////////////////////////
+// Readahead_getCueFiles Tests
+///////////////////////////////
+
+void test_Readahead_getCueFiles_resolves_relative_tracks(void) {
+	write_file(file_path, "FILE \"Game (Track 1).bin\" BINARY\n"
+	                      "  TRACK 01 MODE2/2352\n"
+	                      "    INDEX 01 00:00:00\n"
+	                      "FILE \"Game (Track 2).bin\" BINARY\n"
+	                      "  TRACK 02 AUDIO\n");
+	char files[4][READAHEAD_PATH_MAX];
+	TEST_ASSERT_EQUAL_INT(2, Readahead_getCueFiles(file_path, files, 4));
+
+	char expected[READAHEAD_PATH_MAX];
+	snprintf(expected, sizeof(expected), "%s/Game (Track 1).bin", temp_dir);
+	TEST_ASSERT_EQUAL_STRING(expected, files[0]);
+	snprintf(expected, sizeof(expected), "%s/Game (Track 2).bin", temp_dir);
+	TEST_ASSERT_EQUAL_STRING(expected, files[1]);
+}
+
+void test_Readahead_getCueFiles_unquoted_and_lowercase(void) {
+	write_file(file_path, "file game.bin BINARY\r\n");
+	char files[4][READAHEAD_PATH_MAX];
+	TEST_ASSERT_EQUAL_INT(1, Readahead_getCueFiles(file_path, files, 4));
+
+	char expected[READAHEAD_PATH_MAX];
+	snprintf(expected, sizeof(expected), "%s/game.bin", temp_dir);
+	TEST_ASSERT_EQUAL_STRING(expected, files[0]);
+}
+
+void test_Readahead_getCueFiles_keeps_absolute_paths(void) {
+	write_file(file_path, "FILE \"/mnt/SDCARD/Roms/PS/game.bin\" BINARY\n");
+	char files[4][READAHEAD_PATH_MAX];
+	TEST_ASSERT_EQUAL_INT(1, Readahead_getCueFiles(file_path, files, 4));
+	TEST_ASSERT_EQUAL_STRING("/mnt/SDCARD/Roms/PS/game.bin", files[0]);
+}
+
+void test_Readahead_getCueFiles_respects_max(void) {
+	write_file(file_path, "FILE \"a.bin\" BINARY\nFILE \"b.bin\" BINARY\nFILE \"c.bin\" BINARY\n");
+	char files[2][READAHEAD_PATH_MAX];
+	TEST_ASSERT_EQUAL_INT(2, Readahead_getCueFiles(file_path, files, 2));
+}
+
+void test_Readahead_getCueFiles_ignores_other_commands(void) {
+	write_file(file_path, "REM FILE \"fake.bin\"\nFILES\nCATALOG 0000000000000\n");
+	char files[4][READAHEAD_PATH_MAX];
+	TEST_ASSERT_EQUAL_INT(0, Readahead_getCueFiles(file_path, files, 4));
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Readahead_file
+	RUN_TEST(test_Readahead_file_reads_whole_small_file);
+	RUN_TEST(test_Readahead_file_stops_at_max_bytes);
+	RUN_TEST(test_Readahead_file_missing_file);
+	RUN_TEST(test_Readahead_file_empty_file);
+	RUN_TEST(test_Readahead_file_cancelled_before_start);
+	RUN_TEST(test_Readahead_file_cancelled_between_chunks);
+
+	// Readahead_getEmuExe
+	RUN_TEST(test_Readahead_getEmuExe_reads_template_line);
+	RUN_TEST(test_Readahead_getEmuExe_strips_trailing_comment);
+	RUN_TEST(test_Readahead_getEmuExe_missing_line);
+	RUN_TEST(test_Readahead_getEmuExe_missing_file);
+
+	// Readahead_getCueFiles
+	RUN_TEST(test_Readahead_getCueFiles_resolves_relative_tracks);
+	RUN_TEST(test_Readahead_getCueFiles_unquoted_and_lowercase);
+	RUN_TEST(test_Readahead_getCueFiles_keeps_absolute_paths);
+	RUN_TEST(test_Readahead_getCueFiles_respects_max);
+	RUN_TEST(test_Readahead_getCueFiles_ignores_other_commands);
+
+	return UNITY_END();
+}
@@ -0,0 +1,212 @@
+/**
+ * test_resident.c - Tests for the resident minarch launch protocol
+ *
+ * Runs both ends of the protocol in one process over socketpair() and a
+ * real Unix socket in a temp directory. Descriptor passing is checked by
+ * writing through the received descriptor and reading from the pipe it
+ * was created from.
+ *
+ * Test coverage:
+ * - Resident_listen/connect - Socket setup, missing host
+ * - Resident_sendRequest/recvRequest - Paths and descriptor passing
+ * - Resident_sendReply/recvReply - Reply round trip and EOF
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/resident.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static char temp_dir[] = "/tmp/resident_XXXXXX";
+static char socket_path[256];
+static int pair[2];
+
+void setUp(void) {
+	strcpy(temp_dir, "/tmp/resident_XXXXXX");
+	TEST_ASSERT_NOT_NULL(mkdtemp(temp_dir));
+	snprintf(socket_path, sizeof(socket_path), "%s/minarch.sock", temp_dir);
+	TEST_ASSERT_EQUAL_INT(0, socketpair(AF_UNIX, SOCK_STREAM, 0, pair));
+}
+
+void tearDown(void) {
+	close(pair[0]);
+	close(pair[1]);
+	unlink(socket_path);
+	rmdir(temp_dir);
+}
+
+static ResidentRequest make_request(int fd) {
+	ResidentRequest request;
+	memset(&request, 0, sizeof(request));
+	strcpy(request.core_path, "/mnt/SDCARD/.system/cores/a7/gambatte_libretro.so");
+	strcpy(request.rom_path, "/mnt/SDCARD/Roms/GB/Tetris.gb");
+	strcpy(request.cwd, "/mnt/SDCARD/.userdata/miyoomini");
+	request.priority = -5;
+	request.launch_us = 1234567890123ULL;
+	request.fds[0] = fd;
+	request.fds[1] = fd;
+	request.fds[2] = fd;
+	return request;
+}
+
+///////////////////////////////
+// Socket Tests
+///////////////////////////////
+
+void test_Resident_connect_without_host_fails(void) {
+	TEST_ASSERT_EQUAL_INT(-1, Resident_connect(socket_path));
+}
+
+void test_Resident_connect_to_listening_host(void) {
+	int listen_fd = Resident_listen(socket_path);
+	TEST_ASSERT_TRUE(listen_fd >= 0);
+
+	int client = Resident_connect(socket_path);
+	TEST_ASSERT_TRUE(client >= 0);
+
+	int host = accept(listen_fd, NULL, NULL);
+	TEST_ASSERT_TRUE(host >= 0);
+
+	TEST_ASSERT_TRUE(Resident_sendReply(host, RESIDENT_REPLY_STARTED, 42));
+	int32_t type, value;
+	TEST_ASSERT_TRUE(Resident_recvReply(client, &type, &value));
+	TEST_ASSERT_EQUAL_INT(RESIDENT_REPLY_STARTED, type);
+	TEST_ASSERT_EQUAL_INT(42, value);
+
+	close(host);
+	close(client);
+	close(listen_fd);
+}
+
+void test_Resident_listen_replaces_stale_socket(void) {
+	int first = Resident_listen(socket_path);
+	TEST_ASSERT_TRUE(first >= 0);
+	close(first); // host died without cleaning up
+
+	int second = Resident_listen(socket_path);
+	TEST_ASSERT_TRUE(second >= 0);
+	close(second);
+}
+
+void test_Resident_connect_to_stale_socket_fails(void) {
+	int listen_fd = Resident_listen(socket_path);
+	close(listen_fd);
+
+	TEST_ASSERT_EQUAL_INT(-1, Resident_connect(socket_path));
+}
+
+void test_Resident_listen_rejects_long_path(void) {
+	char long_path[256];
+	memset(long_path, 'a', sizeof(long_path) - 1);
+	long_path[0] = '/';
+	long_path[sizeof(long_path) - 1] = '\0';
+	TEST_ASSERT_EQUAL_INT(-1, Resident_listen(long_path));
+}
+
+///////////////////////////////
+// Request Tests
+///////////////////////////////
+
+void test_Resident_request_round_trip(void) {
+	int pipe_fds[2];
+	TEST_ASSERT_EQUAL_INT(0, pipe(pipe_fds));
+
+	ResidentRequest sent = make_request(pipe_fds[1]);
+	TEST_ASSERT_TRUE(Resident_sendRequest(pair[0], &sent));
+
+	ResidentRequest received;
+	TEST_ASSERT_TRUE(Resident_recvRequest(pair[1], &received));
+	TEST_ASSERT_EQUAL_STRING(sent.core_path, received.core_path);
+	TEST_ASSERT_EQUAL_STRING(sent.rom_path, received.rom_path);
+	TEST_ASSERT_EQUAL_STRING(sent.cwd, received.cwd);
+	TEST_ASSERT_EQUAL_INT(-5, received.priority);
+	TEST_ASSERT_TRUE(received.launch_us == sent.launch_us);
+
+	for (int i = 0; i < 3; i++)
+		TEST_ASSERT_TRUE(received.fds[i] >= 0);
+
+	close(pipe_fds[1]);
+	TEST_ASSERT_EQUAL_INT(5, write(received.fds[1], "hello", 5));
+
+	char buffer[8] = {0};
+	TEST_ASSERT_EQUAL_INT(5, read(pipe_fds[0], buffer, sizeof(buffer)));
+	TEST_ASSERT_EQUAL_STRING("hello", buffer);
+
+	for (int i = 0; i < 3; i++)
+		close(received.fds[i]);
+	close(pipe_fds[0]);
+}
+
+void test_Resident_recvRequest_fails_on_eof(void) {
+	close(pair[0]);
+	pair[0] = -1;
+
+	ResidentRequest received;
+	TEST_ASSERT_FALSE(Resident_recvRequest(pair[1], &received));
+	TEST_ASSERT_EQUAL_INT(-1, received.fds[0]);
+}
+
+void test_Resident_recvRequest_fails_on_truncated_request(void) {
+	TEST_ASSERT_EQUAL_INT(4, write(pair[0], "junk", 4));
+	close(pair[0]);
+	pair[0] = -1;
+
+	ResidentRequest received;
+	TEST_ASSERT_FALSE(Resident_recvRequest(pair[1], &received));
+}
+
+///////////////////////////////
+// Reply Tests
+///////////////////////////////
+
+void test_Resident_replies_arrive_in_order(void) {
+	Resident_sendReply(pair[0], RESIDENT_REPLY_STARTED, 1234);
+	Resident_sendReply(pair[0], RESIDENT_REPLY_EXITED, 0);
+
+	int32_t type, value;
+	TEST_ASSERT_TRUE(Resident_recvReply(pair[1], &type, &value));
+	TEST_ASSERT_EQUAL_INT(RESIDENT_REPLY_STARTED, type);
+	TEST_ASSERT_EQUAL_INT(1234, value);
+
+	TEST_ASSERT_TRUE(Resident_recvReply(pair[1], &type, &value));
+	TEST_ASSERT_EQUAL_INT(RESIDENT_REPLY_EXITED, type);
+	TEST_ASSERT_EQUAL_INT(0, value);
+}
+
+void test_Resident_recvReply_fails_on_eof(void) {
+	close(pair[0]);
+	pair[0] = -1;
+
+	int32_t type, value;
+	TEST_ASSERT_FALSE(Resident_recvReply(pair[1], &type, &value));
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Sockets
+	RUN_TEST(test_Resident_connect_without_host_fails);
+	RUN_TEST(test_Resident_connect_to_listening_host);
+	RUN_TEST(test_Resident_listen_replaces_stale_socket);
+	RUN_TEST(test_Resident_connect_to_stale_socket_fails);
+	RUN_TEST(test_Resident_listen_rejects_long_path);
+
+	// Requests
+	RUN_TEST(test_Resident_request_round_trip);
+	RUN_TEST(test_Resident_recvRequest_fails_on_eof);
+	RUN_TEST(test_Resident_recvRequest_fails_on_truncated_request);
+
+	// Replies
+	RUN_TEST(test_Resident_replies_arrive_in_order);
+	RUN_TEST(test_Resident_recvReply_fails_on_eof);
+
+	return UNITY_END();
+}
@@ -0,0 +1,741 @@
+/**
+ * test_scaler.c - Tests for the software pixel scalers
+ *
+ * Test coverage:
+ * - scaleBilinear_c32 - Fixed-point bilinear scaling against a float reference
+ * - scaleAA_c16 - Table-driven anti-aliased scaling against the original
+ *   per-pixel picoarch scaler (golden output)
+ * - scaleSharpBilinear_c16 - Fused sharp bilinear against an explicit
+ *   nearest neighbor prescale followed by a float bilinear pass
+ * - scaler_c16/c32 - Generated integer scalers for every factor up to
+ *   SCALER_MAX_FACTOR against a per-pixel nearest neighbor reference
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/scaler.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+/**
+ * Float bilinear scaler using the same source mapping (x * sw / dw).
+ */
+static void reference_bilinear(const uint32_t* src, int sw, int sh, uint32_t* dst, int dw,
+                               int dh) {
+	for (int y = 0; y < dh; y++) {
+		float sy = (float)y * sh / dh;
+		int y1 = (int)sy;
+		int y2 = y1 + 1 < sh ? y1 + 1 : y1;
+		float fy = sy - y1;
+		for (int x = 0; x < dw; x++) {
+			float sx = (float)x * sw / dw;
+			int x1 = (int)sx;
+			int x2 = x1 + 1 < sw ? x1 + 1 : x1;
+			float fx = sx - x1;
+			uint32_t out = 0;
+			for (int c = 0; c < 32; c += 8) {
+				float p11 = (src[y1 * sw + x1] >> c) & 0xFF;
+				float p12 = (src[y1 * sw + x2] >> c) & 0xFF;
+				float p21 = (src[y2 * sw + x1] >> c) & 0xFF;
+				float p22 = (src[y2 * sw + x2] >> c) & 0xFF;
+				float top = p11 * (1.0f - fx) + p12 * fx;
+				float bottom = p21 * (1.0f - fx) + p22 * fx;
+				out |= (uint32_t)(top * (1.0f - fy) + bottom * fy + 0.5f) << c;
+			}
+			dst[y * dw + x] = out;
+		}
+	}
+}
+
+/**
+ * Largest per-channel difference between two pixels.
+ */
+static int channel_diff(uint32_t a, uint32_t b) {
+	int max = 0;
+	for (int c = 0; c < 32; c += 8) {
+		int diff = abs((int)((a >> c) & 0xFF) - (int)((b >> c) & 0xFF));
+		if (diff > max)
+			max = diff;
+	}
+	return max;
+}
+
+///////////////////////////////
+// Bilinear Tests
+///////////////////////////////
+
+void test_scaleBilinear_same_size_copies(void) {
+	uint32_t src[6] = {0x11223344, 0x55667788, 0x99AABBCC, 0xDDEEFF00, 0x01020304, 0x05060708};
+	uint32_t dst[6] = {0};
+
+	scaleBilinear_c32(src, dst, 3, 2, 0, 3, 2, 0);
+	TEST_ASSERT_EQUAL_HEX32_ARRAY(src, dst, 6);
+}
+
+void test_scaleBilinear_upscale_interpolates_horizontally(void) {
+	uint32_t src[2] = {0x00000000, 0xFFFFFFFF};
+	uint32_t dst[4] = {0};
+
+	scaleBilinear_c32(src, dst, 2, 1, 0, 4, 1, 0);
+	TEST_ASSERT_EQUAL_HEX32(0x00000000, dst[0]);
+	TEST_ASSERT_EQUAL_HEX32(0x80808080, dst[1]);
+	TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, dst[2]);
+	TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, dst[3]); // clamped at the right edge
+}
+
+void test_scaleBilinear_upscale_interpolates_vertically(void) {
+	uint32_t src[2] = {0x00000000, 0xFFFFFFFF};
+	uint32_t dst[4] = {0};
+
+	scaleBilinear_c32(src, dst, 1, 2, 0, 1, 4, 0);
+	TEST_ASSERT_EQUAL_HEX32(0x00000000, dst[0]);
+	TEST_ASSERT_EQUAL_HEX32(0x80808080, dst[1]);
+	TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, dst[2]);
+	TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFF, dst[3]);
+}
+
+void test_scaleBilinear_channels_do_not_bleed(void) {
+	// Alternating full/empty channels would carry between lanes if the
+	// paired multiply overflowed
+	uint32_t src[2] = {0xFF00FF00, 0x00FF00FF};
+	uint32_t dst[4] = {0};
+
+	scaleBilinear_c32(src, dst, 2, 1, 0, 4, 1, 0);
+	TEST_ASSERT_EQUAL_HEX32(0x80808080, dst[1]);
+}
+
+void test_scaleBilinear_matches_float_reference(void) {
+	enum { SW = 37, SH = 23 };
+	static const int sizes[][2] = {{24, 15}, {50, 31}, {37, 46}, {11, 7}, {80, 60}};
+	uint32_t src[SW * SH];
+	srand(1234);
+	for (int i = 0; i < SW * SH; i++)
+		src[i] = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+
+	for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+		int dw = sizes[s][0];
+		int dh = sizes[s][1];
+		uint32_t* dst = malloc(dw * dh * sizeof(uint32_t));
+		uint32_t* expected = malloc(dw * dh * sizeof(uint32_t));
+
+		scaleBilinear_c32(src, dst, SW, SH, 0, dw, dh, 0);
+		reference_bilinear(src, SW, SH, expected, dw, dh);
+
+		int worst = 0;
+		for (int i = 0; i < dw * dh; i++) {
+			int diff = channel_diff(dst[i], expected[i]);
+			if (diff > worst)
+				worst = diff;
+		}
+		// 8-bit weights and rounding after each pass
+		TEST_ASSERT_LESS_OR_EQUAL_INT(2, worst);
+
+		free(dst);
+		free(expected);
+	}
+}
+
+void test_scaleBilinear_respects_pitch(void) {
+	// 2x2 source and 3x3 destination, both with 2 pixels of row padding
+	uint32_t src[2 * 4] = {0x10101010, 0x20202020, 0xDEADBEEF, 0xDEADBEEF,
+	                       0x30303030, 0x40404040, 0xDEADBEEF, 0xDEADBEEF};
+	uint32_t dst[3 * 5];
+	for (int i = 0; i < 15; i++)
+		dst[i] = 0xCAFEF00D;
+
+	scaleBilinear_c32(src, dst, 2, 2, 4 * sizeof(uint32_t), 3, 3, 5 * sizeof(uint32_t));
+
+	TEST_ASSERT_EQUAL_HEX32(0x10101010, dst[0]);
+	TEST_ASSERT_EQUAL_HEX32(0x40404040, dst[2 * 5 + 2]);
+	for (int y = 0; y < 3; y++) {
+		TEST_ASSERT_EQUAL_HEX32(0xCAFEF00D, dst[y * 5 + 3]);
+		TEST_ASSERT_EQUAL_HEX32(0xCAFEF00D, dst[y * 5 + 4]);
+		for (int x = 0; x < 3; x++)
+			TEST_ASSERT_NOT_EQUAL(0xDEADBEEF, dst[y * 5 + x]);
+	}
+}
+
+void test_scaleBilinear_empty_size_is_noop(void) {
+	uint32_t src[1] = {0x12345678};
+	uint32_t dst[1] = {0xCAFEF00D};
+
+	scaleBilinear_c32(src, dst, 1, 1, 0, 0, 1, 0);
+	scaleBilinear_c32(src, dst, 0, 1, 0, 1, 1, 0);
+	TEST_ASSERT_EQUAL_HEX32(0xCAFEF00D, dst[0]);
+}
+
+///////////////////////////////
+// Anti-aliased Scaler Reference
+///////////////////////////////
+
+/**
+ * The per-pixel scaleAA from picoarch that scaleAA_c16 replaces, kept as
+ * the golden reference. Only change: the last column blends with itself
+ * instead of reading one pixel past the row.
+ */
+static uint32_t ref_average16(uint32_t c1, uint32_t c2) {
+	return (c1 + c2 + ((c1 ^ c2) & 0x0821)) >> 1;
+}
+
+static uint32_t ref_average32(uint32_t c1, uint32_t c2) {
+	uint32_t sum = c1 + c2;
+	uint32_t ret = sum + ((c1 ^ c2) & 0x08210821);
+	uint32_t of = ((sum < c1) | (ret < sum)) ? 0x80000000 : 0;
+	return (ret >> 1) | of;
+}
+
+#define AVERAGE16_NOCHK(c1, c2) (ref_average16((c1), (c2)))
+#define AVERAGE32_NOCHK(c1, c2) (ref_average32((c1), (c2)))
+#define AVERAGE32(c1, c2) ((c1) == (c2) ? (c1) : AVERAGE32_NOCHK((c1), (c2)))
+#define AVERAGE32_1_3(c1, c2)                                                                      \
+	((c1) == (c2) ? (c1) : (AVERAGE32_NOCHK(AVERAGE32_NOCHK((c1), (c2)), (c2))))
+
+static int ref_gcd(int a, int b) {
+	while (b) {
+		int t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+static void reference_scaleAA(const uint16_t* src_pixels, int w, int h, int pitch,
+                              uint16_t* dst_pixels, int dst_w, int dst_h, int dst_p) {
+	int gcd_w = ref_gcd(w, dst_w);
+	int rat_w = w / gcd_w;
+	int rat_dst_w = dst_w / gcd_w;
+	double blend_denominator = (w > dst_w) ? 5 : 2.5;
+	uint16_t bw[2] = {(uint16_t)(rat_dst_w / blend_denominator + 0.5), (uint16_t)(rat_dst_w >> 1)};
+
+	int gcd_h = ref_gcd(h, dst_h);
+	int rat_h = h / gcd_h;
+	int rat_dst_h = dst_h / gcd_h;
+	uint16_t bh[2] = {(uint16_t)(rat_dst_h / blend_denominator + 0.5), (uint16_t)(rat_dst_h >> 1)};
+
+	uint16_t* blend_line = calloc(w, sizeof(uint16_t));
+	const uint8_t* src = (const uint8_t*)src_pixels;
+	uint8_t* dst = (uint8_t*)dst_pixels;
+	int dy = 0;
+	int lines = h;
+
+	while (lines--) {
+		while (dy < rat_dst_h) {
+			uint16_t* dst16 = (uint16_t*)dst;
+			uint16_t* pblend = blend_line;
+			int col = w;
+			int dx = 0;
+
+			uint16_t* pnext = (uint16_t*)(src + pitch);
+			if (!lines)
+				pnext -= (pitch / sizeof(uint16_t));
+
+			if (dy > rat_dst_h - bh[0]) {
+				pblend = pnext;
+			} else if (dy <= bh[0]) {
+				pblend = (uint16_t*)src;
+			} else {
+				const uint32_t* src32 = (const uint32_t*)src;
+				const uint32_t* pnext32 = (const uint32_t*)pnext;
+				uint32_t* pblend32 = (uint32_t*)pblend;
+				int count = w / 2;
+
+				if (dy <= bh[1]) {
+					const uint32_t* tmp = pnext32;
+					pnext32 = src32;
+					src32 = tmp;
+				}
+
+				if (dy > rat_dst_h - bh[1] || dy <= bh[1]) {
+					while (count--) {
+						*pblend32++ = AVERAGE32_1_3(*src32, *pnext32);
+						src32++;
+						pnext32++;
+					}
+				} else {
+					while (count--) {
+						*pblend32++ = AVERAGE32(*src32, *pnext32);
+						src32++;
+						pnext32++;
+					}
+				}
+			}
+
+			while (col--) {
+				uint16_t a, b, out;
+
+				a = *pblend;
+				b = col ? *(pblend + 1) : a;
+
+				while (dx < rat_dst_w) {
+					if (a == b) {
+						out = a;
+					} else if (dx > rat_dst_w - bw[0]) {
+						out = b;
+					} else if (dx <= bw[0]) {
+						out = a;
+					} else {
+						if (dx > rat_dst_w - bw[1]) {
+							a = AVERAGE16_NOCHK(a, b);
+						} else if (dx <= bw[1]) {
+							b = AVERAGE16_NOCHK(a, b);
+						}
+
+						out = AVERAGE16_NOCHK(a, b);
+					}
+					*dst16++ = out;
+					dx += rat_w;
+				}
+
+				dx -= rat_dst_w;
+				pblend++;
+			}
+
+			dy += rat_h;
+			dst += dst_p;
+		}
+
+		dy -= rat_dst_h;
+		src += pitch;
+	}
+
+	free(blend_line);
+}
+
+/**
+ * Fills an RGB565 image with gradients, flat areas and noise so every
+ * blend zone sees both equal and differing neighbours.
+ */
+static void fill_test_image(uint16_t* pixels, int w, int h, int pitch_px) {
+	srand(4321);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			uint16_t value;
+			if ((x / 8 + y / 8) % 3 == 0)
+				value = 0xFFFF; // flat area
+			else if ((x / 8 + y / 8) % 3 == 1)
+				value = (uint16_t)(((x * 31 / w) << 11) | ((y * 63 / h) << 5) | (x ^ y) % 32);
+			else
+				value = (uint16_t)rand();
+			pixels[y * pitch_px + x] = value;
+		}
+	}
+}
+
+/**
+ * Scales with scaleAA_c16 and the reference, returning mismatched pixels.
+ */
+static int compare_scaleAA(int sw, int sh, int dw, int dh) {
+	int src_pitch_px = sw + 4; // padded like an emulator framebuffer
+	int dst_pitch_px = dw + 6;
+	uint16_t* src = calloc(src_pitch_px * sh, sizeof(uint16_t));
+	uint16_t* expected = calloc(dst_pitch_px * dh, sizeof(uint16_t));
+	uint16_t* actual = calloc(dst_pitch_px * dh, sizeof(uint16_t));
+	fill_test_image(src, sw, sh, src_pitch_px);
+
+	reference_scaleAA(src, sw, sh, src_pitch_px * 2, expected, dw, dh, dst_pitch_px * 2);
+
+	AAScaler aa;
+	TEST_ASSERT_TRUE(scaleAA_init(&aa, sw, sh, dw, dh));
+	scaleAA_c16(&aa, src, src_pitch_px * 2, actual, dst_pitch_px * 2);
+	scaleAA_free(&aa);
+
+	int mismatches = 0;
+	for (int y = 0; y < dh; y++)
+		for (int x = 0; x < dw; x++)
+			if (actual[y * dst_pitch_px + x] != expected[y * dst_pitch_px + x])
+				mismatches += 1;
+
+	// Row padding is never written
+	for (int y = 0; y < dh; y++)
+		for (int x = dw; x < dst_pitch_px; x++)
+			TEST_ASSERT_EQUAL_HEX16(0, actual[y * dst_pitch_px + x]);
+
+	free(src);
+	free(expected);
+	free(actual);
+	return mismatches;
+}
+
+///////////////////////////////
+// Anti-aliased Scaler Tests
+///////////////////////////////
+
+void test_scaleAA_matches_reference_gba_aspect(void) {
+	TEST_ASSERT_EQUAL_INT(0, compare_scaleAA(240, 160, 640, 426));
+}
+
+void test_scaleAA_matches_reference_gb_aspect(void) {
+	TEST_ASSERT_EQUAL_INT(0, compare_scaleAA(160, 144, 532, 480));
+}
+
+void test_scaleAA_matches_reference_snes_fullscreen(void) {
+	TEST_ASSERT_EQUAL_INT(0, compare_scaleAA(256, 224, 640, 480));
+}
+
+void test_scaleAA_matches_reference_downscale(void) {
+	TEST_ASSERT_EQUAL_INT(0, compare_scaleAA(320, 240, 240, 180));
+}
+
+void test_scaleAA_matches_reference_odd_output_width(void) {
+	TEST_ASSERT_EQUAL_INT(0, compare_scaleAA(160, 144, 333, 301));
+}
+
+void test_scaleAA_blends_in_quarters(void) {
+	// Black to white across one source step: every blend level appears
+	uint16_t src[2] = {0x0000, 0xFFFF};
+	uint16_t dst[10];
+	AAScaler aa;
+	TEST_ASSERT_TRUE(scaleAA_init(&aa, 2, 1, 10, 1));
+	scaleAA_c16(&aa, src, sizeof(src), dst, sizeof(dst));
+
+	TEST_ASSERT_EQUAL_HEX16(0x0000, dst[0]);
+	for (int x = 1; x < 5; x++)
+		TEST_ASSERT_TRUE(dst[x] >= dst[x - 1]);
+	TEST_ASSERT_EQUAL_HEX16(0xFFFF, dst[9]);
+	scaleAA_free(&aa);
+}
+
+void test_scaleAA_init_rejects_empty_sizes(void) {
+	AAScaler aa;
+	TEST_ASSERT_FALSE(scaleAA_init(&aa, 0, 144, 320, 240));
+	TEST_ASSERT_FALSE(scaleAA_init(&aa, 160, 144, 320, 0));
+	TEST_ASSERT_NULL(aa.col_a);
+	scaleAA_free(&aa);
+}
+
+///////////////////////////////
+// Sharp Bilinear Reference
+///////////////////////////////
+
+/**
+ * Prescales by nearest neighbor into a real buffer, then samples it
+ * bilinearly at output pixel centres in float.
+ */
+static void reference_sharpBilinear(const uint16_t* src, int sw, int sh, uint16_t* dst, int dw,
+                                    int dh) {
+	int prescale = dw / sw < dh / sh ? dw / sw : dh / sh;
+	if (prescale < 1)
+		prescale = 1;
+	int pw = sw * prescale;
+	int ph = sh * prescale;
+	uint16_t* scaled = malloc(pw * ph * sizeof(uint16_t));
+	for (int y = 0; y < ph; y++)
+		for (int x = 0; x < pw; x++)
+			scaled[y * pw + x] = src[(y / prescale) * sw + x / prescale];
+
+	static const int shifts[3] = {11, 5, 0};
+	static const int masks[3] = {0x1F, 0x3F, 0x1F};
+	for (int y = 0; y < dh; y++) {
+		float v = (y + 0.5f) * ph / dh - 0.5f;
+		if (v < 0)
+			v = 0;
+		int y1 = (int)v;
+		int y2 = y1 + 1 < ph ? y1 + 1 : y1;
+		float fy = v - y1;
+		for (int x = 0; x < dw; x++) {
+			float u = (x + 0.5f) * pw / dw - 0.5f;
+			if (u < 0)
+				u = 0;
+			int x1 = (int)u;
+			int x2 = x1 + 1 < pw ? x1 + 1 : x1;
+			float fx = u - x1;
+			uint16_t out = 0;
+			for (int c = 0; c < 3; c++) {
+				float p11 = (scaled[y1 * pw + x1] >> shifts[c]) & masks[c];
+				float p12 = (scaled[y1 * pw + x2] >> shifts[c]) & masks[c];
+				float p21 = (scaled[y2 * pw + x1] >> shifts[c]) & masks[c];
+				float p22 = (scaled[y2 * pw + x2] >> shifts[c]) & masks[c];
+				float top = p11 * (1.0f - fx) + p12 * fx;
+				float bottom = p21 * (1.0f - fx) + p22 * fx;
+				out |= (uint16_t)((int)(top * (1.0f - fy) + bottom * fy + 0.5f) << shifts[c]);
+			}
+			dst[y * dw + x] = out;
+		}
+	}
+	free(scaled);
+}
+
+/**
+ * Largest per-channel difference between two RGB565 pixels.
+ */
+static int channel_diff16(uint16_t a, uint16_t b) {
+	int diffs[3] = {abs((a >> 11) - (b >> 11)), abs(((a >> 5) & 0x3F) - ((b >> 5) & 0x3F)),
+	                abs((a & 0x1F) - (b & 0x1F))};
+	int max = diffs[0] > diffs[1] ? diffs[0] : diffs[1];
+	return max > diffs[2] ? max : diffs[2];
+}
+
+/**
+ * Worst channel difference between scaleSharpBilinear_c16 and the
+ * reference for one size.
+ */
+static int compare_sharpBilinear(int sw, int sh, int dw, int dh) {
+	uint16_t* src = malloc(sw * sh * sizeof(uint16_t));
+	uint16_t* expected = malloc(dw * dh * sizeof(uint16_t));
+	uint16_t* actual = malloc(dw * dh * sizeof(uint16_t));
+	fill_test_image(src, sw, sh, sw);
+
+	reference_sharpBilinear(src, sw, sh, expected, dw, dh);
+	scaleSharpBilinear_c16(src, actual, sw, sh, 0, dw, dh, 0);
+
+	int worst = 0;
+	for (int i = 0; i < dw * dh; i++) {
+		int diff = channel_diff16(actual[i], expected[i]);
+		if (diff > worst)
+			worst = diff;
+	}
+
+	free(src);
+	free(expected);
+	free(actual);
+	return worst;
+}
+
+///////////////////////////////
+// Sharp Bilinear Tests
+///////////////////////////////
+
+void test_scaleSharpBilinear_integer_ratio_is_nearest_neighbor(void) {
+	enum { SW = 5, SH = 3, K = 3 };
+	uint16_t src[SW * SH];
+	uint16_t dst[SW * K * SH * K];
+	fill_test_image(src, SW, SH, SW);
+
+	scaleSharpBilinear_c16(src, dst, SW, SH, 0, SW * K, SH * K, 0);
+	for (int y = 0; y < SH * K; y++)
+		for (int x = 0; x < SW * K; x++)
+			TEST_ASSERT_EQUAL_HEX16(src[(y / K) * SW + x / K], dst[y * SW * K + x]);
+}
+
+void test_scaleSharpBilinear_only_blends_seams(void) {
+	// 2x1 to 7x3: prescale 3 gives 6 wide, so each source pixel covers
+	// 3.5 output pixels and only the one straddling the seam is blended
+	uint16_t src[2] = {0x0000, 0xFFFF};
+	uint16_t dst[7 * 3];
+
+	scaleSharpBilinear_c16(src, dst, 2, 1, 0, 7, 3, 0);
+	TEST_ASSERT_EQUAL_HEX16(0x0000, dst[0]);
+	TEST_ASSERT_EQUAL_HEX16(0x0000, dst[1]);
+	TEST_ASSERT_EQUAL_HEX16(0x0000, dst[2]);
+	TEST_ASSERT_TRUE(dst[3] != 0x0000 && dst[3] != 0xFFFF);
+	TEST_ASSERT_EQUAL_HEX16(0xFFFF, dst[4]);
+	TEST_ASSERT_EQUAL_HEX16(0xFFFF, dst[6]);
+}
+
+void test_scaleSharpBilinear_matches_reference_gba_aspect(void) {
+	// 5-bit weights against float, rounded after each pass
+	TEST_ASSERT_LESS_OR_EQUAL_INT(2, compare_sharpBilinear(240, 160, 640, 426));
+}
+
+void test_scaleSharpBilinear_matches_reference_gb_aspect(void) {
+	TEST_ASSERT_LESS_OR_EQUAL_INT(2, compare_sharpBilinear(160, 144, 533, 480));
+}
+
+void test_scaleSharpBilinear_matches_reference_downscale(void) {
+	TEST_ASSERT_LESS_OR_EQUAL_INT(2, compare_sharpBilinear(320, 240, 203, 157));
+}
+
+void test_scaleSharpBilinear_size_change_rebuilds_tables(void) {
+	TEST_ASSERT_LESS_OR_EQUAL_INT(2, compare_sharpBilinear(256, 224, 548, 480));
+	TEST_ASSERT_LESS_OR_EQUAL_INT(2, compare_sharpBilinear(256, 224, 640, 480));
+	TEST_ASSERT_LESS_OR_EQUAL_INT(2, compare_sharpBilinear(256, 240, 640, 480));
+}
+
+void test_scaleSharpBilinear_respects_pitch(void) {
+	// 2x2 source and 3x3 destination, both with 2 pixels of row padding
+	uint16_t src[2 * 4] = {0x1111, 0x2222, 0xDEAD, 0xDEAD, 0x3333, 0x4444, 0xDEAD, 0xDEAD};
+	uint16_t dst[3 * 5];
+	for (int i = 0; i < 15; i++)
+		dst[i] = 0xF00D;
+
+	scaleSharpBilinear_c16(src, dst, 2, 2, 4 * sizeof(uint16_t), 3, 3, 5 * sizeof(uint16_t));
+
+	TEST_ASSERT_EQUAL_HEX16(0x1111, dst[0]);
+	TEST_ASSERT_EQUAL_HEX16(0x4444, dst[2 * 5 + 2]);
+	for (int y = 0; y < 3; y++) {
+		TEST_ASSERT_EQUAL_HEX16(0xF00D, dst[y * 5 + 3]);
+		TEST_ASSERT_EQUAL_HEX16(0xF00D, dst[y * 5 + 4]);
+		for (int x = 0; x < 3; x++)
+			TEST_ASSERT_NOT_EQUAL(0xDEAD, dst[y * 5 + x]);
+	}
+}
+
+///////////////////////////////
+// Integer Scaler Reference
+///////////////////////////////
+
+#define INT_GUARD 0xA5
+
+/**
+ * Nearest neighbor integer scale, one pixel at a time.
+ */
+static void reference_integer(const uint8_t* src, int sw, int sh, int sp, uint8_t* dst, int dp,
+                              int xmul, int ymul, int bpp) {
+	for (int y = 0; y < sh * ymul; y++) {
+		const uint8_t* s = src + (y / ymul) * sp;
+		uint8_t* d = dst + y * dp;
+		for (int x = 0; x < sw * xmul; x++)
+			memcpy(d + x * bpp, s + (x / xmul) * bpp, bpp);
+	}
+}
+
+/**
+ * Scales a padded, offset test image with the dispatcher and compares it
+ * with the reference, including the destination padding.
+ *
+ * @return Number of mismatched destination bytes
+ */
+static int compare_integer(int sw, int sh, int xmul, int ymul, int bpp) {
+	int sp = (sw + 3) * bpp;
+	int dp = (sw * xmul + 5) * bpp;
+	int dh = sh * ymul;
+	// Odd byte offsets keep the kernels honest about alignment
+	uint8_t* src_buffer = malloc(sp * sh + 1);
+	uint8_t* expected = malloc(dp * dh);
+	uint8_t* actual_buffer = malloc(dp * dh + 1);
+	uint8_t* src = src_buffer + 1;
+	uint8_t* actual = actual_buffer + 1;
+
+	for (int i = 0; i < sp * sh; i++)
+		src[i] = (uint8_t)(i * 31 + (i >> 8) * 7);
+	memset(expected, INT_GUARD, dp * dh);
+	memset(actual, INT_GUARD, dp * dh);
+	reference_integer(src, sw, sh, sp, expected, dp, xmul, ymul, bpp);
+
+	if (bpp == 2)
+		scaler_c16(xmul, ymul, src, actual, sw, sh, sp, sw * xmul, dh, dp);
+	else
+		scaler_c32(xmul, ymul, src, actual, sw, sh, sp, sw * xmul, dh, dp);
+
+	int mismatches = 0;
+	for (int i = 0; i < dp * dh; i++)
+		if (expected[i] != actual[i])
+			mismatches += 1;
+
+	free(src_buffer);
+	free(expected);
+	free(actual_buffer);
+	return mismatches;
+}
+
+///////////////////////////////
+// Integer Scaler Tests
+///////////////////////////////
+
+void test_scaler_c16_matches_reference_every_factor(void) {
+	// 21 pixels is two full 8-pixel blocks plus a tail
+	for (int xmul = 1; xmul <= SCALER_MAX_FACTOR; xmul++)
+		for (int ymul = 1; ymul <= SCALER_MAX_FACTOR; ymul++)
+			TEST_ASSERT_EQUAL_INT(0, compare_integer(21, 3, xmul, ymul, 2));
+}
+
+void test_scaler_c32_matches_reference_every_factor(void) {
+	for (int xmul = 1; xmul <= SCALER_MAX_FACTOR; xmul++)
+		for (int ymul = 1; ymul <= SCALER_MAX_FACTOR; ymul++)
+			TEST_ASSERT_EQUAL_INT(0, compare_integer(11, 3, xmul, ymul, 4));
+}
+
+void test_scaler_matches_reference_console_sizes(void) {
+	TEST_ASSERT_EQUAL_INT(0, compare_integer(160, 144, 3, 3, 2));
+	TEST_ASSERT_EQUAL_INT(0, compare_integer(240, 160, 4, 4, 2));
+	TEST_ASSERT_EQUAL_INT(0, compare_integer(256, 224, 5, 3, 2));
+	TEST_ASSERT_EQUAL_INT(0, compare_integer(160, 144, 9, 9, 4));
+	TEST_ASSERT_EQUAL_INT(0, compare_integer(1, 1, 12, 12, 2));
+}
+
+void test_scale1x1_matching_pitches_copies_whole_frame(void) {
+	uint16_t src[4 * 3];
+	uint16_t dst[4 * 3];
+	for (int i = 0; i < 12; i++)
+		src[i] = (uint16_t)(0x1000 + i);
+
+	scale1x1_c16(src, dst, 4, 3, 0, 4, 3, 0);
+
+	TEST_ASSERT_EQUAL_MEMORY(src, dst, sizeof(src));
+}
+
+void test_scaler_default_pitches(void) {
+	uint32_t src[3] = {0x11111111, 0x22222222, 0x33333333};
+	uint32_t dst[6 * 2];
+	uint32_t expected[6 * 2] = {0x11111111, 0x11111111, 0x22222222, 0x22222222,
+	                            0x33333333, 0x33333333, 0x11111111, 0x11111111,
+	                            0x22222222, 0x22222222, 0x33333333, 0x33333333};
+
+	scale2x2_c32(src, dst, 3, 1, 0, 6, 2, 0);
+
+	TEST_ASSERT_EQUAL_HEX32_ARRAY(expected, dst, 12);
+}
+
+void test_scaler_find_returns_matching_wrapper(void) {
+	TEST_ASSERT_TRUE(scaler_find_c16(1, 1) == scale1x1_c16);
+	TEST_ASSERT_TRUE(scaler_find_c16(3, 2) == scale3x2_c16);
+	TEST_ASSERT_TRUE(scaler_find_c32(12, 7) == scale12x7_c32);
+	TEST_ASSERT_NULL(scaler_find_c16(0, 1));
+	TEST_ASSERT_NULL(scaler_find_c32(1, SCALER_MAX_FACTOR + 1));
+}
+
+void test_scaler_out_of_range_factor_is_noop(void) {
+	uint16_t src[2] = {0x1234, 0x5678};
+	uint16_t dst[2 * 13 * 13];
+	memset(dst, 0, sizeof(dst));
+
+	scaler_c16(0, 1, src, dst, 2, 1, 0, 0, 1, 0);
+	scaler_c16(1, 0, src, dst, 2, 1, 0, 0, 1, 0);
+	scaler_c16(SCALER_MAX_FACTOR + 1, 1, src, dst, 2, 1, 0, 0, 1, 0);
+	scaler_c16(1, SCALER_MAX_FACTOR + 1, src, dst, 2, 1, 0, 0, 1, 0);
+
+	for (int i = 0; i < 2 * 13 * 13; i++)
+		TEST_ASSERT_EQUAL_HEX16(0, dst[i]);
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Bilinear
+	RUN_TEST(test_scaleBilinear_same_size_copies);
+	RUN_TEST(test_scaleBilinear_upscale_interpolates_horizontally);
+	RUN_TEST(test_scaleBilinear_upscale_interpolates_vertically);
+	RUN_TEST(test_scaleBilinear_channels_do_not_bleed);
+	RUN_TEST(test_scaleBilinear_matches_float_reference);
+	RUN_TEST(test_scaleBilinear_respects_pitch);
+	RUN_TEST(test_scaleBilinear_empty_size_is_noop);
+
+	// Anti-aliased
+	RUN_TEST(test_scaleAA_matches_reference_gba_aspect);
+	RUN_TEST(test_scaleAA_matches_reference_gb_aspect);
+	RUN_TEST(test_scaleAA_matches_reference_snes_fullscreen);
+	RUN_TEST(test_scaleAA_matches_reference_downscale);
+	RUN_TEST(test_scaleAA_matches_reference_odd_output_width);
+	RUN_TEST(test_scaleAA_blends_in_quarters);
+	RUN_TEST(test_scaleAA_init_rejects_empty_sizes);
+
+	// Sharp bilinear
+	RUN_TEST(test_scaleSharpBilinear_integer_ratio_is_nearest_neighbor);
+	RUN_TEST(test_scaleSharpBilinear_only_blends_seams);
+	RUN_TEST(test_scaleSharpBilinear_matches_reference_gba_aspect);
+	RUN_TEST(test_scaleSharpBilinear_matches_reference_gb_aspect);
+	RUN_TEST(test_scaleSharpBilinear_matches_reference_downscale);
+	RUN_TEST(test_scaleSharpBilinear_size_change_rebuilds_tables);
+	RUN_TEST(test_scaleSharpBilinear_respects_pitch);
+
+	// Integer
+	RUN_TEST(test_scaler_c16_matches_reference_every_factor);
+	RUN_TEST(test_scaler_c32_matches_reference_every_factor);
+	RUN_TEST(test_scaler_matches_reference_console_sizes);
+	RUN_TEST(test_scale1x1_matching_pitches_copies_whole_frame);
+	RUN_TEST(test_scaler_default_pitches);
+	RUN_TEST(test_scaler_find_returns_matching_wrapper);
+	RUN_TEST(test_scaler_out_of_range_factor_is_noop);
+
+	return UNITY_END();
+}
@@ -0,0 +1,358 @@
+/**
+ * test_scaler_pool.c - Tests for row-parallel scaling
+ *
+ * Banded jobs run on real worker threads; each frame's output is compared
+ * against the same scaler run directly on the calling thread. Gates
+ * alternate single-threaded and banded frames while measuring, so a few
+ * frames in a row cover both paths.
+ *
+ * Test coverage:
+ * - ScalerPool_key - Workload identity
+ * - ScalerPoolGate_bands/record - Alternation, decision, re-measuring
+ * - ScalerPool_run - Every band runs once, nested and serial fallbacks
+ * - ScalerPool_setThreads - Overriding and re-counting cores
+ * - ScalerPool_scale/rotate/scaleAA - Banded output matches serial output
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/scaler_pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Enough frames to cover single-threaded and banded runs while measuring
+#define FRAMES 4
+
+void setUp(void) {
+	// Split frames even when the machine running the tests has one core
+	ScalerPool_setThreads(SCALER_POOL_MAX_THREADS);
+}
+
+void tearDown(void) {
+}
+
+static void fill_pattern(uint16_t* pixels, int count, uint32_t seed) {
+	for (int i = 0; i < count; i++) {
+		seed = seed * 1103515245u + 12345u;
+		pixels[i] = (uint16_t)(seed >> 16);
+	}
+}
+
+///////////////////////////////
+// Key Tests
+///////////////////////////////
+
+void test_ScalerPool_key_depends_on_every_field(void) {
+	uint64_t key = ScalerPool_key(256, 224, 768, 672, 3);
+	TEST_ASSERT_TRUE(key != 0);
+	TEST_ASSERT_TRUE(key == ScalerPool_key(256, 224, 768, 672, 3));
+	TEST_ASSERT_TRUE(key != ScalerPool_key(224, 256, 768, 672, 3));
+	TEST_ASSERT_TRUE(key != ScalerPool_key(256, 224, 672, 768, 3));
+	TEST_ASSERT_TRUE(key != ScalerPool_key(256, 224, 768, 672, 4));
+}
+
+///////////////////////////////
+// Gate Tests
+///////////////////////////////
+
+/**
+ * Runs a full measurement with fixed frame times and returns the decision.
+ */
+static int measure(ScalerPoolGate* gate, uint64_t key, uint64_t serial_us, uint64_t threaded_us) {
+	for (int i = 0; i < SCALER_POOL_WARMUP_FRAMES + 2 * SCALER_POOL_SAMPLE_FRAMES; i++) {
+		int bands = ScalerPoolGate_bands(gate, key, 4);
+		ScalerPoolGate_record(gate, bands, bands > 1 ? threaded_us : serial_us);
+	}
+	return ScalerPoolGate_bands(gate, key, 4);
+}
+
+void test_ScalerPoolGate_single_core_never_splits(void) {
+	ScalerPoolGate gate = {0};
+	for (int i = 0; i < 100; i++) {
+		TEST_ASSERT_EQUAL_INT(1, ScalerPoolGate_bands(&gate, 1, 1));
+		ScalerPoolGate_record(&gate, 1, 10);
+	}
+}
+
+void test_ScalerPoolGate_alternates_while_measuring(void) {
+	ScalerPoolGate gate = {0};
+	for (int i = 0; i < 6; i++) {
+		int bands = ScalerPoolGate_bands(&gate, 1, 4);
+		TEST_ASSERT_EQUAL_INT(i & 1 ? 4 : 1, bands);
+		ScalerPoolGate_record(&gate, bands, 10);
+	}
+}
+
+void test_ScalerPoolGate_keeps_bands_when_faster(void) {
+	ScalerPoolGate gate = {0};
+	TEST_ASSERT_EQUAL_INT(4, measure(&gate, 1, 1000, 400));
+	TEST_ASSERT_EQUAL_INT(1, gate.threaded);
+}
+
+void test_ScalerPoolGate_drops_bands_when_not_faster_enough(void) {
+	ScalerPoolGate gate = {0};
+	// 5% faster is below SCALER_POOL_MIN_GAIN
+	TEST_ASSERT_EQUAL_INT(1, measure(&gate, 1, 1000, 950));
+	TEST_ASSERT_EQUAL_INT(1, measure(&gate, 2, 1000, 1500));
+}
+
+void test_ScalerPoolGate_ignores_warmup_frames(void) {
+	ScalerPoolGate gate = {0};
+	for (int i = 0; i < SCALER_POOL_WARMUP_FRAMES; i++) {
+		int bands = ScalerPoolGate_bands(&gate, 1, 4);
+		ScalerPoolGate_record(&gate, bands, 1000000);
+	}
+	TEST_ASSERT_TRUE(gate.serial_us == 0);
+	TEST_ASSERT_TRUE(gate.threaded_us == 0);
+}
+
+void test_ScalerPoolGate_new_key_measures_again(void) {
+	ScalerPoolGate gate = {0};
+	measure(&gate, 1, 1000, 400);
+
+	TEST_ASSERT_EQUAL_INT(1, ScalerPoolGate_bands(&gate, 2, 4));
+	TEST_ASSERT_EQUAL_INT(0, gate.frames);
+	TEST_ASSERT_TRUE(gate.key == 2);
+}
+
+void test_ScalerPoolGate_measures_again_after_recheck_frames(void) {
+	ScalerPoolGate gate = {0};
+	measure(&gate, 1, 1000, 400);
+	for (int i = 0; i < SCALER_POOL_RECHECK_FRAMES; i++) {
+		TEST_ASSERT_EQUAL_INT(4, ScalerPoolGate_bands(&gate, 1, 4));
+		ScalerPoolGate_record(&gate, 4, 400);
+	}
+
+	// Measuring restarts with a single-threaded frame; a slower result now wins
+	TEST_ASSERT_EQUAL_INT(1, measure(&gate, 1, 400, 1000));
+	TEST_ASSERT_EQUAL_INT(0, gate.threaded);
+}
+
+///////////////////////////////
+// Run Tests
+///////////////////////////////
+
+typedef struct CountJob {
+	pthread_mutex_t mutex;
+	int runs[SCALER_POOL_MAX_THREADS];
+	int bands_seen;
+	int nested;
+} CountJob;
+
+static void count_band(void* ctx, int band, int bands) {
+	CountJob* job = ctx;
+	pthread_mutex_lock(&job->mutex);
+	job->runs[band] += 1;
+	job->bands_seen = bands;
+	pthread_mutex_unlock(&job->mutex);
+}
+
+void test_ScalerPool_run_runs_every_band_once(void) {
+	int threads = ScalerPool_threads();
+	TEST_ASSERT_EQUAL_INT(SCALER_POOL_MAX_THREADS, threads);
+
+	for (int frame = 0; frame < 50; frame++) {
+		CountJob job = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+		ScalerPool_run(count_band, &job, SCALER_POOL_MAX_THREADS);
+		TEST_ASSERT_EQUAL_INT(threads, job.bands_seen);
+		for (int band = 0; band < threads; band++)
+			TEST_ASSERT_EQUAL_INT(1, job.runs[band]);
+	}
+}
+
+void test_ScalerPool_run_clamps_bands(void) {
+	CountJob job = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+	ScalerPool_run(count_band, &job, 0);
+	TEST_ASSERT_EQUAL_INT(1, job.bands_seen);
+	TEST_ASSERT_EQUAL_INT(1, job.runs[0]);
+}
+
+static void nested_band(void* ctx, int band, int bands) {
+	CountJob* inner = (CountJob*)ctx + 1 + band;
+	// The pool is busy with this job, so this must run on the current thread
+	ScalerPool_run(count_band, inner, 2);
+	pthread_mutex_lock(&inner->mutex);
+	inner->nested = 1;
+	pthread_mutex_unlock(&inner->mutex);
+}
+
+void test_ScalerPool_run_nested_runs_on_calling_thread(void) {
+	CountJob jobs[1 + SCALER_POOL_MAX_THREADS];
+	memset(jobs, 0, sizeof(jobs));
+	for (int i = 0; i < 1 + SCALER_POOL_MAX_THREADS; i++)
+		pthread_mutex_init(&jobs[i].mutex, NULL);
+
+	ScalerPool_run(nested_band, jobs, SCALER_POOL_MAX_THREADS);
+	for (int band = 0; band < ScalerPool_threads(); band++) {
+		CountJob* inner = &jobs[1 + band];
+		TEST_ASSERT_EQUAL_INT(1, inner->nested);
+		TEST_ASSERT_EQUAL_INT(1, inner->runs[0]);
+	}
+}
+
+void test_ScalerPool_quit_and_restart(void) {
+	ScalerPool_quit();
+	ScalerPool_quit(); // Stopping twice is safe
+
+	CountJob job = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+	ScalerPool_run(count_band, &job, SCALER_POOL_MAX_THREADS);
+	for (int band = 0; band < ScalerPool_threads(); band++)
+		TEST_ASSERT_EQUAL_INT(1, job.runs[band]);
+}
+
+void test_ScalerPool_setThreads_clamps_and_restores(void) {
+	ScalerPool_setThreads(SCALER_POOL_MAX_THREADS + 5);
+	TEST_ASSERT_EQUAL_INT(SCALER_POOL_MAX_THREADS, ScalerPool_threads());
+	ScalerPool_setThreads(-1);
+	TEST_ASSERT_EQUAL_INT(1, ScalerPool_threads());
+
+	CountJob job = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+	ScalerPool_run(count_band, &job, SCALER_POOL_MAX_THREADS);
+	TEST_ASSERT_EQUAL_INT(1, job.bands_seen);
+
+	ScalerPool_setThreads(0);
+	int threads = ScalerPool_threads();
+	TEST_ASSERT_TRUE(threads >= 1 && threads <= SCALER_POOL_MAX_THREADS);
+}
+
+///////////////////////////////
+// Banded Scaler Tests
+///////////////////////////////
+
+/**
+ * Scales through the pool for a few frames and compares every frame with
+ * the scaler run directly. Pitches have padding to catch offset mistakes,
+ * and dh is passed extra_rows taller than the scaled image, as minarch
+ * does with the screen height.
+ */
+static void check_scale_rows(scaler_t scaler, uint32_t ymul, uint32_t xmul, int sw, int sh,
+                             int extra_rows) {
+	int sp = (sw + 3) * 2;
+	int dp = (sw * xmul + 5) * 2;
+	int dh = sh * ymul + extra_rows;
+	uint16_t* src = malloc(sp * sh);
+	uint16_t* expected = calloc(dh, dp);
+	uint16_t* actual = malloc(dp * dh);
+	fill_pattern(src, sp / 2 * sh, sw * 31 + sh);
+	scaler(src, expected, sw, sh, sp, sw * xmul, dh, dp);
+
+	ScalerPoolGate gate = {0};
+	for (int frame = 0; frame < FRAMES; frame++) {
+		memset(actual, 0, dp * dh);
+		ScalerPool_scale(&gate, scaler, ymul, src, actual, sw, sh, sp, sw * xmul, dh, dp);
+		TEST_ASSERT_EQUAL_MEMORY(expected, actual, dp * dh);
+	}
+	free(src);
+	free(expected);
+	free(actual);
+}
+
+static void check_scale(scaler_t scaler, uint32_t ymul, uint32_t xmul, int sw, int sh) {
+	check_scale_rows(scaler, ymul, xmul, sw, sh, 0);
+}
+
+void test_ScalerPool_scale_matches_serial(void) {
+	for (uint32_t factor = 1; factor <= 5; factor++) {
+		check_scale(scaler_find_c16(factor, factor), factor, factor, 37, 29);
+		check_scale(scaler_find_c16(factor, factor), factor, factor, 17, 3);
+	}
+	check_scale(scaler_find_c16(3, 2), 2, 3, 40, 31);
+}
+
+void test_ScalerPool_scale_splits_with_screen_height(void) {
+	check_scale_rows(scaler_find_c16(2, 2), 2, 2, 37, 29, 23);
+	check_scale_rows(scale3x_grid, 3, 3, 33, 21, 40);
+}
+
+void test_ScalerPool_scale_effect_scalers_match_serial(void) {
+	check_scale(scale2x_line, 2, 2, 33, 21);
+	check_scale(scale3x_grid, 3, 3, 33, 21);
+}
+
+void test_ScalerPool_rotate_matches_serial(void) {
+	int sw = 23, sh = 13;
+	int sp = (sw + 2) * 2;
+	uint16_t* src = malloc(sp * sh);
+	fill_pattern(src, sp / 2 * sh, 7);
+
+	for (unsigned rotation = ROTATION_0; rotation <= ROTATION_270; rotation++) {
+		int swapped = rotation == ROTATION_90 || rotation == ROTATION_270;
+		int dw = swapped ? sh : sw;
+		int dh = swapped ? sw : sh;
+		int dp = (dw + 1) * 2;
+		uint16_t* expected = calloc(dh, dp);
+		uint16_t* actual = malloc(dp * dh);
+		rotate_c16(rotation, src, expected, sw, sh, sp, dp);
+
+		ScalerPoolGate gate = {0};
+		for (int frame = 0; frame < FRAMES; frame++) {
+			memset(actual, 0, dp * dh);
+			ScalerPool_rotate(&gate, rotation, src, actual, sw, sh, sp, dp);
+			TEST_ASSERT_EQUAL_MEMORY(expected, actual, dp * dh);
+		}
+		free(expected);
+		free(actual);
+	}
+	free(src);
+}
+
+void test_ScalerPool_scaleAA_matches_serial(void) {
+	int sw = 41, sh = 27, dw = 97, dh = 66;
+	uint16_t* src = malloc(sw * sh * 2);
+	uint16_t* expected = malloc(dw * dh * 2);
+	uint16_t* actual = malloc(dw * dh * 2);
+	fill_pattern(src, sw * sh, 99);
+
+	AAScaler aa = {0};
+	TEST_ASSERT_TRUE(scaleAA_init(&aa, sw, sh, dw, dh));
+	scaleAA_c16(&aa, src, sw * 2, expected, dw * 2);
+
+	ScalerPoolGate gate = {0};
+	for (int frame = 0; frame < FRAMES; frame++) {
+		memset(actual, 0, dw * dh * 2);
+		ScalerPool_scaleAA(&gate, &aa, src, sw * 2, actual, dw * 2);
+		TEST_ASSERT_EQUAL_MEMORY(expected, actual, dw * dh * 2);
+	}
+	scaleAA_free(&aa);
+	free(src);
+	free(expected);
+	free(actual);
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Key
+	RUN_TEST(test_ScalerPool_key_depends_on_every_field);
+
+	// Gate
+	RUN_TEST(test_ScalerPoolGate_single_core_never_splits);
+	RUN_TEST(test_ScalerPoolGate_alternates_while_measuring);
+	RUN_TEST(test_ScalerPoolGate_keeps_bands_when_faster);
+	RUN_TEST(test_ScalerPoolGate_drops_bands_when_not_faster_enough);
+	RUN_TEST(test_ScalerPoolGate_ignores_warmup_frames);
+	RUN_TEST(test_ScalerPoolGate_new_key_measures_again);
+	RUN_TEST(test_ScalerPoolGate_measures_again_after_recheck_frames);
+
+	// Run
+	RUN_TEST(test_ScalerPool_run_runs_every_band_once);
+	RUN_TEST(test_ScalerPool_run_clamps_bands);
+	RUN_TEST(test_ScalerPool_run_nested_runs_on_calling_thread);
+	RUN_TEST(test_ScalerPool_quit_and_restart);
+	RUN_TEST(test_ScalerPool_setThreads_clamps_and_restores);
+
+	// Banded scalers
+	RUN_TEST(test_ScalerPool_scale_matches_serial);
+	RUN_TEST(test_ScalerPool_scale_splits_with_screen_height);
+	RUN_TEST(test_ScalerPool_scale_effect_scalers_match_serial);
+	RUN_TEST(test_ScalerPool_rotate_matches_serial);
+	RUN_TEST(test_ScalerPool_scaleAA_matches_serial);
+
+	ScalerPool_quit();
+	return UNITY_END();
+}
@@ -0,0 +1,273 @@
+/**
+ * test_thumb_cache.c - Unit tests for the thumbnail LRU cache
+ *
+ * Tests the byte-budgeted LRU used by minui to keep decoded thumbnails.
+ * Values are plain malloc'd buffers here; a counting free function
+ * verifies that eviction and replacement release exactly what they should.
+ *
+ * Test coverage:
+ * - ThumbCache_new/free - Lifecycle
+ * - ThumbCache_put/get/has - Insertion and lookup
+ * - LRU eviction order under a byte budget
+ * - Negative (NULL) entries for missing thumbnails
+ * - ThumbCache_pin - Protecting the displayed thumbnail
+ */
+
+#define _POSIX_C_SOURCE 200809L // Required for strdup()
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/thumb_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int freed_count;
+
+static void counting_free(void* data) {
+	freed_count += 1;
+	free(data);
+}
+
+// Budget that fits roughly three 1000-byte thumbnails plus bookkeeping
+#define SMALL_BUDGET 3600
+
+static void* make_thumb(void) {
+	return malloc(1000);
+}
+
+void setUp(void) {
+	freed_count = 0;
+}
+
+void tearDown(void) {
+	// Nothing to clean up
+}
+
+///////////////////////////////
+// Lifecycle
+///////////////////////////////
+
+void test_ThumbCache_new_creates_empty_cache(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+
+	TEST_ASSERT_NOT_NULL(cache);
+	TEST_ASSERT_EQUAL_INT(0, cache->count);
+	TEST_ASSERT_EQUAL_UINT(0, cache->bytes);
+	TEST_ASSERT_NULL(cache->head);
+	TEST_ASSERT_NULL(cache->tail);
+
+	ThumbCache_free(cache);
+}
+
+void test_ThumbCache_free_releases_values(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	ThumbCache_put(cache, "/a.png", make_thumb(), 1000);
+	ThumbCache_put(cache, "/b.png", make_thumb(), 1000);
+
+	ThumbCache_free(cache);
+
+	TEST_ASSERT_EQUAL_INT(2, freed_count);
+}
+
+void test_ThumbCache_free_null_is_safe(void) {
+	ThumbCache_free(NULL);
+	TEST_PASS();
+}
+
+///////////////////////////////
+// Lookup
+///////////////////////////////
+
+void test_ThumbCache_get_returns_inserted_value(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	void* thumb = make_thumb();
+	ThumbCache_put(cache, "/a.png", thumb, 1000);
+
+	void* found = NULL;
+	TEST_ASSERT_EQUAL_INT(1, ThumbCache_get(cache, "/a.png", &found));
+	TEST_ASSERT_EQUAL_PTR(thumb, found);
+
+	ThumbCache_free(cache);
+}
+
+void test_ThumbCache_get_miss_returns_zero(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+
+	void* found = (void*)0x1;
+	TEST_ASSERT_EQUAL_INT(0, ThumbCache_get(cache, "/missing.png", &found));
+	TEST_ASSERT_EQUAL_PTR((void*)0x1, found);
+
+	ThumbCache_free(cache);
+}
+
+void test_ThumbCache_caches_missing_thumbnails(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	ThumbCache_put(cache, "/none.png", NULL, 0);
+
+	void* found = (void*)0x1;
+	TEST_ASSERT_EQUAL_INT(1, ThumbCache_get(cache, "/none.png", &found));
+	TEST_ASSERT_NULL(found);
+	TEST_ASSERT_TRUE(cache->bytes > 0); // bookkeeping is still charged
+
+	ThumbCache_free(cache);
+	TEST_ASSERT_EQUAL_INT(0, freed_count);
+}
+
+void test_ThumbCache_get_promotes_to_head(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	ThumbCache_put(cache, "/a.png", make_thumb(), 1000);
+	ThumbCache_put(cache, "/b.png", make_thumb(), 1000);
+
+	ThumbCache_get(cache, "/a.png", NULL);
+
+	TEST_ASSERT_EQUAL_STRING("/a.png", cache->head->key);
+	TEST_ASSERT_EQUAL_STRING("/b.png", cache->tail->key);
+
+	ThumbCache_free(cache);
+}
+
+void test_ThumbCache_has_does_not_promote(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	ThumbCache_put(cache, "/a.png", make_thumb(), 1000);
+	ThumbCache_put(cache, "/b.png", make_thumb(), 1000);
+
+	TEST_ASSERT_EQUAL_INT(1, ThumbCache_has(cache, "/a.png"));
+	TEST_ASSERT_EQUAL_INT(0, ThumbCache_has(cache, "/c.png"));
+	TEST_ASSERT_EQUAL_STRING("/b.png", cache->head->key);
+
+	ThumbCache_free(cache);
+}
+
+///////////////////////////////
+// Eviction
+///////////////////////////////
+
+void test_ThumbCache_evicts_least_recently_used(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	ThumbCache_put(cache, "/a.png", make_thumb(), 1000);
+	ThumbCache_put(cache, "/b.png", make_thumb(), 1000);
+	ThumbCache_put(cache, "/c.png", make_thumb(), 1000);
+	ThumbCache_get(cache, "/a.png", NULL); // a is now most recent, b is oldest
+
+	ThumbCache_put(cache, "/d.png", make_thumb(), 1000);
+
+	TEST_ASSERT_EQUAL_INT(1, freed_count);
+	TEST_ASSERT_EQUAL_INT(0, ThumbCache_has(cache, "/b.png"));
+	TEST_ASSERT_EQUAL_INT(1, ThumbCache_has(cache, "/a.png"));
+	TEST_ASSERT_EQUAL_INT(1, ThumbCache_has(cache, "/c.png"));
+	TEST_ASSERT_EQUAL_INT(1, ThumbCache_has(cache, "/d.png"));
+	TEST_ASSERT_TRUE(cache->bytes <= cache->budget);
+
+	ThumbCache_free(cache);
+}
+
+void test_ThumbCache_keeps_oversized_insert(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	ThumbCache_put(cache, "/a.png", make_thumb(), 1000);
+
+	ThumbCache_put(cache, "/huge.png", malloc(10000), 10000);
+
+	TEST_ASSERT_EQUAL_INT(1, cache->count);
+	TEST_ASSERT_EQUAL_INT(1, ThumbCache_has(cache, "/huge.png"));
+	TEST_ASSERT_EQUAL_INT(1, freed_count);
+
+	ThumbCache_free(cache);
+}
+
+void test_ThumbCache_put_replaces_existing_key(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	ThumbCache_put(cache, "/a.png", make_thumb(), 1000);
+	size_t bytes = cache->bytes;
+
+	void* replacement = make_thumb();
+	ThumbCache_put(cache, "/a.png", replacement, 1000);
+
+	void* found = NULL;
+	ThumbCache_get(cache, "/a.png", &found);
+	TEST_ASSERT_EQUAL_PTR(replacement, found);
+	TEST_ASSERT_EQUAL_INT(1, cache->count);
+	TEST_ASSERT_EQUAL_UINT(bytes, cache->bytes);
+	TEST_ASSERT_EQUAL_INT(1, freed_count);
+
+	ThumbCache_free(cache);
+}
+
+void test_ThumbCache_pinned_entry_survives_eviction(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	ThumbCache_put(cache, "/shown.png", make_thumb(), 1000);
+	ThumbCache_pin(cache, "/shown.png");
+
+	// Prefetched neighbors push the displayed thumbnail to the tail
+	ThumbCache_put(cache, "/b.png", make_thumb(), 1000);
+	ThumbCache_put(cache, "/c.png", make_thumb(), 1000);
+	ThumbCache_put(cache, "/d.png", make_thumb(), 1000);
+
+	TEST_ASSERT_EQUAL_INT(1, ThumbCache_has(cache, "/shown.png"));
+	TEST_ASSERT_EQUAL_INT(0, ThumbCache_has(cache, "/b.png"));
+
+	ThumbCache_free(cache);
+}
+
+void test_ThumbCache_pin_applies_to_later_insert(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	ThumbCache_pin(cache, "/shown.png");
+	ThumbCache_put(cache, "/shown.png", make_thumb(), 1000);
+
+	ThumbCache_put(cache, "/b.png", make_thumb(), 1000);
+	ThumbCache_put(cache, "/c.png", make_thumb(), 1000);
+	ThumbCache_put(cache, "/d.png", make_thumb(), 1000);
+
+	TEST_ASSERT_EQUAL_INT(1, ThumbCache_has(cache, "/shown.png"));
+
+	ThumbCache_pin(cache, NULL);
+	ThumbCache_put(cache, "/e.png", make_thumb(), 1000);
+	TEST_ASSERT_EQUAL_INT(0, ThumbCache_has(cache, "/shown.png"));
+
+	ThumbCache_free(cache);
+}
+
+void test_ThumbCache_clear_empties_cache(void) {
+	ThumbCache* cache = ThumbCache_new(SMALL_BUDGET, counting_free);
+	ThumbCache_put(cache, "/a.png", make_thumb(), 1000);
+	ThumbCache_put(cache, "/b.png", NULL, 0);
+
+	ThumbCache_clear(cache);
+
+	TEST_ASSERT_EQUAL_INT(0, cache->count);
+	TEST_ASSERT_EQUAL_UINT(0, cache->bytes);
+	TEST_ASSERT_NULL(cache->head);
+	TEST_ASSERT_NULL(cache->tail);
+	TEST_ASSERT_EQUAL_INT(1, freed_count);
+
+	ThumbCache_free(cache);
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Lifecycle
+	RUN_TEST(test_ThumbCache_new_creates_empty_cache);
+	RUN_TEST(test_ThumbCache_free_releases_values);
+	RUN_TEST(test_ThumbCache_free_null_is_safe);
+
+	// Lookup
+	RUN_TEST(test_ThumbCache_get_returns_inserted_value);
+	RUN_TEST(test_ThumbCache_get_miss_returns_zero);
+	RUN_TEST(test_ThumbCache_caches_missing_thumbnails);
+	RUN_TEST(test_ThumbCache_get_promotes_to_head);
+	RUN_TEST(test_ThumbCache_has_does_not_promote);
+
+	// Eviction
+	RUN_TEST(test_ThumbCache_evicts_least_recently_used);
+	RUN_TEST(test_ThumbCache_keeps_oversized_insert);
+	RUN_TEST(test_ThumbCache_put_replaces_existing_key);
+	RUN_TEST(test_ThumbCache_pinned_entry_survives_eviction);
+	RUN_TEST(test_ThumbCache_pin_applies_to_later_insert);
+	RUN_TEST(test_ThumbCache_clear_empties_cache);
+
+	return UNITY_END();
+}
@@ -0,0 +1,234 @@
+/**
+ * test_thumb_store.c - Tests for the persistent thumbnail cache
+ *
+ * Round-trips thumbnails through real files in a temp directory and
+ * verifies that stale or mismatched entries are rejected.
+ *
+ * Test coverage:
+ * - ThumbStore_getPath - Cache file naming
+ * - ThumbStore_write/open/readPixels - Round trip
+ * - Invalidation on source mtime/size, target box and path mismatch
+ * - Truncated and missing files
+ */
+
+#include "../../../support/unity/unity.h"
+#include "../../../../workspace/all/common/thumb_store.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SRC_PATH "/mnt/SDCARD/Roms/GB/.res/Tetris.gb.png"
+
+static char temp_dir[] = "/tmp/thumbstore_XXXXXX";
+static char cache_file[256];
+
+// 3x2 RGB565 thumbnail, pitch padded to 8 bytes like SDL does
+static uint8_t pixels[16];
+
+static ThumbStoreInfo make_info(void) {
+	ThumbStoreInfo info = {0};
+	info.mtime = 1700000000;
+	info.size = 12345;
+	info.max_w = 256;
+	info.max_h = 480;
+	info.w = 3;
+	info.h = 2;
+	info.pitch = 8;
+	info.bpp = 16;
+	info.rmask = 0xF800;
+	info.gmask = 0x07E0;
+	info.bmask = 0x001F;
+	info.amask = 0;
+	return info;
+}
+
+static ThumbStoreInfo make_key(void) {
+	ThumbStoreInfo key = {0};
+	key.mtime = 1700000000;
+	key.size = 12345;
+	key.max_w = 256;
+	key.max_h = 480;
+	return key;
+}
+
+void setUp(void) {
+	strcpy(temp_dir, "/tmp/thumbstore_XXXXXX");
+	TEST_ASSERT_NOT_NULL(mkdtemp(temp_dir));
+	TEST_ASSERT_TRUE(ThumbStore_getPath(cache_file, sizeof(cache_file), temp_dir, SRC_PATH));
+	for (int i = 0; i < (int)sizeof(pixels); i++)
+		pixels[i] = (uint8_t)(i * 7 + 1);
+}
+
+void tearDown(void) {
+	unlink(cache_file);
+	rmdir(temp_dir);
+}
+
+///////////////////////////////
+// Path Tests
+///////////////////////////////
+
+void test_ThumbStore_getPath_is_stable(void) {
+	char a[256], b[256];
+	ThumbStore_getPath(a, sizeof(a), "/cache", SRC_PATH);
+	ThumbStore_getPath(b, sizeof(b), "/cache", SRC_PATH);
+
+	TEST_ASSERT_EQUAL_STRING(a, b);
+	TEST_ASSERT_EQUAL_INT(0, strncmp(a, "/cache/", 7));
+	TEST_ASSERT_NOT_NULL(strstr(a, ".thumb"));
+}
+
+void test_ThumbStore_getPath_differs_per_source(void) {
+	char a[256], b[256];
+	ThumbStore_getPath(a, sizeof(a), "/cache", "/Roms/GB/.res/A.gb.png");
+	ThumbStore_getPath(b, sizeof(b), "/cache", "/Roms/GB/.res/B.gb.png");
+
+	TEST_ASSERT_TRUE(strcmp(a, b) != 0);
+}
+
+void test_ThumbStore_getPath_fails_when_too_long(void) {
+	char small[16];
+	TEST_ASSERT_EQUAL_INT(0, ThumbStore_getPath(small, sizeof(small), "/cache", SRC_PATH));
+}
+
+///////////////////////////////
+// Round Trip Tests
+///////////////////////////////
+
+void test_ThumbStore_round_trip(void) {
+	ThumbStoreInfo info = make_info();
+	TEST_ASSERT_TRUE(ThumbStore_write(cache_file, SRC_PATH, &info, pixels));
+
+	ThumbStoreInfo key = make_key();
+	int fd = ThumbStore_open(cache_file, SRC_PATH, &key);
+	TEST_ASSERT_TRUE(fd >= 0);
+
+	TEST_ASSERT_EQUAL_INT(3, key.w);
+	TEST_ASSERT_EQUAL_INT(2, key.h);
+	TEST_ASSERT_EQUAL_INT(8, key.pitch);
+	TEST_ASSERT_EQUAL_UINT(16, key.bpp);
+	TEST_ASSERT_EQUAL_HEX32(0xF800, key.rmask);
+
+	uint8_t read_back[sizeof(pixels)] = {0};
+	TEST_ASSERT_TRUE(ThumbStore_readPixels(fd, &key, read_back));
+	TEST_ASSERT_EQUAL_MEMORY(pixels, read_back, sizeof(pixels));
+	close(fd);
+}
+
+void test_ThumbStore_write_replaces_existing(void) {
+	ThumbStoreInfo info = make_info();
+	ThumbStore_write(cache_file, SRC_PATH, &info, pixels);
+
+	info.mtime += 60;
+	pixels[0] = 0xAB;
+	TEST_ASSERT_TRUE(ThumbStore_write(cache_file, SRC_PATH, &info, pixels));
+
+	ThumbStoreInfo key = make_key();
+	key.mtime += 60;
+	int fd = ThumbStore_open(cache_file, SRC_PATH, &key);
+	TEST_ASSERT_TRUE(fd >= 0);
+
+	uint8_t read_back[sizeof(pixels)] = {0};
+	ThumbStore_readPixels(fd, &key, read_back);
+	TEST_ASSERT_EQUAL_HEX8(0xAB, read_back[0]);
+	close(fd);
+}
+
+///////////////////////////////
+// Invalidation Tests
+///////////////////////////////
+
+void test_ThumbStore_open_missing_file(void) {
+	ThumbStoreInfo key = make_key();
+	TEST_ASSERT_EQUAL_INT(-1, ThumbStore_open(cache_file, SRC_PATH, &key));
+}
+
+void test_ThumbStore_open_rejects_changed_mtime(void) {
+	ThumbStoreInfo info = make_info();
+	ThumbStore_write(cache_file, SRC_PATH, &info, pixels);
+
+	ThumbStoreInfo key = make_key();
+	key.mtime += 1;
+	TEST_ASSERT_EQUAL_INT(-1, ThumbStore_open(cache_file, SRC_PATH, &key));
+}
+
+void test_ThumbStore_open_rejects_changed_size(void) {
+	ThumbStoreInfo info = make_info();
+	ThumbStore_write(cache_file, SRC_PATH, &info, pixels);
+
+	ThumbStoreInfo key = make_key();
+	key.size = 999;
+	TEST_ASSERT_EQUAL_INT(-1, ThumbStore_open(cache_file, SRC_PATH, &key));
+}
+
+void test_ThumbStore_open_rejects_different_box(void) {
+	ThumbStoreInfo info = make_info();
+	ThumbStore_write(cache_file, SRC_PATH, &info, pixels);
+
+	ThumbStoreInfo key = make_key();
+	key.max_w = 400;
+	TEST_ASSERT_EQUAL_INT(-1, ThumbStore_open(cache_file, SRC_PATH, &key));
+}
+
+void test_ThumbStore_open_rejects_hash_collision(void) {
+	ThumbStoreInfo info = make_info();
+	ThumbStore_write(cache_file, SRC_PATH, &info, pixels);
+
+	ThumbStoreInfo key = make_key();
+	TEST_ASSERT_EQUAL_INT(-1,
+	                      ThumbStore_open(cache_file, "/mnt/SDCARD/Roms/GB/.res/Other.png", &key));
+}
+
+void test_ThumbStore_readPixels_fails_on_truncated_file(void) {
+	ThumbStoreInfo info = make_info();
+	ThumbStore_write(cache_file, SRC_PATH, &info, pixels);
+	truncate(cache_file, sizeof(ThumbStoreInfo) + strlen(SRC_PATH) + 4);
+
+	ThumbStoreInfo key = make_key();
+	int fd = ThumbStore_open(cache_file, SRC_PATH, &key);
+	TEST_ASSERT_TRUE(fd >= 0);
+
+	uint8_t read_back[sizeof(pixels)];
+	TEST_ASSERT_EQUAL_INT(0, ThumbStore_readPixels(fd, &key, read_back));
+	close(fd);
+}
+
+void test_ThumbStore_open_rejects_garbage(void) {
+	FILE* file = fopen(cache_file, "wb");
+	fputs("not a thumbnail", file);
+	fclose(file);
+
+	ThumbStoreInfo key = make_key();
+	TEST_ASSERT_EQUAL_INT(-1, ThumbStore_open(cache_file, SRC_PATH, &key));
+}
+
+///////////////////////////////
+// Test Runner
+///////////////////////////////
+
+int main(void) {
+	UNITY_BEGIN();
+
+	// Path
+	RUN_TEST(test_ThumbStore_getPath_is_stable);
+	RUN_TEST(test_ThumbStore_getPath_differs_per_source);
+	RUN_TEST(test_ThumbStore_getPath_fails_when_too_long);
+
+	// Round trip
+	RUN_TEST(test_ThumbStore_round_trip);
+	RUN_TEST(test_ThumbStore_write_replaces_existing);
+
+	// Invalidation
+	RUN_TEST(test_ThumbStore_open_missing_file);
+	RUN_TEST(test_ThumbStore_open_rejects_changed_mtime);
+	RUN_TEST(test_ThumbStore_open_rejects_changed_size);
+	RUN_TEST(test_ThumbStore_open_rejects_different_box);
+	RUN_TEST(test_ThumbStore_open_rejects_hash_collision);
+	RUN_TEST(test_ThumbStore_readPixels_fails_on_truncated_file);
+	RUN_TEST(test_ThumbStore_open_rejects_garbage);
+
+	return UNITY_END();
+}
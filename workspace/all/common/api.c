@@ -26,8 +26,10 @@
 #include <stdlib.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <fcntl.h>
+#include <poll.h>
 #include <pthread.h>
 #include <unistd.h>
 
@@ -38,11 +40,15 @@
 #include <msettings.h>
 
 #include "api.h"
+#include "asset_cache.h"
 // NOLINTNEXTLINE(bugprone-suspicious-include) - Intentionally bundled to avoid makefile changes
 #include "audio_resampler.c"
+#include "battery.h"
 #include "defines.h"
 #include "gfx_text.h"
+#include "input_thread.h"
 #include "pad.h"
+#include "scaler_pool.h"
 #include "utils.h"
 
 ///////////////////////////////
@@ -241,6 +247,7 @@ void UI_initLayout(int screen_width, int screen_height, float diagonal_inches) {
 static struct GFX_Context {
 	SDL_Surface* screen;
 	SDL_Surface* assets;
+	AssetCache* asset_cache; // Backs assets when loaded from ASSET_CACHE_PATH
 
 	int mode;
 	int vsync;
@@ -262,9 +269,15 @@ static struct PWR_Context {
 	int requested_wake;
 
 	pthread_t battery_pt;
+	pthread_mutex_t battery_mutex;
+	pthread_cond_t battery_cond; // Wakes the battery thread early
+	int battery_quit;
 	int is_charging;
 	int charge;
-	int should_warn;
+	int minutes;
+	int should_warn; // Only set while a game is running
+	uint32_t battery_at; // When the battery thread samples next
+	uint32_t update_at; // Next timed change PWR_update() makes on its own
 
 	SDL_Surface* overlay;
 } pwr = {0};
@@ -285,6 +298,9 @@ static int _;
  * tiers to the exact dp_scale required by the current screen. Provides
  * smooth edges compared to nearest-neighbor scaling.
  *
+ * 32-bit surfaces go through scaleBilinear_n32/c32. Other depths use the
+ * same 16.16 positions and 8-bit weights one channel at a time.
+ *
  * @param src Source surface to scale
  * @param dst Destination surface (must be pre-allocated at target size)
  *
@@ -293,7 +309,7 @@ static int _;
  * @note dst dimensions determine the output scale
  */
 static void GFX_scaleBilinear(SDL_Surface* src, SDL_Surface* dst) {
-	if (!src || !dst)
+	if (!src || !dst || dst->w <= 0 || dst->h <= 0)
 		return;
 
 	int src_w = src->w;
@@ -301,10 +317,6 @@ static void GFX_scaleBilinear(SDL_Surface* src, SDL_Surface* dst) {
 	int dst_w = dst->w;
 	int dst_h = dst->h;
 
-	// Calculate scale ratios (how much to step through source for each dest pixel)
-	float x_ratio = ((float)src_w) / dst_w;
-	float y_ratio = ((float)src_h) / dst_h;
-
 	// Determine bytes per pixel (3 for RGB, 4 for RGBA)
 	int bpp = src->format->BytesPerPixel;
 
@@ -317,39 +329,45 @@ static void GFX_scaleBilinear(SDL_Surface* src, SDL_Surface* dst) {
 	uint8_t* src_pixels = (uint8_t*)src->pixels;
 	uint8_t* dst_pixels = (uint8_t*)dst->pixels;
 
-	for (int y = 0; y < dst_h; y++) {
-		for (int x = 0; x < dst_w; x++) {
-			// Source coordinates (floating point)
-			float src_x = x * x_ratio;
-			float src_y = y * y_ratio;
-
-			// Integer coordinates of surrounding pixels
-			int x1 = (int)src_x;
-			int y1 = (int)src_y;
-			int x2 = (x1 + 1 < src_w) ? x1 + 1 : x1;
+	if (bpp == 4 && dst->format->BytesPerPixel == 4) {
+#ifdef HAS_NEON
+		scaleBilinear_n32(src_pixels, dst_pixels, src_w, src_h, src->pitch, dst_w, dst_h,
+		                  dst->pitch);
+#else
+		scaleBilinear_c32(src_pixels, dst_pixels, src_w, src_h, src->pitch, dst_w, dst_h,
+		                  dst->pitch);
+#endif
+	} else {
+		for (int y = 0; y < dst_h; y++) {
+			// Source position in 16.16 fixed point
+			uint32_t pos_y = (uint32_t)(((uint64_t)y * src_h << 16) / dst_h);
+			int y1 = pos_y >> 16;
 			int y2 = (y1 + 1 < src_h) ? y1 + 1 : y1;
-
-			// Fractional parts for interpolation
-			float x_frac = src_x - x1;
-			float y_frac = src_y - y1;
-
-			// Get pointers to the 4 surrounding pixels
-			uint8_t* p11 = src_pixels + (y1 * src->pitch) + (x1 * bpp);
-			uint8_t* p12 = src_pixels + (y1 * src->pitch) + (x2 * bpp);
-			uint8_t* p21 = src_pixels + (y2 * src->pitch) + (x1 * bpp);
-			uint8_t* p22 = src_pixels + (y2 * src->pitch) + (x2 * bpp);
-
-			// Bilinear interpolation for each channel
-			uint8_t* dst_pixel = dst_pixels + (y * dst->pitch) + (x * bpp);
-
-			for (int c = 0; c < bpp; c++) {
-				// Interpolate horizontally on top row
-				float top = p11[c] * (1.0f - x_frac) + p12[c] * x_frac;
-				// Interpolate horizontally on bottom row
-				float bottom = p21[c] * (1.0f - x_frac) + p22[c] * x_frac;
-				// Interpolate vertically
-				float result = top * (1.0f - y_frac) + bottom * y_frac;
-				dst_pixel[c] = (uint8_t)(result + 0.5f);
+			uint32_t y_frac = (pos_y >> 8) & 0xFF;
+
+			uint8_t* row1 = src_pixels + (y1 * src->pitch);
+			uint8_t* row2 = src_pixels + (y2 * src->pitch);
+			uint8_t* dst_pixel = dst_pixels + (y * dst->pitch);
+
+			for (int x = 0; x < dst_w; x++) {
+				uint32_t pos_x = (uint32_t)(((uint64_t)x * src_w << 16) / dst_w);
+				int x1 = pos_x >> 16;
+				int x2 = (x1 + 1 < src_w) ? x1 + 1 : x1;
+				uint32_t x_frac = (pos_x >> 8) & 0xFF;
+
+				// Get pointers to the 4 surrounding pixels
+				uint8_t* p11 = row1 + (x1 * bpp);
+				uint8_t* p12 = row1 + (x2 * bpp);
+				uint8_t* p21 = row2 + (x1 * bpp);
+				uint8_t* p22 = row2 + (x2 * bpp);
+
+				for (int c = 0; c < bpp; c++) {
+					// Interpolate horizontally on both rows, then vertically
+					uint32_t top = p11[c] * (256 - x_frac) + p12[c] * x_frac;
+					uint32_t bottom = p21[c] * (256 - x_frac) + p22[c] * x_frac;
+					dst_pixel[c] = (top * (256 - y_frac) + bottom * y_frac + 32768) >> 16;
+				}
+				dst_pixel += bpp;
 			}
 		}
 	}
@@ -418,6 +436,8 @@ SDL_Surface* GFX_scaleToFit(SDL_Surface* src, int max_w, int max_h) {
  *   - Buttons/holes → exactly button_px
  *   - Icons (brightness, volume, wifi) → proportional with even-pixel centering
  *   - Battery assets → proportional scaling (internal offsets handled in GFX_blitBattery)
+ * - The scaled atlas is cached at ASSET_CACHE_PATH, keyed by the PNG's contents, dp_scale
+ *   and sprite sizes; later launches mmap it instead of decoding and scaling again
  * - Defines rectangles for each asset sprite in the texture atlas
  * - Maps asset IDs to RGB color values for fills
  *
@@ -481,7 +501,6 @@ SDL_Surface* GFX_init(int mode) {
 	sprintf(asset_path, RES_PATH "/assets@%ix.png", asset_scale);
 	if (!exists(asset_path))
 		LOG_info("missing assets, you're about to segfault dummy!\n");
-	SDL_Surface* loaded_assets = IMG_Load(asset_path);
 
 	// Define asset rectangles in the loaded sprite sheet (at asset_scale)
 	// Base coordinates are @1x, multiply by asset_scale for actual position
@@ -565,7 +584,42 @@ SDL_Surface* GFX_init(int mode) {
 	int needs_scaling =
 	    (fabsf(gfx_dp_scale - (float)asset_scale) > 0.01f) || (virtual_asset_count > 0);
 
+	// The scaled atlas only depends on these, so reuse it across launches
+	AssetCacheKey cache_key;
+	char cache_path[MAX_PATH];
 	if (needs_scaling) {
+		uint32_t masks[4] = {RGBA_MASK_8888};
+		memset(&cache_key, 0, sizeof(cache_key));
+		cache_key.source_hash = AssetCache_hashFile(asset_path);
+		cache_key.dp_scale = gfx_dp_scale;
+		cache_key.asset_scale = asset_scale;
+		cache_key.pill_px = pill_px;
+		cache_key.button_px = button_px;
+		cache_key.option_px = option_px;
+		cache_key.bpp = 32;
+		cache_key.rmask = masks[0];
+		cache_key.gmask = masks[1];
+		cache_key.bmask = masks[2];
+		cache_key.amask = masks[3];
+		snprintf(cache_path, sizeof(cache_path), ASSET_CACHE_PATH, gfx.screen->w, gfx.screen->h);
+		if (cache_key.source_hash)
+			gfx.asset_cache = AssetCache_load(cache_path, &cache_key, ASSET_COUNT);
+	}
+
+	SDL_Surface* loaded_assets = gfx.asset_cache ? NULL : IMG_Load(asset_path);
+
+	if (gfx.asset_cache) {
+		AssetCache* cache = gfx.asset_cache;
+		gfx.assets = SDL_CreateRGBSurfaceFrom(cache->pixels, cache->w, cache->h, 32, cache->pitch,
+		                                      RGBA_MASK_8888);
+		for (int i = 0; i < ASSET_COUNT; i++) {
+			const AssetCacheRect* rect = &cache->rects[i];
+			asset_rects[i] = (SDL_Rect){rect->x, rect->y, rect->w, rect->h};
+		}
+
+		LOG_info("GFX_init: Loaded %d cached assets for dp_scale=%.2f\n", ASSET_COUNT,
+		         gfx_dp_scale);
+	} else if (needs_scaling) {
 		// Calculate destination sheet dimensions
 		// Add extra row for virtual assets (those scaled to custom sizes)
 		int sheet_w = (int)(loaded_assets->w * scale_ratio + 0.5f);
@@ -657,6 +711,16 @@ SDL_Surface* GFX_init(int mode) {
 
 		LOG_info("GFX_init: Scaled %d assets from @%dx to dp_scale=%.2f (bilinear)\n", ASSET_COUNT,
 		         asset_scale, gfx_dp_scale);
+
+		if (cache_key.source_hash) {
+			AssetCacheRect rects[ASSET_COUNT];
+			for (int i = 0; i < ASSET_COUNT; i++)
+				rects[i] = (AssetCacheRect){asset_rects[i].x, asset_rects[i].y, asset_rects[i].w,
+				                            asset_rects[i].h};
+			mkdir(USERDATA_PATH "/.minui", 0755);
+			AssetCache_save(cache_path, &cache_key, rects, ASSET_COUNT, gfx.assets->pixels,
+			                gfx.assets->w, gfx.assets->h, gfx.assets->pitch);
+		}
 	} else {
 		// Perfect match, use assets as-is
 		gfx.assets = loaded_assets;
@@ -678,18 +742,22 @@ SDL_Surface* GFX_init(int mode) {
 /**
  * Shuts down the graphics subsystem and frees all resources.
  *
- * Closes all fonts, frees the asset texture, clears video memory,
- * and calls platform-specific cleanup.
+ * Frees cached text, closes all fonts, frees the asset texture, clears
+ * video memory, and calls platform-specific cleanup.
  *
  * @note Should be called before program exit to prevent resource leaks
  */
 void GFX_quit(void) {
+	GFX_clearTextCache();
+
 	TTF_CloseFont(font.large);
 	TTF_CloseFont(font.medium);
 	TTF_CloseFont(font.small);
 	TTF_CloseFont(font.tiny);
 
 	SDL_FreeSurface(gfx.assets);
+	AssetCache_free(gfx.asset_cache); // after the surface that points into it
+	gfx.asset_cache = NULL;
 
 	GFX_freeAAScaler();
 
@@ -743,6 +811,12 @@ void GFX_setVsync(int vsync) {
  */
 int GFX_hdmiChanged(void) {
 	static int had_hdmi = -1;
+	static int settings_seq = 0;
+	int seq = GetSettingsSeq();
+	if (had_hdmi != -1 && seq == settings_seq)
+		return 0;
+	settings_seq = seq;
+
 	int has_hdmi = GetHDMI();
 	if (had_hdmi == -1)
 		had_hdmi = has_hdmi;
@@ -856,46 +930,18 @@ FALLBACK_IMPLEMENTATION void PLAT_setEffectColor(int next_color) {}
 // Graphics - Anti-aliased scaling (from picoarch)
 ///////////////////////////////
 
-// Blend arguments structure for anti-aliased scaling
-// Stores the ratio and blend point calculations for both dimensions
-struct blend_args {
-	int w_ratio_in;
-	int w_ratio_out;
-	uint16_t w_bp[2];
-	int h_ratio_in;
-	int h_ratio_out;
-	uint16_t h_bp[2];
-	uint16_t* blend_line; // Temporary buffer for blended scanlines
-} blend_args;
-
-// Color averaging macros using math_utils functions from utils.c
-// Skip averaging if colors are identical for optimization
-#define AVERAGE16_NOCHK(c1, c2) (average16((c1), (c2)))
-#define AVERAGE32_NOCHK(c1, c2) (average32((c1), (c2)))
-
-#define AVERAGE16(c1, c2) ((c1) == (c2) ? (c1) : AVERAGE16_NOCHK((c1), (c2)))
-// 1:3 weighted average (closer to c2)
-#define AVERAGE16_1_3(c1, c2)                                                                      \
-	((c1) == (c2) ? (c1) : (AVERAGE16_NOCHK(AVERAGE16_NOCHK((c1), (c2)), (c2))))
-
-#define AVERAGE32(c1, c2) ((c1) == (c2) ? (c1) : AVERAGE32_NOCHK((c1), (c2)))
-// 1:3 weighted average for paired RGB565 pixels
-#define AVERAGE32_1_3(c1, c2)                                                                      \
-	((c1) == (c2) ? (c1) : (AVERAGE32_NOCHK(AVERAGE32_NOCHK((c1), (c2)), (c2))))
-
-/**
- * Anti-aliased scaler implementation using bilinear interpolation.
- *
- * Scales RGB565 source image to destination with anti-aliasing for smoother
- * results than nearest-neighbor. Uses quintic blending zones for smooth
- * transitions between pixels.
- *
- * Algorithm divides each source pixel into 5 zones when scaling:
- * - Zone 1 (outer): 100% source pixel A
- * - Zone 2: 75% A, 25% B (1:3 blend)
- * - Zone 3 (center): 50% A, 50% B (even blend)
- * - Zone 4: 25% A, 75% B (1:3 blend)
- * - Zone 5 (outer): 100% source pixel B
+// Tables for the current renderer, rebuilt by GFX_getAAScaler
+static AAScaler aa_scaler;
+
+/**
+ * Anti-aliased scaler for non-integer scales.
+ *
+ * Each output pixel is one of five blends of its two nearest source pixels
+ * (all A, 1/4 B, 1/2 B, 3/4 B, all B) in both directions, giving smoother
+ * results than nearest-neighbor without a full bilinear filter. The blend
+ * for every column and row is precomputed by GFX_getAAScaler, so this runs
+ * 8 pixels at a time without per-pixel branching (see scaleAA_c16), split
+ * into row bands across cores when that measures faster.
  *
  * @param src Source image data (RGB565 format)
  * @param dst Destination image buffer
@@ -906,159 +952,45 @@ struct blend_args {
  * @param dst_h Destination height in pixels
  * @param dst_p Destination pitch in bytes
  *
- * @note Requires blend_args to be initialized via GFX_getAAScaler first
+ * @note Sizes come from the tables built by GFX_getAAScaler
  */
 static void scaleAA(void* __restrict src, void* __restrict dst, uint32_t w, uint32_t h,
                     uint32_t pitch, uint32_t dst_w, uint32_t dst_h, uint32_t dst_p) {
-	int dy = 0;
-	int lines = h;
-
-	int rat_w = blend_args.w_ratio_in;
-	int rat_dst_w = blend_args.w_ratio_out;
-	const uint16_t* bw = blend_args.w_bp;
-
-	int rat_h = blend_args.h_ratio_in;
-	int rat_dst_h = blend_args.h_ratio_out;
-	const uint16_t* bh = blend_args.h_bp;
-
-	while (lines--) {
-		while (dy < rat_dst_h) {
-			uint16_t* dst16 = (uint16_t*)dst;
-			uint16_t* pblend = (uint16_t*)blend_args.blend_line;
-			int col = w;
-			int dx = 0;
-
-			uint16_t* pnext = (uint16_t*)(src + pitch);
-			if (!lines)
-				pnext -= (pitch / sizeof(uint16_t));
-
-			if (dy > rat_dst_h - bh[0]) {
-				pblend = pnext;
-			} else if (dy <= bh[0]) {
-				/* Drops const, won't get touched later though */
-				pblend = (uint16_t*)src;
-			} else {
-				const uint32_t* src32 = (const uint32_t*)src;
-				const uint32_t* pnext32 = (const uint32_t*)pnext;
-				uint32_t* pblend32 = (uint32_t*)pblend;
-				int count = w / 2;
-
-				if (dy <= bh[1]) {
-					const uint32_t* tmp = pnext32;
-					pnext32 = src32;
-					src32 = tmp;
-				}
-
-				if (dy > rat_dst_h - bh[1] || dy <= bh[1]) {
-					while (count--) {
-						*pblend32++ = AVERAGE32_1_3(*src32, *pnext32);
-						src32++;
-						pnext32++;
-					}
-				} else {
-					while (count--) {
-						*pblend32++ = AVERAGE32(*src32, *pnext32);
-						src32++;
-						pnext32++;
-					}
-				}
-			}
-
-			while (col--) {
-				uint16_t a, b, out;
-
-				a = *pblend;
-				b = *(pblend + 1);
-
-				while (dx < rat_dst_w) {
-					if (a == b) {
-						out = a;
-					} else if (dx > rat_dst_w - bw[0]) { // top quintile, bbbb
-						out = b;
-					} else if (dx <= bw[0]) { // last quintile, aaaa
-						out = a;
-					} else {
-						if (dx > rat_dst_w - bw[1]) { // 2nd quintile, abbb
-							a = AVERAGE16_NOCHK(a, b);
-						} else if (dx <= bw[1]) { // 4th quintile, aaab
-							b = AVERAGE16_NOCHK(a, b);
-						}
-
-						out = AVERAGE16_NOCHK(a, b); // also 3rd quintile, aabb
-					}
-					*dst16++ = out;
-					dx += rat_w;
-				}
-
-				dx -= rat_dst_w;
-				pblend++;
-			}
-
-			dy += rat_h;
-			dst += dst_p;
-		}
-
-		dy -= rat_dst_h;
-		src += pitch;
-	}
+	static ScalerPoolGate gate;
+	if (!aa_scaler.col_a)
+		return;
+	ScalerPool_scaleAA(&gate, &aa_scaler, src, pitch, dst, dst_p);
 }
 
 /**
  * Initializes the anti-aliased scaler for a given renderer configuration.
  *
- * Calculates blend ratios and breakpoints based on the GCD of source
- * and destination dimensions. Allocates a temporary scanline buffer
- * for blending operations.
- *
- * The blend_denominator controls blend zone widths:
- * - 5.0 for downscaling (sharper)
- * - 2.5 for upscaling (smoother)
+ * Works out, once, which source pixels and which blend each output column
+ * and row uses. Blend zone widths come from the GCD-reduced ratio of source
+ * to destination size: ratio / 5 when downscaling (sharper), ratio / 2.5
+ * when upscaling (smoother).
  *
  * @param renderer Renderer configuration with source/dest dimensions
  * @return Function pointer to scaleAA scaler implementation
  *
- * @note Allocates blend_line buffer - call GFX_freeAAScaler to free
+ * @note Allocates the blend tables - call GFX_freeAAScaler to free
  */
 scaler_t GFX_getAAScaler(const GFX_Renderer* renderer) {
-	int gcd_w, div_w, gcd_h, div_h;
-	blend_args.blend_line = calloc(renderer->src_w, sizeof(uint16_t));
-
-	gcd_w = gcd(renderer->src_w, renderer->dst_w);
-	blend_args.w_ratio_in = renderer->src_w / gcd_w;
-	blend_args.w_ratio_out = renderer->dst_w / gcd_w;
-
-	double blend_denominator = (renderer->src_w > renderer->dst_w)
-	                               ? 5
-	                               : 2.5; // TODO: these values are really only good for the nano...
-	// blend_denominator = 5.0; // better for trimui
-	// LOG_info("blend_denominator: %f (%i && %i)\n", blend_denominator, HAS_SKINNY_SCREEN, renderer->dst_w>renderer->src_w);
-
-	div_w = round(blend_args.w_ratio_out / blend_denominator);
-	blend_args.w_bp[0] = div_w;
-	blend_args.w_bp[1] = blend_args.w_ratio_out >> 1;
-
-	gcd_h = gcd(renderer->src_h, renderer->dst_h);
-	blend_args.h_ratio_in = renderer->src_h / gcd_h;
-	blend_args.h_ratio_out = renderer->dst_h / gcd_h;
-
-	div_h = round(blend_args.h_ratio_out / blend_denominator);
-	blend_args.h_bp[0] = div_h;
-	blend_args.h_bp[1] = blend_args.h_ratio_out >> 1;
-
+	scaleAA_free(&aa_scaler);
+	if (!scaleAA_init(&aa_scaler, renderer->src_w, renderer->src_h, renderer->dst_w,
+	                  renderer->dst_h))
+		LOG_error("GFX_getAAScaler: unable to scale %ix%i to %ix%i", renderer->src_w,
+		          renderer->src_h, renderer->dst_w, renderer->dst_h);
 	return scaleAA;
 }
 
 /**
  * Frees resources allocated by the anti-aliased scaler.
  *
- * Deallocates the temporary scanline buffer used for blending.
  * Safe to call even if scaler was never initialized.
  */
 void GFX_freeAAScaler(void) {
-	if (blend_args.blend_line != NULL) {
-		free(blend_args.blend_line);
-		blend_args.blend_line = NULL;
-	}
+	scaleAA_free(&aa_scaler);
 }
 
 ///////////////////////////////
@@ -1654,6 +1586,8 @@ static struct SND_Context {
 
 	// Linear interpolation resampler with dynamic rate control
 	AudioResampler resampler;
+
+	uint64_t wait_us; // Time SND_batchSamples spent waiting for room, see SND_takeWaitTime
 } snd = {0};
 
 /**
@@ -1852,6 +1786,7 @@ size_t SND_batchSamples(const SND_Frame* frames,
 	}
 
 	// If buffer doesn't have room for estimated output, wait a bit
+	uint64_t wait_start = available < estimated_output ? getMicroseconds() : 0;
 	int tries = 0;
 	while (tries < 10 && available < estimated_output) {
 		tries++;
@@ -1866,6 +1801,8 @@ size_t SND_batchSamples(const SND_Frame* frames,
 			available = snd.frame_out - snd.frame_in - 1;
 		}
 	}
+	if (wait_start)
+		snd.wait_us += getMicroseconds() - wait_start;
 
 	// Set up ring buffer wrapper for the resampler
 	AudioRingBuffer ring = {
@@ -1944,6 +1881,19 @@ void SND_init(double sample_rate, double frame_rate) { // plat_sound_init
 	snd.initialized = 1;
 }
 
+/**
+ * Gets how long SND_batchSamples waited for buffer space since the last call.
+ *
+ * Call from the thread that runs the core, which is the one that waits.
+ *
+ * @return Microseconds spent waiting
+ */
+uint64_t SND_takeWaitTime(void) {
+	uint64_t wait_us = snd.wait_us;
+	snd.wait_us = 0;
+	return wait_us;
+}
+
 /**
  * Gets current audio buffer fill level as a percentage.
  *
@@ -2336,6 +2286,99 @@ FALLBACK_IMPLEMENTATION void PLAT_pollInput(void) {
 		pad.just_released |= BTN_SLEEP;
 }
 
+/**
+ * Blocks until an SDL event is queued or the timeout expires.
+ *
+ * Default implementation for platforms that receive input through SDL.
+ * Platforms reading evdev directly override this to poll() their devices.
+ * Under SDL 1.2 this polls the input devices SDL reads from instead of
+ * waking every frame.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return 1 if input is ready, 0 on timeout
+ */
+FALLBACK_IMPLEMENTATION int PLAT_waitForInput(uint32_t timeout_ms) {
+#if defined(USE_SDL2)
+	return SDL_WaitEventTimeout(NULL, timeout_ms);
+#else
+	// SDL 1.2 has no timed wait. New input shows up on the evdev devices
+	// SDL reads from, so open our own copies and let poll() sleep on them.
+	static int wake_fds[8];
+	static int wake_count = -1;
+	if (wake_count == -1) {
+		wake_count = 0;
+		for (int i = 0; i < 8; i++) {
+			char path[32];
+			snprintf(path, sizeof(path), "/dev/input/event%i", i);
+			int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+			if (fd >= 0)
+				wake_fds[wake_count++] = fd;
+		}
+	}
+
+	SDL_PumpEvents();
+	if (SDL_PeepEvents(NULL, 1, SDL_PEEKEVENT, SDL_ALLEVENTS) > 0)
+		return 1;
+
+	if (wake_count > 0) {
+		struct pollfd fds[8];
+		for (int i = 0; i < wake_count; i++) {
+			fds[i].fd = wake_fds[i];
+			fds[i].events = POLLIN;
+			fds[i].revents = 0;
+		}
+		int ready = poll(fds, wake_count, timeout_ms) > 0;
+
+		// Our copies only wake us, SDL still gets its own
+		char buffer[256];
+		for (int i = 0; i < wake_count; i++) {
+			if (fds[i].revents & POLLIN) {
+				while (read(fds[i].fd, buffer, sizeof(buffer)) > 0)
+					;
+			}
+		}
+		return ready;
+	}
+
+	// No devices to sleep on, peek at the queue once per frame
+	uint32_t start = SDL_GetTicks();
+	do {
+		SDL_Delay(FRAME_BUDGET);
+		SDL_PumpEvents();
+		if (SDL_PeepEvents(NULL, 1, SDL_PEEKEVENT, SDL_ALLEVENTS) > 0)
+			return 1;
+	} while (SDL_GetTicks() - start < timeout_ms);
+	return 0;
+#endif
+}
+
+/**
+ * Starts reading input on a dedicated thread.
+ *
+ * Default implementation for platforms that receive input through SDL,
+ * which has its own event thread and timestamps. Platforms reading evdev
+ * directly override this to hand their devices to input_thread.c.
+ *
+ * @return 1 if the thread is running, 0 if unsupported
+ */
+FALLBACK_IMPLEMENTATION int PLAT_startInputThread(void) {
+	return 0;
+}
+
+/**
+ * Stops the dedicated input thread.
+ */
+FALLBACK_IMPLEMENTATION void PLAT_stopInputThread(void) {}
+
+/**
+ * Gets how long the latest press waited before a poll took it.
+ *
+ * @return Microseconds, 0 without the input thread
+ */
+uint32_t PAD_getInputAge(void) {
+	return InputThread_getAge();
+}
+
 /**
  * Checks if device should wake from sleep.
  *
@@ -2509,6 +2552,14 @@ FALLBACK_IMPLEMENTATION void PLAT_enableOverlay(int enable) {
 	(void)enable; // Overlay composited in software, no hardware control needed
 }
 
+/**
+ * Default network status refresh (no-op).
+ *
+ * Platforms with wifi override this to re-read the link state that
+ * PLAT_isOnline() returns.
+ */
+FALLBACK_IMPLEMENTATION void PLAT_updateNetwork(void) {}
+
 /**
  * Initializes the low battery warning overlay.
  *
@@ -2529,30 +2580,76 @@ static void PWR_initOverlay(void) {
 /**
  * Updates battery charging state and charge level.
  *
- * Queries platform for current battery status and updates overlay
- * visibility based on charge level and warning state.
+ * Samples the platform only if the shared sample is due (see battery.h),
+ * then copies the published status and updates overlay visibility based
+ * on charge level and warning state.
  */
 static void PWR_updateBatteryStatus(void) {
-	PLAT_getBatteryStatus(&pwr.is_charging, &pwr.charge);
+	Battery_update(PLAT_getBatteryStatus, pwr.should_warn, 0);
+
+	BatteryStatus status;
+	Battery_get(&status);
+	pwr.is_charging = status.is_charging;
+	pwr.charge = status.level;
+	pwr.minutes = status.minutes;
 	PLAT_enableOverlay(pwr.should_warn && pwr.charge <= PWR_LOW_CHARGE);
 }
 
+// macOS (desktop builds) has no pthread_condattr_setclock()
+#ifdef __APPLE__
+#define PWR_WAIT_CLOCK CLOCK_REALTIME
+#else
+#define PWR_WAIT_CLOCK CLOCK_MONOTONIC
+#endif
+
 /**
  * Battery monitoring worker thread.
  *
- * Polls battery status every 5 seconds and updates the UI overlay.
- * Runs continuously in the background.
+ * Sleeps until the shared sample is due, which is sooner while charging
+ * or low and later in game, then updates the status. The wifi state is
+ * refreshed every PWR_NETWORK_INTERVAL in every process, whether or not
+ * this one takes the battery sample. PWR_warn() wakes it so a change
+ * between menu and game takes effect right away.
  *
  * @param arg Unused thread argument
- * @return Never returns (infinite loop)
+ * @return NULL once PWR_quit() stops it
  */
 static void* PWR_monitorBattery(void* arg) {
-	while (1) {
-		// TODO: the frequency of checking could depend on whether
-		// we're in game (less frequent) or menu (more frequent)
-		sleep(5);
+	uint32_t network_at = SDL_GetTicks() + PWR_NETWORK_INTERVAL;
+
+	pthread_mutex_lock(&pwr.battery_mutex);
+	while (!pwr.battery_quit) {
+		int wait_ms = Battery_untilDue(pwr.should_warn);
+		if (wait_ms == 0) // Another process is sampling
+			wait_ms = BATTERY_INTERVAL_FAST;
+		uint32_t now = SDL_GetTicks();
+		int network_ms = (int32_t)(network_at - now);
+		if (network_ms < wait_ms)
+			wait_ms = network_ms > 0 ? network_ms : 0;
+		pwr.battery_at = now + wait_ms;
+
+		struct timespec until;
+		clock_gettime(PWR_WAIT_CLOCK, &until);
+		until.tv_sec += wait_ms / 1000;
+		until.tv_nsec += (long)(wait_ms % 1000) * 1000000;
+		if (until.tv_nsec >= 1000000000) {
+			until.tv_sec += 1;
+			until.tv_nsec -= 1000000000;
+		}
+		pthread_cond_timedwait(&pwr.battery_cond, &pwr.battery_mutex, &until);
+		if (pwr.battery_quit)
+			break;
+
+		pthread_mutex_unlock(&pwr.battery_mutex);
+		now = SDL_GetTicks();
+		if ((int32_t)(network_at - now) <= 0) {
+			PLAT_updateNetwork();
+			network_at = now + PWR_NETWORK_INTERVAL;
+		}
 		PWR_updateBatteryStatus();
+		pthread_mutex_lock(&pwr.battery_mutex);
 	}
+	pthread_mutex_unlock(&pwr.battery_mutex);
 	return NULL;
 }
 
@@ -2575,7 +2672,19 @@ void PWR_init(void) {
 
 	PWR_initOverlay();
 
+	PLAT_updateNetwork();
+	Battery_open(BATTERY_SHM_NAME);
 	PWR_updateBatteryStatus();
+
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+#ifndef __APPLE__
+	pthread_condattr_setclock(&attr, PWR_WAIT_CLOCK);
+#endif
+	pthread_cond_init(&pwr.battery_cond, &attr);
+	pthread_condattr_destroy(&attr);
+	pthread_mutex_init(&pwr.battery_mutex, NULL);
+	pwr.battery_quit = 0;
 	pthread_create(&pwr.battery_pt, NULL, &PWR_monitorBattery, NULL);
 	pwr.initialized = 1;
 }
@@ -2592,9 +2701,17 @@ void PWR_quit(void) {
 
 	PLAT_quitOverlay();
 
-	// cancel battery thread
-	pthread_cancel(pwr.battery_pt);
+	// stop battery thread
+	pthread_mutex_lock(&pwr.battery_mutex);
+	pwr.battery_quit = 1;
+	pthread_cond_signal(&pwr.battery_cond);
+	pthread_mutex_unlock(&pwr.battery_mutex);
 	pthread_join(pwr.battery_pt, NULL);
+	pthread_cond_destroy(&pwr.battery_cond);
+	pthread_mutex_destroy(&pwr.battery_mutex);
+
+	Battery_close();
+	pwr.initialized = 0;
 }
 
 /**
@@ -2603,7 +2720,14 @@ void PWR_quit(void) {
  * @param enable 1 to show warning when battery low, 0 to hide
  */
 void PWR_warn(int enable) {
-	pwr.should_warn = enable;
+	if (pwr.initialized) {
+		pthread_mutex_lock(&pwr.battery_mutex);
+		pwr.should_warn = enable;
+		pthread_cond_signal(&pwr.battery_cond);
+		pthread_mutex_unlock(&pwr.battery_mutex);
+	} else {
+		pwr.should_warn = enable;
+	}
 	PLAT_enableOverlay(pwr.should_warn && pwr.charge <= PWR_LOW_CHARGE);
 }
 
@@ -2731,13 +2855,26 @@ void PWR_update(int* _dirty, int* _show_setting, PWR_callback_t before_sleep,
 		}
 	}
 
-	int muted = GetMute();
-	if ((uint32_t)muted != was_muted) {
-		was_muted = muted;
-		show_setting = 2;
-		setting_shown_at = now;
+	// Mute is only reread when keymon changed a setting
+	static int settings_seq = 0;
+	int seq = GetSettingsSeq();
+	if (seq != settings_seq) {
+		settings_seq = seq;
+		int muted = GetMute();
+		if ((uint32_t)muted != was_muted) {
+			was_muted = muted;
+			show_setting = 2;
+			setting_shown_at = now;
+		}
 	}
 
+	// Without input, the next thing to happen here is autosleep or the
+	// power button hold completing
+	uint32_t update_at = last_input_at + SLEEP_DELAY;
+	if (power_pressed_at && (int32_t)(power_pressed_at + 1000 - update_at) < 0)
+		update_at = power_pressed_at + 1000;
+	pwr.update_at = update_at;
+
 	if (show_setting)
 		dirty = 1; // shm is slow or keymon is catching input on the next frame
 	if (_dirty)
@@ -2746,6 +2883,34 @@ void PWR_update(int* _dirty, int* _show_setting, PWR_callback_t before_sleep,
 		*_show_setting = show_setting;
 }
 
+#define PWR_SAMPLE_SLACK 100 // ms for a battery sample to land
+
+/**
+ * Gets how long the caller can sleep before PWR_update() has something new.
+ *
+ * Covers the battery thread's next wake (charge, charger and wifi state
+ * come from it), autosleep and the power button hold. With HDMI the connection is
+ * only noticed by rereading settings, so the wait is capped at a second.
+ *
+ * @return Milliseconds until the next status change could show up
+ */
+uint32_t PWR_untilUpdate(void) {
+	uint32_t now = SDL_GetTicks();
+
+	pthread_mutex_lock(&pwr.battery_mutex);
+	int32_t battery_ms = (int32_t)(pwr.battery_at - now) + PWR_SAMPLE_SLACK;
+	pthread_mutex_unlock(&pwr.battery_mutex);
+
+	int32_t until = (int32_t)(pwr.update_at - now);
+	if (battery_ms < until)
+		until = battery_ms;
+#ifdef HAS_HDMI
+	if (until > 1000)
+		until = 1000;
+#endif
+	return until > 0 ? (uint32_t)until : 0;
+}
+
 /**
  * Disables manual sleep (sleep button/lid close).
  *
@@ -2922,7 +3087,7 @@ int PWR_preventAutosleep(void) {
  *
  * @return 1 if charging, 0 otherwise
  *
- * @note Value updated every 5 seconds by battery monitoring thread
+ * @note Cached by the battery monitoring thread, no file I/O
  */
 int PWR_isCharging(void) {
 	return pwr.is_charging;
@@ -2933,12 +3098,24 @@ int PWR_isCharging(void) {
  *
  * @return Charge percentage (10-100 in 10-20% increments)
  *
- * @note Value updated every 5 seconds by battery monitoring thread
+ * @note Cached by the battery monitoring thread, no file I/O
  */
 int PWR_getBattery(void) { // 10-100 in 10-20% fragments
 	return pwr.charge;
 }
 
+/**
+ * Gets the estimated time left on the battery.
+ *
+ * @return Minutes until empty, or until full while charging, -1 while
+ *         there isn't enough history to tell
+ *
+ * @note Cached by the battery monitoring thread, no file I/O
+ */
+int PWR_getBatteryMinutes(void) {
+	return pwr.minutes;
+}
+
 ///////////////////////////////
 // Platform utility functions
 ///////////////////////////////
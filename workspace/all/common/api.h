@@ -530,6 +530,25 @@ int GFX_truncateText(TTF_Font* font, const char* in_name, char* out_name, int ma
  */
 int GFX_wrapText(TTF_Font* font, char* str, int max_width, int max_lines);
 
+/**
+ * Renders single-line text truncated to a maximum width, with caching.
+ *
+ * @param font Font to render with
+ * @param text Text to render
+ * @param color Text color
+ * @param max_width Maximum width in pixels including padding (0 for no truncation)
+ * @param padding Additional padding to account for
+ * @param width Output: width of truncated text including padding (may be NULL)
+ * @return Surface owned by the text cache (do not free), or NULL
+ */
+SDL_Surface* GFX_getText(TTF_Font* font, const char* text, SDL_Color color, int max_width,
+                         int padding, int* width);
+
+/**
+ * Frees every cached text surface.
+ */
+void GFX_clearTextCache(void);
+
 /**
  * Gets the appropriate scaler function for a renderer configuration.
  * @param renderer Rendering context
@@ -837,6 +856,13 @@ size_t SND_batchSamples(const SND_Frame* frames, size_t frame_count);
  */
 unsigned SND_getBufferOccupancy(void);
 
+/**
+ * Gets and resets the time SND_batchSamples spent waiting for buffer space.
+ *
+ * @return Microseconds waited since the last call
+ */
+uint64_t SND_takeWaitTime(void);
+
 /**
  * Shuts down the audio subsystem.
  */
@@ -910,6 +936,37 @@ extern PAD_Context pad;
  */
 #define PAD_wake PLAT_shouldWake
 
+/**
+ * Blocks until input is available or the timeout expires.
+ * Lets idle menus sleep between events instead of polling every frame.
+ * Follow with PAD_poll() to consume the input.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return 1 if input is ready, 0 on timeout
+ */
+#define PAD_wait PLAT_waitForInput
+
+/**
+ * Starts reading input on a dedicated thread, so events keep their kernel
+ * timestamps and taps shorter than a frame aren't lost (see input_thread.h).
+ * Only platforms that read evdev themselves support it.
+ *
+ * @return 1 if the thread is running, 0 if unsupported
+ */
+#define PAD_startThread PLAT_startInputThread
+
+/**
+ * Goes back to reading input only when polled.
+ */
+#define PAD_stopThread PLAT_stopInputThread
+
+/**
+ * Gets how long the latest press waited between the kernel and PAD_poll().
+ *
+ * @return Microseconds, 0 without the input thread
+ */
+uint32_t PAD_getInputAge(void);
+
 /**
  * Sets analog stick state (internal use by platform implementations).
  *
@@ -920,6 +977,15 @@ extern PAD_Context pad;
  */
 void PAD_setAnalog(int neg, int pos, int value, int repeat_at);
 
+/**
+ * Presses or releases a single button as if a platform had read it.
+ *
+ * @param id Button ID (e.g., BTN_ID_SELECT)
+ * @param pressed 1 to press, 0 to release
+ * @param repeat_at Timestamp for next auto-repeat
+ */
+void PAD_setButton(int id, int pressed, uint32_t repeat_at);
+
 /**
  * Resets all button states to unpressed.
  */
@@ -1072,6 +1138,13 @@ int PWR_ignoreSettingInput(int btn, int show_setting);
 void PWR_update(int* dirty, int* show_setting, PWR_callback_t before_sleep,
                 PWR_callback_t after_sleep);
 
+/**
+ * Gets how long an idle loop can block before PWR_update() needs to run.
+ *
+ * @return Milliseconds until the next battery, wifi, charger or autosleep change
+ */
+uint32_t PWR_untilUpdate(void);
+
 /**
  * Disables power-off functionality (used during critical operations).
  */
@@ -1137,6 +1210,13 @@ int PWR_isCharging(void);
  */
 int PWR_getBattery(void);
 
+/**
+ * Gets the estimated time left on the battery.
+ *
+ * @return Minutes until empty (or full while charging), -1 if unknown
+ */
+int PWR_getBatteryMinutes(void);
+
 /**
  * CPU speed presets for power management.
  */
@@ -1179,6 +1259,26 @@ void PLAT_pollInput(void);
  */
 int PLAT_shouldWake(void);
 
+/**
+ * Platform-specific blocking wait for input.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return 1 if input is ready, 0 on timeout
+ */
+int PLAT_waitForInput(uint32_t timeout_ms);
+
+/**
+ * Platform-specific dedicated input thread start.
+ *
+ * @return 1 if the thread is running, 0 if unsupported
+ */
+int PLAT_startInputThread(void);
+
+/**
+ * Platform-specific dedicated input thread stop.
+ */
+void PLAT_stopInputThread(void);
+
 /**
  * Platform-specific video initialization.
  *
@@ -1319,11 +1419,19 @@ void PLAT_enableOverlay(int enable);
  */
 #define PWR_LOW_CHARGE 10
 
+/**
+ * Milliseconds between network state refreshes.
+ */
+#define PWR_NETWORK_INTERVAL 5000
+
 /**
  * Platform-specific battery status query.
  *
+ * Reports the raw reading; smoothing and bucketing happen in battery.c.
+ * Only the sampling process calls this, at an adaptive rate.
+ *
  * @param is_charging Output: 1 if charging, 0 otherwise
- * @param charge Output: battery percentage (0, 10, 20, 40, 60, 80, or 100)
+ * @param charge Output: battery percentage (0-100)
  */
 void PLAT_getBatteryStatus(int* is_charging, int* charge);
 
@@ -1371,10 +1479,18 @@ int PLAT_pickSampleRate(int requested, int max);
  */
 char* PLAT_getModel(void);
 
+/**
+ * Refreshes the network state PLAT_isOnline() reports.
+ *
+ * Called by every process's battery thread every PWR_NETWORK_INTERVAL,
+ * independently of the shared battery sample.
+ */
+void PLAT_updateNetwork(void);
+
 /**
  * Checks if device is connected to a network.
  *
- * @return 1 if online, 0 otherwise
+ * @return 1 if online, 0 otherwise (as of the last PLAT_updateNetwork)
  */
 int PLAT_isOnline(void);
 
@@ -0,0 +1,202 @@
+/**
+ * asset_cache.c - Persistent cache of the scaled UI asset atlas
+ *
+ * A hit is one open, one fstat and one mmap; the pixels are paged in from
+ * the file as the first frames draw them.
+ */
+
+#include "asset_cache.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Header at the start of every cache file.
+ *
+ * Followed by rect_count AssetCacheRects, then pitch * h bytes of pixels
+ * at pixels_offset.
+ */
+typedef struct AssetCacheHeader {
+	uint32_t magic; // ASSET_CACHE_MAGIC
+	uint32_t version; // ASSET_CACHE_VERSION
+	AssetCacheKey key;
+	int32_t rect_count;
+	int32_t w;
+	int32_t h;
+	int32_t pitch;
+	uint32_t pixels_offset;
+} AssetCacheHeader;
+
+/**
+ * Offset of the pixel data, aligned for SIMD loads.
+ */
+static uint32_t AssetCache_pixelsOffset(int rect_count) {
+	size_t offset = sizeof(AssetCacheHeader) + (size_t)rect_count * sizeof(AssetCacheRect);
+	return (uint32_t)((offset + 15) & ~(size_t)15);
+}
+
+/**
+ * Compares keys field by field (the struct may contain padding).
+ */
+static int AssetCache_keysMatch(const AssetCacheKey* a, const AssetCacheKey* b) {
+	return a->source_hash == b->source_hash && a->dp_scale == b->dp_scale &&
+	       a->asset_scale == b->asset_scale && a->pill_px == b->pill_px &&
+	       a->button_px == b->button_px && a->option_px == b->option_px && a->bpp == b->bpp &&
+	       a->rmask == b->rmask && a->gmask == b->gmask && a->bmask == b->bmask &&
+	       a->amask == b->amask;
+}
+
+/**
+ * Writes exactly size bytes, retrying on short writes.
+ */
+static int AssetCache_writeAll(int fd, const void* buffer, size_t size) {
+	const char* src = buffer;
+	while (size > 0) {
+		ssize_t count = write(fd, src, size);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return 0;
+		src += count;
+		size -= (size_t)count;
+	}
+	return 1;
+}
+
+/**
+ * Hashes a file's contents (64-bit FNV-1a).
+ */
+uint64_t AssetCache_hashFile(const char* path) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	unsigned char buffer[16384];
+	ssize_t count;
+	while ((count = read(fd, buffer, sizeof(buffer))) != 0) {
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+			close(fd);
+			return 0;
+		}
+		for (ssize_t i = 0; i < count; i++) {
+			hash ^= buffer[i];
+			hash *= 0x100000001b3ULL;
+		}
+	}
+	close(fd);
+	return hash ? hash : 1; // 0 means unreadable
+}
+
+/**
+ * Maps a cache file if it matches the key.
+ */
+AssetCache* AssetCache_load(const char* path, const AssetCacheKey* key, int rect_count) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(AssetCacheHeader)) {
+		close(fd);
+		return NULL;
+	}
+
+	size_t size = (size_t)st.st_size;
+	void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	const AssetCacheHeader* header = map;
+	uint32_t offset = AssetCache_pixelsOffset(rect_count);
+	if (header->magic != ASSET_CACHE_MAGIC || header->version != ASSET_CACHE_VERSION ||
+	    !AssetCache_keysMatch(&header->key, key) || header->rect_count != rect_count ||
+	    header->w <= 0 || header->h <= 0 || header->pitch < header->w * (int32_t)(key->bpp / 8) ||
+	    header->pixels_offset != offset ||
+	    size != (size_t)offset + (size_t)header->pitch * header->h) {
+		munmap(map, size);
+		return NULL;
+	}
+
+	AssetCache* cache = malloc(sizeof(AssetCache));
+	if (!cache) {
+		munmap(map, size);
+		return NULL;
+	}
+	cache->map = map;
+	cache->map_size = size;
+	cache->rects = (const AssetCacheRect*)(header + 1);
+	cache->pixels = (char*)map + offset;
+	cache->w = header->w;
+	cache->h = header->h;
+	cache->pitch = header->pitch;
+	return cache;
+}
+
+/**
+ * Unmaps a loaded atlas.
+ */
+void AssetCache_free(AssetCache* cache) {
+	if (!cache)
+		return;
+	munmap(cache->map, cache->map_size);
+	free(cache);
+}
+
+/**
+ * Writes an atlas to the cache.
+ */
+int AssetCache_save(const char* path, const AssetCacheKey* key, const AssetCacheRect* rects,
+                    int rect_count, const void* pixels, int w, int h, int pitch) {
+	char tmp_path[strlen(path) + 16];
+	sprintf(tmp_path, "%s.%d.tmp", path, (int)getpid() % 100000);
+
+	int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		LOG_errno("Failed to create asset cache file: %s", tmp_path);
+		return 0;
+	}
+
+	AssetCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = ASSET_CACHE_MAGIC;
+	header.version = ASSET_CACHE_VERSION;
+	header.key = *key;
+	header.rect_count = rect_count;
+	header.w = w;
+	header.h = h;
+	header.pitch = pitch;
+	header.pixels_offset = AssetCache_pixelsOffset(rect_count);
+
+	static const char padding[16];
+	size_t used = sizeof(header) + (size_t)rect_count * sizeof(AssetCacheRect);
+
+	int ok = AssetCache_writeAll(fd, &header, sizeof(header)) &&
+	         AssetCache_writeAll(fd, rects, (size_t)rect_count * sizeof(AssetCacheRect)) &&
+	         AssetCache_writeAll(fd, padding, header.pixels_offset - used) &&
+	         AssetCache_writeAll(fd, pixels, (size_t)pitch * h);
+	if (ok && fsync(fd) != 0) { // Data must be on disk before the rename is
+		LOG_errno("Failed to sync asset cache file: %s", tmp_path);
+		ok = 0;
+	}
+	if (close(fd) != 0)
+		ok = 0;
+
+	if (ok && rename(tmp_path, path) != 0) {
+		LOG_errno("Failed to move asset cache file into place: %s", path);
+		ok = 0;
+	}
+	if (!ok)
+		unlink(tmp_path);
+
+	return ok;
+}
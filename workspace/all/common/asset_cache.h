@@ -0,0 +1,123 @@
+/**
+ * asset_cache.h - Persistent cache of the scaled UI asset atlas
+ *
+ * Every binary that calls GFX_init decodes assets@Nx.png and rescales each
+ * sprite to the screen's dp scale. The result only depends on the PNG and
+ * a handful of layout sizes, so the first binary to start writes it here
+ * and later starts mmap it instead of decoding and scaling again.
+ *
+ * A cache file holds a fixed header, the sprite rectangles, then the
+ * atlas pixels starting on a 16-byte boundary. The key records a hash of
+ * the PNG's contents, the dp scale and sprite sizes used, and the exact
+ * pixel layout. Anything that doesn't match is treated as a miss, and the
+ * caller rewrites the file.
+ *
+ * Files are device-local (native endianness, RGBA8888 pixels as the atlas
+ * surface stores them) and live under USERDATA_PATH, so they are never
+ * shared between platforms.
+ *
+ * This module has no SDL dependency; callers map the layout fields onto
+ * their surfaces.
+ */
+
+#ifndef __ASSET_CACHE_H__
+#define __ASSET_CACHE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ASSET_CACHE_MAGIC 0x534C5441 // "ATLS"
+#define ASSET_CACHE_VERSION 1
+
+/**
+ * Everything the scaled atlas depends on.
+ */
+typedef struct AssetCacheKey {
+	uint64_t source_hash; // AssetCache_hashFile() of the source PNG
+	float dp_scale; // gfx_dp_scale the atlas was scaled for
+	int32_t asset_scale; // Source tier (@1x-@4x)
+	int32_t pill_px; // Pill size in pixels
+	int32_t button_px; // Button size in pixels
+	int32_t option_px; // Option pill size in pixels
+	uint32_t bpp; // Bits per pixel
+	uint32_t rmask; // Pixel format masks
+	uint32_t gmask;
+	uint32_t bmask;
+	uint32_t amask;
+} AssetCacheKey;
+
+/**
+ * Sprite rectangle within the atlas, in pixels.
+ */
+typedef struct AssetCacheRect {
+	int32_t x;
+	int32_t y;
+	int32_t w;
+	int32_t h;
+} AssetCacheRect;
+
+/**
+ * A loaded atlas. Pixels are a private mapping of the cache file, so they
+ * can be handed to a surface that may write to them without touching the
+ * file.
+ */
+typedef struct AssetCache {
+	void* map; // Whole file mapping
+	size_t map_size;
+	const AssetCacheRect* rects; // rect_count entries
+	void* pixels; // pitch * h bytes
+	int w;
+	int h;
+	int pitch;
+} AssetCache;
+
+/**
+ * Hashes a file's contents (64-bit FNV-1a).
+ *
+ * Reading the PNG is far cheaper than decoding it, and unlike mtime the
+ * hash survives copying a fresh build onto the card.
+ *
+ * @param path File to hash
+ * @return Hash, or 0 if the file couldn't be read
+ */
+uint64_t AssetCache_hashFile(const char* path);
+
+/**
+ * Maps a cache file if it matches the key.
+ *
+ * @param path Cache file path
+ * @param key Current key
+ * @param rect_count Number of sprite rectangles expected
+ * @return Loaded atlas (free with AssetCache_free), or NULL on miss
+ */
+AssetCache* AssetCache_load(const char* path, const AssetCacheKey* key, int rect_count);
+
+/**
+ * Unmaps a loaded atlas.
+ *
+ * Any surface created over its pixels must be freed first.
+ *
+ * @param cache Atlas from AssetCache_load, or NULL
+ */
+void AssetCache_free(AssetCache* cache);
+
+/**
+ * Writes an atlas to the cache.
+ *
+ * Written to a temporary file and renamed into place, so a concurrent
+ * reader or a power loss never sees a partial entry.
+ *
+ * @param path Cache file path
+ * @param key Key the atlas was built for
+ * @param rects Sprite rectangles
+ * @param rect_count Number of rectangles
+ * @param pixels Atlas pixels
+ * @param w Atlas width in pixels
+ * @param h Atlas height in pixels
+ * @param pitch Bytes per row
+ * @return 1 on success, 0 on failure
+ */
+int AssetCache_save(const char* path, const AssetCacheKey* key, const AssetCacheRect* rects,
+                    int rect_count, const void* pixels, int w, int h, int pitch);
+
+#endif // __ASSET_CACHE_H__
@@ -0,0 +1,295 @@
+/**
+ * battery.c - Shared battery telemetry
+ */
+
+#include "battery.h"
+#include "log.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Layout of the shared segment.
+ *
+ * seq is odd while the sampling process rewrites filter.
+ */
+typedef struct BatteryShared {
+	int seq;
+	BatteryFilter filter;
+} BatteryShared;
+
+static struct {
+	BatteryShared* shared; // Points at local when shm isn't available
+	BatteryShared local;
+	int fd;
+} battery = {.fd = -1};
+
+///////////////////////////////
+// Filter
+///////////////////////////////
+
+int Battery_quantize(int percent) {
+	if (percent > 80)
+		return 100;
+	if (percent > 60)
+		return 80;
+	if (percent > 40)
+		return 60;
+	if (percent > 20)
+		return 40;
+	if (percent > 10)
+		return 20;
+	return 10;
+}
+
+/**
+ * Starts measuring the charge rate afresh.
+ */
+static void BatteryFilter_startTrend(BatteryFilter* filter, uint64_t now_ms) {
+	filter->rate = 0;
+	filter->trend_ms = now_ms;
+	filter->window[0] = filter->window[1] = filter->smoothed;
+	filter->window_ms[0] = filter->window_ms[1] = now_ms;
+}
+
+/**
+ * Restarts the filter from a single reading.
+ */
+static void BatteryFilter_reset(BatteryFilter* filter, int is_charging, int percent,
+                                uint64_t now_ms) {
+	memset(filter, 0, sizeof(*filter));
+	filter->initialized = 1;
+	filter->is_charging = is_charging;
+	filter->smoothed = percent * 1000;
+	filter->level = Battery_quantize(percent);
+	filter->sampled_ms = now_ms;
+	BatteryFilter_startTrend(filter, now_ms);
+}
+
+void BatteryFilter_update(BatteryFilter* filter, int is_charging, int percent, uint64_t now_ms) {
+	if (percent < 0)
+		percent = 0;
+	else if (percent > 100)
+		percent = 100;
+	is_charging = is_charging ? 1 : 0;
+
+	if (!filter->initialized || now_ms < filter->sampled_ms) {
+		BatteryFilter_reset(filter, is_charging, percent, now_ms);
+		return;
+	}
+
+	int value = percent * 1000;
+	int64_t dt = (int64_t)(now_ms - filter->sampled_ms);
+
+	if (is_charging != filter->is_charging) {
+		// Voltage based gauges jump when the charger comes or goes, so this
+		// is never an outlier, but the old rate no longer applies
+		filter->is_charging = is_charging;
+		filter->outliers = 0;
+		BatteryFilter_startTrend(filter, now_ms);
+	} else if (abs(value - filter->smoothed) > BATTERY_OUTLIER_PERCENT * 1000 &&
+	           dt < BATTERY_SMOOTH_MS) {
+		if (!filter->outliers) {
+			filter->outliers = 1;
+			filter->sampled_ms = now_ms;
+			return;
+		}
+		// Two readings agree, so the charge really moved
+		BatteryFilter_reset(filter, is_charging, percent, now_ms);
+		return;
+	}
+	filter->outliers = 0;
+
+	filter->smoothed += (int)((int64_t)(value - filter->smoothed) * dt / (dt + BATTERY_SMOOTH_MS));
+	filter->sampled_ms = now_ms;
+
+	// The gauge moves in whole percents, so a per-sample slope is mostly
+	// zeros and steps; measure across one to two windows instead
+	if (now_ms - filter->window_ms[1] >= BATTERY_RATE_MS) {
+		filter->window[0] = filter->window[1];
+		filter->window_ms[0] = filter->window_ms[1];
+		filter->window[1] = filter->smoothed;
+		filter->window_ms[1] = now_ms;
+	}
+	if (now_ms > filter->window_ms[0])
+		filter->rate = (int)((int64_t)(filter->smoothed - filter->window[0]) * 3600000 /
+		                     (int64_t)(now_ms - filter->window_ms[0]));
+
+	// Only leave a bucket once the charge is clearly past its boundary
+	int level = Battery_quantize((filter->smoothed + 500) / 1000);
+	if (level > filter->level) {
+		int lower = Battery_quantize((filter->smoothed - BATTERY_HYSTERESIS_PERCENT * 1000) / 1000);
+		level = lower > filter->level ? lower : filter->level;
+	} else if (level < filter->level) {
+		int upper =
+		    Battery_quantize((filter->smoothed + BATTERY_HYSTERESIS_PERCENT * 1000 + 999) / 1000);
+		level = upper < filter->level ? upper : filter->level;
+	}
+	filter->level = level;
+}
+
+void BatteryFilter_status(const BatteryFilter* filter, BatteryStatus* status) {
+	if (!filter->initialized) {
+		status->is_charging = 0;
+		status->level = 10;
+		status->percent = 0;
+		status->minutes = -1;
+		return;
+	}
+
+	status->is_charging = filter->is_charging;
+	status->level = filter->level;
+	status->percent = (filter->smoothed + 500) / 1000;
+	status->minutes = -1;
+
+	if (filter->sampled_ms - filter->trend_ms < BATTERY_TREND_MS)
+		return;
+
+	int64_t minutes = -1;
+	if (filter->is_charging && filter->rate > 0)
+		minutes = (int64_t)(100000 - filter->smoothed) * 60 / filter->rate;
+	else if (!filter->is_charging && filter->rate < 0)
+		minutes = (int64_t)filter->smoothed * 60 / -filter->rate;
+	if (minutes >= 0 && minutes <= BATTERY_MAX_MINUTES)
+		status->minutes = (int)minutes;
+}
+
+int BatteryFilter_interval(const BatteryFilter* filter, int in_game) {
+	if (!filter->initialized || filter->is_charging || filter->level <= BATTERY_LOW_LEVEL)
+		return BATTERY_INTERVAL_FAST;
+	return in_game ? BATTERY_INTERVAL_GAME : BATTERY_INTERVAL_MENU;
+}
+
+///////////////////////////////
+// Shared segment
+///////////////////////////////
+
+/**
+ * CLOCK_BOOTTIME in milliseconds, so time asleep counts toward the rate.
+ */
+static uint64_t Battery_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_BOOTTIME, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * Copies the shared filter under the sequence lock.
+ */
+static void Battery_read(BatteryFilter* filter) {
+	BatteryShared* shared = battery.shared ? battery.shared : &battery.local;
+	int seq;
+	do {
+		while ((seq = __atomic_load_n(&shared->seq, __ATOMIC_ACQUIRE)) & 1)
+			;
+		memcpy(filter, &shared->filter, sizeof(*filter));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while (__atomic_load_n(&shared->seq, __ATOMIC_RELAXED) != seq);
+}
+
+/**
+ * Publishes a filter. Only called by the process holding the sampler lock.
+ */
+static void Battery_write(const BatteryFilter* filter) {
+	BatteryShared* shared = battery.shared ? battery.shared : &battery.local;
+	int seq = __atomic_load_n(&shared->seq, __ATOMIC_RELAXED);
+	__atomic_store_n(&shared->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(&shared->filter, filter, sizeof(*filter));
+	__atomic_store_n(&shared->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+int Battery_open(const char* name) {
+	Battery_close();
+
+	int fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		LOG_errno("battery: unable to open %s, sampling privately", name);
+		return -1;
+	}
+
+	// A fresh segment is empty and the zeroed filter means "no sample yet"
+	struct stat st;
+	if (fstat(fd, &st) < 0 ||
+	    (st.st_size < (off_t)sizeof(BatteryShared) && ftruncate(fd, sizeof(BatteryShared)) < 0)) {
+		LOG_errno("battery: unable to size %s, sampling privately", name);
+		close(fd);
+		return -1;
+	}
+
+	void* shared = mmap(NULL, sizeof(BatteryShared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (shared == MAP_FAILED) {
+		LOG_errno("battery: unable to map %s, sampling privately", name);
+		close(fd);
+		return -1;
+	}
+
+	battery.shared = shared;
+	battery.fd = fd;
+
+	// A sampler killed mid-write leaves seq odd, which would stall readers
+	if (flock(fd, LOCK_EX | LOCK_NB) == 0) {
+		if (battery.shared->seq & 1)
+			__atomic_add_fetch(&battery.shared->seq, 1, __ATOMIC_RELEASE);
+		flock(fd, LOCK_UN);
+	}
+	return 0;
+}
+
+void Battery_close(void) {
+	if (battery.shared) {
+		munmap(battery.shared, sizeof(BatteryShared));
+		battery.shared = NULL;
+	}
+	if (battery.fd >= 0) {
+		close(battery.fd);
+		battery.fd = -1;
+	}
+}
+
+int Battery_untilDue(int in_game) {
+	BatteryFilter filter;
+	Battery_read(&filter);
+	if (!filter.initialized)
+		return 0;
+
+	uint64_t now = Battery_now();
+	uint64_t due = filter.sampled_ms + BatteryFilter_interval(&filter, in_game);
+	return due > now ? (int)(due - now) : 0;
+}
+
+int Battery_update(BatteryReadFunc read_battery, int in_game, int force) {
+	if (!force && Battery_untilDue(in_game) > 0)
+		return 0;
+
+	// Whoever holds the lock is sampling for everyone
+	if (battery.fd >= 0 && flock(battery.fd, LOCK_EX | LOCK_NB) < 0)
+		return 0;
+
+	int sampled = 0;
+	BatteryFilter filter;
+	Battery_read(&filter);
+	if (force || Battery_untilDue(in_game) == 0) {
+		int is_charging = 0;
+		int percent = 0;
+		read_battery(&is_charging, &percent);
+		BatteryFilter_update(&filter, is_charging, percent, Battery_now());
+		Battery_write(&filter);
+		sampled = 1;
+	}
+
+	if (battery.fd >= 0)
+		flock(battery.fd, LOCK_UN);
+	return sampled;
+}
+
+void Battery_get(BatteryStatus* status) {
+	BatteryFilter filter;
+	Battery_read(&filter);
+	BatteryFilter_status(&filter, status);
+}
@@ -0,0 +1,159 @@
+/**
+ * battery.h - Shared battery telemetry
+ *
+ * Every process that runs PWR used to sample the battery on its own every
+ * 5 seconds and show whatever the last sysfs read said, bucketed. This
+ * module keeps one filtered view of the battery in a small shared memory
+ * segment that outlives the processes using it, so minui and minarch (and
+ * anything started between them) share its history:
+ *
+ * - Samples are smoothed with a time-based exponential moving average
+ *   (BATTERY_SMOOTH_MS), and a single reading that jumps more than
+ *   BATTERY_OUTLIER_PERCENT is dropped unless the next one agrees.
+ * - The 10/20/40/60/80/100 level the UI shows only moves once the smoothed
+ *   charge is BATTERY_HYSTERESIS_PERCENT past a bucket boundary, so it
+ *   doesn't flicker between two buckets.
+ * - The charge rate is measured over the last one to two BATTERY_RATE_MS
+ *   windows, long enough to see past the 1% steps of the gauge, to
+ *   estimate the minutes left until empty, or until full while charging.
+ * - The sampling interval adapts: BATTERY_INTERVAL_FAST while charging or
+ *   low, BATTERY_INTERVAL_MENU in menus, BATTERY_INTERVAL_GAME in game.
+ *
+ * Only one process samples at a time (an flock on the segment) and only
+ * when the shared sample is older than the interval. Readers copy the
+ * published status under a sequence lock, without any file I/O.
+ *
+ * Times are CLOCK_BOOTTIME milliseconds, so time spent asleep counts.
+ *
+ * This module has no SDL dependency.
+ */
+
+#ifndef __BATTERY_H__
+#define __BATTERY_H__
+
+#include <stdint.h>
+
+#define BATTERY_SHM_NAME "/SharedBattery"
+
+#define BATTERY_INTERVAL_FAST 2000 // ms between samples while charging or low
+#define BATTERY_INTERVAL_MENU 5000 // ms between samples in menus
+#define BATTERY_INTERVAL_GAME 15000 // ms between samples in game
+#define BATTERY_LOW_LEVEL 20 // Level at or under which sampling is fast
+
+#define BATTERY_SMOOTH_MS 60000 // Time constant of the charge average
+#define BATTERY_RATE_MS 1800000 // Window the charge rate is measured over
+#define BATTERY_TREND_MS 600000 // History needed before estimating time left
+#define BATTERY_OUTLIER_PERCENT 20 // Jump that is ignored once
+#define BATTERY_HYSTERESIS_PERCENT 2 // Distance past a bucket boundary to change level
+#define BATTERY_MAX_MINUTES (24 * 60) // Longer estimates are reported as unknown
+
+/**
+ * Reads the hardware: charger state and charge in percent (0-100).
+ */
+typedef void (*BatteryReadFunc)(int* is_charging, int* percent);
+
+/**
+ * Filter state. Treat as opaque outside battery.c.
+ */
+typedef struct BatteryFilter {
+	int initialized; // 1 once the first sample was taken
+	int is_charging;
+	int smoothed; // Charge in thousandths of a percent
+	int level; // Bucketed charge shown in the UI (10-100)
+	int rate; // Thousandths of a percent per hour, positive while charging
+	int outliers; // Consecutive readings dropped as outliers
+	int window[2]; // smoothed at the start of the previous and current rate windows
+	uint64_t window_ms[2]; // When those windows started
+	uint64_t sampled_ms; // Time of the last sample
+	uint64_t trend_ms; // When the current charge or discharge started
+} BatteryFilter;
+
+/**
+ * What PWR shows.
+ */
+typedef struct BatteryStatus {
+	int is_charging;
+	int level; // 10, 20, 40, 60, 80 or 100
+	int percent; // Smoothed charge (0-100)
+	int minutes; // Until empty (or full while charging), -1 if unknown
+} BatteryStatus;
+
+/**
+ * Buckets a charge the way the UI shows it.
+ *
+ * @param percent Charge (0-100)
+ * @return 100 above 80, 80 above 60, 60 above 40, 40 above 20, 20 above 10, else 10
+ */
+int Battery_quantize(int percent);
+
+/**
+ * Feeds one reading to a filter.
+ *
+ * @param filter Filter (zeroed before the first sample)
+ * @param is_charging Charger connected
+ * @param percent Raw charge, clamped to 0-100
+ * @param now_ms Current CLOCK_BOOTTIME time
+ */
+void BatteryFilter_update(BatteryFilter* filter, int is_charging, int percent, uint64_t now_ms);
+
+/**
+ * Converts a filter to what PWR shows.
+ *
+ * @param filter Filter
+ * @param status Receives the status
+ */
+void BatteryFilter_status(const BatteryFilter* filter, BatteryStatus* status);
+
+/**
+ * Milliseconds between samples for a filter's state.
+ *
+ * @param filter Filter
+ * @param in_game 1 while a game is running
+ * @return BATTERY_INTERVAL_FAST, _MENU or _GAME
+ */
+int BatteryFilter_interval(const BatteryFilter* filter, int in_game);
+
+/**
+ * Maps the shared segment, creating it if needed.
+ *
+ * If shared memory isn't available the process keeps a private filter.
+ *
+ * @param name POSIX shm name (BATTERY_SHM_NAME)
+ * @return 0 if shared, -1 if private
+ */
+int Battery_open(const char* name);
+
+/**
+ * Unmaps the shared segment. The segment itself stays for the next process.
+ */
+void Battery_close(void);
+
+/**
+ * Samples the battery if the shared sample is due.
+ *
+ * Does nothing if the last sample (by any process) is younger than the
+ * interval, or another process is sampling right now.
+ *
+ * @param read_battery Hardware reader
+ * @param in_game 1 while a game is running
+ * @param force 1 to sample even if the last sample is recent
+ * @return 1 if this call sampled, 0 otherwise
+ */
+int Battery_update(BatteryReadFunc read_battery, int in_game, int force);
+
+/**
+ * Copies the published status. No file I/O.
+ *
+ * @param status Receives the status (level 10 and not charging before any sample)
+ */
+void Battery_get(BatteryStatus* status);
+
+/**
+ * Milliseconds until the shared sample is due.
+ *
+ * @param in_game 1 while a game is running
+ * @return Time to wait (0 if due now)
+ */
+int Battery_untilDue(int in_game);
+
+#endif // __BATTERY_H__
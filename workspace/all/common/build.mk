@@ -70,11 +70,16 @@ COMMON_SOURCE = \
 	$(COMMON_DIR)/utils.c \
 	$(COMMON_DIR)/nointro_parser.c \
 	$(COMMON_DIR)/api.c \
+	$(COMMON_DIR)/asset_cache.c \
 	$(COMMON_DIR)/log.c \
 	$(COMMON_DIR)/collections.c \
 	$(COMMON_DIR)/pad.c \
 	$(COMMON_DIR)/gfx_text.c \
 	$(COMMON_DIR)/scaler.c \
+	$(COMMON_DIR)/scaler_pool.c \
+	$(COMMON_DIR)/cpufreq.c \
+	$(COMMON_DIR)/battery.c \
+	$(COMMON_DIR)/input_thread.c \
 	$(PLATFORM_DIR)/platform.c
 
 SOURCE ?= $(TARGET).c $(COMMON_SOURCE) $(EXTRA_SOURCE)
@@ -88,7 +93,7 @@ CFLAGS  = $(ARCH) -fomit-frame-pointer
 CFLAGS += $(INCDIR) -DPLATFORM=\"$(PLATFORM)\" -DUSE_$(SDL) $(LOG_FLAGS) -Ofast
 CFLAGS += $(EXTRA_CFLAGS)
 
-LDFLAGS  = -ldl $(LIBS) -l$(SDL) -l$(SDL)_image -l$(SDL)_ttf -lpthread -lm -lz
+LDFLAGS  = -ldl $(LIBS) -l$(SDL) -l$(SDL)_image -l$(SDL)_ttf -lpthread -lrt -lm -lz
 LDFLAGS += -lmsettings
 LDFLAGS += $(EXTRA_LDFLAGS)
 
@@ -0,0 +1,132 @@
+/**
+ * cpufreq.c - In-process CPU frequency control
+ */
+
+#include "cpufreq.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static struct {
+	CPUFreqConfig config;
+	int setspeed_fd;
+	int current_khz;
+	int initialized;
+} cpufreq = {.setspeed_fd = -1};
+
+/**
+ * Writes a value to a sysfs node from the start, as echo would.
+ */
+static int CPUFreq_writeNode(int fd, const char* value) {
+	size_t length = strlen(value);
+	ssize_t written;
+	do {
+		written = pwrite(fd, value, length, 0);
+	} while (written < 0 && errno == EINTR);
+	return written == (ssize_t)length ? 0 : -1;
+}
+
+/**
+ * Opens the sysfs nodes and stores the platform table.
+ */
+int CPUFreq_init(const CPUFreqConfig* config) {
+	CPUFreq_quit();
+	cpufreq.config = *config;
+	cpufreq.current_khz = 0;
+	cpufreq.initialized = 1;
+
+	if (config->governor_path) {
+		int fd = open(config->governor_path, O_WRONLY | O_CLOEXEC);
+		if (fd < 0 || CPUFreq_writeNode(fd, "userspace") != 0)
+			LOG_warn("Unable to set userspace governor via %s", config->governor_path);
+		if (fd >= 0)
+			close(fd);
+	}
+
+	if (config->setspeed_path) {
+		cpufreq.setspeed_fd = open(config->setspeed_path, O_WRONLY | O_CLOEXEC);
+		if (cpufreq.setspeed_fd < 0) {
+			LOG_errno("Failed to open %s", config->setspeed_path);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Switches to the frequency for a CPU_SPEED_* level.
+ */
+int CPUFreq_setSpeed(int speed) {
+	if (!cpufreq.initialized || speed < 0 || speed >= CPUFREQ_LEVELS)
+		return -1;
+	return CPUFreq_setKHz(cpufreq.config.khz[speed]);
+}
+
+/**
+ * Switches to the frequency for a CPU_SPEED_* level, initializing on first use.
+ */
+int CPUFreq_setSpeedWith(const CPUFreqConfig* config, int speed) {
+	if (!cpufreq.initialized)
+		CPUFreq_init(config);
+	return CPUFreq_setSpeed(speed);
+}
+
+/**
+ * Switches to an arbitrary frequency.
+ */
+int CPUFreq_setKHz(int khz) {
+	if (!cpufreq.initialized || khz <= 0)
+		return -1;
+	if (khz == cpufreq.current_khz)
+		return 0;
+
+	if (cpufreq.setspeed_fd >= 0) {
+		char value[16];
+		snprintf(value, sizeof(value), "%d", khz);
+		if (CPUFreq_writeNode(cpufreq.setspeed_fd, value) != 0) {
+			LOG_errno("Failed to set CPU speed to %d kHz", khz);
+			cpufreq.current_khz = 0; // state unknown, don't skip the next request
+			return -1;
+		}
+	}
+
+	if (cpufreq.config.apply && cpufreq.config.apply(khz) != 0) {
+		LOG_error("Failed to apply CPU speed %d kHz", khz);
+		cpufreq.current_khz = 0;
+		return -1;
+	}
+
+	LOG_debug("CPU speed %d kHz", khz);
+	cpufreq.current_khz = khz;
+	return 1;
+}
+
+/**
+ * Returns the platform's frequency for a CPU_SPEED_* level.
+ */
+int CPUFreq_getSpeedKHz(int speed) {
+	if (!cpufreq.initialized || speed < 0 || speed >= CPUFREQ_LEVELS)
+		return 0;
+	return cpufreq.config.khz[speed];
+}
+
+/**
+ * Returns the frequency last set through this module.
+ */
+int CPUFreq_getKHz(void) {
+	return cpufreq.current_khz;
+}
+
+/**
+ * Closes the sysfs nodes.
+ */
+void CPUFreq_quit(void) {
+	if (cpufreq.setspeed_fd >= 0)
+		close(cpufreq.setspeed_fd);
+	cpufreq.setspeed_fd = -1;
+	cpufreq.current_khz = 0;
+	cpufreq.initialized = 0;
+}
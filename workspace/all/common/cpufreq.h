@@ -0,0 +1,96 @@
+/**
+ * cpufreq.h - In-process CPU frequency control
+ *
+ * Replaces shelling out to overclock.elf or "echo > scaling_setspeed" for
+ * every speed change. Each platform describes its CPU_SPEED_* frequencies
+ * and how to apply them once; after that a change is a pwrite() to an
+ * already open sysfs node and/or a direct register write, and asking for
+ * the frequency that's already set does nothing.
+ *
+ * The cpufreq governor is expected to be "userspace" (launch.sh sets it).
+ *
+ * This module has no SDL dependency.
+ */
+
+#ifndef __CPUFREQ_H__
+#define __CPUFREQ_H__
+
+#define CPUFREQ_LEVELS 4 // CPU_SPEED_MENU through CPU_SPEED_PERFORMANCE
+
+/**
+ * Applies a frequency directly in hardware (PLL, voltage regulator, ...).
+ *
+ * @param khz Frequency from the platform's table
+ * @return 0 on success, -1 on failure
+ */
+typedef int (*CPUFreq_ApplyFunc)(int khz);
+
+/**
+ * How a platform changes CPU frequency.
+ */
+typedef struct CPUFreqConfig {
+	int khz[CPUFREQ_LEVELS]; // Frequency for each CPU_SPEED_* level
+	const char* governor_path; // scaling_governor to set to "userspace" at init, or NULL
+	const char* setspeed_path; // scaling_setspeed to write kHz to, or NULL
+	CPUFreq_ApplyFunc apply; // Called after the sysfs write, or NULL
+} CPUFreqConfig;
+
+/**
+ * Opens the sysfs nodes and stores the platform table.
+ *
+ * Calling it again replaces the previous configuration.
+ *
+ * @param config Platform configuration (copied)
+ * @return 0 on success, -1 if setspeed_path couldn't be opened
+ */
+int CPUFreq_init(const CPUFreqConfig* config);
+
+/**
+ * Switches to the frequency for a CPU_SPEED_* level.
+ *
+ * @param speed CPU_SPEED_* value
+ * @return 1 if the frequency changed, 0 if it was already set, -1 on error
+ */
+int CPUFreq_setSpeed(int speed);
+
+/**
+ * Switches to the frequency for a CPU_SPEED_* level, initializing from
+ * config on first use.
+ *
+ * Lets PLAT_setCPUSpeed() stay a one-liner without its own init flag.
+ *
+ * @param config Platform configuration, only read if not yet initialized
+ * @param speed CPU_SPEED_* value
+ * @return 1 if the frequency changed, 0 if it was already set, -1 on error
+ */
+int CPUFreq_setSpeedWith(const CPUFreqConfig* config, int speed);
+
+/**
+ * Switches to an arbitrary frequency.
+ *
+ * @param khz Frequency in kHz
+ * @return 1 if the frequency changed, 0 if it was already set, -1 on error
+ */
+int CPUFreq_setKHz(int khz);
+
+/**
+ * Returns the platform's frequency for a CPU_SPEED_* level.
+ *
+ * @param speed CPU_SPEED_* value
+ * @return Frequency in kHz, or 0 if not initialized or out of range
+ */
+int CPUFreq_getSpeedKHz(int speed);
+
+/**
+ * Returns the frequency last set through this module.
+ *
+ * @return Frequency in kHz, or 0 if none has been set yet
+ */
+int CPUFreq_getKHz(void);
+
+/**
+ * Closes the sysfs nodes.
+ */
+void CPUFreq_quit(void);
+
+#endif // __CPUFREQ_H__
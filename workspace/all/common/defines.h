@@ -92,12 +92,46 @@
  */
 #define SIMPLE_MODE_PATH SHARED_USERDATA_PATH "/enable-simple-mode"
 
+/**
+ * Resident minarch enable flag file.
+ * If this file exists, games are launched through a long-lived minarch host
+ * that keeps recently used cores loaded.
+ */
+#define RESIDENT_MODE_PATH SHARED_USERDATA_PATH "/enable-resident-mode"
+
+/**
+ * Launch timeline tracing enable flag file.
+ * If this file exists, minui and minarch append timing spans to TRACE_PATH.
+ */
+#define TRACE_MODE_PATH SHARED_USERDATA_PATH "/enable-trace"
+
+/**
+ * Chrome trace-event JSON file written when tracing is enabled.
+ * Shared by every process so a launch reads as one timeline; delete it to
+ * start a new capture.
+ */
+#define TRACE_PATH USERDATA_PATH "/logs/trace.json"
+
 /**
  * Auto-resume save state tracking file.
  * Stores the last game played for automatic resume on startup.
  */
 #define AUTO_RESUME_PATH SHARED_USERDATA_PATH "/.minui/auto_resume.txt"
 
+/**
+ * Pre-scaled thumbnail cache directory.
+ * Platform-specific because entries are stored at the device's thumbnail
+ * size and in its native pixel format.
+ */
+#define THUMB_CACHE_PATH USERDATA_PATH "/.minui/thumbs"
+
+/**
+ * Scaled UI asset atlas cache, formatted with the screen's width and height.
+ * Per screen size so switching between the panel and HDMI doesn't make each
+ * side overwrite the other's atlas.
+ */
+#define ASSET_CACHE_PATH USERDATA_PATH "/.minui/assets-%ix%i.cache"
+
 /**
  * Save state slot used for auto-resume feature.
  */
@@ -135,6 +169,11 @@
  */
 #define NOUI_PATH "/tmp/noui"
 
+/**
+ * Socket the resident minarch host listens on for launch requests.
+ */
+#define RESIDENT_SOCKET_PATH "/tmp/minarch.sock"
+
 ///////////////////////////////
 // UI color definitions
 ///////////////////////////////
@@ -17,12 +17,18 @@
 
 #include "gfx_text.h"
 #include "utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 // TTF_SizeUTF8 is provided by SDL_ttf in production
-// In tests, it's mocked with fff (declared in sdl_fakes.h)
-#ifndef UNIT_TEST_BUILD
+// In tests, it's mocked with fff (declared in sdl_fakes.h), as are the
+// rendering functions used by the text cache
 extern int TTF_SizeUTF8(TTF_Font* font, const char* text, int* w, int* h);
+#ifdef UNIT_TEST_BUILD
+extern SDL_Surface* TTF_RenderUTF8_Blended(TTF_Font* font, const char* text, SDL_Color fg);
+extern void SDL_FreeSurface(SDL_Surface* surface);
 #endif
 
 // Constants - typically defined in platform headers
@@ -34,11 +40,36 @@ extern int TTF_SizeUTF8(TTF_Font* font, const char* text, int* w, int* h);
 #define MAX_TEXT_LINES 16
 #endif
 
+// Rendered text cache limits (surfaces are RGBA, roughly one list row each)
+#ifndef GFX_TEXT_CACHE_BUDGET
+#define GFX_TEXT_CACHE_BUDGET (2 * 1024 * 1024)
+#endif
+#define GFX_TEXT_CACHE_ENTRIES 128
+
+/**
+ * Measures a prefix of text with "..." appended.
+ *
+ * @param font TTF font used to measure text
+ * @param in_name Full input text
+ * @param len Number of bytes of in_name to keep
+ * @param out_name Output buffer, receives the prefix plus "..."
+ * @return Width of out_name in pixels
+ */
+static int measureEllipsized(TTF_Font* ttf_font, const char* in_name, int len, char* out_name) {
+	int text_width;
+	memcpy(out_name, in_name, len);
+	strcpy(&out_name[len], "...");
+	TTF_SizeUTF8(ttf_font, out_name, &text_width, NULL);
+	return text_width;
+}
+
 /**
  * Truncates text to fit within a maximum width.
  *
- * If the text (plus padding) exceeds max_width, characters are removed from
- * the end and replaced with "..." until it fits.
+ * If the text (plus padding) exceeds max_width, it is cut at the longest
+ * prefix that still fits with "..." appended. The cut point is found by
+ * binary search over UTF-8 character boundaries, so long names cost a
+ * handful of measurements instead of one per removed character.
  *
  * @param font TTF font used to measure text
  * @param in_name Input text to truncate
@@ -53,23 +84,44 @@ int GFX_truncateText(TTF_Font* ttf_font, const char* in_name, char* out_name, in
 	strcpy(out_name, in_name);
 	TTF_SizeUTF8(ttf_font, out_name, &text_width, NULL);
 	text_width += padding;
+	if (text_width <= max_width)
+		return text_width;
 
-	while (text_width > max_width) {
-		int len = strlen(out_name);
-		// Need at least 4 chars to truncate (replace last char with "...")
-		// If string is too short, just use "..." directly
-		if (len <= 4) {
-			strcpy(out_name, "...");
-			TTF_SizeUTF8(ttf_font, out_name, &text_width, NULL);
-			text_width += padding;
-			break;
+	// Collect candidate cut points (start of each character after the first)
+	int len = strlen(in_name);
+	int cuts[MAX_PATH];
+	int cut_count = 0;
+	for (int i = 1; i < len && cut_count < MAX_PATH; i++) {
+		if (((unsigned char)in_name[i] & 0xC0) != 0x80)
+			cuts[cut_count++] = i;
+	}
+
+	// Find the longest prefix that fits, assuming width grows with length
+	int lo = 0;
+	int hi = cut_count - 1;
+	int best = -1;
+	int best_width = 0;
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		int width = measureEllipsized(ttf_font, in_name, cuts[mid], out_name) + padding;
+		if (width <= max_width) {
+			best = mid;
+			best_width = width;
+			lo = mid + 1;
+		} else {
+			hi = mid - 1;
 		}
-		strcpy(&out_name[len - 4], "...");
+	}
+
+	// Nothing fits, fall back to just the ellipsis
+	if (best < 0) {
+		strcpy(out_name, "...");
 		TTF_SizeUTF8(ttf_font, out_name, &text_width, NULL);
-		text_width += padding;
+		return text_width + padding;
 	}
 
-	return text_width;
+	measureEllipsized(ttf_font, in_name, cuts[best], out_name);
+	return best_width;
 }
 
 /**
@@ -194,3 +246,159 @@ void GFX_sizeText(TTF_Font* ttf_font, char* str, int leading, int* w, int* h) {
 	}
 	*w = mw;
 }
+
+///////////////////////////////
+// Rendered text cache
+///////////////////////////////
+
+/**
+ * A rendered, truncated string.
+ *
+ * Keyed by everything that affects the pixels: font, color, the width the
+ * text was truncated to, and the source string itself.
+ */
+typedef struct TextCacheEntry {
+	TTF_Font* font;
+	uint32_t color; // Packed RGBA
+	int max_width; // Width available for text (0 = not truncated)
+	uint32_t hash; // Hash of text, checked before strcmp
+	char* text; // Source text (NULL = unused slot)
+	SDL_Surface* surface; // Rendered truncated text
+	int width; // Measured width of the truncated text
+	size_t bytes; // Accounted size (pixels + bookkeeping)
+	unsigned int last_used; // LRU tick
+} TextCacheEntry;
+
+static struct {
+	TextCacheEntry entries[GFX_TEXT_CACHE_ENTRIES];
+	size_t bytes;
+	unsigned int tick;
+} text_cache;
+
+/**
+ * 32-bit FNV-1a hash of a string.
+ */
+static uint32_t hashText(const char* str) {
+	uint32_t hash = 2166136261u;
+	while (*str) {
+		hash ^= (unsigned char)*str++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * Releases a cache slot.
+ */
+static void TextCache_release(TextCacheEntry* entry) {
+	if (!entry->text)
+		return;
+	text_cache.bytes -= entry->bytes;
+	SDL_FreeSurface(entry->surface);
+	free(entry->text);
+	memset(entry, 0, sizeof(TextCacheEntry));
+}
+
+/**
+ * Evicts least recently used entries until bytes more fit and a slot is free.
+ *
+ * @return Free slot to use
+ */
+static TextCacheEntry* TextCache_reserve(size_t bytes) {
+	while (1) {
+		TextCacheEntry* free_slot = NULL;
+		TextCacheEntry* oldest = NULL;
+		for (int i = 0; i < GFX_TEXT_CACHE_ENTRIES; i++) {
+			TextCacheEntry* entry = &text_cache.entries[i];
+			if (!entry->text) {
+				if (!free_slot)
+					free_slot = entry;
+			} else if (!oldest || entry->last_used < oldest->last_used) {
+				oldest = entry;
+			}
+		}
+
+		if (free_slot && (text_cache.bytes + bytes <= GFX_TEXT_CACHE_BUDGET || !oldest))
+			return free_slot;
+
+		TextCache_release(oldest);
+	}
+}
+
+/**
+ * Renders text truncated to a maximum width, reusing a cached surface.
+ */
+SDL_Surface* GFX_getText(TTF_Font* ttf_font, const char* text, SDL_Color color, int max_width,
+                         int padding, int* width) {
+	if (!text || !text[0]) {
+		if (width)
+			*width = padding;
+		return NULL;
+	}
+
+	uint32_t packed = ((uint32_t)color.r << 24) | ((uint32_t)color.g << 16) |
+	                  ((uint32_t)color.b << 8) | color.a;
+	int text_max = max_width > 0 ? max_width - padding : 0;
+	uint32_t hash = hashText(text);
+
+	for (int i = 0; i < GFX_TEXT_CACHE_ENTRIES; i++) {
+		TextCacheEntry* entry = &text_cache.entries[i];
+		if (entry->text && entry->hash == hash && entry->font == ttf_font &&
+		    entry->color == packed && entry->max_width == text_max &&
+		    strcmp(entry->text, text) == 0) {
+			entry->last_used = ++text_cache.tick;
+			if (width)
+				*width = entry->width + padding;
+			return entry->surface;
+		}
+	}
+
+	// Miss: truncate, measure and rasterize once
+	char truncated[MAX_PATH];
+	int text_width;
+	if (max_width > 0) {
+		char source[MAX_PATH];
+		snprintf(source, sizeof(source), "%s", text);
+		text_width = GFX_truncateText(ttf_font, source, truncated, max_width, padding) - padding;
+	} else {
+		snprintf(truncated, sizeof(truncated), "%s", text);
+		TTF_SizeUTF8(ttf_font, truncated, &text_width, NULL);
+	}
+
+	SDL_Surface* surface = TTF_RenderUTF8_Blended(ttf_font, truncated, color);
+	if (width)
+		*width = text_width + padding;
+	if (!surface)
+		return NULL;
+
+	char* key = strdup(text);
+	if (!key) {
+		SDL_FreeSurface(surface);
+		return NULL;
+	}
+
+	size_t bytes = sizeof(SDL_Surface) + (size_t)surface->pitch * surface->h + strlen(text) + 1;
+	TextCacheEntry* entry = TextCache_reserve(bytes);
+	entry->font = ttf_font;
+	entry->color = packed;
+	entry->max_width = text_max;
+	entry->hash = hash;
+	entry->text = key;
+	entry->surface = surface;
+	entry->width = text_width;
+	entry->bytes = bytes;
+	entry->last_used = ++text_cache.tick;
+	text_cache.bytes += bytes;
+
+	return surface;
+}
+
+/**
+ * Frees every cached text surface.
+ */
+void GFX_clearTextCache(void) {
+	for (int i = 0; i < GFX_TEXT_CACHE_ENTRIES; i++) {
+		TextCache_release(&text_cache.entries[i]);
+	}
+	text_cache.bytes = 0;
+}
@@ -4,8 +4,9 @@
  * Provides text manipulation functions for the graphics system:
  * - Text truncation with ellipsis
  * - Multi-line text wrapping
+ * - Cached rendering of truncated single-line text
  *
- * These are pure logic functions extracted from api.c for testability.
+ * The layout functions are pure logic extracted from api.c for testability.
  * They depend only on TTF_SizeUTF8 for measuring text width.
  */
 
@@ -19,9 +20,10 @@
 /**
  * Truncates text to fit within a maximum width.
  *
- * If the text (plus padding) exceeds max_width, characters are removed from
- * the end and replaced with "..." until it fits. The output string is modified
- * in place.
+ * If the text (plus padding) exceeds max_width, it is cut at the longest
+ * prefix (on a UTF-8 character boundary) that fits with "..." appended.
+ * The cut point is found by binary search, so the number of TTF_SizeUTF8
+ * calls grows with log(length) rather than length.
  *
  * Example:
  *   "The Legend of Zelda" -> "The Legend..."
@@ -79,4 +81,36 @@ int GFX_wrapText(TTF_Font* font, char* str, int max_width, int max_lines);
  */
 void GFX_sizeText(TTF_Font* font, char* str, int leading, int* w, int* h);
 
+/**
+ * Renders single-line text truncated to a maximum width, with caching.
+ *
+ * Combines GFX_truncateText() and TTF_RenderUTF8_Blended(), keeping the
+ * result in an LRU cache keyed by (font, text, color, max width). Redrawing
+ * a list only rasterizes rows that haven't been seen recently, and the
+ * truncation measurements are cached along with the surface.
+ *
+ * The cache is bounded by a byte budget (GFX_TEXT_CACHE_BUDGET).
+ *
+ * @param font TTF font to render with
+ * @param text Text to render
+ * @param color Text color
+ * @param max_width Maximum width in pixels including padding (0 for no truncation)
+ * @param padding Additional padding to account for in pixels
+ * @param width Output: width of truncated text including padding (may be NULL)
+ * @return Rendered surface, or NULL for empty text or on failure
+ *
+ * @warning The surface is owned by the cache: do not free or modify it, and
+ *          don't hold on to it across later GFX_getText() calls
+ */
+SDL_Surface* GFX_getText(TTF_Font* font, const char* text, SDL_Color color, int max_width,
+                         int padding, int* width);
+
+/**
+ * Frees every cached text surface.
+ *
+ * Must be called before closing any font that may have been passed to
+ * GFX_getText(), since entries are keyed by font pointer.
+ */
+void GFX_clearTextCache(void);
+
 #endif // __GFX_TEXT_H__
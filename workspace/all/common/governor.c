@@ -0,0 +1,121 @@
+/**
+ * governor.c - CPU speed controller driven by emulation headroom
+ */
+
+#include "governor.h"
+#include <string.h>
+
+/**
+ * Starts a fresh step-down window.
+ */
+static void Governor_resetWindow(Governor* governor) {
+	governor->window_frames = 0;
+	governor->window_peak = 0;
+	governor->window_audio = 100;
+}
+
+/**
+ * Moves to a new level and waits for it to take effect before judging it.
+ */
+static void Governor_setLevel(Governor* governor, int level) {
+	governor->level = level;
+	governor->settle = GOVERNOR_SETTLE_FRAMES;
+	governor->calm_windows = 0;
+	governor->transitions += 1;
+	Governor_resetWindow(governor);
+}
+
+/**
+ * Estimates the busy percent of peak at the next lower level.
+ */
+static int Governor_predictLower(const Governor* governor, int peak) {
+	int current = governor->khz[governor->level];
+	int lower = governor->khz[governor->level - 1];
+	if (current > 0 && lower > 0)
+		return (int)((int64_t)peak * current / lower);
+	return peak * GOVERNOR_DEFAULT_RATIO / 100;
+}
+
+/**
+ * Resets the governor.
+ */
+void Governor_init(Governor* governor, const int khz[GOVERNOR_LEVELS], int level) {
+	memset(governor, 0, sizeof(*governor));
+	if (khz)
+		memcpy(governor->khz, khz, sizeof(governor->khz));
+	if (level < 0)
+		level = 0;
+	if (level >= GOVERNOR_LEVELS)
+		level = GOVERNOR_LEVELS - 1;
+	governor->level = level;
+	governor->down_windows = GOVERNOR_DOWN_WINDOWS;
+	governor->frames_since_down = GOVERNOR_WINDOW_FRAMES * GOVERNOR_DOWN_WINDOWS_MAX;
+	Governor_resetWindow(governor);
+}
+
+/**
+ * Ignores the next few frames, e.g. after returning from the menu.
+ */
+void Governor_settle(Governor* governor) {
+	governor->settle = GOVERNOR_SETTLE_FRAMES;
+	Governor_resetWindow(governor);
+}
+
+/**
+ * Reports one emulated frame.
+ */
+int Governor_update(Governor* governor, uint32_t busy_us, uint32_t budget_us, int audio_fill) {
+	if (budget_us == 0)
+		return governor->level;
+
+	governor->time_at_level[governor->level] += budget_us;
+	if (governor->frames_since_down < GOVERNOR_WINDOW_FRAMES * GOVERNOR_DOWN_WINDOWS_MAX) {
+		governor->frames_since_down += 1;
+		// No step down for a long while, forget any earlier thrash
+		if (governor->frames_since_down == GOVERNOR_WINDOW_FRAMES * GOVERNOR_DOWN_WINDOWS_MAX)
+			governor->down_windows = GOVERNOR_DOWN_WINDOWS;
+	}
+
+	if (governor->settle > 0) {
+		governor->settle -= 1;
+		return governor->level;
+	}
+
+	int busy = (int)((uint64_t)busy_us * 100 / budget_us);
+	int starved = audio_fill >= 0 && audio_fill < GOVERNOR_AUDIO_LOW;
+
+	// Step up right away, before the next frame can miss
+	if (busy > GOVERNOR_UP_THRESHOLD || starved) {
+		if (governor->level < GOVERNOR_LEVELS - 1) {
+			// Stepping back up soon after stepping down: be slower to try again
+			if (governor->frames_since_down < GOVERNOR_WINDOW_FRAMES * 2) {
+				governor->down_windows *= 2;
+				if (governor->down_windows > GOVERNOR_DOWN_WINDOWS_MAX)
+					governor->down_windows = GOVERNOR_DOWN_WINDOWS_MAX;
+			}
+			Governor_setLevel(governor, governor->level + 1);
+			return governor->level;
+		}
+	}
+
+	if (busy > governor->window_peak)
+		governor->window_peak = busy;
+	if (audio_fill >= 0 && audio_fill < governor->window_audio)
+		governor->window_audio = audio_fill;
+	governor->window_frames += 1;
+	if (governor->window_frames < GOVERNOR_WINDOW_FRAMES)
+		return governor->level;
+
+	// End of window: only step down after several calm ones in a row
+	int calm = governor->level > 0 &&
+	           Governor_predictLower(governor, governor->window_peak) < GOVERNOR_DOWN_THRESHOLD &&
+	           governor->window_audio >= GOVERNOR_AUDIO_OK;
+	governor->calm_windows = calm ? governor->calm_windows + 1 : 0;
+	Governor_resetWindow(governor);
+
+	if (governor->calm_windows >= governor->down_windows) {
+		Governor_setLevel(governor, governor->level - 1);
+		governor->frames_since_down = 0;
+	}
+	return governor->level;
+}
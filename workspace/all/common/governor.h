@@ -0,0 +1,83 @@
+/**
+ * governor.h - CPU speed controller driven by emulation headroom
+ *
+ * Backs minarch's "Auto" CPU Speed setting. Each frame the caller reports
+ * how long the core took against the frame budget, plus the audio buffer
+ * fill, and the governor picks between the POWERSAVE, NORMAL and
+ * PERFORMANCE levels:
+ *
+ * - Up, immediately: one frame over GOVERNOR_UP_THRESHOLD of its budget,
+ *   or audio fill under GOVERNOR_AUDIO_LOW.
+ * - Down, slowly: GOVERNOR_DOWN_WINDOWS consecutive windows whose busiest
+ *   frame, scaled to the next lower frequency, stays under
+ *   GOVERNOR_DOWN_THRESHOLD with audio fill at or above GOVERNOR_AUDIO_OK.
+ *
+ * The gap between the two thresholds is the hysteresis. If a step up
+ * follows soon after a step down, the number of calm windows needed
+ * doubles, so a game sitting on the edge of a level stops bouncing.
+ *
+ * This module has no SDL dependency.
+ */
+
+#ifndef __GOVERNOR_H__
+#define __GOVERNOR_H__
+
+#include <stdint.h>
+
+#define GOVERNOR_LEVELS 3 // CPU_SPEED_POWERSAVE through CPU_SPEED_PERFORMANCE
+
+#define GOVERNOR_UP_THRESHOLD 85 // Percent of frame budget that triggers a step up
+#define GOVERNOR_DOWN_THRESHOLD 70 // Predicted percent at the lower level to step down
+#define GOVERNOR_AUDIO_LOW 25 // Audio fill percent that triggers a step up
+#define GOVERNOR_AUDIO_OK 40 // Audio fill percent required to step down
+#define GOVERNOR_WINDOW_FRAMES 60 // Frames per step-down window
+#define GOVERNOR_DOWN_WINDOWS 3 // Calm windows needed to step down
+#define GOVERNOR_DOWN_WINDOWS_MAX 24 // Limit for the thrash backoff
+#define GOVERNOR_SETTLE_FRAMES 4 // Frames ignored after a change
+#define GOVERNOR_DEFAULT_RATIO 150 // Assumed percent speedup per level if kHz are unknown
+
+/**
+ * Governor state. Treat as opaque outside governor.c.
+ */
+typedef struct Governor {
+	int level; // 0 (POWERSAVE) to GOVERNOR_LEVELS - 1 (PERFORMANCE)
+	int khz[GOVERNOR_LEVELS]; // Frequency per level, 0 if unknown
+	int settle; // Frames left to ignore after a change
+	int window_frames; // Frames in the current window
+	int window_peak; // Busiest frame in the window (percent of budget)
+	int window_audio; // Lowest audio fill in the window (percent)
+	int calm_windows; // Consecutive windows that allowed a step down
+	int down_windows; // Calm windows currently required (grows with thrash)
+	int frames_since_down; // Frames since the last step down
+	int transitions; // Level changes since init
+	uint64_t time_at_level[GOVERNOR_LEVELS]; // Microseconds spent at each level
+} Governor;
+
+/**
+ * Resets the governor.
+ *
+ * @param governor Governor to reset
+ * @param khz Frequency of each level, or NULL if unknown
+ * @param level Starting level
+ */
+void Governor_init(Governor* governor, const int khz[GOVERNOR_LEVELS], int level);
+
+/**
+ * Ignores the next few frames, e.g. after returning from the menu.
+ *
+ * @param governor Governor
+ */
+void Governor_settle(Governor* governor);
+
+/**
+ * Reports one emulated frame.
+ *
+ * @param governor Governor
+ * @param busy_us Time the core spent producing the frame, excluding vsync waits
+ * @param budget_us Time available per frame (1000000 / fps)
+ * @param audio_fill Audio buffer fill percent, or -1 if unknown
+ * @return Level to run at (may be unchanged)
+ */
+int Governor_update(Governor* governor, uint32_t busy_us, uint32_t budget_us, int audio_fill);
+
+#endif // __GOVERNOR_H__
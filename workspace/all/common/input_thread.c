@@ -0,0 +1,295 @@
+/**
+ * input_thread.c - Dedicated evdev reader for raw input platforms
+ */
+
+#include "input_thread.h"
+#include "log.h"
+#include <errno.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#define INPUT_THREAD_READ_BATCH 16 // Events read per read() call
+
+typedef struct InputQueue {
+	InputEvent events[INPUT_THREAD_QUEUE_SIZE];
+	uint32_t head; // Written by the thread
+	uint32_t tail; // Written by the polling thread
+} InputQueue;
+
+typedef struct InputControl {
+	int index;
+	uint16_t type;
+	uint16_t code;
+} InputControl;
+
+static struct {
+	InputQueue queues[INPUT_THREAD_MAX_SOURCES];
+	int fds[INPUT_THREAD_MAX_SOURCES];
+	uint64_t digital_axes[INPUT_THREAD_MAX_SOURCES]; // Bit per ABS code that is a D-pad
+	int count;
+	int stop_fd; // eventfd that ends the thread
+	int notify_fd; // eventfd bumped whenever events are queued
+	int running;
+	int overflowed; // Logged once per start
+	pthread_t thread;
+
+	// Poll side
+	InputControl changed[INPUT_THREAD_FRAME_CONTROLS]; // Digital controls changed this frame
+	int changed_count;
+	uint32_t age_us;
+} input = {.stop_fd = -1, .notify_fd = -1};
+
+static uint64_t InputThread_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void InputThread_convert(const struct input_event* raw, InputEvent* event) {
+#ifdef input_event_sec
+	event->time_us = (uint64_t)raw->input_event_sec * 1000000 + raw->input_event_usec;
+#else
+	event->time_us = (uint64_t)raw->time.tv_sec * 1000000 + raw->time.tv_usec;
+#endif
+	event->type = raw->type;
+	event->code = raw->code;
+	event->value = raw->value;
+}
+
+/**
+ * Queues one event. Drops it if the poll side has fallen a whole queue behind.
+ */
+static int InputThread_push(InputQueue* queue, const InputEvent* event) {
+	uint32_t head = queue->head;
+	uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+	if (head - tail >= INPUT_THREAD_QUEUE_SIZE) {
+		if (!input.overflowed) {
+			input.overflowed = 1;
+			LOG_warn("input: queue full, dropping events");
+		}
+		return 0;
+	}
+	queue->events[head & (INPUT_THREAD_QUEUE_SIZE - 1)] = *event;
+	__atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/**
+ * Finds a device's digital axes: the hats, plus any axis whose range is
+ * -1..1 (D-pads some drivers report on ABS_X/ABS_Y). Sticks keep their
+ * small values near center as analog.
+ */
+static uint64_t InputThread_digitalAxes(int fd) {
+	uint64_t axes = 0;
+	for (int code = ABS_HAT0X; code <= ABS_HAT3Y; code++)
+		axes |= 1ULL << code;
+
+	uint8_t bits[ABS_MAX / 8 + 1] = {0};
+	if (fd < 0 || ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(bits)), bits) < 0)
+		return axes;
+	for (int code = 0; code <= ABS_MAX && code < 64; code++) {
+		struct input_absinfo info;
+		if ((bits[code / 8] & (1 << (code % 8))) &&
+		    ioctl(fd, EVIOCGABS(code), &info) == 0 && info.minimum >= -1 && info.maximum <= 1)
+			axes |= 1ULL << code;
+	}
+	return axes;
+}
+
+static void* InputThread_run(void* arg) {
+	struct pollfd fds[INPUT_THREAD_MAX_SOURCES + 1];
+	for (int i = 0; i < input.count; i++) {
+		fds[i].fd = input.fds[i];
+		fds[i].events = POLLIN;
+	}
+	fds[input.count].fd = input.stop_fd;
+	fds[input.count].events = POLLIN;
+
+	struct input_event raw[INPUT_THREAD_READ_BATCH];
+	while (1) {
+		if (poll(fds, input.count + 1, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			LOG_errno("input: poll failed");
+			break;
+		}
+		if (fds[input.count].revents)
+			break;
+
+		int queued = 0;
+		for (int i = 0; i < input.count; i++) {
+			if (fds[i].revents & POLLIN) {
+				ssize_t got;
+				while ((got = read(fds[i].fd, raw, sizeof(raw))) > 0) {
+					for (int j = 0; j < got / (ssize_t)sizeof(raw[0]); j++) {
+						InputEvent event;
+						InputThread_convert(&raw[j], &event);
+						queued += InputThread_push(&input.queues[i], &event);
+					}
+				}
+			}
+			// A device that went away is ignored from now on
+			if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL))
+				fds[i].fd = -1;
+		}
+
+		if (queued) {
+			uint64_t one = 1;
+			write(input.notify_fd, &one, sizeof(one));
+		}
+	}
+	return NULL;
+}
+
+int InputThread_start(const int* fds, int count) {
+	InputThread_stop();
+	if (count > INPUT_THREAD_MAX_SOURCES)
+		count = INPUT_THREAD_MAX_SOURCES;
+
+	input.stop_fd = eventfd(0, EFD_CLOEXEC);
+	input.notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (input.stop_fd < 0 || input.notify_fd < 0) {
+		LOG_errno("input: eventfd failed");
+		InputThread_stop();
+		return -1;
+	}
+
+	input.count = count;
+	for (int i = 0; i < count; i++) {
+		input.fds[i] = fds[i];
+		input.queues[i].head = 0;
+		input.queues[i].tail = 0;
+		input.digital_axes[i] = InputThread_digitalAxes(fds[i]);
+
+		// Stamp events on the clock the poll side measures age with
+		int clock = CLOCK_MONOTONIC;
+		if (fds[i] >= 0)
+			ioctl(fds[i], EVIOCSCLOCKID, &clock);
+	}
+	input.overflowed = 0;
+	input.changed_count = 0;
+	input.age_us = 0;
+
+	if (pthread_create(&input.thread, NULL, InputThread_run, NULL) != 0) {
+		LOG_error("input: unable to start input thread");
+		InputThread_stop();
+		return -1;
+	}
+	__atomic_store_n(&input.running, 1, __ATOMIC_RELEASE);
+	LOG_info("input: reading %i devices on a dedicated thread", count);
+	return 0;
+}
+
+void InputThread_stop(void) {
+	if (input.running) {
+		__atomic_store_n(&input.running, 0, __ATOMIC_RELEASE);
+		uint64_t one = 1;
+		write(input.stop_fd, &one, sizeof(one));
+		pthread_join(input.thread, NULL);
+	}
+	if (input.stop_fd >= 0) {
+		close(input.stop_fd);
+		input.stop_fd = -1;
+	}
+	if (input.notify_fd >= 0) {
+		close(input.notify_fd);
+		input.notify_fd = -1;
+	}
+	input.age_us = 0;
+}
+
+int InputThread_isRunning(void) {
+	return __atomic_load_n(&input.running, __ATOMIC_ACQUIRE);
+}
+
+void InputThread_beginFrame(void) {
+	input.changed_count = 0;
+}
+
+/**
+ * Whether an event changes a digital control (a key, or a D-pad axis).
+ */
+static int InputThread_isDigital(int index, const InputEvent* event) {
+	if (event->type == EV_KEY)
+		return event->value <= 1; // 2 is autorepeat, which changes nothing
+	if (event->type == EV_ABS && event->code < 64)
+		return (input.digital_axes[index] >> event->code) & 1;
+	return 0;
+}
+
+/**
+ * Records a digital change, or returns 0 if that control already changed
+ * this frame and the event has to wait for the next one.
+ */
+static int InputThread_claim(int index, const InputEvent* event) {
+	for (int i = 0; i < input.changed_count; i++) {
+		InputControl* control = &input.changed[i];
+		if (control->index == index && control->type == event->type &&
+		    control->code == event->code)
+			return 0;
+	}
+	if (input.changed_count < INPUT_THREAD_FRAME_CONTROLS) {
+		InputControl* control = &input.changed[input.changed_count++];
+		control->index = index;
+		control->type = event->type;
+		control->code = event->code;
+	}
+	return 1;
+}
+
+int InputThread_read(int index, int fd, InputEvent* event) {
+	if (!InputThread_isRunning() || index >= input.count) {
+		struct input_event raw;
+		if (fd < 0 || read(fd, &raw, sizeof(raw)) != sizeof(raw))
+			return 0;
+		InputThread_convert(&raw, event);
+		return 1;
+	}
+
+	InputQueue* queue = &input.queues[index];
+	uint32_t tail = queue->tail;
+	if (tail == __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE))
+		return 0;
+
+	InputEvent* next = &queue->events[tail & (INPUT_THREAD_QUEUE_SIZE - 1)];
+	if (InputThread_isDigital(index, next) && !InputThread_claim(index, next))
+		return 0; // Keep order: everything after it waits too
+
+	*event = *next;
+	__atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+
+	if (event->value != 0 && InputThread_isDigital(index, event)) {
+		uint64_t now = InputThread_now();
+		input.age_us = now > event->time_us ? (uint32_t)(now - event->time_us) : 0;
+	}
+	return 1;
+}
+
+int InputThread_wait(uint32_t timeout_ms) {
+	if (!InputThread_isRunning())
+		return 0;
+
+	for (int i = 0; i < input.count; i++) {
+		InputQueue* queue = &input.queues[i];
+		if (queue->tail != __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE))
+			return 1;
+	}
+
+	struct pollfd fd = {.fd = input.notify_fd, .events = POLLIN};
+	if (poll(&fd, 1, timeout_ms) <= 0)
+		return 0;
+
+	uint64_t count;
+	read(input.notify_fd, &count, sizeof(count));
+	return 1;
+}
+
+uint32_t InputThread_getAge(void) {
+	return InputThread_isRunning() ? input.age_us : 0;
+}
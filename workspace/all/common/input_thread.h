@@ -0,0 +1,100 @@
+/**
+ * input_thread.h - Dedicated evdev reader for raw input platforms
+ *
+ * Platforms that read evdev themselves used to drain their devices only
+ * from PLAT_pollInput, i.e. when the core asked for input. Events carried
+ * no usable timestamp, and a press and release that both arrived between
+ * two polls collapsed into nothing the core could see.
+ *
+ * When started, a thread blocks in poll() on the platform's device fds and
+ * moves each event, stamped by the kernel on CLOCK_MONOTONIC, into a
+ * lock-free single producer/single consumer ring per device. The platform
+ * keeps its event loop and only swaps read() for InputThread_read(), which
+ * reads the device directly while the thread isn't running.
+ *
+ * At poll time, a digital control (any key, an ABS_HAT* axis, or an axis
+ * whose absinfo range is -1..1) changes at most once per frame. A second
+ * change stays queued for the next InputThread_beginFrame(), so a tap
+ * shorter than a frame is still seen pressed for one frame and released
+ * the next. Analog axes are passed through as they come.
+ *
+ * This module has no SDL dependency.
+ */
+
+#ifndef __INPUT_THREAD_H__
+#define __INPUT_THREAD_H__
+
+#include <stdint.h>
+
+#define INPUT_THREAD_MAX_SOURCES 8 // Devices read by the thread
+#define INPUT_THREAD_QUEUE_SIZE 256 // Events buffered per device, power of 2
+#define INPUT_THREAD_FRAME_CONTROLS 32 // Controls tracked per frame
+
+/**
+ * One evdev event, without <linux/input.h> (its BTN_ constants clash
+ * with the platform headers).
+ */
+typedef struct InputEvent {
+	uint64_t time_us; // Kernel timestamp (CLOCK_MONOTONIC while the thread runs)
+	uint16_t type;
+	uint16_t code;
+	int32_t value;
+} InputEvent;
+
+/**
+ * Starts reading the devices on a dedicated thread.
+ *
+ * Negative fds are skipped. The fds stay owned by the platform and must
+ * stay open until InputThread_stop().
+ *
+ * @param fds Device fds, opened O_NONBLOCK
+ * @param count Number of fds (at most INPUT_THREAD_MAX_SOURCES)
+ * @return 0 on success, -1 if the thread couldn't be started
+ */
+int InputThread_start(const int* fds, int count);
+
+/**
+ * Stops the thread. Events still queued are dropped.
+ */
+void InputThread_stop(void);
+
+/**
+ * @return 1 while the thread is reading the devices
+ */
+int InputThread_isRunning(void);
+
+/**
+ * Starts a new frame of polling. Call at the top of PLAT_pollInput().
+ */
+void InputThread_beginFrame(void);
+
+/**
+ * Reads the next event of a device for this frame.
+ *
+ * Takes it from the device's queue while the thread runs, otherwise
+ * reads the fd directly.
+ *
+ * @param index Device index (position in the fds given to InputThread_start)
+ * @param fd Device fd, read directly when the thread isn't running
+ * @param event Receives the event
+ * @return 1 if an event was read, 0 if there is none for this frame
+ */
+int InputThread_read(int index, int fd, InputEvent* event);
+
+/**
+ * Blocks until the thread has queued input or the timeout expires.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return 1 if input is queued, 0 on timeout
+ */
+int InputThread_wait(uint32_t timeout_ms);
+
+/**
+ * How long the most recent press waited between the kernel stamping it
+ * and a poll taking it.
+ *
+ * @return Microseconds, 0 if the thread isn't running or saw no press yet
+ */
+uint32_t InputThread_getAge(void);
+
+#endif // __INPUT_THREAD_H__
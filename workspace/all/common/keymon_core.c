@@ -0,0 +1,646 @@
+/**
+ * keymon_core.c - Event-driven core for the keymon daemons
+ */
+
+#include "keymon_core.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <linux/netlink.h>
+#include <msettings.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#define KEYMON_VALUE_MAX 64 // Longest port file contents read
+#define KEYMON_UEVENT_MAX 2048 // Largest uevent message read
+#define KEYMON_EVENTS 16 // epoll events handled per step
+
+// epoll_data.u32 is the source type in the high half and its index in the low half
+enum {
+	KEYMON_SOURCE_INPUT,
+	KEYMON_SOURCE_REPEAT,
+	KEYMON_SOURCE_PORT,
+	KEYMON_SOURCE_PORT_TIMER,
+	KEYMON_SOURCE_UEVENT,
+};
+#define KEYMON_SOURCE(type, index) (((uint32_t)(type) << 16) | (uint32_t)(index))
+
+typedef struct KeymonPortState {
+	int fd; // sysfs file, kept open and re-read from the start, -1 if missing
+	int timer_fd; // Poll timer, -1 if the port notifies
+	int uevent; // 1 if re-read on uevents
+	int state; // Last state applied
+} KeymonPortState;
+
+static struct {
+	const KeymonConfig* config;
+	int epoll_fd;
+	int input_fds[KEYMON_MAX_INPUTS];
+	int repeat_fd;
+	int uevent_fd;
+	KeymonPortState ports[KEYMON_MAX_PORTS];
+	KeymonKeys keys;
+	int64_t suspended_ms; // CLOCK_BOOTTIME - CLOCK_MONOTONIC at the last wake
+} keymon = {.epoll_fd = -1, .repeat_fd = -1, .uevent_fd = -1};
+
+static volatile sig_atomic_t keymon_stopping = 0;
+
+///////////////////////////////
+// Button state
+
+/**
+ * Index into KeymonKeys.held and repeat_at.
+ */
+static int KeymonKeys_index(KeymonRole role) {
+	return role == KEYMON_PLUS ? 0 : 1;
+}
+
+/**
+ * What PLUS (index 0) or MINUS (index 1) does with the current modifier.
+ */
+static KeymonAction KeymonKeys_action(const KeymonKeys* keys, int index) {
+	if (index == 0)
+		return keys->menu ? KEYMON_BRIGHTNESS_UP : KEYMON_VOLUME_UP;
+	return keys->menu ? KEYMON_BRIGHTNESS_DOWN : KEYMON_VOLUME_DOWN;
+}
+
+/**
+ * Releases every button.
+ */
+void KeymonKeys_reset(KeymonKeys* keys) {
+	memset(keys, 0, sizeof(*keys));
+}
+
+/**
+ * Reports an EV_KEY event.
+ */
+KeymonAction KeymonKeys_event(KeymonKeys* keys, KeymonRole role, int value, uint64_t now_ms) {
+	if (value < 0 || value > 2)
+		return KEYMON_ACTION_NONE;
+
+	if (role == KEYMON_MENU) {
+		keys->menu = value != 0;
+		return KEYMON_ACTION_NONE;
+	}
+	if (role != KEYMON_PLUS && role != KEYMON_MINUS)
+		return KEYMON_ACTION_NONE;
+
+	int index = KeymonKeys_index(role);
+	keys->held[index] = value != 0;
+	if (!value) {
+		keys->repeat_at[index] = 0;
+		return KEYMON_ACTION_NONE;
+	}
+	keys->repeat_at[index] = now_ms + KEYMON_REPEAT_DELAY;
+	return KeymonKeys_action(keys, index);
+}
+
+/**
+ * Collects repeats that are due.
+ */
+int KeymonKeys_repeat(KeymonKeys* keys, uint64_t now_ms, KeymonAction actions[2]) {
+	int count = 0;
+	for (int i = 0; i < 2; i++) {
+		if (!keys->held[i] || now_ms < keys->repeat_at[i])
+			continue;
+		actions[count++] = KeymonKeys_action(keys, i);
+		keys->repeat_at[i] += KEYMON_REPEAT_INTERVAL;
+		if (keys->repeat_at[i] <= now_ms)
+			keys->repeat_at[i] = now_ms + KEYMON_REPEAT_INTERVAL;
+	}
+	return count;
+}
+
+/**
+ * Time the next repeat is due.
+ */
+uint64_t KeymonKeys_deadline(const KeymonKeys* keys) {
+	uint64_t deadline = 0;
+	for (int i = 0; i < 2; i++) {
+		if (keys->held[i] && (!deadline || keys->repeat_at[i] < deadline))
+			deadline = keys->repeat_at[i];
+	}
+	return deadline;
+}
+
+///////////////////////////////
+// Clocks and settings
+
+/**
+ * CLOCK_MONOTONIC in ms, the clock the repeat timer runs on.
+ */
+static uint64_t Keymon_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**
+ * Total time spent suspended since boot, in ms.
+ *
+ * CLOCK_BOOTTIME keeps counting through suspend and CLOCK_MONOTONIC
+ * doesn't, so the difference only grows across a suspend.
+ */
+static int64_t Keymon_suspendedMs(void) {
+	struct timespec boot;
+	struct timespec mono;
+	if (clock_gettime(CLOCK_BOOTTIME, &boot) != 0 || clock_gettime(CLOCK_MONOTONIC, &mono) != 0)
+		return 0;
+	return ((int64_t)boot.tv_sec - mono.tv_sec) * 1000 + (boot.tv_nsec - mono.tv_nsec) / 1000000;
+}
+
+/**
+ * Returns 1 if the device slept since the last call.
+ */
+static int Keymon_resumed(void) {
+	int64_t suspended_ms = Keymon_suspendedMs();
+	int resumed = suspended_ms - keymon.suspended_ms > KEYMON_SLEEP_GAP;
+	keymon.suspended_ms = suspended_ms;
+	return resumed;
+}
+
+/**
+ * Steps volume or brightness by one, within range.
+ */
+static void Keymon_perform(KeymonAction action) {
+	int value;
+	switch (action) {
+	case KEYMON_VOLUME_UP:
+		value = GetVolume();
+		if (value < KEYMON_VOLUME_MAX)
+			SetVolume(value + 1);
+		break;
+	case KEYMON_VOLUME_DOWN:
+		value = GetVolume();
+		if (value > KEYMON_VOLUME_MIN)
+			SetVolume(value - 1);
+		break;
+	case KEYMON_BRIGHTNESS_UP:
+		value = GetBrightness();
+		if (value < KEYMON_BRIGHTNESS_MAX)
+			SetBrightness(value + 1);
+		break;
+	case KEYMON_BRIGHTNESS_DOWN:
+		value = GetBrightness();
+		if (value > KEYMON_BRIGHTNESS_MIN)
+			SetBrightness(value - 1);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Arms the repeat timer for the next held button, or disarms it.
+ */
+static void Keymon_armRepeat(void) {
+	struct itimerspec spec = {0};
+	uint64_t deadline = KeymonKeys_deadline(&keymon.keys);
+	if (deadline) {
+		spec.it_value.tv_sec = deadline / 1000;
+		spec.it_value.tv_nsec = (deadline % 1000) * 1000000;
+	}
+	if (keymon.repeat_fd >= 0)
+		timerfd_settime(keymon.repeat_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+
+///////////////////////////////
+// Input devices
+
+/**
+ * Handles one evdev event.
+ */
+static void Keymon_handleEvent(const struct input_event* event, uint64_t now_ms) {
+	const KeymonConfig* config = keymon.config;
+
+	if (event->type == EV_SW) {
+		for (int i = 0; i < config->switch_count; i++) {
+			if (config->switches[i].code == event->code)
+				config->switches[i].apply(event->value);
+		}
+		return;
+	}
+	if (event->type != EV_KEY)
+		return;
+
+	for (int i = 0; i < config->button_count; i++) {
+		if (config->buttons[i].code != event->code)
+			continue;
+		KeymonAction action =
+		    KeymonKeys_event(&keymon.keys, config->buttons[i].role, event->value, now_ms);
+		Keymon_perform(action);
+		return;
+	}
+}
+
+/**
+ * Stops watching an input device that went away.
+ */
+static void Keymon_closeInput(int index) {
+	LOG_warn("keymon: lost %s", keymon.config->inputs[index]);
+	epoll_ctl(keymon.epoll_fd, EPOLL_CTL_DEL, keymon.input_fds[index], NULL);
+	close(keymon.input_fds[index]);
+	keymon.input_fds[index] = -1;
+}
+
+/**
+ * Reads everything pending on an input device.
+ *
+ * @param index Input slot
+ * @param stale 1 to throw the events away
+ */
+static void Keymon_readInput(int index, int stale) {
+	struct input_event events[16];
+	uint64_t now_ms = Keymon_now();
+	ssize_t size;
+
+	while ((size = read(keymon.input_fds[index], events, sizeof(events))) > 0) {
+		if (stale)
+			continue;
+		int count = size / sizeof(events[0]);
+		for (int i = 0; i < count; i++)
+			Keymon_handleEvent(&events[i], now_ms);
+	}
+	if (size < 0 && errno != EAGAIN && errno != EINTR)
+		Keymon_closeInput(index);
+}
+
+///////////////////////////////
+// Ports
+
+/**
+ * Ports in the config, up to KEYMON_MAX_PORTS.
+ */
+static int Keymon_portCount(void) {
+	int count = keymon.config->port_count;
+	return count < KEYMON_MAX_PORTS ? count : KEYMON_MAX_PORTS;
+}
+
+/**
+ * Parses a sysfs file holding an integer.
+ */
+int Keymon_parseInt(const char* value) {
+	return (int)strtol(value, NULL, 0);
+}
+
+/**
+ * Reads a port's file from the start and parses it.
+ *
+ * A missing file parses as empty.
+ */
+static int Keymon_readPort(int index) {
+	const KeymonPort* port = &keymon.config->ports[index];
+	int fd = keymon.ports[index].fd;
+	char value[KEYMON_VALUE_MAX];
+	ssize_t size = -1;
+
+	if (fd >= 0) {
+		do {
+			size = pread(fd, value, sizeof(value) - 1, 0);
+		} while (size < 0 && errno == EINTR);
+	}
+	value[size > 0 ? size : 0] = '\0';
+	return port->parse ? port->parse(value) : Keymon_parseInt(value);
+}
+
+/**
+ * Re-reads a port and applies its state if it changed.
+ *
+ * @param index Port
+ * @param force 1 to apply even if unchanged
+ */
+static void Keymon_checkPort(int index, int force) {
+	int state = Keymon_readPort(index);
+	if (!force && state == keymon.ports[index].state)
+		return;
+	keymon.ports[index].state = state;
+	keymon.config->ports[index].apply(state);
+}
+
+/**
+ * Asks the kernel to signal a GPIO value file on both edges.
+ *
+ * @param path GPIO's value file (its edge file is beside it)
+ * @return 0 on success, -1 if the GPIO can't interrupt
+ */
+static int Keymon_setEdge(const char* path) {
+	char edge_path[256];
+	const char* slash = strrchr(path, '/');
+	if (!slash)
+		return -1;
+	snprintf(edge_path, sizeof(edge_path), "%.*sedge", (int)(slash - path + 1), path);
+
+	int fd = open(edge_path, O_WRONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	int ok = write(fd, "both", 4) == 4;
+	close(fd);
+	return ok ? 0 : -1;
+}
+
+/**
+ * Opens the uevent netlink socket on first use.
+ *
+ * @return 0 if it's open, -1 if uevents aren't available
+ */
+static int Keymon_openUevents(void) {
+	if (keymon.uevent_fd >= 0)
+		return 0;
+
+	int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+	if (fd < 0)
+		return -1;
+
+	struct sockaddr_nl addr = {0};
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = 1; // Kernel broadcasts
+	struct epoll_event event = {.events = EPOLLIN,
+	                            .data.u32 = KEYMON_SOURCE(KEYMON_SOURCE_UEVENT, 0)};
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+	    epoll_ctl(keymon.epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+		close(fd);
+		return -1;
+	}
+	keymon.uevent_fd = fd;
+	return 0;
+}
+
+/**
+ * Starts polling a port every interval_ms.
+ */
+static int Keymon_pollPort(int index) {
+	const KeymonPort* port = &keymon.config->ports[index];
+	int interval_ms = port->interval_ms > 0 ? port->interval_ms : 1000;
+
+	int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (fd < 0)
+		return -1;
+
+	struct itimerspec spec = {0};
+	spec.it_interval.tv_sec = interval_ms / 1000;
+	spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000;
+	spec.it_value = spec.it_interval;
+	struct epoll_event event = {.events = EPOLLIN,
+	                            .data.u32 = KEYMON_SOURCE(KEYMON_SOURCE_PORT_TIMER, index)};
+	if (timerfd_settime(fd, 0, &spec, NULL) != 0 ||
+	    epoll_ctl(keymon.epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+		close(fd);
+		return -1;
+	}
+	keymon.ports[index].timer_fd = fd;
+	return 0;
+}
+
+/**
+ * Opens a port, applies its current state and starts watching it.
+ */
+static void Keymon_openPort(int index) {
+	const KeymonPort* port = &keymon.config->ports[index];
+	KeymonPortState* state = &keymon.ports[index];
+
+	state->timer_fd = -1;
+	state->uevent = 0;
+	state->fd = open(port->path, O_RDONLY | O_CLOEXEC);
+	if (state->fd < 0)
+		LOG_warn("keymon: unable to open %s", port->path);
+
+	// Read before waiting for POLLPRI, or it's reported straight away
+	Keymon_checkPort(index, 1);
+	if (state->fd < 0)
+		return;
+
+	if (port->notify == KEYMON_GPIO && Keymon_setEdge(port->path) == 0) {
+		struct epoll_event event = {.events = EPOLLPRI | EPOLLERR,
+		                            .data.u32 = KEYMON_SOURCE(KEYMON_SOURCE_PORT, index)};
+		if (epoll_ctl(keymon.epoll_fd, EPOLL_CTL_ADD, state->fd, &event) == 0)
+			return;
+	}
+	if (port->notify == KEYMON_UEVENT && port->subsystem && Keymon_openUevents() == 0) {
+		state->uevent = 1;
+		return;
+	}
+
+	if (port->notify != KEYMON_POLL)
+		LOG_info("keymon: no notifications for %s, polling", port->path);
+	if (Keymon_pollPort(index) != 0)
+		LOG_errno("keymon: unable to poll %s", port->path);
+}
+
+/**
+ * Re-reads the ports whose subsystem sent a uevent.
+ */
+static void Keymon_readUevents(void) {
+	char message[KEYMON_UEVENT_MAX];
+	ssize_t size;
+
+	while ((size = recv(keymon.uevent_fd, message, sizeof(message) - 1, 0)) > 0) {
+		message[size] = '\0';
+
+		// "action@devpath" then KEY=value fields, all NUL separated
+		const char* subsystem = NULL;
+		for (const char* field = message; field < message + size; field += strlen(field) + 1) {
+			if (strncmp(field, "SUBSYSTEM=", 10) == 0) {
+				subsystem = field + 10;
+				break;
+			}
+		}
+		if (!subsystem)
+			continue;
+
+		for (int i = 0; i < Keymon_portCount(); i++) {
+			if (keymon.ports[i].uevent && strcmp(keymon.config->ports[i].subsystem, subsystem) == 0)
+				Keymon_checkPort(i, 0);
+		}
+	}
+}
+
+/**
+ * Consumes a timerfd's expiration count.
+ */
+static void Keymon_drainTimer(int fd) {
+	uint64_t expirations;
+	while (read(fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+		;
+}
+
+///////////////////////////////
+// Main loop
+
+/**
+ * Opens the platform's devices and applies the current port states.
+ */
+int Keymon_init(const KeymonConfig* config) {
+	keymon.config = config;
+	for (int i = 0; i < KEYMON_MAX_PORTS; i++)
+		keymon.ports[i].fd = keymon.ports[i].timer_fd = -1;
+	for (int i = 0; i < KEYMON_MAX_INPUTS; i++)
+		keymon.input_fds[i] = -1;
+
+	keymon.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (keymon.epoll_fd < 0) {
+		LOG_errno("keymon: epoll_create1 failed");
+		return -1;
+	}
+	KeymonKeys_reset(&keymon.keys);
+	keymon.suspended_ms = Keymon_suspendedMs();
+
+	for (int i = 0; i < KEYMON_MAX_INPUTS; i++) {
+		if (!config->inputs[i])
+			continue;
+		int fd = open(config->inputs[i], O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+		if (fd < 0) {
+			LOG_warn("keymon: unable to open %s", config->inputs[i]);
+			continue;
+		}
+		struct epoll_event event = {.events = EPOLLIN,
+		                            .data.u32 = KEYMON_SOURCE(KEYMON_SOURCE_INPUT, i)};
+		if (epoll_ctl(keymon.epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+			LOG_errno("keymon: unable to watch %s", config->inputs[i]);
+			close(fd);
+			continue;
+		}
+		keymon.input_fds[i] = fd;
+	}
+
+	keymon.repeat_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	struct epoll_event event = {.events = EPOLLIN,
+	                            .data.u32 = KEYMON_SOURCE(KEYMON_SOURCE_REPEAT, 0)};
+	if (keymon.repeat_fd < 0 ||
+	    epoll_ctl(keymon.epoll_fd, EPOLL_CTL_ADD, keymon.repeat_fd, &event) != 0) {
+		LOG_errno("keymon: unable to create repeat timer");
+		Keymon_quit();
+		return -1;
+	}
+
+	for (int i = 0; i < Keymon_portCount(); i++)
+		Keymon_openPort(i);
+	return 0;
+}
+
+/**
+ * Waits for and handles one batch of events.
+ */
+int Keymon_step(int timeout_ms) {
+	struct epoll_event events[KEYMON_EVENTS];
+	int count = epoll_wait(keymon.epoll_fd, events, KEYMON_EVENTS, timeout_ms);
+	if (count < 0)
+		return errno == EINTR ? 0 : -1;
+
+	// Whatever queued up while asleep is stale, including the button that woke us
+	int stale = Keymon_resumed();
+	if (stale) {
+		KeymonKeys_reset(&keymon.keys);
+		for (int i = 0; i < KEYMON_MAX_INPUTS; i++) {
+			if (keymon.input_fds[i] >= 0)
+				Keymon_readInput(i, 1);
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		int type = events[i].data.u32 >> 16;
+		int index = events[i].data.u32 & 0xffff;
+		switch (type) {
+		case KEYMON_SOURCE_INPUT:
+			if (!stale && keymon.input_fds[index] >= 0)
+				Keymon_readInput(index, 0);
+			break;
+		case KEYMON_SOURCE_REPEAT: {
+			KeymonAction actions[2];
+			Keymon_drainTimer(keymon.repeat_fd);
+			int repeats = KeymonKeys_repeat(&keymon.keys, Keymon_now(), actions);
+			for (int j = 0; j < repeats; j++)
+				Keymon_perform(actions[j]);
+			break;
+		}
+		case KEYMON_SOURCE_PORT:
+			Keymon_checkPort(index, 0);
+			break;
+		case KEYMON_SOURCE_PORT_TIMER:
+			Keymon_drainTimer(keymon.ports[index].timer_fd);
+			Keymon_checkPort(index, 0);
+			break;
+		case KEYMON_SOURCE_UEVENT:
+			Keymon_readUevents();
+			break;
+		}
+	}
+
+	// A change during suspend may not have been announced
+	if (stale) {
+		for (int i = 0; i < Keymon_portCount(); i++)
+			Keymon_checkPort(i, 0);
+	}
+
+	Keymon_armRepeat();
+	return count;
+}
+
+/**
+ * Asks Keymon_run to return.
+ */
+void Keymon_stop(void) {
+	keymon_stopping = 1;
+}
+
+/**
+ * Closes everything Keymon_init opened.
+ */
+void Keymon_quit(void) {
+	for (int i = 0; i < KEYMON_MAX_INPUTS; i++) {
+		if (keymon.input_fds[i] >= 0)
+			close(keymon.input_fds[i]);
+		keymon.input_fds[i] = -1;
+	}
+	for (int i = 0; i < KEYMON_MAX_PORTS; i++) {
+		if (keymon.ports[i].fd >= 0)
+			close(keymon.ports[i].fd);
+		if (keymon.ports[i].timer_fd >= 0)
+			close(keymon.ports[i].timer_fd);
+		keymon.ports[i].fd = keymon.ports[i].timer_fd = -1;
+		keymon.ports[i].uevent = 0;
+	}
+	if (keymon.uevent_fd >= 0)
+		close(keymon.uevent_fd);
+	if (keymon.repeat_fd >= 0)
+		close(keymon.repeat_fd);
+	if (keymon.epoll_fd >= 0)
+		close(keymon.epoll_fd);
+	keymon.uevent_fd = keymon.repeat_fd = keymon.epoll_fd = -1;
+}
+
+/**
+ * SIGTERM handler.
+ */
+static void Keymon_onTerm(int sig) {
+	Keymon_stop();
+}
+
+/**
+ * Runs the daemon until SIGTERM.
+ */
+int Keymon_run(const KeymonConfig* config) {
+	// No SA_RESTART, so the signal interrupts epoll_wait
+	struct sigaction action = {0};
+	action.sa_handler = Keymon_onTerm;
+	sigaction(SIGTERM, &action, NULL);
+
+	keymon_stopping = 0;
+	if (Keymon_init(config) != 0)
+		return 1;
+	while (!keymon_stopping) {
+		if (Keymon_step(-1) < 0) {
+			LOG_errno("keymon: epoll_wait failed");
+			break;
+		}
+	}
+	Keymon_quit();
+	return 0;
+}
@@ -0,0 +1,215 @@
+/**
+ * keymon_core.h - Event-driven core for the keymon daemons
+ *
+ * keymon runs for the device's whole uptime to handle the volume and
+ * brightness buttons and to follow the headphone jack, HDMI and mute
+ * switch. Each platform describes its hardware in a KeymonConfig and hands
+ * it to Keymon_run, which sleeps in epoll_wait until something happens:
+ *
+ * - evdev devices: button presses and EV_SW switches
+ * - a timerfd for key repeat, armed only while PLUS or MINUS is held
+ * - sysfs GPIO value files, signalled with POLLPRI once their edge is
+ *   set to "both"
+ * - a uevent netlink socket for ports whose driver announces changes
+ *   (drm, extcon, switch); the port's file is re-read on a matching event
+ * - a timerfd per port that has no way to notify, at its own interval
+ *
+ * With nothing held and no polled ports the daemon doesn't wake until the
+ * hardware has something to report. PLUS and MINUS act on the press itself
+ * instead of on the next 60Hz tick.
+ *
+ * Input that arrives across a suspend is dropped, as is the button state,
+ * so the button that woke the device doesn't change the volume.
+ *
+ * Buttons: MENU+PLUS/MINUS changes brightness, PLUS/MINUS alone changes
+ * volume. A held PLUS or MINUS repeats after KEYMON_REPEAT_DELAY ms, every
+ * KEYMON_REPEAT_INTERVAL ms. That logic lives in KeymonKeys, which does no
+ * I/O.
+ */
+
+#ifndef __KEYMON_CORE_H__
+#define __KEYMON_CORE_H__
+
+#include <stdint.h>
+
+#define KEYMON_REPEAT_DELAY 300 // ms a button is held before it repeats
+#define KEYMON_REPEAT_INTERVAL 100 // ms between repeats
+#define KEYMON_SLEEP_GAP 1000 // ms of suspend after which pending input is stale
+#define KEYMON_MAX_INPUTS 8 // evdev devices per platform
+#define KEYMON_MAX_PORTS 4 // Watched sysfs files per platform
+
+#define KEYMON_VOLUME_MIN 0
+#define KEYMON_VOLUME_MAX 20
+#define KEYMON_BRIGHTNESS_MIN 0
+#define KEYMON_BRIGHTNESS_MAX 10
+
+/**
+ * What a button does.
+ */
+typedef enum KeymonRole {
+	KEYMON_NONE = 0,
+	KEYMON_MENU, // Modifier: PLUS/MINUS change brightness while held
+	KEYMON_PLUS,
+	KEYMON_MINUS,
+} KeymonRole;
+
+/**
+ * What a press or repeat asks for.
+ */
+typedef enum KeymonAction {
+	KEYMON_ACTION_NONE = 0,
+	KEYMON_VOLUME_UP,
+	KEYMON_VOLUME_DOWN,
+	KEYMON_BRIGHTNESS_UP,
+	KEYMON_BRIGHTNESS_DOWN,
+} KeymonAction;
+
+/**
+ * Maps an EV_KEY code to a role.
+ */
+typedef struct KeymonButton {
+	int code; // EV_KEY code (not the SDL code)
+	KeymonRole role;
+} KeymonButton;
+
+/**
+ * Maps an EV_SW code to a setting.
+ */
+typedef struct KeymonSwitch {
+	int code; // EV_SW code
+	void (*apply)(int value); // SetJack, SetMute...
+} KeymonSwitch;
+
+/**
+ * How a port reports changes.
+ */
+typedef enum KeymonNotify {
+	KEYMON_POLL = 0, // Re-read every interval_ms
+	KEYMON_GPIO, // sysfs GPIO value file, POLLPRI on either edge
+	KEYMON_UEVENT, // Re-read when a uevent for subsystem arrives
+} KeymonNotify;
+
+/**
+ * A sysfs file that holds the state of a port.
+ *
+ * If GPIO or uevent notification can't be set up the file is polled every
+ * interval_ms instead.
+ */
+typedef struct KeymonPort {
+	const char* path; // sysfs file to read
+	int (*parse)(const char* value); // File contents to state, NULL for Keymon_parseInt
+	void (*apply)(int state); // SetJack, SetHDMI, SetMute...
+	KeymonNotify notify;
+	const char* subsystem; // uevent SUBSYSTEM for KEYMON_UEVENT ("drm", "extcon"...)
+	int interval_ms; // Poll interval (also the fallback for GPIO and uevent)
+} KeymonPort;
+
+/**
+ * A platform's buttons and ports.
+ */
+typedef struct KeymonConfig {
+	const char* inputs[KEYMON_MAX_INPUTS]; // evdev paths, unused slots NULL
+	const KeymonButton* buttons;
+	int button_count;
+	const KeymonSwitch* switches; // EV_SW handlers, or NULL
+	int switch_count;
+	const KeymonPort* ports; // Watched files, or NULL
+	int port_count;
+} KeymonConfig;
+
+/**
+ * Button state. Treat as opaque outside keymon_core.c.
+ */
+typedef struct KeymonKeys {
+	int menu; // MENU held
+	int held[2]; // PLUS, MINUS held
+	uint64_t repeat_at[2]; // Next repeat of PLUS, MINUS (ms)
+} KeymonKeys;
+
+/**
+ * Releases every button.
+ *
+ * @param keys Button state
+ */
+void KeymonKeys_reset(KeymonKeys* keys);
+
+/**
+ * Reports an EV_KEY event.
+ *
+ * A kernel autorepeat (value 2) acts like a fresh press.
+ *
+ * @param keys Button state
+ * @param role Role of the button
+ * @param value 0 released, 1 pressed, 2 autorepeat
+ * @param now_ms Current time
+ * @return Action to perform now, or KEYMON_ACTION_NONE
+ */
+KeymonAction KeymonKeys_event(KeymonKeys* keys, KeymonRole role, int value, uint64_t now_ms);
+
+/**
+ * Collects repeats that are due.
+ *
+ * A repeat that is more than one interval late fires once and the next
+ * one is scheduled from now, so a late wakeup doesn't burst.
+ *
+ * @param keys Button state
+ * @param now_ms Current time
+ * @param actions Receives up to two actions (PLUS and MINUS)
+ * @return Number of actions written
+ */
+int KeymonKeys_repeat(KeymonKeys* keys, uint64_t now_ms, KeymonAction actions[2]);
+
+/**
+ * Time the next repeat is due.
+ *
+ * @param keys Button state
+ * @return Deadline in ms, or 0 if nothing is held
+ */
+uint64_t KeymonKeys_deadline(const KeymonKeys* keys);
+
+/**
+ * Parses a sysfs file holding an integer (GPIO value, extcon state...).
+ *
+ * @param value File contents
+ * @return The integer, or 0 if there isn't one
+ */
+int Keymon_parseInt(const char* value);
+
+/**
+ * Opens the platform's devices and applies the current port states.
+ *
+ * Devices or files that are missing are logged and skipped.
+ *
+ * @param config Platform description (must outlive Keymon_quit)
+ * @return 0 on success, -1 if epoll couldn't be set up
+ */
+int Keymon_init(const KeymonConfig* config);
+
+/**
+ * Waits for and handles one batch of events.
+ *
+ * @param timeout_ms Longest wait, or -1 to wait until something happens
+ * @return Number of sources that were ready, or -1 on error
+ */
+int Keymon_step(int timeout_ms);
+
+/**
+ * Asks Keymon_run to return. Safe to call from a signal handler.
+ */
+void Keymon_stop(void);
+
+/**
+ * Closes everything Keymon_init opened.
+ */
+void Keymon_quit(void);
+
+/**
+ * Runs the daemon: Keymon_init, Keymon_step until SIGTERM or
+ * Keymon_stop, then Keymon_quit.
+ *
+ * @param config Platform description
+ * @return 0 on clean exit, 1 if init failed
+ */
+int Keymon_run(const KeymonConfig* config);
+
+#endif // __KEYMON_CORE_H__
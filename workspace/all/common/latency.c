@@ -0,0 +1,208 @@
+/**
+ * latency.c - Input-to-photon latency probe for minarch
+ */
+
+#include "latency.h"
+#include "log.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	LATENCY_OFF,
+	LATENCY_WAITING, // Button up until next_us
+	LATENCY_HELD, // Button down, core hasn't read it yet
+	LATENCY_READ, // Core read it, next rendered frame gets the marker
+	LATENCY_MARKED, // Marked frame rendered, waiting for its flip
+	LATENCY_FLIPPING, // Marked frame is being flipped
+	LATENCY_DONE,
+};
+
+static struct {
+	pthread_mutex_t mutex;
+	int state;
+	int samples; // Presses to measure
+	int count; // Presses measured
+	int misses; // Presses that timed out
+	uint32_t random; // xorshift state for the jitter
+	uint64_t next_us; // When the next press goes down
+	uint64_t times[LATENCY_STAGE_COUNT]; // Of the current press, per stage
+	uint32_t results[LATENCY_STAGE_COUNT][LATENCY_MAX_SAMPLES];
+} latency = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+static uint32_t Latency_random(void) {
+	uint32_t x = latency.random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	latency.random = x;
+	return x;
+}
+
+/**
+ * Releases the button and schedules the next press, or ends the run.
+ */
+static void Latency_next(uint64_t now_us) {
+	if (latency.count + latency.misses >= latency.samples) {
+		latency.state = LATENCY_DONE;
+		return;
+	}
+	latency.state = LATENCY_WAITING;
+	latency.next_us = now_us + LATENCY_GAP_MS * 1000 + Latency_random() % (LATENCY_JITTER_MS * 1000);
+}
+
+void Latency_start(int samples, uint64_t now_us) {
+	pthread_mutex_lock(&latency.mutex);
+	if (samples < 1)
+		samples = 1;
+	if (samples > LATENCY_MAX_SAMPLES)
+		samples = LATENCY_MAX_SAMPLES;
+	latency.samples = samples;
+	latency.count = 0;
+	latency.misses = 0;
+	latency.random = 0x9e3779b9; // Same schedule every run
+	latency.state = LATENCY_WAITING;
+	latency.next_us = now_us + LATENCY_GAP_MS * 1000;
+	pthread_mutex_unlock(&latency.mutex);
+
+	LOG_info("latency: measuring %i presses", samples);
+}
+
+int Latency_isActive(void) {
+	int state = __atomic_load_n(&latency.state, __ATOMIC_ACQUIRE);
+	return state != LATENCY_OFF && state != LATENCY_DONE;
+}
+
+int Latency_isDone(void) {
+	return __atomic_load_n(&latency.state, __ATOMIC_ACQUIRE) == LATENCY_DONE;
+}
+
+int Latency_poll(uint64_t now_us) {
+	if (!Latency_isActive())
+		return 0;
+
+	pthread_mutex_lock(&latency.mutex);
+	if (latency.state == LATENCY_WAITING && now_us >= latency.next_us) {
+		// Timed from when the press was due, like a device event that
+		// arrived between two polls
+		latency.state = LATENCY_HELD;
+	} else if (latency.state != LATENCY_WAITING &&
+	           now_us - latency.next_us > LATENCY_TIMEOUT_MS * 1000) {
+		latency.misses += 1;
+		Latency_next(now_us);
+	}
+	int held = latency.state != LATENCY_WAITING && latency.state != LATENCY_DONE;
+	pthread_mutex_unlock(&latency.mutex);
+	return held;
+}
+
+void Latency_seen(uint64_t now_us) {
+	pthread_mutex_lock(&latency.mutex);
+	if (latency.state == LATENCY_HELD) {
+		latency.times[LATENCY_SEEN] = now_us;
+		latency.state = LATENCY_READ;
+	}
+	pthread_mutex_unlock(&latency.mutex);
+}
+
+int Latency_markFrame(void) {
+	if (!Latency_isActive())
+		return 0;
+
+	pthread_mutex_lock(&latency.mutex);
+	int mark = latency.state == LATENCY_READ;
+	if (mark)
+		latency.state = LATENCY_MARKED;
+	pthread_mutex_unlock(&latency.mutex);
+	return mark;
+}
+
+void Latency_flipStart(uint64_t now_us) {
+	if (!Latency_isActive())
+		return;
+
+	pthread_mutex_lock(&latency.mutex);
+	if (latency.state == LATENCY_MARKED) {
+		latency.times[LATENCY_FLIP] = now_us;
+		latency.state = LATENCY_FLIPPING;
+	}
+	pthread_mutex_unlock(&latency.mutex);
+}
+
+void Latency_flipEnd(uint64_t now_us) {
+	if (!Latency_isActive())
+		return;
+
+	pthread_mutex_lock(&latency.mutex);
+	if (latency.state == LATENCY_FLIPPING) {
+		latency.times[LATENCY_VSYNC] = now_us;
+		for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+			uint64_t time = latency.times[i];
+			latency.results[i][latency.count] =
+			    time > latency.next_us ? (uint32_t)(time - latency.next_us) : 0;
+		}
+		latency.count += 1;
+		Latency_next(now_us);
+	}
+	pthread_mutex_unlock(&latency.mutex);
+}
+
+static int Latency_compare(const void* a, const void* b) {
+	uint32_t x = *(const uint32_t*)a;
+	uint32_t y = *(const uint32_t*)b;
+	return (x > y) - (x < y);
+}
+
+void Latency_getStats(int stage, LatencyStats* stats) {
+	static uint32_t sorted[LATENCY_MAX_SAMPLES];
+
+	memset(stats, 0, sizeof(*stats));
+	if (stage < 0 || stage >= LATENCY_STAGE_COUNT)
+		return;
+
+	pthread_mutex_lock(&latency.mutex);
+	int count = latency.count;
+	memcpy(sorted, latency.results[stage], count * sizeof(uint32_t));
+	pthread_mutex_unlock(&latency.mutex);
+	if (!count)
+		return;
+
+	qsort(sorted, count, sizeof(uint32_t), Latency_compare);
+	uint64_t total = 0;
+	for (int i = 0; i < count; i++)
+		total += sorted[i];
+
+	stats->count = count;
+	stats->min = sorted[0];
+	stats->median = sorted[count / 2];
+	stats->p95 = sorted[(count * 95) / 100];
+	stats->max = sorted[count - 1];
+	stats->mean = (uint32_t)(total / count);
+}
+
+int Latency_getMisses(void) {
+	pthread_mutex_lock(&latency.mutex);
+	int misses = latency.misses;
+	pthread_mutex_unlock(&latency.mutex);
+	return misses;
+}
+
+void Latency_report(void) {
+	static const char* names[LATENCY_STAGE_COUNT] = {"core read", "flip", "vsync"};
+
+	if (__atomic_load_n(&latency.state, __ATOMIC_ACQUIRE) == LATENCY_OFF)
+		return;
+
+	LatencyStats stats;
+	Latency_getStats(LATENCY_SEEN, &stats);
+	LOG_warn("latency: %i presses measured, %i missed", stats.count, Latency_getMisses());
+	if (!stats.count)
+		return;
+
+	for (int i = 0; i < LATENCY_STAGE_COUNT; i++) {
+		Latency_getStats(i, &stats);
+		LOG_warn("latency: %-9s min %5.1fms median %5.1fms p95 %5.1fms max %5.1fms mean %5.1fms",
+		         names[i], stats.min / 1000.0, stats.median / 1000.0, stats.p95 / 1000.0,
+		         stats.max / 1000.0, stats.mean / 1000.0);
+	}
+}
@@ -0,0 +1,127 @@
+/**
+ * latency.h - Input-to-photon latency probe for minarch
+ *
+ * Measures how long a button press takes to travel through the frontend:
+ * a synthetic press is injected into the PAD layer at a scheduled time,
+ * the core reads it through the input callbacks, the next frame it renders
+ * carries a marker, and that frame is timed as it enters PLAT_flip and as
+ * the flip (and its vsync wait) returns.
+ *
+ * Presses are spaced LATENCY_GAP_MS apart plus a pseudo-random jitter, so
+ * they land at every phase of the frame and the distribution covers the
+ * whole poll-to-flip window rather than one fixed offset.
+ *
+ * What a game does with the press (most take a frame or more to react) is
+ * outside the measurement, and so is the panel's own scanout delay.
+ *
+ * The probe is driven from two threads when minarch threads video (input
+ * on the core thread, flips on the main thread), so every call locks.
+ *
+ * This module has no SDL dependency.
+ */
+
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+#include <stdint.h>
+
+#define LATENCY_MAX_SAMPLES 1000 // Presses measured per run
+#define LATENCY_GAP_MS 250 // Minimum time between presses
+#define LATENCY_JITTER_MS 50 // Random extra time between presses
+#define LATENCY_TIMEOUT_MS 1000 // A press not shown by then counts as a miss
+
+/**
+ * Points along the path a press is timed at.
+ */
+enum {
+	LATENCY_SEEN, // Core read the press
+	LATENCY_FLIP, // Marked frame entered PLAT_flip
+	LATENCY_VSYNC, // PLAT_flip returned
+	LATENCY_STAGE_COUNT,
+};
+
+/**
+ * Distribution of one stage, in microseconds since the press.
+ */
+typedef struct LatencyStats {
+	int count;
+	uint32_t min;
+	uint32_t median;
+	uint32_t p95;
+	uint32_t max;
+	uint32_t mean;
+} LatencyStats;
+
+/**
+ * Starts a run. The first press is scheduled LATENCY_GAP_MS from now.
+ *
+ * @param samples Presses to measure (at most LATENCY_MAX_SAMPLES)
+ * @param now_us Current time in microseconds
+ */
+void Latency_start(int samples, uint64_t now_us);
+
+/**
+ * @return 1 while a run is measuring presses
+ */
+int Latency_isActive(void);
+
+/**
+ * @return 1 once every press of a run has been measured or missed
+ */
+int Latency_isDone(void);
+
+/**
+ * Advances the probe at input poll time.
+ *
+ * @param now_us Current time in microseconds
+ * @return 1 while the synthetic button should be held
+ */
+int Latency_poll(uint64_t now_us);
+
+/**
+ * Records that the core read the held button. Later reads are ignored.
+ *
+ * @param now_us Current time in microseconds
+ */
+void Latency_seen(uint64_t now_us);
+
+/**
+ * Claims the frame being rendered for the marker.
+ *
+ * @return 1 if this is the first frame since the core read the press
+ */
+int Latency_markFrame(void);
+
+/**
+ * Records that a frame is about to be flipped.
+ *
+ * @param now_us Current time in microseconds
+ */
+void Latency_flipStart(uint64_t now_us);
+
+/**
+ * Records that a flip returned. Completes the sample if the flipped frame
+ * carried the marker.
+ *
+ * @param now_us Current time in microseconds
+ */
+void Latency_flipEnd(uint64_t now_us);
+
+/**
+ * @param stage LATENCY_SEEN, LATENCY_FLIP or LATENCY_VSYNC
+ * @param stats Receives the distribution of the completed samples
+ */
+void Latency_getStats(int stage, LatencyStats* stats);
+
+/**
+ * @return Presses that timed out before a marked frame was flipped
+ */
+int Latency_getMisses(void);
+
+/**
+ * Logs the distribution of every stage at warning level, so it appears
+ * without ENABLE_INFO_LOGS. Does nothing if no run started.
+ */
+void Latency_report(void);
+
+#endif // __LATENCY_H__
@@ -4,12 +4,22 @@
  * Provides elegant, consistent logging across all LessUI components.
  */
 
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE // Required for clock_gettime(), sigaction() and localtime_r() under -std=c99
+#endif
+
 #include "log.h"
 #include "log_internal.h"
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <sys/stat.h>
 #include <time.h>
 #include <unistd.h>
@@ -20,6 +30,7 @@
 
 #define LOG_BUFFER_SIZE 2048
 #define TIMESTAMP_SIZE 16
+#define LOG_WRITER_BATCH_SIZE 16384 // Bytes gathered before each write()
 
 // Log level names for output
 static const char* LEVEL_NAMES[] = {
@@ -29,6 +40,24 @@ static const char* LEVEL_NAMES[] = {
     [LOG_LEVEL_DEBUG] = "DEBUG",
 };
 
+///////////////////////////////
+// Runtime Level
+///////////////////////////////
+
+int log_level = LOG_LEVEL_DEBUG;
+
+/**
+ * Sets the most verbose level that will be written.
+ */
+void log_set_level(LogLevel level) {
+	int value = (int)level; // enum may be unsigned
+	if (value < LOG_LEVEL_ERROR)
+		value = LOG_LEVEL_ERROR;
+	if (value > LOG_LEVEL_DEBUG)
+		value = LOG_LEVEL_DEBUG;
+	log_level = value;
+}
+
 ///////////////////////////////
 // Timestamp Formatting
 ///////////////////////////////
@@ -37,19 +66,29 @@ static const char* LEVEL_NAMES[] = {
  * Get current time as compact formatted string (HH:MM:SS).
  *
  * Uses local time for readability. Falls back to zeros if time unavailable.
+ * The formatted string is cached per thread and only rebuilt when the
+ * second changes, so most calls cost one time() call and a copy.
  */
 int log_get_timestamp(char* buf, size_t size) {
+	static __thread time_t cached_second = (time_t)-1;
+	static __thread char cached_text[TIMESTAMP_SIZE];
+
 	time_t now = time(NULL);
 	if (now == (time_t)-1) {
 		return snprintf(buf, size, "00:00:00");
 	}
 
-	struct tm* tm = localtime(&now);
-	if (!tm) {
-		return snprintf(buf, size, "00:00:00");
+	if (now != cached_second) {
+		struct tm tm;
+		if (!localtime_r(&now, &tm)) {
+			return snprintf(buf, size, "00:00:00");
+		}
+		snprintf(cached_text, sizeof(cached_text), "%02d:%02d:%02d", tm.tm_hour, tm.tm_min,
+		         tm.tm_sec);
+		cached_second = now;
 	}
 
-	return snprintf(buf, size, "%02d:%02d:%02d", tm->tm_hour, tm->tm_min, tm->tm_sec);
+	return snprintf(buf, size, "%s", cached_text);
 }
 
 ///////////////////////////////
@@ -82,6 +121,343 @@ int log_format_prefix(char* buf, size_t size, LogLevel level, const char* file,
 	}
 }
 
+/**
+ * Formats a complete log line (prefix, message and newline) into buf.
+ *
+ * @return Line length, truncated to fit buf
+ */
+static size_t log_format_line(char* buf, size_t size, LogLevel level, const char* file, int line,
+                              const char* fmt, va_list args) {
+	int length = log_format_prefix(buf, size - 1, level, file, line);
+	if (length < 0)
+		length = 0;
+	if ((size_t)length > size - 2)
+		length = (int)size - 2;
+
+	int written = vsnprintf(buf + length, size - 1 - (size_t)length, fmt, args);
+	if (written > 0)
+		length += written;
+	if ((size_t)length > size - 2)
+		length = (int)size - 2;
+
+	buf[length++] = '\n'; // auto-add newline
+	buf[length] = '\0';
+	return (size_t)length;
+}
+
+///////////////////////////////
+// Asynchronous Writer
+///////////////////////////////
+
+/**
+ * One queued line and where it goes.
+ *
+ * sequence implements a bounded multi-producer queue: a slot is free for
+ * the producer claiming position pos when sequence == pos, and holds a
+ * finished line for the writer when sequence == pos + 1.
+ */
+typedef struct LogSlot {
+	uint32_t sequence;
+	LogFile* file; // Destination file, or NULL for fd
+	int fd; // STDOUT_FILENO or STDERR_FILENO when file is NULL
+	uint32_t length;
+	char text[LOG_QUEUE_MESSAGE_SIZE];
+} LogSlot;
+
+/**
+ * Lines gathered for one destination before they're written together.
+ */
+typedef struct LogBatch {
+	LogFile* file;
+	int fd;
+	size_t length;
+	char data[LOG_WRITER_BATCH_SIZE];
+} LogBatch;
+
+static LogSlot log_queue[LOG_QUEUE_SLOTS];
+static uint32_t log_enqueue_pos; // Next position a producer will claim
+static uint32_t log_dequeue_pos; // Next position the writer will read
+static uint32_t log_written_pos; // Everything before this has been written
+static uint32_t log_dropped; // Lines dropped because the queue was full
+static int log_async_active;
+static int log_writer_sleeping;
+static int log_writer_stopping;
+static sem_t log_writer_wake;
+static pthread_t log_writer;
+static LogBatch log_batch; // Only touched by the writer thread
+
+static void log_file_append(LogFile* lf, const char* text, size_t length);
+
+/**
+ * Writes all of text to fd, retrying on short writes.
+ */
+static void log_write_fd(int fd, const char* text, size_t length) {
+	while (length > 0) {
+		ssize_t count = write(fd, text, length);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return;
+		text += count;
+		length -= (size_t)count;
+	}
+}
+
+/**
+ * Writes a finished line on the calling thread (the pre-async behavior).
+ */
+static void log_output_sync(LogFile* lf, int fd, const char* text, size_t length) {
+	if (lf) {
+		log_file_append(lf, text, length);
+		return;
+	}
+
+	FILE* stream = (fd == STDERR_FILENO) ? stderr : stdout;
+	fwrite(text, 1, length, stream);
+	fflush(stream);
+}
+
+/**
+ * Wakes the writer thread if it's waiting for work.
+ *
+ * Only the producer that clears the flag posts, so a burst of lines costs
+ * at most one sem_post().
+ */
+static void log_wake_writer(void) {
+	if (__atomic_exchange_n(&log_writer_sleeping, 0, __ATOMIC_SEQ_CST))
+		sem_post(&log_writer_wake);
+}
+
+/**
+ * Copies a finished line into the queue.
+ *
+ * @return 1 if queued, 0 if the queue is full
+ */
+static int log_enqueue(LogFile* lf, int fd, const char* text, size_t length) {
+	uint32_t pos = __atomic_load_n(&log_enqueue_pos, __ATOMIC_RELAXED);
+	LogSlot* slot;
+	for (;;) {
+		slot = &log_queue[pos % LOG_QUEUE_SLOTS];
+		uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+		int32_t diff = (int32_t)(sequence - pos);
+		if (diff == 0) {
+			if (__atomic_compare_exchange_n(&log_enqueue_pos, &pos, pos + 1, 1, __ATOMIC_RELAXED,
+			                                __ATOMIC_RELAXED))
+				break;
+		} else if (diff < 0) {
+			return 0; // writer hasn't caught up
+		} else {
+			pos = __atomic_load_n(&log_enqueue_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	slot->file = lf;
+	slot->fd = fd;
+	slot->length = (uint32_t)length;
+	memcpy(slot->text, text, length);
+	__atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_SEQ_CST);
+
+	log_wake_writer();
+	return 1;
+}
+
+/**
+ * Returns 1 if the next queued line is ready for the writer.
+ */
+static int log_queue_ready(void) {
+	const LogSlot* slot = &log_queue[log_dequeue_pos % LOG_QUEUE_SLOTS];
+	return __atomic_load_n(&slot->sequence, __ATOMIC_SEQ_CST) == log_dequeue_pos + 1;
+}
+
+/**
+ * Writes out whatever the writer has gathered.
+ */
+static void log_batch_flush(void) {
+	if (log_batch.length == 0)
+		return;
+
+	if (log_batch.file)
+		log_file_append(log_batch.file, log_batch.data, log_batch.length);
+	else
+		log_write_fd(log_batch.fd, log_batch.data, log_batch.length);
+	log_batch.length = 0;
+}
+
+/**
+ * Adds a line to the batch, writing the batch first if the line is for a
+ * different destination, doesn't fit, or would carry a file past its
+ * rotation size.
+ */
+static void log_batch_add(LogFile* lf, int fd, const char* text, size_t length) {
+	if (log_batch.length > 0) {
+		int same = lf ? log_batch.file == lf : (!log_batch.file && log_batch.fd == fd);
+		int fits = log_batch.length + length <= sizeof(log_batch.data);
+		int rotates = lf && lf->max_size > 0 &&
+		              lf->current_size + log_batch.length + length > lf->max_size;
+		if (!same || !fits || rotates)
+			log_batch_flush();
+	}
+
+	log_batch.file = lf;
+	log_batch.fd = fd;
+	memcpy(log_batch.data + log_batch.length, text, length);
+	log_batch.length += length;
+}
+
+/**
+ * Drains every ready line from the queue.
+ *
+ * @return Number of lines written
+ */
+static int log_drain(void) {
+	int count = 0;
+	while (log_queue_ready()) {
+		LogSlot* slot = &log_queue[log_dequeue_pos % LOG_QUEUE_SLOTS];
+		log_batch_add(slot->file, slot->fd, slot->text, slot->length);
+		__atomic_store_n(&slot->sequence, log_dequeue_pos + LOG_QUEUE_SLOTS, __ATOMIC_RELEASE);
+		log_dequeue_pos += 1;
+		count += 1;
+	}
+
+	uint32_t dropped = __atomic_exchange_n(&log_dropped, 0, __ATOMIC_RELAXED);
+	if (dropped > 0) {
+		char line[128];
+		int length = log_format_prefix(line, sizeof(line), LOG_LEVEL_WARN, NULL, 0);
+		length += snprintf(line + length, sizeof(line) - (size_t)length,
+		                   "%u log messages dropped (queue full)\n", dropped);
+		log_batch_add(NULL, STDERR_FILENO, line, (size_t)length);
+	}
+
+	log_batch_flush();
+	__atomic_store_n(&log_written_pos, log_dequeue_pos, __ATOMIC_RELEASE);
+	return count;
+}
+/**
+ * Writer thread: drains the queue, then sleeps until a producer wakes it.
+ */
+static void* log_writer_thread(void* arg) {
+	(void)arg;
+	for (;;) {
+		if (log_drain() > 0)
+			continue;
+		if (__atomic_load_n(&log_writer_stopping, __ATOMIC_SEQ_CST))
+			break;
+
+		// Announce the sleep before the final check so a producer either
+		// sees the flag and posts, or its line is seen here
+		__atomic_store_n(&log_writer_sleeping, 1, __ATOMIC_SEQ_CST);
+		if (log_queue_ready() || __atomic_load_n(&log_writer_stopping, __ATOMIC_SEQ_CST)) {
+			if (__atomic_exchange_n(&log_writer_sleeping, 0, __ATOMIC_SEQ_CST))
+				continue;
+			// A producer cleared the flag first and posted, consume it
+		}
+		while (sem_wait(&log_writer_wake) != 0 && errno == EINTR)
+			;
+	}
+	return NULL;
+}
+
+/**
+ * Drops back to synchronous output in a forked child, which has no writer.
+ */
+static void log_async_forked(void) {
+	log_async_active = 0;
+}
+
+/**
+ * Moves stdio and LogFile output onto the writer thread.
+ */
+int log_async_start(void) {
+	if (log_async_active)
+		return 1;
+
+	const char* level = getenv("LOG_LEVEL");
+	if (level) {
+		for (int i = LOG_LEVEL_ERROR; i <= LOG_LEVEL_DEBUG; i++) {
+			if (strcasecmp(level, LEVEL_NAMES[i]) == 0)
+				log_set_level((LogLevel)i);
+		}
+	}
+
+	for (uint32_t i = 0; i < LOG_QUEUE_SLOTS; i++)
+		log_queue[i].sequence = i;
+	log_enqueue_pos = 0;
+	log_dequeue_pos = 0;
+	log_written_pos = 0;
+	log_writer_sleeping = 0;
+	log_writer_stopping = 0;
+
+	if (sem_init(&log_writer_wake, 0, 0) != 0)
+		return 0;
+	if (pthread_create(&log_writer, NULL, log_writer_thread, NULL) != 0) {
+		sem_destroy(&log_writer_wake);
+		return 0;
+	}
+
+	// Anything already buffered by stdio goes out before queued lines
+	fflush(stdout);
+	fflush(stderr);
+
+	static int registered = 0;
+	if (!registered) {
+		atexit(log_async_stop);
+		pthread_atfork(NULL, NULL, log_async_forked);
+		registered = 1;
+	}
+
+	__atomic_store_n(&log_async_active, 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/**
+ * Blocks until every line queued so far has been written.
+ */
+void log_async_flush(void) {
+	if (!__atomic_load_n(&log_async_active, __ATOMIC_ACQUIRE))
+		return;
+
+	uint32_t target = __atomic_load_n(&log_enqueue_pos, __ATOMIC_SEQ_CST);
+	while ((int32_t)(__atomic_load_n(&log_written_pos, __ATOMIC_ACQUIRE) - target) < 0) {
+		log_wake_writer();
+		usleep(1000);
+	}
+}
+
+/**
+ * Writes out the queue, stops the writer thread and returns to writing
+ * on the calling thread.
+ */
+void log_async_stop(void) {
+	if (!__atomic_exchange_n(&log_async_active, 0, __ATOMIC_SEQ_CST))
+		return;
+
+	__atomic_store_n(&log_writer_stopping, 1, __ATOMIC_SEQ_CST);
+	log_wake_writer();
+	pthread_join(log_writer, NULL);
+	sem_destroy(&log_writer_wake);
+}
+
+/**
+ * Sends a finished line to its destination.
+ *
+ * With the writer running, lines are queued and the caller returns
+ * immediately. Errors are the exception: the queue is flushed and they're
+ * written before returning, so they survive a crash right after. Lines
+ * too long for a queue slot are also written directly.
+ */
+static void log_output(LogLevel level, LogFile* lf, int fd, const char* text, size_t length) {
+	if (__atomic_load_n(&log_async_active, __ATOMIC_ACQUIRE)) {
+		if (level == LOG_LEVEL_ERROR || length > LOG_QUEUE_MESSAGE_SIZE) {
+			log_async_flush();
+		} else {
+			if (!log_enqueue(lf, fd, text, length))
+				__atomic_add_fetch(&log_dropped, 1, __ATOMIC_RELAXED);
+			return;
+		}
+	}
+	log_output_sync(lf, fd, text, length);
+}
+
 ///////////////////////////////
 // Core Logging Functions
 ///////////////////////////////
@@ -90,25 +466,17 @@ int log_format_prefix(char* buf, size_t size, LogLevel level, const char* file,
  * Write a log message with context (file:line).
  *
  * ERROR/WARN go to stderr, INFO/DEBUG go to stdout.
- * Always flushes output for immediate visibility.
  */
 void log_write(LogLevel level, const char* file, int line, const char* fmt, ...) {
-	char prefix[256];
-	char message[LOG_BUFFER_SIZE];
+	char text[LOG_BUFFER_SIZE + 256];
 
-	// Format prefix
-	log_format_prefix(prefix, sizeof(prefix), level, file, line);
-
-	// Format message
 	va_list args;
 	va_start(args, fmt);
-	vsnprintf(message, sizeof(message), fmt, args);
+	size_t length = log_format_line(text, sizeof(text), level, file, line, fmt, args);
 	va_end(args);
 
-	// Write to appropriate stream (auto-add newline)
-	FILE* stream = (level <= LOG_LEVEL_WARN) ? stderr : stdout;
-	fprintf(stream, "%s%s\n", prefix, message);
-	fflush(stream);
+	int fd = (level <= LOG_LEVEL_WARN) ? STDERR_FILENO : STDOUT_FILENO;
+	log_output(level, NULL, fd, text, length);
 }
 
 /**
@@ -117,22 +485,15 @@ void log_write(LogLevel level, const char* file, int line, const char* fmt, ...)
  * Cleaner output for informational messages.
  */
 void log_write_simple(LogLevel level, const char* fmt, ...) {
-	char prefix[256];
-	char message[LOG_BUFFER_SIZE];
+	char text[LOG_BUFFER_SIZE + 256];
 
-	// Format prefix (no file:line)
-	log_format_prefix(prefix, sizeof(prefix), level, NULL, 0);
-
-	// Format message
 	va_list args;
 	va_start(args, fmt);
-	vsnprintf(message, sizeof(message), fmt, args);
+	size_t length = log_format_line(text, sizeof(text), level, NULL, 0, fmt, args);
 	va_end(args);
 
-	// Write to appropriate stream (auto-add newline)
-	FILE* stream = (level <= LOG_LEVEL_WARN) ? stderr : stdout;
-	fprintf(stream, "%s%s\n", prefix, message);
-	fflush(stream);
+	int fd = (level <= LOG_LEVEL_WARN) ? STDERR_FILENO : STDOUT_FILENO;
+	log_output(level, NULL, fd, text, length);
 }
 
 ///////////////////////////////
@@ -261,50 +622,47 @@ LogFile* log_file_open(const char* path, size_t max_size, int max_backups) {
 }
 
 /**
- * Write a message to a LogFile with automatic rotation.
+ * Appends text to a LogFile, rotating first if it would exceed max_size.
  *
- * Thread-safe. Checks for rotation before writing.
+ * Thread-safe.
  */
-void log_file_write(LogFile* lf, LogLevel level, const char* fmt, ...) {
-	if (!lf || !lf->fp)
-		return;
-
-	char prefix[256];
-	char message[LOG_BUFFER_SIZE];
-	char full_message[LOG_BUFFER_SIZE + 256];
-
-	// Format prefix
-	log_format_prefix(prefix, sizeof(prefix), level, NULL, 0);
-
-	// Format message
-	va_list args;
-	va_start(args, fmt);
-	vsnprintf(message, sizeof(message), fmt, args);
-	va_end(args);
-
-	// Combine prefix + message
-	snprintf(full_message, sizeof(full_message), "%s%s", prefix, message);
-	size_t msg_len = strlen(full_message);
-
-	// Lock for thread safety
+static void log_file_append(LogFile* lf, const char* text, size_t length) {
 	pthread_mutex_lock(&lf->lock);
 
 	// Check if rotation needed
 	int rotate_ok = 1;
-	if (lf->max_size > 0 && lf->current_size + msg_len > lf->max_size) {
+	if (lf->max_size > 0 && lf->current_size + length > lf->max_size) {
 		rotate_ok = (log_rotate_file(lf) != -1);
 	}
 
-	// Write message (with auto-newline)
 	if (rotate_ok && lf->fp) {
-		fprintf(lf->fp, "%s\n", full_message);
+		fwrite(text, 1, length, lf->fp);
 		fflush(lf->fp);
-		lf->current_size += msg_len + 1; // +1 for newline
+		lf->current_size += length;
 	}
 
 	pthread_mutex_unlock(&lf->lock);
 }
 
+/**
+ * Write a message to a LogFile with automatic rotation.
+ *
+ * Thread-safe. Queued for the writer thread when log_async_start() is active.
+ */
+void log_file_write(LogFile* lf, LogLevel level, const char* fmt, ...) {
+	if (!lf)
+		return; // fp is checked under the lock, the writer thread may be rotating it
+
+	char text[LOG_BUFFER_SIZE + 256];
+
+	va_list args;
+	va_start(args, fmt);
+	size_t length = log_format_line(text, sizeof(text), level, NULL, 0, fmt, args);
+	va_end(args);
+
+	log_output(level, lf, -1, text, length);
+}
+
 /**
  * Close and free a LogFile.
  */
@@ -312,6 +670,9 @@ void log_file_close(LogFile* lf) {
 	if (!lf)
 		return;
 
+	// Queued lines still point at lf
+	log_async_flush();
+
 	pthread_mutex_lock(&lf->lock);
 
 	if (lf->fp) {
@@ -324,3 +685,199 @@ void log_file_close(LogFile* lf) {
 
 	free(lf);
 }
+
+///////////////////////////////
+// Timeline Tracing
+///////////////////////////////
+
+/**
+ * One recorded event. Names are string literals, so only the pointer is kept.
+ */
+typedef struct TraceEvent {
+	const char* name;
+	uint64_t ts; // Monotonic microseconds
+	char phase; // 'B', 'E' or 'i'
+} TraceEvent;
+
+/**
+ * Ring buffer owned by one thread.
+ *
+ * Only the owning thread writes events and advances head, so recording
+ * needs no lock. Readers load head with acquire ordering and only touch
+ * events before it.
+ */
+typedef struct TraceBuffer {
+	TraceEvent events[TRACE_BUFFER_EVENTS];
+	uint32_t head; // Total events ever recorded (index = head % TRACE_BUFFER_EVENTS)
+	uint32_t flushed; // Events already written by trace_flush()
+	int tid;
+	struct TraceBuffer* next;
+} TraceBuffer;
+
+int trace_enabled = 0;
+static char trace_path[512];
+static const char* trace_process_name;
+static TraceBuffer* trace_buffers; // Lock-free list of every thread's buffer
+static int trace_thread_count;
+static __thread TraceBuffer* trace_buffer;
+
+/**
+ * Current CLOCK_MONOTONIC time in microseconds.
+ */
+static uint64_t trace_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/**
+ * Returns the calling thread's buffer, creating and registering it on first use.
+ */
+static TraceBuffer* trace_get_buffer(void) {
+	if (trace_buffer)
+		return trace_buffer;
+
+	TraceBuffer* buffer = calloc(1, sizeof(TraceBuffer));
+	if (!buffer)
+		return NULL;
+	buffer->tid = __atomic_add_fetch(&trace_thread_count, 1, __ATOMIC_RELAXED);
+
+	// Push onto the list with a CAS loop so registration never blocks
+	buffer->next = __atomic_load_n(&trace_buffers, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&trace_buffers, &buffer->next, buffer, 1,
+	                                    __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+		;
+
+	trace_buffer = buffer;
+	return buffer;
+}
+
+/**
+ * Appends a string to a buffer without overflowing it.
+ */
+static size_t trace_append(char* out, size_t pos, size_t size, const char* str) {
+	while (*str && pos < size)
+		out[pos++] = *str++;
+	return pos;
+}
+
+/**
+ * Appends an unsigned decimal number (snprintf isn't async-signal-safe).
+ */
+static size_t trace_append_u64(char* out, size_t pos, size_t size, uint64_t value) {
+	char digits[20];
+	int count = 0;
+	do {
+		digits[count++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value);
+	while (count > 0 && pos < size)
+		out[pos++] = digits[--count];
+	return pos;
+}
+
+/**
+ * Flushes on SIGUSR1 without disturbing errno.
+ */
+static void trace_signal_handler(int sig) {
+	int saved_errno = errno;
+	trace_flush();
+	errno = saved_errno;
+}
+
+/**
+ * Enables tracing for this process.
+ */
+void trace_start(const char* path, const char* process_name) {
+	if (trace_enabled || !path || strlen(path) >= sizeof(trace_path))
+		return;
+
+	strcpy(trace_path, path);
+	trace_process_name = process_name;
+	atexit(trace_flush);
+
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = trace_signal_handler;
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = SA_RESTART;
+	sigaction(SIGUSR1, &action, NULL);
+
+	trace_enabled = 1;
+}
+
+/**
+ * Records one event on the calling thread.
+ */
+void trace_event(char phase, const char* name) {
+	TraceBuffer* buffer = trace_get_buffer();
+	if (!buffer)
+		return;
+
+	uint32_t head = buffer->head;
+	TraceEvent* event = &buffer->events[head % TRACE_BUFFER_EVENTS];
+	event->name = name;
+	event->ts = trace_now();
+	event->phase = phase;
+	__atomic_store_n(&buffer->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Appends all events recorded since the last flush to the trace file.
+ */
+void trace_flush(void) {
+	if (!trace_enabled)
+		return;
+
+	int fd = open(trace_path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+	if (fd < 0)
+		return;
+
+	// Start the JSON array in a new file
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size == 0)
+		write(fd, "[\n", 2);
+
+	uint64_t pid = (uint64_t)getpid();
+	char line[256];
+	size_t pos;
+
+	// Label this process (names the pid row in the viewer)
+	if (trace_process_name) {
+		pos = trace_append(line, 0, sizeof(line), "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":");
+		pos = trace_append_u64(line, pos, sizeof(line), pid);
+		pos = trace_append(line, pos, sizeof(line), ",\"args\":{\"name\":\"");
+		pos = trace_append(line, pos, sizeof(line) - 8, trace_process_name);
+		pos = trace_append(line, pos, sizeof(line), "\"}},\n");
+		write(fd, line, pos);
+	}
+
+	TraceBuffer* buffer = __atomic_load_n(&trace_buffers, __ATOMIC_ACQUIRE);
+	for (; buffer; buffer = buffer->next) {
+		uint32_t head = __atomic_load_n(&buffer->head, __ATOMIC_ACQUIRE);
+		uint32_t start = buffer->flushed;
+		if (head - start > TRACE_BUFFER_EVENTS)
+			start = head - TRACE_BUFFER_EVENTS; // oldest events were overwritten
+
+		for (uint32_t i = start; i != head; i++) {
+			const TraceEvent* event = &buffer->events[i % TRACE_BUFFER_EVENTS];
+			pos = trace_append(line, 0, sizeof(line), "{\"name\":\"");
+			pos = trace_append(line, pos, sizeof(line) - 64, event->name);
+			pos = trace_append(line, pos, sizeof(line), "\",\"ph\":\"");
+			line[pos++] = event->phase;
+			pos = trace_append(line, pos, sizeof(line), "\",\"ts\":");
+			pos = trace_append_u64(line, pos, sizeof(line), event->ts);
+			pos = trace_append(line, pos, sizeof(line), ",\"pid\":");
+			pos = trace_append_u64(line, pos, sizeof(line), pid);
+			pos = trace_append(line, pos, sizeof(line), ",\"tid\":");
+			pos = trace_append_u64(line, pos, sizeof(line), (uint64_t)buffer->tid);
+			if (event->phase == 'i')
+				pos = trace_append(line, pos, sizeof(line), ",\"s\":\"p\"");
+			pos = trace_append(line, pos, sizeof(line), "},\n");
+			write(fd, line, pos);
+		}
+		buffer->flushed = head;
+	}
+
+	close(fd);
+}
@@ -12,7 +12,10 @@
  * - Optional file:line context for errors
  * - Thread-safe file logging with rotation
  * - Compile-time level control for zero overhead
+ * - Runtime level check that skips formatting for disabled levels
+ * - Optional writer thread so logging never blocks the caller on I/O
  * - Size-based log rotation (configurable)
+ * - Timeline tracing to Chrome trace-event JSON (TRACE_* macros)
  *
  * Usage:
  *   LOG_error("Failed to open file: %s", path);
@@ -28,9 +31,16 @@
  *   -DENABLE_DEBUG_LOGS   Enable DEBUG level (development/testing only)
  *   Without flags: Only ERROR and WARN compiled in
  *
+ * Runtime control:
+ *   log_set_level() (or LOG_LEVEL=error|warn|info|debug, read by
+ *   log_async_start()) filters further. Disabled levels cost one
+ *   comparison; arguments aren't evaluated or formatted.
+ *
  * Log output:
  *   By default, logs go to stdout/stderr. Shell scripts redirect to files.
  *   For daemons or apps needing rotation, use log_file_open() API.
+ *   Apps with frame deadlines call log_async_start() to hand writes to a
+ *   background thread.
  */
 
 #ifndef __LOG_H__
@@ -52,6 +62,27 @@ typedef enum {
 	LOG_LEVEL_DEBUG = 3, // Debug, controlled by ENABLE_DEBUG_LOGS
 } LogLevel;
 
+///////////////////////////////
+// Runtime Level
+///////////////////////////////
+
+/**
+ * Most verbose level currently written (a LogLevel).
+ *
+ * Checked by the logging macros before any formatting happens. Defaults
+ * to LOG_LEVEL_DEBUG, so every compiled-in level is written.
+ */
+extern int log_level;
+
+/**
+ * Sets the most verbose level that will be written.
+ *
+ * @param level Highest level to write (clamped to ERROR..DEBUG)
+ */
+void log_set_level(LogLevel level);
+
+#define LOG_enabled(level) ((level) <= log_level)
+
 ///////////////////////////////
 // Core Logging Functions
 ///////////////////////////////
@@ -100,7 +131,11 @@ void log_write_simple(LogLevel level, const char* fmt, ...);
  * Always compiled. Use for non-critical issues that don't prevent operation.
  * Examples: missing optional files, deprecated features, recoverable errors
  */
-#define LOG_warn(fmt, ...) log_write(LOG_LEVEL_WARN, __FILE__, __LINE__, fmt, ##__VA_ARGS__)
+#define LOG_warn(fmt, ...)                                                                         \
+	do {                                                                                           \
+		if (LOG_enabled(LOG_LEVEL_WARN))                                                           \
+			log_write(LOG_LEVEL_WARN, __FILE__, __LINE__, fmt, ##__VA_ARGS__);                     \
+	} while (0)
 
 /**
  * Log an informational message.
@@ -109,7 +144,11 @@ void log_write_simple(LogLevel level, const char* fmt, ...);
  * Examples: app startup, ROM loading, save state operations
  */
 #ifdef ENABLE_INFO_LOGS
-#define LOG_info(fmt, ...) log_write_simple(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define LOG_info(fmt, ...)                                                                         \
+	do {                                                                                           \
+		if (LOG_enabled(LOG_LEVEL_INFO))                                                           \
+			log_write_simple(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__);                                  \
+	} while (0)
 #else
 #define LOG_info(fmt, ...) ((void)0)
 #endif
@@ -121,7 +160,11 @@ void log_write_simple(LogLevel level, const char* fmt, ...);
  * Examples: loop iterations, variable values, call traces
  */
 #ifdef ENABLE_DEBUG_LOGS
-#define LOG_debug(fmt, ...) log_write_simple(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define LOG_debug(fmt, ...)                                                                        \
+	do {                                                                                           \
+		if (LOG_enabled(LOG_LEVEL_DEBUG))                                                          \
+			log_write_simple(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__);                                 \
+	} while (0)
 #else
 #define LOG_debug(fmt, ...) ((void)0)
 #endif
@@ -155,7 +198,128 @@ void log_write_simple(LogLevel level, const char* fmt, ...);
  * Same as LOG_errno() but at WARN level.
  */
 #define LOG_errno_warn(fmt, ...)                                                                   \
-	log_write(LOG_LEVEL_WARN, __FILE__, __LINE__, fmt ": %s", ##__VA_ARGS__, strerror(errno))
+	do {                                                                                           \
+		if (LOG_enabled(LOG_LEVEL_WARN))                                                           \
+			log_write(LOG_LEVEL_WARN, __FILE__, __LINE__, fmt ": %s", ##__VA_ARGS__,               \
+			          strerror(errno));                                                            \
+	} while (0)
+
+///////////////////////////////
+// Asynchronous Output
+///////////////////////////////
+
+/**
+ * Background writer for stdio and LogFile output.
+ *
+ * Once started, each log call formats its line into a slot of a bounded
+ * lock-free queue and returns. A writer thread drains the queue, joining
+ * consecutive lines for the same destination into one write(). When the
+ * queue is full, lines are dropped and a count is logged once there's
+ * room again, so a burst of logging never stalls a frame.
+ *
+ * ERROR lines bypass the queue: it's flushed and they're written before
+ * the call returns, so the lines leading up to a crash reach the log.
+ */
+
+#define LOG_QUEUE_SLOTS 256 // Lines that can be pending at once
+#define LOG_QUEUE_MESSAGE_SIZE 512 // Longer lines are written synchronously
+
+/**
+ * Starts the writer thread.
+ *
+ * Also applies the LOG_LEVEL environment variable (error, warn, info or
+ * debug) if set. The queue is flushed at exit. Forked children fall back to
+ * synchronous output.
+ *
+ * @return 1 if running, 0 if the thread couldn't be started
+ */
+int log_async_start(void);
+
+/**
+ * Blocks until every line queued so far has been written.
+ */
+void log_async_flush(void);
+
+/**
+ * Flushes the queue and stops the writer thread.
+ *
+ * Call once other threads have stopped logging.
+ */
+void log_async_stop(void);
+
+///////////////////////////////
+// Timeline Tracing
+///////////////////////////////
+
+/**
+ * Lightweight span tracing for boot and launch timing.
+ *
+ * Records begin/end/instant events with monotonic microsecond timestamps
+ * into a per-thread ring buffer (no locks on the recording path) and writes
+ * them out as Chrome trace-event JSON, viewable in chrome://tracing or
+ * ui.perfetto.dev.
+ *
+ * Every process appends to the same file, and CLOCK_MONOTONIC is shared
+ * system-wide, so minui's launch and minarch's startup line up on one
+ * timeline. The closing ] is never written, which the trace format allows.
+ *
+ * Tracing is off until trace_start() is called; until then each TRACE_*
+ * macro costs one branch.
+ *
+ * Usage:
+ *   TRACE_begin("GFX_init");
+ *   screen = GFX_init(MODE_MAIN);
+ *   TRACE_end("GFX_init");
+ *   TRACE_instant("first_frame");
+ *
+ * Names must be string literals (only the pointer is recorded).
+ */
+
+#define TRACE_BUFFER_EVENTS 1024 // Events kept per thread (oldest are overwritten)
+
+extern int trace_enabled;
+
+/**
+ * Enables tracing for this process.
+ *
+ * Events are appended to path at exit and whenever the process receives
+ * SIGUSR1.
+ *
+ * @param path Trace file to append to
+ * @param process_name Label for this process in the viewer (string literal)
+ */
+void trace_start(const char* path, const char* process_name);
+
+/**
+ * Records one event on the calling thread.
+ *
+ * @param phase 'B' (begin), 'E' (end) or 'i' (instant)
+ * @param name Event name (string literal)
+ */
+void trace_event(char phase, const char* name);
+
+/**
+ * Appends all events recorded since the last flush to the trace file.
+ *
+ * Async-signal-safe, so it can run from a signal handler.
+ */
+void trace_flush(void);
+
+#define TRACE_begin(name)                                                                          \
+	do {                                                                                           \
+		if (trace_enabled)                                                                         \
+			trace_event('B', name);                                                                \
+	} while (0)
+#define TRACE_end(name)                                                                            \
+	do {                                                                                           \
+		if (trace_enabled)                                                                         \
+			trace_event('E', name);                                                                \
+	} while (0)
+#define TRACE_instant(name)                                                                        \
+	do {                                                                                           \
+		if (trace_enabled)                                                                         \
+			trace_event('i', name);                                                                \
+	} while (0)
 
 ///////////////////////////////
 // File Logging API (Optional)
@@ -0,0 +1,206 @@
+/**
+ * movie.c - Input movie recording and playback for minarch
+ */
+
+#include "movie.h"
+#include "log.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static struct {
+	// Recording
+	FILE* file;
+	MovieHeader header;
+	MovieRun run; // Current run, not written yet
+
+	// Playback
+	int playing;
+	void* state;
+	size_t state_size;
+	MovieRun* runs;
+	uint32_t run_count;
+	uint32_t run_index;
+	uint32_t run_played; // Polls played from the current run
+	uint32_t frame_count;
+
+	uint32_t frame; // Polls recorded or played
+} movie;
+
+static void Movie_writeRun(void) {
+	if (!movie.run.count)
+		return;
+
+	// Flushed so a crash loses at most the run in progress
+	if (fwrite(&movie.run, sizeof(movie.run), 1, movie.file) != 1 || fflush(movie.file) != 0)
+		LOG_error("movie: unable to write input (%s)", strerror(errno));
+	movie.run.count = 0;
+}
+
+int Movie_startRecording(const char* path, const void* state, size_t state_size) {
+	Movie_stop();
+
+	movie.file = fopen(path, "wb");
+	if (!movie.file) {
+		LOG_error("movie: unable to create %s (%s)", path, strerror(errno));
+		return -1;
+	}
+
+	movie.header = (MovieHeader){
+	    .magic = MOVIE_MAGIC,
+	    .version = MOVIE_VERSION,
+	    .frames = 0,
+	    .state_size = state ? state_size : 0,
+	};
+	if (fwrite(&movie.header, sizeof(movie.header), 1, movie.file) != 1 ||
+	    (movie.header.state_size &&
+	     fwrite(state, movie.header.state_size, 1, movie.file) != 1)) {
+		LOG_error("movie: unable to write %s (%s)", path, strerror(errno));
+		fclose(movie.file);
+		movie.file = NULL;
+		return -1;
+	}
+
+	movie.run.count = 0;
+	movie.frame = 0;
+	LOG_info("movie: recording to %s", path);
+	return 0;
+}
+
+void Movie_recordFrame(const MovieInput* input) {
+	if (!movie.file)
+		return;
+
+	if (movie.run.count && movie.run.count < UINT32_MAX &&
+	    !memcmp(&movie.run.input, input, sizeof(*input))) {
+		movie.run.count += 1;
+	} else {
+		Movie_writeRun();
+		movie.run.count = 1;
+		movie.run.input = *input;
+	}
+	movie.frame += 1;
+}
+
+int Movie_startPlayback(const char* path) {
+	Movie_stop();
+
+	FILE* file = fopen(path, "rb");
+	if (!file) {
+		LOG_error("movie: unable to open %s (%s)", path, strerror(errno));
+		return -1;
+	}
+
+	MovieHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != MOVIE_MAGIC ||
+	    header.version != MOVIE_VERSION) {
+		LOG_error("movie: %s is not a movie", path);
+		goto error;
+	}
+
+	if (fseek(file, 0, SEEK_END) != 0)
+		goto error;
+	long end = ftell(file);
+	long runs_size = end - (long)sizeof(header) - (long)header.state_size;
+	if (runs_size < 0) {
+		LOG_error("movie: %s is truncated", path);
+		goto error;
+	}
+	fseek(file, sizeof(header), SEEK_SET);
+
+	if (header.state_size) {
+		movie.state = malloc(header.state_size);
+		if (!movie.state || fread(movie.state, header.state_size, 1, file) != 1)
+			goto error;
+		movie.state_size = header.state_size;
+	}
+
+	movie.run_count = runs_size / sizeof(MovieRun); // A partly written run is dropped
+	if (movie.run_count) {
+		movie.runs = malloc(movie.run_count * sizeof(MovieRun));
+		if (!movie.runs || fread(movie.runs, sizeof(MovieRun), movie.run_count, file) !=
+		                       movie.run_count)
+			goto error;
+	}
+	fclose(file);
+
+	movie.frame_count = 0;
+	for (uint32_t i = 0; i < movie.run_count; i++)
+		movie.frame_count += movie.runs[i].count;
+	movie.run_index = 0;
+	movie.run_played = 0;
+	movie.frame = 0;
+	movie.playing = 1;
+
+	LOG_info("movie: playing %s (%u frames)", path, movie.frame_count);
+	return 0;
+
+error:
+	fclose(file);
+	Movie_stop();
+	return -1;
+}
+
+const void* Movie_getState(size_t* size) {
+	*size = movie.state_size;
+	return movie.state;
+}
+
+int Movie_playFrame(MovieInput* input) {
+	if (!movie.playing)
+		return 0;
+
+	while (movie.run_index < movie.run_count &&
+	       movie.run_played >= movie.runs[movie.run_index].count) {
+		movie.run_index += 1;
+		movie.run_played = 0;
+	}
+	if (movie.run_index >= movie.run_count)
+		return 0;
+
+	*input = movie.runs[movie.run_index].input;
+	movie.run_played += 1;
+	movie.frame += 1;
+	return 1;
+}
+
+void Movie_stop(void) {
+	if (movie.file) {
+		Movie_writeRun();
+
+		// Fill in the frame count now that it's known
+		movie.header.frames = movie.frame;
+		if (fseek(movie.file, 0, SEEK_SET) != 0 ||
+		    fwrite(&movie.header, sizeof(movie.header), 1, movie.file) != 1)
+			LOG_error("movie: unable to finish recording (%s)", strerror(errno));
+		fclose(movie.file);
+		movie.file = NULL;
+		LOG_info("movie: recorded %u frames", movie.frame);
+	}
+
+	free(movie.state);
+	free(movie.runs);
+	movie.state = NULL;
+	movie.state_size = 0;
+	movie.runs = NULL;
+	movie.run_count = 0;
+	movie.frame_count = 0;
+	movie.playing = 0;
+}
+
+int Movie_isRecording(void) {
+	return movie.file != NULL;
+}
+
+int Movie_isPlaying(void) {
+	return movie.playing;
+}
+
+uint32_t Movie_getFrame(void) {
+	return movie.frame;
+}
+
+uint32_t Movie_getFrameCount(void) {
+	return movie.frame_count;
+}
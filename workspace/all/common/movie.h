@@ -0,0 +1,122 @@
+/**
+ * movie.h - Input movie recording and playback for minarch
+ *
+ * A movie is the input a core saw, one entry per input poll, starting from
+ * a save state. Played back from that state it reproduces the same frames,
+ * which makes a recorded session usable both as a replay and as a fixed
+ * workload for comparing cores, settings and builds.
+ *
+ * File layout (native byte order, all supported devices are little endian):
+ *
+ *   MovieHeader
+ *   state_size bytes of save state (none if the core can't save states)
+ *   MovieRun records until the end of the file
+ *
+ * Consecutive polls with identical input are stored as one run, so held
+ * buttons and idle sticks cost one record however long they last. Runs are
+ * written as they end, so a movie cut short by a crash still plays up to
+ * the last run that reached the file.
+ *
+ * This module has no SDL dependency.
+ */
+
+#ifndef __MOVIE_H__
+#define __MOVIE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MOVIE_MAGIC 0x564f4d4c // "LMOV"
+#define MOVIE_VERSION 1
+
+/**
+ * Input the core sees during one poll.
+ */
+typedef struct MovieInput {
+	uint32_t buttons; // RETRO_DEVICE_ID_JOYPAD_* bits
+	int16_t axes[4]; // Left x, left y, right x, right y
+} MovieInput;
+
+/**
+ * Start of a movie file.
+ */
+typedef struct MovieHeader {
+	uint32_t magic; // MOVIE_MAGIC
+	uint32_t version; // MOVIE_VERSION
+	uint32_t frames; // Polls recorded, 0 if the recording wasn't stopped cleanly
+	uint32_t state_size; // Bytes of save state following the header
+} MovieHeader;
+
+/**
+ * The same input repeated over consecutive polls.
+ */
+typedef struct MovieRun {
+	uint32_t count;
+	MovieInput input;
+} MovieRun;
+
+/**
+ * Starts recording to a file, replacing it.
+ *
+ * @param path Movie file path
+ * @param state Save state the recording starts from, NULL if none
+ * @param state_size Size of the state in bytes
+ * @return 0 on success, -1 if the file couldn't be written
+ */
+int Movie_startRecording(const char* path, const void* state, size_t state_size);
+
+/**
+ * Appends one poll's input to the recording.
+ */
+void Movie_recordFrame(const MovieInput* input);
+
+/**
+ * Loads a movie for playback.
+ *
+ * @param path Movie file path
+ * @return 0 on success, -1 if the file is missing or not a movie
+ */
+int Movie_startPlayback(const char* path);
+
+/**
+ * Gets the save state the loaded movie starts from.
+ *
+ * @param size Receives the state size in bytes
+ * @return State data, NULL if the movie has none
+ */
+const void* Movie_getState(size_t* size);
+
+/**
+ * Takes the next poll's input from the movie.
+ *
+ * @param input Receives the input
+ * @return 1 if there was input, 0 once the movie has ended
+ */
+int Movie_playFrame(MovieInput* input);
+
+/**
+ * Ends recording or playback. A recording is finalized on disk.
+ */
+void Movie_stop(void);
+
+/**
+ * @return 1 while recording
+ */
+int Movie_isRecording(void);
+
+/**
+ * @return 1 while a movie is loaded for playback
+ */
+int Movie_isPlaying(void);
+
+/**
+ * @return Polls recorded or played so far
+ */
+uint32_t Movie_getFrame(void);
+
+/**
+ * @return Polls in the loaded movie, 0 while not playing
+ */
+uint32_t Movie_getFrameCount(void);
+
+#endif // __MOVIE_H__
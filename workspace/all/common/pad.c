@@ -76,6 +76,33 @@ void PAD_setAnalog(int neg_id, int pos_id, int value, int repeat_at) {
 	}
 }
 
+/**
+ * Presses or releases a single button.
+ *
+ * Does the same bookkeeping as a platform handling a button event, so
+ * input that doesn't come from a device (like the latency probe) looks
+ * like a real press to everything reading the pad.
+ *
+ * @param id Button ID (e.g., BTN_ID_SELECT)
+ * @param pressed 1 to press, 0 to release
+ * @param repeat_at Timestamp when button should start repeating
+ */
+void PAD_setButton(int id, int pressed, uint32_t repeat_at) {
+	int btn = 1 << id;
+	if (pressed) {
+		if (!(pad.is_pressed & btn)) { // not pressing
+			pad.is_pressed |= btn; // set
+			pad.just_pressed |= btn; // set
+			pad.just_repeated |= btn; // set
+			pad.repeat_at[id] = repeat_at;
+		}
+	} else if (pad.is_pressed & btn) { // was pressing
+		pad.is_pressed &= ~btn; // unset
+		pad.just_repeated &= ~btn; // unset
+		pad.just_released |= btn; // set
+	}
+}
+
 /**
  * Resets all button states to unpressed.
  *
@@ -67,6 +67,17 @@ extern PAD_Context pad;
  */
 void PAD_setAnalog(int neg_id, int pos_id, int value, int repeat_at);
 
+/**
+ * Presses or releases a single button.
+ *
+ * Does the same bookkeeping as a platform handling a button event.
+ *
+ * @param id Button ID (e.g., BTN_ID_SELECT)
+ * @param pressed 1 to press, 0 to release
+ * @param repeat_at Timestamp when button should start repeating
+ */
+void PAD_setButton(int id, int pressed, uint32_t repeat_at);
+
 /**
  * Resets all button states to unpressed.
  *
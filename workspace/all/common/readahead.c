@@ -0,0 +1,141 @@
+/**
+ * readahead.c - Page cache warming for ROMs and cores
+ */
+
+#include "readahead.h"
+#include <ctype.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t Readahead_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Reads the start of a file into the page cache, one chunk at a time.
+ */
+int64_t Readahead_file(const char* path, int64_t max_bytes, Readahead_CancelFunc cancelled,
+                       void* userdata) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -1;
+
+	struct stat st;
+	char* buffer = NULL;
+	if (fstat(fd, &st) != 0 || !(buffer = malloc(READAHEAD_CHUNK_SIZE))) {
+		close(fd);
+		return -1;
+	}
+
+	int64_t size = st.st_size < max_bytes ? st.st_size : max_bytes;
+	int64_t offset = 0;
+	while (offset < size) {
+		if (cancelled && cancelled(userdata))
+			break;
+
+		int64_t length = size - offset;
+		if (length > READAHEAD_CHUNK_SIZE)
+			length = READAHEAD_CHUNK_SIZE;
+
+		// Blocks until the card has delivered the chunk, so the pause
+		// below is measured against the I/O this chunk really caused
+		uint64_t start = Readahead_now();
+		ssize_t got = pread(fd, buffer, (size_t)length, (off_t)offset);
+		if (got <= 0)
+			break;
+		offset += got;
+
+		if (offset < size)
+			usleep((useconds_t)((Readahead_now() - start) * READAHEAD_IDLE_RATIO));
+	}
+
+	free(buffer);
+	close(fd);
+	return offset;
+}
+
+/**
+ * Reads the core name from an emulator pak's launch.sh.
+ */
+int Readahead_getEmuExe(const char* launch_path, char* out, size_t out_size) {
+	FILE* file = fopen(launch_path, "r");
+	if (!file)
+		return 0;
+
+	int found = 0;
+	char line[256];
+	while (!found && fgets(line, sizeof(line), file)) {
+		if (strncmp(line, "EMU_EXE=", 8) != 0)
+			continue;
+
+		char* value = line + 8;
+		size_t len = strcspn(value, " \t\r\n#");
+		if (len > 0 && len < out_size) {
+			memcpy(out, value, len);
+			out[len] = '\0';
+			found = 1;
+		}
+	}
+
+	fclose(file);
+	return found;
+}
+
+/**
+ * Lists the data files referenced by a cue sheet.
+ */
+int Readahead_getCueFiles(const char* cue_path, char files[][READAHEAD_PATH_MAX], int max) {
+	FILE* file = fopen(cue_path, "r");
+	if (!file)
+		return 0;
+
+	// Directory prefix, including the trailing slash
+	const char* slash = strrchr(cue_path, '/');
+	int dir_len = slash ? (int)(slash - cue_path + 1) : 0;
+
+	int count = 0;
+	char line[READAHEAD_PATH_MAX];
+	while (count < max && fgets(line, sizeof(line), file)) {
+		char* tmp = line;
+		while (isspace((unsigned char)*tmp))
+			tmp++;
+		if (strncasecmp(tmp, "FILE", 4) != 0 || !isspace((unsigned char)tmp[4]))
+			continue;
+		tmp += 5;
+		while (isspace((unsigned char)*tmp))
+			tmp++;
+
+		// Name is either quoted or runs to the next space
+		char* name = tmp;
+		char* end;
+		if (*name == '"') {
+			name += 1;
+			end = strchr(name, '"');
+		} else {
+			end = name + strcspn(name, " \t\r\n");
+		}
+		if (!end || end == name)
+			continue;
+		*end = '\0';
+
+		int written;
+		if (name[0] == '/')
+			written = snprintf(files[count], READAHEAD_PATH_MAX, "%s", name);
+		else
+			written = snprintf(files[count], READAHEAD_PATH_MAX, "%.*s%s", dir_len, cue_path,
+			                   name);
+		if (written > 0 && written < READAHEAD_PATH_MAX)
+			count += 1;
+	}
+
+	fclose(file);
+	return count;
+}
@@ -0,0 +1,77 @@
+/**
+ * readahead.h - Page cache warming for ROMs and cores
+ *
+ * Launching a game means the launcher exits, the shell starts minarch, and
+ * minarch dlopen()s the core and reads the ROM, all from a cold SD card.
+ * While the user is still looking at a selection, the launcher can ask the
+ * kernel to start pulling those files into the page cache so the launch
+ * finds them warm.
+ *
+ * Files are read in small chunks, each followed by a pause proportional to
+ * how long the card took to deliver it, so readahead leaves the card idle
+ * most of the time while the user is scrolling. Chunks already cached
+ * read quickly and cost almost no pause. A cancel callback is checked
+ * before every chunk so a new selection stops the previous one immediately.
+ *
+ * Also provides the small parsers needed to work out which files a launch
+ * will touch (the core named in an emulator pak, the tracks of a cue sheet).
+ *
+ * This module has no SDL dependency.
+ */
+
+#ifndef __READAHEAD_H__
+#define __READAHEAD_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define READAHEAD_PATH_MAX 512 // Matches MAX_PATH in defines.h
+#define READAHEAD_CHUNK_SIZE (512 * 1024) // Bytes read per step
+#define READAHEAD_IDLE_RATIO 2 // Pause after each step, as a multiple of its read time
+
+/**
+ * Returns nonzero when the current readahead should stop.
+ */
+typedef int (*Readahead_CancelFunc)(void* userdata);
+
+/**
+ * Reads the start of a file into the page cache, one chunk at a time.
+ *
+ * Uses blocking pread() into a scratch buffer rather than an asynchronous
+ * hint, so each chunk's pause can be paced against the I/O it caused.
+ *
+ * @param path File to warm
+ * @param max_bytes Maximum number of bytes to read from the start of the file
+ * @param cancelled Checked before every chunk, may be NULL
+ * @param userdata Passed to cancelled
+ * @return Bytes read (may be short if cancelled), or -1 if the file couldn't be opened
+ */
+int64_t Readahead_file(const char* path, int64_t max_bytes, Readahead_CancelFunc cancelled,
+                       void* userdata);
+
+/**
+ * Reads the core name from an emulator pak's launch.sh.
+ *
+ * Emulator paks are generated from a template that starts with a line like
+ * EMU_EXE=gambatte, and launch "$CORES_PATH/${EMU_EXE}_libretro.so".
+ *
+ * @param launch_path Path to the pak's launch.sh
+ * @param out Output buffer for the core name
+ * @param out_size Size of output buffer
+ * @return 1 if a core name was found, 0 otherwise
+ */
+int Readahead_getEmuExe(const char* launch_path, char* out, size_t out_size);
+
+/**
+ * Lists the data files referenced by a cue sheet.
+ *
+ * Relative FILE entries are resolved against the cue sheet's directory.
+ *
+ * @param cue_path Path to the .cue file
+ * @param files Output array of paths
+ * @param max Capacity of files
+ * @return Number of files written
+ */
+int Readahead_getCueFiles(const char* cue_path, char files[][READAHEAD_PATH_MAX], int max);
+
+#endif // __READAHEAD_H__
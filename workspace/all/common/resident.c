@@ -0,0 +1,211 @@
+/**
+ * resident.c - Launch protocol for the resident minarch host
+ *
+ * Requests are sent as one fixed-size struct with the client's stdio
+ * descriptors attached as SCM_RIGHTS ancillary data. Replies are a pair
+ * of int32s.
+ */
+
+#include "resident.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * Fills in a Unix socket address.
+ *
+ * @return 1 on success, 0 if path doesn't fit
+ */
+static int Resident_address(const char* path, struct sockaddr_un* addr) {
+	memset(addr, 0, sizeof(*addr));
+	addr->sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(addr->sun_path))
+		return 0;
+	strcpy(addr->sun_path, path);
+	return 1;
+}
+
+/**
+ * Reads exactly size bytes, retrying on short reads.
+ */
+static int Resident_readAll(int fd, void* buffer, size_t size) {
+	char* dst = buffer;
+	while (size > 0) {
+		ssize_t count = read(fd, dst, size);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return 0;
+		dst += count;
+		size -= (size_t)count;
+	}
+	return 1;
+}
+
+/**
+ * Writes exactly size bytes, retrying on short writes.
+ */
+static int Resident_writeAll(int fd, const void* buffer, size_t size) {
+	const char* src = buffer;
+	while (size > 0) {
+		ssize_t count = write(fd, src, size);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return 0;
+		src += count;
+		size -= (size_t)count;
+	}
+	return 1;
+}
+
+/**
+ * Creates the host's listening socket, replacing any stale one.
+ */
+int Resident_listen(const char* path) {
+	struct sockaddr_un addr;
+	if (!Resident_address(path, &addr))
+		return -1;
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		LOG_errno("Failed to create resident socket");
+		return -1;
+	}
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+	unlink(path);
+	if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0) {
+		LOG_errno("Failed to listen on %s", path);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * Connects to a running host.
+ */
+int Resident_connect(const char* path) {
+	struct sockaddr_un addr;
+	if (!Resident_address(path, &addr))
+		return -1;
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -1;
+	fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+	if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * Sends a launch request, passing request->fds to the host.
+ */
+int Resident_sendRequest(int fd, const ResidentRequest* request) {
+	union {
+		char buffer[CMSG_SPACE(sizeof(request->fds))];
+		struct cmsghdr align;
+	} control;
+	memset(&control, 0, sizeof(control));
+
+	struct iovec iov = {.iov_base = (void*)request, .iov_len = sizeof(*request)};
+	struct msghdr msg = {0};
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buffer;
+	msg.msg_controllen = sizeof(control.buffer);
+
+	struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(request->fds));
+	memcpy(CMSG_DATA(cmsg), request->fds, sizeof(request->fds));
+
+	ssize_t sent;
+	do {
+		sent = sendmsg(fd, &msg, 0);
+	} while (sent < 0 && errno == EINTR);
+	if (sent <= 0)
+		return 0;
+
+	// Descriptors went with the first byte, the rest is plain data
+	return Resident_writeAll(fd, (const char*)request + sent, sizeof(*request) - (size_t)sent);
+}
+
+/**
+ * Receives a launch request.
+ */
+int Resident_recvRequest(int fd, ResidentRequest* request) {
+	union {
+		char buffer[CMSG_SPACE(sizeof(request->fds))];
+		struct cmsghdr align;
+	} control;
+	memset(&control, 0, sizeof(control));
+
+	struct iovec iov = {.iov_base = request, .iov_len = sizeof(*request)};
+	struct msghdr msg = {0};
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buffer;
+	msg.msg_controllen = sizeof(control.buffer);
+
+	ssize_t received;
+	do {
+		received = recvmsg(fd, &msg, 0);
+	} while (received < 0 && errno == EINTR);
+
+	int fds[3] = {-1, -1, -1};
+	struct cmsghdr* cmsg = received > 0 ? CMSG_FIRSTHDR(&msg) : NULL;
+	if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+	    cmsg->cmsg_len == CMSG_LEN(sizeof(fds)))
+		memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+
+	int ok = received > 0 && Resident_readAll(fd, (char*)request + received,
+	                                          sizeof(*request) - (size_t)received);
+	memcpy(request->fds, fds, sizeof(fds));
+
+	// Never trust the peer to have terminated the strings
+	request->core_path[RESIDENT_PATH_MAX - 1] = '\0';
+	request->rom_path[RESIDENT_PATH_MAX - 1] = '\0';
+	request->cwd[RESIDENT_PATH_MAX - 1] = '\0';
+
+	if (!ok) {
+		for (int i = 0; i < 3; i++) {
+			if (fds[i] >= 0)
+				close(fds[i]);
+			request->fds[i] = -1;
+		}
+	}
+	return ok;
+}
+
+/**
+ * Sends a reply to the client.
+ */
+int Resident_sendReply(int fd, int32_t type, int32_t value) {
+	int32_t reply[2] = {type, value};
+	return Resident_writeAll(fd, reply, sizeof(reply));
+}
+
+/**
+ * Waits for the next reply from the host.
+ */
+int Resident_recvReply(int fd, int32_t* type, int32_t* value) {
+	int32_t reply[2];
+	if (!Resident_readAll(fd, reply, sizeof(reply)))
+		return 0;
+	*type = reply[0];
+	*value = reply[1];
+	return 1;
+}
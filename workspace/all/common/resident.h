@@ -0,0 +1,109 @@
+/**
+ * resident.h - Launch protocol for the resident minarch host
+ *
+ * In resident mode a long-lived minarch host keeps recently used cores
+ * dlopen()ed and forks a fresh child for every game. The minarch.elf that
+ * an emulator pak's launch.sh starts becomes a thin client: it connects to
+ * the host over a Unix socket, sends the core and ROM along with its own
+ * stdin/stdout/stderr (so logs still land where launch.sh redirected them),
+ * and waits for the game to finish.
+ *
+ * The host replies twice: RESIDENT_REPLY_STARTED once the child is running,
+ * then RESIDENT_REPLY_EXITED with its wait status. The child holds the
+ * connection open too, so a client only sees EOF before EXITED if something
+ * went wrong. EOF before STARTED means nothing was launched and the client
+ * can safely run the game itself.
+ *
+ * Only loaded cores outlive a game. Video, audio and input are set up
+ * again in every child, and the client process is still started per launch.
+ * The child times its first frame from launch_us, so the log shows what a
+ * resident launch actually saves over a direct one.
+ *
+ * This module has no SDL dependency.
+ */
+
+#ifndef __RESIDENT_H__
+#define __RESIDENT_H__
+
+#include <stdint.h>
+
+#define RESIDENT_PATH_MAX 512 // Matches MAX_PATH in defines.h
+
+/**
+ * A launch request from client to host.
+ */
+typedef struct ResidentRequest {
+	char core_path[RESIDENT_PATH_MAX]; // Core .so to load
+	char rom_path[RESIDENT_PATH_MAX]; // ROM to play
+	char cwd[RESIDENT_PATH_MAX]; // Working directory launch.sh set up
+	int32_t priority; // Nice value launch.sh ran the client with
+	uint64_t launch_us; // When the client started, from getMicroseconds()
+	int fds[3]; // stdin, stdout, stderr (sent as SCM_RIGHTS, -1 if not received)
+} ResidentRequest;
+
+/**
+ * Host to client messages.
+ */
+enum {
+	RESIDENT_REPLY_STARTED = 1, // value: child pid
+	RESIDENT_REPLY_EXITED = 2, // value: wait status from waitpid()
+};
+
+/**
+ * Creates the host's listening socket, replacing any stale one.
+ *
+ * @param path Socket path
+ * @return Listening descriptor, or -1 on failure
+ */
+int Resident_listen(const char* path);
+
+/**
+ * Connects to a running host.
+ *
+ * @param path Socket path
+ * @return Connected descriptor, or -1 if no host is listening
+ */
+int Resident_connect(const char* path);
+
+/**
+ * Sends a launch request, passing request->fds to the host.
+ *
+ * @param fd Connected descriptor
+ * @param request Request to send
+ * @return 1 on success, 0 on failure
+ */
+int Resident_sendRequest(int fd, const ResidentRequest* request);
+
+/**
+ * Receives a launch request.
+ *
+ * On success request->fds holds the client's descriptors, which the
+ * caller owns and must close.
+ *
+ * @param fd Accepted descriptor
+ * @param request Output request
+ * @return 1 on success, 0 on failure or EOF
+ */
+int Resident_recvRequest(int fd, ResidentRequest* request);
+
+/**
+ * Sends a reply to the client.
+ *
+ * @param fd Connected descriptor
+ * @param type RESIDENT_REPLY_* value
+ * @param value Reply payload
+ * @return 1 on success, 0 on failure
+ */
+int Resident_sendReply(int fd, int32_t type, int32_t value);
+
+/**
+ * Waits for the next reply from the host.
+ *
+ * @param fd Connected descriptor
+ * @param type Output RESIDENT_REPLY_* value
+ * @param value Output payload
+ * @return 1 on success, 0 on failure or EOF
+ */
+int Resident_recvReply(int fd, int32_t* type, int32_t* value);
+
+#endif // __RESIDENT_H__
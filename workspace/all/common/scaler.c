@@ -6,22 +6,22 @@
  * (e.g., 160x144 Game Boy) to higher-resolution device screens (e.g., 640x480).
  *
  * The scaler supports:
- * - Multiple scaling factors (1x through 6x)
+ * - Every integer scaling factor from 1x to 12x on each axis
  * - Both 16-bit (RGB565) and 32-bit (RGBA8888) pixel formats
  * - Format conversion (16-bit source to 32-bit destination)
  * - ARM NEON hardware acceleration with C fallbacks
  * - Non-uniform Y-axis scaling (e.g., 2x horizontal, 3x vertical)
  *
  * Platform Support:
- * - NEON versions (_n16/_n32): ARMv7 devices with NEON SIMD (most handhelds)
- * - C versions (_c16/_c32): Fallback for non-ARM or unaligned buffers
+ * - NEON versions (_n16/_n32): ARM devices with NEON SIMD (most handhelds)
+ * - C versions (_c16/_c32): Portable vector fallback for everything else
  * - Conversion versions (c16to32): Trimui Model S and GKD Pixel
  *
  * Performance: NEON implementations are 2-4x faster than C on supported hardware.
  *
  * Function naming convention: scale{X}x{Y}_{type}{bpp}
- * - X: horizontal scale factor (1-6)
- * - Y: vertical scale factor (1-6, or omitted for variable)
+ * - X: horizontal scale factor (1-12)
+ * - Y: vertical scale factor (1-12, or omitted for variable)
  * - type: 'n' (NEON), 'c' (C), or omitted
  * - bpp: '16' (RGB565), '32' (RGBA8888), or '16to32' (conversion)
  *
@@ -35,24 +35,21 @@
  * @param dh Destination height in pixels (often unused, for API compatibility)
  * @param dp Destination pitch (stride) in bytes, or 0 for auto-calculated
  *
- * @note NEON scalers require 32-bit aligned addresses and even pixel counts
- *       for 16bpp. Unaligned inputs automatically fall back to C scalers.
  * @warning Source and destination buffers must not overlap
  */
 
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "defines.h" // for HAS_NEON, FIXED_BPP, MIN
 #include "log.h"
 #include "scaler.h" // for function declarations and ROTATION_ constants
 
-/**
- * No-op scaler function (unused placeholder).
- */
-static void dummy(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {}
+#ifdef HAS_NEON
+#include <arm_neon.h>
+#endif
 
 ///////////////////////////////
 // Format Conversion Scalers (RGB565 to RGBA8888)
@@ -168,747 +165,82 @@ void scale2x_c16to32(void* __restrict src, void* __restrict dst, uint32_t sw, ui
 }
 
 ///////////////////////////////
-// Generic C Scalers (RGB565 and RGBA8888)
+// Integer Scalers (RGB565 and RGBA8888)
 ///////////////////////////////
 
-/**
- * Generic 1x horizontal scale with variable vertical scaling (16-bit C version).
- *
- * Implements point sampling (nearest-neighbor) scaling with no horizontal scaling
- * and configurable vertical duplication. Each source line is copied to the destination
- * and optionally repeated ymul times.
- *
- * Optimization: If source and destination have matching pitches and ymul=1,
- * performs a single bulk memcpy for the entire image.
- *
- * @param ymul Vertical scale factor (number of times to repeat each line)
- *
- * @note This is the core implementation for scale1x1_c16, scale1x2_c16, etc.
- */
-void scale1x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t swl = sw * sizeof(uint16_t);
-	if (!sp) {
-		sp = swl;
-	}
-	if (!dp) {
-		dp = swl * 1;
-	}
-	if ((ymul == 1) && (swl == sp) && (sp == dp))
-		memcpy(dst, src, sp * sh);
-	else {
-		if (swl > dp)
-			swl = dp;
-		for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-			for (uint32_t i = ymul; i > 0; i--, dst = (uint8_t*)dst + dp)
-				memcpy(dst, src, swl);
-		}
-	}
-}
-
-/**
- * 1x1 scale (no scaling, direct copy) for 16-bit pixels.
- */
-void scale1x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-
-/**
- * 1x2 scale (1x horizontal, 2x vertical) for 16-bit pixels.
- */
-void scale1x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-
-/**
- * 1x3 scale (1x horizontal, 3x vertical) for 16-bit pixels.
- */
-void scale1x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
+// Every integer scaler is the same nearest-neighbor kernel: widen each source row X
+// times, then copy the widened row ymul - 1 more times. The kernel is written once,
+// below, for any X and pixel size; the generator macros that follow it specialize it
+// for every X up to SCALER_MAX_FACTOR and emit the scale{X}x{Y}_* wrappers and the
+// dispatch tables. Rows are expanded in 16-byte source blocks (8 RGB565 or 4 RGBA8888
+// pixels), each producing X 16-byte output blocks.
 
-/**
- * 1x4 scale (1x horizontal, 4x vertical) for 16-bit pixels.
- */
-void scale1x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
+#define SCALE_BLOCK 16
 
 /**
- * Generic 1x horizontal scale with variable vertical scaling (32-bit C version).
- *
- * Same as scale1x_c16 but for 32-bit RGBA8888 pixels.
- *
- * @param ymul Vertical scale factor (number of times to repeat each line)
+ * Copies one pixel X times (row tails shorter than a block).
  */
-void scale1x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t swl = sw * sizeof(uint32_t);
-	if (!sp) {
-		sp = swl;
-	}
-	if (!dp) {
-		dp = swl * 1;
+static inline __attribute__((always_inline)) void scale_tail(const uint8_t* __restrict src,
+                                                             uint8_t* __restrict dst, uint32_t len,
+                                                             uint32_t X, uint32_t bpp) {
+	for (; len > 0; len -= bpp, src += bpp) {
+		for (uint32_t i = 0; i < X; i++, dst += bpp)
+			memcpy(dst, src, bpp);
 	}
-	if ((ymul == 1) && (swl == sp) && (sp == dp))
-		memcpy(dst, src, sp * sh);
-	else {
-		for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-			for (uint32_t i = ymul; i > 0; i--, dst = (uint8_t*)dst + dp)
-				memcpy(dst, src, swl);
-		}
-	}
-}
-
-/**
- * 1x1 scale (no scaling, direct copy) for 32-bit pixels.
- */
-void scale1x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-
-/**
- * 1x2 scale (1x horizontal, 2x vertical) for 32-bit pixels.
- */
-void scale1x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2);
 }
 
-/**
- * 1x3 scale (1x horizontal, 3x vertical) for 32-bit pixels.
- */
-void scale1x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
+typedef uint16_t scale_vec16 __attribute__((vector_size(SCALE_BLOCK)));
+typedef uint32_t scale_vec32 __attribute__((vector_size(SCALE_BLOCK)));
 
 /**
- * 1x4 scale (1x horizontal, 4x vertical) for 32-bit pixels.
+ * Source lane for lane i of output block k, with lanes pixels per block.
  */
-void scale1x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale1x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
+#define SCALE_LANE(X, lanes, k, i) (((lanes) * (k) + (i)) / (X))
 
 /**
- * Generic 2x horizontal scale with variable vertical scaling (16-bit C version).
+ * Widens one row X times using GCC vector extensions.
  *
- * Scales image 2x horizontally by duplicating each pixel, with configurable
- * vertical scaling. Each source pixel is read once and written twice horizontally.
- * Each output line is then duplicated ymul times vertically.
+ * With X and bpp constant every lane index below is constant, so the
+ * compiler lowers each output block to a shuffle of the loaded source
+ * block. Lanes are whole pixels, which lets targets without a byte
+ * shuffle use their 16- and 32-bit ones.
  *
- * Algorithm: Reads pixels in pairs (32-bit read = 2 RGB565 pixels) and
- * duplicates each to create 4 output pixels per iteration.
- *
- * @param ymul Vertical scale factor (number of times to repeat each line)
- *
- * @note Output width is 2x source width, height is ymul * source height
- */
-void scale2x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t x, dx, pix, dpix1, dpix2, swl = sw * sizeof(uint16_t);
-	if (!sp) {
-		sp = swl;
-	}
-	swl *= 2;
-	if (!dp) {
-		dp = swl;
-	}
-	for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-		const uint32_t* s = (const uint32_t* __restrict)src;
-		uint32_t* d = (uint32_t* __restrict)dst;
-		// Process pairs of RGB565 pixels (read 32 bits = 2 pixels)
-		for (x = dx = 0; x < (sw / 2); x++, dx += 2) {
-			pix = s[x]; // Contains pixels A and B: [B][A]
-			// Create [A][A] by taking lower 16 bits and duplicating
-			dpix1 = (pix & 0x0000FFFF) | (pix << 16);
-			// Create [B][B] by taking upper 16 bits and duplicating
-			dpix2 = (pix & 0xFFFF0000) | (pix >> 16);
-			d[dx] = dpix1; // Output: [A][A]
-			d[dx + 1] = dpix2; // Output: [B][B]
-		}
-		// Handle odd-width case (last pixel if width is odd)
-		if (sw & 1) {
-			const uint16_t* s16 = (const uint16_t*)s;
-			uint16_t pix16 = s16[x * 2];
-			d[dx] = pix16 | (pix16 << 16); // Duplicate single pixel
-		}
-		// Duplicate the scaled line ymul-1 additional times
-		const void* __restrict dstsrc = dst;
-		dst = (uint8_t*)dst + dp;
-		for (uint32_t i = ymul - 1; i > 0; i--, dst = (uint8_t*)dst + dp)
-			memcpy(dst, dstsrc, swl);
-	}
-}
-
-/**
- * 2x1 scale (2x horizontal, 1x vertical) for 16-bit pixels.
+ * @param len Source row length in bytes
  */
-void scale2x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-
-/**
- * 2x2 scale (2x horizontal, 2x vertical) for 16-bit pixels.
- */
-void scale2x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-
-/**
- * 2x3 scale (2x horizontal, 3x vertical) for 16-bit pixels.
- */
-void scale2x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
-
-/**
- * 2x4 scale (2x horizontal, 4x vertical) for 16-bit pixels.
- */
-void scale2x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
-
-/**
- * Generic 2x horizontal scale with variable vertical scaling (32-bit C version).
- *
- * Same algorithm as scale2x_c16 but for 32-bit RGBA8888 pixels.
- * Simpler than 16-bit version since one read = one pixel (no pairs).
- *
- * @param ymul Vertical scale factor (number of times to repeat each line)
- */
-void scale2x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t x, dx, pix, swl = sw * sizeof(uint32_t);
-	if (!sp) {
-		sp = swl;
-	}
-	swl *= 2;
-	if (!dp) {
-		dp = swl;
-	}
-	for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-		const uint32_t* s = (const uint32_t* __restrict)src;
-		uint32_t* d = (uint32_t* __restrict)dst;
-		// Simpler than 16-bit: just duplicate each pixel directly
-		for (x = dx = 0; x < sw; x++, dx += 2) {
-			pix = s[x];
-			d[dx] = pix;
-			d[dx + 1] = pix;
-		}
-		// Duplicate the scaled line ymul-1 additional times
-		const void* __restrict dstsrc = dst;
-		dst = (uint8_t*)dst + dp;
-		for (uint32_t i = ymul - 1; i > 0; i--, dst = (uint8_t*)dst + dp)
-			memcpy(dst, dstsrc, swl);
-	}
-}
-
-/** 2x1 scale (2x horizontal, 1x vertical) for 32-bit pixels. */
-void scale2x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-/** 2x2 scale (2x horizontal, 2x vertical) for 32-bit pixels. */
-void scale2x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-/** 2x3 scale (2x horizontal, 3x vertical) for 32-bit pixels. */
-void scale2x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
-/** 2x4 scale (2x horizontal, 4x vertical) for 32-bit pixels. */
-void scale2x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale2x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
-
-/**
- * Generic 3x horizontal scale with variable vertical scaling (16-bit C version).
- *
- * Triplicates each pixel horizontally. For pairs of pixels [A][B], outputs
- * [A][A][A][B][B][B] using bit manipulation to minimize writes.
- *
- * @param ymul Vertical scale factor
- */
-void scale3x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t x, dx, pix, dpix1, dpix2, swl = sw * sizeof(uint16_t);
-	if (!sp) {
-		sp = swl;
-	}
-	swl *= 3;
-	if (!dp) {
-		dp = swl;
-	}
-	for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-		const uint32_t* s = (const uint32_t* __restrict)src;
-		uint32_t* d = (uint32_t* __restrict)dst;
-		// Process pairs: [A][B] -> [A][A][A][B][B][B] in 3 writes
-		for (x = dx = 0; x < (sw / 2); x++, dx += 3) {
-			pix = s[x]; // [B][A]
-			dpix1 = (pix & 0x0000FFFF) | (pix << 16); // [A][A]
-			dpix2 = (pix & 0xFFFF0000) | (pix >> 16); // [B][B]
-			d[dx] = dpix1; // [A][A]
-			d[dx + 1] = pix; // [B][A] (middle A, first B)
-			d[dx + 2] = dpix2; // [B][B]
-		}
-		if (sw & 1) {
-			const uint16_t* s16 = (const uint16_t*)s;
-			uint16_t* d16 = (uint16_t*)d;
-			uint16_t pix16 = s16[x * 2];
-			dpix1 = pix16 | (pix16 << 16);
-			d[dx] = dpix1; // First two copies
-			d16[(dx + 1) * 2] = pix16; // Third copy
-		}
-		const void* __restrict dstsrc = dst;
-		dst = (uint8_t*)dst + dp;
-		for (uint32_t i = ymul - 1; i > 0; i--, dst = (uint8_t*)dst + dp)
-			memcpy(dst, dstsrc, swl);
-	}
-}
-
-/** 3x1 scale (3x horizontal, 1x vertical) for 16-bit pixels. */
-void scale3x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-/** 3x2 scale (3x horizontal, 2x vertical) for 16-bit pixels. */
-void scale3x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-/** 3x3 scale (3x horizontal, 3x vertical) for 16-bit pixels. */
-void scale3x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
-/** 3x4 scale (3x horizontal, 4x vertical) for 16-bit pixels. */
-void scale3x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
-
-/**
- * Generic 3x horizontal scale with variable vertical scaling (32-bit C version).
- *
- * Same as scale3x_c16 but for 32-bit pixels. Simpler since no paired reads needed.
- *
- * @param ymul Vertical scale factor
- */
-void scale3x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t x, dx, pix, swl = sw * sizeof(uint32_t);
-	if (!sp) {
-		sp = swl;
-	}
-	swl *= 3;
-	if (!dp) {
-		dp = swl;
-	}
-	for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-		const uint32_t* s = (const uint32_t* __restrict)src;
-		uint32_t* d = (uint32_t* __restrict)dst;
-		for (x = dx = 0; x < sw; x++, dx += 3) {
-			pix = s[x];
-			d[dx] = pix;
-			d[dx + 1] = pix;
-			d[dx + 2] = pix;
-		}
-		const void* __restrict dstsrc = dst;
-		dst = (uint8_t*)dst + dp;
-		for (uint32_t i = ymul - 1; i > 0; i--, dst = (uint8_t*)dst + dp)
-			memcpy(dst, dstsrc, swl);
-	}
-}
-
-/** 3x1 scale (3x horizontal, 1x vertical) for 32-bit pixels. */
-void scale3x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-/** 3x2 scale (3x horizontal, 2x vertical) for 32-bit pixels. */
-void scale3x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-/** 3x3 scale (3x horizontal, 3x vertical) for 32-bit pixels. */
-void scale3x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
-/** 3x4 scale (3x horizontal, 4x vertical) for 32-bit pixels. */
-void scale3x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale3x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
-
-/** Generic 4x horizontal scale with variable vertical scaling (16-bit C version). */
-void scale4x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t x, dx, pix, dpix1, dpix2, swl = sw * sizeof(uint16_t);
-	if (!sp) {
-		sp = swl;
-	}
-	swl *= 4;
-	if (!dp) {
-		dp = swl;
-	}
-	for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-		const uint32_t* s = (const uint32_t* __restrict)src;
-		uint32_t* d = (uint32_t* __restrict)dst;
-		for (x = dx = 0; x < (sw / 2); x++, dx += 4) {
-			pix = s[x];
-			dpix1 = (pix & 0x0000FFFF) | (pix << 16);
-			dpix2 = (pix & 0xFFFF0000) | (pix >> 16);
-			d[dx] = dpix1;
-			d[dx + 1] = dpix1;
-			d[dx + 2] = dpix2;
-			d[dx + 3] = dpix2;
-		}
-		if (sw & 1) {
-			const uint16_t* s16 = (const uint16_t*)s;
-			uint16_t pix16 = s16[x * 2];
-			dpix1 = pix16 | (pix16 << 16);
-			d[dx] = dpix1;
-			d[dx + 1] = dpix1;
-		}
-		const void* __restrict dstsrc = dst;
-		dst = (uint8_t*)dst + dp;
-		for (uint32_t i = ymul - 1; i > 0; i--, dst = (uint8_t*)dst + dp)
-			memcpy(dst, dstsrc, swl);
-	}
-}
-
-void scale4x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-void scale4x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-void scale4x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
-void scale4x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
-
-void scale4x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t x, dx, pix, swl = sw * sizeof(uint32_t);
-	if (!sp) {
-		sp = swl;
-	}
-	swl *= 4;
-	if (!dp) {
-		dp = swl;
-	}
-	for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-		const uint32_t* s = (const uint32_t* __restrict)src;
-		uint32_t* d = (uint32_t* __restrict)dst;
-		for (x = dx = 0; x < sw; x++, dx += 4) {
-			pix = s[x];
-			d[dx] = pix;
-			d[dx + 1] = pix;
-			d[dx + 2] = pix;
-			d[dx + 3] = pix;
-		}
-		const void* __restrict dstsrc = dst;
-		dst = (uint8_t*)dst + dp;
-		for (uint32_t i = ymul - 1; i > 0; i--, dst = (uint8_t*)dst + dp)
-			memcpy(dst, dstsrc, swl);
-	}
-}
-
-void scale4x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-void scale4x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-void scale4x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
-void scale4x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale4x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
-
-void scale5x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
+static inline __attribute__((always_inline)) void scale_row_c(const uint8_t* __restrict src,
+                                                              uint8_t* __restrict dst, uint32_t len,
+                                                              uint32_t X, uint32_t bpp) {
+	if (X == 1) {
+		memcpy(dst, src, len);
 		return;
-	uint32_t x, dx, pix, dpix1, dpix2, swl = sw * sizeof(uint16_t);
-	if (!sp) {
-		sp = swl;
-	}
-	swl *= 5;
-	if (!dp) {
-		dp = swl;
-	}
-	for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-		const uint32_t* s = (const uint32_t* __restrict)src;
-		uint32_t* d = (uint32_t* __restrict)dst;
-		for (x = dx = 0; x < (sw / 2); x++, dx += 5) {
-			pix = s[x];
-			dpix1 = (pix & 0x0000FFFF) | (pix << 16);
-			dpix2 = (pix & 0xFFFF0000) | (pix >> 16);
-			d[dx] = dpix1;
-			d[dx + 1] = dpix1;
-			d[dx + 2] = pix;
-			d[dx + 3] = dpix2;
-			d[dx + 4] = dpix2;
-		}
-		if (sw & 1) {
-			const uint16_t* s16 = (const uint16_t*)s;
-			uint16_t* d16 = (uint16_t*)d;
-			uint16_t pix16 = s16[x * 2];
-			dpix1 = pix16 | (pix16 << 16);
-			d[dx] = dpix1;
-			d[dx + 1] = dpix1;
-			d16[(dx + 2) * 2] = pix16;
-		}
-		const void* __restrict dstsrc = dst;
-		dst = (uint8_t*)dst + dp;
-		for (uint32_t i = ymul - 1; i > 0; i--, dst = (uint8_t*)dst + dp)
-			memcpy(dst, dstsrc, swl);
 	}
-}
-
-void scale5x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-void scale5x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-void scale5x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
-void scale5x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
-void scale5x5_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c16(src, dst, sw, sh, sp, dw, dh, dp, 5);
-}
-
-void scale5x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t x, dx, pix, swl = sw * sizeof(uint32_t);
-	if (!sp) {
-		sp = swl;
-	}
-	swl *= 5;
-	if (!dp) {
-		dp = swl;
-	}
-	for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-		const uint32_t* s = (const uint32_t* __restrict)src;
-		uint32_t* d = (uint32_t* __restrict)dst;
-		for (x = dx = 0; x < sw; x++, dx += 5) {
-			pix = s[x];
-			d[dx] = pix;
-			d[dx + 1] = pix;
-			d[dx + 2] = pix;
-			d[dx + 3] = pix;
-			d[dx + 4] = pix;
-		}
-		const void* __restrict dstsrc = dst;
-		dst = (uint8_t*)dst + dp;
-		for (uint32_t i = ymul - 1; i > 0; i--, dst = (uint8_t*)dst + dp)
-			memcpy(dst, dstsrc, swl);
-	}
-}
-
-void scale5x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-void scale5x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-void scale5x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
-void scale5x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
-void scale5x5_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale5x_c32(src, dst, sw, sh, sp, dw, dh, dp, 5);
-}
-
-void scale6x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t x, dx, pix, dpix1, dpix2, swl = sw * sizeof(uint16_t);
-	if (!sp) {
-		sp = swl;
-	}
-	swl *= 6;
-	if (!dp) {
-		dp = swl;
-	}
-	for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-		const uint32_t* s = (const uint32_t* __restrict)src;
-		uint32_t* d = (uint32_t* __restrict)dst;
-		for (x = dx = 0; x < (sw / 2); x++, dx += 6) {
-			pix = s[x];
-			dpix1 = (pix & 0x0000FFFF) | (pix << 16);
-			dpix2 = (pix & 0xFFFF0000) | (pix >> 16);
-			d[dx] = dpix1;
-			d[dx + 1] = dpix1;
-			d[dx + 2] = dpix1;
-			d[dx + 3] = dpix2;
-			d[dx + 4] = dpix2;
-			d[dx + 5] = dpix2;
-		}
-		if (sw & 1) {
-			const uint16_t* s16 = (const uint16_t*)s;
-			uint16_t pix16 = s16[x * 2];
-			dpix1 = pix16 | (pix16 << 16);
-			d[dx] = dpix1;
-			d[dx + 1] = dpix1;
-			d[dx + 2] = dpix1;
-		}
-		const void* __restrict dstsrc = dst;
-		dst = (uint8_t*)dst + dp;
-		for (uint32_t i = ymul - 1; i > 0; i--, dst = (uint8_t*)dst + dp)
-			memcpy(dst, dstsrc, swl);
-	}
-}
-
-void scale6x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-void scale6x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-void scale6x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
-void scale6x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
-void scale6x5_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 5);
-}
-void scale6x6_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c16(src, dst, sw, sh, sp, dw, dh, dp, 6);
-}
-
-void scale6x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {
-	if (!sw || !sh || !ymul)
-		return;
-	uint32_t x, dx, pix, swl = sw * sizeof(uint32_t);
-	if (!sp) {
-		sp = swl;
-	}
-	swl *= 6;
-	if (!dp) {
-		dp = swl;
-	}
-	for (; sh > 0; sh--, src = (uint8_t*)src + sp) {
-		const uint32_t* s = (const uint32_t* __restrict)src;
-		uint32_t* d = (uint32_t* __restrict)dst;
-		for (x = dx = 0; x < sw; x++, dx += 6) {
-			pix = s[x];
-			d[dx] = pix;
-			d[dx + 1] = pix;
-			d[dx + 2] = pix;
-			d[dx + 3] = pix;
-			d[dx + 4] = pix;
-			d[dx + 5] = pix;
+	uint32_t x = 0;
+	for (; x + SCALE_BLOCK <= len; x += SCALE_BLOCK, dst += SCALE_BLOCK * X) {
+		if (bpp == 2) {
+			scale_vec16 v;
+			memcpy(&v, src + x, sizeof(v));
+#pragma GCC unroll 12
+			for (uint32_t k = 0; k < X; k++) {
+				scale_vec16 out = {v[SCALE_LANE(X, 8, k, 0)], v[SCALE_LANE(X, 8, k, 1)],
+				                   v[SCALE_LANE(X, 8, k, 2)], v[SCALE_LANE(X, 8, k, 3)],
+				                   v[SCALE_LANE(X, 8, k, 4)], v[SCALE_LANE(X, 8, k, 5)],
+				                   v[SCALE_LANE(X, 8, k, 6)], v[SCALE_LANE(X, 8, k, 7)]};
+				memcpy(dst + SCALE_BLOCK * k, &out, sizeof(out));
+			}
+		} else {
+			scale_vec32 v;
+			memcpy(&v, src + x, sizeof(v));
+#pragma GCC unroll 12
+			for (uint32_t k = 0; k < X; k++) {
+				scale_vec32 out = {v[SCALE_LANE(X, 4, k, 0)], v[SCALE_LANE(X, 4, k, 1)],
+				                   v[SCALE_LANE(X, 4, k, 2)], v[SCALE_LANE(X, 4, k, 3)]};
+				memcpy(dst + SCALE_BLOCK * k, &out, sizeof(out));
+			}
 		}
-		const void* __restrict dstsrc = dst;
-		dst = (uint8_t*)dst + dp;
-		for (uint32_t i = ymul - 1; i > 0; i--, dst = (uint8_t*)dst + dp)
-			memcpy(dst, dstsrc, swl);
 	}
+	scale_tail(src + x, dst, len - x, X, bpp);
 }
 
-void scale6x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 1);
-}
-void scale6x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 2);
-}
-void scale6x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 3);
-}
-void scale6x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 4);
-}
-void scale6x5_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 5);
-}
-/** 6x6 scale for 32-bit pixels. */
-void scale6x6_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp) {
-	scale6x_c32(src, dst, sw, sh, sp, dw, dh, dp, 6);
-}
-
-///////////////////////////////
-// ARM NEON Optimized Scalers
-///////////////////////////////
-
 #ifdef HAS_NEON
 
 /**
@@ -986,6 +318,127 @@ void memcpy_neon(void* dst, const void* src, uint32_t size) {
 	    : "r3", "r4", "q8", "q9", "q10", "q11", "q12", "q13", "q14", "q15", "memory", "cc");
 }
 
+#endif // HAS_NEON
+
+/**
+ * Integer scaler kernel template.
+ *
+ * Each output row after the first of a group is a memcpy of the first.
+ * A 1x1 copy between matching pitches is a single memcpy.
+ *
+ * @param ymul Vertical scale factor (number of times to repeat each line)
+ * @param X Horizontal scale factor (compile-time constant)
+ * @param bpp Bytes per pixel (compile-time constant)
+ */
+static inline __attribute__((always_inline)) void scale_frame(void* __restrict src,
+                                                              void* __restrict dst, uint32_t sw,
+                                                              uint32_t sh, uint32_t sp, uint32_t dp,
+                                                              uint32_t ymul, uint32_t X,
+                                                              uint32_t bpp) {
+	if (!sw || !sh || !ymul)
+		return;
+	uint32_t swl = sw * bpp;
+	uint32_t dwl = swl * X;
+	if (!sp) {
+		sp = swl;
+	}
+	if (!dp) {
+		dp = dwl;
+	}
+	if (X == 1) {
+		if ((ymul == 1) && (swl == sp) && (sp == dp)) {
+			memcpy(dst, src, sp * sh);
+			return;
+		}
+		if (swl > dp)
+			swl = dwl = dp;
+	}
+	const uint8_t* s = src;
+	uint8_t* d = dst;
+	for (; sh > 0; sh--, s += sp) {
+		scale_row_c(s, d, swl, X, bpp);
+		const uint8_t* line = d;
+		d += dp;
+		for (uint32_t i = ymul - 1; i > 0; i--, d += dp)
+			memcpy(d, line, dwl);
+	}
+}
+
+#define SCALE_BPP_c16 2
+#define SCALE_BPP_c32 4
+
+/**
+ * Defines scale<X>x_<T> and its fixed-factor wrappers scale<X>x<Y>_<T>.
+ */
+#define SCALER_DEFINE_X(X, T)                                                                      \
+	void scale##X##x_##T(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,     \
+	                     uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul) {      \
+		scale_frame(src, dst, sw, sh, sp, dp, ymul, X, SCALE_BPP_##T);                             \
+	}                                                                                              \
+	SCALER_FOREACH_Y(SCALER_DEFINE_XY, X, T)
+#define SCALER_DEFINE_XY(X, Y, T)                                                                  \
+	void scale##X##x##Y##_##T(void* __restrict src, void* __restrict dst, uint32_t sw,             \
+	                          uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {   \
+		scale##X##x_##T(src, dst, sw, sh, sp, dw, dh, dp, Y);                                      \
+	}
+
+#define SCALER_TABLE_ENTRY(X, Y, T) &scale##X##x##Y##_##T,
+#define SCALER_TABLE_ROW(X, T) {SCALER_FOREACH_Y(SCALER_TABLE_ENTRY, X, T)},
+
+/**
+ * Returns table[xmul - 1][ymul - 1], or NULL for factors out of range.
+ */
+static scaler_t scaler_find(const scaler_t (*table)[SCALER_MAX_FACTOR], uint32_t xmul,
+                            uint32_t ymul) {
+	if ((xmul - 1 < SCALER_MAX_FACTOR) && (ymul - 1 < SCALER_MAX_FACTOR))
+		return table[xmul - 1][ymul - 1];
+	return NULL;
+}
+
+SCALER_FOREACH_X(SCALER_DEFINE_X, c16)
+SCALER_FOREACH_X(SCALER_DEFINE_X, c32)
+
+static const scaler_t scalers_c16[SCALER_MAX_FACTOR][SCALER_MAX_FACTOR] = {
+    SCALER_FOREACH_X(SCALER_TABLE_ROW, c16)};
+static const scaler_t scalers_c32[SCALER_MAX_FACTOR][SCALER_MAX_FACTOR] = {
+    SCALER_FOREACH_X(SCALER_TABLE_ROW, c32)};
+
+scaler_t scaler_find_c16(uint32_t xmul, uint32_t ymul) {
+	return scaler_find(scalers_c16, xmul, ymul);
+}
+
+scaler_t scaler_find_c32(uint32_t xmul, uint32_t ymul) {
+	return scaler_find(scalers_c32, xmul, ymul);
+}
+
+/**
+ * Generic scaler dispatcher for 16-bit pixels (C implementation).
+ *
+ * @param xmul Horizontal scale factor (1-12)
+ * @param ymul Vertical scale factor (1-12)
+ */
+void scaler_c16(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst,
+                uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
+	scaler_t scaler = scaler_find_c16(xmul, ymul);
+	if (scaler)
+		scaler(src, dst, sw, sh, sp, dw, dh, dp);
+}
+
+/**
+ * Generic scaler dispatcher for 32-bit pixels (C implementation).
+ *
+ * @param xmul Horizontal scale factor (1-12)
+ * @param ymul Vertical scale factor (1-12)
+ */
+void scaler_c32(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst,
+                uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
+	scaler_t scaler = scaler_find_c32(xmul, ymul);
+	if (scaler)
+		scaler(src, dst, sw, sh, sp, dw, dh, dp);
+}
+
+#ifdef HAS_NEON
+
 /**
  * 1x1 scale (direct copy) for 16-bit pixels using NEON.
  *
@@ -3850,115 +3303,66 @@ void scale6x6_n32(void* __restrict src, void* __restrict dst, uint32_t sw, uint3
 	scale6x_n32(src, dst, sw, sh, sp, dw, dh, dp, 6);
 }
 
-void scaler_n16(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst,
-                uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	void (*const func[6][8])(void* __restrict, void* __restrict, uint32_t, uint32_t, uint32_t,
-	                         uint32_t, uint32_t, uint32_t) = {
-	    {&scale1x1_n16, &scale1x2_n16, &scale1x3_n16, &scale1x4_n16, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale2x1_n16, &scale2x2_n16, &scale2x3_n16, &scale2x4_n16, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale3x1_n16, &scale3x2_n16, &scale3x3_n16, &scale3x4_n16, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale4x1_n16, &scale4x2_n16, &scale4x3_n16, &scale4x4_n16, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale5x1_n16, &scale5x2_n16, &scale5x3_n16, &scale5x4_n16, &scale5x5_n16, &dummy, &dummy,
-	     &dummy},
-	    {&scale6x1_n16, &scale6x2_n16, &scale6x3_n16, &scale6x4_n16, &scale6x5_n16, &scale6x6_n16,
-	     &dummy, &dummy}};
-	if ((--xmul < 6) && (--ymul < 6))
-		func[xmul][ymul](src, dst, sw, sh, sp, dw, dh, dp);
-	return;
+#define SCALER_NEON_MAX_FACTOR 6 // Largest factor the NEON scalers cover
+
+static const scaler_t scalers_n16[SCALER_NEON_MAX_FACTOR][SCALER_NEON_MAX_FACTOR] = {
+    {&scale1x1_n16, &scale1x2_n16, &scale1x3_n16, &scale1x4_n16},
+    {&scale2x1_n16, &scale2x2_n16, &scale2x3_n16, &scale2x4_n16},
+    {&scale3x1_n16, &scale3x2_n16, &scale3x3_n16, &scale3x4_n16},
+    {&scale4x1_n16, &scale4x2_n16, &scale4x3_n16, &scale4x4_n16},
+    {&scale5x1_n16, &scale5x2_n16, &scale5x3_n16, &scale5x4_n16, &scale5x5_n16},
+    {&scale6x1_n16, &scale6x2_n16, &scale6x3_n16, &scale6x4_n16, &scale6x5_n16, &scale6x6_n16}};
+static const scaler_t scalers_n32[SCALER_NEON_MAX_FACTOR][SCALER_NEON_MAX_FACTOR] = {
+    {&scale1x1_n32, &scale1x2_n32, &scale1x3_n32, &scale1x4_n32},
+    {&scale2x1_n32, &scale2x2_n32, &scale2x3_n32, &scale2x4_n32},
+    {&scale3x1_n32, &scale3x2_n32, &scale3x3_n32, &scale3x4_n32},
+    {&scale4x1_n32, &scale4x2_n32, &scale4x3_n32, &scale4x4_n32},
+    {&scale5x1_n32, &scale5x2_n32, &scale5x3_n32, &scale5x4_n32, &scale5x5_n32},
+    {&scale6x1_n32, &scale6x2_n32, &scale6x3_n32, &scale6x4_n32, &scale6x5_n32, &scale6x6_n32}};
+
+/**
+ * Pairs without a NEON scaler use the C one, which covers every factor.
+ */
+scaler_t scaler_find_n16(uint32_t xmul, uint32_t ymul) {
+	scaler_t scaler = NULL;
+	if ((xmul - 1 < SCALER_NEON_MAX_FACTOR) && (ymul - 1 < SCALER_NEON_MAX_FACTOR))
+		scaler = scalers_n16[xmul - 1][ymul - 1];
+	return scaler ? scaler : scaler_find_c16(xmul, ymul);
 }
 
-void scaler_n32(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst,
-                uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	void (*const func[6][8])(void* __restrict, void* __restrict, uint32_t, uint32_t, uint32_t,
-	                         uint32_t, uint32_t, uint32_t) = {
-	    {&scale1x1_n32, &scale1x2_n32, &scale1x3_n32, &scale1x4_n32, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale2x1_n32, &scale2x2_n32, &scale2x3_n32, &scale2x4_n32, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale3x1_n32, &scale3x2_n32, &scale3x3_n32, &scale3x4_n32, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale4x1_n32, &scale4x2_n32, &scale4x3_n32, &scale4x4_n32, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale5x1_n32, &scale5x2_n32, &scale5x3_n32, &scale5x4_n32, &scale5x5_n32, &dummy, &dummy,
-	     &dummy},
-	    {&scale6x1_n32, &scale6x2_n32, &scale6x3_n32, &scale6x4_n32, &scale6x5_n32, &scale6x6_n32,
-	     &dummy, &dummy}};
-	if ((--xmul < 6) && (--ymul < 6))
-		func[xmul][ymul](src, dst, sw, sh, sp, dw, dh, dp);
-	return;
+scaler_t scaler_find_n32(uint32_t xmul, uint32_t ymul) {
+	scaler_t scaler = NULL;
+	if ((xmul - 1 < SCALER_NEON_MAX_FACTOR) && (ymul - 1 < SCALER_NEON_MAX_FACTOR))
+		scaler = scalers_n32[xmul - 1][ymul - 1];
+	return scaler ? scaler : scaler_find_c32(xmul, ymul);
 }
 
-#endif // HAS_NEON
+#endif
 
-///////////////////////////////
-// High-Level Scaler Dispatchers
-///////////////////////////////
+#ifdef HAS_NEON
 
 /**
- * Generic scaler dispatcher for 16-bit pixels (C implementation).
- *
- * Selects the appropriate scale function based on horizontal (xmul) and
- * vertical (ymul) scale factors. Uses function pointer table for dispatch.
- *
- * @param xmul Horizontal scale factor (1-6)
- * @param ymul Vertical scale factor (1-6, up to 8 for some scales)
- *
- * @note This is the main entry point for C-based scaling (fallback or non-NEON platforms)
+ * Generic scaler dispatcher for 16-bit pixels (NEON implementation).
  */
-void scaler_c16(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst,
+void scaler_n16(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst,
                 uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	void (*const func[6][8])(void* __restrict, void* __restrict, uint32_t, uint32_t, uint32_t,
-	                         uint32_t, uint32_t, uint32_t) = {
-	    {&scale1x1_c16, &scale1x2_c16, &scale1x3_c16, &scale1x4_c16, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale2x1_c16, &scale2x2_c16, &scale2x3_c16, &scale2x4_c16, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale3x1_c16, &scale3x2_c16, &scale3x3_c16, &scale3x4_c16, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale4x1_c16, &scale4x2_c16, &scale4x3_c16, &scale4x4_c16, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale5x1_c16, &scale5x2_c16, &scale5x3_c16, &scale5x4_c16, &scale5x5_c16, &dummy, &dummy,
-	     &dummy},
-	    {&scale6x1_c16, &scale6x2_c16, &scale6x3_c16, &scale6x4_c16, &scale6x5_c16, &scale6x6_c16,
-	     &dummy, &dummy}};
-	if ((--xmul < 6) && (--ymul < 6))
-		func[xmul][ymul](src, dst, sw, sh, sp, dw, dh, dp);
-	return;
+	scaler_t scaler = scaler_find_n16(xmul, ymul);
+	if (scaler)
+		scaler(src, dst, sw, sh, sp, dw, dh, dp);
 }
 
 /**
- * Generic scaler dispatcher for 32-bit pixels (C implementation).
- *
- * Same as scaler_c16 but for 32-bit RGBA8888 pixels.
- *
- * @param xmul Horizontal scale factor (1-6)
- * @param ymul Vertical scale factor (1-6, up to 8 for some scales)
+ * Generic scaler dispatcher for 32-bit pixels (NEON implementation).
  */
-void scaler_c32(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst,
+void scaler_n32(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst,
                 uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
-	void (*const func[6][8])(void* __restrict, void* __restrict, uint32_t, uint32_t, uint32_t,
-	                         uint32_t, uint32_t, uint32_t) = {
-	    {&scale1x1_c32, &scale1x2_c32, &scale1x3_c32, &scale1x4_c32, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale2x1_c32, &scale2x2_c32, &scale2x3_c32, &scale2x4_c32, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale3x1_c32, &scale3x2_c32, &scale3x3_c32, &scale3x4_c32, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale4x1_c32, &scale4x2_c32, &scale4x3_c32, &scale4x4_c32, &dummy, &dummy, &dummy,
-	     &dummy},
-	    {&scale5x1_c32, &scale5x2_c32, &scale5x3_c32, &scale5x4_c32, &scale5x5_c32, &dummy, &dummy,
-	     &dummy},
-	    {&scale6x1_c32, &scale6x2_c32, &scale6x3_c32, &scale6x4_c32, &scale6x5_c32, &scale6x6_c32,
-	     &dummy, &dummy}};
-	if ((--xmul < 6) && (--ymul < 6))
-		func[xmul][ymul](src, dst, sw, sh, sp, dw, dh, dp);
-	return;
+	scaler_t scaler = scaler_find_n32(xmul, ymul);
+	if (scaler)
+		scaler(src, dst, sw, sh, sp, dw, dh, dp);
 }
 
+#endif // HAS_NEON
+
 ///////////////////////////////
 // Advanced Scaling Algorithms (from gambatte-dms)
 ///////////////////////////////
@@ -4197,7 +3601,6 @@ void scale3x_grid(void* __restrict src, void* __restrict dst, uint32_t sw, uint3
 ///////////////////////////////
 
 #ifdef HAS_NEON
-#include <arm_neon.h>
 
 /**
  * NEON-optimized 4x4 block transpose for RGB565.
@@ -4525,3 +3928,751 @@ void rotate_c16(unsigned rotation, void* __restrict src, void* __restrict dst, u
 		break;
 	}
 }
+
+///////////////////////////////
+// Bilinear scaling
+///////////////////////////////
+
+/**
+ * Blends two RGBA8888 pixels, weight 0-255 toward b.
+ *
+ * Red/blue and green/alpha are each blended as a pair in one multiply;
+ * 255 * 256 fits in the 16 bits between lanes so nothing carries across.
+ */
+static inline uint32_t bilinear_lerp32(uint32_t a, uint32_t b, uint32_t weight) {
+	uint32_t inverse = 256 - weight;
+	uint32_t rb = (((a & 0x00FF00FF) * inverse + (b & 0x00FF00FF) * weight + 0x00800080) >> 8) &
+	              0x00FF00FF;
+	uint32_t ag =
+	    (((a >> 8) & 0x00FF00FF) * inverse + ((b >> 8) & 0x00FF00FF) * weight + 0x00800080) &
+	    0xFF00FF00;
+	return rb | ag;
+}
+
+/**
+ * Blends two source rows into one, weight 1-255 toward b.
+ */
+typedef void (*bilinear_row_t)(const uint32_t* __restrict a, const uint32_t* __restrict b,
+                               uint32_t* __restrict out, uint32_t count, uint32_t weight);
+
+static void bilinear_blendRow_c32(const uint32_t* __restrict a, const uint32_t* __restrict b,
+                                  uint32_t* __restrict out, uint32_t count, uint32_t weight) {
+	for (uint32_t x = 0; x < count; x++)
+		out[x] = bilinear_lerp32(a[x], b[x], weight);
+}
+
+#ifdef HAS_NEON
+static void bilinear_blendRow_n32(const uint32_t* __restrict a, const uint32_t* __restrict b,
+                                  uint32_t* __restrict out, uint32_t count, uint32_t weight) {
+	uint8x8_t wa = vdup_n_u8((uint8_t)(256 - weight));
+	uint8x8_t wb = vdup_n_u8((uint8_t)weight);
+	uint32_t x = 0;
+	for (; x + 4 <= count; x += 4) {
+		uint8x16_t pa = vld1q_u8((const uint8_t*)(a + x));
+		uint8x16_t pb = vld1q_u8((const uint8_t*)(b + x));
+		uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(pa), wa), vget_low_u8(pb), wb);
+		uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(pa), wa), vget_high_u8(pb), wb);
+		// Rounding narrow matches the + 0x80 >> 8 in bilinear_lerp32
+		vst1q_u8((uint8_t*)(out + x), vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+	}
+	for (; x < count; x++)
+		out[x] = bilinear_lerp32(a[x], b[x], weight);
+}
+#endif
+
+/**
+ * Shared body of scaleBilinear_c32/n32.
+ */
+static void scaleBilinear32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,
+                            uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp,
+                            bilinear_row_t blend_row) {
+	if (!sw || !sh || !dw || !dh)
+		return;
+	if (!sp)
+		sp = sw * sizeof(uint32_t);
+	if (!dp)
+		dp = dw * sizeof(uint32_t);
+
+	// One allocation: per-column source index and weight, plus a blended row
+	uint32_t* columns = malloc(dw * 2 * sizeof(uint32_t) + sw * sizeof(uint32_t));
+	if (!columns) {
+		LOG_error("scaleBilinear: out of memory for %ux%u", dw, dh);
+		return;
+	}
+	uint32_t* weights = columns + dw;
+	uint32_t* row = weights + dw;
+
+	for (uint32_t x = 0; x < dw; x++) {
+		uint32_t pos = (uint32_t)(((uint64_t)x * sw << 16) / dw);
+		columns[x] = pos >> 16;
+		// Last column has no right neighbour
+		weights[x] = columns[x] + 1 < sw ? (pos >> 8) & 0xFF : 0;
+	}
+
+	uint8_t* src_bytes = (uint8_t*)src;
+	uint8_t* dst_bytes = (uint8_t*)dst;
+	for (uint32_t y = 0; y < dh; y++) {
+		uint32_t pos = (uint32_t)(((uint64_t)y * sh << 16) / dh);
+		uint32_t sy = pos >> 16;
+		uint32_t weight = sy + 1 < sh ? (pos >> 8) & 0xFF : 0;
+
+		const uint32_t* top = (const uint32_t*)(src_bytes + sy * sp);
+		const uint32_t* line = top;
+		if (weight) {
+			blend_row(top, (const uint32_t*)(src_bytes + (sy + 1) * sp), row, sw, weight);
+			line = row;
+		}
+
+		uint32_t* out = (uint32_t*)(dst_bytes + y * dp);
+		for (uint32_t x = 0; x < dw; x++) {
+			uint32_t sx = columns[x];
+			uint32_t wx = weights[x];
+			out[x] = wx ? bilinear_lerp32(line[sx], line[sx + 1], wx) : line[sx];
+		}
+	}
+
+	free(columns);
+}
+
+void scaleBilinear_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,
+                       uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
+	scaleBilinear32(src, dst, sw, sh, sp, dw, dh, dp, bilinear_blendRow_c32);
+}
+
+#ifdef HAS_NEON
+void scaleBilinear_n32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,
+                       uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
+	scaleBilinear32(src, dst, sw, sh, sp, dw, dh, dp, bilinear_blendRow_n32);
+}
+#endif
+
+///////////////////////////////
+// Anti-aliased scaling (from picoarch)
+///////////////////////////////
+
+/**
+ * Averages two RGB565 pixels, rounding each channel up.
+ *
+ * Same result as average16() in utils.c, written as (a | b) minus half the
+ * differing bits so nothing carries out of a 16-bit lane.
+ */
+static inline uint16_t aa_average(uint16_t a, uint16_t b) {
+	return (uint16_t)((a | b) - (((a ^ b) & 0xF7DE) >> 1));
+}
+
+/**
+ * Column blends. The original scaler overwrote a or b in place when it
+ * produced a 1/4 or 3/4 blend, so later pixels from the same source pair
+ * blend the blend; AA_BLEND_AMM is the one such case seen in practice.
+ */
+enum {
+	AA_BLEND_A, // a
+	AA_BLEND_AM, // avg(a, m), about 1/4 b
+	AA_BLEND_M, // m = avg(a, b)
+	AA_BLEND_MB, // avg(m, b), about 3/4 b
+	AA_BLEND_B, // b
+	AA_BLEND_AMM, // avg(avg(a, m), m)
+};
+
+/**
+ * Blends two RGB565 pixels by repeated averaging, exactly as the original
+ * per-pixel scaler did. Rows only use the first five blends.
+ */
+static inline uint16_t aa_blend(uint16_t a, uint16_t b, unsigned blend) {
+	uint16_t m = aa_average(a, b);
+	switch (blend) {
+	case AA_BLEND_A:
+		return a;
+	case AA_BLEND_AM:
+		return aa_average(a, m);
+	case AA_BLEND_M:
+		return m;
+	case AA_BLEND_MB:
+		return aa_average(m, b);
+	case AA_BLEND_B:
+		return b;
+	default:
+		return aa_average(aa_average(a, m), m);
+	}
+}
+
+/**
+ * Blend produced by averaging two blends, or -1 if it isn't one of ours.
+ */
+static int aa_averageBlend(int x, int y) {
+	if (x == y)
+		return x;
+	if (x > y) {
+		int t = x;
+		x = y;
+		y = t;
+	}
+	if (x == AA_BLEND_A && y == AA_BLEND_B)
+		return AA_BLEND_M;
+	if (x == AA_BLEND_A && y == AA_BLEND_M)
+		return AA_BLEND_AM;
+	if (x == AA_BLEND_M && y == AA_BLEND_B)
+		return AA_BLEND_MB;
+	if (x == AA_BLEND_AM && y == AA_BLEND_M)
+		return AA_BLEND_AMM;
+	return -1;
+}
+
+static uint32_t aa_gcd(uint32_t a, uint32_t b) {
+	while (b) {
+		uint32_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/**
+ * Computes the tables for scaling src_w x src_h to dst_w x dst_h.
+ *
+ * Walks the same fixed-ratio stepping and breakpoints as picoarch's
+ * scaler, recording the result for each output column and row.
+ */
+int scaleAA_init(AAScaler* aa, uint32_t src_w, uint32_t src_h, uint32_t dst_w, uint32_t dst_h) {
+	memset(aa, 0, sizeof(*aa));
+	if (!src_w || !src_h || !dst_w || !dst_h || src_w > UINT16_MAX || src_h > UINT16_MAX)
+		return 0;
+
+	// One allocation for every table; the byte-sized row table goes last
+	size_t words = (size_t)dst_w * 3 + dst_h + src_w;
+	uint16_t* tables = malloc(words * sizeof(uint16_t) + dst_h);
+	if (!tables) {
+		LOG_error("scaleAA: out of memory for %ux%u", dst_w, dst_h);
+		return 0;
+	}
+	aa->src_w = src_w;
+	aa->src_h = src_h;
+	aa->dst_w = dst_w;
+	aa->dst_h = dst_h;
+	aa->col_a = tables;
+	aa->col_b = aa->col_a + dst_w;
+	aa->col_q = aa->col_b + dst_w;
+	aa->row_src = aa->col_q + dst_w;
+	aa->blend_line = aa->row_src + dst_h;
+	aa->row_q = (uint8_t*)(aa->blend_line + src_w);
+
+	// Blend zone widths: round(ratio / 5) when shrinking, round(ratio / 2.5)
+	// when growing. These values are really only good for the nano.
+	int shrinking = src_w > dst_w;
+#define AA_BREAKPOINT(ratio) (shrinking ? (2 * (ratio) + 5) / 10 : (4 * (ratio) + 5) / 10)
+
+	uint32_t gcd_w = aa_gcd(src_w, dst_w);
+	int ratio_w = (int)(src_w / gcd_w);
+	int ratio_dst_w = (int)(dst_w / gcd_w);
+	int bw0 = AA_BREAKPOINT(ratio_dst_w);
+	int bw1 = ratio_dst_w >> 1;
+
+	uint32_t x = 0;
+	int dx = 0;
+	for (uint32_t sx = 0; sx < src_w && x < dst_w; sx++) {
+		// What a and b hold in the original after its in-place updates
+		int a = AA_BLEND_A;
+		int b = AA_BLEND_B;
+		for (; dx < ratio_dst_w && x < dst_w; dx += ratio_w, x++) {
+			int blend;
+			if (dx > ratio_dst_w - bw0) {
+				blend = b;
+			} else if (dx <= bw0) {
+				blend = a;
+			} else {
+				int nominal = AA_BLEND_M;
+				if (dx > ratio_dst_w - bw1) {
+					a = aa_averageBlend(a, b);
+					nominal = AA_BLEND_MB;
+				} else if (dx <= bw1) {
+					b = aa_averageBlend(a, b);
+					nominal = AA_BLEND_AM;
+				}
+				blend = aa_averageBlend(a, b);
+				if (a < 0 || b < 0 || blend < 0) { // deeper nesting, never seen
+					a = AA_BLEND_A;
+					b = AA_BLEND_B;
+					blend = nominal;
+				}
+			}
+			aa->col_a[x] = (uint16_t)sx;
+			aa->col_b[x] = (uint16_t)(sx + 1 < src_w ? sx + 1 : sx);
+			aa->col_q[x] = (uint16_t)blend;
+		}
+		dx -= ratio_dst_w;
+	}
+	for (; x < dst_w; x++) { // only reached if the ratio didn't divide evenly
+		aa->col_a[x] = aa->col_b[x] = (uint16_t)(src_w - 1);
+		aa->col_q[x] = AA_BLEND_A;
+	}
+
+	uint32_t gcd_h = aa_gcd(src_h, dst_h);
+	int ratio_h = (int)(src_h / gcd_h);
+	int ratio_dst_h = (int)(dst_h / gcd_h);
+	int bh0 = AA_BREAKPOINT(ratio_dst_h);
+	int bh1 = ratio_dst_h >> 1;
+#undef AA_BREAKPOINT
+
+	uint32_t y = 0;
+	int dy = 0;
+	for (uint32_t sy = 0; sy < src_h && y < dst_h; sy++) {
+		for (; dy < ratio_dst_h && y < dst_h; dy += ratio_h, y++) {
+			// Rows are blended fresh each time, so no nesting here
+			unsigned q;
+			if (dy > ratio_dst_h - bh0)
+				q = AA_BLEND_B;
+			else if (dy <= bh0)
+				q = AA_BLEND_A;
+			else if (dy <= bh1)
+				q = AA_BLEND_AM;
+			else if (dy > ratio_dst_h - bh1)
+				q = AA_BLEND_MB;
+			else
+				q = AA_BLEND_M;
+			aa->row_src[y] = (uint16_t)sy;
+			aa->row_q[y] = (uint8_t)q;
+		}
+		dy -= ratio_dst_h;
+	}
+	for (; y < dst_h; y++) {
+		aa->row_src[y] = (uint16_t)(src_h - 1);
+		aa->row_q[y] = AA_BLEND_A;
+	}
+
+	return 1;
+}
+
+/**
+ * Frees the tables.
+ */
+void scaleAA_free(AAScaler* aa) {
+	free(aa->col_a);
+	memset(aa, 0, sizeof(*aa));
+}
+
+/**
+ * Blends two source rows (AA_BLEND_AM, M or MB).
+ */
+typedef void (*aa_row_t)(const uint16_t* __restrict a, const uint16_t* __restrict b,
+                         uint16_t* __restrict out, uint32_t count, unsigned q);
+
+/**
+ * Produces one output row from a (vertically blended) source row.
+ */
+typedef void (*aa_columns_t)(const AAScaler* aa, const uint16_t* __restrict line,
+                             uint16_t* __restrict out);
+
+/**
+ * Shared row loop of scaleAA_c16/n16 and scaleAA_rows_c16/n16.
+ *
+ * Only touches destination rows y0 to y1 - 1 and the scratch line, so
+ * disjoint row ranges can run in parallel with their own scratch lines.
+ */
+static void scaleAA(const AAScaler* aa, const void* __restrict src, uint32_t sp,
+                    void* __restrict dst, uint32_t dp, uint32_t y0, uint32_t y1,
+                    uint16_t* __restrict scratch, aa_row_t blend_row,
+                    aa_columns_t blend_columns) {
+	const uint8_t* src_bytes = (const uint8_t*)src;
+	uint8_t* dst_bytes = (uint8_t*)dst;
+	if (y1 > aa->dst_h)
+		y1 = aa->dst_h;
+	if (!scratch)
+		scratch = aa->blend_line;
+
+	for (uint32_t y = y0; y < y1; y++) {
+		uint32_t sy = aa->row_src[y];
+		unsigned q = aa->row_q[y];
+		uint16_t* out = (uint16_t*)(dst_bytes + y * dp);
+
+		// Upscaling repeats rows; copy instead of blending again
+		if (y > y0 && sy == aa->row_src[y - 1] && q == aa->row_q[y - 1]) {
+			memcpy(out, dst_bytes + (y - 1) * dp, aa->dst_w * sizeof(uint16_t));
+			continue;
+		}
+
+		const uint16_t* top = (const uint16_t*)(src_bytes + sy * sp);
+		const uint16_t* next = sy + 1 < aa->src_h ? (const uint16_t*)(src_bytes + (sy + 1) * sp)
+		                                          : top;
+		const uint16_t* line = q == AA_BLEND_A ? top : next;
+		if (q != AA_BLEND_A && q != AA_BLEND_B) {
+			blend_row(top, next, scratch, aa->src_w, q);
+			line = scratch;
+		}
+		blend_columns(aa, line, out);
+	}
+}
+
+typedef uint16_t aa_vec __attribute__((vector_size(16)));
+
+static inline aa_vec aa_load(const uint16_t* src) {
+	aa_vec v;
+	memcpy(&v, src, sizeof(v));
+	return v;
+}
+
+static inline void aa_store(uint16_t* dst, aa_vec v) {
+	memcpy(dst, &v, sizeof(v));
+}
+
+static inline aa_vec aa_splat(uint16_t value) {
+	aa_vec v = {value, value, value, value, value, value, value, value};
+	return v;
+}
+
+static inline aa_vec aa_averageVec(aa_vec a, aa_vec b) {
+	return (a | b) - (((a ^ b) & aa_splat(0xF7DE)) >> aa_splat(1));
+}
+
+static void aa_blendRow_c16(const uint16_t* __restrict a, const uint16_t* __restrict b,
+                            uint16_t* __restrict out, uint32_t count, unsigned q) {
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8) {
+		aa_vec va = aa_load(a + x);
+		aa_vec vb = aa_load(b + x);
+		aa_vec m = aa_averageVec(va, vb);
+		if (q == AA_BLEND_AM)
+			m = aa_averageVec(va, m);
+		else if (q == AA_BLEND_MB)
+			m = aa_averageVec(m, vb);
+		aa_store(out + x, m);
+	}
+	for (; x < count; x++)
+		out[x] = aa_blend(a[x], b[x], q);
+}
+
+static void aa_blendColumns_c16(const AAScaler* aa, const uint16_t* __restrict line,
+                                uint16_t* __restrict out) {
+	uint32_t x = 0;
+	for (; x + 8 <= aa->dst_w; x += 8) {
+		uint16_t ga[8], gb[8];
+		for (int i = 0; i < 8; i++) {
+			ga[i] = line[aa->col_a[x + i]];
+			gb[i] = line[aa->col_b[x + i]];
+		}
+		aa_vec a = aa_load(ga);
+		aa_vec b = aa_load(gb);
+		aa_vec q = aa_load(aa->col_q + x);
+
+		aa_vec m = aa_averageVec(a, b);
+		aa_vec low = aa_averageVec(a, m);
+		aa_vec high = aa_averageVec(m, b);
+		aa_vec nested = aa_averageVec(low, m);
+
+		// Comparisons give all-ones lanes, so each candidate is masked in
+		aa_vec result = (a & (aa_vec)(q == aa_splat(AA_BLEND_A))) |
+		                (low & (aa_vec)(q == aa_splat(AA_BLEND_AM))) |
+		                (m & (aa_vec)(q == aa_splat(AA_BLEND_M))) |
+		                (high & (aa_vec)(q == aa_splat(AA_BLEND_MB))) |
+		                (b & (aa_vec)(q == aa_splat(AA_BLEND_B))) |
+		                (nested & (aa_vec)(q == aa_splat(AA_BLEND_AMM)));
+		aa_store(out + x, result);
+	}
+	for (; x < aa->dst_w; x++)
+		out[x] = aa_blend(line[aa->col_a[x]], line[aa->col_b[x]], aa->col_q[x]);
+}
+
+void scaleAA_c16(const AAScaler* aa, const void* __restrict src, uint32_t sp,
+                 void* __restrict dst, uint32_t dp) {
+	scaleAA(aa, src, sp, dst, dp, 0, aa->dst_h, NULL, aa_blendRow_c16, aa_blendColumns_c16);
+}
+
+void scaleAA_rows_c16(const AAScaler* aa, const void* __restrict src, uint32_t sp,
+                      void* __restrict dst, uint32_t dp, uint32_t y0, uint32_t y1,
+                      uint16_t* scratch) {
+	scaleAA(aa, src, sp, dst, dp, y0, y1, scratch, aa_blendRow_c16, aa_blendColumns_c16);
+}
+
+#ifdef HAS_NEON
+static inline uint16x8_t aa_averageNeon(uint16x8_t a, uint16x8_t b) {
+	uint16x8_t half = vshrq_n_u16(vandq_u16(veorq_u16(a, b), vdupq_n_u16(0xF7DE)), 1);
+	return vsubq_u16(vorrq_u16(a, b), half);
+}
+
+static void aa_blendRow_n16(const uint16_t* __restrict a, const uint16_t* __restrict b,
+                            uint16_t* __restrict out, uint32_t count, unsigned q) {
+	uint32_t x = 0;
+	for (; x + 8 <= count; x += 8) {
+		uint16x8_t va = vld1q_u16(a + x);
+		uint16x8_t vb = vld1q_u16(b + x);
+		uint16x8_t m = aa_averageNeon(va, vb);
+		if (q == AA_BLEND_AM)
+			m = aa_averageNeon(va, m);
+		else if (q == AA_BLEND_MB)
+			m = aa_averageNeon(m, vb);
+		vst1q_u16(out + x, m);
+	}
+	for (; x < count; x++)
+		out[x] = aa_blend(a[x], b[x], q);
+}
+
+static void aa_blendColumns_n16(const AAScaler* aa, const uint16_t* __restrict line,
+                                uint16_t* __restrict out) {
+	uint32_t x = 0;
+	for (; x + 8 <= aa->dst_w; x += 8) {
+		uint16_t ga[8], gb[8];
+		for (int i = 0; i < 8; i++) {
+			ga[i] = line[aa->col_a[x + i]];
+			gb[i] = line[aa->col_b[x + i]];
+		}
+		uint16x8_t a = vld1q_u16(ga);
+		uint16x8_t b = vld1q_u16(gb);
+		uint16x8_t q = vld1q_u16(aa->col_q + x);
+
+		uint16x8_t m = aa_averageNeon(a, b);
+		uint16x8_t low = aa_averageNeon(a, m);
+		uint16x8_t result = vbslq_u16(vceqq_u16(q, vdupq_n_u16(AA_BLEND_AM)), low, a);
+		result = vbslq_u16(vceqq_u16(q, vdupq_n_u16(AA_BLEND_M)), m, result);
+		result = vbslq_u16(vceqq_u16(q, vdupq_n_u16(AA_BLEND_MB)), aa_averageNeon(m, b), result);
+		result = vbslq_u16(vceqq_u16(q, vdupq_n_u16(AA_BLEND_B)), b, result);
+		result = vbslq_u16(vceqq_u16(q, vdupq_n_u16(AA_BLEND_AMM)), aa_averageNeon(low, m),
+		                   result);
+		vst1q_u16(out + x, result);
+	}
+	for (; x < aa->dst_w; x++)
+		out[x] = aa_blend(line[aa->col_a[x]], line[aa->col_b[x]], aa->col_q[x]);
+}
+
+void scaleAA_n16(const AAScaler* aa, const void* __restrict src, uint32_t sp,
+                 void* __restrict dst, uint32_t dp) {
+	scaleAA(aa, src, sp, dst, dp, 0, aa->dst_h, NULL, aa_blendRow_n16, aa_blendColumns_n16);
+}
+
+void scaleAA_rows_n16(const AAScaler* aa, const void* __restrict src, uint32_t sp,
+                      void* __restrict dst, uint32_t dp, uint32_t y0, uint32_t y1,
+                      uint16_t* scratch) {
+	scaleAA(aa, src, sp, dst, dp, y0, y1, scratch, aa_blendRow_n16, aa_blendColumns_n16);
+}
+#endif
+
+///////////////////////////////
+// Sharp bilinear scaling
+///////////////////////////////
+
+/**
+ * Per-axis sample table: output pixel i blends source pixels s0[i] and
+ * s1[i] with w[i]/32 of s1. w is only nonzero where the prescaled pixel
+ * pair straddles two source pixels.
+ */
+typedef struct SharpAxis {
+	uint32_t src;
+	uint32_t dst;
+	uint32_t prescale;
+	uint16_t* s0;
+	uint16_t* s1;
+	uint16_t* w;
+} SharpAxis;
+
+/**
+ * Fills a SharpAxis for src pixels prescaled by prescale, then sampled
+ * bilinearly at dst pixel centres.
+ */
+static int sharp_buildAxis(SharpAxis* axis, uint32_t src, uint32_t dst, uint32_t prescale) {
+	if (axis->src == src && axis->dst == dst && axis->prescale == prescale)
+		return 1;
+
+	uint16_t* tables = realloc(axis->s0, (size_t)dst * 3 * sizeof(uint16_t));
+	if (!tables) {
+		LOG_error("scaleSharpBilinear: out of memory for %u pixels", dst);
+		return 0;
+	}
+	axis->s0 = tables;
+	axis->s1 = tables + dst;
+	axis->w = tables + dst * 2;
+
+	// Output pixel centres in the prescaled image, 16.16
+	uint32_t step = (uint32_t)(((uint64_t)src * prescale << 16) / dst);
+	int64_t pos = (int64_t)(step / 2) - 0x8000;
+	for (uint32_t i = 0; i < dst; i++, pos += step) {
+		uint32_t p = pos < 0 ? 0 : (uint32_t)pos;
+		uint32_t left = p >> 16; // prescaled pixel at or left of the centre
+		uint32_t a = left / prescale;
+		uint32_t b = (left + 1) / prescale;
+		uint32_t weight = ((p & 0xFFFF) + 0x400) >> 11;
+		// Inside one source pixel (or past the edge) the prescale is flat
+		if (a == b || b >= src || !weight) {
+			b = a;
+			weight = 0;
+		}
+		axis->s0[i] = (uint16_t)a;
+		axis->s1[i] = (uint16_t)b;
+		axis->w[i] = (uint16_t)weight;
+	}
+
+	axis->src = src;
+	axis->dst = dst;
+	axis->prescale = prescale;
+	return 1;
+}
+
+/**
+ * Tables for the last size scaled; rebuilt only when the size changes.
+ */
+static SharpAxis sharp_columns;
+static SharpAxis sharp_rows;
+
+/**
+ * Blends two RGB565 pixels with weight/32 of b, rounding each channel.
+ *
+ * Spreads the channels to 0x07E0F81F so all three blend in one multiply.
+ */
+static inline uint16_t sharp_lerp(uint16_t a, uint16_t b, uint32_t weight) {
+	uint32_t ea = (a | (uint32_t)a << 16) & 0x07E0F81F;
+	uint32_t eb = (b | (uint32_t)b << 16) & 0x07E0F81F;
+	uint32_t e = ((ea * (32 - weight) + eb * weight + 0x02008010) >> 5) & 0x07E0F81F;
+	return (uint16_t)(e | e >> 16);
+}
+
+/**
+ * Produces one output row from source rows top and bottom, blended with
+ * weight/32 of bottom (0 when the row isn't on a source row boundary).
+ */
+typedef void (*sharp_row_t)(const uint16_t* __restrict top, const uint16_t* __restrict bottom,
+                            uint32_t weight, uint16_t* __restrict out);
+
+static inline uint16_t sharp_sample(const uint16_t* __restrict top,
+                                    const uint16_t* __restrict bottom, uint32_t weight,
+                                    uint32_t x) {
+	uint16_t s0 = sharp_columns.s0[x];
+	uint16_t s1 = sharp_columns.s1[x];
+	uint16_t w = sharp_columns.w[x];
+	uint16_t out = sharp_lerp(top[s0], top[s1], w);
+	if (weight)
+		out = sharp_lerp(out, sharp_lerp(bottom[s0], bottom[s1], w), weight);
+	return out;
+}
+
+/**
+ * Blends 8 RGB565 pixels per channel; same rounding as sharp_lerp().
+ */
+static inline aa_vec sharp_lerpVec(aa_vec a, aa_vec b, aa_vec weight) {
+	aa_vec inverse = aa_splat(32) - weight;
+	aa_vec half = aa_splat(16);
+	aa_vec r = ((a >> 11) * inverse + (b >> 11) * weight + half) >> 5;
+	aa_vec g = (((a >> 5) & 0x3F) * inverse + ((b >> 5) & 0x3F) * weight + half) >> 5;
+	aa_vec bl = ((a & 0x1F) * inverse + (b & 0x1F) * weight + half) >> 5;
+	return (r << 11) | (g << 5) | bl;
+}
+
+static void sharp_row_c16(const uint16_t* __restrict top, const uint16_t* __restrict bottom,
+                          uint32_t weight, uint16_t* __restrict out) {
+	uint32_t dw = sharp_columns.dst;
+	aa_vec vweight = aa_splat((uint16_t)weight);
+	uint32_t x = 0;
+	for (; x + 8 <= dw; x += 8) {
+		const uint16_t* s0 = sharp_columns.s0 + x;
+		const uint16_t* s1 = sharp_columns.s1 + x;
+		aa_vec w = aa_load(sharp_columns.w + x);
+		aa_vec a = {top[s0[0]], top[s0[1]], top[s0[2]], top[s0[3]],
+		            top[s0[4]], top[s0[5]], top[s0[6]], top[s0[7]]};
+		aa_vec b = {top[s1[0]], top[s1[1]], top[s1[2]], top[s1[3]],
+		            top[s1[4]], top[s1[5]], top[s1[6]], top[s1[7]]};
+		aa_vec result = sharp_lerpVec(a, b, w);
+		if (weight) {
+			aa_vec c = {bottom[s0[0]], bottom[s0[1]], bottom[s0[2]], bottom[s0[3]],
+			            bottom[s0[4]], bottom[s0[5]], bottom[s0[6]], bottom[s0[7]]};
+			aa_vec d = {bottom[s1[0]], bottom[s1[1]], bottom[s1[2]], bottom[s1[3]],
+			            bottom[s1[4]], bottom[s1[5]], bottom[s1[6]], bottom[s1[7]]};
+			result = sharp_lerpVec(result, sharp_lerpVec(c, d, w), vweight);
+		}
+		aa_store(out + x, result);
+	}
+	for (; x < dw; x++)
+		out[x] = sharp_sample(top, bottom, weight, x);
+}
+
+#ifdef HAS_NEON
+static inline uint16x8_t sharp_lerpNeon(uint16x8_t a, uint16x8_t b, uint16x8_t weight) {
+	uint16x8_t inverse = vsubq_u16(vdupq_n_u16(32), weight);
+	uint16x8_t mask6 = vdupq_n_u16(0x3F);
+	uint16x8_t mask5 = vdupq_n_u16(0x1F);
+	uint16x8_t r = vmlaq_u16(vmulq_u16(vshrq_n_u16(a, 11), inverse), vshrq_n_u16(b, 11), weight);
+	uint16x8_t g = vmlaq_u16(vmulq_u16(vandq_u16(vshrq_n_u16(a, 5), mask6), inverse),
+	                         vandq_u16(vshrq_n_u16(b, 5), mask6), weight);
+	uint16x8_t bl = vmlaq_u16(vmulq_u16(vandq_u16(a, mask5), inverse), vandq_u16(b, mask5), weight);
+	// Rounding shift matches the + 16 >> 5 in sharp_lerp()
+	r = vrshrq_n_u16(r, 5);
+	g = vrshrq_n_u16(g, 5);
+	bl = vrshrq_n_u16(bl, 5);
+	return vorrq_u16(vorrq_u16(vshlq_n_u16(r, 11), vshlq_n_u16(g, 5)), bl);
+}
+
+static inline uint16x8_t sharp_gatherNeon(const uint16_t* __restrict row,
+                                          const uint16_t* __restrict index) {
+	uint16_t pixels[8];
+	for (int i = 0; i < 8; i++)
+		pixels[i] = row[index[i]];
+	return vld1q_u16(pixels);
+}
+
+static void sharp_row_n16(const uint16_t* __restrict top, const uint16_t* __restrict bottom,
+                          uint32_t weight, uint16_t* __restrict out) {
+	uint32_t dw = sharp_columns.dst;
+	uint16x8_t vweight = vdupq_n_u16((uint16_t)weight);
+	uint32_t x = 0;
+	for (; x + 8 <= dw; x += 8) {
+		const uint16_t* s0 = sharp_columns.s0 + x;
+		const uint16_t* s1 = sharp_columns.s1 + x;
+		uint16x8_t w = vld1q_u16(sharp_columns.w + x);
+		uint16x8_t result = sharp_lerpNeon(sharp_gatherNeon(top, s0), sharp_gatherNeon(top, s1), w);
+		if (weight) {
+			uint16x8_t below =
+			    sharp_lerpNeon(sharp_gatherNeon(bottom, s0), sharp_gatherNeon(bottom, s1), w);
+			result = sharp_lerpNeon(result, below, vweight);
+		}
+		vst1q_u16(out + x, result);
+	}
+	for (; x < dw; x++)
+		out[x] = sharp_sample(top, bottom, weight, x);
+}
+#endif
+
+/**
+ * Shared row loop of scaleSharpBilinear_c16/n16.
+ */
+static void scaleSharpBilinear(void* __restrict src, void* __restrict dst, uint32_t sw,
+                               uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp,
+                               sharp_row_t row) {
+	if (!sw || !sh || !dw || !dh || sw > UINT16_MAX || sh > UINT16_MAX)
+		return;
+	if (!sp)
+		sp = sw * sizeof(uint16_t);
+	if (!dp)
+		dp = dw * sizeof(uint16_t);
+
+	// Largest whole multiple that fits both axes, never below 1x
+	uint32_t prescale = MIN(dw / sw, dh / sh);
+	if (!prescale)
+		prescale = 1;
+	if (!sharp_buildAxis(&sharp_columns, sw, dw, prescale) ||
+	    !sharp_buildAxis(&sharp_rows, sh, dh, prescale))
+		return;
+
+	const uint8_t* src_bytes = (const uint8_t*)src;
+	uint8_t* dst_bytes = (uint8_t*)dst;
+	for (uint32_t y = 0; y < dh; y++) {
+		uint16_t s0 = sharp_rows.s0[y];
+		uint16_t weight = sharp_rows.w[y];
+		uint16_t* out = (uint16_t*)(dst_bytes + y * dp);
+
+		// Rows inside one source row repeat the row above
+		if (y > 0 && !weight && !sharp_rows.w[y - 1] && s0 == sharp_rows.s0[y - 1]) {
+			memcpy(out, dst_bytes + (y - 1) * dp, dw * sizeof(uint16_t));
+			continue;
+		}
+
+		row((const uint16_t*)(src_bytes + s0 * sp),
+		    (const uint16_t*)(src_bytes + sharp_rows.s1[y] * sp), weight, out);
+	}
+}
+
+void scaleSharpBilinear_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,
+                            uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
+	scaleSharpBilinear(src, dst, sw, sh, sp, dw, dh, dp, sharp_row_c16);
+}
+
+#ifdef HAS_NEON
+void scaleSharpBilinear_n16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,
+                            uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp) {
+	scaleSharpBilinear(src, dst, sw, sh, sp, dw, dh, dp, sharp_row_n16);
+}
+#endif
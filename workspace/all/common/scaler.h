@@ -5,24 +5,24 @@
  * functions for RGB565 (16bpp) and RGBA8888 (32bpp) pixel formats.
  *
  * These scalers are used to upscale emulator video output to the physical
- * screen resolution. They support various integer scale factors (1x-6x)
- * in both horizontal and vertical directions.
+ * screen resolution. They support every integer scale factor from 1x to
+ * SCALER_MAX_FACTOR in both horizontal and vertical directions.
  *
  * NEON functions (scale*_n16, scale*_n32):
  *   - Available when HAS_NEON is defined
- *   - Use ARM NEON SIMD instructions for ~2-4x speedup
- *   - Require 32-bit aligned addresses and even pixel counts
- *   - Fall back to C scalers for odd dimensions
+ *   - Hand-written for factors up to 6x (1-4 vertical below 5x)
+ *   - C fallback for unaligned buffers
+ *   - scaler_find_n16/n32 return the C scaler for every other pair
  *
  * C functions (scale*_c16, scale*_c32):
- *   - Portable implementations
+ *   - Portable vector implementations (GCC vector extensions)
  *   - Work on any platform
  *   - Handle all pixel dimensions
  *
  * Function naming convention:
  *   scale<xmul>x<ymul>_[n|c][16|32]
- *   - xmul: horizontal scale factor (1-6)
- *   - ymul: vertical scale factor (1-6)
+ *   - xmul: horizontal scale factor (1-12)
+ *   - ymul: vertical scale factor (1-12)
  *   - n/c: NEON or C implementation
  *   - 16/32: bits per pixel (16=RGB565, 32=RGBA8888)
  *
@@ -35,10 +35,6 @@
  *   dw:  Destination width in pixels
  *   dh:  Destination height in pixels
  *   dp:  Destination pitch/stride in bytes (0 = auto-calculate)
- *
- * IMPORTANT: For NEON scalers with 16bpp:
- *   - X-offset and stride must be even numbers (for 32-bit alignment)
- *   - Odd dimensions automatically fall back to C scaler
  */
 
 #ifndef __SCALER_H__
@@ -54,6 +50,37 @@
 typedef void (*scaler_t)(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,
                          uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
 
+/**
+ * Largest integer scale factor on either axis.
+ */
+#define SCALER_MAX_FACTOR 12
+
+/**
+ * Integer scaler generator lists.
+ *
+ * SCALER_FOREACH_X expands M(X, T) for every horizontal factor and
+ * SCALER_FOREACH_Y expands M(X, Y, T) for every vertical factor, where T is
+ * the variant suffix (c16, c32, n16 or n32). scaler.c uses them to generate
+ * the kernels and dispatch tables; they are used here to declare them.
+ */
+#define SCALER_FOREACH_X(M, T)                                                                     \
+	M(1, T) M(2, T) M(3, T) M(4, T) M(5, T) M(6, T) M(7, T) M(8, T) M(9, T) M(10, T) M(11, T)      \
+	M(12, T)
+#define SCALER_FOREACH_Y(M, X, T)                                                                  \
+	M(X, 1, T) M(X, 2, T) M(X, 3, T) M(X, 4, T) M(X, 5, T) M(X, 6, T) M(X, 7, T) M(X, 8, T)        \
+	M(X, 9, T) M(X, 10, T) M(X, 11, T) M(X, 12, T)
+
+/**
+ * Declares scale<X>x_<T> and its fixed-factor wrappers scale<X>x<Y>_<T>.
+ */
+#define SCALER_DECLARE_X(X, T)                                                                     \
+	void scale##X##x_##T(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,     \
+	                     uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);       \
+	SCALER_FOREACH_Y(SCALER_DECLARE_XY, X, T)
+#define SCALER_DECLARE_XY(X, Y, T)                                                                 \
+	void scale##X##x##Y##_##T(void* __restrict src, void* __restrict dst, uint32_t sw,             \
+	                          uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+
 ///////////////////////////////
 // Generic scaler dispatchers
 ///////////////////////////////
@@ -62,9 +89,10 @@ typedef void (*scaler_t)(void* __restrict src, void* __restrict dst, uint32_t sw
  * Generic NEON scaler dispatcher for 16bpp (RGB565).
  *
  * Selects the appropriate NEON scaler based on scale factors.
+ * Factors outside 1-SCALER_MAX_FACTOR are ignored.
  *
- * @param xmul Horizontal scale factor (1-6)
- * @param ymul Vertical scale factor (1-4 for xmul<5, 1-5 for xmul==5, 1-6 for xmul==6)
+ * @param xmul Horizontal scale factor (1-12)
+ * @param ymul Vertical scale factor (1-12)
  * @param src Source pixel buffer
  * @param dst Destination pixel buffer
  * @param sw Source width in pixels
@@ -81,31 +109,31 @@ void scaler_n16(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __rest
 /**
  * Generic NEON scaler dispatcher for 32bpp (RGBA8888).
  *
- * Selects the appropriate NEON scaler based on scale factors.
- *
- * @param xmul Horizontal scale factor (1-6)
- * @param ymul Vertical scale factor (1-4 for xmul<5, 1-5 for xmul==5, 1-6 for xmul==6)
- * @param src Source pixel buffer
- * @param dst Destination pixel buffer
- * @param sw Source width in pixels
- * @param sh Source height in pixels
- * @param sp Source pitch in bytes (0 for auto)
- * @param dw Destination width in pixels
- * @param dh Destination height in pixels
- * @param dp Destination pitch in bytes (0 for auto)
+ * Same as scaler_n16 but for 32-bit RGBA8888 pixels.
  */
 void scaler_n32(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst,
                 uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+
+/**
+ * Looks up the NEON scaler for a pair of scale factors.
+ *
+ * @param xmul Horizontal scale factor (1-12)
+ * @param ymul Vertical scale factor (1-12)
+ * @return scale<xmul>x<ymul>_n16/n32, the C scaler for pairs without a NEON
+ *         one, or NULL if either factor is out of range
+ */
+scaler_t scaler_find_n16(uint32_t xmul, uint32_t ymul);
+scaler_t scaler_find_n32(uint32_t xmul, uint32_t ymul);
 #endif
 
 /**
  * Generic C scaler dispatcher for 16bpp (RGB565).
  *
  * Selects the appropriate C scaler based on scale factors.
- * Works on all platforms.
+ * Works on all platforms. Factors outside 1-SCALER_MAX_FACTOR are ignored.
  *
- * @param xmul Horizontal scale factor (1-6)
- * @param ymul Vertical scale factor (1-6)
+ * @param xmul Horizontal scale factor (1-12)
+ * @param ymul Vertical scale factor (1-12)
  * @param src Source pixel buffer
  * @param dst Destination pixel buffer
  * @param sw Source width in pixels
@@ -121,23 +149,21 @@ void scaler_c16(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __rest
 /**
  * Generic C scaler dispatcher for 32bpp (RGBA8888).
  *
- * Selects the appropriate C scaler based on scale factors.
- * Works on all platforms.
- *
- * @param xmul Horizontal scale factor (1-6)
- * @param ymul Vertical scale factor (1-6)
- * @param src Source pixel buffer
- * @param dst Destination pixel buffer
- * @param sw Source width in pixels
- * @param sh Source height in pixels
- * @param sp Source pitch in bytes (0 for auto)
- * @param dw Destination width in pixels
- * @param dh Destination height in pixels
- * @param dp Destination pitch in bytes (0 for auto)
+ * Same as scaler_c16 but for 32-bit RGBA8888 pixels.
  */
 void scaler_c32(uint32_t xmul, uint32_t ymul, void* __restrict src, void* __restrict dst,
                 uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
 
+/**
+ * Looks up the C scaler for a pair of scale factors.
+ *
+ * @param xmul Horizontal scale factor (1-12)
+ * @param ymul Vertical scale factor (1-12)
+ * @return scale<xmul>x<ymul>_c16/c32, or NULL if either factor is out of range
+ */
+scaler_t scaler_find_c16(uint32_t xmul, uint32_t ymul);
+scaler_t scaler_find_c32(uint32_t xmul, uint32_t ymul);
+
 ///////////////////////////////
 // NEON-optimized functions
 ///////////////////////////////
@@ -306,6 +332,7 @@ void scale6x6_n16(void* __restrict src, void* __restrict dst, uint32_t sw, uint3
                   uint32_t dw, uint32_t dh, uint32_t dp);
 void scale6x6_n32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
                   uint32_t dw, uint32_t dh, uint32_t dp);
+
 #endif
 
 ///////////////////////////////
@@ -328,150 +355,14 @@ void scale2x_c16to32(void* __restrict src, void* __restrict dst, uint32_t sw, ui
 ///////////////////////////////
 
 /**
- * C scalers with variable Y multiplier.
+ * Portable integer scalers.
  *
- * Portable implementations that work on all platforms.
- * Same functionality as NEON versions but without SIMD optimization.
+ * Same functions as the NEON versions, built on GCC vector extensions
+ * so the compiler can pick the target's own shuffles. Declared for every
+ * X and Y from 1 to SCALER_MAX_FACTOR.
  */
-void scale1x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale1x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale2x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale2x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale3x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale3x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale4x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale4x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale5x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale5x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale6x_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-void scale6x_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                 uint32_t dw, uint32_t dh, uint32_t dp, uint32_t ymul);
-
-/**
- * C scalers with fixed scale factors.
- *
- * Portable implementations with specific X and Y multipliers.
- * Same naming convention as NEON versions: scale<X>x<Y>_c<bpp>
- */
-void scale1x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale1x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale1x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale1x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale1x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale1x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale1x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale1x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale2x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale2x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale2x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale2x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale2x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale2x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale2x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale2x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale3x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale3x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale3x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale3x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale3x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale3x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale3x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale3x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale4x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale4x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale4x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale4x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale4x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale4x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale4x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale4x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale5x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale5x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale5x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale5x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale5x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale5x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale5x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale5x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale5x5_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale5x5_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x1_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x1_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x2_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x2_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x3_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x3_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x4_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x4_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x5_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x5_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x6_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
-void scale6x6_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp,
-                  uint32_t dw, uint32_t dh, uint32_t dp);
+SCALER_FOREACH_X(SCALER_DECLARE_X, c16)
+SCALER_FOREACH_X(SCALER_DECLARE_X, c32)
 
 ///////////////////////////////
 // CRT effect scalers
@@ -553,4 +444,144 @@ void rotate_n16(unsigned rotation, void* __restrict src, void* __restrict dst, u
                 uint32_t src_h, uint32_t src_p, uint32_t dst_p);
 #endif
 
+///////////////////////////////
+// Bilinear scaling
+///////////////////////////////
+
+/**
+ * Scales a 32bpp image to an arbitrary size with bilinear filtering.
+ *
+ * Fixed-point throughout: 16.16 source coordinates and 8-bit blend
+ * weights, with two channels blended per 32-bit multiply. Each output row
+ * blends its two source rows once, then every output pixel is a single
+ * horizontal blend using per-column positions computed up front. All four
+ * channels are filtered, so alpha edges stay smooth.
+ *
+ * Same signature as scaler_t. Unlike the integer scalers, dw and dh are
+ * required.
+ */
+void scaleBilinear_c32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,
+                       uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+
+#ifdef HAS_NEON
+/**
+ * NEON version of scaleBilinear_c32(), blending source rows 4 pixels at a
+ * time. Produces identical output.
+ */
+void scaleBilinear_n32(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,
+                       uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+#endif
+
+///////////////////////////////
+// Anti-aliased scaling
+///////////////////////////////
+
+/**
+ * Precomputed tables for scaleAA_c16/n16.
+ *
+ * The anti-aliased scaler (from picoarch) gives each output pixel a blend
+ * of its two nearest source pixels: all A, roughly 1/4 B, 1/2 B, 3/4 B or
+ * all B, depending on where it falls between them. Which blend and which
+ * source pair only depend on the sizes, so they are worked out once per
+ * column and per row instead of per pixel.
+ */
+typedef struct AAScaler {
+	uint32_t src_w;
+	uint32_t src_h;
+	uint32_t dst_w;
+	uint32_t dst_h;
+	uint16_t* col_a; // Per output column: left source pixel
+	uint16_t* col_b; // Per output column: right source pixel (clamped)
+	uint16_t* col_q; // Per output column: blend (see scaler.c)
+	uint16_t* row_src; // Per output row: top source row
+	uint8_t* row_q; // Per output row: blend with the next row
+	uint16_t* blend_line; // One vertically blended source row
+} AAScaler;
+
+/**
+ * Computes the tables for scaling src_w x src_h to dst_w x dst_h.
+ *
+ * @param aa Scaler to initialize; free previous tables with scaleAA_free() first
+ * @param src_w Source width in pixels
+ * @param src_h Source height in pixels
+ * @param dst_w Destination width in pixels
+ * @param dst_h Destination height in pixels
+ * @return 1 on success, 0 on invalid sizes or allocation failure
+ */
+int scaleAA_init(AAScaler* aa, uint32_t src_w, uint32_t src_h, uint32_t dst_w, uint32_t dst_h);
+
+/**
+ * Frees the tables. Safe on a zeroed or already freed scaler.
+ */
+void scaleAA_free(AAScaler* aa);
+
+/**
+ * Scales RGB565 with the blends chosen by scaleAA_init, 8 pixels at a time
+ * using GCC vector extensions.
+ *
+ * @param aa Initialized scaler
+ * @param src Source pixels (src_w x src_h)
+ * @param sp Source pitch in bytes
+ * @param dst Destination pixels (dst_w x dst_h)
+ * @param dp Destination pitch in bytes
+ */
+void scaleAA_c16(const AAScaler* aa, const void* __restrict src, uint32_t sp,
+                 void* __restrict dst, uint32_t dp);
+
+/**
+ * Scales only destination rows y0 to y1 - 1 of scaleAA_c16()'s output.
+ *
+ * Calls on disjoint row ranges may run concurrently as long as each has
+ * its own scratch line.
+ *
+ * @param dst Destination pixels (top-left of the whole frame)
+ * @param y0 First destination row
+ * @param y1 One past the last destination row
+ * @param scratch src_w pixels of scratch, or NULL to use the scaler's own
+ */
+void scaleAA_rows_c16(const AAScaler* aa, const void* __restrict src, uint32_t sp,
+                      void* __restrict dst, uint32_t dp, uint32_t y0, uint32_t y1,
+                      uint16_t* scratch);
+
+#ifdef HAS_NEON
+/**
+ * NEON versions of scaleAA_c16() and scaleAA_rows_c16(). Produce identical output.
+ */
+void scaleAA_n16(const AAScaler* aa, const void* __restrict src, uint32_t sp,
+                 void* __restrict dst, uint32_t dp);
+void scaleAA_rows_n16(const AAScaler* aa, const void* __restrict src, uint32_t sp,
+                      void* __restrict dst, uint32_t dp, uint32_t y0, uint32_t y1,
+                      uint16_t* scratch);
+#endif
+
+///////////////////////////////
+// Sharp bilinear scaling
+///////////////////////////////
+
+/**
+ * Scales RGB565 to an arbitrary size with sharp bilinear filtering.
+ *
+ * Equivalent to a nearest neighbor prescale by the largest whole factor
+ * that fits, followed by a bilinear pass down to dw x dh, but fused: each
+ * output pixel samples the source directly, so no prescaled image is ever
+ * written. Pixels stay square and crisp, and only the seams between source
+ * pixels are blended, which hides the uneven pixel widths (shimmer) of a
+ * plain nearest neighbor scale. Blend weights are 5-bit and every channel
+ * is rounded.
+ *
+ * Same signature as scaler_t. Unlike the integer scalers, dw and dh are
+ * required. The sample tables are kept between calls and rebuilt when the
+ * size changes, so this is not reentrant.
+ */
+void scaleSharpBilinear_c16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,
+                            uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+
+#ifdef HAS_NEON
+/**
+ * NEON version of scaleSharpBilinear_c16(). Produces identical output.
+ */
+void scaleSharpBilinear_n16(void* __restrict src, void* __restrict dst, uint32_t sw, uint32_t sh,
+                            uint32_t sp, uint32_t dw, uint32_t dh, uint32_t dp);
+#endif
+
 #endif
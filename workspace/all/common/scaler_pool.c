@@ -0,0 +1,382 @@
+/**
+ * scaler_pool.c - Row-parallel scaling on a persistent worker pool
+ */
+
+#include "scaler_pool.h"
+#include "defines.h" // for HAS_NEON
+#include "log.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Pool state. Workers sleep on start until generation changes, run their
+ * band if it exists, and the last one to finish signals done.
+ */
+static struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t start;
+	pthread_cond_t done;
+	pthread_mutex_t busy; // Held by the thread running a job
+	pthread_t workers[SCALER_POOL_MAX_THREADS - 1];
+	int worker_count; // Workers running
+	int threads; // Cached ScalerPool_threads(), 0 until known
+	int failed; // Workers couldn't be started; stay single-threaded
+	unsigned generation; // Bumped for every job and for quit
+	unsigned spawn_generation; // generation when the workers were started
+	int quit;
+	ScalerPoolJob job;
+	void* ctx;
+	int bands;
+	int pending; // Worker bands still running
+} pool = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .start = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .busy = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static uint64_t ScalerPool_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Identifies a workload for a gate (FNV-1a over the fields).
+ */
+uint64_t ScalerPool_key(uint32_t src_w, uint32_t src_h, uint32_t dst_w, uint32_t dst_h,
+                        uintptr_t variant) {
+	uint64_t fields[5] = {src_w, src_h, dst_w, dst_h, (uint64_t)variant};
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (int i = 0; i < 5; i++) {
+		hash ^= fields[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash ? hash : 1;
+}
+
+int ScalerPool_threads(void) {
+	if (!pool.threads) {
+		long cores = sysconf(_SC_NPROCESSORS_ONLN);
+		pool.threads = cores < 1 ? 1 : cores > SCALER_POOL_MAX_THREADS ? SCALER_POOL_MAX_THREADS
+		                                                                : (int)cores;
+	}
+	return pool.threads;
+}
+
+void ScalerPool_setThreads(int threads) {
+	ScalerPool_quit();
+	pool.failed = 0;
+	if (threads < 0)
+		threads = 1;
+	if (threads > SCALER_POOL_MAX_THREADS)
+		threads = SCALER_POOL_MAX_THREADS;
+	pool.threads = threads; // 0 is counted again by ScalerPool_threads
+}
+
+/**
+ * Worker loop. index is the worker's band when a job has enough bands.
+ */
+static void* ScalerPool_worker(void* arg) {
+	int index = (int)(intptr_t)arg;
+	pthread_mutex_lock(&pool.mutex);
+	unsigned seen = pool.spawn_generation;
+	while (1) {
+		while (pool.generation == seen)
+			pthread_cond_wait(&pool.start, &pool.mutex);
+		seen = pool.generation;
+		if (pool.quit)
+			break;
+		if (index >= pool.bands)
+			continue;
+
+		ScalerPoolJob job = pool.job;
+		void* ctx = pool.ctx;
+		int bands = pool.bands;
+		pthread_mutex_unlock(&pool.mutex);
+		job(ctx, index, bands);
+		pthread_mutex_lock(&pool.mutex);
+		if (--pool.pending == 0)
+			pthread_cond_signal(&pool.done);
+	}
+	pthread_mutex_unlock(&pool.mutex);
+	return NULL;
+}
+
+/**
+ * Starts the workers if they aren't running.
+ *
+ * @return 1 if workers are available
+ */
+static int ScalerPool_start(void) {
+	if (pool.worker_count)
+		return 1;
+	if (pool.failed || ScalerPool_threads() < 2)
+		return 0;
+
+	pool.quit = 0;
+	pool.spawn_generation = pool.generation;
+	for (int i = 1; i < pool.threads; i++) {
+		if (pthread_create(&pool.workers[i - 1], NULL, ScalerPool_worker, (void*)(intptr_t)i) !=
+		    0) {
+			LOG_warn("Scaler pool: unable to start worker %i, staying single-threaded", i);
+			ScalerPool_quit();
+			pool.failed = 1;
+			return 0;
+		}
+		pool.worker_count = i;
+	}
+	LOG_info("Scaler pool: started %i workers", pool.worker_count);
+	return 1;
+}
+
+/**
+ * Runs every band on the calling thread.
+ */
+static void ScalerPool_runSerial(ScalerPoolJob job, void* ctx, int bands) {
+	for (int band = 0; band < bands; band++)
+		job(ctx, band, bands);
+}
+
+void ScalerPool_run(ScalerPoolJob job, void* ctx, int bands) {
+	if (bands < 1)
+		bands = 1;
+	if (bands > ScalerPool_threads())
+		bands = pool.threads;
+	if (bands < 2 || pthread_mutex_trylock(&pool.busy) != 0) {
+		ScalerPool_runSerial(job, ctx, bands);
+		return;
+	}
+	if (!ScalerPool_start()) {
+		pthread_mutex_unlock(&pool.busy);
+		ScalerPool_runSerial(job, ctx, bands);
+		return;
+	}
+
+	pthread_mutex_lock(&pool.mutex);
+	pool.job = job;
+	pool.ctx = ctx;
+	pool.bands = bands;
+	pool.pending = bands - 1;
+	pool.generation += 1;
+	pthread_cond_broadcast(&pool.start);
+	pthread_mutex_unlock(&pool.mutex);
+
+	job(ctx, 0, bands);
+
+	pthread_mutex_lock(&pool.mutex);
+	while (pool.pending > 0)
+		pthread_cond_wait(&pool.done, &pool.mutex);
+	pthread_mutex_unlock(&pool.mutex);
+	pthread_mutex_unlock(&pool.busy);
+}
+
+void ScalerPool_quit(void) {
+	if (!pool.worker_count)
+		return;
+
+	pthread_mutex_lock(&pool.mutex);
+	pool.quit = 1;
+	pool.generation += 1;
+	pthread_cond_broadcast(&pool.start);
+	pthread_mutex_unlock(&pool.mutex);
+
+	for (int i = 0; i < pool.worker_count; i++)
+		pthread_join(pool.workers[i], NULL);
+	pool.worker_count = 0;
+}
+
+///////////////////////////////
+// Gate
+///////////////////////////////
+
+#define SCALER_POOL_MEASURE_FRAMES (SCALER_POOL_WARMUP_FRAMES + 2 * SCALER_POOL_SAMPLE_FRAMES)
+
+int ScalerPoolGate_bands(ScalerPoolGate* gate, uint64_t key, int threads) {
+	if (threads < 2)
+		return 1;
+	if (gate->key != key ||
+	    gate->frames >= SCALER_POOL_MEASURE_FRAMES + SCALER_POOL_RECHECK_FRAMES) {
+		gate->key = key;
+		gate->frames = 0;
+		gate->serial_us = 0;
+		gate->threaded_us = 0;
+	}
+	// Alternate while measuring so both sides see the same conditions
+	if (gate->frames < SCALER_POOL_MEASURE_FRAMES)
+		return (gate->frames & 1) ? threads : 1;
+	return gate->threaded ? threads : 1;
+}
+
+void ScalerPoolGate_record(ScalerPoolGate* gate, int bands, uint64_t elapsed_us) {
+	if (gate->frames >= SCALER_POOL_WARMUP_FRAMES && gate->frames < SCALER_POOL_MEASURE_FRAMES) {
+		if (bands > 1)
+			gate->threaded_us += elapsed_us;
+		else
+			gate->serial_us += elapsed_us;
+	}
+	gate->frames += 1;
+
+	if (gate->frames == SCALER_POOL_MEASURE_FRAMES) {
+		int threaded = gate->threaded_us * 100 < gate->serial_us * (100 - SCALER_POOL_MIN_GAIN);
+		if (threaded != gate->threaded)
+			LOG_info("Scaler pool: %s (%llu us serial, %llu us in bands over %i frames)",
+			         threaded ? "splitting into bands" : "single-threaded",
+			         (unsigned long long)gate->serial_us, (unsigned long long)gate->threaded_us,
+			         SCALER_POOL_SAMPLE_FRAMES);
+		gate->threaded = threaded;
+	}
+}
+
+void ScalerPool_dispatch(ScalerPoolGate* gate, uint64_t key, ScalerPoolJob job, void* ctx) {
+	int bands = ScalerPoolGate_bands(gate, key, ScalerPool_threads());
+	uint64_t start = ScalerPool_now();
+	ScalerPool_run(job, ctx, bands);
+	ScalerPoolGate_record(gate, bands, ScalerPool_now() - start);
+}
+
+///////////////////////////////
+// Jobs
+///////////////////////////////
+
+/**
+ * First row of band out of bands when splitting rows as evenly as possible.
+ */
+static uint32_t ScalerPool_bandStart(uint32_t rows, int band, int bands) {
+	return (uint32_t)((uint64_t)rows * band / bands);
+}
+
+typedef struct ScaleJob {
+	scaler_t scaler;
+	uint8_t* src;
+	uint8_t* dst;
+	uint32_t sw;
+	uint32_t sh;
+	uint32_t sp;
+	uint32_t dw;
+	uint32_t dp;
+	uint32_t ymul;
+} ScaleJob;
+
+static void ScalerPool_scaleBand(void* ctx, int band, int bands) {
+	ScaleJob* job = ctx;
+	uint32_t y0 = ScalerPool_bandStart(job->sh, band, bands);
+	uint32_t y1 = ScalerPool_bandStart(job->sh, band + 1, bands);
+	if (y1 > y0)
+		job->scaler(job->src + y0 * job->sp, job->dst + y0 * job->ymul * job->dp, job->sw,
+		            y1 - y0, job->sp, job->dw, (y1 - y0) * job->ymul, job->dp);
+}
+
+void ScalerPool_scale(ScalerPoolGate* gate, scaler_t scaler, uint32_t ymul, void* __restrict src,
+                      void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw,
+                      uint32_t dh, uint32_t dp) {
+	// scale1x_line works on pairs of source rows, which a band could split
+	if (!ymul || !sp || !dp || scaler == scale1x_line) {
+		scaler(src, dst, sw, sh, sp, dw, dh, dp);
+		return;
+	}
+	ScaleJob job = {scaler, src, dst, sw, sh, sp, dw, dp, ymul};
+	ScalerPool_dispatch(gate, ScalerPool_key(sw, sh, dw, dh, (uintptr_t)scaler),
+	                    ScalerPool_scaleBand, &job);
+}
+
+typedef struct RotateJob {
+	unsigned rotation;
+	uint8_t* src;
+	uint8_t* dst;
+	uint32_t src_w;
+	uint32_t src_h;
+	uint32_t src_p;
+	uint32_t dst_p;
+} RotateJob;
+
+static void ScalerPool_rotateBand(void* ctx, int band, int bands) {
+	RotateJob* job = ctx;
+	uint32_t y0 = ScalerPool_bandStart(job->src_h, band, bands);
+	uint32_t y1 = ScalerPool_bandStart(job->src_h, band + 1, bands);
+	if (y1 <= y0)
+		return;
+
+	// Where source rows y0..y1 land in the full rotation
+	uint8_t* dst = job->dst;
+	switch (job->rotation) {
+	case ROTATION_90:
+		dst += y0 * sizeof(uint16_t); // source rows become columns
+		break;
+	case ROTATION_180:
+		dst += (job->src_h - y1) * job->dst_p;
+		break;
+	case ROTATION_270:
+		dst += (job->src_h - y1) * sizeof(uint16_t);
+		break;
+	default:
+		dst += y0 * job->dst_p;
+		break;
+	}
+#ifdef HAS_NEON
+	rotate_n16(job->rotation, job->src + y0 * job->src_p, dst, job->src_w, y1 - y0, job->src_p,
+	           job->dst_p);
+#else
+	rotate_c16(job->rotation, job->src + y0 * job->src_p, dst, job->src_w, y1 - y0, job->src_p,
+	           job->dst_p);
+#endif
+}
+
+void ScalerPool_rotate(ScalerPoolGate* gate, unsigned rotation, void* __restrict src,
+                       void* __restrict dst, uint32_t src_w, uint32_t src_h, uint32_t src_p,
+                       uint32_t dst_p) {
+	int swapped = rotation == ROTATION_90 || rotation == ROTATION_270;
+	if (!src_p)
+		src_p = src_w * sizeof(uint16_t);
+	if (!dst_p)
+		dst_p = (swapped ? src_h : src_w) * sizeof(uint16_t);
+
+	RotateJob job = {rotation, src, dst, src_w, src_h, src_p, dst_p};
+	ScalerPool_dispatch(gate, ScalerPool_key(src_w, src_h, src_p, dst_p, rotation),
+	                    ScalerPool_rotateBand, &job);
+}
+
+typedef struct AAJob {
+	const AAScaler* aa;
+	const void* src;
+	uint32_t sp;
+	void* dst;
+	uint32_t dp;
+	uint16_t* scratch; // src_w pixels per band after the first
+} AAJob;
+
+static void ScalerPool_scaleAABand(void* ctx, int band, int bands) {
+	AAJob* job = ctx;
+	uint32_t y0 = ScalerPool_bandStart(job->aa->dst_h, band, bands);
+	uint32_t y1 = ScalerPool_bandStart(job->aa->dst_h, band + 1, bands);
+	uint16_t* scratch = band ? job->scratch + (band - 1) * job->aa->src_w : NULL;
+#ifdef HAS_NEON
+	scaleAA_rows_n16(job->aa, job->src, job->sp, job->dst, job->dp, y0, y1, scratch);
+#else
+	scaleAA_rows_c16(job->aa, job->src, job->sp, job->dst, job->dp, y0, y1, scratch);
+#endif
+}
+
+void ScalerPool_scaleAA(ScalerPoolGate* gate, const AAScaler* aa, const void* __restrict src,
+                        uint32_t sp, void* __restrict dst, uint32_t dp) {
+	static uint16_t* scratch = NULL;
+	static uint32_t scratch_w = 0;
+
+	if (ScalerPool_threads() > 1 && scratch_w < aa->src_w) {
+		uint16_t* grown =
+		    realloc(scratch, (size_t)aa->src_w * (SCALER_POOL_MAX_THREADS - 1) * sizeof(uint16_t));
+		if (grown) {
+			scratch = grown;
+			scratch_w = aa->src_w;
+		}
+	}
+	AAJob job = {aa, src, sp, dst, dp, scratch};
+	if (scratch_w < aa->src_w) {
+		ScalerPool_scaleAABand(&job, 0, 1);
+		return;
+	}
+	ScalerPool_dispatch(gate, ScalerPool_key(aa->src_w, aa->src_h, aa->dst_w, aa->dst_h, 0),
+	                    ScalerPool_scaleAABand, &job);
+}
@@ -0,0 +1,166 @@
+/**
+ * scaler_pool.h - Row-parallel scaling on a persistent worker pool
+ *
+ * Splits a blit into horizontal bands and runs one band per core. Workers
+ * are created once, on the first frame that wants them, and then park on a
+ * condition variable between frames; each frame is one fork/join: publish
+ * the job, run band 0 on the calling thread, wait for the rest.
+ *
+ * Splitting only pays off when a frame is big enough to outweigh the wake
+ * and join cost, and the answer depends on the device, resolution and
+ * scaler. So every call site owns a ScalerPoolGate: for the first
+ * frames of each workload it alternates single-threaded and banded runs,
+ * times both, and keeps the bands only if they were at least
+ * SCALER_POOL_MIN_GAIN percent faster. The workload is re-measured every
+ * SCALER_POOL_RECHECK_FRAMES frames (CPU speed may have changed).
+ *
+ * On single-core devices everything runs on the calling thread.
+ *
+ * This module has no SDL dependency.
+ */
+
+#ifndef __SCALER_POOL_H__
+#define __SCALER_POOL_H__
+
+#include <stdint.h>
+
+#include "scaler.h"
+
+#define SCALER_POOL_MAX_THREADS 4 // Bands per frame, including the calling thread
+#define SCALER_POOL_WARMUP_FRAMES 2 // Frames run but not timed when measuring
+#define SCALER_POOL_SAMPLE_FRAMES 16 // Timed frames each way when measuring
+#define SCALER_POOL_MIN_GAIN 10 // Percent faster bands must be to be kept
+#define SCALER_POOL_RECHECK_FRAMES 3600 // Frames between measurements
+
+/**
+ * One band of a job: do the share of the work numbered band out of bands.
+ */
+typedef void (*ScalerPoolJob)(void* ctx, int band, int bands);
+
+/**
+ * Per call site measurement. Zero-initialize before first use.
+ */
+typedef struct ScalerPoolGate {
+	uint64_t key; // Workload being measured (ScalerPool_key)
+	int frames; // Frames since measuring started
+	uint64_t serial_us; // Total time of timed single-threaded frames
+	uint64_t threaded_us; // Total time of timed banded frames
+	int threaded; // 1 if bands measured faster
+} ScalerPoolGate;
+
+/**
+ * Identifies a workload for a gate.
+ *
+ * @param src_w Source width
+ * @param src_h Source height
+ * @param dst_w Destination width
+ * @param dst_h Destination height
+ * @param variant Anything else that changes the cost (scaler, rotation...)
+ * @return Key, never 0
+ */
+uint64_t ScalerPool_key(uint32_t src_w, uint32_t src_h, uint32_t dst_w, uint32_t dst_h,
+                        uintptr_t variant);
+
+/**
+ * Number of bands a frame can be split into (online cores, capped at
+ * SCALER_POOL_MAX_THREADS).
+ */
+int ScalerPool_threads(void);
+
+/**
+ * Overrides the number of bands instead of counting cores, stopping the
+ * workers first. Lets tests split frames on single-core machines.
+ *
+ * @param threads Bands per frame (clamped to 1..SCALER_POOL_MAX_THREADS),
+ *                or 0 to count cores again
+ */
+void ScalerPool_setThreads(int threads);
+
+/**
+ * Runs job(ctx, band, bands) for every band and returns when all are done.
+ *
+ * Band 0 runs on the calling thread. Starts the workers on first use.
+ * Falls back to running every band on the calling thread if the workers
+ * can't be started or another thread is already running a job.
+ *
+ * @param bands Number of bands (clamped to ScalerPool_threads())
+ */
+void ScalerPool_run(ScalerPoolJob job, void* ctx, int bands);
+
+/**
+ * Stops the workers. The next ScalerPool_run starts them again.
+ */
+void ScalerPool_quit(void);
+
+/**
+ * Picks the number of bands for the next frame of a workload.
+ *
+ * A new key (or SCALER_POOL_RECHECK_FRAMES frames on the old one) starts
+ * a new measurement.
+ *
+ * @param gate Call site's gate
+ * @param key Workload key
+ * @param threads Bands available (ScalerPool_threads())
+ * @return 1 to run on the calling thread, otherwise threads
+ */
+int ScalerPoolGate_bands(ScalerPoolGate* gate, uint64_t key, int threads);
+
+/**
+ * Records how long a frame took with the bands ScalerPoolGate_bands chose.
+ *
+ * @param gate Call site's gate
+ * @param bands Bands the frame ran with
+ * @param elapsed_us Frame time in microseconds
+ */
+void ScalerPoolGate_record(ScalerPoolGate* gate, int bands, uint64_t elapsed_us);
+
+/**
+ * Runs a job with the bands its gate chooses and times it.
+ *
+ * @param gate Call site's gate
+ * @param key Workload key
+ * @param job Job to run
+ * @param ctx Job context
+ */
+void ScalerPool_dispatch(ScalerPoolGate* gate, uint64_t key, ScalerPoolJob job, void* ctx);
+
+/**
+ * Runs an integer scaler_t in source row bands.
+ *
+ * Source rows y0..y1 of each band become destination rows y0 * ymul to
+ * y1 * ymul, so any scaler that repeats each source row exactly ymul
+ * times can be split (the scale*x* and effect scalers). Scalers that
+ * don't (ymul of 0, scale1x_line), and calls with either pitch 0, run
+ * directly. Each band is passed (y1 - y0) * ymul as its height, so dh may
+ * be larger than sh * ymul (minarch passes the screen height).
+ *
+ * @param gate Call site's gate
+ * @param scaler Scaler to run
+ * @param ymul Vertical scale factor of the scaler, or 0
+ * @param src,dst,sw,sh,sp,dw,dh,dp As for scaler_t
+ */
+void ScalerPool_scale(ScalerPoolGate* gate, scaler_t scaler, uint32_t ymul, void* __restrict src,
+                      void* __restrict dst, uint32_t sw, uint32_t sh, uint32_t sp, uint32_t dw,
+                      uint32_t dh, uint32_t dp);
+
+/**
+ * Runs rotate_n16 (rotate_c16 without NEON) in source row bands.
+ *
+ * @param gate Call site's gate
+ * @param rotation,src,dst,src_w,src_h,src_p,dst_p As for rotate_c16
+ */
+void ScalerPool_rotate(ScalerPoolGate* gate, unsigned rotation, void* __restrict src,
+                       void* __restrict dst, uint32_t src_w, uint32_t src_h, uint32_t src_p,
+                       uint32_t dst_p);
+
+/**
+ * Runs scaleAA_rows_n16 (scaleAA_rows_c16 without NEON) in destination
+ * row bands, each with its own scratch line.
+ *
+ * @param gate Call site's gate
+ * @param aa,src,sp,dst,dp As for scaleAA_c16
+ */
+void ScalerPool_scaleAA(ScalerPoolGate* gate, const AAScaler* aa, const void* __restrict src,
+                        uint32_t sp, void* __restrict dst, uint32_t dp);
+
+#endif // __SCALER_POOL_H__
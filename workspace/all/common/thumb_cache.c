@@ -0,0 +1,193 @@
+/**
+ * thumb_cache.c - Bounded LRU cache for decoded thumbnails
+ *
+ * Doubly-linked list ordered by recency. Lookups are a linear scan, which is
+ * fine because the byte budget keeps the cache to a few dozen entries.
+ */
+
+#include "thumb_cache.h"
+#include "log.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Bytes charged for an entry on top of its data.
+ *
+ * Keeps negative (NULL) entries from being free so the cache can't grow
+ * without bound while scrolling through a folder with no thumbnails.
+ */
+static size_t ThumbCache_overhead(const char* key) {
+	return sizeof(ThumbCacheEntry) + strlen(key) + 1;
+}
+
+/**
+ * Finds an entry by key.
+ */
+static ThumbCacheEntry* ThumbCache_find(ThumbCache* self, const char* key) {
+	for (ThumbCacheEntry* entry = self->head; entry; entry = entry->next) {
+		if (strcmp(entry->key, key) == 0)
+			return entry;
+	}
+	return NULL;
+}
+
+/**
+ * Detaches an entry from the LRU list.
+ */
+static void ThumbCache_unlink(ThumbCache* self, ThumbCacheEntry* entry) {
+	if (entry->prev)
+		entry->prev->next = entry->next;
+	else
+		self->head = entry->next;
+
+	if (entry->next)
+		entry->next->prev = entry->prev;
+	else
+		self->tail = entry->prev;
+
+	entry->prev = NULL;
+	entry->next = NULL;
+}
+
+/**
+ * Inserts a detached entry at the most recently used position.
+ */
+static void ThumbCache_pushFront(ThumbCache* self, ThumbCacheEntry* entry) {
+	entry->prev = NULL;
+	entry->next = self->head;
+	if (self->head)
+		self->head->prev = entry;
+	self->head = entry;
+	if (!self->tail)
+		self->tail = entry;
+}
+
+/**
+ * Unlinks and releases an entry.
+ */
+static void ThumbCache_remove(ThumbCache* self, ThumbCacheEntry* entry) {
+	ThumbCache_unlink(self, entry);
+	self->bytes -= entry->bytes;
+	self->count -= 1;
+	if (entry->data && self->free_fn)
+		self->free_fn(entry->data);
+	free(entry->key);
+	free(entry);
+}
+
+/**
+ * Evicts least recently used entries until the cache fits its budget.
+ *
+ * @param keep Entry that must survive (the one just inserted)
+ */
+static void ThumbCache_evict(ThumbCache* self, ThumbCacheEntry* keep) {
+	ThumbCacheEntry* entry = self->tail;
+	while (self->bytes > self->budget && entry) {
+		ThumbCacheEntry* prev = entry->prev;
+		int pinned = self->pinned && strcmp(entry->key, self->pinned) == 0;
+		if (entry != keep && !pinned)
+			ThumbCache_remove(self, entry);
+		entry = prev;
+	}
+}
+
+/**
+ * Creates a new empty cache.
+ */
+ThumbCache* ThumbCache_new(size_t budget, ThumbCache_FreeFunc free_fn) {
+	ThumbCache* self = malloc(sizeof(ThumbCache));
+	if (!self)
+		return NULL;
+
+	self->head = NULL;
+	self->tail = NULL;
+	self->count = 0;
+	self->bytes = 0;
+	self->budget = budget;
+	self->pinned = NULL;
+	self->free_fn = free_fn;
+	return self;
+}
+
+/**
+ * Frees the cache and releases every cached value.
+ */
+void ThumbCache_free(ThumbCache* self) {
+	if (!self)
+		return;
+
+	ThumbCache_clear(self);
+	free(self->pinned);
+	free(self);
+}
+
+/**
+ * Looks up a key and marks it most recently used.
+ */
+int ThumbCache_get(ThumbCache* self, const char* key, void** data) {
+	ThumbCacheEntry* entry = ThumbCache_find(self, key);
+	if (!entry)
+		return 0;
+
+	if (entry != self->head) {
+		ThumbCache_unlink(self, entry);
+		ThumbCache_pushFront(self, entry);
+	}
+
+	if (data)
+		*data = entry->data;
+	return 1;
+}
+
+/**
+ * Checks whether a key is cached without touching LRU order.
+ */
+int ThumbCache_has(ThumbCache* self, const char* key) {
+	return ThumbCache_find(self, key) != NULL;
+}
+
+/**
+ * Inserts (or replaces) a value, then evicts down to the budget.
+ */
+int ThumbCache_put(ThumbCache* self, const char* key, void* data, size_t bytes) {
+	ThumbCacheEntry* existing = ThumbCache_find(self, key);
+	if (existing)
+		ThumbCache_remove(self, existing);
+
+	ThumbCacheEntry* entry = malloc(sizeof(ThumbCacheEntry));
+	char* key_copy = strdup(key);
+	if (!entry || !key_copy) {
+		LOG_error("Failed to allocate thumbnail cache entry for %s", key);
+		free(entry);
+		free(key_copy);
+		if (data && self->free_fn)
+			self->free_fn(data);
+		return 0;
+	}
+
+	entry->key = key_copy;
+	entry->data = data;
+	entry->bytes = bytes + ThumbCache_overhead(key);
+	ThumbCache_pushFront(self, entry);
+	self->bytes += entry->bytes;
+	self->count += 1;
+
+	ThumbCache_evict(self, entry);
+	return 1;
+}
+
+/**
+ * Protects one key from eviction (NULL to unpin).
+ */
+void ThumbCache_pin(ThumbCache* self, const char* key) {
+	free(self->pinned);
+	self->pinned = key ? strdup(key) : NULL;
+}
+
+/**
+ * Removes and releases every entry.
+ */
+void ThumbCache_clear(ThumbCache* self) {
+	while (self->head)
+		ThumbCache_remove(self, self->head);
+}
@@ -0,0 +1,128 @@
+/**
+ * thumb_cache.h - Bounded LRU cache for decoded thumbnails
+ *
+ * Keeps recently decoded (and pre-scaled) thumbnails in memory so that
+ * scrolling back and forth through a folder doesn't re-decode the same PNGs.
+ *
+ * The cache is keyed by path and bounded by a byte budget. Values are opaque
+ * pointers (SDL surfaces in minui) released through a caller-supplied free
+ * function, which keeps this module free of SDL and easy to test.
+ *
+ * A NULL value is a valid entry meaning "no thumbnail exists for this path",
+ * so negative lookups are cached too and don't hit the filesystem again.
+ *
+ * Not thread-safe: all calls must come from the same thread (the UI thread).
+ * Background loaders hand results back to that thread for insertion.
+ */
+
+#ifndef __THUMB_CACHE_H__
+#define __THUMB_CACHE_H__
+
+#include <stddef.h>
+
+/**
+ * Function used to release a cached value when it is evicted or replaced.
+ */
+typedef void (*ThumbCache_FreeFunc)(void* data);
+
+/**
+ * A single cached thumbnail (node in the LRU list).
+ */
+typedef struct ThumbCacheEntry {
+	char* key; // Thumbnail path
+	void* data; // Decoded thumbnail, or NULL if none exists
+	size_t bytes; // Accounted size (data + bookkeeping)
+	struct ThumbCacheEntry* prev; // Towards most recently used
+	struct ThumbCacheEntry* next; // Towards least recently used
+} ThumbCacheEntry;
+
+/**
+ * LRU cache with a memory budget.
+ */
+typedef struct ThumbCache {
+	ThumbCacheEntry* head; // Most recently used
+	ThumbCacheEntry* tail; // Least recently used
+	int count; // Number of entries
+	size_t bytes; // Total accounted bytes
+	size_t budget; // Maximum bytes before eviction
+	char* pinned; // Key that must never be evicted (currently displayed), or NULL
+	ThumbCache_FreeFunc free_fn; // Releases evicted values (may be NULL)
+} ThumbCache;
+
+/**
+ * Creates a new empty cache.
+ *
+ * @param budget Maximum number of bytes to keep cached
+ * @param free_fn Function to release values (NULL if values need no cleanup)
+ * @return Pointer to allocated ThumbCache, or NULL on allocation failure
+ *
+ * @warning Caller must free with ThumbCache_free()
+ */
+ThumbCache* ThumbCache_new(size_t budget, ThumbCache_FreeFunc free_fn);
+
+/**
+ * Frees the cache and releases every cached value.
+ *
+ * @param self Cache to free (may be NULL)
+ */
+void ThumbCache_free(ThumbCache* self);
+
+/**
+ * Looks up a key and marks it most recently used.
+ *
+ * @param self Cache to search
+ * @param key Thumbnail path
+ * @param data Output: cached value (NULL if path has no thumbnail), may be NULL
+ * @return 1 if the key is cached, 0 otherwise
+ */
+int ThumbCache_get(ThumbCache* self, const char* key, void** data);
+
+/**
+ * Checks whether a key is cached without changing its LRU position.
+ *
+ * Used when deciding what to prefetch, so that probing neighbors
+ * doesn't keep them alive longer than the entries actually shown.
+ *
+ * @param self Cache to search
+ * @param key Thumbnail path
+ * @return 1 if the key is cached, 0 otherwise
+ */
+int ThumbCache_has(ThumbCache* self, const char* key);
+
+/**
+ * Inserts (or replaces) a value and evicts least recently used entries
+ * until the cache fits its budget again.
+ *
+ * The cache takes ownership of data. The newly inserted entry and the
+ * pinned entry are never evicted, even if together they exceed the budget.
+ *
+ * @param self Cache to modify
+ * @param key Thumbnail path (copied)
+ * @param data Decoded thumbnail, or NULL to record that none exists
+ * @param bytes Size of data in bytes (0 for NULL data)
+ * @return 1 on success, 0 on allocation failure (data is released)
+ */
+int ThumbCache_put(ThumbCache* self, const char* key, void* data, size_t bytes);
+
+/**
+ * Protects one key from eviction.
+ *
+ * Pin the thumbnail currently on screen so inserting prefetched neighbors
+ * can't free a surface that is still being blitted. The key doesn't need
+ * to be cached yet. Only one key can be pinned at a time.
+ *
+ * @param self Cache to modify
+ * @param key Thumbnail path to protect, or NULL to unpin
+ */
+void ThumbCache_pin(ThumbCache* self, const char* key);
+
+/**
+ * Removes and releases every entry.
+ *
+ * The pinned key is kept so it still applies to later insertions.
+ *
+ * @param self Cache to clear
+ */
+void ThumbCache_clear(ThumbCache* self);
+
+#endif // __THUMB_CACHE_H__
@@ -0,0 +1,139 @@
+/**
+ * thumb_store.c - Persistent cache of pre-scaled thumbnails
+ *
+ * One file per source image: fixed header, source path, raw pixels.
+ * Uses plain read()/write() so a hit costs exactly three syscalls
+ * after open (header, path, pixels).
+ */
+
+#include "thumb_store.h"
+#include "log.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * 64-bit FNV-1a hash of a string.
+ */
+static uint64_t ThumbStore_hash(const char* str) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	while (*str) {
+		hash ^= (unsigned char)*str++;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/**
+ * Reads exactly size bytes, retrying on short reads.
+ */
+static int ThumbStore_readAll(int fd, void* buffer, size_t size) {
+	char* dst = buffer;
+	while (size > 0) {
+		ssize_t count = read(fd, dst, size);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return 0;
+		dst += count;
+		size -= (size_t)count;
+	}
+	return 1;
+}
+
+/**
+ * Writes exactly size bytes, retrying on short writes.
+ */
+static int ThumbStore_writeAll(int fd, const void* buffer, size_t size) {
+	const char* src = buffer;
+	while (size > 0) {
+		ssize_t count = write(fd, src, size);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return 0;
+		src += count;
+		size -= (size_t)count;
+	}
+	return 1;
+}
+
+/**
+ * Builds the cache file path for a source image.
+ */
+int ThumbStore_getPath(char* out, size_t out_size, const char* dir, const char* src_path) {
+	int len = snprintf(out, out_size, "%s/%016llx.thumb", dir,
+	                   (unsigned long long)ThumbStore_hash(src_path));
+	return len > 0 && (size_t)len < out_size;
+}
+
+/**
+ * Opens a cached thumbnail and validates it against its source.
+ */
+int ThumbStore_open(const char* file, const char* src_path, ThumbStoreInfo* info) {
+	int fd = open(file, O_RDONLY);
+	if (fd < 0)
+		return -1;
+
+	ThumbStoreInfo header;
+	size_t path_len = strlen(src_path);
+	char stored_path[path_len + 1];
+
+	if (!ThumbStore_readAll(fd, &header, sizeof(header)) || header.magic != THUMB_STORE_MAGIC ||
+	    header.version != THUMB_STORE_VERSION || header.mtime != info->mtime ||
+	    header.size != info->size || header.max_w != info->max_w ||
+	    header.max_h != info->max_h || header.path_len != path_len || header.w <= 0 ||
+	    header.h <= 0 || header.pitch <= 0 ||
+	    !ThumbStore_readAll(fd, stored_path, path_len) ||
+	    memcmp(stored_path, src_path, path_len) != 0) {
+		close(fd);
+		return -1;
+	}
+
+	*info = header;
+	return fd;
+}
+
+/**
+ * Reads the pixel data of an opened cache file.
+ */
+int ThumbStore_readPixels(int fd, const ThumbStoreInfo* info, void* pixels) {
+	return ThumbStore_readAll(fd, pixels, (size_t)info->pitch * info->h);
+}
+
+/**
+ * Writes a thumbnail to the cache.
+ */
+int ThumbStore_write(const char* file, const char* src_path, const ThumbStoreInfo* info,
+                     const void* pixels) {
+	char tmp_path[strlen(file) + 8];
+	sprintf(tmp_path, "%s.tmp", file);
+
+	int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		LOG_errno("Failed to create thumbnail cache file: %s", tmp_path);
+		return 0;
+	}
+
+	ThumbStoreInfo header = *info;
+	header.magic = THUMB_STORE_MAGIC;
+	header.version = THUMB_STORE_VERSION;
+	header.path_len = (uint32_t)strlen(src_path);
+
+	int ok = ThumbStore_writeAll(fd, &header, sizeof(header)) &&
+	         ThumbStore_writeAll(fd, src_path, header.path_len) &&
+	         ThumbStore_writeAll(fd, pixels, (size_t)header.pitch * header.h);
+	if (close(fd) != 0)
+		ok = 0;
+
+	if (ok && rename(tmp_path, file) != 0) {
+		LOG_errno("Failed to move thumbnail cache file into place: %s", file);
+		ok = 0;
+	}
+	if (!ok)
+		unlink(tmp_path);
+
+	return ok;
+}
@@ -0,0 +1,103 @@
+/**
+ * thumb_store.h - Persistent cache of pre-scaled thumbnails
+ *
+ * Stores thumbnails on disk already scaled to the launcher's thumbnail box
+ * and converted to their display pixel format, so showing cached art is one
+ * header read plus one pixel read instead of a PNG decode and a resample.
+ *
+ * Each source image maps to one file named by a hash of its path. The
+ * header records the source's mtime and size, the box it was scaled into,
+ * and the exact pixel layout. Anything that doesn't match is treated as a
+ * miss, and the caller rewrites the entry.
+ *
+ * Files are device-local (native endianness, native pixel format) and live
+ * under USERDATA_PATH, so they are never shared between platforms.
+ *
+ * This module has no SDL dependency; callers map the layout fields onto
+ * their surfaces.
+ */
+
+#ifndef __THUMB_STORE_H__
+#define __THUMB_STORE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define THUMB_STORE_MAGIC 0x42485454 // "TTHB"
+#define THUMB_STORE_VERSION 1
+
+/**
+ * Header at the start of every cached thumbnail file.
+ *
+ * Followed by path_len bytes of source path (collision check),
+ * then pitch * h bytes of pixel data.
+ */
+typedef struct ThumbStoreInfo {
+	uint32_t magic; // THUMB_STORE_MAGIC
+	uint32_t version; // THUMB_STORE_VERSION
+	int64_t mtime; // Source image modification time
+	int64_t size; // Source image size in bytes
+	int32_t max_w; // Width of the box the image was scaled into
+	int32_t max_h; // Height of the box the image was scaled into
+	int32_t w; // Thumbnail width in pixels
+	int32_t h; // Thumbnail height in pixels
+	int32_t pitch; // Bytes per row
+	uint32_t bpp; // Bits per pixel
+	uint32_t rmask; // Pixel format masks
+	uint32_t gmask;
+	uint32_t bmask;
+	uint32_t amask;
+	uint32_t path_len; // Length of source path following the header
+} ThumbStoreInfo;
+
+/**
+ * Builds the cache file path for a source image.
+ *
+ * @param out Output buffer
+ * @param out_size Size of output buffer
+ * @param dir Cache directory
+ * @param src_path Full path to the source image
+ * @return 1 on success, 0 if the path didn't fit
+ */
+int ThumbStore_getPath(char* out, size_t out_size, const char* dir, const char* src_path);
+
+/**
+ * Opens a cached thumbnail and validates it against its source.
+ *
+ * On input, info must have mtime, size, max_w and max_h set to the current
+ * source file and box. On success the remaining fields describe the cached
+ * pixels and the returned descriptor is positioned at the pixel data.
+ *
+ * @param file Cache file path (from ThumbStore_getPath)
+ * @param src_path Full path to the source image
+ * @param info In: key fields, Out: full header
+ * @return File descriptor on a valid hit (caller must close), -1 on miss
+ */
+int ThumbStore_open(const char* file, const char* src_path, ThumbStoreInfo* info);
+
+/**
+ * Reads the pixel data of an opened cache file.
+ *
+ * @param fd Descriptor returned by ThumbStore_open
+ * @param info Header returned by ThumbStore_open
+ * @param pixels Destination, at least info->pitch * info->h bytes
+ * @return 1 on success, 0 if the file was truncated or unreadable
+ */
+int ThumbStore_readPixels(int fd, const ThumbStoreInfo* info, void* pixels);
+
+/**
+ * Writes a thumbnail to the cache.
+ *
+ * Written to a temporary file and renamed into place, so a concurrent
+ * reader or a power loss never sees a partial entry.
+ *
+ * @param file Cache file path (from ThumbStore_getPath)
+ * @param src_path Full path to the source image
+ * @param info Complete header (magic, version and path_len are filled in)
+ * @param pixels Pixel data, info->pitch * info->h bytes
+ * @return 1 on success, 0 on failure
+ */
+int ThumbStore_write(const char* file, const char* src_path, const ThumbStoreInfo* info,
+                     const void* pixels);
+
+#endif // __THUMB_STORE_H__
@@ -47,16 +47,26 @@
 #include <fcntl.h>
 #include <libgen.h>
 #include <pthread.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 #include <zlib.h>
 
 #include "api.h"
+#include "cpufreq.h"
 #include "defines.h"
+#include "governor.h"
+#include "latency.h"
 #include "libretro.h"
 #include "minui_file_utils.h"
+#include "movie.h"
+#include "resident.h"
 #include "scaler.h"
+#include "scaler_pool.h"
 #include "utils.h"
 
 ///////////////////////////////////////
@@ -73,6 +83,8 @@ static int simple_mode = 0; // Simplified interface mode (fewer options)
 
 // Threading
 static int thread_video = 0; // Enable threaded video rendering
+static uint64_t launch_us = 0; // When launch.sh started minarch.elf, for the first frame log
+static int launch_resident = 0; // Running in a child of the resident host
 static int was_threaded = 0; // Previous threading state (for fast-forward toggle)
 static int should_run_core = 1; // Signal to core thread: run or pause
 static pthread_t core_pt; // Core thread handle
@@ -106,7 +118,8 @@ enum {
 	SCALE_NATIVE, // No scaling, 1:1 pixel mapping (may be cropped)
 	SCALE_ASPECT, // Scale maintaining aspect ratio (letterboxed)
 	SCALE_FULLSCREEN, // Scale to fill entire screen (may distort)
-	SCALE_CROPPED, // Crop to fill screen maintaining aspect ratio
+	SCALE_SHARP_BILINEAR, // Aspect, integer prescale then bilinear to exact size
+	SCALE_CROPPED, // Crop to fill screen maintaining aspect ratio (must be last)
 	SCALE_COUNT, // Number of scaling modes
 };
 
@@ -148,9 +161,11 @@ static enum retro_pixel_format pixel_format =
 static int show_debug = 0; // Display FPS/CPU usage overlay
 static int max_ff_speed = 3; // Fast-forward speed (0=2x, 3=4x)
 static int fast_forward = 0; // Currently fast-forwarding
-static int overclock = 1; // CPU speed (0=underclock, 1=normal, 2=overclock)
+static int overclock = 1; // CPU speed (0=underclock, 1=normal, 2=overclock, 3=auto)
+#define OVERCLOCK_AUTO 3
 
 // Input Settings
+static int input_thread = 0; // Read evdev on a dedicated thread (see input_thread.h)
 static int has_custom_controllers = 0; // Custom controller mappings defined
 static int gamepad_type = 0; // Index in gamepad_labels/gamepad_values
 
@@ -783,6 +798,9 @@ static void State_read(void) {
 	if (!state_size)
 		return;
 
+	// A movie only replays from the state it started at
+	Movie_stop();
+
 	int was_ff = fast_forward;
 	fast_forward = 0;
 
@@ -915,6 +933,126 @@ static void State_resume(void) {
 	state_slot = last_state_slot;
 }
 
+///////////////////////////////
+// Input movies
+///////////////////////////////
+// Record the input the core sees and play it back from the same state.
+// Stored next to the save states as <game>.mov
+
+enum {
+	MOVIE_REQUEST_NONE,
+	MOVIE_REQUEST_RECORD, // Start or stop recording
+	MOVIE_REQUEST_PLAY, // Start or stop playback
+};
+
+static int movie_request = MOVIE_REQUEST_NONE; // Handled between frames
+static char movie_path[MAX_PATH] = {0}; // Movie to play instead of the game's own
+static int movie_quit = 0; // Quit when playback ends (benchmark runs)
+static uint64_t movie_start_us = 0;
+static uint32_t movie_run_frames = 0; // core.run() calls since playback started
+
+static void Movie_getPath(char* filename) {
+	if (movie_path[0])
+		strcpy(filename, movie_path);
+	else
+		sprintf(filename, "%s/%s.mov", core.states_dir, game.name);
+}
+
+/**
+ * Starts recording from the current state.
+ *
+ * Cores that can't save states are reset instead, so the recording starts
+ * from power on.
+ */
+static void Movie_beginRecording(void) {
+	size_t state_size = core.serialize_size();
+	void* state = NULL;
+	if (state_size) {
+		state = calloc(1, state_size);
+		if (!state || !core.serialize(state, state_size)) {
+			LOG_error("Error creating movie state");
+			free(state);
+			return;
+		}
+	} else {
+		core.reset();
+	}
+
+	char filename[MAX_PATH];
+	Movie_getPath(filename);
+	Movie_startRecording(filename, state, state_size);
+	free(state);
+}
+
+/**
+ * Loads a movie and restores the state it starts from.
+ */
+static void Movie_beginPlayback(void) {
+	char filename[MAX_PATH];
+	Movie_getPath(filename);
+	if (Movie_startPlayback(filename) != 0) {
+		if (movie_quit)
+			quit = 1;
+		return;
+	}
+
+	size_t state_size;
+	const void* state = Movie_getState(&state_size);
+	if (!state) {
+		core.reset();
+	} else if (!core.unserialize(state, state_size)) {
+		LOG_error("Error restoring movie state: %s", filename);
+		Movie_stop();
+		if (movie_quit)
+			quit = 1;
+		return;
+	}
+	movie_start_us = getMicroseconds();
+	movie_run_frames = 0;
+}
+
+/**
+ * Ends playback and reports how fast it ran.
+ */
+static void Movie_endPlayback(void) {
+	// Counted per core.run(), cores that poll input more or less than once
+	// a frame would skew a count of movie polls
+	uint32_t frames = movie_run_frames;
+	double seconds = (getMicroseconds() - movie_start_us) / 1000000.0;
+	Movie_stop();
+	LOG_info("movie: played %u frames in %.2fs (%.1f fps)", frames, seconds,
+	         seconds > 0 ? frames / seconds : 0.0);
+	if (movie_quit)
+		quit = 1;
+}
+
+/**
+ * Starts or stops recording and playback as requested by the shortcuts.
+ *
+ * Called right before core.run() on the thread that runs the core, so the
+ * movie's state is saved and restored between frames. Also counts the
+ * frames run during playback.
+ */
+static void Movie_update(void) {
+	int request = movie_request;
+	movie_request = MOVIE_REQUEST_NONE;
+
+	if (request == MOVIE_REQUEST_RECORD) {
+		if (Movie_isRecording())
+			Movie_stop();
+		else
+			Movie_beginRecording();
+	} else if (request == MOVIE_REQUEST_PLAY) {
+		if (Movie_isPlaying())
+			Movie_endPlayback();
+		else
+			Movie_beginPlayback();
+	}
+
+	if (Movie_isPlaying())
+		movie_run_frames += 1;
+}
+
 ///////////////////////////////
 
 typedef struct Option {
@@ -941,7 +1079,8 @@ typedef struct OptionList {
 } OptionList;
 
 static char* onoff_labels[] = {"Off", "On", NULL};
-static char* scaling_labels[] = {"Native", "Aspect", "Fullscreen", "Cropped", NULL};
+static char* scaling_labels[] = {"Native", "Aspect", "Fullscreen", "Sharp Bilinear", "Cropped",
+                                 NULL};
 static char* effect_labels[] = {"None", "Line", "Grid", NULL};
 static char* sharpness_labels[] = {"Sharp", "Crisp", "Soft", NULL};
 static char* tearing_labels[] = {"Off", "Lenient", "Strict", NULL};
@@ -958,6 +1097,7 @@ enum {
 	FE_OPT_TEARING,
 	FE_OPT_OVERCLOCK,
 	FE_OPT_THREAD,
+	FE_OPT_INPUT,
 	FE_OPT_DEBUG,
 	FE_OPT_MAXFF,
 	FE_OPT_COUNT,
@@ -970,6 +1110,8 @@ enum {
 	SHORTCUT_SAVE_QUIT,
 	SHORTCUT_CYCLE_SCALE,
 	SHORTCUT_CYCLE_EFFECT,
+	SHORTCUT_RECORD_MOVIE,
+	SHORTCUT_PLAY_MOVIE,
 	SHORTCUT_TOGGLE_FF,
 	SHORTCUT_HOLD_FF,
 	SHORTCUT_COUNT,
@@ -1222,6 +1364,7 @@ static char* overclock_labels[] = {
     "Powersave",
     "Normal",
     "Performance",
+    "Auto",
     NULL,
 };
 
@@ -1246,14 +1389,15 @@ enum {
 static inline char* getScreenScalingDesc(void) {
 	if (GFX_supportsOverscan()) {
 		return "Native uses integer scaling. Aspect uses core\nreported aspect ratio. Fullscreen "
-		       "has non-square\npixels. Cropped is integer scaled then cropped.";
+		       "has non-square\npixels. Sharp Bilinear is Aspect with crisp\npixels. Cropped is "
+		       "integer scaled then cropped.";
 	} else {
 		return "Native uses integer scaling.\nAspect uses core reported aspect ratio.\nFullscreen "
-		       "has non-square pixels.";
+		       "has non-square pixels.\nSharp Bilinear is Aspect with crisp pixels.";
 	}
 }
 static inline int getScreenScalingCount(void) {
-	return GFX_supportsOverscan() ? 4 : 3;
+	return GFX_supportsOverscan() ? SCALE_COUNT : SCALE_COUNT - 1;
 }
 
 
@@ -1344,12 +1488,13 @@ static struct Config {
                                 .key = "minarch_cpu_speed",
                                 .name = "CPU Speed",
                                 .desc = "Over- or underclock the CPU to prioritize\npure "
-                                        "performance or power savings.",
+                                        "performance or power savings.\nAuto picks the "
+                                        "lowest speed that keeps up.",
                                 .full = NULL,
                                 .var = NULL,
                                 .default_value = 1,
                                 .value = 1,
-                                .count = 3,
+                                .count = 4,
                                 .lock = 0,
                                 .values = overclock_labels,
                                 .labels = overclock_labels,
@@ -1369,6 +1514,21 @@ static struct Config {
                                 .values = onoff_labels,
                                 .labels = onoff_labels,
                             },
+                        [FE_OPT_INPUT] =
+                            {
+                                .key = "minarch_input_thread",
+                                .name = "Input Thread",
+                                .desc = "Read buttons as they arrive so\nquick taps aren't lost at low "
+                                        "frame\nrates. Debug HUD shows input age.",
+                                .full = NULL,
+                                .var = NULL,
+                                .default_value = 0,
+                                .value = 0,
+                                .count = 2,
+                                .lock = 0,
+                                .values = onoff_labels,
+                                .labels = onoff_labels,
+                            },
                         [FE_OPT_DEBUG] =
                             {
                                 .key = "minarch_debug_hud",
@@ -1473,6 +1633,18 @@ static struct Config {
                                                               .mod = 0,
                                                               .default_ = 0,
                                                               .ignore = 0},
+                                   [SHORTCUT_RECORD_MOVIE] = {.name = "Record Movie",
+                                                              .retro = -1,
+                                                              .local = BTN_ID_NONE,
+                                                              .mod = 0,
+                                                              .default_ = 0,
+                                                              .ignore = 0},
+                                   [SHORTCUT_PLAY_MOVIE] = {.name = "Play Movie",
+                                                            .retro = -1,
+                                                            .local = BTN_ID_NONE,
+                                                            .mod = 0,
+                                                            .default_ = 0,
+                                                            .ignore = 0},
                                    [SHORTCUT_TOGGLE_FF] = {.name = "Toggle FF",
                                                            .retro = -1,
                                                            .local = BTN_ID_NONE,
@@ -1520,8 +1692,66 @@ static int Config_getValue(char* cfg, const char* key, char* out_value,
 	return 1;
 }
 
+///////////////////////////////////////
+// Auto CPU Speed
+//
+// With CPU Speed set to Auto, a Governor (see governor.h) picks between
+// the Powersave, Normal and Performance levels from how long each frame
+// took to emulate, so light games run at the lowest speed that keeps up.
+///////////////////////////////////////
+
+static Governor governor;
+static int governor_active = 0;
+static uint64_t frame_wait_us = 0; // Time the current frame spent waiting on vsync
+
+/**
+ * Logs how long Auto spent at each level, for tuning.
+ */
+static void autoCPU_report(void) {
+	uint64_t total = 0;
+	for (int i = 0; i < GOVERNOR_LEVELS; i++)
+		total += governor.time_at_level[i];
+	if (!total)
+		return;
+
+	LOG_info("Auto CPU: %i transitions, %s %i%% / %s %i%% / %s %i%% of %.0fs", governor.transitions,
+	         overclock_labels[0], (int)(governor.time_at_level[0] * 100 / total),
+	         overclock_labels[1], (int)(governor.time_at_level[1] * 100 / total),
+	         overclock_labels[2], (int)(governor.time_at_level[2] * 100 / total),
+	         (double)total / 1000000);
+}
+
+/**
+ * Feeds one emulated frame to the governor and applies its decision.
+ *
+ * @param run_us Wall time of core.run(), including any vsync and audio waits
+ */
+static void autoCPU(uint64_t run_us) {
+	uint64_t wait_us = frame_wait_us + SND_takeWaitTime();
+	if (!governor_active || fast_forward || show_menu || core.fps <= 0)
+		return;
+
+	uint64_t busy_us = run_us > wait_us ? run_us - wait_us : 0;
+	uint32_t budget_us = (uint32_t)(1000000 / core.fps);
+	int audio_fill = (int)SND_getBufferOccupancy();
+
+	int old_level = governor.level;
+	int level = Governor_update(&governor, (uint32_t)busy_us, budget_us, audio_fill);
+	if (level == old_level)
+		return;
+
+	PWR_setCPUSpeed(CPU_SPEED_POWERSAVE + level);
+	LOG_info("Auto CPU: %s -> %s (busy %i%%, audio %i%%)", overclock_labels[old_level],
+	         overclock_labels[level], (int)(busy_us * 100 / budget_us), audio_fill);
+}
+
 static void setOverclock(int i) {
 	overclock = i;
+	if (i != OVERCLOCK_AUTO && governor_active) {
+		autoCPU_report();
+		governor_active = 0;
+	}
+
 	switch (i) {
 	case 0:
 		PWR_setCPUSpeed(CPU_SPEED_POWERSAVE);
@@ -1532,6 +1762,20 @@ static void setOverclock(int i) {
 	case 2:
 		PWR_setCPUSpeed(CPU_SPEED_PERFORMANCE);
 		break;
+	case OVERCLOCK_AUTO:
+		if (!governor_active) {
+			// Start at the top so nothing is missed while headroom is measured
+			PWR_setCPUSpeed(CPU_SPEED_PERFORMANCE);
+			int khz[GOVERNOR_LEVELS];
+			for (int level = 0; level < GOVERNOR_LEVELS; level++)
+				khz[level] = CPUFreq_getSpeedKHz(CPU_SPEED_POWERSAVE + level);
+			Governor_init(&governor, khz, GOVERNOR_LEVELS - 1);
+			governor_active = 1;
+		} else {
+			Governor_settle(&governor);
+		}
+		PWR_setCPUSpeed(CPU_SPEED_POWERSAVE + governor.level);
+		break;
 	}
 }
 static int toggle_thread = 0;
@@ -1542,6 +1786,8 @@ static void Config_syncFrontend(char* key, int value) {
 
 		if (screen_scaling == SCALE_NATIVE)
 			GFX_setSharpness(SHARPNESS_SHARP);
+		else if (screen_scaling == SCALE_SHARP_BILINEAR)
+			GFX_setSharpness(SHARPNESS_CRISP);
 		else
 			GFX_setSharpness(screen_sharpness);
 
@@ -1557,6 +1803,8 @@ static void Config_syncFrontend(char* key, int value) {
 
 		if (screen_scaling == SCALE_NATIVE)
 			GFX_setSharpness(SHARPNESS_SHARP);
+		else if (screen_scaling == SCALE_SHARP_BILINEAR)
+			GFX_setSharpness(SHARPNESS_CRISP);
 		else
 			GFX_setSharpness(screen_sharpness);
 
@@ -1569,6 +1817,15 @@ static void Config_syncFrontend(char* key, int value) {
 		int old_value = thread_video || was_threaded;
 		toggle_thread = old_value != value;
 		i = FE_OPT_THREAD;
+	} else if (exactMatch(key, config.frontend.options[FE_OPT_INPUT].key)) {
+		if (value != input_thread) {
+			input_thread = value;
+			if (input_thread)
+				PAD_startThread();
+			else
+				PAD_stopThread();
+		}
+		i = FE_OPT_INPUT;
 	} else if (exactMatch(key, config.frontend.options[FE_OPT_OVERCLOCK].key)) {
 		overclock = value;
 		i = FE_OPT_OVERCLOCK;
@@ -1805,7 +2062,7 @@ static void Config_load(void) {
 	scaling_option->desc = getScreenScalingDesc();
 	scaling_option->count = getScreenScalingCount();
 	if (!GFX_supportsOverscan()) {
-		scaling_labels[3] = NULL;
+		scaling_labels[SCALE_CROPPED] = NULL;
 	}
 
 	char* system_path = SYSTEM_PATH "/system.cfg";
@@ -2311,6 +2568,10 @@ static int setFastForward(int enable) {
 
 static uint32_t buttons = 0; // Current button state (RETRO_DEVICE_ID_JOYPAD_* flags)
 static int ignore_menu = 0; // Suppress menu button (used for shortcuts)
+static int latency_pressed = 0; // Latency probe is holding Select
+static uint32_t latency_buttons = 0; // Core buttons the probe's Select maps to
+static PAD_Axis analog_left; // Left stick as the core sees it, live or from a movie
+static PAD_Axis analog_right; // Right stick as the core sees it
 
 /**
  * Polls input devices and handles frontend shortcuts.
@@ -2330,6 +2591,13 @@ static int ignore_menu = 0; // Suppress menu button (used for shortcuts)
 static void input_poll_callback(void) {
 	PAD_poll();
 
+	// The latency probe presses Select through the pad, like a player would
+	int probe = Latency_poll(getMicroseconds());
+	if (probe != latency_pressed) {
+		latency_pressed = probe;
+		PAD_setButton(BTN_ID_SELECT, probe, SDL_GetTicks() + PAD_REPEAT_DELAY);
+	}
+
 	int show_setting = 0;
 	PWR_update(NULL, &show_setting, Menu_beforeSleep, Menu_afterSleep);
 
@@ -2411,6 +2679,12 @@ static void input_poll_callback(void) {
 						screen_effect -= EFFECT_COUNT;
 					Config_syncFrontend(config.frontend.options[FE_OPT_EFFECT].key, screen_effect);
 					break;
+				case SHORTCUT_RECORD_MOVIE:
+					movie_request = MOVIE_REQUEST_RECORD;
+					break;
+				case SHORTCUT_PLAY_MOVIE:
+					movie_request = MOVIE_REQUEST_PLAY;
+					break;
 				default:
 					break;
 				}
@@ -2441,6 +2715,7 @@ static void input_poll_callback(void) {
 	// TODO: the shortcuts loop above should also contribute to the array
 
 	buttons = 0;
+	latency_buttons = 0;
 	for (int i = 0; config.controls[i].name; i++) {
 		ButtonMapping* mapping = &config.controls[i];
 		int btn = 1 << mapping->local;
@@ -2466,28 +2741,54 @@ static void input_poll_callback(void) {
 			buttons |= 1 << mapping->retro;
 			if (mapping->mod)
 				ignore_menu = 1;
+			if (latency_pressed && btn == BTN_SELECT)
+				latency_buttons |= 1 << mapping->retro;
 		}
 		//  && !PWR_ignoreSettingInput(btn, show_setting)
 	}
 
+	analog_left = pad.laxis;
+	analog_right = pad.raxis;
+	if (Movie_isPlaying()) {
+		MovieInput input;
+		if (Movie_playFrame(&input)) {
+			buttons = input.buttons;
+			analog_left.x = input.axes[0];
+			analog_left.y = input.axes[1];
+			analog_right.x = input.axes[2];
+			analog_right.y = input.axes[3];
+		} else {
+			Movie_endPlayback();
+		}
+	} else if (Movie_isRecording()) {
+		MovieInput input = {
+		    .buttons = buttons,
+		    .axes = {analog_left.x, analog_left.y, analog_right.x, analog_right.y},
+		};
+		Movie_recordFrame(&input);
+	}
+
 	// if (buttons) LOG_info("buttons: %i", buttons);
 }
 static int16_t input_state_callback(unsigned port, unsigned device, unsigned index, unsigned id) {
 	if (port == 0 && device == RETRO_DEVICE_JOYPAD && index == 0) {
+		if (latency_buttons &&
+		    (id == RETRO_DEVICE_ID_JOYPAD_MASK || ((latency_buttons >> id) & 1)))
+			Latency_seen(getMicroseconds());
 		if (id == RETRO_DEVICE_ID_JOYPAD_MASK)
 			return buttons;
 		return (buttons >> id) & 1;
 	} else if (port == 0 && device == RETRO_DEVICE_ANALOG) {
 		if (index == RETRO_DEVICE_INDEX_ANALOG_LEFT) {
 			if (id == RETRO_DEVICE_ID_ANALOG_X)
-				return pad.laxis.x;
+				return analog_left.x;
 			else if (id == RETRO_DEVICE_ID_ANALOG_Y)
-				return pad.laxis.y;
+				return analog_left.y;
 		} else if (index == RETRO_DEVICE_INDEX_ANALOG_RIGHT) {
 			if (id == RETRO_DEVICE_ID_ANALOG_X)
-				return pad.raxis.x;
+				return analog_right.x;
 			else if (id == RETRO_DEVICE_ID_ANALOG_Y)
-				return pad.raxis.y;
+				return analog_right.y;
 		}
 	}
 	return 0;
@@ -3015,8 +3316,14 @@ static bool environment_callback(unsigned cmd, void* data) { // copied from pico
 ///////////////////////////////
 
 static void hdmimon(void) {
-	// handle HDMI change
+	// handle HDMI change, only rereading settings when keymon changed one
 	static int had_hdmi = -1;
+	static int settings_seq = 0;
+	int seq = GetSettingsSeq();
+	if (had_hdmi != -1 && seq == settings_seq)
+		return;
+	settings_seq = seq;
+
 	int has_hdmi = GetHDMI();
 	if (had_hdmi == -1)
 		had_hdmi = has_hdmi;
@@ -3407,13 +3714,14 @@ static void convert_buffer_alloc(int w, int h) {
  * Output: RRRRRGGGGGGBBBBB RRRRRGGGGGGBBBBB (4x16-bit packed)
  *
  * @param data Source XRGB8888 data
+ * @param output RGB565 output, width pixels per row
  * @param width Frame width
  * @param height Frame height
  * @param pitch Source pitch in bytes
  */
-static void convert_xrgb8888_neon(const void* data, unsigned width, unsigned height, size_t pitch) {
+static void convert_xrgb8888_neon(const void* data, uint16_t* output, unsigned width,
+                                  unsigned height, size_t pitch) {
 	const uint32_t* input = data;
-	uint16_t* output = convert_buffer;
 	size_t extra = pitch / sizeof(uint32_t) - width;
 
 	// NEON mask constants for extracting RGB565 components from XRGB8888
@@ -3467,13 +3775,14 @@ static void convert_xrgb8888_neon(const void* data, unsigned width, unsigned hei
  * into the LSB position: g6 = (g << 1) | (g >> 4)
  *
  * @param data Source 0RGB1555 data
+ * @param output RGB565 output, width pixels per row
  * @param width Frame width
  * @param height Frame height
  * @param pitch Source pitch in bytes
  */
-static void convert_0rgb1555_neon(const void* data, unsigned width, unsigned height, size_t pitch) {
+static void convert_0rgb1555_neon(const void* data, uint16_t* output, unsigned width,
+                                  unsigned height, size_t pitch) {
 	const uint16_t* input = data;
-	uint16_t* output = convert_buffer;
 	size_t extra = pitch / sizeof(uint16_t) - width;
 
 	for (unsigned y = 0; y < height; y++) {
@@ -3524,14 +3833,14 @@ static void convert_0rgb1555_neon(const void* data, unsigned width, unsigned hei
  * Converts XRGB8888 to RGB565 (scalar fallback).
  *
  * @param data Source XRGB8888 data
+ * @param output RGB565 output, width pixels per row
  * @param width Frame width
  * @param height Frame height
  * @param pitch Source pitch in bytes
  */
-static void convert_xrgb8888_scalar(const void* data, unsigned width, unsigned height,
-                                    size_t pitch) {
+static void convert_xrgb8888_scalar(const void* data, uint16_t* output, unsigned width,
+                                    unsigned height, size_t pitch) {
 	const uint32_t* input = data;
-	uint16_t* output = convert_buffer;
 	size_t extra = pitch / sizeof(uint32_t) - width;
 
 	for (unsigned y = 0; y < height; y++) {
@@ -3549,14 +3858,14 @@ static void convert_xrgb8888_scalar(const void* data, unsigned width, unsigned h
  * Converts 0RGB1555 to RGB565 (scalar fallback).
  *
  * @param data Source 0RGB1555 data
+ * @param output RGB565 output, width pixels per row
  * @param width Frame width
  * @param height Frame height
  * @param pitch Source pitch in bytes
  */
-static void convert_0rgb1555_scalar(const void* data, unsigned width, unsigned height,
-                                    size_t pitch) {
+static void convert_0rgb1555_scalar(const void* data, uint16_t* output, unsigned width,
+                                    unsigned height, size_t pitch) {
 	const uint16_t* input = data;
-	uint16_t* output = convert_buffer;
 	size_t extra = pitch / sizeof(uint16_t) - width;
 
 	for (unsigned y = 0; y < height; y++) {
@@ -3575,11 +3884,36 @@ static void convert_0rgb1555_scalar(const void* data, unsigned width, unsigned h
 	}
 }
 
+typedef void (*ConvertFunc)(const void* data, uint16_t* output, unsigned width, unsigned height,
+                            size_t pitch);
+
+// One frame's conversion, split into row bands by pixel_convert_band
+typedef struct ConvertJob {
+	ConvertFunc convert;
+	const uint8_t* data;
+	unsigned width;
+	unsigned height;
+	size_t pitch;
+} ConvertJob;
+
+/**
+ * Converts one band of rows of a ConvertJob into convert_buffer.
+ */
+static void pixel_convert_band(void* ctx, int band, int bands) {
+	ConvertJob* job = ctx;
+	unsigned y0 = (uint64_t)job->height * band / bands;
+	unsigned y1 = (uint64_t)job->height * (band + 1) / bands;
+	if (y1 > y0)
+		job->convert(job->data + y0 * job->pitch, (uint16_t*)convert_buffer + y0 * job->width,
+		             job->width, y1 - y0, job->pitch);
+}
+
 /**
  * Converts pixel data to RGB565 format based on current pixel_format setting.
  *
  * Dispatches to the appropriate conversion function (NEON-optimized or scalar)
- * based on the source format. RGB565 input is a no-op (returns immediately).
+ * based on the source format, split into row bands across cores when that
+ * measures faster. RGB565 input is a no-op (returns immediately).
  *
  * @param data Source pixel data
  * @param width Frame width in pixels
@@ -3607,32 +3941,38 @@ static void pixel_convert(const void* data, unsigned width, unsigned height, siz
 
 	LOG_debug("Converting %ux%u from format %d to RGB565", width, height, pixel_format);
 
+	ConvertFunc convert;
 	switch (pixel_format) {
 	case RETRO_PIXEL_FORMAT_XRGB8888:
 #ifdef HAS_NEON
-		convert_xrgb8888_neon(data, width, height, pitch);
+		convert = convert_xrgb8888_neon;
 #else
-		convert_xrgb8888_scalar(data, width, height, pitch);
+		convert = convert_xrgb8888_scalar;
 #endif
 		break;
 
 	case RETRO_PIXEL_FORMAT_0RGB1555:
 #ifdef HAS_NEON
-		convert_0rgb1555_neon(data, width, height, pitch);
+		convert = convert_0rgb1555_neon;
 #else
-		convert_0rgb1555_scalar(data, width, height, pitch);
+		convert = convert_0rgb1555_scalar;
 #endif
 		break;
 
 	case RETRO_PIXEL_FORMAT_RGB565:
 		// Should never be called for RGB565, but handle it gracefully
 		LOG_warn("pixel_convert called for RGB565 (no conversion needed)");
-		break;
+		return;
 
 	default:
 		LOG_error("Unknown pixel format %d", pixel_format);
-		break;
+		return;
 	}
+
+	static ScalerPoolGate gate;
+	ConvertJob job = {convert, data, width, height, pitch};
+	ScalerPool_dispatch(&gate, ScalerPool_key(width, height, width, height, pixel_format),
+	                    pixel_convert_band, &job);
 }
 
 /**
@@ -3718,12 +4058,10 @@ static void* apply_rotation(void* src, uint32_t src_w, uint32_t src_h, uint32_t
 		return src;
 	}
 
-	// Perform rotation (use NEON-optimized version when available)
-#ifdef HAS_NEON
-	rotate_n16(rotation, src, rotation_buffer.buffer, src_w, src_h, src_p, dst_p);
-#else
-	rotate_c16(rotation, src, rotation_buffer.buffer, src_w, src_h, src_p, dst_p);
-#endif
+	// Perform rotation (NEON-optimized when available, split into row bands across cores when
+	// that measures faster)
+	static ScalerPoolGate gate;
+	ScalerPool_rotate(&gate, rotation, src, rotation_buffer.buffer, src_w, src_h, src_p, dst_p);
 
 	return rotation_buffer.buffer;
 }
@@ -3739,6 +4077,8 @@ static void* apply_rotation(void* src, uint32_t src_w, uint32_t src_h, uint32_t
  * - SCALE_NATIVE: 1:1 pixel mapping (may be cropped if game > screen)
  * - SCALE_ASPECT: Maintain aspect ratio with letterboxing
  * - SCALE_FULLSCREEN: Stretch to fill screen (may distort)
+ * - SCALE_SHARP_BILINEAR: Aspect, drawn at its exact size by a fused integer
+ *   prescale and bilinear pass (crisp filtering on GPU-scaled platforms)
  * - SCALE_CROPPED: Crop to fill screen while maintaining aspect
  *
  * @param src_w Source width from core
@@ -3861,6 +4201,20 @@ static void selectScaler(int src_w, int src_h, int src_p) {
 			dst_x = (DEVICE_WIDTH - scaled_w) / 2; // should always be positive
 			dst_y = (DEVICE_HEIGHT - scaled_h) / 2; // should always be positive
 		}
+	} else if (scaling == SCALE_SHARP_BILINEAR) {
+		// Software scalers draw straight into the screen at the final size
+		// (scale -1 selects scaleSharpBilinear), GPU platforms just use the
+		// aspect and crisp filtering
+		double scale_f =
+		    MIN(((double)DEVICE_WIDTH) / aspect_w, ((double)DEVICE_HEIGHT) / aspect_h);
+
+		sprintf(scaler_name, "sharp bilinear");
+		dst_w = aspect_w * scale_f;
+		dst_h = aspect_h * scale_f;
+		dst_p = DEVICE_PITCH;
+		dst_x = (DEVICE_WIDTH - dst_w) / 2;
+		dst_y = (DEVICE_HEIGHT - dst_h) / 2;
+		scale = -1;
 	} else if (fit) {
 		// these both will use a generic nn scaler
 		if (scaling == SCALE_FULLSCREEN) {
@@ -3986,7 +4340,7 @@ static void selectScaler(int src_w, int src_h, int src_p) {
 	// 	aspect_w,aspect_h
 	// );
 
-	if (fit) {
+	if (fit || scaling == SCALE_SHARP_BILINEAR) {
 		dst_w = DEVICE_WIDTH;
 		dst_h = DEVICE_HEIGHT;
 	}
@@ -3995,6 +4349,22 @@ static void selectScaler(int src_w, int src_h, int src_p) {
 	screen = GFX_resize(dst_w, dst_h, dst_p);
 	// }
 }
+
+/**
+ * Whites out the top left corner of the frame being rendered, so a camera
+ * pointed at the screen can confirm what the latency probe timed.
+ */
+static void drawLatencyMarker(void) {
+	int size = 8;
+	if (size > renderer.src_w)
+		size = renderer.src_w;
+	if (size > renderer.src_h)
+		size = renderer.src_h;
+
+	uint8_t* row = (uint8_t*)renderer.src + renderer.src_y * renderer.src_p + renderer.src_x * 2;
+	for (int y = 0; y < size; y++, row += renderer.src_p)
+		memset(row, 0xff, size * 2);
+}
 static void video_refresh_callback_main(const void* data, unsigned width, unsigned height,
                                         size_t pitch) {
 	// return;
@@ -4089,6 +4459,9 @@ static void video_refresh_callback_main(const void* data, unsigned width, unsign
 
 	renderer.src = rotated_data;
 
+	if (Latency_markFrame())
+		drawLatencyMarker();
+
 	// debug - render after pixel conversion so we write to RGB565 buffer
 	if (show_debug) {
 		int x = 2 + renderer.src_x;
@@ -4137,7 +4510,12 @@ static void video_refresh_callback_main(const void* data, unsigned width, unsign
 		blitBitmapText(debug_text, x, -y, (uint16_t*)renderer.src, pitch_in_pixels, debug_width,
 		               debug_height);
 
-		sprintf(debug_text, "%ix%i", renderer.dst_w, renderer.dst_h);
+		uint32_t input_age = PAD_getInputAge();
+		if (input_age)
+			sprintf(debug_text, "%ix%i in %.01fms", renderer.dst_w, renderer.dst_h,
+			        input_age / 1000.0);
+		else
+			sprintf(debug_text, "%ix%i", renderer.dst_w, renderer.dst_h);
 		blitBitmapText(debug_text, -x, -y, (uint16_t*)renderer.src, pitch_in_pixels, debug_width,
 		               debug_height);
 	}
@@ -4146,9 +4524,24 @@ static void video_refresh_callback_main(const void* data, unsigned width, unsign
 
 	GFX_blitRenderer(&renderer);
 
-	if (!thread_video)
+	if (!thread_video) {
+		uint64_t flip_start = getMicroseconds();
+		Latency_flipStart(flip_start);
 		GFX_flip(screen);
+		uint64_t flip_end = getMicroseconds();
+		Latency_flipEnd(flip_end);
+		frame_wait_us += flip_end - flip_start;
+	}
 	last_flip_time = SDL_GetTicks();
+
+	static int traced_first_frame = 0;
+	if (!traced_first_frame) {
+		traced_first_frame = 1;
+		TRACE_instant("first_frame");
+		LOG_info("Launch: first frame after %llums (%s)",
+		         (unsigned long long)((getMicroseconds() - launch_us) / 1000),
+		         launch_resident ? "resident" : "direct");
+	}
 }
 
 /**
@@ -5444,11 +5837,12 @@ static int Menu_options(MenuList* list) {
 						if (item->desc)
 							desc = item->desc;
 					}
-					text = TTF_RenderUTF8_Blended(font.medium, item->name, text_color);
-					SDL_BlitSurface(text, NULL, screen,
-					                &(SDL_Rect){ox + DP(OPTION_PADDING),
-					                            oy + DP(j * ui.option_size + ui.option_baseline)});
-					SDL_FreeSurface(text);
+					text = GFX_getText(font.medium, item->name, text_color, 0, 0, NULL);
+					if (text)
+						SDL_BlitSurface(
+						    text, NULL, screen,
+						    &(SDL_Rect){ox + DP(OPTION_PADDING),
+						                oy + DP(j * ui.option_size + ui.option_baseline)});
 				}
 			} else if (type == MENU_FIXED) {
 				// NOTE: no need to calculate max width
@@ -5480,15 +5874,13 @@ static int Menu_options(MenuList* list) {
 
 					// Render value text
 					if (item->value >= 0) {
-						char truncated[256];
-						GFX_truncateText(font.small, item->values[item->value], truncated,
-						                 value_text_w, 0);
-						text = TTF_RenderUTF8_Blended(font.small, truncated, COLOR_WHITE);
-						SDL_BlitSurface(
-						    text, NULL, screen,
-						    &(SDL_Rect){ox + mw - text->w - DP(OPTION_PADDING),
-						                oy + DP(j * ui.option_size + ui.option_value_baseline)});
-						SDL_FreeSurface(text);
+						text = GFX_getText(font.small, item->values[item->value], COLOR_WHITE,
+						                   value_text_w, 0, NULL);
+						if (text)
+							SDL_BlitSurface(
+							    text, NULL, screen,
+							    &(SDL_Rect){ox + mw - text->w - DP(OPTION_PADDING),
+							                oy + DP(j * ui.option_size + ui.option_value_baseline)});
 					}
 
 					if (j == selected_row) {
@@ -5502,13 +5894,12 @@ static int Menu_options(MenuList* list) {
 							desc = item->desc;
 					}
 					// Render label text
-					char label_truncated[256];
-					GFX_truncateText(font.medium, item->name, label_truncated, label_text_w, 0);
-					text = TTF_RenderUTF8_Blended(font.medium, label_truncated, text_color);
-					SDL_BlitSurface(text, NULL, screen,
-					                &(SDL_Rect){ox + DP(OPTION_PADDING),
-					                            oy + DP(j * ui.option_size + ui.option_baseline)});
-					SDL_FreeSurface(text);
+					text = GFX_getText(font.medium, item->name, text_color, label_text_w, 0, NULL);
+					if (text)
+						SDL_BlitSurface(
+						    text, NULL, screen,
+						    &(SDL_Rect){ox + DP(OPTION_PADDING),
+						                oy + DP(j * ui.option_size + ui.option_baseline)});
 				}
 			} else if (type == MENU_VAR || type == MENU_INPUT) {
 				int mw = list->max_width;
@@ -5575,27 +5966,24 @@ static int Menu_options(MenuList* list) {
 							desc = item->desc;
 					}
 					// Render label text
-					char label_truncated[256];
-					GFX_truncateText(font.medium, item->name, label_truncated, label_text_w, 0);
-					text = TTF_RenderUTF8_Blended(font.medium, label_truncated, text_color);
-					SDL_BlitSurface(text, NULL, screen,
-					                &(SDL_Rect){ox + DP(OPTION_PADDING),
-					                            oy + DP(j * ui.option_size + ui.option_baseline)});
-					SDL_FreeSurface(text);
+					text = GFX_getText(font.medium, item->name, text_color, label_text_w, 0, NULL);
+					if (text)
+						SDL_BlitSurface(
+						    text, NULL, screen,
+						    &(SDL_Rect){ox + DP(OPTION_PADDING),
+						                oy + DP(j * ui.option_size + ui.option_baseline)});
 
 					if (await_input && j == selected_row) {
 						// buh
 					} else if (item->value >= 0) {
 						// Render value text
-						char truncated[256];
-						GFX_truncateText(font.small, item->values[item->value], truncated,
-						                 value_text_w, 0);
-						text = TTF_RenderUTF8_Blended(font.small, truncated, COLOR_WHITE);
-						SDL_BlitSurface(
-						    text, NULL, screen,
-						    &(SDL_Rect){ox + mw - text->w - DP(OPTION_PADDING),
-						                oy + DP(j * ui.option_size + ui.option_value_baseline)});
-						SDL_FreeSurface(text);
+						text = GFX_getText(font.small, item->values[item->value], COLOR_WHITE,
+						                   value_text_w, 0, NULL);
+						if (text)
+							SDL_BlitSurface(
+							    text, NULL, screen,
+							    &(SDL_Rect){ox + mw - text->w - DP(OPTION_PADDING),
+							                oy + DP(j * ui.option_size + ui.option_value_baseline)});
 					}
 				}
 			}
@@ -5708,7 +6096,7 @@ static void Menu_scale(SDL_Surface* src, SDL_Surface* dst) {
 		}
 	}
 
-	if (scaling == SCALE_ASPECT || rw > dw || rh > dh) {
+	if (scaling == SCALE_ASPECT || scaling == SCALE_SHARP_BILINEAR || rw > dw || rh > dh) {
 		// LOG_info("aspect");
 		double fixed_aspect_ratio = ((double)DEVICE_WIDTH) / DEVICE_HEIGHT;
 		int core_aspect = core.aspect_ratio * 1000;
@@ -6096,21 +6484,19 @@ static void Menu_loop(void) {
 			int ow = GFX_blitHardwareGroup(screen, show_setting);
 			int max_width = DP(ui.screen_width) - DP(ui.edge_padding * 2) - ow;
 
-			char display_name[256];
-			int text_width = GFX_truncateText(font.large, rom_name, display_name, max_width,
-			                                  DP(ui.button_padding * 2));
+			int text_width;
+			SDL_Surface* text = GFX_getText(font.large, rom_name, COLOR_WHITE, max_width,
+			                                DP(ui.button_padding * 2), &text_width);
 			max_width = MIN(max_width, text_width);
 
-			SDL_Surface* text;
-			text = TTF_RenderUTF8_Blended(font.large, display_name, COLOR_WHITE);
 			GFX_blitPill(ASSET_BLACK_PILL, screen,
 			             &(SDL_Rect){DP(ui.edge_padding), DP(ui.edge_padding), max_width,
 			                         DP(ui.pill_height)});
-			SDL_BlitSurface(text, &(SDL_Rect){0, 0, max_width - DP(ui.button_padding * 2), text->h},
-			                screen,
-			                &(SDL_Rect){DP(ui.edge_padding + ui.button_padding),
-			                            DP(ui.edge_padding + ui.text_baseline)});
-			SDL_FreeSurface(text);
+			if (text)
+				SDL_BlitSurface(
+				    text, &(SDL_Rect){0, 0, max_width - DP(ui.button_padding * 2), text->h}, screen,
+				    &(SDL_Rect){DP(ui.edge_padding + ui.button_padding),
+				                DP(ui.edge_padding + ui.text_baseline)});
 
 			if (show_setting && !GetHDMI())
 				GFX_blitHardwareHints(screen, show_setting);
@@ -6138,13 +6524,14 @@ static void Menu_loop(void) {
 						             &(SDL_Rect){DP(ui.edge_padding), DP(oy + ui.padding),
 						                         DP(ui.screen_width - ui.edge_padding * 2),
 						                         DP(ui.pill_height)});
-						text = TTF_RenderUTF8_Blended(font.large, disc_name, COLOR_WHITE);
-						SDL_BlitSurface(
-						    text, NULL, screen,
-						    &(SDL_Rect){DP(ui.screen_width - ui.edge_padding - ui.button_padding) -
-						                    text->w,
-						                DP(oy + ui.padding + ui.text_baseline)});
-						SDL_FreeSurface(text);
+						text = GFX_getText(font.large, disc_name, COLOR_WHITE, 0, 0, NULL);
+						if (text)
+							SDL_BlitSurface(
+							    text, NULL, screen,
+							    &(SDL_Rect){
+							        DP(ui.screen_width - ui.edge_padding - ui.button_padding) -
+							            text->w,
+							        DP(oy + ui.padding + ui.text_baseline)});
 					}
 
 					TTF_SizeUTF8(font.large, item, &ow, NULL);
@@ -6158,21 +6545,21 @@ static void Menu_loop(void) {
 					text_color = COLOR_BLACK;
 				} else {
 					// shadow
-					text = TTF_RenderUTF8_Blended(font.large, item, COLOR_BLACK);
-					SDL_BlitSurface(text, NULL, screen,
-					                &(SDL_Rect){DP(2 + ui.edge_padding + ui.button_padding),
-					                            DP(1 + ui.padding + oy + (i * ui.pill_height) +
-					                               ui.text_baseline)});
-					SDL_FreeSurface(text);
+					text = GFX_getText(font.large, item, COLOR_BLACK, 0, 0, NULL);
+					if (text)
+						SDL_BlitSurface(text, NULL, screen,
+						                &(SDL_Rect){DP(2 + ui.edge_padding + ui.button_padding),
+						                            DP(1 + ui.padding + oy + (i * ui.pill_height) +
+						                               ui.text_baseline)});
 				}
 
 				// text
-				text = TTF_RenderUTF8_Blended(font.large, item, text_color);
-				SDL_BlitSurface(
-				    text, NULL, screen,
-				    &(SDL_Rect){DP(ui.edge_padding + ui.button_padding),
-				                DP(oy + ui.padding + (i * ui.pill_height) + ui.text_baseline)});
-				SDL_FreeSurface(text);
+				text = GFX_getText(font.large, item, text_color, 0, 0, NULL);
+				if (text)
+					SDL_BlitSurface(
+					    text, NULL, screen,
+					    &(SDL_Rect){DP(ui.edge_padding + ui.button_padding),
+					                DP(oy + ui.padding + (i * ui.pill_height) + ui.text_baseline)});
 			}
 
 			// slot preview
@@ -6428,7 +6815,11 @@ static void* coreThread(void* arg) {
 				core.audio_buffer_status(true, occupancy, occupancy < 25);
 			}
 
+			frame_wait_us = 0;
+			Movie_update();
+			uint64_t run_start = getMicroseconds();
 			core.run();
+			autoCPU(getMicroseconds() - run_start);
 			limitFF();
 			trackFPS();
 		}
@@ -6436,6 +6827,270 @@ static void* coreThread(void* arg) {
 	pthread_exit(NULL);
 }
 
+///////////////////////////////////////
+// Resident Host
+//
+// When RESIDENT_MODE_PATH exists, the first launch spawns a long-lived
+// host (minarch.elf --resident) and every later minarch.elf just hands its
+// core and ROM to it (see resident.h). The host keeps the most recently
+// used cores dlopen()ed and forks a child per game, so each game starts
+// with its core already mapped and relocated but with completely fresh
+// frontend state. The core's retro_init/retro_deinit only ever run in the
+// child, which makes reuse safe for every core, and a crashing core only
+// takes down its child; the next launch forks a clean one.
+//
+// This only saves the dlopen(). Each child still runs GFX_init, SND_init,
+// PAD_init and PWR_init, because the launcher owns the display and input
+// devices between games and the audio rate depends on the core. The
+// client is still exec'd by launch.sh through /tmp/next. The host serves
+// one launch at a time and blocks in waitpid() until that game exits.
+// The child logs its first frame against the client's start time, the same
+// measure a direct launch logs, so the two can be compared per core.
+///////////////////////////////////////
+
+#define RESIDENT_CORE_MAX 2 // Cores kept loaded by the host
+
+static struct {
+	char path[MAX_PATH];
+	void* handle;
+	uint32_t used_at; // Launch counter value at last use (LRU)
+} resident_cores[RESIDENT_CORE_MAX];
+static uint32_t resident_launches;
+
+int MinArch_run(int argc, char* argv[]);
+
+/**
+ * Keeps a core loaded in the host, evicting the least recently used one.
+ *
+ * @param core_path Full path to core .so file
+ */
+static void Resident_keepCore(const char* core_path) {
+	resident_launches += 1;
+
+	int slot = 0;
+	for (int i = 0; i < RESIDENT_CORE_MAX; i++) {
+		if (resident_cores[i].handle && exactMatch(resident_cores[i].path, (char*)core_path)) {
+			resident_cores[i].used_at = resident_launches;
+			return;
+		}
+		if (resident_cores[i].used_at < resident_cores[slot].used_at)
+			slot = i;
+	}
+
+	if (resident_cores[slot].handle) {
+		LOG_info("Resident: unloading %s", resident_cores[slot].path);
+		dlclose(resident_cores[slot].handle);
+		resident_cores[slot].handle = NULL;
+	}
+
+	uint64_t start = getMicroseconds();
+	void* handle = dlopen(core_path, RTLD_LAZY);
+	if (!handle) {
+		LOG_error("Resident: %s", dlerror());
+		return;
+	}
+	LOG_info("Resident: loaded %s in %llums", core_path,
+	         (unsigned long long)((getMicroseconds() - start) / 1000));
+
+	strcpy(resident_cores[slot].path, core_path);
+	resident_cores[slot].handle = handle;
+	resident_cores[slot].used_at = resident_launches;
+}
+
+/**
+ * Drops a core from the host (after it crashed a game).
+ *
+ * @param core_path Full path to core .so file
+ */
+static void Resident_dropCore(const char* core_path) {
+	for (int i = 0; i < RESIDENT_CORE_MAX; i++) {
+		if (resident_cores[i].handle && exactMatch(resident_cores[i].path, (char*)core_path)) {
+			dlclose(resident_cores[i].handle);
+			resident_cores[i].handle = NULL;
+			resident_cores[i].used_at = 0;
+		}
+	}
+}
+
+/**
+ * Runs one game in a child process of the host.
+ *
+ * @param client Connection to the waiting minarch.elf
+ * @param listen_fd Host socket (closed in the child)
+ * @param request Launch request, its descriptors are closed before returning
+ */
+static void Resident_launch(int client, int listen_fd, ResidentRequest* request) {
+	Resident_keepCore(request->core_path);
+
+	pid_t pid = fork();
+	if (pid == 0) {
+		// Child: become the minarch.elf that launch.sh started
+		close(listen_fd);
+		for (int i = 0; i < 3; i++) {
+			if (request->fds[i] >= 0) {
+				dup2(request->fds[i], i);
+				close(request->fds[i]);
+			}
+		}
+		if (chdir(request->cwd) != 0)
+			LOG_errno("Resident: failed to enter %s", request->cwd);
+		setpriority(PRIO_PROCESS, 0, request->priority);
+		signal(SIGPIPE, SIG_DFL);
+		signal(SIGCHLD, SIG_DFL);
+		launch_us = request->launch_us;
+		launch_resident = 1;
+
+		// The client connection stays open (without being inherited by anything
+		// this game execs) so the client only sees EOF once the game is gone
+		char* argv[] = {"minarch.elf", request->core_path, request->rom_path, NULL};
+		exit(MinArch_run(3, argv)); // not _exit(), so atexit handlers (trace flush) run
+	}
+
+	for (int i = 0; i < 3; i++) {
+		if (request->fds[i] >= 0)
+			close(request->fds[i]);
+	}
+	if (pid < 0) {
+		LOG_errno("Resident: fork failed");
+		return; // client sees EOF before STARTED and runs the game itself
+	}
+
+	Resident_sendReply(client, RESIDENT_REPLY_STARTED, pid);
+
+	int status = 0;
+	while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+		;
+	if (WIFSIGNALED(status)) {
+		LOG_error("Resident: %s crashed (signal %i)", request->rom_path, WTERMSIG(status));
+		Resident_dropCore(request->core_path);
+	}
+
+	Resident_sendReply(client, RESIDENT_REPLY_EXITED, status);
+}
+
+/**
+ * Host main loop: serves launch requests until killed.
+ *
+ * @return EXIT_FAILURE if the socket couldn't be created
+ */
+static int Resident_host(void) {
+	signal(SIGPIPE, SIG_IGN); // a client vanishing must not take the host down
+
+	int listen_fd = Resident_listen(RESIDENT_SOCKET_PATH);
+	if (listen_fd < 0)
+		return EXIT_FAILURE;
+
+	LOG_info("Resident: listening on %s", RESIDENT_SOCKET_PATH);
+	while (1) {
+		int client = accept(listen_fd, NULL, NULL);
+		if (client < 0) {
+			if (errno == EINTR)
+				continue;
+			LOG_errno("Resident: accept failed");
+			break;
+		}
+		fcntl(client, F_SETFD, FD_CLOEXEC);
+
+		ResidentRequest request;
+		if (Resident_recvRequest(client, &request))
+			Resident_launch(client, listen_fd, &request);
+		close(client);
+	}
+
+	close(listen_fd);
+	unlink(RESIDENT_SOCKET_PATH);
+	return EXIT_FAILURE;
+}
+
+/**
+ * Starts a detached resident host for the next launch to use.
+ */
+static void Resident_spawnHost(void) {
+	pid_t pid = fork();
+	if (pid < 0)
+		return;
+	if (pid > 0) {
+		waitpid(pid, NULL, 0);
+		return;
+	}
+
+	// Double fork so the host is reparented to init and never becomes a zombie
+	setsid();
+	if (fork() != 0)
+		_exit(EXIT_SUCCESS);
+
+	int null_fd = open("/dev/null", O_RDWR);
+	if (null_fd >= 0)
+		dup2(null_fd, STDIN_FILENO);
+
+	char log_path[MAX_PATH];
+	char* logs_path = getenv("LOGS_PATH");
+	if (logs_path) {
+		snprintf(log_path, sizeof(log_path), "%s/minarch-resident.log", logs_path);
+		int log_fd = open(log_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (log_fd >= 0) {
+			dup2(log_fd, STDOUT_FILENO);
+			dup2(log_fd, STDERR_FILENO);
+			close(log_fd);
+		}
+	}
+	if (null_fd > STDERR_FILENO)
+		close(null_fd);
+
+	execl("/proc/self/exe", "minarch.elf", "--resident", (char*)NULL);
+	_exit(EXIT_FAILURE);
+}
+
+/**
+ * Hands a launch to the resident host if one is running.
+ *
+ * @param core_path Full path to core .so file
+ * @param rom_path Full path to ROM
+ * @param exit_code Output: exit code to return when handled
+ * @return 1 if the host ran the game, 0 if the caller should run it itself
+ */
+static int Resident_forward(char* core_path, char* rom_path, int* exit_code) {
+	int fd = Resident_connect(RESIDENT_SOCKET_PATH);
+	if (fd < 0) {
+		LOG_info("Resident: no host, starting one for next time");
+		Resident_spawnHost();
+		return 0;
+	}
+
+	ResidentRequest request;
+	memset(&request, 0, sizeof(request));
+	snprintf(request.core_path, sizeof(request.core_path), "%s", core_path);
+	snprintf(request.rom_path, sizeof(request.rom_path), "%s", rom_path);
+	if (!getcwd(request.cwd, sizeof(request.cwd)))
+		strcpy(request.cwd, "/");
+	request.priority = getpriority(PRIO_PROCESS, 0);
+	request.launch_us = launch_us;
+	request.fds[0] = STDIN_FILENO;
+	request.fds[1] = STDOUT_FILENO;
+	request.fds[2] = STDERR_FILENO;
+
+	int32_t type = 0;
+	int32_t value = 0;
+	if (!Resident_sendRequest(fd, &request) || !Resident_recvReply(fd, &type, &value) ||
+	    type != RESIDENT_REPLY_STARTED) {
+		LOG_error("Resident: host did not start the game, running it here");
+		close(fd);
+		return 0;
+	}
+	LOG_info("Resident: running in host child %i", value);
+
+	if (!Resident_recvReply(fd, &type, &value) || type != RESIDENT_REPLY_EXITED) {
+		LOG_error("Resident: lost contact with host");
+		*exit_code = EXIT_FAILURE;
+	} else if (WIFEXITED(value)) {
+		*exit_code = WEXITSTATUS(value);
+	} else {
+		*exit_code = EXIT_FAILURE;
+	}
+	close(fd);
+	return 1;
+}
+
 ///////////////////////////////////////
 // Main Entry Point
 ///////////////////////////////////////
@@ -6472,7 +7127,11 @@ static void* coreThread(void* arg) {
  *
  * @note Exits early if game fails to load
  */
-int main(int argc, char* argv[]) {
+int MinArch_run(int argc, char* argv[]) {
+	if (exists(TRACE_MODE_PATH))
+		trace_start(TRACE_PATH, "minarch");
+	log_async_start();
+	TRACE_instant("minarch_start");
 	LOG_info("MinArch");
 
 	setOverclock(overclock); // default to normal
@@ -6490,8 +7149,15 @@ int main(int argc, char* argv[]) {
 
 	LOG_info("rom_path: %s", rom_path);
 
+	TRACE_begin("GFX_init");
 	screen = GFX_init(MODE_MENU);
+	TRACE_end("GFX_init");
 	PAD_init();
+	// Only platforms reading evdev themselves can move it to a thread
+	if (PAD_startThread())
+		PAD_stopThread();
+	else
+		config.frontend.options[FE_OPT_INPUT].lock = 1;
 	DEVICE_WIDTH = screen->w;
 	DEVICE_HEIGHT = screen->h;
 	DEVICE_PITCH = screen->pitch;
@@ -6505,8 +7171,13 @@ int main(int argc, char* argv[]) {
 
 	// Overrides_init();
 
+	// The launcher warms these files with readahead while hovering
+	TRACE_begin("Core_open");
 	Core_open(core_path, tag_name);
+	TRACE_end("Core_open");
+	TRACE_begin("Game_open");
 	Game_open(rom_path); // nes tries to load gamegenie setting before this returns ffs
+	TRACE_end("Game_open");
 	if (!game.is_open)
 		goto finish;
 
@@ -6527,16 +7198,22 @@ int main(int argc, char* argv[]) {
 	// ah, because it's defined before options_menu...
 	options_menu.items[1].desc = (char*)core.version;
 
+	TRACE_begin("Core_load");
 	Core_load();
+	TRACE_end("Core_load");
 	Input_init(NULL);
 	Config_readOptions(); // but others load and report options later (eg. nes)
 	Config_readControls(); // restore controls (after the core has reported its defaults)
 	Config_free();
 
+	TRACE_begin("SND_init");
 	SND_init(core.sample_rate, core.fps);
+	TRACE_end("SND_init");
 	InitSettings(); // after we initialize audio
 	Menu_init();
+	TRACE_begin("State_resume");
 	State_resume();
+	TRACE_end("State_resume");
 	Menu_initState(); // make ready for state shortcuts
 
 	if (thread_video) {
@@ -6555,6 +7232,18 @@ int main(int argc, char* argv[]) {
 
 	Special_init(); // after config
 
+	char* latency_samples = getenv("MINARCH_LATENCY");
+	if (latency_samples)
+		Latency_start(atoi(latency_samples), getMicroseconds());
+
+	// Play a movie as a fixed workload and quit when it ends
+	char* movie = getenv("MINARCH_MOVIE");
+	if (movie) {
+		snprintf(movie_path, sizeof(movie_path), "%s", movie);
+		movie_quit = 1;
+		movie_request = MOVIE_REQUEST_PLAY;
+	}
+
 	sec_start = SDL_GetTicks();
 	while (!quit) {
 		GFX_startFrame();
@@ -6590,7 +7279,11 @@ int main(int argc, char* argv[]) {
 				core.audio_buffer_status(true, occupancy, occupancy < 25);
 			}
 
+			frame_wait_us = 0;
+			Movie_update();
+			uint64_t run_start = getMicroseconds();
 			core.run();
+			autoCPU(getMicroseconds() - run_start);
 			limitFF();
 			trackFPS();
 		}
@@ -6602,7 +7295,9 @@ int main(int argc, char* argv[]) {
 			if (backbuffer) {
 				video_refresh_callback_main(backbuffer->pixels, backbuffer->w, backbuffer->h,
 				                            backbuffer->pitch);
+				Latency_flipStart(getMicroseconds());
 				GFX_flip(screen);
+				Latency_flipEnd(getMicroseconds());
 			}
 			core_rq = (pthread_cond_t)PTHREAD_COND_INITIALIZER;
 			pthread_mutex_unlock(&core_mx);
@@ -6640,11 +7335,19 @@ int main(int argc, char* argv[]) {
 		// LOG_info("frame duration: %ims", SDL_GetTicks()-frame_start);
 
 		hdmimon();
+
+		if (Latency_isDone())
+			quit = 1;
 	}
 
+	Latency_report();
+	Movie_stop();
 	Menu_quit();
 	QuitSettings();
 
+	if (governor_active)
+		autoCPU_report();
+
 finish:
 
 	Game_close();
@@ -6663,8 +7366,33 @@ finish:
 	SND_quit();
 	PAD_quit();
 	GFX_quit();
+	ScalerPool_quit();
 
 	convert_buffer_free();
 
 	return EXIT_SUCCESS;
 }
+
+/**
+ * Process entry point.
+ *
+ * Runs the resident host for --resident, otherwise hands the launch to a
+ * running host when resident mode is enabled, falling back to running the
+ * game in this process.
+ *
+ * @param argc Argument count
+ * @param argv Arguments: core .so path and ROM path, or --resident
+ * @return Exit code of the game
+ */
+int main(int argc, char* argv[]) {
+	if (argc > 1 && exactMatch(argv[1], "--resident"))
+		return Resident_host();
+
+	launch_us = getMicroseconds();
+
+	int exit_code;
+	if (argc > 2 && exists(RESIDENT_MODE_PATH) && Resident_forward(argv[1], argv[2], &exit_code))
+		return exit_code;
+
+	return MinArch_run(argc, argv);
+}
@@ -34,16 +34,21 @@
 #include <fcntl.h>
 #include <msettings.h>
 #include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include "api.h"
 #include "collections.h"
 #include "defines.h"
+#include "readahead.h"
 #include "str_compare.h"
+#include "thumb_cache.h"
+#include "thumb_store.h"
 #include "utils.h"
 
 ///////////////////////////////
@@ -69,44 +74,180 @@
 #define THUMB_ALPHA_MAX 255 // Fully opaque
 #define THUMB_ALPHA_MIN 0 // Fully transparent
 
+// Idle loop
+// After this many frames with nothing to draw, the main loop stops ticking
+// at the display rate and blocks on input instead. It still wakes when
+// PWR_untilUpdate() says battery, wifi, charger or autosleep state is due.
+#define IDLE_FRAME_THRESHOLD 30 // ~0.5s at 60fps
+
 ///////////////////////////////
 // Async thumbnail loader
 //
-// Loads thumbnails in a background thread to prevent UI stutter during scrolling.
-// Design: Single worker thread with request superseding (new requests cancel pending).
-// Thread-safe handoff via mutex-protected result surface.
+// Loads thumbnails in the background to prevent UI stutter during scrolling.
+// Design: Small worker pool fed by a priority queue (selected entry first, then
+// neighbors in scroll direction). Decoded, pre-scaled surfaces are handed back
+// to the UI thread and kept in a byte-budgeted LRU (ThumbCache), so scrolling
+// back and forth shows art without decoding the same PNGs again.
+// Workers also persist scaled thumbnails to disk (ThumbStore) in display pixel
+// format, so after the first visit a thumbnail is a raw read instead of a decode.
 ///////////////////////////////
 
+#define THUMB_WORKER_COUNT 2 // Background decode threads
+#define THUMB_PREFETCH_AHEAD 3 // Entries to prefetch in scroll direction
+#define THUMB_PREFETCH_BEHIND 1 // Entries to prefetch against scroll direction
+#define THUMB_QUEUE_MAX (1 + THUMB_PREFETCH_AHEAD + THUMB_PREFETCH_BEHIND)
+#define THUMB_RESULT_MAX (THUMB_QUEUE_MAX + THUMB_WORKER_COUNT)
+#define THUMB_CACHE_BUDGET (12 * 1024 * 1024) // Decoded surfaces kept in memory
+
 // Thumbnail loader state
-static pthread_t thumb_thread;
-static int thumb_thread_valid; // Whether thread was successfully created
+static pthread_t thumb_threads[THUMB_WORKER_COUNT];
+static int thumb_thread_count; // Number of threads successfully created
 static pthread_mutex_t thumb_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t thumb_cond = PTHREAD_COND_INITIALIZER;
+static int thumb_max_width; // Max width for scaling
+static int thumb_max_height; // Max height for scaling
+static SDL_PixelFormat* thumb_format; // Screen format opaque thumbnails are converted to
 
 // Request state (protected by thumb_mutex)
-static char thumb_request_path[MAX_PATH]; // Path to load (empty = no request)
-static int thumb_request_width; // Max width for scaling
-static int thumb_request_height; // Max height for scaling
-static int thumb_shutdown; // Signal thread to exit
+static char thumb_queue[THUMB_QUEUE_MAX][MAX_PATH]; // Paths to load, highest priority first
+static int thumb_queue_count;
+static char thumb_inflight[THUMB_WORKER_COUNT][MAX_PATH]; // Path each worker is decoding
+static int thumb_shutdown; // Signal threads to exit
 
 // Result state (protected by thumb_mutex)
-static SDL_Surface* thumb_result; // Loaded surface (NULL if no thumbnail)
-static char thumb_result_path[MAX_PATH]; // Path that was loaded
+typedef struct ThumbResult {
+	char path[MAX_PATH];
+	SDL_Surface* surface; // NULL if no thumbnail exists
+} ThumbResult;
+static ThumbResult thumb_results[THUMB_RESULT_MAX];
+static int thumb_result_count;
+
+// Decoded thumbnails (UI thread only)
+static ThumbCache* thumb_cache;
+
+/**
+ * Releases a cached thumbnail surface.
+ */
+static void thumb_free_surface(void* data) {
+	SDL_FreeSurface((SDL_Surface*)data);
+}
+
+/**
+ * Loads a thumbnail from the disk cache.
+ *
+ * @param path Source image path
+ * @param store_path Cache file path
+ * @param key Source mtime/size and target box
+ * @return Surface on a valid hit, NULL on miss
+ */
+static SDL_Surface* thumb_load_cached(const char* path, const char* store_path,
+                                      ThumbStoreInfo key) {
+	int fd = ThumbStore_open(store_path, path, &key);
+	if (fd < 0)
+		return NULL;
+
+	SDL_Surface* surface = SDL_CreateRGBSurface(0, key.w, key.h, key.bpp, key.rmask, key.gmask,
+	                                            key.bmask, key.amask);
+	if (surface &&
+	    (surface->pitch != key.pitch || !ThumbStore_readPixels(fd, &key, surface->pixels))) {
+		SDL_FreeSurface(surface);
+		surface = NULL;
+	}
+	close(fd);
+	return surface;
+}
+
+/**
+ * Decodes, scales and converts a thumbnail, then writes it to the disk cache.
+ *
+ * Opaque thumbnails are converted to the screen format so blitting them is a
+ * plain copy. Thumbnails with an alpha channel keep their 32-bit format since
+ * SDL blits expect straight (not premultiplied) alpha.
+ *
+ * @param path Source image path
+ * @param store_path Cache file path, or NULL to skip writing
+ * @param key Source mtime/size and target box
+ * @return Scaled surface, or NULL if the image couldn't be loaded
+ */
+static SDL_Surface* thumb_load_source(const char* path, const char* store_path,
+                                      ThumbStoreInfo key) {
+	SDL_Surface* orig = IMG_Load(path);
+	if (!orig)
+		return NULL;
+
+	SDL_Surface* loaded = GFX_scaleToFit(orig, key.max_w, key.max_h);
+	if (loaded != orig)
+		SDL_FreeSurface(orig);
+
+	if (!loaded->format->Amask && thumb_format &&
+	    (loaded->format->BitsPerPixel != thumb_format->BitsPerPixel ||
+	     loaded->format->Rmask != thumb_format->Rmask ||
+	     loaded->format->Gmask != thumb_format->Gmask ||
+	     loaded->format->Bmask != thumb_format->Bmask)) {
+		SDL_Surface* converted = SDL_ConvertSurface(loaded, thumb_format, 0);
+		if (converted) {
+			SDL_FreeSurface(loaded);
+			loaded = converted;
+		}
+	}
+
+	if (store_path && loaded->format->BitsPerPixel >= 16) { // Palettized can't be stored raw
+		key.w = loaded->w;
+		key.h = loaded->h;
+		key.pitch = loaded->pitch;
+		key.bpp = loaded->format->BitsPerPixel;
+		key.rmask = loaded->format->Rmask;
+		key.gmask = loaded->format->Gmask;
+		key.bmask = loaded->format->Bmask;
+		key.amask = loaded->format->Amask;
+		ThumbStore_write(store_path, path, &key, loaded->pixels);
+	}
+
+	return loaded;
+}
+
+/**
+ * Loads a scaled thumbnail, from the disk cache when possible.
+ *
+ * @param path Source image path
+ * @return Scaled surface, or NULL if no thumbnail exists
+ */
+static SDL_Surface* thumb_load(const char* path) {
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return NULL;
+
+	ThumbStoreInfo key = {0};
+	key.mtime = st.st_mtime;
+	key.size = st.st_size;
+	key.max_w = thumb_max_width;
+	key.max_h = thumb_max_height;
+
+	char store_path[MAX_PATH];
+	if (!ThumbStore_getPath(store_path, sizeof(store_path), THUMB_CACHE_PATH, path))
+		return thumb_load_source(path, NULL, key);
+
+	SDL_Surface* surface = thumb_load_cached(path, store_path, key);
+	if (!surface)
+		surface = thumb_load_source(path, store_path, key);
+	return surface;
+}
 
 /**
  * Background thread function for loading thumbnails.
- * Waits for requests, loads and scales images, posts results.
+ * Takes the highest priority request, loads and scales it, posts the result.
+ *
+ * @param arg Worker index (into thumb_inflight)
  */
 static void* thumb_loader_thread(void* arg) {
-	(void)arg;
-	LOG_debug("Thumbnail thread started");
+	int worker = (int)(intptr_t)arg;
+	LOG_debug("Thumbnail thread %i started", worker);
 
 	char path[MAX_PATH];
-	int max_w, max_h;
 	while (1) {
 		// Wait for a request
 		pthread_mutex_lock(&thumb_mutex);
-		while (thumb_request_path[0] == '\0' && !thumb_shutdown) {
+		while (thumb_queue_count == 0 && !thumb_shutdown) {
 			pthread_cond_wait(&thumb_cond, &thumb_mutex);
 		}
 
@@ -115,37 +256,26 @@ static void* thumb_loader_thread(void* arg) {
 			break;
 		}
 
-		// Copy request parameters
-		strcpy(path, thumb_request_path);
-		max_w = thumb_request_width;
-		max_h = thumb_request_height;
-		thumb_request_path[0] = '\0'; // Clear request
+		// Pop the front of the queue
+		strcpy(path, thumb_queue[0]);
+		thumb_queue_count -= 1;
+		memmove(thumb_queue[0], thumb_queue[1], thumb_queue_count * MAX_PATH);
+		strcpy(thumb_inflight[worker], path);
 		pthread_mutex_unlock(&thumb_mutex);
 
 		// Load and scale (slow operations, done without lock)
-		// Note: caller already verified file exists before requesting
-		SDL_Surface* loaded = NULL;
-		SDL_Surface* orig = IMG_Load(path);
-		if (orig) {
-			loaded = GFX_scaleToFit(orig, max_w, max_h);
-			if (loaded != orig)
-				SDL_FreeSurface(orig);
-		}
+		SDL_Surface* loaded = thumb_load(path);
 
-		// Post result
+		// Post result (even if superseded, it's still worth caching)
 		pthread_mutex_lock(&thumb_mutex);
-		// Check if request was superseded while we were loading
-		if (thumb_request_path[0] == '\0') {
-			// No new request - post our result
-			if (thumb_result)
-				SDL_FreeSurface(thumb_result);
-			thumb_result = loaded;
-			strcpy(thumb_result_path, path);
-		} else {
-			// Request was superseded - discard our result
-			if (loaded)
-				SDL_FreeSurface(loaded);
+		if (thumb_result_count < THUMB_RESULT_MAX) {
+			ThumbResult* result = &thumb_results[thumb_result_count++];
+			strcpy(result->path, path);
+			result->surface = loaded;
+		} else if (loaded) {
+			SDL_FreeSurface(loaded);
 		}
+		thumb_inflight[worker][0] = '\0';
 		pthread_mutex_unlock(&thumb_mutex);
 	}
 
@@ -153,79 +283,307 @@ static void* thumb_loader_thread(void* arg) {
 }
 
 /**
- * Starts the thumbnail loader thread.
- * Call once at startup.
+ * Starts the thumbnail worker threads and creates the cache.
+ * Call once at startup, after GFX_init() so the layout is known.
+ *
+ * @param screen Screen surface (opaque thumbnails are stored in its format)
  */
-static void ThumbLoader_init(void) {
-	thumb_request_path[0] = '\0';
-	thumb_result_path[0] = '\0';
-	thumb_result = NULL;
+static void ThumbLoader_init(SDL_Surface* screen) {
+	int padding = DP(ui.edge_padding);
+	thumb_max_width = (ui.screen_width_px * THUMB_MAX_WIDTH_PERCENT) / 100 - padding;
+	thumb_max_height = ui.screen_height_px - (padding * 2);
+	thumb_format = screen ? screen->format : NULL;
+
+	mkdir(USERDATA_PATH "/.minui", 0755);
+	mkdir(THUMB_CACHE_PATH, 0755);
+
+	thumb_cache = ThumbCache_new(THUMB_CACHE_BUDGET, thumb_free_surface);
+	thumb_queue_count = 0;
+	thumb_result_count = 0;
 	thumb_shutdown = 0;
-	thumb_thread_valid = 0;
-	int rc = pthread_create(&thumb_thread, NULL, thumb_loader_thread, NULL);
-	if (rc != 0) {
-		LOG_error("Failed to create thumbnail thread: %d", rc);
-	} else {
-		thumb_thread_valid = 1;
+	thumb_thread_count = 0;
+	for (int i = 0; i < THUMB_WORKER_COUNT; i++) {
+		thumb_inflight[i][0] = '\0';
+		int rc =
+		    pthread_create(&thumb_threads[i], NULL, thumb_loader_thread, (void*)(intptr_t)i);
+		if (rc != 0) {
+			LOG_error("Failed to create thumbnail thread: %d", rc);
+			break;
+		}
+		thumb_thread_count += 1;
 	}
 }
 
 /**
- * Stops the thumbnail loader thread and frees resources.
+ * Stops the thumbnail worker threads and frees all cached thumbnails.
  * Call once at shutdown.
  */
 static void ThumbLoader_quit(void) {
-	if (thumb_thread_valid) {
-		pthread_mutex_lock(&thumb_mutex);
-		thumb_shutdown = 1;
-		pthread_cond_signal(&thumb_cond);
-		pthread_mutex_unlock(&thumb_mutex);
+	pthread_mutex_lock(&thumb_mutex);
+	thumb_shutdown = 1;
+	pthread_cond_broadcast(&thumb_cond);
+	pthread_mutex_unlock(&thumb_mutex);
 
-		pthread_join(thumb_thread, NULL);
+	for (int i = 0; i < thumb_thread_count; i++) {
+		pthread_join(thumb_threads[i], NULL);
 	}
+	thumb_thread_count = 0;
 
-	if (thumb_result) {
-		SDL_FreeSurface(thumb_result);
-		thumb_result = NULL;
+	for (int i = 0; i < thumb_result_count; i++) {
+		if (thumb_results[i].surface)
+			SDL_FreeSurface(thumb_results[i].surface);
 	}
+	thumb_result_count = 0;
+
+	ThumbCache_free(thumb_cache);
+	thumb_cache = NULL;
 }
 
 /**
- * Requests a thumbnail to be loaded asynchronously.
- * Supersedes any pending request. Returns immediately.
- *
- * @param path Path to image file
- * @param max_w Maximum width after scaling
- * @param max_h Maximum height after scaling
+ * Drops all pending (not yet started) requests.
+ * Thumbnails already being decoded still land in the cache.
  */
-static void ThumbLoader_request(const char* path, int max_w, int max_h) {
+static void ThumbLoader_cancel(void) {
 	pthread_mutex_lock(&thumb_mutex);
-	strcpy(thumb_request_path, path);
-	thumb_request_width = max_w;
-	thumb_request_height = max_h;
-	pthread_cond_signal(&thumb_cond);
+	thumb_queue_count = 0;
 	pthread_mutex_unlock(&thumb_mutex);
 }
 
 /**
- * Checks if a thumbnail is ready and retrieves it.
- * Non-blocking - returns NULL if not ready or path doesn't match.
+ * Replaces the pending queue with new requests. Returns immediately.
+ * Paths already cached, being decoded, or awaiting pickup are skipped.
  *
- * @param path Path that was requested
- * @return Surface if ready and path matches (caller takes ownership), NULL otherwise
+ * @param paths Thumbnail paths in priority order
+ * @param count Number of paths
  */
-static SDL_Surface* ThumbLoader_get(const char* path) {
-	SDL_Surface* result = NULL;
+static void ThumbLoader_request(char paths[][MAX_PATH], int count) {
+	if (thumb_thread_count == 0 || thumb_max_width <= 0 || thumb_max_height <= 0)
+		return;
 
 	pthread_mutex_lock(&thumb_mutex);
-	if (thumb_result && exactMatch(thumb_result_path, path)) {
-		result = thumb_result;
-		thumb_result = NULL;
-		thumb_result_path[0] = '\0';
+	thumb_queue_count = 0;
+	for (int i = 0; i < count && thumb_queue_count < THUMB_QUEUE_MAX; i++) {
+		if (ThumbCache_has(thumb_cache, paths[i]))
+			continue;
+
+		int busy = 0;
+		for (int j = 0; j < THUMB_WORKER_COUNT && !busy; j++) {
+			busy = exactMatch(thumb_inflight[j], paths[i]);
+		}
+		for (int j = 0; j < thumb_result_count && !busy; j++) {
+			busy = exactMatch(thumb_results[j].path, paths[i]);
+		}
+		if (!busy)
+			strcpy(thumb_queue[thumb_queue_count++], paths[i]);
 	}
+	if (thumb_queue_count > 0)
+		pthread_cond_broadcast(&thumb_cond);
 	pthread_mutex_unlock(&thumb_mutex);
+}
+
+/**
+ * Moves finished thumbnails from the workers into the cache.
+ * Call once per frame from the UI thread.
+ */
+static void ThumbLoader_poll(void) {
+	ThumbResult results[THUMB_RESULT_MAX];
+	int count;
+
+	pthread_mutex_lock(&thumb_mutex);
+	count = thumb_result_count;
+	memcpy(results, thumb_results, count * sizeof(ThumbResult));
+	thumb_result_count = 0;
+	pthread_mutex_unlock(&thumb_mutex);
+
+	for (int i = 0; i < count; i++) {
+		SDL_Surface* surface = results[i].surface;
+		size_t bytes = surface ? sizeof(SDL_Surface) + (size_t)surface->pitch * surface->h : 0;
+		ThumbCache_put(thumb_cache, results[i].path, surface, bytes);
+	}
+}
+
+/**
+ * Looks up a decoded thumbnail in the cache.
+ *
+ * @param path Thumbnail path
+ * @param surface Output: cached surface (NULL if no thumbnail exists), owned by the cache
+ * @return 1 if the path has been loaded, 0 if it is still pending
+ */
+static int ThumbLoader_get(const char* path, SDL_Surface** surface) {
+	void* data = NULL;
+	if (!ThumbCache_get(thumb_cache, path, &data))
+		return 0;
+	*surface = data;
+	return 1;
+}
+
+/**
+ * Protects the displayed thumbnail from eviction by prefetched ones.
+ *
+ * @param path Thumbnail path on screen, or NULL
+ */
+static void ThumbLoader_pin(const char* path) {
+	ThumbCache_pin(thumb_cache, path);
+}
+
+/**
+ * Builds the thumbnail path for an entry: /dir/.res/filename.png
+ *
+ * @param entry_path Full path to the ROM or folder
+ * @param thumb_path Output buffer (MAX_PATH bytes)
+ * @return 1 if a path was built, 0 if entry_path has no usable filename
+ */
+static int getThumbPath(const char* entry_path, char* thumb_path) {
+	thumb_path[0] = '\0';
+	if (!entry_path)
+		return 0;
+
+	char* last_slash = strrchr(entry_path, '/');
+	if (!last_slash || last_slash[1] == '\0')
+		return 0;
+
+	int dir_len = (int)(last_slash - entry_path);
+	if (dir_len <= 0 || dir_len >= MAX_PATH - 32) // Leave room for /.res/name.png
+		return 0;
+
+	snprintf(thumb_path, MAX_PATH, "%.*s/.res/%s.png", dir_len, entry_path, last_slash + 1);
+	return 1;
+}
+
+///////////////////////////////
+// ROM and core readahead
+//
+// Once a selection has been stable for READAHEAD_HOVER_MS, a single
+// background thread reads the files a launch will need into the page
+// cache: the ROM (or the first disc's tracks) and the core .so.
+// Readahead is chunked and paced (see readahead.h), and any selection
+// change cancels it before the next chunk, so scrolling is never slowed.
+///////////////////////////////
+
+#define READAHEAD_HOVER_MS 300 // Selection must be stable this long
+#define READAHEAD_TARGET_MAX 8 // ROM/disc tracks + core
+#define READAHEAD_ROM_BYTES (16 * 1024 * 1024) // Cartridge ROMs are read whole
+#define READAHEAD_DISC_BYTES (4 * 1024 * 1024) // Disc images: header and boot area only
+#define READAHEAD_CORE_BYTES (16 * 1024 * 1024)
+
+typedef struct ReadaheadTarget {
+	char path[MAX_PATH];
+	int64_t max_bytes;
+} ReadaheadTarget;
 
-	return result;
+static pthread_t readahead_thread;
+static int readahead_running; // Whether readahead_thread was created
+static pthread_mutex_t readahead_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t readahead_cond = PTHREAD_COND_INITIALIZER;
+
+// Request state (protected by readahead_mutex)
+static ReadaheadTarget readahead_targets[READAHEAD_TARGET_MAX];
+static int readahead_target_count;
+static unsigned readahead_generation; // Bumped on every request or cancel
+static int readahead_shutdown;
+
+/**
+ * Cancel callback for Readahead_file: stops once a newer request arrives.
+ *
+ * @param userdata Pointer to the generation the worker is serving
+ */
+static int readahead_cancelled(void* userdata) {
+	unsigned generation = *(unsigned*)userdata;
+	pthread_mutex_lock(&readahead_mutex);
+	int cancelled = readahead_shutdown || readahead_generation != generation;
+	pthread_mutex_unlock(&readahead_mutex);
+	return cancelled;
+}
+
+/**
+ * Background thread that warms the page cache for the latest request.
+ */
+static void* readahead_loop(void* arg) {
+	ReadaheadTarget targets[READAHEAD_TARGET_MAX];
+	while (1) {
+		pthread_mutex_lock(&readahead_mutex);
+		while (readahead_target_count == 0 && !readahead_shutdown) {
+			pthread_cond_wait(&readahead_cond, &readahead_mutex);
+		}
+
+		if (readahead_shutdown) {
+			pthread_mutex_unlock(&readahead_mutex);
+			break;
+		}
+
+		int count = readahead_target_count;
+		unsigned generation = readahead_generation;
+		memcpy(targets, readahead_targets, count * sizeof(ReadaheadTarget));
+		readahead_target_count = 0;
+		pthread_mutex_unlock(&readahead_mutex);
+
+		for (int i = 0; i < count && !readahead_cancelled(&generation); i++) {
+			TRACE_begin("Readahead_file");
+			Readahead_file(targets[i].path, targets[i].max_bytes, readahead_cancelled,
+			               &generation);
+			TRACE_end("Readahead_file");
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Starts the readahead thread. Call once at startup.
+ */
+static void ReadaheadLoader_init(void) {
+	readahead_target_count = 0;
+	readahead_shutdown = 0;
+	int rc = pthread_create(&readahead_thread, NULL, readahead_loop, NULL);
+	if (rc != 0)
+		LOG_error("Failed to create readahead thread: %d", rc);
+	readahead_running = rc == 0;
+}
+
+/**
+ * Stops the readahead thread, abandoning any work in progress.
+ * Call once at shutdown.
+ */
+static void ReadaheadLoader_quit(void) {
+	if (!readahead_running)
+		return;
+
+	pthread_mutex_lock(&readahead_mutex);
+	readahead_shutdown = 1;
+	pthread_cond_signal(&readahead_cond);
+	pthread_mutex_unlock(&readahead_mutex);
+
+	pthread_join(readahead_thread, NULL);
+	readahead_running = 0;
+}
+
+/**
+ * Drops pending targets and stops the current one at its next chunk.
+ */
+static void ReadaheadLoader_cancel(void) {
+	pthread_mutex_lock(&readahead_mutex);
+	readahead_target_count = 0;
+	readahead_generation += 1;
+	pthread_mutex_unlock(&readahead_mutex);
+}
+
+/**
+ * Replaces any pending or running readahead with new targets. Returns immediately.
+ *
+ * @param targets Files to warm, in order
+ * @param count Number of targets
+ */
+static void ReadaheadLoader_request(ReadaheadTarget* targets, int count) {
+	if (!readahead_running)
+		return;
+
+	pthread_mutex_lock(&readahead_mutex);
+	readahead_generation += 1;
+	readahead_target_count = count;
+	memcpy(readahead_targets, targets, count * sizeof(ReadaheadTarget));
+	if (count > 0)
+		pthread_cond_signal(&readahead_cond);
+	pthread_mutex_unlock(&readahead_mutex);
 }
 
 ///////////////////////////////
@@ -722,6 +1080,7 @@ static Directory* Directory_new(char* path, int selected) {
 		free(self);
 		return NULL;
 	}
+	TRACE_begin("Directory_new");
 	if (exactMatch(path, SDCARD_PATH)) {
 		self->entries = getRoot();
 	} else if (exactMatch(path, FAUX_RECENT_PATH)) {
@@ -736,6 +1095,7 @@ static Directory* Directory_new(char* path, int selected) {
 	}
 	self->alphas = IntArray_new();
 	if (!self->alphas) {
+		TRACE_end("Directory_new");
 		EntryArray_free(self->entries);
 		free(self->name);
 		free(self->path);
@@ -744,6 +1104,7 @@ static Directory* Directory_new(char* path, int selected) {
 	}
 	self->selected = selected;
 	Directory_index(self);
+	TRACE_end("Directory_new");
 	return self;
 }
 
@@ -1621,6 +1982,7 @@ static Array* getEntries(char* path) {
  */
 static void queueNext(char* cmd) {
 	LOG_info("cmd: %s", cmd);
+	TRACE_instant("launch");
 	putFile("/tmp/next", cmd);
 	quit = 1;
 }
@@ -1808,6 +2170,61 @@ static void openPak(char* path) {
 	queueNext(cmd);
 }
 
+/**
+ * Lists the files launching an entry will read first, for readahead.
+ *
+ * Resolves multi-disc games the same way openRom() does (ignoring the disc
+ * a save state might switch to), then adds the core named in the emulator
+ * pak's launch.sh. Disc images only have their first few megabytes warmed.
+ *
+ * @param entry Hovered entry
+ * @param targets Output array (READAHEAD_TARGET_MAX entries)
+ * @return Number of targets, 0 if the entry isn't a ROM
+ */
+static int getReadaheadTargets(Entry* entry, ReadaheadTarget* targets) {
+	if (entry->type != ENTRY_ROM)
+		return 0;
+
+	char sd_path[MAX_PATH];
+	strcpy(sd_path, entry->path);
+
+	char m3u_path[MAX_PATH];
+	int has_m3u = hasM3u(sd_path, m3u_path);
+	if (has_m3u && suffixMatch(".m3u", sd_path) && !getFirstDisc(m3u_path, sd_path))
+		return 0;
+
+	int count = 0;
+
+	// Core is loaded before the game
+	char emu_name[MAX_PATH];
+	char emu_path[MAX_PATH];
+	char emu_exe[MAX_PATH];
+	getEmuName(sd_path, emu_name);
+	getEmuPath(emu_name, emu_path);
+	const char* cores_path = getenv("CORES_PATH");
+	if (cores_path && Readahead_getEmuExe(emu_path, emu_exe, sizeof(emu_exe))) {
+		snprintf(targets[count].path, MAX_PATH, "%s/%s_libretro.so", cores_path, emu_exe);
+		targets[count].max_bytes = READAHEAD_CORE_BYTES;
+		count += 1;
+	}
+
+	if (suffixMatch(".cue", sd_path)) {
+		char tracks[READAHEAD_TARGET_MAX][READAHEAD_PATH_MAX];
+		int track_count = Readahead_getCueFiles(sd_path, tracks, READAHEAD_TARGET_MAX - count);
+		for (int i = 0; i < track_count; i++) {
+			strcpy(targets[count].path, tracks[i]);
+			targets[count].max_bytes = READAHEAD_DISC_BYTES;
+			count += 1;
+		}
+	} else {
+		strcpy(targets[count].path, sd_path);
+		targets[count].max_bytes = has_m3u ? READAHEAD_DISC_BYTES : READAHEAD_ROM_BYTES;
+		count += 1;
+	}
+
+	return count;
+}
+
 /**
  * Launches a ROM with its emulator.
  *
@@ -2178,6 +2595,10 @@ static void Menu_quit(void) {
  * - If a ROM/app was launched, it's queued in /tmp/next
  */
 int main(int argc, char* argv[]) {
+	if (exists(TRACE_MODE_PATH))
+		trace_start(TRACE_PATH, "minui");
+	log_async_start();
+
 	// Check for auto-resume first (fast path)
 	if (autoResume())
 		return 0;
@@ -2190,7 +2611,9 @@ int main(int argc, char* argv[]) {
 	InitSettings();
 
 	LOG_debug("GFX_init");
+	TRACE_begin("GFX_init");
 	SDL_Surface* screen = GFX_init(MODE_MAIN);
+	TRACE_end("GFX_init");
 
 	LOG_debug("PAD_init");
 	PAD_init();
@@ -2203,7 +2626,10 @@ int main(int argc, char* argv[]) {
 	SDL_Surface* version = NULL;
 
 	LOG_debug("ThumbLoader_init");
-	ThumbLoader_init();
+	ThumbLoader_init(screen);
+
+	LOG_debug("ReadaheadLoader_init");
+	ReadaheadLoader_init();
 
 	LOG_debug("Menu_init");
 	Menu_init();
@@ -2219,11 +2645,19 @@ int main(int argc, char* argv[]) {
 	int was_online = PLAT_isOnline();
 
 	// Async thumbnail loading state
-	SDL_Surface* cached_thumb = NULL; // Currently displayed thumbnail
-	char cached_thumb_path[MAX_PATH] = {0}; // Path of cached thumbnail
+	SDL_Surface* cached_thumb = NULL; // Currently displayed thumbnail (owned by thumb_cache)
+	char cached_thumb_path[MAX_PATH] = {0}; // Path of current entry's thumbnail
 	Entry* last_rendered_entry = NULL; // Last entry we rendered (for change detection)
-	int thumb_exists = 0; // Whether thumbnail exists for current entry
+	int thumb_pending = 0; // Whether current entry's thumbnail is still loading
 	int thumb_alpha = THUMB_ALPHA_MAX; // Current fade alpha, starts full for instant display
+	int scroll_dir = 1; // Direction of last selection change (prefetch bias)
+	int idle_frames = 0; // Consecutive frames with nothing to redraw
+	int trace_first_frame = 0; // Whether the first present has been traced
+
+	// Readahead state
+	Entry* readahead_entry = NULL; // Entry the hover timer is running for
+	unsigned long readahead_at = 0; // When readahead_entry was selected
+	int readahead_sent = 0; // Whether readahead_entry has been requested
 
 	LOG_debug("Entering main loop");
 	while (!quit) {
@@ -2324,6 +2758,7 @@ int main(int argc, char* argv[]) {
 				Entry* entry = top->entries->items[selected];
 				int i = entry->alpha - 1;
 				if (i >= 0) {
+					ThumbLoader_cancel(); // Neighbors of the old position are no longer useful
 					selected = top->alphas->items[i];
 					if (total > ui.row_count) {
 						top->start = selected;
@@ -2338,6 +2773,7 @@ int main(int argc, char* argv[]) {
 				Entry* entry = top->entries->items[selected];
 				int i = entry->alpha + 1;
 				if (i < top->alphas->count) {
+					ThumbLoader_cancel(); // Neighbors of the old position are no longer useful
 					selected = top->alphas->items[i];
 					if (total > ui.row_count) {
 						top->start = selected;
@@ -2351,6 +2787,7 @@ int main(int argc, char* argv[]) {
 
 			// Update selection and mark dirty if changed
 			if (selected != top->selected) {
+				scroll_dir = (selected > top->selected) ? 1 : -1;
 				top->selected = selected;
 				dirty = 1;
 			}
@@ -2380,57 +2817,71 @@ int main(int argc, char* argv[]) {
 		}
 
 		// Thumbnail handling - all logic in one place
+		ThumbLoader_poll();
+
 		// Detect when selected entry changes and update thumbnail state
 		Entry* current_entry = (total > 0) ? top->entries->items[top->selected] : NULL;
 		if (current_entry != last_rendered_entry) {
-			// Selection changed - reset thumbnail state
-			if (cached_thumb) {
-				SDL_FreeSurface(cached_thumb);
-				cached_thumb = NULL;
-			}
-			cached_thumb_path[0] = '\0';
-			thumb_exists = 0;
-
-			if (current_entry && current_entry->path && !show_version) {
-				char* last_slash = strrchr(current_entry->path, '/');
-				if (last_slash && last_slash[1] != '\0') {
-					// Build thumbnail path: /dir/.res/filename.png
-					int dir_len = (int)(last_slash - current_entry->path);
-					if (dir_len > 0 && dir_len < MAX_PATH - 32) { // Leave room for /.res/name.png
-						snprintf(cached_thumb_path, MAX_PATH, "%.*s/.res/%s.png", dir_len,
-						         current_entry->path, last_slash + 1);
-						thumb_exists = exists(cached_thumb_path);
-
-						// Request async load if thumbnail exists
-						if (thumb_exists) {
-							int padding = DP(ui.edge_padding);
-							int max_width =
-							    (ui.screen_width_px * THUMB_MAX_WIDTH_PERCENT) / 100 - padding;
-							int max_height = ui.screen_height_px - (padding * 2);
-							if (max_width > 0 && max_height > 0) {
-								ThumbLoader_request(cached_thumb_path, max_width, max_height);
-							}
-						}
-					}
+			// Selection changed - reset thumbnail state (surface stays in the cache)
+			cached_thumb = NULL;
+			thumb_pending = 0;
+
+			if (current_entry && !show_version &&
+			    getThumbPath(current_entry->path, cached_thumb_path)) {
+				ThumbLoader_pin(cached_thumb_path);
+				if (ThumbLoader_get(cached_thumb_path, &cached_thumb))
+					thumb_alpha = THUMB_ALPHA_MAX; // Cache hit, no fade needed
+				else
+					thumb_pending = 1;
+
+				// Queue current entry first, then neighbors in scroll direction, then behind
+				char paths[THUMB_QUEUE_MAX][MAX_PATH];
+				int count = 0;
+				if (thumb_pending)
+					strcpy(paths[count++], cached_thumb_path);
+				for (int i = 1; i <= THUMB_PREFETCH_AHEAD + THUMB_PREFETCH_BEHIND; i++) {
+					int offset = (i <= THUMB_PREFETCH_AHEAD) ? i * scroll_dir
+					                                         : (THUMB_PREFETCH_AHEAD - i) * scroll_dir;
+					int index = top->selected + offset;
+					if (index < 0 || index >= total)
+						continue;
+					Entry* neighbor = top->entries->items[index];
+					if (getThumbPath(neighbor->path, paths[count]))
+						count += 1;
 				}
+				ThumbLoader_request(paths, count);
+			} else {
+				cached_thumb_path[0] = '\0';
+				ThumbLoader_pin(NULL);
 			}
 			last_rendered_entry = current_entry;
 		}
 
-		// Check if thumbnail is actually loaded and ready to display
-		int showing_thumb = (!show_version && total > 0 && cached_thumb && cached_thumb->w > 0 &&
-		                     cached_thumb->h > 0);
+		// Warm the page cache for the hovered ROM once the selection settles
+		if (current_entry != readahead_entry) {
+			ReadaheadLoader_cancel();
+			readahead_entry = current_entry;
+			readahead_at = now;
+			readahead_sent = 0;
+		} else if (current_entry && !readahead_sent && now - readahead_at >= READAHEAD_HOVER_MS) {
+			ReadaheadTarget targets[READAHEAD_TARGET_MAX];
+			ReadaheadLoader_request(targets, getReadaheadTargets(current_entry, targets));
+			readahead_sent = 1;
+		}
 
-		// Poll for async thumbnail load completion
-		if (thumb_exists && !cached_thumb && cached_thumb_path[0]) {
-			SDL_Surface* loaded = ThumbLoader_get(cached_thumb_path);
-			if (loaded) {
-				cached_thumb = loaded;
+		// Pick up current thumbnail once a worker has finished it
+		if (thumb_pending && ThumbLoader_get(cached_thumb_path, &cached_thumb)) {
+			thumb_pending = 0;
+			if (cached_thumb) {
 				thumb_alpha = THUMB_ALPHA_MIN; // Start fade from transparent
 				dirty = 1;
 			}
 		}
 
+		// Check if thumbnail is actually loaded and ready to display
+		int showing_thumb = (!show_version && total > 0 && cached_thumb && cached_thumb->w > 0 &&
+		                     cached_thumb->h > 0);
+
 		// Animate thumbnail fade-in
 		if (cached_thumb && thumb_alpha < THUMB_ALPHA_MAX) {
 			int fade_step = (THUMB_ALPHA_MAX * THUMB_FADE_FRAME_MS) / THUMB_FADE_DURATION_MS;
@@ -2578,51 +3029,45 @@ int main(int argc, char* argv[]) {
 								available_width -= ow;
 						}
 
-						SDL_Color text_color = COLOR_WHITE;
-
 						trimSortingMeta(&entry_name);
 
-						char display_name[256];
-						int text_width = GFX_truncateText(
-						    font.large, entry_unique ? entry_unique : entry_name, display_name,
-						    available_width, DP(ui.button_padding * 2));
+						// Rendered rows come from the text cache (owned there, not freed here)
+						int padding = DP(ui.button_padding * 2);
+						int text_width;
+						SDL_Surface* text;
+						if (j == selected_row) {
+							text = GFX_getText(font.large, entry_unique ? entry_unique : entry_name,
+							                   COLOR_BLACK, available_width, padding, &text_width);
+						} else if (entry->unique) {
+							trimSortingMeta(&entry_unique);
+							text = GFX_getText(font.large, entry_unique, COLOR_DARK_TEXT,
+							                   available_width, padding, &text_width);
+						} else {
+							text = GFX_getText(font.large, entry_name, COLOR_WHITE,
+							                   available_width, padding, &text_width);
+						}
 						int max_width = MIN(available_width, text_width);
+						SDL_Rect text_clip = {0, 0, max_width - padding, text ? text->h : 0};
+						SDL_Rect text_pos = {
+						    DP(ui.edge_padding + ui.button_padding),
+						    DP(ui.edge_padding + (j * ui.pill_height) + ui.text_baseline), 0, 0};
+
 						if (j == selected_row) {
 							GFX_blitPill(ASSET_WHITE_PILL, screen,
 							             &(SDL_Rect){DP(ui.edge_padding),
 							                         DP(ui.edge_padding + (j * ui.pill_height)),
 							                         max_width, DP(ui.pill_height)});
-							text_color = COLOR_BLACK;
 						} else if (entry->unique) {
-							trimSortingMeta(&entry_unique);
-							char unique_name[256];
-							GFX_truncateText(font.large, entry_unique, unique_name, available_width,
-							                 DP(ui.button_padding * 2));
-
-							SDL_Surface* text =
-							    TTF_RenderUTF8_Blended(font.large, unique_name, COLOR_DARK_TEXT);
-							SDL_BlitSurface(
-							    text,
-							    &(SDL_Rect){0, 0, max_width - DP(ui.button_padding * 2), text->h},
-							    screen,
-							    &(SDL_Rect){
-							        DP(ui.edge_padding + ui.button_padding),
-							        DP(ui.edge_padding + (j * ui.pill_height) + ui.text_baseline),
-							        0, 0});
-
-							GFX_truncateText(font.large, entry_name, display_name, available_width,
-							                 DP(ui.button_padding * 2));
+							// Unique name in dark text underneath, display name on top
+							if (text)
+								SDL_BlitSurface(text, &text_clip, screen, &text_pos);
+							text = GFX_getText(font.large, entry_name, COLOR_WHITE, available_width,
+							                   padding, NULL);
+						}
+						if (text) {
+							text_clip.h = text->h;
+							SDL_BlitSurface(text, &text_clip, screen, &text_pos);
 						}
-						SDL_Surface* text =
-						    TTF_RenderUTF8_Blended(font.large, display_name, text_color);
-						SDL_BlitSurface(
-						    text, &(SDL_Rect){0, 0, max_width - DP(ui.button_padding * 2), text->h},
-						    screen,
-						    &(SDL_Rect){
-						        DP(ui.edge_padding + ui.button_padding),
-						        DP(ui.edge_padding + (j * ui.pill_height) + ui.text_baseline), 0,
-						        0});
-						SDL_FreeSurface(text);
 					}
 				} else {
 					// Use DP-based wrapper for proper scaling
@@ -2656,9 +3101,21 @@ int main(int argc, char* argv[]) {
 			}
 
 			GFX_flip(screen);
+			if (!trace_first_frame) {
+				trace_first_frame = 1;
+				TRACE_instant("first_frame");
+			}
 			dirty = 0;
-		} else
+			idle_frames = 0;
+		} else if (idle_frames >= IDLE_FRAME_THRESHOLD && !show_setting && !thumb_pending &&
+		           thumb_alpha == THUMB_ALPHA_MAX && (readahead_sent || !readahead_entry) &&
+		           !PAD_anyPressed()) {
+			// Nothing is animating or loading: sleep until input or the next status refresh
+			PAD_wait(PWR_untilUpdate());
+		} else {
+			idle_frames += 1;
 			GFX_sync();
+		}
 
 		// if (!first_draw) {
 		// 	first_draw = SDL_GetTicks();
@@ -2668,8 +3125,15 @@ int main(int argc, char* argv[]) {
 		// HDMI hotplug detection
 		// When HDMI is connected/disconnected, restart to reinit graphics
 		// with correct resolution. Save state so we return to same position.
+		// Settings are only reread when their sequence number moved.
 		static int had_hdmi = -1;
-		int has_hdmi = GetHDMI();
+		static int settings_seq = 0;
+		int seq = GetSettingsSeq();
+		int has_hdmi = had_hdmi;
+		if (had_hdmi == -1 || seq != settings_seq) {
+			settings_seq = seq;
+			has_hdmi = GetHDMI();
+		}
 		if (had_hdmi == -1)
 			had_hdmi = has_hdmi;
 		if (has_hdmi != had_hdmi) {
@@ -2685,9 +3149,8 @@ int main(int argc, char* argv[]) {
 
 	if (version)
 		SDL_FreeSurface(version);
-	if (cached_thumb)
-		SDL_FreeSurface(cached_thumb);
 
+	ReadaheadLoader_quit();
 	ThumbLoader_quit();
 	Menu_quit();
 	PWR_quit();
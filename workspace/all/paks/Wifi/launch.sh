@@ -499,6 +499,7 @@ network_loop() {
 cleanup() {
 	rm -f /tmp/stay_awake /tmp/wifi-next-screen
 	killall minui-presenter >/dev/null 2>&1 || true
+	minui-daemon --stop >/dev/null 2>&1 || true
 }
 
 # ============================================================================
@@ -568,6 +569,11 @@ main() {
 		fi
 	fi
 
+	# keep one process drawing every screen, so moving between them doesn't flash black
+	if command -v minui-daemon >/dev/null 2>&1; then
+		minui-daemon
+	fi
+
 	# Main UI loop
 	while true; do
 		main_screen
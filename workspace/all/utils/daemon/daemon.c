@@ -0,0 +1,432 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "daemon.h"
+
+// set by client signal handlers to the control byte to forward to the daemon
+static volatile sig_atomic_t forward_control = 0;
+
+// set by daemon signal handlers to the control byte the current request reads next
+static volatile sig_atomic_t signal_control = 0;
+
+volatile sig_atomic_t daemon_quitting = 0;
+
+// daemon_log_error logs a message to stderr, like each util's log_error
+static void daemon_log_error(const char *msg)
+{
+    setvbuf(stderr, NULL, _IONBF, 0);
+    fprintf(stderr, "%s\n", msg);
+}
+
+// client_signal_handler forwards signals sent to a client to the daemon it is waiting on
+static void client_signal_handler(int signal)
+{
+    if (signal == SIGINT)
+    {
+        forward_control = DAEMON_CONTROL_INTERRUPT;
+    }
+    else if (signal == SIGTERM)
+    {
+        forward_control = DAEMON_CONTROL_TERMINATE;
+    }
+    else if (signal == SIGUSR1)
+    {
+        forward_control = DAEMON_CONTROL_NEXT;
+    }
+}
+
+// daemon_signal_handler handles signals sent to the daemon itself
+// SIGTERM only ends the current request so `killall minui-daemon` does not lose the display mid-step
+static void daemon_signal_handler(int signal)
+{
+    if (signal == SIGTERM)
+    {
+        signal_control = DAEMON_CONTROL_TERMINATE;
+    }
+    else if (signal == SIGUSR1)
+    {
+        signal_control = DAEMON_CONTROL_NEXT;
+    }
+    else
+    {
+        signal_control = DAEMON_CONTROL_INTERRUPT;
+        daemon_quitting = 1;
+    }
+}
+
+// write_all writes the whole buffer, retrying short writes
+static bool write_all(int fd, const char *buffer, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t count = send(fd, buffer, length, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        buffer += count;
+        length -= count;
+    }
+    return true;
+}
+
+// read_all reads exactly length bytes, returning false on error or a closed connection
+static bool read_all(int fd, char *buffer, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t count = read(fd, buffer, length);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        buffer += count;
+        length -= count;
+    }
+    return true;
+}
+
+const char *daemon_socket_path(const char *env_name, const char *default_path)
+{
+    const char *path = getenv(env_name);
+    if (path == NULL || strlen(path) == 0)
+    {
+        path = default_path;
+    }
+    return path;
+}
+
+int daemon_connect(const char *path)
+{
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// daemon_send_request sends a request along with this process's stdin, stdout and stderr,
+// so the daemon reads and logs exactly where this process would have
+static bool daemon_send_request(int fd, const char *request)
+{
+    uint32_t length = strlen(request);
+    int fds[3] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+    struct iovec iov = {.iov_base = &length, .iov_len = sizeof(length)};
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control,
+        .msg_controllen = sizeof(control),
+    };
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    if (sendmsg(fd, &msg, MSG_NOSIGNAL) != sizeof(length))
+    {
+        return false;
+    }
+    return write_all(fd, request, length);
+}
+
+JSON_Value *daemon_request_arguments(const char *util, int argc, char *argv[])
+{
+    char cwd[PATH_MAX];
+    if (getcwd(cwd, sizeof(cwd)) == NULL)
+    {
+        return NULL;
+    }
+
+    JSON_Value *request_value = json_value_init_object();
+    JSON_Object *request = json_value_get_object(request_value);
+    json_object_set_string(request, "util", util);
+    json_object_set_string(request, "cwd", cwd);
+
+    JSON_Value *args_value = json_value_init_array();
+    JSON_Array *args = json_value_get_array(args_value);
+    for (int i = 1; i < argc; i++)
+    {
+        json_array_append_string(args, argv[i]);
+    }
+    json_object_set_value(request, "args", args_value);
+    return request_value;
+}
+
+bool daemon_forward(const char *path, JSON_Value *request_value, int *exit_code)
+{
+    int fd = daemon_connect(path);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    char *request = json_serialize_to_string(request_value);
+    bool sent = request != NULL && daemon_send_request(fd, request);
+    json_free_serialized_string(request);
+    if (!sent)
+    {
+        daemon_log_error("Failed to send request to daemon");
+        close(fd);
+        *exit_code = DAEMON_EXIT_ERROR;
+        return true;
+    }
+
+    // forward the signals scripts send to the util while waiting
+    struct sigaction sa = {.sa_handler = client_signal_handler};
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGUSR1, &sa, NULL);
+
+    char response[1024];
+    size_t response_length = 0;
+    while (response_length < sizeof(response) - 1)
+    {
+        if (forward_control)
+        {
+            char control = forward_control;
+            forward_control = 0;
+            write_all(fd, &control, 1);
+        }
+
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, DAEMON_SIGNAL_POLL_MS) <= 0)
+        {
+            continue;
+        }
+
+        ssize_t count = read(fd, response + response_length, sizeof(response) - 1 - response_length);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            break;
+        }
+        response_length += count;
+    }
+    response[response_length] = '\0';
+    close(fd);
+
+    *exit_code = DAEMON_EXIT_ERROR;
+    JSON_Value *response_value = json_parse_string(response);
+    JSON_Object *response_object = json_value_get_object(response_value);
+    if (response_object != NULL && json_object_has_value_of_type(response_object, "exit_code", JSONNumber))
+    {
+        *exit_code = (int)json_object_get_number(response_object, "exit_code");
+    }
+    else
+    {
+        daemon_log_error("Daemon did not return an exit code");
+    }
+    json_value_free(response_value);
+    return true;
+}
+
+int daemon_stop(const char *path)
+{
+    JSON_Value *request_value = json_value_init_object();
+    json_object_set_boolean(json_value_get_object(request_value), "stop", 1);
+    int exit_code = 0;
+    daemon_forward(path, request_value, &exit_code);
+    json_value_free(request_value);
+    return exit_code;
+}
+
+int daemon_listen(const char *path)
+{
+    int existing_fd = daemon_connect(path);
+    if (existing_fd >= 0)
+    {
+        close(existing_fd);
+        daemon_log_error("A daemon is already running");
+        return -1;
+    }
+
+    // a socket left behind by a daemon that died would refuse every connection
+    unlink(path);
+
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 4) != 0)
+    {
+        char buff[1024];
+        snprintf(buff, sizeof(buff), "Failed to listen on %s: %s", path, strerror(errno));
+        daemon_log_error(buff);
+        if (listen_fd >= 0)
+        {
+            close(listen_fd);
+        }
+        return -1;
+    }
+    fcntl(listen_fd, F_SETFD, FD_CLOEXEC);
+
+    // a client that goes away mid-response must not take the daemon with it
+    signal(SIGPIPE, SIG_IGN);
+    return listen_fd;
+}
+
+void daemon_handle_signals(void)
+{
+    // no SA_RESTART, so a signal interrupts the wait for the next client
+    struct sigaction sa = {.sa_handler = daemon_signal_handler};
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGUSR1, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+}
+
+JSON_Value *daemon_receive(int client_fd)
+{
+    uint32_t length = 0;
+    int fds[3] = {-1, -1, -1};
+
+    char control[CMSG_SPACE(sizeof(fds))];
+    struct iovec iov = {.iov_base = &length, .iov_len = sizeof(length)};
+    struct msghdr msg = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control,
+        .msg_controllen = sizeof(control),
+    };
+    if (recvmsg(client_fd, &msg, 0) != sizeof(length))
+    {
+        return NULL;
+    }
+
+    // a signal sent while the daemon was idle was meant for no request
+    signal_control = 0;
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS && cmsg->cmsg_len == CMSG_LEN(sizeof(fds)))
+    {
+        memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    }
+
+    char *request = NULL;
+    JSON_Value *request_value = NULL;
+    if (length <= DAEMON_MAX_REQUEST && (request = malloc(length + 1)) != NULL && read_all(client_fd, request, length))
+    {
+        request[length] = '\0';
+        request_value = json_parse_string(request);
+    }
+    free(request);
+
+    // read, write and log through the client's stdin, stdout and stderr for this request
+    for (int i = 0; i < 3; i++)
+    {
+        if (fds[i] >= 0)
+        {
+            dup2(fds[i], i);
+            close(fds[i]);
+        }
+    }
+    clearerr(stdin);
+
+    if (request_value == NULL)
+    {
+        daemon_log_error("Failed to parse daemon request");
+    }
+    return request_value;
+}
+
+char **daemon_request_argv(JSON_Object *request, const char *name, int *argc)
+{
+    JSON_Array *args = json_object_get_array(request, "args");
+    const char *cwd = json_object_get_string(request, "cwd");
+    if (args == NULL || cwd == NULL || chdir(cwd) != 0)
+    {
+        daemon_log_error("Invalid daemon request");
+        return NULL;
+    }
+
+    *argc = json_array_get_count(args) + 1;
+    char **argv = calloc(*argc + 1, sizeof(char *));
+    if (argv == NULL)
+    {
+        return NULL;
+    }
+    argv[0] = (char *)name;
+    for (int i = 1; i < *argc; i++)
+    {
+        const char *arg = json_array_get_string(args, i - 1);
+        argv[i] = (char *)(arg != NULL ? arg : "");
+    }
+
+    // getopt keeps its position between calls, 0 makes it start over
+    optind = 0;
+    return argv;
+}
+
+void daemon_respond(int client_fd, int exit_code, const int saved_fds[3])
+{
+    char response[64];
+    snprintf(response, sizeof(response), "{\"exit_code\": %d}", exit_code);
+    write_all(client_fd, response, strlen(response));
+
+    // hand the client's files back so it sees them closed when it exits
+    fflush(stdout);
+    fflush(stderr);
+    for (int i = 0; i < 3; i++)
+    {
+        dup2(saved_fds[i], i);
+    }
+}
+
+int daemon_read_control(int client_fd)
+{
+    if (signal_control)
+    {
+        int control = signal_control;
+        signal_control = 0;
+        return control;
+    }
+
+    char control;
+    ssize_t count = recv(client_fd, &control, 1, MSG_DONTWAIT);
+    if (count == 1)
+    {
+        return control;
+    }
+    if (count == 0)
+    {
+        return -1;
+    }
+    return 0;
+}
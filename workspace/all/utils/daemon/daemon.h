@@ -0,0 +1,91 @@
+// daemon.h - the resident daemon protocol shared by minui-presenter, minui-list and minui-keyboard
+//
+// minui-daemon initializes the screen, input and power management once and serves all three
+// utils on one UNIX socket, keeping their fonts and other assets loaded between requests.
+// Every util invocation connects, forwards its arguments, working directory, stdin, stdout
+// and stderr, and exits with the daemon's exit code. Without a daemon listening, the util
+// runs standalone as before.
+//
+// A request is its length followed by a JSON object:
+// - {"util": "...", "args": [...], "cwd": "..."} runs the named util with those arguments
+// - {"stop": true} stops the daemon
+// stdin, stdout and stderr ride along with the length as SCM_RIGHTS fds.
+//
+// While waiting, a client forwards the signals sent to it as single control bytes:
+// DAEMON_CONTROL_INTERRUPT (SIGINT), DAEMON_CONTROL_TERMINATE (SIGTERM) and
+// DAEMON_CONTROL_NEXT (SIGUSR1). The daemon answers with {"exit_code": n}.
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <parson/parson.h>
+#include <signal.h>
+#include <stdbool.h>
+
+#define DAEMON_MAX_REQUEST (256 * 1024) // largest request a client may send
+#define DAEMON_SIGNAL_POLL_MS 100       // how often a waiting client checks for signals
+#define DAEMON_EXIT_ERROR 1             // ExitCodeError in every util
+
+#define DAEMON_SOCKET_ENV "MINUI_DAEMON_SOCKET"
+#define DAEMON_SOCKET_PATH "/tmp/minui-daemon.sock"
+
+#define DAEMON_CONTROL_INTERRUPT 'i'
+#define DAEMON_CONTROL_TERMINATE 't'
+#define DAEMON_CONTROL_NEXT 'n'
+
+struct SDL_Surface;
+
+// set once SIGINT or SIGHUP asks the daemon to shut down, see daemon_handle_signals
+extern volatile sig_atomic_t daemon_quitting;
+
+// daemon_socket_path returns the socket path from env_name, or default_path if it is unset
+const char *daemon_socket_path(const char *env_name, const char *default_path);
+
+// daemon_connect connects to a running daemon, returning -1 if there is none
+int daemon_connect(const char *path);
+
+// daemon_request_arguments builds a request asking the daemon to run util with these arguments
+// relative paths are resolved against the working directory the client was started in
+JSON_Value *daemon_request_arguments(const char *util, int argc, char *argv[]);
+
+// daemon_forward runs a request on a running daemon instead of starting up
+// returns false if no daemon is running, otherwise waits for the daemon's exit code
+bool daemon_forward(const char *path, JSON_Value *request_value, int *exit_code);
+
+// daemon_stop asks a running daemon to exit, returning the exit code for minui-daemon --stop
+int daemon_stop(const char *path);
+
+// daemon_listen creates the daemon's socket, returning the listening fd or -1
+// fails if another daemon is already listening on the path
+int daemon_listen(const char *path);
+
+// daemon_handle_signals turns signals sent to the daemon itself into control bytes,
+// so they end the current request the same way a client's forwarded signals do
+// SIGINT and SIGHUP also set daemon_quitting
+void daemon_handle_signals(void);
+
+// daemon_receive reads a client's request and switches stdin, stdout and stderr to the client's
+// returns the parsed request, or NULL if it could not be read
+JSON_Value *daemon_receive(int client_fd);
+
+// daemon_request_argv changes to the request's working directory and builds its argv
+// argv[0] is name and the strings belong to the request; free the array with free()
+// returns NULL if the request has no arguments or working directory
+char **daemon_request_argv(JSON_Object *request, const char *name, int *argc);
+
+// daemon_respond sends the exit code to the client and restores the daemon's own stdio
+void daemon_respond(int client_fd, int exit_code, const int saved_fds[3]);
+
+// daemon_read_control returns the next control byte a waiting client forwarded
+// or a signal sent to the daemon, 0 if there is none yet, or -1 once the client has gone away
+int daemon_read_control(int client_fd);
+
+// the utils minui-daemon serves, built into it with MINUI_DAEMON defined
+// each runs one request on the daemon's screen and returns the util's exit code,
+// keeping what it loaded for the next request; the *_quit functions release it on shutdown
+int minui_presenter_serve(struct SDL_Surface *display, int client_fd, JSON_Object *request);
+void minui_presenter_quit(void);
+int minui_list_serve(struct SDL_Surface *display, int client_fd, JSON_Object *request);
+void minui_list_quit(void);
+int minui_keyboard_serve(struct SDL_Surface *display, int client_fd, JSON_Object *request);
+
+#endif
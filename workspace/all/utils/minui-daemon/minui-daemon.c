@@ -0,0 +1,222 @@
+#include <daemon/daemon.h>
+#include <fcntl.h>
+#include <msettings.h>
+#include <parson/parson.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "defines.h"
+#include "api.h"
+#include "utils.h"
+
+enum daemon_result_t
+{
+    ExitCodeSuccess = 0,
+    ExitCodeError = 1,
+};
+
+// Util is a util minui-daemon serves requests for
+struct Util
+{
+    // the name clients send, the util's binary name
+    const char *name;
+    // runs one request, returning the util's exit code
+    int (*serve)(SDL_Surface *display, int client_fd, JSON_Object *request);
+};
+
+static const struct Util utils[] = {
+    {"minui-presenter", minui_presenter_serve},
+    {"minui-list", minui_list_serve},
+    {"minui-keyboard", minui_keyboard_serve},
+};
+
+static SDL_Surface *screen = NULL;
+
+// log_error logs a message to stderr for debugging purposes
+static void log_error(const char *msg)
+{
+    // Set stderr to unbuffered mode
+    setvbuf(stderr, NULL, _IONBF, 0);
+    fprintf(stderr, "%s\n", msg);
+}
+
+// suppress_output suppresses stdout and stderr
+// returns a single integer containing both file descriptors
+static int suppress_output(void)
+{
+    int stdout_fd = dup(STDOUT_FILENO);
+    int stderr_fd = dup(STDERR_FILENO);
+
+    int dev_null_fd = open("/dev/null", O_WRONLY);
+    dup2(dev_null_fd, STDOUT_FILENO);
+    dup2(dev_null_fd, STDERR_FILENO);
+    close(dev_null_fd);
+
+    return (stdout_fd << 16) | stderr_fd;
+}
+
+// restore_output restores stdout and stderr to the original file descriptors
+static void restore_output(int saved_fds)
+{
+    int stdout_fd = (saved_fds >> 16) & 0xFFFF;
+    int stderr_fd = saved_fds & 0xFFFF;
+
+    fflush(stdout);
+    fflush(stderr);
+
+    dup2(stdout_fd, STDOUT_FILENO);
+    dup2(stderr_fd, STDERR_FILENO);
+
+    close(stdout_fd);
+    close(stderr_fd);
+}
+
+// swallow_stdout_from_function swallows stdout from a function
+// MinUI sometimes logs to stdout, which would end up in a client's output
+static void swallow_stdout_from_function(void (*func)(void))
+{
+    int saved_fds = suppress_output();
+
+    func();
+
+    restore_output(saved_fds);
+}
+
+// init initializes the screen, input, power management and hardware settings
+// once for every request the daemon serves
+static void init()
+{
+    PWR_setCPUSpeed(CPU_SPEED_MENU);
+
+    screen = GFX_init(MODE_MAIN);
+    PAD_init();
+    PWR_init();
+    InitSettings();
+}
+
+// destruct cleans up in reverse order
+static void destruct()
+{
+    QuitSettings();
+    PWR_quit();
+    PAD_quit();
+    GFX_quit();
+}
+
+// serve runs one client request with the util it names
+// returns false if the request asked the daemon to stop
+static bool serve(int client_fd, const int saved_fds[3])
+{
+    JSON_Value *request_value = daemon_receive(client_fd);
+    JSON_Object *request = json_value_get_object(request_value);
+
+    bool keep_running = true;
+    int exit_code = ExitCodeError;
+    if (request != NULL && json_object_get_boolean(request, "stop") == 1)
+    {
+        keep_running = false;
+        exit_code = ExitCodeSuccess;
+    }
+    else if (request != NULL)
+    {
+        const char *name = json_object_get_string(request, "util");
+        const struct Util *util = NULL;
+        for (size_t i = 0; name != NULL && i < sizeof(utils) / sizeof(utils[0]); i++)
+        {
+            if (strcmp(utils[i].name, name) == 0)
+            {
+                util = &utils[i];
+            }
+        }
+
+        if (util != NULL)
+        {
+            // drop input that queued up while nothing was shown,
+            // such as presses meant for another app run between two requests
+            PAD_poll();
+            PAD_reset();
+
+            exit_code = util->serve(screen, client_fd, request);
+            PWR_enableAutosleep();
+        }
+        else
+        {
+            log_error("Unknown util in daemon request");
+        }
+    }
+    json_value_free(request_value);
+
+    daemon_respond(client_fd, exit_code, saved_fds);
+    return keep_running;
+}
+
+// main keeps the screen, input, power management and each util's fonts and assets loaded,
+// serving minui-presenter, minui-list and minui-keyboard requests until stopped
+// the last screen stays up until the next request replaces it, whichever util draws it
+int main(int argc, char *argv[])
+{
+    const char *path = daemon_socket_path(DAEMON_SOCKET_ENV, DAEMON_SOCKET_PATH);
+    if (argc == 2 && strcmp(argv[1], "--stop") == 0)
+    {
+        return daemon_stop(path);
+    }
+    if (argc != 1)
+    {
+        log_error("Usage: minui-daemon [--stop]");
+        return ExitCodeError;
+    }
+
+    int listen_fd = daemon_listen(path);
+    if (listen_fd < 0)
+    {
+        return ExitCodeError;
+    }
+
+    // return to the script once clients can connect, so its next util call is forwarded
+    // instead of starting up standalone next to the daemon
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        log_error("Failed to start the daemon");
+        return ExitCodeError;
+    }
+    if (pid > 0)
+    {
+        return ExitCodeSuccess;
+    }
+
+    swallow_stdout_from_function(init);
+    daemon_handle_signals();
+
+    int saved_fds[3];
+    for (int i = 0; i < 3; i++)
+    {
+        saved_fds[i] = dup(i);
+    }
+
+    while (!daemon_quitting)
+    {
+        int client_fd = accept(listen_fd, NULL, NULL);
+        if (client_fd < 0)
+        {
+            continue;
+        }
+
+        bool keep_running = serve(client_fd, saved_fds);
+        close(client_fd);
+        if (!keep_running)
+        {
+            break;
+        }
+    }
+
+    close(listen_fd);
+    unlink(path);
+
+    minui_presenter_quit();
+    minui_list_quit();
+    swallow_stdout_from_function(destruct);
+    return ExitCodeSuccess;
+}
@@ -1,9 +1,11 @@
+#include <daemon/daemon.h>
 #include <fcntl.h>
 #include <getopt.h>
 #include <msettings.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <sys/socket.h>
 #include <unistd.h>
 #ifdef USE_SDL2
 #include <SDL2/SDL_ttf.h>
@@ -15,7 +17,10 @@
 #include "api.h"
 #include "utils.h"
 
-SDL_Surface *screen = NULL;
+static SDL_Surface *screen = NULL;
+
+// set from the daemon's control bytes to end the current keyboard with that exit code
+static volatile sig_atomic_t stop_exit_code = 0;
 
 enum list_result_t
 {
@@ -35,7 +40,7 @@ enum list_result_t
 typedef int ExitCode;
 
 // log_error logs a message to stderr for debugging purposes
-void log_error(const char *msg)
+static void log_error(const char *msg)
 {
     // Set stderr to unbuffered mode
     setvbuf(stderr, NULL, _IONBF, 0);
@@ -43,7 +48,7 @@ void log_error(const char *msg)
 }
 
 // log_info logs a message to stdout for debugging purposes
-void log_info(const char *msg)
+static void log_info(const char *msg)
 {
     // Set stdout to unbuffered mode
     setvbuf(stdout, NULL, _IONBF, 0);
@@ -51,7 +56,7 @@ void log_info(const char *msg)
 }
 
 // keyboard_layout_lowercase is the default keyboard layout
-const char *keyboard_layout_lowercase[5][14] = {
+static const char *keyboard_layout_lowercase[5][14] = {
     {"`", "1", "2", "3", "4", "5", "6", "7", "8", "9", "0", "-", "=", "\0"},
     {"q", "w", "e", "r", "t", "y", "u", "i", "o", "p", "[", "]", "\\", "\0"},
     {"a", "s", "d", "f", "g", "h", "j", "k", "l", ";", "'", "\0", "\0", "\0"},
@@ -59,7 +64,7 @@ const char *keyboard_layout_lowercase[5][14] = {
     {"shift", "space", "enter", "\0", "\0", "\0", "\0", "\0", "\0", "\0", "\0", "\0", "\0", "\0"}};
 
 // keyboard_layout_uppercase is the uppercase keyboard layout
-const char *keyboard_layout_uppercase[5][14] = {
+static const char *keyboard_layout_uppercase[5][14] = {
     {"~", "!", "@", "#", "$", "%", "^", "&", "*", "(", ")", "_", "+", "\0"},
     {"Q", "W", "E", "R", "T", "Y", "U", "I", "O", "P", "{", "}", "|", "\0"},
     {"A", "S", "D", "F", "G", "H", "J", "K", "L", ":", "\"", "\0", "\0", "\0"},
@@ -69,7 +74,7 @@ const char *keyboard_layout_uppercase[5][14] = {
 // keyboard_layout_special is the special keyboard layout
 // note that some characters are not supported by the font in use by MinUI
 // so we omit those characters from the layout
-const char *keyboard_layout_special[5][14] = {
+static const char *keyboard_layout_special[5][14] = {
     {"~", "!", "@", "#", "$", "%", "^", "&", "*", "(", ")", "_", "+", "\0"},
     {"{", "}", "|", "\\", "<", ">", "?", "\"", ";", ":", "[", "]", "\\", "\0"},
     {"±", "§", "¶", "©", "®", "™", "€", "£", "¥", "¢", "¤", "\0", "\0", "\0"},
@@ -103,13 +108,13 @@ struct AppState
 };
 
 // max returns the maximum of two integers
-int max(int a, int b)
+static int max(int a, int b)
 {
     return (a > b) ? a : b;
 }
 
 // count_row_length returns the number of non-empty characters in a keyboard row
-int count_row_length(const char *(*layout)[14], int row)
+static int count_row_length(const char *(*layout)[14], int row)
 {
     int length = 0;
     for (int i = 0; i < 14; i++)
@@ -123,7 +128,7 @@ int count_row_length(const char *(*layout)[14], int row)
 }
 
 // calculate_column_offset returns the offset between two rows
-int calculate_column_offset(const char *(*layout)[14], int from_row, int to_row)
+static int calculate_column_offset(const char *(*layout)[14], int from_row, int to_row)
 {
     int from_length = count_row_length(layout, from_row);
     int to_length = count_row_length(layout, to_row);
@@ -131,7 +136,7 @@ int calculate_column_offset(const char *(*layout)[14], int from_row, int to_row)
 }
 
 // adjust_offset_exit_last_row adjusts offset when exiting the last row
-int adjust_offset_exit_last_row(int offset, int column)
+static int adjust_offset_exit_last_row(int offset, int column)
 {
     if (column == 0)
     {
@@ -145,7 +150,7 @@ int adjust_offset_exit_last_row(int offset, int column)
 }
 
 // adjust_offset_enter_last_row adjusts offset when entering the last row
-int adjust_offset_enter_last_row(int offset, int col, int center)
+static int adjust_offset_enter_last_row(int offset, int col, int center)
 {
     if (col > center)
     {
@@ -162,7 +167,7 @@ int adjust_offset_enter_last_row(int offset, int col, int center)
 }
 
 // get_current_layout returns the appropriate keyboard layout array based on the current state
-const char *(*get_current_layout(struct AppState *state))[14]
+static const char *(*get_current_layout(struct AppState *state))[14]
 {
     if (state->keyboard.layout == 0)
     {
@@ -179,7 +184,7 @@ const char *(*get_current_layout(struct AppState *state))[14]
 }
 
 // cursor_rescue ensures the cursor lands on a valid key and doesn't get lost in empty space
-void cursor_rescue(struct AppState *state, const char *(*current_layout)[14], int num_rows)
+static void cursor_rescue(struct AppState *state, const char *(*current_layout)[14], int num_rows)
 {
     int num_cols = sizeof(current_layout[0]) / sizeof(current_layout[0][0]);
 
@@ -217,7 +222,7 @@ void cursor_rescue(struct AppState *state, const char *(*current_layout)[14], in
 }
 
 // handle_keyboard_input interprets keyboard input events and mutates app state
-void handle_keyboard_input(struct AppState *state)
+static void handle_keyboard_input(struct AppState *state)
 {
     // redraw unless a key was not pressed
     state->redraw = 1;
@@ -366,7 +371,7 @@ void handle_keyboard_input(struct AppState *state)
 }
 
 // handle_input interprets input events and mutates app state
-void handle_input(struct AppState *state)
+static void handle_input(struct AppState *state)
 {
     PAD_poll();
 
@@ -391,7 +396,7 @@ void handle_input(struct AppState *state)
 }
 
 // draw_keyboard interprets the app state and draws it as a keyboard to the screen
-void draw_keyboard(SDL_Surface *screen, struct AppState *state)
+static void draw_keyboard(SDL_Surface *screen, struct AppState *state)
 {
     // determine which keyboard layout to use based on current state
     const char *(*current_layout)[14];
@@ -543,7 +548,7 @@ void draw_keyboard(SDL_Surface *screen, struct AppState *state)
 }
 
 // draw_screen interprets the app state and draws it to the screen
-void draw_screen(SDL_Surface *screen, struct AppState *state)
+static void draw_screen(SDL_Surface *screen, struct AppState *state)
 {
     draw_keyboard(screen, state);
 
@@ -552,7 +557,7 @@ void draw_screen(SDL_Surface *screen, struct AppState *state)
 }
 
 // write_to_file writes some text to a file
-int write_to_file(const char *filename, const char *text)
+static int write_to_file(const char *filename, const char *text)
 {
     FILE *file = fopen(filename, "w");
     if (file == NULL)
@@ -569,7 +574,7 @@ int write_to_file(const char *filename, const char *text)
 }
 
 // write_output writes the final text to the write location
-int write_output(struct AppState *state)
+static int write_output(struct AppState *state)
 {
     if (state->exit_code != ExitCodeSuccess)
     {
@@ -594,7 +599,7 @@ int write_output(struct AppState *state)
 
 // suppress_output suppresses stdout and stderr
 // returns a single integer containing both file descriptors
-int suppress_output(void)
+static int suppress_output(void)
 {
     int stdout_fd = dup(STDOUT_FILENO);
     int stderr_fd = dup(STDERR_FILENO);
@@ -608,7 +613,7 @@ int suppress_output(void)
 }
 
 // restore_output restores stdout and stderr to the original file descriptors
-void restore_output(int saved_fds)
+static void restore_output(int saved_fds)
 {
     int stdout_fd = (saved_fds >> 16) & 0xFFFF;
     int stderr_fd = saved_fds & 0xFFFF;
@@ -627,7 +632,7 @@ void restore_output(int saved_fds)
 // this is useful for suppressing output from a function
 // that we don't want to see in the log file
 // the InitSettings() function is an example of this (some implementations print to stdout)
-void swallow_stdout_from_function(void (*func)(void))
+static void swallow_stdout_from_function(void (*func)(void))
 {
     int saved_fds = suppress_output();
 
@@ -636,7 +641,7 @@ void swallow_stdout_from_function(void (*func)(void))
     restore_output(saved_fds);
 }
 
-void signal_handler(int signal)
+static void signal_handler(int signal)
 {
     // if the signal is a ctrl+c, exit with code 130
     if (signal == SIGINT)
@@ -660,7 +665,7 @@ void signal_handler(int signal)
 // - --initial-value <value> (default: empty string)
 // - --title <title> (default: empty string)
 // - --write-location <location> (default: "-")
-bool parse_arguments(struct AppState *state, int argc, char *argv[])
+static bool parse_arguments(struct AppState *state, int argc, char *argv[])
 {
     static struct option long_options[] = {
         {"show-hardware-group", no_argument, 0, 'S'},
@@ -702,7 +707,7 @@ bool parse_arguments(struct AppState *state, int argc, char *argv[])
 // init initializes the app state
 // everything is placed here as MinUI sometimes logs to stdout
 // and the logging happens depending on the platform
-void init()
+static void init()
 {
     // set the cpu speed to the menu speed
     // this is done here to ensure we downclock
@@ -724,7 +729,7 @@ void init()
 }
 
 // destruct cleans up the app state in reverse order
-void destruct()
+static void destruct()
 {
     QuitSettings();
     PWR_quit();
@@ -732,14 +737,10 @@ void destruct()
     GFX_quit();
 }
 
-// main is the entry point for the app
-int main(int argc, char *argv[])
+// AppState_init resets the app state to the defaults used before parsing arguments
+static void AppState_init(struct AppState *state)
 {
-    // Initialize app state
-    char default_keyboard_text[1024] = "";
-    char default_keyboard_title[1024] = "";
-    char default_write_location[1024] = "-";
-    struct AppState state = {
+    *state = (struct AppState){
         .redraw = 1,
         .quitting = 0,
         .exit_code = ExitCodeSuccess,
@@ -752,25 +753,40 @@ int main(int argc, char *argv[])
             .col = 0,
             .layout = 0}};
 
-    // assign the default values to the app state
-    strncpy(state.keyboard.current_text, default_keyboard_text, sizeof(state.keyboard.current_text));
-    strncpy(state.keyboard.initial_text, default_keyboard_text, sizeof(state.keyboard.initial_text));
-    strncpy(state.keyboard.final_text, default_keyboard_text, sizeof(state.keyboard.final_text));
-    strncpy(state.keyboard.title, default_keyboard_title, sizeof(state.keyboard.title));
-    strncpy(state.write_location, default_write_location, sizeof(state.write_location));
+    strncpy(state->keyboard.current_text, "", sizeof(state->keyboard.current_text));
+    strncpy(state->keyboard.initial_text, "", sizeof(state->keyboard.initial_text));
+    strncpy(state->keyboard.final_text, "", sizeof(state->keyboard.final_text));
+    strncpy(state->keyboard.title, "", sizeof(state->keyboard.title));
+    strncpy(state->write_location, "-", sizeof(state->write_location));
+}
 
-    if (!parse_arguments(&state, argc, argv))
+// read_client_control applies the control bytes a waiting client forwarded
+// a closed connection means the client is gone, so the keyboard closes
+static void read_client_control(int client_fd)
+{
+    int control;
+    while ((control = daemon_read_control(client_fd)) > 0)
     {
-        return ExitCodeError;
+        if (control == DAEMON_CONTROL_INTERRUPT)
+        {
+            stop_exit_code = ExitCodeKeyboardInterrupt;
+        }
+        else if (control == DAEMON_CONTROL_TERMINATE)
+        {
+            stop_exit_code = ExitCodeSigterm;
+        }
     }
 
-    // swallow all stdout from init calls
-    // MinUI will sometimes randomly log to stdout
-    swallow_stdout_from_function(init);
-
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+    if (control < 0)
+    {
+        stop_exit_code = ExitCodeSigterm;
+    }
+}
 
+// present shows the keyboard until the text is entered, cancelled or a signal ends it
+// client_fd is the daemon client to take control bytes from, or -1
+static void present(struct AppState *state, int client_fd)
+{
     // get initial wifi state
     int was_online = PLAT_isOnline();
 
@@ -778,12 +794,12 @@ int main(int argc, char *argv[])
     // handle_keyboard_input sets state.redraw to 0 if no key is pressed
     int was_ever_drawn = 0;
 
-    if (state.disable_auto_sleep)
+    if (state->disable_auto_sleep)
     {
         PWR_disableAutosleep();
     }
 
-    while (!state.quitting)
+    while (!state->quitting)
     {
         // start the frame to ensure GFX_sync() works
         // on devices that don't support vsync
@@ -791,7 +807,7 @@ int main(int argc, char *argv[])
 
         // handle turning the on/off screen on/off
         // as well as general power management
-        PWR_update(&state.redraw, NULL, NULL, NULL);
+        PWR_update(&state->redraw, NULL, NULL, NULL);
 
         // check if the device is on wifi
         // redraw if the wifi state changed
@@ -799,41 +815,53 @@ int main(int argc, char *argv[])
         int is_online = PLAT_isOnline();
         if (was_online != is_online)
         {
-            state.redraw = 1;
+            state->redraw = 1;
         }
         was_online = is_online;
 
         // handle any input events
-        handle_input(&state);
+        if (client_fd >= 0)
+        {
+            read_client_control(client_fd);
+        }
+        handle_input(state);
+
+        // a signal or the daemon client asked to stop
+        if (stop_exit_code)
+        {
+            state->exit_code = stop_exit_code;
+            state->quitting = 1;
+            break;
+        }
 
         // force a redraw if the screen was never drawn
-        if (!was_ever_drawn && !state.redraw)
+        if (!was_ever_drawn && !state->redraw)
         {
-            state.redraw = 1;
+            state->redraw = 1;
             was_ever_drawn = 1;
         }
 
         // redraw the screen if there has been a change
-        if (state.redraw)
+        if (state->redraw)
         {
             // clear the screen at the beginning of each loop
             GFX_clear(screen);
 
             // optionally display hardware status
-            if (state.show_hardware_group)
+            if (state->show_hardware_group)
             {
                 // draw the hardware information in the top-right
-                GFX_blitHardwareGroup(screen, state.show_brightness_setting);
+                GFX_blitHardwareGroup(screen, state->show_brightness_setting);
 
                 // draw the setting hints
-                if (state.show_brightness_setting)
+                if (state->show_brightness_setting)
                 {
-                    GFX_blitHardwareHints(screen, state.show_brightness_setting);
+                    GFX_blitHardwareHints(screen, state->show_brightness_setting);
                 }
             }
 
             // your draw logic goes here
-            draw_screen(screen, &state);
+            draw_screen(screen, state);
 
             // Takes the screen buffer and displays it on the screen
             GFX_flip(screen);
@@ -845,6 +873,68 @@ int main(int argc, char *argv[])
             GFX_sync();
         }
     }
+}
+
+// minui_keyboard_serve shows the keyboard for one request on minui-daemon, see daemon/daemon.h
+int minui_keyboard_serve(SDL_Surface *display, int client_fd, JSON_Object *request)
+{
+    int argc;
+    char **argv = daemon_request_argv(request, "minui-keyboard", &argc);
+    if (argv == NULL)
+    {
+        return ExitCodeError;
+    }
+
+    screen = display;
+    struct AppState state;
+    AppState_init(&state);
+    stop_exit_code = 0;
+
+    int exit_code = ExitCodeError;
+    if (parse_arguments(&state, argc, argv))
+    {
+        present(&state, client_fd);
+        exit_code = write_output(&state);
+    }
+    free(argv);
+    return exit_code;
+}
+
+#ifndef MINUI_DAEMON
+// main is the entry point for the app
+int main(int argc, char *argv[])
+{
+    // let a running minui-daemon show the keyboard instead of starting up
+    const char *path = daemon_socket_path(DAEMON_SOCKET_ENV, DAEMON_SOCKET_PATH);
+    JSON_Value *request_value = daemon_request_arguments("minui-keyboard", argc, argv);
+    if (request_value != NULL)
+    {
+        int exit_code;
+        bool forwarded = daemon_forward(path, request_value, &exit_code);
+        json_value_free(request_value);
+        if (forwarded)
+        {
+            return exit_code;
+        }
+    }
+
+    // Initialize app state
+    struct AppState state;
+    AppState_init(&state);
+
+    if (!parse_arguments(&state, argc, argv))
+    {
+        return ExitCodeError;
+    }
+
+    // swallow all stdout from init calls
+    // MinUI will sometimes randomly log to stdout
+    swallow_stdout_from_function(init);
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    present(&state, -1);
 
     int exit_code = write_output(&state);
     if (exit_code != ExitCodeSuccess)
@@ -856,4 +946,6 @@ int main(int argc, char *argv[])
 
     // exit the program
     return state.exit_code;
-}
\ No newline at end of file
+}
+
+#endif
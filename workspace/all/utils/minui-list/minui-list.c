@@ -1,10 +1,14 @@
+#include <daemon/daemon.h>
 #include <fcntl.h>
 #include <getopt.h>
 #include <msettings.h>
 #include <parson/parson.h>
+#include <poll.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #ifdef USE_SDL2
 #include <SDL2/SDL_ttf.h>
@@ -16,7 +20,7 @@
 #include "api.h"
 #include "utils.h"
 
-SDL_Surface *screen = NULL;
+static SDL_Surface *screen = NULL;
 
 enum list_result_t
 {
@@ -37,8 +41,26 @@ typedef int ExitCode;
 
 #define OPTION_PADDING 8
 
+// size of the blocks item strings are allocated from
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+// bytes read from a streamed text list per read call
+#define LIST_READ_SIZE (64 * 1024)
+
+// reads a streamed text list may do per frame once the first screen is shown
+#define LIST_READS_PER_FRAME 4
+
+// decoded backgrounds kept in memory: the selected item's and two neighbors on each side
+#define BACKGROUND_CACHE_SIZE 5
+
+// fonts kept open, so a daemon showing list after list opens each font once
+#define FONT_CACHE_SIZE 4
+
+// set from the daemon's control bytes to end the current list with that exit code
+static volatile sig_atomic_t stop_exit_code = 0;
+
 // log_error logs a message to stderr for debugging purposes
-void log_error(const char *msg)
+static void log_error(const char *msg)
 {
     // Set stderr to unbuffered mode
     setvbuf(stderr, NULL, _IONBF, 0);
@@ -46,7 +68,7 @@ void log_error(const char *msg)
 }
 
 // log_info logs a message to stdout for debugging purposes
-void log_info(const char *msg)
+static void log_info(const char *msg)
 {
     // Set stdout to unbuffered mode
     setvbuf(stdout, NULL, _IONBF, 0);
@@ -55,16 +77,16 @@ void log_info(const char *msg)
 
 struct ListItemFeature
 {
-    // the background color to use for the list
-    char background_color[1024];
-    // path to the background image to use for the list
-    char background_image[1024];
+    // the background color to use for the list (interned)
+    const char *background_color;
+    // path to the background image to use for the list (interned)
+    const char *background_image;
     // whether the background image exists
     bool background_image_exists;
     // whether the item can be disabled
     bool can_disable;
-    // the confirm text to display on the confirm button
-    char confirm_text[1024];
+    // the confirm text to display on the confirm button (interned)
+    const char *confirm_text;
     // whether the item is disabled
     bool disabled;
     // whether to draw arrows around the item
@@ -79,8 +101,8 @@ struct ListItemFeature
     bool is_header;
     // whether or not the item is unselectable
     bool unselectable;
-    // alignment of the item text ('left', 'center', 'right')
-    char alignment[1024];
+    // alignment of the item text ('left', 'center', 'right', interned)
+    const char *alignment;
 
     // whether the item has a background_color field
     bool has_background_color;
@@ -131,6 +153,51 @@ struct ListItem
     struct ListItemFeature features;
 };
 
+// ArenaBlock is one block of an Arena
+struct ArenaBlock
+{
+    // the previously filled block
+    struct ArenaBlock *next;
+    // bytes handed out from data
+    size_t used;
+    // bytes available in data
+    size_t size;
+    char data[];
+};
+
+// Arena hands out item strings from large blocks instead of one malloc each
+// everything allocated from it is freed at once by arena_free
+struct Arena
+{
+    // the block being filled
+    struct ArenaBlock *head;
+};
+
+// ListLoader reads a text list incrementally, so the first screen is drawn
+// before the rest of the input has arrived
+struct ListLoader
+{
+    // the file or stdin being read
+    int fd;
+    // unparsed input, ending with an incomplete line
+    char *buffer;
+    // bytes in buffer
+    size_t used;
+    // bytes allocated for buffer
+    size_t capacity;
+    // total bytes read
+    size_t total_read;
+    // whether the end of the input was reached
+    bool eof;
+    // rows the list shows at once
+    int row_count;
+    // defaults applied to every item (interned)
+    const char *confirm_text;
+    const char *background_image;
+    const char *background_color;
+    bool background_image_exists;
+};
+
 // ListState holds the state of the list
 struct ListState
 {
@@ -138,6 +205,12 @@ struct ListState
     struct ListItem *items;
     // number of items in the list
     size_t item_count;
+    // number of items allocated in items
+    size_t item_capacity;
+    // storage for item names and options
+    struct Arena arena;
+    // reads the rest of a text list, NULL when every item is loaded
+    struct ListLoader *loader;
     // rendering state
     // index of first visible item
     int first_visible;
@@ -218,7 +291,7 @@ struct AppState
     struct ListState *list_state;
 };
 
-bool has_left_button_group(struct AppState *app_state, struct ListState *list_state)
+static bool has_left_button_group(struct AppState *app_state, struct ListState *list_state)
 {
     bool is_action_hidden = false;
     bool is_enable_hidden = false;
@@ -241,7 +314,7 @@ bool has_left_button_group(struct AppState *app_state, struct ListState *list_st
     return true;
 }
 
-char *read_stdin()
+static char *read_stdin()
 {
     // Read all of stdin into a string
     char *stdin_contents = NULL;
@@ -280,196 +353,460 @@ char *read_stdin()
     return stdin_contents;
 }
 
-char *read_file(const char *filename)
+// InternTable stores one copy of every distinct item string
+// items point into it, so values shared by many items (the default background,
+// confirm text, alignment) cost a pointer per item rather than a copy each
+struct InternTable
+{
+    // open-addressed slots, NULL when empty
+    char **slots;
+    // number of slots, always a power of two
+    size_t capacity;
+    // number of strings stored
+    size_t count;
+};
+
+static struct InternTable intern_table = {NULL, 0, 0};
+
+// intern_hash hashes a string (32-bit FNV-1a)
+static uint32_t intern_hash(const char *str)
 {
-    FILE *file = fopen(filename, "r");
-    if (!file)
+    uint32_t hash = 2166136261u;
+    for (; *str; str++)
     {
-        return NULL;
+        hash ^= (unsigned char)*str;
+        hash *= 16777619u;
     }
+    return hash;
+}
 
-    // Get file size
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    fseek(file, 0, SEEK_SET);
+// intern_grow doubles the intern table and rehashes its strings
+static bool intern_grow()
+{
+    size_t capacity = intern_table.capacity ? intern_table.capacity * 2 : 64;
+    char **slots = calloc(capacity, sizeof(char *));
+    if (slots == NULL)
+    {
+        return false;
+    }
 
-    // Allocate buffer with extra byte for null terminator
-    char *contents = malloc(file_size + 1);
-    if (!contents)
+    for (size_t i = 0; i < intern_table.capacity; i++)
     {
-        fclose(file);
-        return NULL;
+        char *str = intern_table.slots[i];
+        if (str == NULL)
+        {
+            continue;
+        }
+
+        size_t slot = intern_hash(str) & (capacity - 1);
+        while (slots[slot] != NULL)
+        {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        slots[slot] = str;
     }
 
-    // Read file contents
-    size_t bytes_read = fread(contents, 1, file_size, file);
-    fclose(file);
+    free(intern_table.slots);
+    intern_table.slots = slots;
+    intern_table.capacity = capacity;
+    return true;
+}
 
-    if (bytes_read != file_size)
+// intern_string returns the shared copy of a string, adding it if needed
+// the result lives until intern_free and must not be modified or freed
+static const char *intern_string(const char *str)
+{
+    if (str == NULL)
     {
-        free(contents);
         return NULL;
     }
+    if (str[0] == '\0')
+    {
+        return "";
+    }
+
+    // keep the table at most 3/4 full
+    if ((intern_table.count + 1) * 4 > intern_table.capacity * 3 && !intern_grow())
+    {
+        log_error("Failed to grow the string table");
+        return "";
+    }
 
-    // Add null terminator
-    contents[file_size] = '\0';
+    size_t slot = intern_hash(str) & (intern_table.capacity - 1);
+    while (intern_table.slots[slot] != NULL)
+    {
+        if (strcmp(intern_table.slots[slot], str) == 0)
+        {
+            return intern_table.slots[slot];
+        }
+        slot = (slot + 1) & (intern_table.capacity - 1);
+    }
 
-    return contents;
+    char *copy = strdup(str);
+    if (copy == NULL)
+    {
+        log_error("Failed to copy string");
+        return "";
+    }
+    intern_table.slots[slot] = copy;
+    intern_table.count++;
+    return copy;
 }
 
-// ListState_New creates a new ListState from a JSON file
-struct ListState *ListState_New(const char *filename, const char *format, const char *item_key, const char *title, const char *confirm_text, const char *default_background_image, const char *default_background_color, bool show_hardware_group, struct AppState *app_state)
+// intern_free releases every interned string
+// the daemon calls it between lists, so strings from one list don't pile up in the next
+static void intern_free()
 {
-    struct ListState *state = malloc(sizeof(struct ListState));
+    for (size_t i = 0; i < intern_table.capacity; i++)
+    {
+        free(intern_table.slots[i]);
+    }
+    free(intern_table.slots);
+    intern_table = (struct InternTable){NULL, 0, 0};
+}
 
-    int max_row_count = ui.row_count;
-    if (strlen(title) > 0)
+// arena_alloc returns size bytes from the arena, or NULL if out of memory
+// allocations are pointer aligned so arrays of options can live there too
+static void *arena_alloc(struct Arena *arena, size_t size)
+{
+    size = (size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+    struct ArenaBlock *block = arena->head;
+    if (block == NULL || block->size - block->used < size)
     {
-        max_row_count -= 1;
+        size_t block_size = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        block = malloc(sizeof(struct ArenaBlock) + block_size);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+        block->next = arena->head;
+        block->used = 0;
+        block->size = block_size;
+        arena->head = block;
     }
-    if (show_hardware_group)
+
+    void *ptr = block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+// arena_strndup copies len bytes of a string into the arena and terminates it
+static char *arena_strndup(struct Arena *arena, const char *str, size_t len)
+{
+    char *copy = arena_alloc(arena, len + 1);
+    if (copy == NULL)
     {
-        max_row_count -= 1;
+        log_error("Failed to allocate item string");
+        return "";
     }
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
 
-    if (strcmp(format, "text") == 0)
+// arena_strdup copies a string into the arena
+static char *arena_strdup(struct Arena *arena, const char *str)
+{
+    return arena_strndup(arena, str, strlen(str));
+}
+
+// arena_free releases every block of the arena
+static void arena_free(struct Arena *arena)
+{
+    while (arena->head != NULL)
+    {
+        struct ArenaBlock *next = arena->head->next;
+        free(arena->head);
+        arena->head = next;
+    }
+}
+
+// ListState_reserve makes room for count items, returning false if out of memory
+static bool ListState_reserve(struct ListState *state, size_t count)
+{
+    if (count <= state->item_capacity)
+    {
+        return true;
+    }
+
+    size_t capacity = state->item_capacity ? state->item_capacity * 2 : 64;
+    while (capacity < count)
+    {
+        capacity *= 2;
+    }
+
+    struct ListItem *items = realloc(state->items, sizeof(struct ListItem) * capacity);
+    if (items == NULL)
+    {
+        log_error("Failed to allocate list items");
+        return false;
+    }
+    state->items = items;
+    state->item_capacity = capacity;
+    return true;
+}
+
+// ListLoader_addLine adds a line of a text list as an item, skipping blank lines
+static void ListLoader_addLine(struct ListState *state, const char *line_start, const char *line_end)
+{
+    struct ListLoader *loader = state->loader;
+
+    // Check if line has non-whitespace content
+    const char *p;
+    for (p = line_start; p < line_end && isspace(*p); p++)
+        ;
+    if (p == line_end || !ListState_reserve(state, state->item_count + 1))
+    {
+        return;
+    }
+
+    struct ListItem *item = &state->items[state->item_count++];
+    item->name = arena_strndup(&state->arena, line_start, line_end - line_start);
+    item->has_features = false;
+    item->has_options = false;
+    item->has_selected = false;
+    item->option_count = 0;
+    item->options = NULL;
+    item->selected = 0;
+    item->initial_selected = 0;
+    item->features = (struct ListItemFeature){
+        .background_color = "",
+        .background_image = "",
+        .confirm_text = loader->confirm_text,
+        .alignment = intern_string("left"),
+    };
+    if (loader->background_image != NULL)
+    {
+        item->features.background_image = loader->background_image;
+        item->features.background_image_exists = loader->background_image_exists;
+    }
+    if (loader->background_color != NULL)
+    {
+        item->features.background_color = loader->background_color;
+    }
+}
+
+// ListLoader_read reads one chunk of a text list and adds its complete lines as items
+// when wait is false it only reads input that is already available
+// returns false once every item has been loaded
+static bool ListLoader_read(struct ListState *state, bool wait)
+{
+    struct ListLoader *loader = state->loader;
+    if (loader == NULL)
+    {
+        return false;
+    }
+
+    if (!wait)
     {
-        char *contents = NULL;
-        if (strcmp(filename, "-") == 0)
+        struct pollfd pfd = {loader->fd, POLLIN, 0};
+        if (poll(&pfd, 1, 0) <= 0)
         {
-            contents = read_stdin();
+            return true;
+        }
+    }
+
+    // make room for a full read, growing when a single line is longer than the buffer
+    if (loader->capacity - loader->used < LIST_READ_SIZE)
+    {
+        size_t capacity = loader->used + LIST_READ_SIZE;
+        char *buffer = realloc(loader->buffer, capacity);
+        if (buffer == NULL)
+        {
+            log_error("Failed to allocate list buffer");
+            loader->eof = true;
         }
         else
         {
-            contents = read_file(filename);
+            loader->buffer = buffer;
+            loader->capacity = capacity;
         }
+    }
 
-        if (contents == NULL)
+    if (!loader->eof)
+    {
+        ssize_t count = read(loader->fd, loader->buffer + loader->used, LIST_READ_SIZE);
+        if (count < 0 && (errno == EINTR || errno == EAGAIN))
         {
-            log_error("Failed to read file or stdin");
-            free(state);
-            return NULL;
+            return true;
         }
-
-        // Count number of non-empty lines
-        size_t item_count = 0;
-        char *line_start = contents;
-        while (*line_start != '\0')
+        if (count <= 0)
         {
-            char *line_end = strchr(line_start, '\n');
-            if (!line_end)
-            {
-                line_end = line_start + strlen(line_start);
-            }
+            loader->eof = true;
+        }
+        else
+        {
+            loader->used += count;
+            loader->total_read += count;
+        }
+    }
 
-            // Check if line has non-whitespace content
-            char *p;
-            for (p = line_start; p < line_end && isspace(*p); p++)
-                ;
-            if (p < line_end)
-            {
-                item_count++;
-            }
+    // add every complete line, keeping an incomplete one for the next read
+    char *line_start = loader->buffer;
+    char *end = loader->buffer + loader->used;
+    char *line_end;
+    while ((line_end = memchr(line_start, '\n', end - line_start)) != NULL)
+    {
+        ListLoader_addLine(state, line_start, line_end);
+        line_start = line_end + 1;
+    }
+    if (loader->eof)
+    {
+        // the last line may not end with a newline
+        ListLoader_addLine(state, line_start, end);
+        line_start = end;
+    }
+    loader->used = end - line_start;
+    memmove(loader->buffer, line_start, loader->used);
 
-            if (*line_end == '\0')
-            {
-                break;
-            }
-            line_start = line_end + 1;
-        }
+    // show the new items if the list doesn't fill the screen yet
+    int last_visible = state->first_visible + loader->row_count;
+    if (last_visible > (int)state->item_count)
+    {
+        last_visible = state->item_count;
+    }
+    if (state->last_visible < last_visible)
+    {
+        state->last_visible = last_visible;
+    }
 
-        // Allocate array for items
-        state->items = malloc(sizeof(struct ListItem) * item_count);
-        state->item_count = item_count;
-        state->last_visible = (item_count < max_row_count) ? item_count : max_row_count;
-        state->first_visible = 0;
-        state->selected = 0;
+    if (!loader->eof)
+    {
+        return true;
+    }
+
+    if (loader->fd != STDIN_FILENO)
+    {
+        close(loader->fd);
+    }
+    free(loader->buffer);
+    free(loader);
+    state->loader = NULL;
+    return false;
+}
+
+// ListState_Free frees a ListState, its items and a loader that is still reading
+static void ListState_Free(struct ListState *state)
+{
+    if (state == NULL)
+    {
+        return;
+    }
 
-        // Add non-empty lines to items array
-        size_t item_index = 0;
-        line_start = contents;
-        while (*line_start != '\0')
+    if (state->loader != NULL)
+    {
+        if (state->loader->fd != STDIN_FILENO)
         {
-            char *line_end = strchr(line_start, '\n');
-            if (!line_end)
-            {
-                line_end = line_start + strlen(line_start);
-            }
+            close(state->loader->fd);
+        }
+        free(state->loader->buffer);
+        free(state->loader);
+    }
+    arena_free(&state->arena);
+    free(state->items);
+    free(state);
+}
 
-            // Check if line has non-whitespace content
-            char *p;
-            for (p = line_start; p < line_end && isspace(*p); p++)
-                ;
-            if (p < line_end)
-            {
-                size_t line_len = line_end - line_start;
-                char *line = malloc(line_len + 1);
-                memcpy(line, line_start, line_len);
-                line[line_len] = '\0';
-                state->items[item_index].name = line;
-                state->items[item_index].has_features = false;
-                state->items[item_index].has_options = false;
-                state->items[item_index].has_selected = false;
-                state->items[item_index].option_count = 0;
-                state->items[item_index].options = NULL;
-                state->items[item_index].selected = 0;
-                state->items[item_index].initial_selected = 0;
-                state->items[item_index].features = (struct ListItemFeature){
-                    .background_color = "",
-                    .background_image = "",
-                    .background_image_exists = false,
-                    .can_disable = false,
-                    .confirm_text = "",
-                    .disabled = false,
-                    .draw_arrows = false,
-                    .hide_action = false,
-                    .hide_cancel = false,
-                    .hide_confirm = false,
-                    .is_header = false,
-                    .unselectable = false,
-                    .alignment = "",
-                    .has_background_color = false,
-                    .has_background_image = false,
-                    .has_can_disable = false,
-                    .has_confirm_text = false,
-                    .has_draw_arrows = false,
-                    .has_disabled = false,
-                    .has_hide_action = false,
-                    .has_hide_cancel = false,
-                    .has_hide_confirm = false,
-                    .has_is_header = false,
-                    .has_unselectable = false,
-                    .has_alignment = false,
-                };
-                strncpy(state->items[item_index].features.alignment, "left", sizeof(state->items[item_index].features.alignment) - 1);
-                strncpy(state->items[item_index].features.confirm_text, confirm_text, sizeof(state->items[item_index].features.confirm_text) - 1);
-                if (default_background_image != NULL)
-                {
-                    strncpy(state->items[item_index].features.background_image, default_background_image, sizeof(state->items[item_index].features.background_image) - 1);
-                    if (access(default_background_image, F_OK) != -1)
-                    {
-                        state->items[item_index].features.background_image_exists = true;
-                    }
-                }
-                if (default_background_color != NULL)
-                {
-                    strncpy(state->items[item_index].features.background_color, default_background_color, sizeof(state->items[item_index].features.background_color) - 1);
-                }
+// ListState_loadUntil waits until a text list has at least count items or is fully loaded
+static void ListState_loadUntil(struct ListState *state, size_t count)
+{
+    while (state->item_count < count && ListLoader_read(state, true))
+        ;
+}
 
-                item_index++;
-            }
+// ListState_finishLoading waits for the rest of a text list
+static void ListState_finishLoading(struct ListState *state)
+{
+    while (ListLoader_read(state, true))
+        ;
+}
 
-            if (*line_end == '\0')
-            {
-                break;
-            }
-            line_start = line_end + 1;
+// ListState_loadText starts reading a text list and returns once the first screen of items is loaded
+// the rest is read by ListLoader_read as the list is shown
+static bool ListState_loadText(struct ListState *state, const char *filename, int row_count, const char *confirm_text, const char *default_background_image, bool default_background_image_exists, const char *default_background_color)
+{
+    int fd = STDIN_FILENO;
+    if (strcmp(filename, "-") != 0)
+    {
+        fd = open(filename, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
         }
+    }
 
-        free(contents);
+    struct ListLoader *loader = calloc(1, sizeof(struct ListLoader));
+    if (loader == NULL)
+    {
+        if (fd != STDIN_FILENO)
+        {
+            close(fd);
+        }
+        return false;
+    }
+    loader->fd = fd;
+    loader->row_count = row_count;
+    loader->confirm_text = intern_string(confirm_text);
+    loader->background_image = intern_string(default_background_image);
+    loader->background_image_exists = default_background_image_exists;
+    loader->background_color = intern_string(default_background_color);
+    state->loader = loader;
+
+    // the loader is freed by the read that reaches the end, so note what was read before each one
+    size_t total_read = 0;
+    while (state->item_count < (size_t)row_count && state->loader != NULL)
+    {
+        total_read = state->loader->total_read;
+        ListLoader_read(state, true);
+    }
+
+    // stdin with no input at all is an error rather than an empty list
+    if (fd == STDIN_FILENO && state->loader == NULL && total_read == 0)
+    {
+        return false;
+    }
+    return true;
+}
+
+// ListState_New creates a new ListState from a JSON file
+static struct ListState *ListState_New(const char *filename, const char *format, const char *item_key, const char *title, const char *confirm_text, const char *default_background_image, const char *default_background_color, bool show_hardware_group, struct AppState *app_state)
+{
+    struct ListState *state = calloc(1, sizeof(struct ListState));
+
+    // items without their own background share the default, so only check it once
+    bool default_background_image_exists = default_background_image != NULL && access(default_background_image, F_OK) != -1;
+
+    int max_row_count = ui.row_count;
+    if (strlen(title) > 0)
+    {
+        max_row_count -= 1;
+    }
+    if (show_hardware_group)
+    {
+        max_row_count -= 1;
+    }
+
+    if (strcmp(format, "text") == 0)
+    {
+        // text lists are streamed: the first screen is loaded here and
+        // the main loop reads the rest while the list is shown
+        state->first_visible = 0;
+        state->last_visible = 0;
+        state->selected = 0;
+        if (!ListState_loadText(state, filename, max_row_count, confirm_text, default_background_image, default_background_image_exists, default_background_color))
+        {
+            log_error("Failed to read file or stdin");
+            arena_free(&state->arena);
+            free(state->items);
+            free(state);
+            return NULL;
+        }
         return state;
     }
 
+    // the items are copied out of the tree, so it is parsed into an arena and freed in one go
+    JSON_Arena *json_arena = json_arena_create(0);
     JSON_Value *root_value;
     if (strcmp(filename, "-") == 0)
     {
@@ -477,21 +814,23 @@ struct ListState *ListState_New(const char *filename, const char *format, const
         if (contents == NULL)
         {
             log_error("Failed to read stdin");
+            json_arena_free(json_arena);
             free(state);
             return NULL;
         }
 
-        root_value = json_parse_string_with_comments(contents);
+        root_value = json_parse_string_with_comments_arena(json_arena, contents);
         free(contents);
     }
     else
     {
-        root_value = json_parse_file_with_comments(filename);
+        root_value = json_parse_file_with_comments_arena(json_arena, filename);
     }
 
     if (root_value == NULL)
     {
         log_error("Failed to parse JSON file");
+        json_arena_free(json_arena);
         free(state);
         return NULL;
     }
@@ -509,6 +848,7 @@ struct ListState *ListState_New(const char *filename, const char *format, const
     size_t item_count = json_array_get_count(items_array);
 
     state->items = malloc(sizeof(struct ListItem) * item_count);
+    state->item_capacity = item_count;
     state->has_options = false;
 
     if (strlen(item_key) == 0)
@@ -516,7 +856,7 @@ struct ListState *ListState_New(const char *filename, const char *format, const
         for (size_t i = 0; i < item_count; i++)
         {
             const char *name = json_array_get_string(items_array, i);
-            state->items[i].name = name ? strdup(name) : "";
+            state->items[i].name = name ? arena_strdup(&state->arena, name) : "";
 
             // set defaults for the other fields
             state->items[i].has_features = false;
@@ -553,19 +893,19 @@ struct ListState *ListState_New(const char *filename, const char *format, const
                 .has_unselectable = false,
                 .has_alignment = false,
             };
-            strncpy(state->items[i].features.alignment, "left", sizeof(state->items[i].features.alignment) - 1);
-            strncpy(state->items[i].features.confirm_text, confirm_text, sizeof(state->items[i].features.confirm_text) - 1);
+            state->items[i].features.alignment = intern_string("left");
+            state->items[i].features.confirm_text = intern_string(confirm_text);
             if (default_background_image != NULL)
             {
-                strncpy(state->items[i].features.background_image, default_background_image, sizeof(state->items[i].features.background_image) - 1);
-                if (access(default_background_image, F_OK) != -1)
+                state->items[i].features.background_image = intern_string(default_background_image);
+                if (default_background_image_exists)
                 {
                     state->items[i].features.background_image_exists = true;
                 }
             }
             if (default_background_color != NULL)
             {
-                strncpy(state->items[i].features.background_color, default_background_color, sizeof(state->items[i].features.background_color) - 1);
+                state->items[i].features.background_color = intern_string(default_background_color);
             }
         }
     }
@@ -576,19 +916,19 @@ struct ListState *ListState_New(const char *filename, const char *format, const
             JSON_Object *item = json_array_get_object(items_array, i);
 
             const char *name = json_object_get_string(item, "name");
-            state->items[i].name = name ? strdup(name) : "";
+            state->items[i].name = name ? arena_strdup(&state->arena, name) : "";
 
             // read in the options from the json object
             // if there are no options, set the options to an empty array
             // if there are options, treat them as a list of strings
             JSON_Array *options_array = json_object_get_array(item, "options");
             size_t options_count = json_array_get_count(options_array);
-            state->items[i].options = malloc(sizeof(char *) * options_count);
+            state->items[i].options = arena_alloc(&state->arena, sizeof(char *) * options_count);
             state->items[i].option_count = options_count;
             for (size_t j = 0; j < options_count; j++)
             {
                 const char *option = json_array_get_string(options_array, j);
-                state->items[i].options[j] = option ? strdup(option) : "";
+                state->items[i].options[j] = option ? arena_strdup(&state->arena, option) : "";
             }
 
             if (options_count > 0)
@@ -662,8 +1002,8 @@ struct ListState *ListState_New(const char *filename, const char *format, const
                 .has_unselectable = false,
                 .has_alignment = false,
             };
-            strncpy(state->items[i].features.alignment, "left", sizeof(state->items[i].features.alignment) - 1);
-            strncpy(state->items[i].features.confirm_text, confirm_text, sizeof(state->items[i].features.confirm_text) - 1);
+            state->items[i].features.alignment = intern_string("left");
+            state->items[i].features.confirm_text = intern_string(confirm_text);
             state->items[i].has_features = false;
             if (json_object_has_value(item, "features"))
             {
@@ -676,7 +1016,7 @@ struct ListState *ListState_New(const char *filename, const char *format, const
                 const char *background_image = json_object_get_string(features, "background_image");
                 if (background_image != NULL)
                 {
-                    strncpy(state->items[i].features.background_image, background_image, sizeof(state->items[i].features.background_image) - 1);
+                    state->items[i].features.background_image = intern_string(background_image);
                     if (access(background_image, F_OK) != -1)
                     {
                         state->items[i].features.background_image_exists = true;
@@ -687,8 +1027,8 @@ struct ListState *ListState_New(const char *filename, const char *format, const
                 {
                     if (default_background_image != NULL)
                     {
-                        strncpy(state->items[i].features.background_image, default_background_image, sizeof(state->items[i].features.background_image) - 1);
-                        if (access(default_background_image, F_OK) != -1)
+                        state->items[i].features.background_image = intern_string(default_background_image);
+                        if (default_background_image_exists)
                         {
                             state->items[i].features.background_image_exists = true;
                         }
@@ -706,14 +1046,14 @@ struct ListState *ListState_New(const char *filename, const char *format, const
                 const char *background_color = json_object_get_string(features, "background_color");
                 if (background_color != NULL)
                 {
-                    strncpy(state->items[i].features.background_color, background_color, sizeof(state->items[i].features.background_color) - 1);
+                    state->items[i].features.background_color = intern_string(background_color);
                     state->items[i].features.has_background_color = true;
                 }
                 else
                 {
                     if (default_background_color != NULL)
                     {
-                        strncpy(state->items[i].features.background_color, default_background_color, sizeof(state->items[i].features.background_color) - 1);
+                        state->items[i].features.background_color = intern_string(default_background_color);
                         state->items[i].features.has_background_color = true;
                     }
                     else
@@ -890,7 +1230,7 @@ struct ListState *ListState_New(const char *filename, const char *format, const
                 {
                     if (strcmp(alignment, "left") == 0 || strcmp(alignment, "center") == 0 || strcmp(alignment, "right") == 0)
                     {
-                        strncpy(state->items[i].features.alignment, alignment, sizeof(state->items[i].features.alignment) - 1);
+                        state->items[i].features.alignment = intern_string(alignment);
                         state->items[i].features.has_alignment = true;
                     }
                     else
@@ -898,13 +1238,13 @@ struct ListState *ListState_New(const char *filename, const char *format, const
                         char error_message[256];
                         snprintf(error_message, sizeof(error_message), "Item %s has invalid alignment %s. Must be 'left', 'center', or 'right'. Using default (left).", state->items[i].name, alignment);
                         log_error(error_message);
-                        strncpy(state->items[i].features.alignment, "left", sizeof(state->items[i].features.alignment) - 1);
+                        state->items[i].features.alignment = intern_string("left");
                         state->items[i].features.has_alignment = false;
                     }
                 }
                 else
                 {
-                    strncpy(state->items[i].features.alignment, "left", sizeof(state->items[i].features.alignment) - 1);
+                    state->items[i].features.alignment = intern_string("left");
                     state->items[i].features.has_alignment = false;
                 }
 
@@ -916,7 +1256,7 @@ struct ListState *ListState_New(const char *filename, const char *format, const
                 {
                     if (strlen(confirm_text) > 0)
                     {
-                        strncpy(state->items[i].features.confirm_text, confirm_text, sizeof(state->items[i].features.confirm_text) - 1);
+                        state->items[i].features.confirm_text = intern_string(confirm_text);
                         state->items[i].features.has_confirm_text = true;
                     }
                 }
@@ -925,8 +1265,8 @@ struct ListState *ListState_New(const char *filename, const char *format, const
             {
                 if (default_background_image != NULL)
                 {
-                    strncpy(state->items[i].features.background_image, default_background_image, sizeof(state->items[i].features.background_image) - 1);
-                    if (access(default_background_image, F_OK) != -1)
+                    state->items[i].features.background_image = intern_string(default_background_image);
+                    if (default_background_image_exists)
                     {
                         state->items[i].features.background_image_exists = true;
                     }
@@ -939,7 +1279,7 @@ struct ListState *ListState_New(const char *filename, const char *format, const
 
                 if (default_background_color != NULL)
                 {
-                    strncpy(state->items[i].features.background_color, default_background_color, sizeof(state->items[i].features.background_color) - 1);
+                    state->items[i].features.background_color = intern_string(default_background_color);
                     state->items[i].features.has_background_color = true;
                 }
                 else
@@ -961,12 +1301,12 @@ struct ListState *ListState_New(const char *filename, const char *format, const
     state->last_visible = (item_count < max_row_count) ? item_count : max_row_count;
     state->item_count = item_count;
 
-    json_value_free(root_value);
+    json_arena_free(json_arena);
     return state;
 }
 
 // handle_input interprets input events and mutates app state
-void handle_input(struct AppState *state)
+static void handle_input(struct AppState *state)
 {
     // do not redraw by default
     state->redraw = 0;
@@ -989,6 +1329,21 @@ void handle_input(struct AppState *state)
         max_row_count -= 1;
     }
 
+    // moving past the loaded items of a list that is still streaming in
+    // needs the items after them, and wrapping to the bottom needs all of them
+    if (state->list_state->loader != NULL)
+    {
+        int selected = state->list_state->selected;
+        if (PAD_justRepeated(BTN_UP) && selected == 0)
+        {
+            ListState_finishLoading(state->list_state);
+        }
+        else if (PAD_justRepeated(BTN_DOWN) || (PAD_justRepeated(BTN_RIGHT) && !state->list_state->has_options))
+        {
+            ListState_loadUntil(state->list_state, selected + max_row_count * 2 + 1);
+        }
+    }
+
     bool is_action_button_pressed = false;
     bool is_cancel_button_pressed = false;
     bool is_confirm_button_pressed = false;
@@ -1306,7 +1661,7 @@ void handle_input(struct AppState *state)
 }
 
 // detects if a string is a hex color
-bool detect_hex_color(const char *hex)
+static bool detect_hex_color(const char *hex)
 {
     if (hex[0] != '#')
     {
@@ -1324,7 +1679,7 @@ bool detect_hex_color(const char *hex)
 }
 
 // turns a hex color (e.g. #000000) into an SDL_Color
-SDL_Color hex_to_sdl_color(const char *hex)
+static SDL_Color hex_to_sdl_color(const char *hex)
 {
     SDL_Color color = {0, 0, 0, 255};
 
@@ -1347,12 +1702,12 @@ SDL_Color hex_to_sdl_color(const char *hex)
 }
 
 // turns an SDL_Color into a uint32_t
-uint32_t sdl_color_to_uint32(SDL_Color color)
+static uint32_t sdl_color_to_uint32(SDL_Color color)
 {
     return (uint32_t)((color.r << 16) + (color.g << 8) + (color.b << 0));
 }
 // scale_surface manually scales a surface to a new width and height for SDL1
-SDL_Surface *scale_surface(SDL_Surface *surface,
+static SDL_Surface *scale_surface(SDL_Surface *surface,
                            Uint16 width, Uint16 height)
 {
     SDL_Surface *scaled = SDL_CreateRGBSurface(surface->flags,
@@ -1400,76 +1755,296 @@ SDL_Surface *scale_surface(SDL_Surface *surface,
     return scaled;
 }
 
+// BackgroundCacheEntry holds a background image decoded and scaled for the screen
+struct BackgroundCacheEntry
+{
+    // path of the image, NULL when the entry is empty
+    char *path;
+    // modification time of the file when it was decoded
+    time_t mtime;
+    // size of the file when it was decoded
+    off_t size;
+    // the image, already scaled to the size of rect
+    SDL_Surface *surface;
+    // where the image is drawn on the screen
+    SDL_Rect rect;
+    // value of background_cache_clock when the entry was last used
+    unsigned int last_used;
+};
+
+// recently drawn backgrounds, so scrolling between items doesn't decode a PNG per keypress
+static struct BackgroundCacheEntry background_cache[BACKGROUND_CACHE_SIZE];
+static unsigned int background_cache_clock = 0;
+
+// background_cache_decode loads an image and scales it to where draw_background shows it
+static SDL_Surface *background_cache_decode(const char *path, SDL_Rect *rect)
+{
+    SDL_Surface *surface = IMG_Load(path);
+    if (!surface)
+    {
+        return NULL;
+    }
+
+    int imgW = surface->w, imgH = surface->h;
+
+    // Compute scale factor
+    float scaleX = (float)(FIXED_WIDTH - 2 * DP(ui.edge_padding)) / imgW;
+    float scaleY = (float)(FIXED_HEIGHT - 2 * DP(ui.edge_padding)) / imgH;
+    float scale = (scaleX < scaleY) ? scaleX : scaleY;
+
+    // Ensure upscaling only when the image is smaller than the screen
+    if (imgW * scale < FIXED_WIDTH - 2 * DP(ui.edge_padding) && imgH * scale < FIXED_HEIGHT - 2 * DP(ui.edge_padding))
+    {
+        scale = (scaleX > scaleY) ? scaleX : scaleY;
+    }
+
+    // Compute target dimensions
+    int dstW = imgW * scale;
+    int dstH = imgH * scale;
+
+    int dstX = (FIXED_WIDTH - dstW) / 2;
+    int dstY = (FIXED_HEIGHT - dstH) / 2;
+    if (imgW == FIXED_WIDTH && imgH == FIXED_HEIGHT)
+    {
+        dstW = FIXED_WIDTH;
+        dstH = FIXED_HEIGHT;
+        dstX = 0;
+        dstY = 0;
+    }
+
+    *rect = (SDL_Rect){dstX, dstY, dstW, dstH};
+    if (dstW == imgW && dstH == imgH)
+    {
+        return surface;
+    }
+    if (dstW <= 0 || dstH <= 0)
+    {
+        SDL_FreeSurface(surface);
+        return NULL;
+    }
+
+    // Scale once here so drawing is a plain blit
+#ifdef USE_SDL2
+    SDL_Surface *scaled = SDL_CreateRGBSurface(0, dstW, dstH, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+    if (scaled)
+    {
+        // copy the alpha channel as is, it is blended when the scaled image is drawn
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        SDL_BlitScaled(surface, NULL, scaled, NULL);
+    }
+#else
+    SDL_Surface *scaled = scale_surface(surface, dstW, dstH);
+#endif
+    SDL_FreeSurface(surface);
+    return scaled;
+}
+
+// background_cache_get returns the cached background for a file, decoding it if needed
+// file_stat identifies the version of the file, so replaced images are decoded again
+static struct BackgroundCacheEntry *background_cache_get(const char *path, const struct stat *file_stat)
+{
+    background_cache_clock++;
+
+    // find the image, or the least recently used entry to replace
+    struct BackgroundCacheEntry *victim = &background_cache[0];
+    for (int i = 0; i < BACKGROUND_CACHE_SIZE; i++)
+    {
+        struct BackgroundCacheEntry *entry = &background_cache[i];
+        if (entry->path != NULL && strcmp(entry->path, path) == 0)
+        {
+            if (entry->mtime == file_stat->st_mtime && entry->size == file_stat->st_size)
+            {
+                entry->last_used = background_cache_clock;
+                return entry;
+            }
+            victim = entry;
+            break;
+        }
+        if (entry->path == NULL || entry->last_used < victim->last_used)
+        {
+            victim = entry;
+        }
+    }
+
+    SDL_Rect rect;
+    SDL_Surface *surface = background_cache_decode(path, &rect);
+    if (!surface)
+    {
+        return NULL;
+    }
+
+    if (victim->surface)
+    {
+        SDL_FreeSurface(victim->surface);
+    }
+    free(victim->path);
+    victim->path = strdup(path);
+    victim->mtime = file_stat->st_mtime;
+    victim->size = file_stat->st_size;
+    victim->surface = surface;
+    victim->rect = rect;
+    victim->last_used = background_cache_clock;
+    return victim;
+}
+
+// background_cache_contains returns whether an image is cached and up to date
+static bool background_cache_contains(const char *path, const struct stat *file_stat)
+{
+    for (int i = 0; i < BACKGROUND_CACHE_SIZE; i++)
+    {
+        struct BackgroundCacheEntry *entry = &background_cache[i];
+        if (entry->path != NULL && strcmp(entry->path, path) == 0 && entry->mtime == file_stat->st_mtime && entry->size == file_stat->st_size)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// background_cache_prefetch decodes the background of at most one item near the selection
+// called on frames that are not redrawn, so the next scroll finds its image decoded
+// returns whether an image was decoded
+static bool background_cache_prefetch(struct AppState *state)
+{
+    struct ListState *list_state = state->list_state;
+    int offsets[] = {1, -1, 2, -2};
+    for (int i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++)
+    {
+        int index = list_state->selected + offsets[i];
+        if (index < 0 || index >= (int)list_state->item_count)
+        {
+            continue;
+        }
+
+        struct ListItemFeature *features = &list_state->items[index].features;
+        struct stat file_stat;
+        if (!features->background_image_exists || stat(features->background_image, &file_stat) != 0 || background_cache_contains(features->background_image, &file_stat))
+        {
+            continue;
+        }
+
+        return background_cache_get(features->background_image, &file_stat) != NULL;
+    }
+    return false;
+}
+
+// background_cache_free releases every cached background
+static void background_cache_free()
+{
+    for (int i = 0; i < BACKGROUND_CACHE_SIZE; i++)
+    {
+        if (background_cache[i].surface)
+        {
+            SDL_FreeSurface(background_cache[i].surface);
+        }
+        free(background_cache[i].path);
+        background_cache[i] = (struct BackgroundCacheEntry){0};
+    }
+}
+
+// FontCacheEntry holds a font opened in bold at one size
+struct FontCacheEntry
+{
+    // path of the font, NULL when the entry is empty
+    char *path;
+    // the size the font was opened at
+    int size;
+    // the open font
+    TTF_Font *font;
+    // value of font_cache_clock when the entry was last used
+    unsigned int last_used;
+};
+
+// fonts opened by earlier lists, so the daemon doesn't reopen them for every request
+static struct FontCacheEntry font_cache[FONT_CACHE_SIZE];
+static unsigned int font_cache_clock = 0;
+
+// font_cache_open returns the font at path opened in bold at size, opening it if it is not cached
+static TTF_Font *font_cache_open(const char *path, int size)
+{
+    font_cache_clock++;
+
+    // find the font, or the least recently used entry to replace
+    struct FontCacheEntry *victim = &font_cache[0];
+    for (int i = 0; i < FONT_CACHE_SIZE; i++)
+    {
+        struct FontCacheEntry *entry = &font_cache[i];
+        if (entry->path != NULL && entry->size == size && strcmp(entry->path, path) == 0)
+        {
+            entry->last_used = font_cache_clock;
+            return entry->font;
+        }
+        if (entry->path == NULL || entry->last_used < victim->last_used)
+        {
+            victim = entry;
+        }
+    }
+
+    TTF_Font *opened = TTF_OpenFont(path, size);
+    if (opened == NULL)
+    {
+        return NULL;
+    }
+    TTF_SetFontStyle(opened, TTF_STYLE_BOLD);
+
+    if (victim->font)
+    {
+        TTF_CloseFont(victim->font);
+    }
+    free(victim->path);
+    victim->path = strdup(path);
+    victim->size = size;
+    victim->font = opened;
+    victim->last_used = font_cache_clock;
+    return opened;
+}
+
+// font_cache_free closes every cached font
+static void font_cache_free()
+{
+    for (int i = 0; i < FONT_CACHE_SIZE; i++)
+    {
+        if (font_cache[i].font)
+        {
+            TTF_CloseFont(font_cache[i].font);
+        }
+        free(font_cache[i].path);
+        font_cache[i] = (struct FontCacheEntry){0};
+    }
+}
+
 // draw_background draws the background of the list
-bool draw_background(SDL_Surface *screen, struct AppState *state)
+static bool draw_background(SDL_Surface *screen, struct AppState *state)
 {
+    struct ListItemFeature *features = &state->list_state->items[state->list_state->selected].features;
+
     // render a background color
     char hex_color[1024] = "#000000";
-    if (state->list_state->items[state->list_state->selected].features.background_color != NULL)
+    if (features->background_color != NULL)
     {
-        strncpy(hex_color, state->list_state->items[state->list_state->selected].features.background_color, sizeof(hex_color));
+        strncpy(hex_color, features->background_color, sizeof(hex_color));
     }
 
     SDL_Color background_color = hex_to_sdl_color(hex_color);
     uint32_t color = SDL_MapRGBA(screen->format, background_color.r, background_color.g, background_color.b, 255);
     SDL_FillRect(screen, NULL, color);
 
+    // check if there is an image and it is accessible
+    struct stat file_stat;
     bool should_draw_background_image = false;
-    if (state->list_state->items[state->list_state->selected].features.background_image_exists && access(state->list_state->items[state->list_state->selected].features.background_image, F_OK) != -1)
+    if (features->background_image_exists && stat(features->background_image, &file_stat) == 0)
     {
         should_draw_background_image = true;
     }
 
-    // check if there is an image and it is accessible
     if (should_draw_background_image)
     {
-        SDL_Surface *surface = IMG_Load(state->list_state->items[state->list_state->selected].features.background_image);
-        if (surface)
+        struct BackgroundCacheEntry *entry = background_cache_get(features->background_image, &file_stat);
+        if (entry)
         {
-            int imgW = surface->w, imgH = surface->h;
-
-            // Compute scale factor
-            float scaleX = (float)(FIXED_WIDTH - 2 * DP(ui.edge_padding)) / imgW;
-            float scaleY = (float)(FIXED_HEIGHT - 2 * DP(ui.edge_padding)) / imgH;
-            float scale = (scaleX < scaleY) ? scaleX : scaleY;
-
-            // Ensure upscaling only when the image is smaller than the screen
-            if (imgW * scale < FIXED_WIDTH - 2 * DP(ui.edge_padding) && imgH * scale < FIXED_HEIGHT - 2 * DP(ui.edge_padding))
-            {
-                scale = (scaleX > scaleY) ? scaleX : scaleY;
-            }
-
-            // Compute target dimensions
-            int dstW = imgW * scale;
-            int dstH = imgH * scale;
-
-            int dstX = (FIXED_WIDTH - dstW) / 2;
-            int dstY = (FIXED_HEIGHT - dstH) / 2;
-            if (imgW == FIXED_WIDTH && imgH == FIXED_HEIGHT)
-            {
-                dstW = FIXED_WIDTH;
-                dstH = FIXED_HEIGHT;
-                dstX = 0;
-                dstY = 0;
-            }
-
-            // Compute destination rectangle
-            SDL_Rect dstRect = {dstX, dstY, dstW, dstH};
-#ifdef USE_SDL2
-            SDL_BlitScaled(surface, NULL, screen, &dstRect);
-#else
-            if (imgW == FIXED_WIDTH && imgH == FIXED_HEIGHT)
-            {
-                SDL_BlitSurface(surface, NULL, screen, &dstRect);
-            }
-            else
-            {
-                SDL_Surface *scaled = scale_surface(surface, dstW, dstH);
-                SDL_BlitSurface(scaled, NULL, screen, &dstRect);
-                SDL_FreeSurface(scaled);
-            }
-#endif
-            SDL_FreeSurface(surface);
+            // SDL_BlitSurface may clip the rect it is given
+            SDL_Rect dstRect = entry->rect;
+            SDL_BlitSurface(entry->surface, NULL, screen, &dstRect);
         }
     }
 
@@ -1477,7 +2052,7 @@ bool draw_background(SDL_Surface *screen, struct AppState *state)
 }
 
 // draw_screen interprets the app state and draws it to the screen
-void draw_screen(SDL_Surface *screen, struct AppState *state, int ow, bool should_draw_background_image)
+static void draw_screen(SDL_Surface *screen, struct AppState *state, int ow, bool should_draw_background_image)
 {
     bool force_hide_confirm = false;
     if (state->list_state->items[state->list_state->selected].has_options && state->list_state->items[state->list_state->selected].initial_selected == state->list_state->items[state->list_state->selected].selected)
@@ -1501,11 +2076,11 @@ void draw_screen(SDL_Surface *screen, struct AppState *state, int ow, bool shoul
     }
     else if (state->list_state->items[state->list_state->selected].features.hide_cancel)
     {
-        GFX_blitButtonGroup((char *[]){state->confirm_button, state->list_state->items[state->list_state->selected].features.confirm_text, NULL}, 1, screen, 1);
+        GFX_blitButtonGroup((char *[]){state->confirm_button, (char *)state->list_state->items[state->list_state->selected].features.confirm_text, NULL}, 1, screen, 1);
     }
     else
     {
-        GFX_blitButtonGroup((char *[]){state->cancel_button, state->cancel_text, state->confirm_button, state->list_state->items[state->list_state->selected].features.confirm_text, NULL}, 1, screen, 1);
+        GFX_blitButtonGroup((char *[]){state->cancel_button, state->cancel_text, state->confirm_button, (char *)state->list_state->items[state->list_state->selected].features.confirm_text, NULL}, 1, screen, 1);
     }
 
     // if there is a title specified, compute the space needed for it
@@ -1602,7 +2177,7 @@ void draw_screen(SDL_Surface *screen, struct AppState *state, int ow, bool shoul
         // item.name
         char display_text[256];
         char display_selected_text[256];
-        char *alignment = state->list_state->items[i].features.alignment;
+        const char *alignment = state->list_state->items[i].features.alignment;
         bool is_hex_color = false;
         strncpy(display_selected_text, "", sizeof(display_selected_text));
         if (state->list_state->items[i].option_count > 0)
@@ -1861,7 +2436,9 @@ void draw_screen(SDL_Surface *screen, struct AppState *state, int ow, bool shoul
     state->redraw = 0;
 }
 
-bool open_fonts(struct AppState *state)
+// open_fonts opens the fonts the arguments ask for, falling back to MinUI's own
+// the opened fonts belong to the font cache
+static bool open_fonts(struct AppState *state)
 {
     if (state->fonts.default_font != NULL)
     {
@@ -1882,23 +2459,21 @@ bool open_fonts(struct AppState *state)
             return false;
         }
 
-        state->fonts.large = TTF_OpenFont(state->fonts.large_font, DP(FONT_LARGE));
+        state->fonts.large = font_cache_open(state->fonts.large_font, DP(FONT_LARGE));
         if (state->fonts.large == NULL)
         {
             log_error("Failed to open large font");
             return false;
         }
-        TTF_SetFontStyle(state->fonts.large, TTF_STYLE_BOLD);
     }
     else if (state->fonts.default_font != NULL)
     {
-        state->fonts.large = TTF_OpenFont(state->fonts.default_font, DP(FONT_LARGE));
+        state->fonts.large = font_cache_open(state->fonts.default_font, DP(FONT_LARGE));
         if (state->fonts.large == NULL)
         {
             log_error("Failed to open default font");
             return false;
         }
-        TTF_SetFontStyle(state->fonts.large, TTF_STYLE_BOLD);
     }
     else
     {
@@ -1913,23 +2488,21 @@ bool open_fonts(struct AppState *state)
             log_error("Invalid font path provided");
             return false;
         }
-        state->fonts.medium = TTF_OpenFont(state->fonts.medium_font, DP(FONT_MEDIUM));
+        state->fonts.medium = font_cache_open(state->fonts.medium_font, DP(FONT_MEDIUM));
         if (state->fonts.medium == NULL)
         {
             log_error("Failed to open medium font");
             return false;
         }
-        TTF_SetFontStyle(state->fonts.medium, TTF_STYLE_BOLD);
     }
     else if (state->fonts.default_font != NULL)
     {
-        state->fonts.medium = TTF_OpenFont(state->fonts.default_font, DP(FONT_MEDIUM));
+        state->fonts.medium = font_cache_open(state->fonts.default_font, DP(FONT_MEDIUM));
         if (state->fonts.medium == NULL)
         {
             log_error("Failed to open default font");
             return false;
         }
-        TTF_SetFontStyle(state->fonts.medium, TTF_STYLE_BOLD);
     }
     else
     {
@@ -1941,7 +2514,7 @@ bool open_fonts(struct AppState *state)
 
 // suppress_output suppresses stdout and stderr
 // returns a single integer containing both file descriptors
-int suppress_output(void)
+static int suppress_output(void)
 {
     int stdout_fd = dup(STDOUT_FILENO);
     int stderr_fd = dup(STDERR_FILENO);
@@ -1955,7 +2528,7 @@ int suppress_output(void)
 }
 
 // restore_output restores stdout and stderr to the original file descriptors
-void restore_output(int saved_fds)
+static void restore_output(int saved_fds)
 {
     int stdout_fd = (saved_fds >> 16) & 0xFFFF;
     int stderr_fd = saved_fds & 0xFFFF;
@@ -1974,7 +2547,7 @@ void restore_output(int saved_fds)
 // this is useful for suppressing output from a function
 // that we don't want to see in the log file
 // the InitSettings() function is an example of this (some implementations print to stdout)
-void swallow_stdout_from_function(void (*func)(void))
+static void swallow_stdout_from_function(void (*func)(void))
 {
     int saved_fds = suppress_output();
 
@@ -1983,7 +2556,7 @@ void swallow_stdout_from_function(void (*func)(void))
     restore_output(saved_fds);
 }
 
-void signal_handler(int signal)
+static void signal_handler(int signal)
 {
     // if the signal is a ctrl+c, exit with code 130
     if (signal == SIGINT)
@@ -2022,7 +2595,7 @@ void signal_handler(int signal)
 // - --item-key <key> (default: "items")
 // - --write-location <location> (default: "-")
 // - --write-value <value> (default: "selected")
-bool parse_arguments(struct AppState *state, int argc, char *argv[])
+static bool parse_arguments(struct AppState *state, int argc, char *argv[])
 {
     static struct option long_options[] = {
         {"action-button", required_argument, 0, 'a'},
@@ -2093,13 +2666,16 @@ bool parse_arguments(struct AppState *state, int argc, char *argv[])
             state->show_hardware_group = 0;
             break;
         case 'l':
-            strncpy(state->fonts.default_font, optarg, sizeof(state->fonts.default_font) - 1);
+            free(state->fonts.default_font);
+            state->fonts.default_font = strdup(optarg);
             break;
         case 'L':
-            strncpy(state->fonts.large_font, optarg, sizeof(state->fonts.large_font) - 1);
+            free(state->fonts.large_font);
+            state->fonts.large_font = strdup(optarg);
             break;
         case 'M':
-            strncpy(state->fonts.medium_font, optarg, sizeof(state->fonts.medium_font) - 1);
+            free(state->fonts.medium_font);
+            state->fonts.medium_font = strdup(optarg);
             break;
         case 'K':
             strncpy(state->item_key, optarg, sizeof(state->item_key) - 1);
@@ -2350,7 +2926,7 @@ bool parse_arguments(struct AppState *state, int argc, char *argv[])
 // init initializes the app state
 // everything is placed here as MinUI sometimes logs to stdout
 // and the logging happens depending on the platform
-void init()
+static void init()
 {
     // set the cpu speed to the menu speed
     // this is done here to ensure we downclock
@@ -2372,7 +2948,7 @@ void init()
 }
 
 // destruct cleans up the app state in reverse order
-void destruct()
+static void destruct()
 {
     QuitSettings();
     PWR_quit();
@@ -2381,7 +2957,7 @@ void destruct()
 }
 
 // write_to_file writes some text to a file
-int write_to_file(const char *filename, const char *text)
+static int write_to_file(const char *filename, const char *text)
 {
     FILE *file = fopen(filename, "w");
     if (file == NULL)
@@ -2398,7 +2974,7 @@ int write_to_file(const char *filename, const char *text)
 }
 
 // write_output writes the final text to the write location
-int write_output(struct AppState *state)
+static int write_output(struct AppState *state)
 {
     if (strcmp(state->write_value, "selected") == 0)
     {
@@ -2600,27 +3176,10 @@ int write_output(struct AppState *state)
     return state->exit_code;
 }
 
-// main is the entry point for the app
-int main(int argc, char *argv[])
+// AppState_init resets the app state to the defaults used before parsing arguments
+static void AppState_init(struct AppState *state)
 {
-    // Initialize app state
-    char default_action_button[1024] = "";
-    char default_action_text[1024] = "ACTION";
-    char default_background_image[1024] = "";
-    char default_background_color[1024] = "#000000";
-    char default_cancel_button[1024] = "B";
-    char default_cancel_text[1024] = "BACK";
-    char default_enable_button[1024] = "Y";
-    char default_confirm_button[1024] = "A";
-    char default_confirm_text[1024] = "SELECT";
-    char default_file[1024] = "";
-    char default_format[1024] = "json";
-    char default_item_key[1024] = "";
-    char default_write_value[1024] = "selected";
-    char default_title[1024] = "";
-    char default_title_alignment[1024] = "left";
-    char default_write_location[1024] = "-";
-    struct AppState state = {
+    *state = (struct AppState){
         .exit_code = ExitCodeSuccess,
         .quitting = 0,
         .redraw = 1,
@@ -2636,71 +3195,101 @@ int main(int argc, char *argv[])
         },
         .list_state = NULL};
 
-    // assign the default values to the app state
-    strncpy(state.action_button, default_action_button, sizeof(state.action_button) - 1);
-    strncpy(state.action_text, default_action_text, sizeof(state.action_text) - 1);
-    strncpy(state.background_image, default_background_image, sizeof(state.background_image));
-    strncpy(state.background_color, default_background_color, sizeof(state.background_color));
-    strncpy(state.cancel_button, default_cancel_button, sizeof(state.cancel_button) - 1);
-    strncpy(state.cancel_text, default_cancel_text, sizeof(state.cancel_text) - 1);
-    strncpy(state.confirm_button, default_confirm_button, sizeof(state.confirm_button) - 1);
-    strncpy(state.confirm_text, default_confirm_text, sizeof(state.confirm_text) - 1);
-    strncpy(state.enable_button, default_enable_button, sizeof(state.enable_button) - 1);
-    strncpy(state.file, default_file, sizeof(state.file) - 1);
-    strncpy(state.format, default_format, sizeof(state.format) - 1);
-    strncpy(state.item_key, default_item_key, sizeof(state.item_key) - 1);
-    strncpy(state.write_value, default_write_value, sizeof(state.write_value) - 1);
-    strncpy(state.title, default_title, sizeof(state.title) - 1);
-    strncpy(state.title_alignment, default_title_alignment, sizeof(state.title_alignment) - 1);
-    strncpy(state.write_location, default_write_location, sizeof(state.write_location) - 1);
+    strncpy(state->action_button, "", sizeof(state->action_button) - 1);
+    strncpy(state->action_text, "ACTION", sizeof(state->action_text) - 1);
+    strncpy(state->background_image, "", sizeof(state->background_image));
+    strncpy(state->background_color, "#000000", sizeof(state->background_color));
+    strncpy(state->cancel_button, "B", sizeof(state->cancel_button) - 1);
+    strncpy(state->cancel_text, "BACK", sizeof(state->cancel_text) - 1);
+    strncpy(state->confirm_button, "A", sizeof(state->confirm_button) - 1);
+    strncpy(state->confirm_text, "SELECT", sizeof(state->confirm_text) - 1);
+    strncpy(state->enable_button, "Y", sizeof(state->enable_button) - 1);
+    strncpy(state->file, "", sizeof(state->file) - 1);
+    strncpy(state->format, "json", sizeof(state->format) - 1);
+    strncpy(state->item_key, "", sizeof(state->item_key) - 1);
+    strncpy(state->write_value, "selected", sizeof(state->write_value) - 1);
+    strncpy(state->title, "", sizeof(state->title) - 1);
+    strncpy(state->title_alignment, "left", sizeof(state->title_alignment) - 1);
+    strncpy(state->write_location, "-", sizeof(state->write_location) - 1);
+}
 
-    // parse the arguments
-    if (!parse_arguments(&state, argc, argv))
+// AppState_free frees the list and the font paths parse_arguments copied
+// the fonts themselves stay open in the font cache for the next list
+static void AppState_free(struct AppState *state)
+{
+    ListState_Free(state->list_state);
+    state->list_state = NULL;
+    free(state->fonts.default_font);
+    free(state->fonts.large_font);
+    free(state->fonts.medium_font);
+    state->fonts = (struct Fonts){0};
+}
+
+// load_list loads the list the arguments point at and checks it has something to select
+static bool load_list(struct AppState *state)
+{
+    state->list_state = ListState_New(state->file, state->format, state->item_key, state->title, state->confirm_text, state->background_image, state->background_color, state->show_hardware_group, state);
+    if (state->list_state == NULL)
     {
-        return ExitCodeError;
+        log_error("Failed to create list state");
+        return false;
     }
 
-    state.list_state = ListState_New(state.file, state.format, state.item_key, state.title, state.confirm_text, state.background_image, state.background_color, state.show_hardware_group, &state);
-    if (state.list_state == NULL)
+    // the list is drawn around items[selected], so an empty list has nothing to show
+    if (state->list_state->item_count == 0)
     {
-        log_error("Failed to create list state");
-        return ExitCodeError;
+        log_error("No items found");
+        return false;
     }
 
-    if (state.list_state->item_count > 0)
+    // validate that at least one item is not a header and is selectable
+    bool has_selectable = false;
+    for (size_t i = 0; i < state->list_state->item_count; i++)
     {
-        // if there are items in the list,
-        // validate that at least one item is not a header and is selectable
-        bool has_selectable = false;
-        for (size_t i = 0; i < state.list_state->item_count; i++)
-        {
-            state.list_state->selected = i;
-            if (!state.list_state->items[i].features.is_header && !state.list_state->items[i].features.unselectable)
-            {
-                has_selectable = true;
-                break;
-            }
-        }
-        if (!has_selectable)
+        state->list_state->selected = i;
+        if (!state->list_state->items[i].features.is_header && !state->list_state->items[i].features.unselectable)
         {
-            log_error("No selectable items found");
-            return ExitCodeError;
+            has_selectable = true;
+            break;
         }
     }
+    if (!has_selectable)
+    {
+        log_error("No selectable items found");
+        return false;
+    }
 
-    // swallow all stdout from init calls
-    // MinUI will sometimes randomly log to stdout
-    swallow_stdout_from_function(init);
+    return true;
+}
 
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+// read_client_control applies the control bytes a waiting client forwarded
+// a closed connection means the client is gone, so the list closes
+static void read_client_control(int client_fd)
+{
+    int control;
+    while ((control = daemon_read_control(client_fd)) > 0)
+    {
+        if (control == DAEMON_CONTROL_INTERRUPT)
+        {
+            stop_exit_code = ExitCodeKeyboardInterrupt;
+        }
+        else if (control == DAEMON_CONTROL_TERMINATE)
+        {
+            stop_exit_code = ExitCodeSigterm;
+        }
+    }
 
-    if (!open_fonts(&state))
+    if (control < 0)
     {
-        log_error("Failed to open fonts");
-        return ExitCodeError;
+        stop_exit_code = ExitCodeSigterm;
     }
+}
 
+// present shows the list until an item is chosen, the list is cancelled or a signal ends it,
+// then writes the result
+// client_fd is the daemon client to take control bytes from, or -1
+static int present(struct AppState *state, int client_fd)
+{
     // get initial wifi state
     int was_online = PLAT_isOnline();
 
@@ -2708,12 +3297,12 @@ int main(int argc, char *argv[])
     // handle_input sets state.redraw to 0 if no key is pressed
     int was_ever_drawn = 0;
 
-    if (state.disable_auto_sleep)
+    if (state->disable_auto_sleep)
     {
         PWR_disableAutosleep();
     }
 
-    while (!state.quitting)
+    while (!state->quitting)
     {
         // start the frame to ensure GFX_sync() works
         // on devices that don't support vsync
@@ -2721,9 +3310,9 @@ int main(int argc, char *argv[])
 
         // handle turning the on/off screen on/off
         // as well as general power management
-        PWR_update(&state.redraw, NULL, NULL, NULL);
+        PWR_update(&state->redraw, NULL, NULL, NULL);
         bool power_redraw = false;
-        if (state.redraw)
+        if (state->redraw)
         {
             power_redraw = true;
         }
@@ -2734,46 +3323,76 @@ int main(int argc, char *argv[])
         int is_online = PLAT_isOnline();
         if (was_online != is_online)
         {
-            state.redraw = 1;
+            state->redraw = 1;
         }
         was_online = is_online;
 
         // handle any input events
-        handle_input(&state);
+        if (client_fd >= 0)
+        {
+            read_client_control(client_fd);
+        }
+        handle_input(state);
+
+        // a signal or the daemon client asked to stop
+        if (stop_exit_code)
+        {
+            state->exit_code = stop_exit_code;
+            state->quitting = 1;
+            break;
+        }
+
+        // keep reading a streamed list without blocking the frame
+        // and redraw if new items became visible
+        if (state->list_state->loader != NULL)
+        {
+            int last_visible = state->list_state->last_visible;
+            for (int i = 0; i < LIST_READS_PER_FRAME; i++)
+            {
+                if (!ListLoader_read(state->list_state, false))
+                {
+                    break;
+                }
+            }
+            if (state->list_state->last_visible != last_visible)
+            {
+                state->redraw = 1;
+            }
+        }
 
         // force a redraw if the screen was never drawn
-        if (!was_ever_drawn && !state.redraw)
+        if (!was_ever_drawn && !state->redraw)
         {
-            state.redraw = 1;
+            state->redraw = 1;
             was_ever_drawn = 1;
         }
 
         // force a redraw if the power state changed
         if (power_redraw)
         {
-            state.redraw = 1;
+            state->redraw = 1;
         }
 
         // redraw the screen if there has been a change
-        if (state.redraw)
+        if (state->redraw)
         {
             // clear the screen at the beginning of each loop
             GFX_clear(screen);
 
-            bool should_draw_background_image = draw_background(screen, &state);
+            bool should_draw_background_image = draw_background(screen, state);
 
             int ow = 0;
-            if (state.show_hardware_group)
+            if (state->show_hardware_group)
             {
                 // draw the hardware information in the top-right
-                ow = GFX_blitHardwareGroup(screen, state.show_brightness_setting);
+                ow = GFX_blitHardwareGroup(screen, state->show_brightness_setting);
 
-                if (!has_left_button_group(&state, state.list_state))
+                if (!has_left_button_group(state, state->list_state))
                 {
                     // draw the setting hints
-                    if (state.show_brightness_setting && !GetHDMI())
+                    if (state->show_brightness_setting && !GetHDMI())
                     {
-                        GFX_blitHardwareHints(screen, state.show_brightness_setting);
+                        GFX_blitHardwareHints(screen, state->show_brightness_setting);
                     }
                     else
                     {
@@ -2783,27 +3402,130 @@ int main(int argc, char *argv[])
             }
 
             // your draw logic goes here
-            draw_screen(screen, &state, ow, should_draw_background_image);
+            draw_screen(screen, state, ow, should_draw_background_image);
 
             // Takes the screen buffer and displays it on the screen
             GFX_flip(screen);
         }
         else
         {
+            // decode nearby backgrounds while idle so scrolling to them is just a blit
+            background_cache_prefetch(state);
+
             // Slows down the frame rate to match the refresh rate of the screen
             // when the screen is not being redrawn
             GFX_sync();
         }
     }
 
-    int exit_code = write_output(&state);
+    // the selected item is already loaded, but writing the whole state needs every item
+    if (strcmp(state->write_value, "selected") != 0)
+    {
+        ListState_finishLoading(state->list_state);
+    }
+
+    return write_output(state);
+}
+
+// minui_list_serve shows the list for one request on minui-daemon, see daemon/daemon.h
+// decoded backgrounds and fonts stay cached for the next list
+int minui_list_serve(SDL_Surface *display, int client_fd, JSON_Object *request)
+{
+    int argc;
+    char **argv = daemon_request_argv(request, "minui-list", &argc);
+    if (argv == NULL)
+    {
+        return ExitCodeError;
+    }
+
+    screen = display;
+    struct AppState state;
+    AppState_init(&state);
+    stop_exit_code = 0;
+
+    int exit_code = ExitCodeError;
+    if (parse_arguments(&state, argc, argv) && load_list(&state))
+    {
+        if (open_fonts(&state))
+        {
+            exit_code = present(&state, client_fd);
+        }
+        else
+        {
+            log_error("Failed to open fonts");
+        }
+    }
+    AppState_free(&state);
+    intern_free();
+    free(argv);
+    return exit_code;
+}
+
+// minui_list_quit releases the backgrounds and fonts kept cached between lists
+void minui_list_quit(void)
+{
+    background_cache_free();
+    font_cache_free();
+}
+
+#ifndef MINUI_DAEMON
+// main is the entry point for the app
+int main(int argc, char *argv[])
+{
+    // let a running minui-daemon show the list instead of starting up
+    const char *path = daemon_socket_path(DAEMON_SOCKET_ENV, DAEMON_SOCKET_PATH);
+    JSON_Value *request_value = daemon_request_arguments("minui-list", argc, argv);
+    if (request_value != NULL)
+    {
+        int exit_code;
+        bool forwarded = daemon_forward(path, request_value, &exit_code);
+        json_value_free(request_value);
+        if (forwarded)
+        {
+            return exit_code;
+        }
+    }
+
+    // Initialize app state
+    struct AppState state;
+    AppState_init(&state);
+
+    // parse the arguments
+    if (!parse_arguments(&state, argc, argv))
+    {
+        return ExitCodeError;
+    }
+
+    if (!load_list(&state))
+    {
+        return ExitCodeError;
+    }
+
+    // swallow all stdout from init calls
+    // MinUI will sometimes randomly log to stdout
+    swallow_stdout_from_function(init);
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    if (!open_fonts(&state))
+    {
+        log_error("Failed to open fonts");
+        return ExitCodeError;
+    }
+
+    int exit_code = present(&state, -1);
     if (exit_code != ExitCodeSuccess)
     {
         return exit_code;
     }
 
+    background_cache_free();
+    font_cache_free();
     swallow_stdout_from_function(destruct);
 
     // exit the program
     return state.exit_code;
 }
+
+#endif
@@ -1,3 +1,4 @@
+#include <daemon/daemon.h>
 #include <fcntl.h>
 #include <getopt.h>
 #include <msettings.h>
@@ -7,6 +8,7 @@
 #include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <sys/socket.h>
 #include <sys/time.h>
 #include <unistd.h>
 #ifdef USE_SDL2
@@ -21,19 +23,22 @@
 #include "api.h"
 #include "utils.h"
 
-SDL_Surface *screen = NULL;
+static SDL_Surface *screen = NULL;
 
 #ifdef USE_SDL2
-bool use_sdl2 = true;
+static bool use_sdl2 = true;
 #else
-bool use_sdl2 = false;
+static bool use_sdl2 = false;
 #endif
 
 // DP constants - derived from ui layout values
 #define MAIN_ROW_COUNT 8  // Maximum rows to display (based on typical 480p screens with 28dp pills)
 
-pthread_mutex_t increment_item_list_index_lock = PTHREAD_MUTEX_INITIALIZER;
-volatile sig_atomic_t increment_item_list_index = 0;
+static pthread_mutex_t increment_item_list_index_lock = PTHREAD_MUTEX_INITIALIZER;
+static volatile sig_atomic_t increment_item_list_index = 0;
+
+// set from the daemon's control bytes to end the current presentation with that exit code
+static volatile sig_atomic_t stop_exit_code = 0;
 
 enum list_result_t
 {
@@ -53,7 +58,7 @@ enum list_result_t
 typedef int ExitCode;
 
 // log_error logs a message to stderr for debugging purposes
-void log_error(const char *msg)
+static void log_error(const char *msg)
 {
     // Set stderr to unbuffered mode
     setvbuf(stderr, NULL, _IONBF, 0);
@@ -61,7 +66,7 @@ void log_error(const char *msg)
 }
 
 // log_info logs a message to stdout for debugging purposes
-void log_info(const char *msg)
+static void log_info(const char *msg)
 {
     // Set stdout to unbuffered mode
     setvbuf(stdout, NULL, _IONBF, 0);
@@ -185,7 +190,7 @@ struct Message
     int width;
 };
 
-void strtrim(char *s)
+static void strtrim(char *s)
 {
     char *p = s;
     int l = strlen(p);
@@ -209,7 +214,7 @@ void strtrim(char *s)
     memmove(s, p, l + 1);
 }
 
-char *read_stdin()
+static char *read_stdin()
 {
     // Read all of stdin into a string
     char *stdin_contents = NULL;
@@ -249,10 +254,12 @@ char *read_stdin()
 }
 
 // hydrate_display_states hydrates the display states from a file or stdin
-struct ItemsState *ItemsState_New(const char *filename, const char *item_key, const char *default_background_image, const char *default_background_color, bool default_show_pill, enum MessageAlignment default_alignment)
+static struct ItemsState *ItemsState_New(const char *filename, const char *item_key, const char *default_background_image, const char *default_background_color, bool default_show_pill, enum MessageAlignment default_alignment)
 {
     struct ItemsState *state = malloc(sizeof(struct ItemsState));
 
+    // the items are copied out of the tree, so it is parsed into an arena and freed in one go
+    JSON_Arena *json_arena = json_arena_create(0);
     JSON_Value *root_value;
     if (strcmp(filename, "-") == 0)
     {
@@ -260,41 +267,43 @@ struct ItemsState *ItemsState_New(const char *filename, const char *item_key, co
         if (contents == NULL)
         {
             log_error("Failed to read stdin");
+            json_arena_free(json_arena);
             return NULL;
         }
 
-        root_value = json_parse_string_with_comments(contents);
+        root_value = json_parse_string_with_comments_arena(json_arena, contents);
         free(contents);
     }
     else
     {
-        root_value = json_parse_file_with_comments(filename);
+        root_value = json_parse_file_with_comments_arena(json_arena, filename);
     }
 
     if (root_value == NULL)
     {
         log_error("Failed to parse JSON file");
+        json_arena_free(json_arena);
         return NULL;
     }
 
     JSON_Object *root_object = json_value_get_object(root_value);
     if (root_object == NULL)
     {
-        json_value_free(root_value);
+        json_arena_free(json_arena);
         return NULL;
     }
 
     JSON_Array *items = json_object_get_array(root_object, item_key);
     if (items == NULL)
     {
-        json_value_free(root_value);
+        json_arena_free(json_arena);
         return NULL;
     }
 
     size_t item_count = json_array_get_count(items);
     if (item_count == 0)
     {
-        json_value_free(root_value);
+        json_arena_free(json_arena);
         return NULL;
     }
 
@@ -308,7 +317,7 @@ struct ItemsState *ItemsState_New(const char *filename, const char *item_key, co
             char buff[1024];
             snprintf(buff, sizeof(buff), "Failed to get item %zu", i);
             log_error(buff);
-            json_value_free(root_value);
+            json_arena_free(json_arena);
             return NULL;
         }
 
@@ -318,7 +327,7 @@ struct ItemsState *ItemsState_New(const char *filename, const char *item_key, co
             char buff[1024];
             snprintf(buff, sizeof(buff), "Failed to get text for item %zu", i);
             log_error(buff);
-            json_value_free(root_value);
+            json_arena_free(json_arena);
             return NULL;
         }
 
@@ -356,7 +365,7 @@ struct ItemsState *ItemsState_New(const char *filename, const char *item_key, co
                 char buff[1024];
                 snprintf(buff, sizeof(buff), "Invalid show_pill value provided for item %zu", i);
                 log_error(buff);
-                json_value_free(root_value);
+                json_arena_free(json_arena);
                 return NULL;
             }
         }
@@ -383,7 +392,7 @@ struct ItemsState *ItemsState_New(const char *filename, const char *item_key, co
             char buff[1024];
             snprintf(buff, sizeof(buff), "Invalid alignment provided for item %zu", i);
             log_error(buff);
-            json_value_free(root_value);
+            json_arena_free(json_arena);
             return NULL;
         }
     }
@@ -404,12 +413,30 @@ struct ItemsState *ItemsState_New(const char *filename, const char *item_key, co
         }
     }
 
-    json_value_free(root_value);
+    json_arena_free(json_arena);
     return state;
 }
 
+// ItemsState_Free frees a ItemsState and its items
+static void ItemsState_Free(struct ItemsState *state)
+{
+    if (state == NULL)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < state->item_count; i++)
+    {
+        free(state->items[i].text);
+        free(state->items[i].background_image);
+        free(state->items[i].background_color);
+    }
+    free(state->items);
+    free(state);
+}
+
 // handle_input interprets input events and mutates app state
-void handle_input(struct AppState *state)
+static void handle_input(struct AppState *state)
 {
     if (!state->items_state->items[state->items_state->selected].image_exists && state->items_state->items[state->items_state->selected].background_image != NULL)
     {
@@ -618,7 +645,7 @@ void handle_input(struct AppState *state)
 }
 
 // turns a hex color (e.g. #000000) into an SDL_Color
-SDL_Color hex_to_sdl_color(const char *hex)
+static SDL_Color hex_to_sdl_color(const char *hex)
 {
     SDL_Color color = {0, 0, 0, 255};
 
@@ -641,7 +668,7 @@ SDL_Color hex_to_sdl_color(const char *hex)
 }
 
 // scale_surface manually scales a surface to a new width and height for SDL1
-SDL_Surface *scale_surface(SDL_Surface *surface,
+static SDL_Surface *scale_surface(SDL_Surface *surface,
                            Uint16 width, Uint16 height)
 {
     SDL_Surface *scaled = SDL_CreateRGBSurface(surface->flags,
@@ -690,7 +717,7 @@ SDL_Surface *scale_surface(SDL_Surface *surface,
 }
 
 // draw_screen interprets the app state and draws it to the screen
-void draw_screen(SDL_Surface *screen, struct AppState *state)
+static void draw_screen(SDL_Surface *screen, struct AppState *state)
 {
     // render a background color
     char hex_color[1024] = "#000000";
@@ -1014,7 +1041,7 @@ void draw_screen(SDL_Surface *screen, struct AppState *state)
     state->redraw = 0;
 }
 
-bool open_fonts(struct AppState *state)
+static bool open_fonts(struct AppState *state)
 {
     if (state->fonts.font_path == NULL)
     {
@@ -1051,7 +1078,7 @@ bool open_fonts(struct AppState *state)
     return true;
 }
 
-void signal_handler(int signal)
+static void signal_handler(int signal)
 {
     // if the signal is a ctrl+c, exit with code 130
     if (signal == SIGINT)
@@ -1100,7 +1127,7 @@ void signal_handler(int signal)
 // - --show-pill (default: false)
 // - --show-time-left (default: false)
 // - --timeout <seconds> (default: 1)
-bool parse_arguments(struct AppState *state, int argc, char *argv[])
+static bool parse_arguments(struct AppState *state, int argc, char *argv[])
 {
     static struct option long_options[] = {
         {"action-button", required_argument, 0, 'a'},
@@ -1133,8 +1160,8 @@ bool parse_arguments(struct AppState *state, int argc, char *argv[])
 
     int opt;
     char *font_path = NULL;
-    char message[1024];
-    char alignment[1024];
+    char message[1024] = "";
+    char alignment[1024] = "";
     while ((opt = getopt_long(argc, argv, "a:A:b:B:c:C:d:D:E:f:F:i:I:K:m:M:t:QPSTUWYXZ", long_options, NULL)) != -1)
     {
         switch (opt)
@@ -1246,13 +1273,14 @@ bool parse_arguments(struct AppState *state, int argc, char *argv[])
         struct ItemsState *items_state = malloc(sizeof(struct ItemsState));
         items_state->items = malloc(sizeof(struct Item) * 1);
         items_state->items[0].text = strdup(message);
-        items_state->items[0].background_color = "#000000";
+        items_state->items[0].background_color = strdup("#000000");
         items_state->items[0].background_image = NULL;
         items_state->items[0].image_exists = false;
         items_state->items[0].show_pill = state->show_pill;
 
         if (strcmp(state->background_color, "") != 0)
         {
+            free(items_state->items[0].background_color);
             items_state->items[0].background_color = strdup(state->background_color);
         }
 
@@ -1502,7 +1530,7 @@ bool parse_arguments(struct AppState *state, int argc, char *argv[])
 
 // suppress_output suppresses stdout and stderr
 // returns a single integer containing both file descriptors
-int suppress_output(void)
+static int suppress_output(void)
 {
     int stdout_fd = dup(STDOUT_FILENO);
     int stderr_fd = dup(STDERR_FILENO);
@@ -1516,7 +1544,7 @@ int suppress_output(void)
 }
 
 // restore_output restores stdout and stderr to the original file descriptors
-void restore_output(int saved_fds)
+static void restore_output(int saved_fds)
 {
     int stdout_fd = (saved_fds >> 16) & 0xFFFF;
     int stderr_fd = saved_fds & 0xFFFF;
@@ -1535,7 +1563,7 @@ void restore_output(int saved_fds)
 // this is useful for suppressing output from a function
 // that we don't want to see in the log file
 // the InitSettings() function is an example of this (some implementations print to stdout)
-void swallow_stdout_from_function(void (*func)(void))
+static void swallow_stdout_from_function(void (*func)(void))
 {
     int saved_fds = suppress_output();
 
@@ -1547,7 +1575,7 @@ void swallow_stdout_from_function(void (*func)(void))
 // init initializes the app state
 // everything is placed here as MinUI sometimes logs to stdout
 // and the logging happens depending on the platform
-void init()
+static void init()
 {
     // set the cpu speed to the menu speed
     // this is done here to ensure we downclock
@@ -1569,7 +1597,7 @@ void init()
 }
 
 // destruct cleans up the app state in reverse order
-void destruct()
+static void destruct()
 {
     QuitSettings();
     PWR_quit();
@@ -1577,24 +1605,10 @@ void destruct()
     GFX_quit();
 }
 
-// main is the entry point for the app
-int main(int argc, char *argv[])
+// AppState_init resets the app state to the defaults used before parsing arguments
+static void AppState_init(struct AppState *state)
 {
-    // Initialize app state
-    char default_action_button[1024] = "";
-    char default_action_text[1024] = "ACTION";
-    char default_background_image[1024] = "";
-    char default_background_color[1024] = "#000000";
-    char default_cancel_button[1024] = "B";
-    char default_cancel_text[1024] = "BACK";
-    char default_confirm_button[1024] = "A";
-    char default_confirm_text[1024] = "SELECT";
-    char default_inaction_button[1024] = "";
-    char default_inaction_text[1024] = "OTHER";
-    char default_file[1024] = "";
-    char default_item_key[1024] = "items";
-    char default_message[1024] = "";
-    struct AppState state = {
+    *state = (struct AppState){
         .redraw = 1,
         .quitting = 0,
         .exit_code = ExitCodeSuccess,
@@ -1618,55 +1632,75 @@ int main(int argc, char *argv[])
         .show_pill = false,
     };
 
-    // assign the default values to the app state
-    strncpy(state.action_button, default_action_button, sizeof(state.action_button));
-    strncpy(state.action_text, default_action_text, sizeof(state.action_text));
-    strncpy(state.background_image, default_background_image, sizeof(state.background_image));
-    strncpy(state.background_color, default_background_color, sizeof(state.background_color));
-    strncpy(state.cancel_button, default_cancel_button, sizeof(state.cancel_button));
-    strncpy(state.cancel_text, default_cancel_text, sizeof(state.cancel_text));
-    strncpy(state.confirm_button, default_confirm_button, sizeof(state.confirm_button));
-    strncpy(state.confirm_text, default_confirm_text, sizeof(state.confirm_text));
-    strncpy(state.inaction_button, default_inaction_button, sizeof(state.inaction_button));
-    strncpy(state.inaction_text, default_inaction_text, sizeof(state.inaction_text));
-    strncpy(state.file, default_file, sizeof(state.file));
-    strncpy(state.item_key, default_item_key, sizeof(state.item_key));
+    strncpy(state->action_button, "", sizeof(state->action_button));
+    strncpy(state->action_text, "ACTION", sizeof(state->action_text));
+    strncpy(state->background_image, "", sizeof(state->background_image));
+    strncpy(state->background_color, "#000000", sizeof(state->background_color));
+    strncpy(state->cancel_button, "B", sizeof(state->cancel_button));
+    strncpy(state->cancel_text, "BACK", sizeof(state->cancel_text));
+    strncpy(state->confirm_button, "A", sizeof(state->confirm_button));
+    strncpy(state->confirm_text, "SELECT", sizeof(state->confirm_text));
+    strncpy(state->inaction_button, "", sizeof(state->inaction_button));
+    strncpy(state->inaction_text, "OTHER", sizeof(state->inaction_text));
+    strncpy(state->file, "", sizeof(state->file));
+    strncpy(state->item_key, "items", sizeof(state->item_key));
+}
 
-    // parse the arguments
-    if (!parse_arguments(&state, argc, argv))
+// AppState_free frees what parse_arguments allocated
+// the fonts are left open, as the daemon reuses them between presentations
+static void AppState_free(struct AppState *state)
+{
+    ItemsState_Free(state->items_state);
+    state->items_state = NULL;
+    free(state->fonts.font_path);
+    state->fonts.font_path = NULL;
+}
+
+// read_client_control applies the control bytes a waiting client forwarded
+// a closed connection means the client is gone, so the presentation ends
+static void read_client_control(struct AppState *state, int client_fd)
+{
+    int control;
+    while ((control = daemon_read_control(client_fd)) > 0)
     {
-        return ExitCodeError;
+        if (control == DAEMON_CONTROL_NEXT)
+        {
+            increment_item_list_index = 1;
+        }
+        else if (control == DAEMON_CONTROL_INTERRUPT)
+        {
+            stop_exit_code = ExitCodeKeyboardInterrupt;
+        }
+        else if (control == DAEMON_CONTROL_TERMINATE)
+        {
+            stop_exit_code = ExitCodeSigterm;
+        }
     }
 
-    swallow_stdout_from_function(init);
-
-    struct sigaction sa = {
-        .sa_handler = signal_handler,
-        .sa_flags = SA_RESTART};
-    sigemptyset(&sa.sa_mask);
-    sigaction(SIGINT, &sa, NULL);
-    sigaction(SIGTERM, &sa, NULL);
-    sigaction(SIGUSR1, &sa, NULL);
-
-    if (!open_fonts(&state))
+    if (control < 0)
     {
-        return ExitCodeError;
+        stop_exit_code = ExitCodeSigterm;
     }
+}
 
+// present shows the parsed app state until a button, timeout or signal ends it
+// client_fd is the daemon client to take control bytes from, or -1
+static int present(struct AppState *state, int client_fd)
+{
     // get initial wifi state
     int was_online = PLAT_isOnline();
 
     // get the current time
-    gettimeofday(&state.start_time, NULL);
+    gettimeofday(&state->start_time, NULL);
 
     int show_setting = 0; // 1=brightness,2=volume
 
-    if (state.timeout_seconds <= 0 || state.disable_auto_sleep)
+    if (state->timeout_seconds <= 0 || state->disable_auto_sleep)
     {
         PWR_disableAutosleep();
     }
 
-    while (!state.quitting)
+    while (!state->quitting)
     {
         // start the frame to ensure GFX_sync() works
         // on devices that don't support vsync
@@ -1674,7 +1708,7 @@ int main(int argc, char *argv[])
 
         // handle turning the on/off screen on/off
         // as well as general power management
-        PWR_update(&state.redraw, &show_setting, NULL, NULL);
+        PWR_update(&state->redraw, &show_setting, NULL, NULL);
 
         // check if the device is on wifi
         // redraw if the wifi state changed
@@ -1682,20 +1716,32 @@ int main(int argc, char *argv[])
         int is_online = PLAT_isOnline();
         if (was_online != is_online)
         {
-            state.redraw = 1;
+            state->redraw = 1;
         }
         was_online = is_online;
 
         // handle any input events
-        handle_input(&state);
+        if (client_fd >= 0)
+        {
+            read_client_control(state, client_fd);
+        }
+        handle_input(state);
+
+        // a signal or the daemon client asked to stop
+        if (stop_exit_code)
+        {
+            state->exit_code = stop_exit_code;
+            state->quitting = 1;
+            break;
+        }
 
         // redraw the screen if there has been a change
-        if (state.redraw)
+        if (state->redraw)
         {
             // clear the screen at the beginning of each loop
             GFX_clear(screen);
 
-            if (state.show_hardware_group)
+            if (state->show_hardware_group)
             {
                 // draw the hardware information in the top-right
                 GFX_blitHardwareGroup(screen, show_setting);
@@ -1711,7 +1757,7 @@ int main(int argc, char *argv[])
             }
 
             // your draw logic goes here
-            draw_screen(screen, &state);
+            draw_screen(screen, state);
 
             // Takes the screen buffer and displays it on the screen
             GFX_flip(screen);
@@ -1724,25 +1770,158 @@ int main(int argc, char *argv[])
         }
 
         // if the sleep seconds is larger than 0, check if the sleep has expired
-        if (state.timeout_seconds > 0)
+        if (state->timeout_seconds > 0)
         {
             struct timeval current_time;
             gettimeofday(&current_time, NULL);
-            if (current_time.tv_sec - state.start_time.tv_sec >= state.timeout_seconds)
+            if (current_time.tv_sec - state->start_time.tv_sec >= state->timeout_seconds)
             {
-                state.exit_code = ExitCodeTimeout;
-                state.quitting = 1;
+                state->exit_code = ExitCodeTimeout;
+                state->quitting = 1;
             }
 
-            if (current_time.tv_sec != state.start_time.tv_sec && state.show_time_left)
+            if (current_time.tv_sec != state->start_time.tv_sec && state->show_time_left)
             {
-                state.redraw = 1;
+                state->redraw = 1;
             }
         }
     }
 
+    return state->exit_code;
+}
+
+// the fonts the daemon opened for the previous presentation
+static struct Fonts daemon_fonts;
+
+// daemon_open_fonts opens the fonts for a presentation, reusing the daemon's
+// open fonts when the path and size match the previous presentation
+static bool daemon_open_fonts(struct AppState *state, struct Fonts *fonts)
+{
+    if (fonts->large != NULL && fonts->size == state->fonts.size && strcmp(fonts->font_path, state->fonts.font_path) == 0)
+    {
+        state->fonts.large = fonts->large;
+        state->fonts.small = fonts->small;
+        return true;
+    }
+
+    if (fonts->large != NULL)
+    {
+        TTF_CloseFont(fonts->large);
+    }
+    if (fonts->small != NULL)
+    {
+        TTF_CloseFont(fonts->small);
+    }
+    free(fonts->font_path);
+    memset(fonts, 0, sizeof(*fonts));
+
+    if (!open_fonts(state))
+    {
+        if (state->fonts.large != NULL)
+        {
+            TTF_CloseFont(state->fonts.large);
+        }
+        return false;
+    }
+
+    fonts->size = state->fonts.size;
+    fonts->large = state->fonts.large;
+    fonts->small = state->fonts.small;
+    fonts->font_path = strdup(state->fonts.font_path);
+    return true;
+}
+
+// minui_presenter_serve presents one request on minui-daemon, see daemon/daemon.h
+// the fonts stay open for the next presentation that uses the same ones
+int minui_presenter_serve(SDL_Surface *display, int client_fd, JSON_Object *request)
+{
+    int argc;
+    char **argv = daemon_request_argv(request, "minui-presenter", &argc);
+    if (argv == NULL)
+    {
+        return ExitCodeError;
+    }
+
+    screen = display;
+    struct AppState state;
+    AppState_init(&state);
+    stop_exit_code = 0;
+    increment_item_list_index = 0;
+
+    int exit_code = ExitCodeError;
+    if (parse_arguments(&state, argc, argv) && daemon_open_fonts(&state, &daemon_fonts))
+    {
+        exit_code = present(&state, client_fd);
+    }
+    AppState_free(&state);
+    free(argv);
+    return exit_code;
+}
+
+// minui_presenter_quit closes the fonts kept open between presentations
+void minui_presenter_quit(void)
+{
+    if (daemon_fonts.large != NULL)
+    {
+        TTF_CloseFont(daemon_fonts.large);
+    }
+    if (daemon_fonts.small != NULL)
+    {
+        TTF_CloseFont(daemon_fonts.small);
+    }
+    free(daemon_fonts.font_path);
+    memset(&daemon_fonts, 0, sizeof(daemon_fonts));
+}
+
+#ifndef MINUI_DAEMON
+// main is the entry point for the app
+int main(int argc, char *argv[])
+{
+    // let a running minui-daemon present this instead of starting up
+    const char *path = daemon_socket_path(DAEMON_SOCKET_ENV, DAEMON_SOCKET_PATH);
+    JSON_Value *request_value = daemon_request_arguments("minui-presenter", argc, argv);
+    if (request_value != NULL)
+    {
+        int exit_code;
+        bool forwarded = daemon_forward(path, request_value, &exit_code);
+        json_value_free(request_value);
+        if (forwarded)
+        {
+            return exit_code;
+        }
+    }
+
+    // Initialize app state
+    struct AppState state;
+    AppState_init(&state);
+
+    // parse the arguments
+    if (!parse_arguments(&state, argc, argv))
+    {
+        return ExitCodeError;
+    }
+
+    swallow_stdout_from_function(init);
+
+    struct sigaction sa = {
+        .sa_handler = signal_handler,
+        .sa_flags = SA_RESTART};
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGUSR1, &sa, NULL);
+
+    if (!open_fonts(&state))
+    {
+        return ExitCodeError;
+    }
+
+    present(&state, -1);
+
     swallow_stdout_from_function(destruct);
 
     // exit the program
     return state.exit_code;
 }
+
+#endif
@@ -0,0 +1,167 @@
+/*
+ Benchmarks parse-and-free of a large item list with the heap allocator and with an arena.
+
+ Builds a ~1 MB minui-list style document in memory, parses and frees it repeatedly in both
+ modes, and prints the best time and the peak memory held through parson's allocator: the bytes
+ parson asked for, and the bytes malloc handed out including its per-allocation overhead.
+ Build and run with `make bench` (needs malloc_usable_size, so glibc or musl).
+*/
+#define _POSIX_C_SOURCE 199309L
+
+#include "parson.h"
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_DOCUMENT_SIZE (1024 * 1024)
+#define BENCH_RUNS 20
+
+/* allocations carry their size in front so the peak can be tracked */
+typedef union bench_header {
+    size_t size;
+    double align_double;
+    void  *align_pointer;
+} bench_header_t;
+
+typedef struct bench_usage {
+    size_t requested;
+    size_t allocated;
+} bench_usage_t;
+
+static bench_usage_t g_current;
+static bench_usage_t g_peak;
+
+/* what malloc really spends on an allocation of size bytes: its usable size plus a size word */
+static size_t allocated_size(size_t size) {
+    void *probe = malloc(size);
+    size_t allocated = malloc_usable_size(probe) + sizeof(size_t);
+    free(probe);
+    return allocated;
+}
+
+static void *bench_malloc(size_t size) {
+    bench_header_t *header = (bench_header_t*)malloc(sizeof(bench_header_t) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->size = size;
+    g_current.requested += size;
+    g_current.allocated += allocated_size(size);
+    if (g_current.allocated > g_peak.allocated) {
+        g_peak = g_current;
+    }
+    return header + 1;
+}
+
+static void bench_free(void *ptr) {
+    bench_header_t *header = NULL;
+    if (ptr == NULL) {
+        return;
+    }
+    header = (bench_header_t*)ptr - 1;
+    g_current.requested -= header->size;
+    g_current.allocated -= allocated_size(header->size);
+    free(header);
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* an item list like the ones paks pipe into minui-list */
+static char * build_document(size_t target_size, size_t *item_count) {
+    size_t capacity = target_size + 1024;
+    size_t length = 0;
+    size_t i = 0;
+    char *document = (char*)malloc(capacity);
+    if (document == NULL) {
+        return NULL;
+    }
+    length += sprintf(document, "{\"items\": [");
+    while (length < target_size) {
+        length += sprintf(document + length,
+            "%s{\"name\": \"Game Title Number %lu\", \"options\": [\"On\", \"Off\"], \"selected\": %lu, "
+            "\"features\": {\"background_image\": \"/mnt/SDCARD/Roms/.media/%lu.png\", \"is_header\": false}}",
+            i > 0 ? ", " : "", (unsigned long)i, (unsigned long)(i % 2), (unsigned long)i);
+        i++;
+    }
+    length += sprintf(document + length, "]}");
+    *item_count = i;
+    return document;
+}
+
+static JSON_Value * parse(JSON_Arena **arena, const char *document, int use_arena) {
+    JSON_Value *value = NULL;
+    if (use_arena) {
+        *arena = json_arena_create(0);
+        value = json_parse_string_arena(*arena, document);
+    } else {
+        value = json_parse_string(document);
+    }
+    if (value == NULL) {
+        printf("parse failed\n");
+        exit(1);
+    }
+    return value;
+}
+
+static void release(JSON_Arena *arena, JSON_Value *value) {
+    if (arena) {
+        json_arena_free(arena);
+    } else {
+        json_value_free(value);
+    }
+}
+
+/* times with plain malloc, then measures memory in a separate pass with the counting allocator */
+static void run(const char *name, const char *document, int use_arena) {
+    JSON_Arena *arena = NULL;
+    JSON_Value *value = NULL;
+    double best_ms = 0;
+    double start = 0;
+    double elapsed = 0;
+    int run = 0;
+
+    json_set_allocation_functions(malloc, free);
+    for (run = 0; run < BENCH_RUNS; run++) {
+        arena = NULL;
+        start = now_ms();
+        value = parse(&arena, document, use_arena);
+        release(arena, value);
+        elapsed = now_ms() - start;
+        if (run == 0 || elapsed < best_ms) {
+            best_ms = elapsed;
+        }
+    }
+
+    json_set_allocation_functions(bench_malloc, bench_free);
+    memset(&g_current, 0, sizeof(g_current));
+    memset(&g_peak, 0, sizeof(g_peak));
+    arena = NULL;
+    value = parse(&arena, document, use_arena);
+    release(arena, value);
+
+    printf("%-8s %10.2f ms %10.1f KiB %10.1f KiB\n", name, best_ms,
+           g_peak.requested / 1024.0, g_peak.allocated / 1024.0);
+}
+
+int main(void) {
+    size_t item_count = 0;
+    char *document = build_document(BENCH_DOCUMENT_SIZE, &item_count);
+    if (document == NULL) {
+        return 1;
+    }
+    printf("parse and free, %lu bytes, %lu items, best of %d\n",
+           (unsigned long)strlen(document), (unsigned long)item_count, BENCH_RUNS);
+    printf("%-8s %13s %14s %14s\n", "mode", "time", "peak requested", "peak allocated");
+    run("heap", document, 0);
+    run("arena", document, 1);
+
+    free(document);
+    return 0;
+}
@@ -64,6 +64,13 @@
 #define STARTING_CAPACITY 16
 #define MAX_NESTING       2048
 
+/* objects with up to this many members are searched linearly instead of through a hash index */
+#define OBJECT_LINEAR_CAPACITY 8
+
+#ifndef PARSON_ARENA_BLOCK_SIZE
+#define PARSON_ARENA_BLOCK_SIZE (64 * 1024) /* default size of the blocks an arena allocates */
+#endif
+
 #ifndef PARSON_DEFAULT_FLOAT_FORMAT
 #define PARSON_DEFAULT_FLOAT_FORMAT "%1.17g" /* do not increase precision without incresing NUM_BUF_SIZE */
 #endif
@@ -92,8 +99,11 @@
 
 #define OBJECT_INVALID_IX ((size_t)-1)
 
-static JSON_Malloc_Function parson_malloc = malloc;
-static JSON_Free_Function parson_free = free;
+static JSON_Malloc_Function parson_malloc_function = malloc;
+static JSON_Free_Function parson_free_function = free;
+
+/* arena the parser is currently allocating from, if any (see json_parse_string_arena) */
+static JSON_Arena *parson_arena = NULL;
 
 static int parson_escape_slashes = 1;
 
@@ -148,6 +158,33 @@ struct json_array_t {
     size_t       capacity;
 };
 
+/* every allocation from an arena is aligned like this union */
+typedef union json_arena_align {
+    double  number;
+    void   *pointer;
+    size_t  size;
+} JSON_Arena_Align;
+
+#define ARENA_ALIGN(n) (((n) + sizeof(JSON_Arena_Align) - 1) & ~(sizeof(JSON_Arena_Align) - 1))
+
+typedef struct json_arena_block {
+    struct json_arena_block *next;
+    size_t used;
+    size_t capacity;
+} JSON_Arena_Block;
+
+#define ARENA_BLOCK_HEADER_SIZE ARENA_ALIGN(sizeof(JSON_Arena_Block))
+
+struct json_arena_t {
+    JSON_Arena_Block *blocks; /* the first block is the one being filled */
+    size_t block_size;
+};
+
+/* Allocation */
+static void * parson_malloc(size_t size);
+static void   parson_free(void *ptr);
+static void * arena_alloc(JSON_Arena *arena, size_t size);
+
 /* Various */
 static char * read_file(const char *filename);
 static void   remove_comments(char *string, const char *start_token, const char *end_token);
@@ -165,10 +202,12 @@ static unsigned long hash_string(const char *string, size_t n);
 
 /* JSON Object */
 static JSON_Object * json_object_make(JSON_Value *wrapping_value);
-static JSON_Status   json_object_init(JSON_Object *object, size_t capacity);
+static JSON_Status   json_object_init(JSON_Object *object, size_t item_capacity, size_t cell_capacity);
 static void          json_object_deinit(JSON_Object *object, parson_bool_t free_keys, parson_bool_t free_values);
 static JSON_Status   json_object_grow_and_rehash(JSON_Object *object);
 static size_t        json_object_get_cell_ix(const JSON_Object *object, const char *key, size_t key_len, unsigned long hash, parson_bool_t *out_found);
+static size_t        json_object_get_item_ix(const JSON_Object *object, const char *key, size_t key_len, unsigned long hash);
+static void          json_object_insert(JSON_Object *object, char *name, JSON_Value *value, unsigned long hash);
 static JSON_Status   json_object_add(JSON_Object *object, char *name, JSON_Value *value);
 static JSON_Value  * json_object_getn_value(const JSON_Object *object, const char *name, size_t name_len);
 static JSON_Status   json_object_remove_internal(JSON_Object *object, const char *name, parson_bool_t free_value);
@@ -197,12 +236,66 @@ static JSON_Value *  parse_boolean_value(const char **string);
 static JSON_Value *  parse_number_value(const char **string);
 static JSON_Value *  parse_null_value(const char **string);
 static JSON_Value *  parse_value(const char **string, size_t nesting);
+static JSON_Value *  parse_root(JSON_Arena *arena, const char *string);
+static JSON_Value *  parse_string_with_comments(JSON_Arena *arena, const char *string);
+static JSON_Value *  parse_file(JSON_Arena *arena, const char *filename, parson_bool_t with_comments);
 
 /* Serialization */
 static int json_serialize_to_buffer_r(const JSON_Value *value, char *buf, int level, parson_bool_t is_pretty, char *num_buf);
 static int json_serialize_string(const char *string, size_t len, char *buf);
 
 /* Various */
+/* Allocation */
+static void * parson_malloc(size_t size) {
+    if (parson_arena) {
+        return arena_alloc(parson_arena, size);
+    }
+    return parson_malloc_function(size);
+}
+
+static void parson_free(void *ptr) {
+    if (parson_arena) {
+        return; /* released with the whole arena */
+    }
+    parson_free_function(ptr);
+}
+
+static void * arena_alloc(JSON_Arena *arena, size_t size) {
+    JSON_Arena_Block *block = arena->blocks;
+    void *ptr = NULL;
+    size = ARENA_ALIGN(size);
+    if (block == NULL || block->capacity - block->used < size) {
+        if (size > arena->block_size / 4) {
+            /* large allocations get a block of their own so the current block keeps its free space */
+            block = (JSON_Arena_Block*)parson_malloc_function(ARENA_BLOCK_HEADER_SIZE + size);
+            if (block == NULL) {
+                return NULL;
+            }
+            block->capacity = size;
+            block->used = size;
+            if (arena->blocks) {
+                block->next = arena->blocks->next;
+                arena->blocks->next = block;
+            } else {
+                block->next = NULL;
+                arena->blocks = block;
+            }
+            return (char*)block + ARENA_BLOCK_HEADER_SIZE;
+        }
+        block = (JSON_Arena_Block*)parson_malloc_function(ARENA_BLOCK_HEADER_SIZE + arena->block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->capacity = arena->block_size;
+        block->used = 0;
+        block->next = arena->blocks;
+        arena->blocks = block;
+    }
+    ptr = (char*)block + ARENA_BLOCK_HEADER_SIZE + block->used;
+    block->used += size;
+    return ptr;
+}
+
 static char * read_file(const char * filename) {
     FILE *fp = fopen(filename, "r");
     size_t size_to_read = 0;
@@ -444,7 +537,7 @@ static JSON_Object * json_object_make(JSON_Value *wrapping_value) {
         return NULL;
     }
     new_obj->wrapping_value = wrapping_value;
-    res = json_object_init(new_obj, 0);
+    res = json_object_init(new_obj, 0, 0);
     if (res != JSONSuccess) {
         parson_free(new_obj);
         return NULL;
@@ -452,7 +545,8 @@ static JSON_Object * json_object_make(JSON_Value *wrapping_value) {
     return new_obj;
 }
 
-static JSON_Status json_object_init(JSON_Object *object, size_t capacity) {
+/* cell_capacity 0 makes an object without a hash index, searched linearly */
+static JSON_Status json_object_init(JSON_Object *object, size_t item_capacity, size_t cell_capacity) {
     unsigned int i = 0;
 
     object->cells = NULL;
@@ -462,25 +556,31 @@ static JSON_Status json_object_init(JSON_Object *object, size_t capacity) {
     object->hashes = NULL;
 
     object->count = 0;
-    object->cell_capacity = capacity;
-    object->item_capacity = (unsigned int)(capacity * 7/10);
+    object->cell_capacity = cell_capacity;
+    object->item_capacity = item_capacity;
 
-    if (capacity == 0) {
+    if (item_capacity == 0) {
         return JSONSuccess;
     }
 
-    object->cells = (size_t*)parson_malloc(object->cell_capacity * sizeof(*object->cells));
     object->names = (char**)parson_malloc(object->item_capacity * sizeof(*object->names));
     object->values = (JSON_Value**)parson_malloc(object->item_capacity * sizeof(*object->values));
-    object->cell_ixs = (size_t*)parson_malloc(object->item_capacity * sizeof(*object->cell_ixs));
     object->hashes = (unsigned long*)parson_malloc(object->item_capacity * sizeof(*object->hashes));
-    if (object->cells == NULL
-        || object->names == NULL
+    if (object->names == NULL
         || object->values == NULL
-        || object->cell_ixs == NULL
         || object->hashes == NULL) {
         goto error;
     }
+    if (cell_capacity == 0) {
+        return JSONSuccess;
+    }
+
+    object->cells = (size_t*)parson_malloc(object->cell_capacity * sizeof(*object->cells));
+    object->cell_ixs = (size_t*)parson_malloc(object->item_capacity * sizeof(*object->cell_ixs));
+    if (object->cells == NULL
+        || object->cell_ixs == NULL) {
+        goto error;
+    }
     for (i = 0; i < object->cell_capacity; i++) {
         object->cells[i] = OBJECT_INVALID_IX;
     }
@@ -528,8 +628,14 @@ static JSON_Status json_object_grow_and_rehash(JSON_Object *object) {
     char *key = NULL;
     JSON_Value *value = NULL;
     unsigned int i = 0;
-    size_t new_capacity = MAX(object->cell_capacity * 2, STARTING_CAPACITY);
-    JSON_Status res = json_object_init(&new_object, new_capacity);
+    size_t new_cell_capacity = 0;
+    size_t new_item_capacity = OBJECT_LINEAR_CAPACITY;
+    JSON_Status res = JSONFailure;
+    if (object->item_capacity >= OBJECT_LINEAR_CAPACITY) {
+        new_cell_capacity = MAX(object->cell_capacity * 2, STARTING_CAPACITY);
+        new_item_capacity = new_cell_capacity * 7/10;
+    }
+    res = json_object_init(&new_object, new_item_capacity, new_cell_capacity);
     if (res != JSONSuccess) {
         return JSONFailure;
     }
@@ -583,10 +689,45 @@ static size_t json_object_get_cell_ix(const JSON_Object *object, const char *key
     return OBJECT_INVALID_IX;
 }
 
-static JSON_Status json_object_add(JSON_Object *object, char *name, JSON_Value *value) {
-    unsigned long hash = 0;
+static size_t json_object_get_item_ix(const JSON_Object *object, const char *key, size_t key_len, unsigned long hash) {
+    parson_bool_t found = PARSON_FALSE;
+    size_t cell_ix = 0;
+    size_t i = 0;
+    if (object->cell_capacity == 0) {
+        for (i = 0; i < object->count; i++) {
+            if (object->hashes[i] == hash
+                && strlen(object->names[i]) == key_len
+                && strncmp(key, object->names[i], key_len) == 0) {
+                return i;
+            }
+        }
+        return OBJECT_INVALID_IX;
+    }
+    cell_ix = json_object_get_cell_ix(object, key, key_len, hash, &found);
+    if (!found) {
+        return OBJECT_INVALID_IX;
+    }
+    return object->cells[cell_ix];
+}
+
+/* adds a member that isn't in the object yet, which must have room for it */
+static void json_object_insert(JSON_Object *object, char *name, JSON_Value *value, unsigned long hash) {
     parson_bool_t found = PARSON_FALSE;
     size_t cell_ix = 0;
+    if (object->cell_capacity > 0) {
+        cell_ix = json_object_get_cell_ix(object, name, strlen(name), hash, &found);
+        object->cells[cell_ix] = object->count;
+        object->cell_ixs[object->count] = cell_ix;
+    }
+    object->names[object->count] = name;
+    object->values[object->count] = value;
+    object->hashes[object->count] = hash;
+    object->count++;
+    value->parent = json_object_get_wrapping_value(object);
+}
+
+static JSON_Status json_object_add(JSON_Object *object, char *name, JSON_Value *value) {
+    unsigned long hash = 0;
     JSON_Status res = JSONFailure;
 
     if (!object || !name || !value) {
@@ -594,9 +735,7 @@ static JSON_Status json_object_add(JSON_Object *object, char *name, JSON_Value *
     }
 
     hash = hash_string(name, strlen(name));
-    found = PARSON_FALSE;
-    cell_ix = json_object_get_cell_ix(object, name, strlen(name), hash, &found);
-    if (found) {
+    if (json_object_get_item_ix(object, name, strlen(name), hash) != OBJECT_INVALID_IX) {
         return JSONFailure;
     }
 
@@ -605,41 +744,25 @@ static JSON_Status json_object_add(JSON_Object *object, char *name, JSON_Value *
         if (res != JSONSuccess) {
             return JSONFailure;
         }
-        cell_ix = json_object_get_cell_ix(object, name, strlen(name), hash, &found);
     }
 
-    object->names[object->count] = name;
-    object->cells[cell_ix] = object->count;
-    object->values[object->count] = value;
-    object->cell_ixs[object->count] = cell_ix;
-    object->hashes[object->count] = hash;
-    object->count++;
-    value->parent = json_object_get_wrapping_value(object);
-
+    json_object_insert(object, name, value, hash);
     return JSONSuccess;
 }
 
 static JSON_Value * json_object_getn_value(const JSON_Object *object, const char *name, size_t name_len) {
-    unsigned long hash = 0;
-    parson_bool_t found = PARSON_FALSE;
-    size_t cell_ix = 0;
     size_t item_ix = 0;
     if (!object || !name) {
         return NULL;
     }
-    hash = hash_string(name, name_len);
-    found = PARSON_FALSE;
-    cell_ix = json_object_get_cell_ix(object, name, name_len, hash, &found);
-    if (!found) {
+    item_ix = json_object_get_item_ix(object, name, name_len, hash_string(name, name_len));
+    if (item_ix == OBJECT_INVALID_IX) {
         return NULL;
     }
-    item_ix = object->cells[cell_ix];
     return object->values[item_ix];
 }
 
 static JSON_Status json_object_remove_internal(JSON_Object *object, const char *name, parson_bool_t free_value) {
-    unsigned long hash = 0;
-    parson_bool_t found = PARSON_FALSE;
     size_t cell = 0;
     size_t item_ix = 0;
     size_t last_item_ix = 0;
@@ -653,14 +776,11 @@ static JSON_Status json_object_remove_internal(JSON_Object *object, const char *
         return JSONFailure;
     }
 
-    hash = hash_string(name, strlen(name));
-    found = PARSON_FALSE;
-    cell = json_object_get_cell_ix(object, name, strlen(name), hash, &found);
-    if (!found) {
+    item_ix = json_object_get_item_ix(object, name, strlen(name), hash_string(name, strlen(name)));
+    if (item_ix == OBJECT_INVALID_IX) {
         return JSONFailure;
     }
 
-    item_ix = object->cells[cell];
     if (free_value) {
         val = object->values[item_ix];
         json_value_free(val);
@@ -669,6 +789,15 @@ static JSON_Status json_object_remove_internal(JSON_Object *object, const char *
 
     parson_free(object->names[item_ix]);
     last_item_ix = object->count - 1;
+    if (object->cell_capacity == 0) {
+        object->names[item_ix] = object->names[last_item_ix];
+        object->values[item_ix] = object->values[last_item_ix];
+        object->hashes[item_ix] = object->hashes[last_item_ix];
+        object->count--;
+        return JSONSuccess;
+    }
+
+    cell = object->cell_ixs[item_ix];
     if (item_ix < last_item_ix) {
         object->names[item_ix] = object->names[last_item_ix];
         object->values[item_ix] = object->values[last_item_ix];
@@ -894,7 +1023,10 @@ static char* process_string(const char *input, size_t input_len, size_t *output_
     *output_ptr = '\0';
     /* resize to new length */
     final_size = (size_t)(output_ptr-output) + 1;
-    /* todo: don't resize if final_size == initial_size */
+    *output_len = final_size - 1;
+    if (final_size == initial_size) {
+        return output; /* nothing was unescaped, so the buffer is already the right size */
+    }
     resized_output = (char*)parson_malloc(final_size);
     if (resized_output == NULL) {
         goto error;
@@ -1059,8 +1191,8 @@ static JSON_Value * parse_array_value(const char **string, size_t nesting) {
         }
     }
     SKIP_WHITESPACES(string);
-    if (**string != ']' || /* Trim array after parsing is over */
-        json_array_resize(output_array, json_array_get_count(output_array)) != JSONSuccess) {
+    if (**string != ']' || /* Trim array after parsing is over, which an arena can't reclaim */
+        (!parson_arena && json_array_resize(output_array, json_array_get_count(output_array)) != JSONSuccess)) {
             json_value_free(output_value);
             return NULL;
     }
@@ -1358,51 +1490,129 @@ static int json_serialize_string(const char *string, size_t len, char *buf) {
 #undef APPEND_INDENT
 
 /* Parser API */
-JSON_Value * json_parse_file(const char *filename) {
-    char *file_contents = read_file(filename);
-    JSON_Value *output_value = NULL;
-    if (file_contents == NULL) {
+
+/* parses into arena if it isn't NULL; only the values come from the arena, not the input */
+static JSON_Value * parse_root(JSON_Arena *arena, const char *string) {
+    JSON_Value *result = NULL;
+    if (string == NULL) {
         return NULL;
     }
-    output_value = json_parse_string(file_contents);
-    parson_free(file_contents);
-    return output_value;
+    if (string[0] == '\xEF' && string[1] == '\xBB' && string[2] == '\xBF') {
+        string = string + 3; /* Support for UTF-8 BOM */
+    }
+    parson_arena = arena;
+    result = parse_value((const char**)&string, 0);
+    parson_arena = NULL;
+    return result;
 }
 
-JSON_Value * json_parse_file_with_comments(const char *filename) {
+static JSON_Value * parse_string_with_comments(JSON_Arena *arena, const char *string) {
+    JSON_Value *result = NULL;
+    char *string_mutable_copy = NULL;
+    string_mutable_copy = parson_strdup(string);
+    if (string_mutable_copy == NULL) {
+        return NULL;
+    }
+    remove_comments(string_mutable_copy, "/*", "*/");
+    remove_comments(string_mutable_copy, "//", "\n");
+    result = parse_root(arena, string_mutable_copy);
+    parson_free(string_mutable_copy);
+    return result;
+}
+
+static JSON_Value * parse_file(JSON_Arena *arena, const char *filename, parson_bool_t with_comments) {
     char *file_contents = read_file(filename);
     JSON_Value *output_value = NULL;
     if (file_contents == NULL) {
         return NULL;
     }
-    output_value = json_parse_string_with_comments(file_contents);
+    if (with_comments) {
+        output_value = parse_string_with_comments(arena, file_contents);
+    } else {
+        output_value = parse_root(arena, file_contents);
+    }
     parson_free(file_contents);
     return output_value;
 }
 
+JSON_Value * json_parse_file(const char *filename) {
+    return parse_file(NULL, filename, PARSON_FALSE);
+}
+
+JSON_Value * json_parse_file_with_comments(const char *filename) {
+    return parse_file(NULL, filename, PARSON_TRUE);
+}
+
 JSON_Value * json_parse_string(const char *string) {
-    if (string == NULL) {
+    return parse_root(NULL, string);
+}
+
+JSON_Value * json_parse_string_with_comments(const char *string) {
+    return parse_string_with_comments(NULL, string);
+}
+
+/* Arena API */
+JSON_Arena * json_arena_create(size_t block_size) {
+    JSON_Arena *arena = (JSON_Arena*)parson_malloc_function(sizeof(JSON_Arena));
+    if (arena == NULL) {
         return NULL;
     }
-    if (string[0] == '\xEF' && string[1] == '\xBB' && string[2] == '\xBF') {
-        string = string + 3; /* Support for UTF-8 BOM */
+    arena->blocks = NULL;
+    arena->block_size = block_size > 0 ? ARENA_ALIGN(block_size) : PARSON_ARENA_BLOCK_SIZE;
+    return arena;
+}
+
+void json_arena_free(JSON_Arena *arena) {
+    JSON_Arena_Block *block = NULL;
+    if (arena == NULL) {
+        return;
+    }
+    while (arena->blocks) {
+        block = arena->blocks;
+        arena->blocks = block->next;
+        parson_free_function(block);
     }
-    return parse_value((const char**)&string, 0);
+    parson_free_function(arena);
 }
 
-JSON_Value * json_parse_string_with_comments(const char *string) {
-    JSON_Value *result = NULL;
-    char *string_mutable_copy = NULL, *string_mutable_copy_ptr = NULL;
-    string_mutable_copy = parson_strdup(string);
-    if (string_mutable_copy == NULL) {
+size_t json_arena_size(const JSON_Arena *arena) {
+    const JSON_Arena_Block *block = NULL;
+    size_t size = 0;
+    if (arena == NULL) {
+        return 0;
+    }
+    for (block = arena->blocks; block; block = block->next) {
+        size += ARENA_BLOCK_HEADER_SIZE + block->capacity;
+    }
+    return size;
+}
+
+JSON_Value * json_parse_file_arena(JSON_Arena *arena, const char *filename) {
+    if (arena == NULL) {
         return NULL;
     }
-    remove_comments(string_mutable_copy, "/*", "*/");
-    remove_comments(string_mutable_copy, "//", "\n");
-    string_mutable_copy_ptr = string_mutable_copy;
-    result = parse_value((const char**)&string_mutable_copy_ptr, 0);
-    parson_free(string_mutable_copy);
-    return result;
+    return parse_file(arena, filename, PARSON_FALSE);
+}
+
+JSON_Value * json_parse_file_with_comments_arena(JSON_Arena *arena, const char *filename) {
+    if (arena == NULL) {
+        return NULL;
+    }
+    return parse_file(arena, filename, PARSON_TRUE);
+}
+
+JSON_Value * json_parse_string_arena(JSON_Arena *arena, const char *string) {
+    if (arena == NULL) {
+        return NULL;
+    }
+    return parse_root(arena, string);
+}
+
+JSON_Value * json_parse_string_with_comments_arena(JSON_Arena *arena, const char *string) {
+    if (arena == NULL) {
+        return NULL;
+    }
+    return parse_string_with_comments(arena, string);
 }
 
 /* JSON Object API */
@@ -2083,8 +2293,6 @@ JSON_Status json_array_append_null(JSON_Array *array) {
 
 JSON_Status json_object_set_value(JSON_Object *object, const char *name, JSON_Value *value) {
     unsigned long hash = 0;
-    parson_bool_t found = PARSON_FALSE;
-    size_t cell_ix = 0;
     size_t item_ix = 0;
     JSON_Value *old_value = NULL;
     char *key_copy = NULL;
@@ -2093,10 +2301,8 @@ JSON_Status json_object_set_value(JSON_Object *object, const char *name, JSON_Va
         return JSONFailure;
     }
     hash = hash_string(name, strlen(name));
-    found = PARSON_FALSE;
-    cell_ix = json_object_get_cell_ix(object, name, strlen(name), hash, &found);
-    if (found) {
-        item_ix = object->cells[cell_ix];
+    item_ix = json_object_get_item_ix(object, name, strlen(name), hash);
+    if (item_ix != OBJECT_INVALID_IX) {
         old_value = object->values[item_ix];
         json_value_free(old_value);
         object->values[item_ix] = value;
@@ -2108,19 +2314,12 @@ JSON_Status json_object_set_value(JSON_Object *object, const char *name, JSON_Va
         if (res != JSONSuccess) {
             return JSONFailure;
         }
-        cell_ix = json_object_get_cell_ix(object, name, strlen(name), hash, &found);
     }
     key_copy = parson_strdup(name);
     if (!key_copy) {
         return JSONFailure;
     }
-    object->names[object->count] = key_copy;
-    object->cells[cell_ix] = object->count;
-    object->values[object->count] = value;
-    object->cell_ixs[object->count] = cell_ix;
-    object->hashes[object->count] = hash;
-    object->count++;
-    value->parent = json_object_get_wrapping_value(object);
+    json_object_insert(object, key_copy, value, hash);
     return JSONSuccess;
 }
 
@@ -2461,8 +2660,8 @@ int json_boolean(const JSON_Value *value) {
 }
 
 void json_set_allocation_functions(JSON_Malloc_Function malloc_fun, JSON_Free_Function free_fun) {
-    parson_malloc = malloc_fun;
-    parson_free = free_fun;
+    parson_malloc_function = malloc_fun;
+    parson_free_function = free_fun;
 }
 
 void json_set_escape_slashes(int escape_slashes) {
@@ -46,6 +46,7 @@ extern "C"
 typedef struct json_object_t JSON_Object;
 typedef struct json_array_t  JSON_Array;
 typedef struct json_value_t  JSON_Value;
+typedef struct json_arena_t  JSON_Arena;
 
 enum json_value_type {
     JSONError   = -1,
@@ -104,6 +105,28 @@ JSON_Value * json_parse_string(const char *string);
     returns NULL in case of error */
 JSON_Value * json_parse_string_with_comments(const char *string);
 
+/* Arena parsing
+   The json_parse_*_arena functions allocate every value, string and object member from an arena
+   instead of one allocation each, and the whole tree is released at once with json_arena_free.
+   Values parsed into an arena are read-only: don't modify them or pass them to json_value_free
+   (use json_value_deep_copy for a copy that can be modified). Several values can be parsed into
+   the same arena. A failed parse returns NULL and leaves its partial allocations in the arena.
+   Not thread safe, like json_set_allocation_functions. */
+
+/* Creates an empty arena that allocates blocks of block_size bytes (0 for the default) */
+JSON_Arena * json_arena_create(size_t block_size);
+
+/* Frees an arena and every value parsed into it */
+void json_arena_free(JSON_Arena *arena);
+
+/* Returns the number of bytes the arena has allocated */
+size_t json_arena_size(const JSON_Arena *arena);
+
+JSON_Value * json_parse_file_arena(JSON_Arena *arena, const char *filename);
+JSON_Value * json_parse_file_with_comments_arena(JSON_Arena *arena, const char *filename);
+JSON_Value * json_parse_string_arena(JSON_Arena *arena, const char *string);
+JSON_Value * json_parse_string_with_comments_arena(JSON_Arena *arena, const char *string);
+
 /* Serialization */
 size_t      json_serialization_size(const JSON_Value *value); /* returns 0 on fail */
 JSON_Status json_serialize_to_buffer(const JSON_Value *value, char *buf, size_t buf_size_in_bytes);
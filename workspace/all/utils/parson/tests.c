@@ -69,6 +69,8 @@ void test_failing_allocations(void);
 void test_custom_number_format(void);
 void test_custom_number_serialization_function(void);
 void test_object_clear(void);
+void test_object_linear_and_hashed(void); /* Test objects crossing the hash index threshold */
+void test_arena(void); /* Test parsing into an arena */
 
 void print_commits_info(const char *username, const char *repo);
 void persistence_example(void);
@@ -140,6 +142,8 @@ int tests_main(int argc, char *argv[]) {
     test_custom_number_format();
     test_custom_number_serialization_function();
     test_object_clear();
+    test_object_linear_and_hashed();
+    test_arena();
 
     printf("Tests failed: %d\n", g_tests_failed);
     printf("Tests passed: %d\n", g_tests_passed);
@@ -756,6 +760,87 @@ void test_object_clear(void) {
     TEST(g_malloc_count == 0);
 }
 
+void test_object_linear_and_hashed(void) {
+    JSON_Value *val = NULL;
+    JSON_Object *obj = NULL;
+    char key[32];
+    int i = 0;
+    int found = 0;
+    g_malloc_count = 0;
+
+    val = json_value_init_object();
+    obj = json_value_get_object(val);
+    for (i = 0; i < 40; i++) {
+        sprintf(key, "key%d", i);
+        TEST(json_object_set_number(obj, key, i) == JSONSuccess);
+        if (i == 3 || i == 20) {
+            /* remove from a small object and from an indexed one */
+            TEST(json_object_remove(obj, "key1") == JSONSuccess);
+            TEST(json_object_set_number(obj, "key1", 1) == JSONSuccess);
+        }
+    }
+    TEST(json_object_get_count(obj) == 40);
+    for (i = 0; i < 40; i++) {
+        sprintf(key, "key%d", i);
+        if (DBL_EQ(json_object_get_number(obj, key), i)) {
+            found++;
+        }
+    }
+    TEST(found == 40);
+    TEST(json_object_get_value(obj, "key40") == NULL);
+    TEST(json_object_set_number(obj, "key5", 50) == JSONSuccess);
+    TEST(json_object_get_count(obj) == 40);
+    TEST(DBL_EQ(json_object_get_number(obj, "key5"), 50));
+    json_value_free(val);
+
+    TEST(g_malloc_count == 0);
+}
+
+void test_arena(void) {
+    JSON_Arena *arena = NULL;
+    JSON_Value *val = NULL;
+    JSON_Value *heap_val = NULL;
+    JSON_Value *copy = NULL;
+    g_malloc_count = 0;
+
+    TEST(json_parse_string_arena(NULL, "[]") == NULL);
+
+    arena = json_arena_create(0);
+    TEST(arena != NULL);
+    TEST(json_arena_size(arena) == 0);
+
+    TEST((val = json_parse_file_arena(arena, get_file_path("test_2.txt"))) != NULL);
+    test_suite_2(val);
+    TEST(json_arena_size(arena) > 0);
+
+    heap_val = json_parse_file(get_file_path("test_2.txt"));
+    TEST(json_value_equals(val, heap_val));
+    copy = json_value_deep_copy(val);
+    TEST(json_value_equals(copy, heap_val));
+    json_value_free(copy);
+    json_value_free(heap_val);
+
+    TEST((val = json_parse_file_with_comments_arena(arena, get_file_path("test_2_comments.txt"))) != NULL);
+    test_suite_2(val);
+
+    TEST((val = json_parse_string_arena(arena, "{\"a\": [1, \"two\", {\"b\": null}]}")) != NULL);
+    TEST(STREQ(json_array_get_string(json_object_get_array(json_value_get_object(val), "a"), 1), "two"));
+    TEST(json_parse_string_arena(arena, "{\"a\": [1, ") == NULL);
+    TEST(json_parse_string_with_comments_arena(arena, "/* c */ [true] // c") != NULL);
+
+    json_arena_free(arena);
+    json_arena_free(NULL);
+
+    /* blocks smaller than a single string */
+    arena = json_arena_create(16);
+    TEST((val = json_parse_string_arena(arena, "[\"a string longer than the block\", \"s\"]")) != NULL);
+    TEST(STREQ(json_array_get_string(json_value_get_array(val), 0), "a string longer than the block"));
+    TEST(STREQ(json_array_get_string(json_value_get_array(val), 1), "s"));
+    json_arena_free(arena);
+
+    TEST(g_malloc_count == 0);
+}
+
 void print_commits_info(const char *username, const char *repo) {
     JSON_Value *root_value;
     JSON_Array *commits;
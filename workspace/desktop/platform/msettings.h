@@ -108,4 +108,23 @@ void SetHDMI(int value);
  */
 int GetMute(void);
 
+/**
+ * Gets the settings sequence number.
+ *
+ * Changes whenever any setting does, so a caller can compare it once per
+ * frame and only reread the settings it cares about when it moved.
+ *
+ * @return Current sequence number
+ */
+int GetSettingsSeq(void);
+
+/**
+ * Waits for the settings to change.
+ *
+ * @param seq Sequence number the caller last saw
+ * @param timeout_ms Longest wait, or -1 to wait forever
+ * @return 1 if the sequence number differs from seq, 0 on timeout
+ */
+int WaitSettings(int seq, int timeout_ms);
+
 #endif // __msettings_h__
@@ -24,6 +24,7 @@
 
 #include "api.h"
 #include "defines.h"
+#include "input_thread.h"
 #include "platform.h"
 #include "utils.h"
 
@@ -63,6 +64,16 @@ int GetMute(void) {
 	return 0;
 }
 
+int GetSettingsSeq(void) {
+	return 0;
+}
+int WaitSettings(int seq, int timeout_ms) {
+	// Settings never change here
+	if (timeout_ms > 0)
+		usleep(timeout_ms * 1000);
+	return 0;
+}
+
 ///////////////////////////////
 // Input
 ///////////////////////////////
@@ -85,6 +96,15 @@ void PLAT_quitInput(void) {
 	SDL_QuitSubSystem(SDL_INIT_JOYSTICK);
 }
 
+/**
+ * Stands in for input_thread.c, which needs evdev and isn't built here.
+ *
+ * @return 0, input comes through SDL without an input thread
+ */
+uint32_t InputThread_getAge(void) {
+	return 0;
+}
+
 ///////////////////////////////
 // Video
 ///////////////////////////////
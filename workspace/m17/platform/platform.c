@@ -26,12 +26,14 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 
 #include <msettings.h>
 
 #include "api.h"
 #include "defines.h"
+#include "input_thread.h"
 #include "platform.h"
 #include "utils.h"
 
@@ -81,18 +83,29 @@ void PLAT_initInput(void) {
  * Closes input system and cleans up resources.
  */
 void PLAT_quitInput(void) {
+	InputThread_stop();
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		close(inputs[i]);
 	}
 }
 
-// Struct from <linux/input.h> which has BTN_ constants that conflict with platform.h
-struct input_event {
-	struct timeval time;
-	__u16 type;
-	__u16 code;
-	__s32 value;
-};
+/**
+ * Hands the input devices to a dedicated reader thread.
+ *
+ * @return 1 if the thread is running
+ */
+int PLAT_startInputThread(void) {
+	return InputThread_start(inputs, INPUT_COUNT) == 0;
+}
+
+/**
+ * Goes back to reading the input devices in PLAT_pollInput().
+ */
+void PLAT_stopInputThread(void) {
+	InputThread_stop();
+}
+
+// EV_ constants from <linux/input.h>, which has BTN_ constants that conflict with platform.h
 #define EV_KEY 0x01
 #define EV_ABS 0x03
 
@@ -108,6 +121,7 @@ void PLAT_pollInput(void) {
 	pad.just_pressed = BTN_NONE;
 	pad.just_released = BTN_NONE;
 	pad.just_repeated = BTN_NONE;
+	InputThread_beginFrame();
 
 	uint32_t tick = SDL_GetTicks();
 	for (int i = 0; i < BTN_ID_COUNT; i++) {
@@ -120,10 +134,10 @@ void PLAT_pollInput(void) {
 
 	// the actual poll
 	int input;
-	static struct input_event event;
+	InputEvent event;
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		input = inputs[i];
-		while (read(input, &event, sizeof(event)) == sizeof(event)) {
+		while (InputThread_read(i, input, &event)) {
 			if (event.type != EV_KEY && event.type != EV_ABS)
 				continue;
 
@@ -227,10 +241,11 @@ void PLAT_pollInput(void) {
  */
 int PLAT_shouldWake(void) {
 	int input;
-	static struct input_event event;
+	InputEvent event;
+	InputThread_beginFrame();
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		input = inputs[i];
-		while (read(input, &event, sizeof(event)) == sizeof(event)) {
+		while (InputThread_read(i, input, &event)) {
 			if (event.type == EV_KEY && (event.code == RAW_MENU1 || event.code == RAW_MENU2) &&
 			    event.value == 0)
 				return 1;
@@ -239,6 +254,25 @@ int PLAT_shouldWake(void) {
 	return 0;
 }
 
+/**
+ * Blocks until an input device has events or the timeout expires.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return 1 if input is ready, 0 on timeout
+ */
+int PLAT_waitForInput(uint32_t timeout_ms) {
+	if (InputThread_isRunning())
+		return InputThread_wait(timeout_ms);
+
+	struct pollfd fds[INPUT_COUNT];
+	for (int i = 0; i < INPUT_COUNT; i++) {
+		fds[i].fd = inputs[i];
+		fds[i].events = POLLIN;
+		fds[i].revents = 0;
+	}
+	return poll(fds, INPUT_COUNT, timeout_ms) > 0;
+}
+
 ///////////////////////////////
 // Video subsystem (SDL2)
 ///////////////////////////////
@@ -580,19 +614,7 @@ void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	// *is_charging = exactMatch(state,"Charging\n");
 
 	int i = getInt("/sys/class/power_supply/battery/capacity");
-	// worry less about battery and more about the game you're playing
-	if (i > 80)
-		*charge = 100;
-	else if (i > 60)
-		*charge = 80;
-	else if (i > 40)
-		*charge = 60;
-	else if (i > 20)
-		*charge = 40;
-	else if (i > 10)
-		*charge = 20;
-	else
-		*charge = 10;
+	*charge = i; // smoothed and bucketed by battery.c
 }
 
 /**
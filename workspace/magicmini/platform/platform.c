@@ -27,13 +27,16 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <pthread.h>
 #include <unistd.h>
 
 #include <msettings.h>
 
 #include "api.h"
+#include "cpufreq.h"
 #include "defines.h"
+#include "input_thread.h"
 #include "platform.h"
 #include "utils.h"
 
@@ -104,18 +107,29 @@ void PLAT_initInput(void) {
  * Closes all input device file descriptors.
  */
 void PLAT_quitInput(void) {
+	InputThread_stop();
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		close(inputs[i]);
 	}
 }
 
-// from <linux/input.h> which has BTN_ constants that conflict with platform.h
-struct input_event {
-	struct timeval time;
-	__u16 type;
-	__u16 code;
-	__s32 value;
-};
+/**
+ * Hands the input devices to a dedicated reader thread.
+ *
+ * @return 1 if the thread is running
+ */
+int PLAT_startInputThread(void) {
+	return InputThread_start(inputs, INPUT_COUNT) == 0;
+}
+
+/**
+ * Goes back to reading the input devices in PLAT_pollInput().
+ */
+void PLAT_stopInputThread(void) {
+	InputThread_stop();
+}
+
+// EV_ constants from <linux/input.h>, which has BTN_ constants that conflict with platform.h
 #define EV_KEY 0x01
 #define EV_ABS 0x03
 
@@ -176,6 +190,7 @@ void PLAT_pollInput(void) {
 	pad.just_pressed = BTN_NONE;
 	pad.just_released = BTN_NONE;
 	pad.just_repeated = BTN_NONE;
+	InputThread_beginFrame();
 
 	uint32_t tick = SDL_GetTicks();
 	// Handle button repeat for held buttons
@@ -189,10 +204,10 @@ void PLAT_pollInput(void) {
 
 	// the actual poll
 	int input;
-	static struct input_event event;
+	InputEvent event;
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		input = inputs[i];
-		while (read(input, &event, sizeof(event)) == sizeof(event)) {
+		while (InputThread_read(i, input, &event)) {
 			if (event.type != EV_KEY && event.type != EV_ABS)
 				continue;
 
@@ -314,10 +329,11 @@ void PLAT_pollInput(void) {
  */
 int PLAT_shouldWake(void) {
 	int input;
-	static struct input_event event;
+	InputEvent event;
+	InputThread_beginFrame();
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		input = inputs[i];
-		while (read(input, &event, sizeof(event)) == sizeof(event)) {
+		while (InputThread_read(i, input, &event)) {
 			if (event.type == EV_KEY && event.code == RAW_POWER && event.value == 0) {
 				return 1;
 			}
@@ -326,6 +342,25 @@ int PLAT_shouldWake(void) {
 	return 0;
 }
 
+/**
+ * Blocks until an input device has events or the timeout expires.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return 1 if input is ready, 0 on timeout
+ */
+int PLAT_waitForInput(uint32_t timeout_ms) {
+	if (InputThread_isRunning())
+		return InputThread_wait(timeout_ms);
+
+	struct pollfd fds[INPUT_COUNT];
+	for (int i = 0; i < INPUT_COUNT; i++) {
+		fds[i].fd = inputs[i];
+		fds[i].events = POLLIN;
+		fds[i].revents = 0;
+	}
+	return poll(fds, INPUT_COUNT, timeout_ms) > 0;
+}
+
 ///////////////////////////////
 // Video System
 ///////////////////////////////
@@ -1052,19 +1087,7 @@ void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	*is_charging = getInt("/sys/class/power_supply/ac/online");
 
 	int i = getInt("/sys/class/power_supply/battery/capacity");
-	// Bucket charge level to reduce UI flicker from minor fluctuations
-	if (i > 80)
-		*charge = 100;
-	else if (i > 60)
-		*charge = 80;
-	else if (i > 40)
-		*charge = 60;
-	else if (i > 20)
-		*charge = 40;
-	else if (i > 10)
-		*charge = 20;
-	else
-		*charge = 10;
+	*charge = i; // smoothed and bucketed by battery.c
 }
 
 #define BACKLIGHT_PATH "/sys/class/backlight/backlight/bl_power"
@@ -1119,6 +1142,11 @@ void PLAT_powerOff(void) {
 #define GPU_PATH "/sys/devices/platform/ff400000.gpu/devfreq/ff400000.gpu/governor"
 #define DMC_PATH "/sys/devices/platform/dmc/devfreq/dmc/governor"
 
+static const CPUFreqConfig cpufreq_config = {
+    .khz = {600000, 816000, 1416000, 2016000}, // MENU, POWERSAVE, NORMAL, PERFORMANCE
+    .setspeed_path = CPU_PATH,
+};
+
 /**
  * Sets CPU/GPU/memory frequency based on performance mode.
  *
@@ -1134,21 +1162,8 @@ void PLAT_powerOff(void) {
  * @note PERFORMANCE mode may not be stable on all chips (depends on binning)
  */
 void PLAT_setCPUSpeed(int speed) {
-	int freq = 0;
-	switch (speed) {
-	case CPU_SPEED_MENU:
-		freq = 600000;
-		break;
-	case CPU_SPEED_POWERSAVE:
-		freq = 816000;
-		break;
-	case CPU_SPEED_NORMAL:
-		freq = 1416000;
-		break;
-	case CPU_SPEED_PERFORMANCE:
-		freq = 2016000;
-		break; // not viable on lower binned chips
-	}
+	if (CPUFreq_setSpeedWith(&cpufreq_config, speed) <= 0)
+		return; // unchanged or failed
 
 	// Performance mode: maximize GPU and memory controller
 	if (speed == CPU_SPEED_PERFORMANCE) {
@@ -1158,7 +1173,6 @@ void PLAT_setCPUSpeed(int speed) {
 		putFile(GPU_PATH, "simple_ondemand");
 		putFile(DMC_PATH, "dmc_ondemand");
 	}
-	putInt(CPU_PATH, freq);
 }
 
 /**
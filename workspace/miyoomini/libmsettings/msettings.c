@@ -7,6 +7,10 @@
 #include <sys/stat.h>
 #include <dlfcn.h>
 #include <string.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
 
 #include <mi_ao.h>
 #include <stdint.h>
@@ -100,7 +104,8 @@ typedef struct Settings {
 	int headphones; // Mini Flip headphone volume
 	int speaker;
 	int jack;       // 0 = speaker, 1 = headphones (Mini Flip)
-	int unused[3];  // for future use
+	int seq; // bumped on every change, see GetSettingsSeq()
+	int unused[2];  // for future use
 } Settings;
 static Settings DefaultSettings = {
 	.version = SETTINGS_VERSION,
@@ -111,6 +116,27 @@ static Settings DefaultSettings = {
 };
 static Settings* settings;
 
+///////////////////////////////////////
+
+// settings->seq is bumped after every change and futex waiters are woken,
+// so clients can check for changes with one compare instead of rereading
+// fields. The bump is a release store: a client that sees the new seq also
+// sees the fields that were written before it.
+static void NotifySettings(void) {
+	__atomic_add_fetch(&settings->seq, 1, __ATOMIC_RELEASE);
+	syscall(SYS_futex, &settings->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+int GetSettingsSeq(void) {
+	return __atomic_load_n(&settings->seq, __ATOMIC_ACQUIRE);
+}
+int WaitSettings(int seq, int timeout_ms) {
+	struct timespec timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000 };
+	if (GetSettingsSeq()==seq) {
+		syscall(SYS_futex, &settings->seq, FUTEX_WAIT, seq, timeout_ms<0 ? NULL : &timeout, NULL, 0);
+	}
+	return GetSettingsSeq()!=seq;
+}
+
 #define SHM_KEY "/SharedSettings"
 static char SettingsPath[256];
 static int shm_fd = -1;
@@ -180,6 +206,7 @@ void SetBrightness(int value) {
 	SetRawBrightness(value==0?6:value*10);
 	settings->brightness = value;
 	SaveSettings();
+	NotifySettings();
 }
 
 int GetVolume(void) { // 0-20
@@ -192,6 +219,7 @@ void SetVolume(int value) {
 	int raw = -60 + value * 3;
 	SetRawVolume(raw);
 	SaveSettings();
+	NotifySettings();
 }
 
 void SetRawBrightness(int val) {
@@ -230,6 +258,7 @@ void SetJack(int value) {
 	LOG_debug("SetJack(%i)", value);
 	settings->jack = value;
 	SetVolume(GetVolume());
+	NotifySettings();
 }
 
 int GetHDMI(void) {
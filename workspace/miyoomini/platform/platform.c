@@ -46,9 +46,11 @@
 #include <linux/i2c.h>
 
 #include "api.h"
+#include "cpufreq.h"
 #include "defines.h"
 #include "platform.h"
 #include "scaler.h"
+#include "scaler_pool.h"
 #include "utils.h"
 
 ///////////////////////////////
@@ -555,6 +557,10 @@ void PLAT_vsync(int remaining) {
  * @return Function pointer to scaler implementation
  */
 scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
+	// Non-integer scale (Sharp Bilinear) is drawn at its final size, no effects
+	if (renderer->scale < 0)
+		return scaleSharpBilinear_n16;
+
 	// Scanline effect scalers
 	if (effect_type == EFFECT_LINE) {
 		switch (renderer->scale) {
@@ -579,20 +585,8 @@ scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
 	}
 
 	// Default nearest-neighbor scalers (NEON-optimized)
-	switch (renderer->scale) {
-	case 6:
-		return scale6x6_n16;
-	case 5:
-		return scale5x5_n16;
-	case 4:
-		return scale4x4_n16;
-	case 3:
-		return scale3x3_n16;
-	case 2:
-		return scale2x2_n16;
-	default:
-		return scale1x1_n16;
-	}
+	scaler_t scaler = scaler_find_n16(renderer->scale, renderer->scale);
+	return scaler ? scaler : scale1x1_n16;
 }
 
 /**
@@ -612,8 +606,11 @@ void PLAT_blitRenderer(GFX_Renderer* renderer) {
 
 	// Calculate destination pointer with offset
 	void* dst = renderer->dst + (renderer->dst_y * renderer->dst_p) + (renderer->dst_x * FIXED_BPP);
-	((scaler_t)renderer->blit)(renderer->src, dst, renderer->src_w, renderer->src_h,
-	                           renderer->src_p, renderer->dst_w, renderer->dst_h, renderer->dst_p);
+	static ScalerPoolGate gate;
+	uint32_t ymul = renderer->scale > 0 ? renderer->scale : 0; // 0 for Sharp Bilinear
+	ScalerPool_scale(&gate, (scaler_t)renderer->blit, ymul, renderer->src, dst, renderer->src_w,
+	                 renderer->src_h, renderer->src_p, renderer->dst_w, renderer->dst_h,
+	                 renderer->dst_p);
 }
 
 /**
@@ -755,8 +752,6 @@ static int online = 0; // WiFi connection status
  * Battery level is read from /tmp/battery (updated by system daemon) and
  * quantized to 6 levels to reduce visual noise: 100%, 80%, 60%, 40%, 20%, 10%
  *
- * Also updates WiFi connection status as a side effect.
- *
  * @param is_charging Output: receives charging status (1=charging, 0=not)
  * @param charge Output: receives battery level (10, 20, 40, 60, 80, 100)
  */
@@ -768,21 +763,13 @@ void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	// Read battery percentage from system daemon
 	int i = getInt("/tmp/battery"); // 0-100
 
-	// Quantize to reduce visual noise in battery indicator
-	if (i > 80)
-		*charge = 100;
-	else if (i > 60)
-		*charge = 80;
-	else if (i > 40)
-		*charge = 60;
-	else if (i > 20)
-		*charge = 40;
-	else if (i > 10)
-		*charge = 20;
-	else
-		*charge = 10;
+	*charge = i; // smoothed and bucketed by battery.c
+}
 
-	// Update WiFi connection status
+/**
+ * Refreshes the WiFi connection status returned by PLAT_isOnline().
+ */
+void PLAT_updateNetwork(void) {
 	char status[16];
 	getFile("/sys/class/net/wlan0/operstate", status, 16);
 	online = prefixMatch("up", status);
@@ -842,8 +829,81 @@ void PLAT_powerOff(void) {
 // CPU Speed Control
 ///////////////////////////////
 
+#define MPLL_BASE (0x1F000000 + 0x103000 * 2) // RIU base + MPLL bank
+#define MPLL_SIZE 0x1000
+
+static volatile uint16_t* mpll;
+
 /**
- * Sets CPU frequency using overclock.elf utility.
+ * Programs the CPU PLL directly (ported from overclock.elf).
+ *
+ * The post divider is raised before and lowered after the LPF transition
+ * so the clock never overshoots.
+ *
+ * @param khz Target frequency
+ * @return 0 on success, -1 if /dev/mem couldn't be mapped
+ */
+static int setCPUClock(int khz) {
+	if (!mpll) {
+		int fd = open("/dev/mem", O_RDWR | O_SYNC);
+		if (fd < 0)
+			return -1;
+		void* map = mmap(0, MPLL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, MPLL_BASE);
+		close(fd);
+		if (map == MAP_FAILED)
+			return -1;
+		mpll = map;
+	}
+
+	uint32_t post_div;
+	if (khz >= 800000)
+		post_div = 2;
+	else if (khz >= 400000)
+		post_div = 4;
+	else if (khz >= 200000)
+		post_div = 8;
+	else
+		post_div = 16;
+
+	static const uint64_t divsrc = 432000000llu * 524288;
+	uint32_t rate = ((uint32_t)khz * 1000) / 16 * post_div / 2;
+	uint32_t lpf = (uint32_t)(divsrc / rate);
+
+	uint32_t cur_post_div = (mpll[0x232] & 0x0F) + 1;
+	uint32_t tmp_post_div = cur_post_div;
+	while (post_div > tmp_post_div) {
+		tmp_post_div <<= 1;
+		mpll[0x232] = (mpll[0x232] & 0xF0) | ((tmp_post_div - 1) & 0x0F);
+	}
+
+	mpll[0x2A8] = 0x0000; // reg_lpf_enable = 0
+	mpll[0x2AE] = 0x000F; // reg_lpf_update_cnt = 32
+	mpll[0x2A4] = lpf & 0xFFFF; // set target freq to LPF high
+	mpll[0x2A6] = lpf >> 16;
+	mpll[0x2B0] = 0x0001; // switch to LPF control
+	mpll[0x2B2] |= 0x1000; // from low to high
+	mpll[0x2A8] = 0x0001; // reg_lpf_enable = 1
+	while (!(mpll[0x2BA] & 1))
+		; // poll until done
+	mpll[0x2A0] = lpf & 0xFFFF; // store freq to LPF low
+	mpll[0x2A2] = lpf >> 16;
+
+	while (post_div < tmp_post_div) {
+		tmp_post_div >>= 1;
+		mpll[0x232] = (mpll[0x232] & 0xF0) | ((tmp_post_div - 1) & 0x0F);
+	}
+	return 0;
+}
+
+static const CPUFreqConfig cpufreq_config = {
+    .khz = {504000, 1104000, 1296000, 1488000}, // MENU, POWERSAVE, NORMAL, PERFORMANCE
+    .governor_path = "/sys/devices/system/cpu/cpufreq/policy0/scaling_governor",
+    .setspeed_path = "/sys/devices/system/cpu/cpufreq/policy0/scaling_setspeed",
+    .apply = setCPUClock,
+};
+
+/**
+ * Sets CPU frequency in-process (previously via overclock.elf).
  *
  * Frequency mapping:
  * - CPU_SPEED_MENU:        504 MHz (power saving for menus)
@@ -854,25 +914,7 @@ void PLAT_powerOff(void) {
  * @param speed One of the CPU_SPEED_* constants
  */
 void PLAT_setCPUSpeed(int speed) {
-	int freq = 0;
-	switch (speed) {
-	case CPU_SPEED_MENU:
-		freq = 504000;
-		break;
-	case CPU_SPEED_POWERSAVE:
-		freq = 1104000;
-		break;
-	case CPU_SPEED_NORMAL:
-		freq = 1296000;
-		break;
-	case CPU_SPEED_PERFORMANCE:
-		freq = 1488000;
-		break;
-	}
-
-	char cmd[32];
-	sprintf(cmd, "overclock.elf %d\n", freq);
-	system(cmd);
+	CPUFreq_setSpeedWith(&cpufreq_config, speed);
 }
 
 ///////////////////////////////
@@ -9,178 +9,40 @@
  *
  * Uses different input event codes than SDL (CODE_MENU can be 1 or 354).
  * Monitors two separate input devices (event0 and event3).
- *
- * Runs continuously at 60Hz polling the input devices for button events.
- * Ignores stale input after system sleep to prevent spurious events.
+ * See keymon_core.h.
  */
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdint.h>
-#include <unistd.h>
-#include <string.h>
-#include <fcntl.h>
-#include <dirent.h>
-#include <linux/input.h>
+#include <stddef.h>
 
 #include <msettings.h>
 
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <sys/ioctl.h>
-
-// #include "defines.h"
-
-#define VOLUME_MIN 		0
-#define VOLUME_MAX 		20
-#define BRIGHTNESS_MIN 	0
-#define BRIGHTNESS_MAX 	10
+#include "keymon_core.h"
 
 // Hardware button codes (different from SDL codes)
 #define CODE_MENU		1 // but also 354
 #define CODE_PLUS		115
 #define CODE_MINUS		114
 
-// Input event values from linux/input.h
-#define RELEASED	0
-#define PRESSED		1
-#define REPEAT		2
+static const KeymonButton buttons[] = {
+	{CODE_MENU,		KEYMON_MENU},
+	{CODE_PLUS,		KEYMON_PLUS},
+	{CODE_MINUS,	KEYMON_MINUS},
+};
 
-#define INPUT_COUNT 2
-static int inputs[INPUT_COUNT];
-static struct input_event ev;
+static const KeymonConfig config = {
+	.inputs = {"/dev/input/event0", "/dev/input/event3"},
+	.buttons = buttons,
+	.button_count = sizeof(buttons) / sizeof(buttons[0]),
+};
 
 /**
- * Main event loop for hardware button monitoring.
- *
- * Continuously polls two input devices for button events and handles:
- * - MENU+PLUS: Increase brightness
- * - MENU+MINUS: Decrease brightness
- * - PLUS alone: Increase volume
- * - MINUS alone: Decrease volume
- *
- * Implements repeat functionality (initial 300ms delay, then 100ms interval)
- * and ignores stale input after system sleep (> 1 second gap).
+ * Runs the keymon daemon until SIGTERM.
  *
  * @param argc Argument count (unused)
  * @param argv Argument values (unused)
- * @return Never returns (runs infinite loop)
- *
- * @note Uses event0 and event3 input devices
+ * @return 0 on clean exit, 1 if the event loop couldn't be set up
  */
 int main (int argc, char *argv[]) {
 	InitSettings();
-
-	// Open multiple input devices for button monitoring
-	inputs[0] = open("/dev/input/event0", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
-	inputs[1] = open("/dev/input/event3", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
-
-	uint32_t val;
-	uint32_t menu_pressed = 0;
-
-	// Track PLUS button state for repeat handling
-	uint32_t up_pressed = 0;
-	uint32_t up_just_pressed = 0;
-	uint32_t up_repeat_at = 0;
-
-	// Track MINUS button state for repeat handling
-	uint32_t down_pressed = 0;
-	uint32_t down_just_pressed = 0;
-	uint32_t down_repeat_at = 0;
-
-	uint8_t ignore;
-	uint32_t then;
-	uint32_t now;
-	struct timeval tod;
-
-	gettimeofday(&tod, NULL);
-	then = tod.tv_sec * 1000 + tod.tv_usec / 1000; // SDL_GetTicks() equivalent
-	ignore = 0;
-
-	while (1) {
-		gettimeofday(&tod, NULL);
-		now = tod.tv_sec * 1000 + tod.tv_usec / 1000;
-
-		// Ignore stale input after system sleep to avoid spurious events
-		if (now-then>1000) ignore = 1;
-
-		// Poll both input devices for button events
-		for (int i=0; i<INPUT_COUNT; i++) {
-			int input_fd = inputs[i];
-			while(read(input_fd, &ev, sizeof(ev))==sizeof(ev)) {
-				if (ignore) continue;
-				val = ev.value;
-
-				// Only process key events (PRESSED, RELEASED, or REPEAT)
-				if (( ev.type != EV_KEY ) || ( val > REPEAT )) continue;
-
-				// Process hardware button events
-				switch (ev.code) {
-					case CODE_MENU:
-						menu_pressed = val;
-					break;
-				case CODE_PLUS:
-						// Volume up button (or brightness up if MENU held)
-						up_pressed = up_just_pressed = val;
-						if (val) up_repeat_at = now + 300; // 300ms initial delay
-					break;
-					case CODE_MINUS:
-						// Volume down button (or brightness down if MENU held)
-						down_pressed = down_just_pressed = val;
-						if (val) down_repeat_at = now + 300; // 300ms initial delay
-					break;
-					default:
-					break;
-				}
-			}
-		}
-
-		// Reset button state after ignoring stale input
-		if (ignore) {
-			menu_pressed = 0;
-			up_pressed = up_just_pressed = 0;
-			down_pressed = down_just_pressed = 0;
-			up_repeat_at = 0;
-			down_repeat_at = 0;
-		}
-
-		// Handle PLUS button (initial press or repeat after delay)
-		if (up_just_pressed || (up_pressed && now>=up_repeat_at)) {
-			if (menu_pressed) {
-				// MENU+PLUS: Brightness up
-				val = GetBrightness();
-				if (val<BRIGHTNESS_MAX) SetBrightness(++val);
-			}
-			else {
-				// PLUS alone: Volume up
-				val = GetVolume();
-				if (val<VOLUME_MAX) SetVolume(++val);
-			}
-
-			if (up_just_pressed) up_just_pressed = 0;
-			else up_repeat_at += 100; // 100ms repeat interval
-		}
-
-		// Handle MINUS button (initial press or repeat after delay)
-		if (down_just_pressed || (down_pressed && now>=down_repeat_at)) {
-			if (menu_pressed) {
-				// MENU+MINUS: Brightness down
-				val = GetBrightness();
-				if (val>BRIGHTNESS_MIN) SetBrightness(--val);
-			}
-			else {
-				// MINUS alone: Volume down
-				val = GetVolume();
-				if (val>VOLUME_MIN) SetVolume(--val);
-			}
-
-			if (down_just_pressed) down_just_pressed = 0;
-			else down_repeat_at += 100; // 100ms repeat interval
-		}
-
-		then = now;
-		ignore = 0;
-
-		usleep(16666); // 60Hz polling rate
-	}
+	return Keymon_run(&config);
 }
@@ -35,6 +35,12 @@ static int s_fd = -1;
 static int g_lastX = 0;
 static int g_lastY = 0;
 
+// Written whenever the stick leaves or returns to center, so a sleeping
+// reader can poll() it alongside its button devices
+#define STICK_WAKE_THRESHOLD 64 // AXIS_DEADZONE (0x4000) in 8-bit units
+static int s_wake[2] = {-1, -1};
+static int s_deflected = 0;
+
 #define MIYOO_ADC_MIDDLE	128
 #define MIYOO_ADC_RANGE		64
 
@@ -238,6 +244,13 @@ static void check_axis_event(void) {
 		}
 		s_miyoo_axis_last[i] = s_miyoo_axis[i];
 	}
+
+	int deflected = abs(g_lastX) > STICK_WAKE_THRESHOLD || abs(g_lastY) > STICK_WAKE_THRESHOLD;
+	if (deflected != s_deflected) {
+		s_deflected = deflected;
+		char c = 1;
+		if (s_wake[1] >= 0) write(s_wake[1], &c, 1); // A full pipe is already readable
+	}
 	
 	// printf("x:%i-%i (%i) y:%i-%i (%i) %i,%i (%u,%u)\n", calibration.x_min,calibration.x_max,calibration.x_mid, calibration.y_min,calibration.y_max,calibration.y_mid, g_lastX,g_lastY, s_frame.axis0,s_frame.axis1);
 }
@@ -368,6 +381,13 @@ static void* readStick(void *arg) {
 
 void Stick_init(void) {
 	miyoo_init_serial_input();
+
+	if (pipe(s_wake) == 0) {
+		for (int i = 0; i < 2; i++) {
+			fcntl(s_wake[i], F_SETFL, O_NONBLOCK);
+			fcntl(s_wake[i], F_SETFD, FD_CLOEXEC);
+		}
+	}
 	
 	// load calibration data if present
 	sprintf(StickPath, "%s/mstick.bin", getenv("USERDATA_PATH"));
@@ -398,6 +418,14 @@ void Stick_quit(void) {
 	
 	pthread_cancel(stick_pt);
 	pthread_join(stick_pt, NULL);
+
+	for (int i = 0; i < 2; i++) {
+		if (s_wake[i] >= 0) close(s_wake[i]);
+		s_wake[i] = -1;
+	}
+}
+int Stick_getWakeFd(void) {
+	return s_wake[0];
 }
 void Stick_get(int* x, int* y) { // -32768 thru 32767
 	*x = g_lastX * 256;
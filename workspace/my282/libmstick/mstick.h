@@ -4,5 +4,6 @@
 void Stick_init(void);
 void Stick_quit(void);
 void Stick_get(int* x, int* y); // -32768 thru 32767
+int Stick_getWakeFd(void); // readable after the stick leaves or returns to center, drain with read()
 
 #endif  // __mstick_h__
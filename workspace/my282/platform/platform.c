@@ -22,6 +22,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <pthread.h>
 #include <unistd.h>
 
@@ -29,7 +30,9 @@
 #include <mstick.h>
 
 #include "api.h"
+#include "cpufreq.h"
 #include "defines.h"
+#include "input_thread.h"
 #include "platform.h"
 #include "utils.h"
 
@@ -78,19 +81,30 @@ void PLAT_initInput(void) {
  * Shuts down input system and closes file descriptors.
  */
 void PLAT_quitInput(void) {
+	InputThread_stop();
 	Stick_quit();
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		close(inputs[i]);
 	}
 }
 
-// from <linux/input.h> which has BTN_ constants that conflict with platform.h
-struct input_event {
-	struct timeval time;
-	__u16 type;
-	__u16 code;
-	__s32 value;
-};
+/**
+ * Hands the input devices to a dedicated reader thread.
+ *
+ * @return 1 if the thread is running
+ */
+int PLAT_startInputThread(void) {
+	return InputThread_start(inputs, INPUT_COUNT) == 0;
+}
+
+/**
+ * Goes back to reading the input devices in PLAT_pollInput().
+ */
+void PLAT_stopInputThread(void) {
+	InputThread_stop();
+}
+
+// EV_ constants from <linux/input.h>, which has BTN_ constants that conflict with platform.h
 #define EV_KEY 0x01
 #define EV_ABS 0x03
 
@@ -106,6 +120,7 @@ void PLAT_pollInput(void) {
 	pad.just_pressed = BTN_NONE;
 	pad.just_released = BTN_NONE;
 	pad.just_repeated = BTN_NONE;
+	InputThread_beginFrame();
 
 	uint32_t tick = SDL_GetTicks();
 	for (int i = 0; i < BTN_ID_COUNT; i++) {
@@ -118,10 +133,10 @@ void PLAT_pollInput(void) {
 
 	// the actual poll
 	int input;
-	static struct input_event event;
+	InputEvent event;
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		input = inputs[i];
-		while (read(input, &event, sizeof(event)) == sizeof(event)) {
+		while (InputThread_read(i, input, &event)) {
 			if (event.type != EV_KEY && event.type != EV_ABS)
 				continue;
 
@@ -227,10 +242,11 @@ void PLAT_pollInput(void) {
  */
 int PLAT_shouldWake(void) {
 	int input;
-	static struct input_event event;
+	InputEvent event;
+	InputThread_beginFrame();
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		input = inputs[i];
-		while (read(input, &event, sizeof(event)) == sizeof(event)) {
+		while (InputThread_read(i, input, &event)) {
 			if (event.type == EV_KEY && event.code == RAW_POWER && event.value == 0) {
 				return 1;
 			}
@@ -239,6 +255,44 @@ int PLAT_shouldWake(void) {
 	return 0;
 }
 
+/**
+ * Blocks until input is available or the timeout expires.
+ *
+ * Buttons are waited on with poll(). The analog stick is read over the
+ * UART by mstick, which signals its wake fd when the stick leaves center,
+ * so it is polled alongside them.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return 1 if input is ready, 0 on timeout
+ */
+int PLAT_waitForInput(uint32_t timeout_ms) {
+	if (InputThread_isRunning())
+		return InputThread_wait(timeout_ms);
+
+	int x, y;
+	Stick_get(&x, &y);
+	if (x > AXIS_DEADZONE || x < -AXIS_DEADZONE || y > AXIS_DEADZONE || y < -AXIS_DEADZONE)
+		return 1;
+
+	struct pollfd fds[INPUT_COUNT + 1];
+	for (int i = 0; i < INPUT_COUNT; i++) {
+		fds[i].fd = inputs[i];
+		fds[i].events = POLLIN;
+		fds[i].revents = 0;
+	}
+	fds[INPUT_COUNT].fd = Stick_getWakeFd(); // Ignored by poll() if negative
+	fds[INPUT_COUNT].events = POLLIN;
+	fds[INPUT_COUNT].revents = 0;
+
+	int ready = poll(fds, INPUT_COUNT + 1, timeout_ms) > 0;
+	if (fds[INPUT_COUNT].revents & POLLIN) {
+		char buffer[16];
+		while (read(fds[INPUT_COUNT].fd, buffer, sizeof(buffer)) > 0)
+			;
+	}
+	return ready;
+}
+
 ///////////////////////////////
 // Video Handling
 ///////////////////////////////
@@ -863,19 +917,7 @@ void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	*is_charging = getInt("/sys/class/power_supply/usb/online");
 
 	int i = getInt("/sys/class/power_supply/battery/capacity");
-	// worry less about battery and more about the game you're playing
-	if (i > 80)
-		*charge = 100;
-	else if (i > 60)
-		*charge = 80;
-	else if (i > 40)
-		*charge = 60;
-	else if (i > 20)
-		*charge = 40;
-	else if (i > 10)
-		*charge = 20;
-	else
-		*charge = 10;
+	*charge = i; // smoothed and bucketed by battery.c
 
 	// wifi status, just hooking into the regular PWR polling
 	// char status[16];
@@ -928,46 +970,40 @@ void PLAT_powerOff(void) {
 // System Control
 ///////////////////////////////
 
+/**
+ * Applies a CPU profile through overclock.elf.
+ *
+ * The tool also sets core count, GPU and DRAM clocks, so it's still run
+ * here, but CPUFreq only calls this when the frequency actually changes.
+ * NORMAL and above run with two cores.
+ *
+ * Command format: overclock.elf userspace <cores> <MHz> 384 1080 0
+ */
+static int setCPUProfile(int khz) {
+	char cmd[128];
+	sprintf(cmd, "overclock.elf userspace %d %d 384 1080 0", khz >= 1344000 ? 2 : 1, khz / 1000);
+	system(cmd);
+	return 0;
+}
+
+static const CPUFreqConfig cpufreq_config = {
+    .khz = {576000, 1056000, 1344000, 1512000}, // MENU, POWERSAVE, NORMAL, PERFORMANCE
+    .apply = setCPUProfile,
+};
+
 /**
  * Sets CPU frequency and core count.
  *
- * Uses overclock.elf utility to adjust CPU governor, core count,
- * and frequency based on performance profile:
+ * Performance profiles:
  * - MENU: 576MHz, 1 core (lowest power)
  * - POWERSAVE: 1056MHz, 1 core
  * - NORMAL: 1344MHz, 2 cores
  * - PERFORMANCE: 1512MHz, 2 cores (highest performance)
  *
- * Command format: overclock.elf userspace <cores> <freq> 384 1080 0
- *
  * @param speed CPU_SPEED_MENU/POWERSAVE/NORMAL/PERFORMANCE
  */
 void PLAT_setCPUSpeed(int speed) {
-	int freq = 0;
-	int cpu = 1;
-	switch (speed) {
-	case CPU_SPEED_MENU:
-		freq = 576;
-		cpu = 1;
-		break;
-	case CPU_SPEED_POWERSAVE:
-		freq = 1056;
-		cpu = 1;
-		break;
-	case CPU_SPEED_NORMAL:
-		freq = 1344;
-		cpu = 2;
-		break;
-	case CPU_SPEED_PERFORMANCE:
-		freq = 1512;
-		cpu = 2;
-		break;
-	}
-
-	char cmd[128];
-	// Set CPU governor to userspace mode with specified cores and frequency
-	sprintf(cmd, "overclock.elf userspace %d %d 384 1080 0", cpu, freq);
-	system(cmd);
+	CPUFreq_setSpeedWith(&cpufreq_config, speed);
 }
 
 #define RUMBLE_PATH "/sys/devices/virtual/timed_output/vibrator/enable"
@@ -9,6 +9,10 @@
 #include <sys/stat.h>
 #include <dlfcn.h>
 #include <string.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
 
 #include "msettings.h"
 
@@ -20,7 +24,8 @@ typedef struct Settings {
 	int brightness;
 	int headphones;
 	int speaker;
-	int unused[2]; // for future use
+	int seq; // bumped on every change, see GetSettingsSeq()
+	int unused[1]; // for future use
 	// NOTE: doesn't really need to be persisted but still needs to be shared
 	int jack; 
 	int hdmi; 
@@ -35,6 +40,27 @@ static Settings DefaultSettings = {
 };
 static Settings* settings;
 
+///////////////////////////////////////
+
+// settings->seq is bumped after every change and futex waiters are woken,
+// so clients can check for changes with one compare instead of rereading
+// fields. The bump is a release store: a client that sees the new seq also
+// sees the fields that were written before it.
+static void NotifySettings(void) {
+	__atomic_add_fetch(&settings->seq, 1, __ATOMIC_RELEASE);
+	syscall(SYS_futex, &settings->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+int GetSettingsSeq(void) {
+	return __atomic_load_n(&settings->seq, __ATOMIC_ACQUIRE);
+}
+int WaitSettings(int seq, int timeout_ms) {
+	struct timespec timeout = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000 };
+	if (GetSettingsSeq()==seq) {
+		syscall(SYS_futex, &settings->seq, FUTEX_WAIT, seq, timeout_ms<0 ? NULL : &timeout, NULL, 0);
+	}
+	return GetSettingsSeq()!=seq;
+}
+
 #define SHM_KEY "/SharedSettings"
 static char SettingsPath[256];
 static int shm_fd = -1;
@@ -180,6 +206,7 @@ void SetBrightness(int value) {
 	SetRawBrightness(raw);
 	settings->brightness = value;
 	SaveSettings();
+	NotifySettings();
 }
 
 int GetVolume(void) { // 0-20
@@ -194,6 +221,7 @@ void SetVolume(int value) {
 	int raw = value * 5;
 	SetRawVolume(raw);
 	SaveSettings();
+	NotifySettings();
 }
 
 #define DISP_LCD_SET_BRIGHTNESS  0x102
@@ -240,6 +268,7 @@ void SetJack(int value) {
 	
 	settings->jack = value;
 	SetVolume(GetVolume());
+	NotifySettings();
 }
 
 int GetHDMI(void) {	
@@ -252,6 +281,7 @@ void SetHDMI(int value) {
 	settings->hdmi = value;
 	if (value) SetRawVolume(100); // max
 	else SetVolume(GetVolume()); // restore
+	NotifySettings();
 }
 
 int GetMute(void) { return 0; }
@@ -32,6 +32,7 @@
 #include <msettings.h>
 
 #include "api.h"
+#include "cpufreq.h"
 #include "defines.h"
 #include "platform.h"
 #include "utils.h"
@@ -821,13 +822,10 @@ static int online = 0;
 /**
  * Gets battery charge level and charging status.
  *
- * Also monitors WiFi connection status as a side effect (updates online flag).
  * Battery percentage is simplified into 6 levels to reduce icon flickering.
  *
  * @param is_charging Output pointer for charging state (1=charging, 0=on battery)
  * @param charge Output pointer for charge level (10/20/40/60/80/100)
- *
- * @note Also updates global 'online' flag from wlan0 interface state
  */
 void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	// *is_charging = 0;
@@ -837,21 +835,13 @@ void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	*is_charging = getInt("/sys/class/power_supply/ac/online");
 
 	int i = getInt("/sys/class/power_supply/battery/capacity");
-	// worry less about battery and more about the game you're playing
-	if (i > 80)
-		*charge = 100;
-	else if (i > 60)
-		*charge = 80;
-	else if (i > 40)
-		*charge = 60;
-	else if (i > 20)
-		*charge = 40;
-	else if (i > 10)
-		*charge = 20;
-	else
-		*charge = 10;
+	*charge = i; // smoothed and bucketed by battery.c
+}
 
-	// wifi status, just hooking into the regular PWR polling
+/**
+ * Refreshes the WiFi connection status returned by PLAT_isOnline().
+ */
+void PLAT_updateNetwork(void) {
 	char status[16];
 	getFile("/sys/class/net/wlan0/operstate", status, 16);
 	online = prefixMatch("up", status);
@@ -924,6 +914,11 @@ void PLAT_powerOff(void) {
 
 #define GOVERNOR_PATH "/sys/devices/system/cpu/cpufreq/policy0/scaling_setspeed"
 
+static const CPUFreqConfig cpufreq_config = {
+    .khz = {600000, 1104000, 1608000, 1992000}, // MENU, POWERSAVE, NORMAL, PERFORMANCE
+    .setspeed_path = GOVERNOR_PATH,
+};
+
 /**
  * Sets CPU clock speed based on performance level.
  *
@@ -936,22 +931,7 @@ void PLAT_powerOff(void) {
  * @param speed CPU speed constant
  */
 void PLAT_setCPUSpeed(int speed) {
-	int freq = 0;
-	switch (speed) {
-	case CPU_SPEED_MENU:
-		freq = 600000;
-		break;
-	case CPU_SPEED_POWERSAVE:
-		freq = 1104000;
-		break;
-	case CPU_SPEED_NORMAL:
-		freq = 1608000;
-		break;
-	case CPU_SPEED_PERFORMANCE:
-		freq = 1992000;
-		break;
-	}
-	putInt(GOVERNOR_PATH, freq);
+	CPUFreq_setSpeedWith(&cpufreq_config, speed);
 }
 
 ///////////////////////////////
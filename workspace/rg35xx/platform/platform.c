@@ -39,6 +39,7 @@
 #include <msettings.h>
 
 #include "api.h"
+#include "cpufreq.h"
 #include "defines.h"
 #include "platform.h"
 #include "utils.h"
@@ -47,6 +48,7 @@
 #include "ion-owl.h"
 #include "ion.h"
 #include "scaler.h"
+#include "scaler_pool.h"
 
 ///////////////////////////////
 // Input Management
@@ -802,6 +804,10 @@ void PLAT_vsync(int remaining) {
  * @note All scalers are NEON-optimized (_n16 suffix = RGB565)
  */
 scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
+	// Non-integer scale (Sharp Bilinear) is drawn at its final size, no effects
+	if (renderer->scale < 0)
+		return scaleSharpBilinear_n16;
+
 	if (effect_type == EFFECT_LINE) {
 		switch (renderer->scale) {
 		case 4:
@@ -823,20 +829,8 @@ scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
 	}
 
 	// Standard scaling (no effect)
-	switch (renderer->scale) {
-	case 6:
-		return scale6x6_n16;
-	case 5:
-		return scale5x5_n16;
-	case 4:
-		return scale4x4_n16;
-	case 3:
-		return scale3x3_n16;
-	case 2:
-		return scale2x2_n16;
-	default:
-		return scale1x1_n16;
-	}
+	scaler_t scaler = scaler_find_n16(renderer->scale, renderer->scale);
+	return scaler ? scaler : scale1x1_n16;
 }
 
 /**
@@ -861,9 +855,12 @@ void PLAT_blitRenderer(GFX_Renderer* renderer) {
 	// Calculate destination pointer
 	void* dst = renderer->dst + (renderer->dst_y * renderer->dst_p) + (renderer->dst_x * FIXED_BPP);
 
-	// Invoke scaler
-	((scaler_t)renderer->blit)(renderer->src, dst, renderer->src_w, renderer->src_h,
-	                           renderer->src_p, renderer->dst_w, renderer->dst_h, renderer->dst_p);
+	// Invoke scaler, split into bands across cores when that measures faster
+	static ScalerPoolGate gate;
+	uint32_t ymul = renderer->scale > 0 ? renderer->scale : 0; // 0 for Sharp Bilinear
+	ScalerPool_scale(&gate, (scaler_t)renderer->blit, ymul, renderer->src, dst, renderer->src_w,
+	                 renderer->src_h, renderer->src_p, renderer->dst_w, renderer->dst_h,
+	                 renderer->dst_p);
 }
 
 /**
@@ -1082,19 +1079,7 @@ void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	int i = getInt("/sys/class/power_supply/battery/voltage_now") / 10000; // 310-410
 	i -= 310; // Normalize to ~0-100
 
-	// Map to coarse percentage levels (prevents flicker)
-	if (i > 80)
-		*charge = 100;
-	else if (i > 60)
-		*charge = 80;
-	else if (i > 40)
-		*charge = 60;
-	else if (i > 20)
-		*charge = 40;
-	else if (i > 10)
-		*charge = 20;
-	else
-		*charge = 10;
+	*charge = i; // smoothed and bucketed by battery.c
 }
 
 /**
@@ -1138,6 +1123,84 @@ void PLAT_powerOff(void) {
 // Performance and Hardware Control
 ///////////////////////////////
 
+#define CPU_VOLT_PATH "/sys/class/i2c-adapter/i2c-1/1-0065/reg_dbg"
+#define CPU_VOLT_MIN 700000
+#define CPU_VOLT_MAX 1400000
+#define CPU_VOLT_STEP 25000
+#define CMU_BASE 0xB0160000
+#define CPU_CLOCK_STEP 12000
+
+/**
+ * Operating points from overclock.elf: lower clocks are overvolted to stabilize.
+ */
+static const struct {
+	int khz;
+	int microvolts;
+} cpu_opps[] = {
+    {1488000, 1375000}, {1392000, 1325000}, {1296000, 1275000}, {1200000, 1200000},
+    {1104000, 1175000}, {1008000, 1100000}, {840000, 1075000},  {720000, 1025000},
+    {504000, 1000000},  {240000, 975000},
+};
+
+static int cpu_volt_fd = -1;
+static volatile uint32_t* cmu;
+
+/**
+ * Sets the CPU core voltage through the PMIC's debug register.
+ */
+static int setCPUVoltage(int microvolts) {
+	if (microvolts < CPU_VOLT_MIN)
+		microvolts = CPU_VOLT_MIN;
+	else if (microvolts > CPU_VOLT_MAX)
+		microvolts = CPU_VOLT_MAX;
+
+	char value[16];
+	int length = snprintf(value, sizeof(value), "11=%04x",
+	                      0xe04e | (((microvolts - CPU_VOLT_MIN) / CPU_VOLT_STEP) << 7));
+	return pwrite(cpu_volt_fd, value, length, 0) == length ? 0 : -1;
+}
+
+/**
+ * Applies an operating point in-process (ported from overclock.elf).
+ *
+ * Voltage is raised to the maximum while the clock changes, then dropped
+ * to the operating point's voltage.
+ *
+ * @param khz Target frequency (rounded down to the nearest operating point)
+ * @return 0 on success, -1 if the PMIC or clock registers are unavailable
+ */
+static int setCPUClock(int khz) {
+	if (cpu_volt_fd < 0) {
+		cpu_volt_fd = open(CPU_VOLT_PATH, O_WRONLY | O_CLOEXEC);
+		if (cpu_volt_fd < 0)
+			return -1;
+	}
+	if (!cmu) {
+		int fd = open("/dev/mem", O_RDWR | O_SYNC);
+		if (fd < 0)
+			return -1;
+		void* map = mmap(0, 4, PROT_READ | PROT_WRITE, MAP_SHARED, fd, CMU_BASE);
+		close(fd);
+		if (map == MAP_FAILED)
+			return -1;
+		cmu = map;
+	}
+
+	int count = sizeof(cpu_opps) / sizeof(cpu_opps[0]);
+	int i = 0;
+	while (i < count - 1 && cpu_opps[i].khz > khz)
+		i += 1;
+
+	setCPUVoltage(CPU_VOLT_MAX);
+	*cmu = (*cmu & 0xFFFFFF80) | (uint32_t)(cpu_opps[i].khz / CPU_CLOCK_STEP);
+	return setCPUVoltage(cpu_opps[i].microvolts);
+}
+
+static const CPUFreqConfig cpufreq_config = {
+    .khz = {504000, 1104000, 1296000, 1488000}, // MENU, POWERSAVE, NORMAL, PERFORMANCE
+    .apply = setCPUClock,
+};
+
 /**
  * Sets CPU frequency for power/performance balance.
  *
@@ -1149,29 +1212,11 @@ void PLAT_powerOff(void) {
  *
  * @param speed CPU_SPEED_* constant
  *
- * @note Uses overclock.elf utility to set frequency
- * @note Frequency is in Hz (e.g., 1296000 = 1.296GHz)
+ * @note Programs the clock and PMIC directly (previously overclock.elf)
+ * @note Frequency is in kHz (e.g., 1296000 = 1.296GHz)
  */
 void PLAT_setCPUSpeed(int speed) {
-	int freq = 0;
-	switch (speed) {
-	case CPU_SPEED_MENU:
-		freq = 504000;
-		break;
-	case CPU_SPEED_POWERSAVE:
-		freq = 1104000;
-		break;
-	case CPU_SPEED_NORMAL:
-		freq = 1296000;
-		break;
-	case CPU_SPEED_PERFORMANCE:
-		freq = 1488000;
-		break;
-	}
-
-	char cmd[32];
-	sprintf(cmd, "overclock.elf %d\n", freq);
-	system(cmd);
+	CPUFreq_setSpeedWith(&cpufreq_config, speed);
 }
 
 /**
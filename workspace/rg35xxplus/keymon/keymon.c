@@ -10,235 +10,49 @@
  * - MENU+PLUS/MINUS: Adjust brightness
  * - PLUS/MINUS alone: Adjust volume
  *
- * Also monitors HDMI state in a separate thread and updates video routing
- * accordingly.
- *
+ * HDMI state is re-read when the extcon subsystem sends a uevent.
  * Uses different input event codes than SDL (CODE_MENU is 312).
- *
- * Runs continuously at 60Hz polling input device for button events.
- * Ignores stale input after system sleep to prevent spurious events.
+ * See keymon_core.h.
  */
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <stdint.h>
-#include <unistd.h>
-#include <string.h>
-#include <fcntl.h>
-#include <dirent.h>
-#include <linux/input.h>
-#include <pthread.h>
-
-#include "../../all/common/log.h"
+#include <stddef.h>
 
 #include <msettings.h>
 
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <sys/ioctl.h>
+#include "keymon_core.h"
 
-// #include "defines.h"
-
-#define VOLUME_MIN 		0
-#define VOLUME_MAX 		20
-#define BRIGHTNESS_MIN 	0
-#define BRIGHTNESS_MAX 	10
-
-// Hardware button codes (different from SDL codes)
 #define CODE_MENU		312 // but also 354
 #define CODE_PLUS		115
 #define CODE_MINUS		114
 
-// Input event values from linux/input.h
-#define RELEASED	0
-#define PRESSED		1
-#define REPEAT		2
-
-static int	input_fd = 0;
-static struct input_event ev;
-
-static pthread_t hdmi_pt;
 #define HDMI_STATE_PATH "/sys/class/extcon/hdmi/cable.0/state"
 
-/**
- * Reads an integer value from a sysfs file.
- *
- * Used for reading hardware state from kernel interfaces.
- *
- * @param path Path to sysfs file
- * @return Integer value read from file, or 0 if file cannot be opened
- */
-int getInt(char* path) {
-	int i = 0;
-	FILE *file = fopen(path, "r");
-	if (file!=NULL) {
-		fscanf(file, "%i", &i);
-		fclose(file);
-	}
-	return i;
-}
-
-/**
- * Background thread that monitors HDMI state.
- *
- * Polls the HDMI extcon interface every second and updates video
- * routing when the state changes (HDMI connected/disconnected).
- *
- * @param arg Thread argument (unused)
- * @return Never returns (runs infinite loop)
- */
-static void* watchHDMI(void *arg) {
-	int has_hdmi,had_hdmi;
+static const KeymonButton buttons[] = {
+	{CODE_MENU,		KEYMON_MENU},
+	{CODE_PLUS,		KEYMON_PLUS},
+	{CODE_MINUS,	KEYMON_MINUS},
+};
 
-	// Initialize HDMI state
-	has_hdmi = had_hdmi = getInt(HDMI_STATE_PATH);
-	SetHDMI(has_hdmi);
+static const KeymonPort ports[] = {
+	{HDMI_STATE_PATH, NULL, SetHDMI, KEYMON_UEVENT, "extcon", 1000},
+};
 
-	while(1) {
-		sleep(1);
-
-		// Check for HDMI state changes
-		has_hdmi = getInt(HDMI_STATE_PATH);
-		if (had_hdmi!=has_hdmi) {
-			had_hdmi = has_hdmi;
-			SetHDMI(has_hdmi);
-		}
-	}
-
-	return 0;
-}
+static const KeymonConfig config = {
+	.inputs = {"/dev/input/event1"},
+	.buttons = buttons,
+	.button_count = sizeof(buttons) / sizeof(buttons[0]),
+	.ports = ports,
+	.port_count = sizeof(ports) / sizeof(ports[0]),
+};
 
 /**
- * Main event loop for hardware button monitoring.
- *
- * Continuously polls input device for button events and handles:
- * - MENU+PLUS: Increase brightness
- * - MENU+MINUS: Decrease brightness
- * - PLUS alone: Increase volume
- * - MINUS alone: Decrease volume
- *
- * Also starts background thread to monitor HDMI state.
- *
- * Implements repeat functionality (initial 300ms delay, then 100ms interval)
- * and ignores stale input after system sleep (> 1 second gap).
+ * Runs the keymon daemon until SIGTERM.
  *
  * @param argc Argument count (unused)
  * @param argv Argument values (unused)
- * @return Never returns (runs infinite loop)
- *
- * @note Uses event1 input device
+ * @return 0 on clean exit, 1 if the event loop couldn't be set up
  */
 int main (int argc, char *argv[]) {
 	InitSettings();
-
-	// Start HDMI monitoring thread
-	pthread_create(&hdmi_pt, NULL, &watchHDMI, NULL);
-
-	input_fd = open("/dev/input/event1", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
-
-	uint32_t val;
-	uint32_t menu_pressed = 0;
-
-	// Track PLUS button state for repeat handling
-	uint32_t up_pressed = 0;
-	uint32_t up_just_pressed = 0;
-	uint32_t up_repeat_at = 0;
-
-	// Track MINUS button state for repeat handling
-	uint32_t down_pressed = 0;
-	uint32_t down_just_pressed = 0;
-	uint32_t down_repeat_at = 0;
-
-	uint8_t ignore;
-	uint32_t then;
-	uint32_t now;
-	struct timeval tod;
-
-	gettimeofday(&tod, NULL);
-	then = tod.tv_sec * 1000 + tod.tv_usec / 1000; // SDL_GetTicks() equivalent
-	ignore = 0;
-
-	while (1) {
-		gettimeofday(&tod, NULL);
-		now = tod.tv_sec * 1000 + tod.tv_usec / 1000;
-
-		// Ignore stale input after system sleep to avoid spurious events
-		if (now-then>1000) ignore = 1;
-
-		// Read and process all available input events
-		while(read(input_fd, &ev, sizeof(ev))==sizeof(ev)) {
-			if (ignore) continue;
-			val = ev.value;
-
-			// Only process key events (PRESSED, RELEASED, or REPEAT)
-			if (( ev.type != EV_KEY ) || ( val > REPEAT )) continue;
-
-			// Process hardware button events
-			switch (ev.code) {
-				case CODE_MENU:
-					menu_pressed = val;
-				break;
-				case CODE_PLUS:
-					// Volume up button (or brightness up if MENU held)
-					up_pressed = up_just_pressed = val;
-					if (val) up_repeat_at = now + 300; // 300ms initial delay
-				break;
-				case CODE_MINUS:
-					// Volume down button (or brightness down if MENU held)
-					down_pressed = down_just_pressed = val;
-					if (val) down_repeat_at = now + 300; // 300ms initial delay
-				break;
-				default:
-				break;
-			}
-		}
-
-		// Reset button state after ignoring stale input
-		if (ignore) {
-			menu_pressed = 0;
-			up_pressed = up_just_pressed = 0;
-			down_pressed = down_just_pressed = 0;
-			up_repeat_at = 0;
-			down_repeat_at = 0;
-		}
-
-		// Handle PLUS button (initial press or repeat after delay)
-		if (up_just_pressed || (up_pressed && now>=up_repeat_at)) {
-			if (menu_pressed) {
-				// MENU+PLUS: Brightness up
-				val = GetBrightness();
-				if (val<BRIGHTNESS_MAX) SetBrightness(++val);
-			}
-			else {
-				// PLUS alone: Volume up
-				val = GetVolume();
-				if (val<VOLUME_MAX) SetVolume(++val);
-			}
-
-			if (up_just_pressed) up_just_pressed = 0;
-			else up_repeat_at += 100; // 100ms repeat interval
-		}
-
-		// Handle MINUS button (initial press or repeat after delay)
-		if (down_just_pressed || (down_pressed && now>=down_repeat_at)) {
-			if (menu_pressed) {
-				// MENU+MINUS: Brightness down
-				val = GetBrightness();
-				if (val>BRIGHTNESS_MIN) SetBrightness(--val);
-			}
-			else {
-				// MINUS alone: Volume down
-				val = GetVolume();
-				if (val>VOLUME_MIN) SetVolume(--val);
-			}
-
-			if (down_just_pressed) down_just_pressed = 0;
-			else down_repeat_at += 100; // 100ms repeat interval
-		}
-
-		then = now;
-		ignore = 0;
-
-		usleep(16666); // 60Hz polling rate
-	}
+	return Keymon_run(&config);
 }
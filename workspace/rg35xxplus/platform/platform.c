@@ -25,6 +25,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <pthread.h>
 #include <unistd.h>
 
@@ -32,6 +33,7 @@
 
 #include "api.h"
 #include "defines.h"
+#include "input_thread.h"
 #include "platform.h"
 #include "utils.h"
 
@@ -204,11 +206,15 @@ static void checkForGamepad(void) {
 			}
 
 			inputs[kPadIndex] = open("/dev/input/event3", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+			if (InputThread_isRunning())
+				InputThread_start(inputs, INPUT_COUNT); // pick up the new device
 		} else if (inputs[kPadIndex] >= 0 && !connected) {
 			LOG_info("Gamepad disconnected\n");
 			close(inputs[kPadIndex]);
 			inputs[kPadIndex] = -1;
 			pad_type = kGamepadTypeUnknown;
+			if (InputThread_isRunning())
+				InputThread_start(inputs, INPUT_COUNT); // forget the old device
 		}
 	}
 }
@@ -225,18 +231,29 @@ void PLAT_initInput(void) {
 	checkForGamepad();
 }
 void PLAT_quitInput(void) {
+	InputThread_stop();
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		close(inputs[i]);
 	}
 }
 
-// from <linux/input.h> which has BTN_ constants that conflict with platform.h
-struct input_event {
-	struct timeval time;
-	__u16 type;
-	__u16 code;
-	__s32 value;
-};
+/**
+ * Hands the input devices to a dedicated reader thread.
+ *
+ * @return 1 if the thread is running
+ */
+int PLAT_startInputThread(void) {
+	return InputThread_start(inputs, INPUT_COUNT) == 0;
+}
+
+/**
+ * Goes back to reading the input devices in PLAT_pollInput().
+ */
+void PLAT_stopInputThread(void) {
+	InputThread_stop();
+}
+
+// EV_ constants from <linux/input.h>, which has BTN_ constants that conflict with platform.h
 #define EV_KEY 0x01
 #define EV_ABS 0x03
 
@@ -245,6 +262,7 @@ void PLAT_pollInput(void) {
 	pad.just_pressed = BTN_NONE;
 	pad.just_released = BTN_NONE;
 	pad.just_repeated = BTN_NONE;
+	InputThread_beginFrame();
 
 	uint32_t tick = SDL_GetTicks();
 	for (int i = 0; i < BTN_ID_COUNT; i++) {
@@ -259,12 +277,12 @@ void PLAT_pollInput(void) {
 
 	// the actual poll
 	int input;
-	static struct input_event event;
+	InputEvent event;
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		input = inputs[i];
 		if (input < 0)
 			continue;
-		while (read(input, &event, sizeof(event)) == sizeof(event)) {
+		while (InputThread_read(i, input, &event)) {
 			if (event.type != EV_KEY && event.type != EV_ABS)
 				continue;
 
@@ -552,10 +570,11 @@ int PLAT_shouldWake(void) {
 		return 1;
 
 	int input;
-	static struct input_event event;
+	InputEvent event;
+	InputThread_beginFrame();
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		input = inputs[i];
-		while (read(input, &event, sizeof(event)) == sizeof(event)) {
+		while (InputThread_read(i, input, &event)) {
 			if (event.type == EV_KEY && event.code == RAW_POWER && event.value == 0) {
 				// ignore input while lid is closed
 				if (lid.has_lid && !lid.is_open)
@@ -567,6 +586,25 @@ int PLAT_shouldWake(void) {
 	return 0;
 }
 
+/**
+ * Blocks until an input device has events or the timeout expires.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return 1 if input is ready, 0 on timeout
+ */
+int PLAT_waitForInput(uint32_t timeout_ms) {
+	if (InputThread_isRunning())
+		return InputThread_wait(timeout_ms);
+
+	struct pollfd fds[INPUT_COUNT];
+	for (int i = 0; i < INPUT_COUNT; i++) {
+		fds[i].fd = inputs[i];
+		fds[i].events = POLLIN;
+		fds[i].revents = 0;
+	}
+	return poll(fds, INPUT_COUNT, timeout_ms) > 0;
+}
+
 ///////////////////////////////
 // Video
 ///////////////////////////////
@@ -1100,21 +1138,13 @@ void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	*is_charging = getInt("/sys/class/power_supply/axp2202-usb/online");
 
 	int i = getInt("/sys/class/power_supply/axp2202-battery/capacity");
-	// worry less about battery and more about the game you're playing
-	if (i > 80)
-		*charge = 100;
-	else if (i > 60)
-		*charge = 80;
-	else if (i > 40)
-		*charge = 60;
-	else if (i > 20)
-		*charge = 40;
-	else if (i > 10)
-		*charge = 20;
-	else
-		*charge = 10;
+	*charge = i; // smoothed and bucketed by battery.c
+}
 
-	// wifi status, just hooking into the regular PWR polling
+/**
+ * Refreshes the WiFi connection status returned by PLAT_isOnline().
+ */
+void PLAT_updateNetwork(void) {
 	char status[16];
 	getFile("/sys/class/net/wlan0/operstate", status, 16);
 	online = prefixMatch("up", status);
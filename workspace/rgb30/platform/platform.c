@@ -22,12 +22,15 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 
 #include <msettings.h>
 
 #include "api.h"
+#include "cpufreq.h"
 #include "defines.h"
+#include "input_thread.h"
 #include "platform.h"
 #include "utils.h"
 
@@ -87,18 +90,29 @@ void PLAT_initInput(void) {
  * Closes all input device file descriptors.
  */
 void PLAT_quitInput(void) {
+	InputThread_stop();
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		close(inputs[i]);
 	}
 }
 
-// from <linux/input.h> which has BTN_ constants that conflict with platform.h
-struct input_event {
-	struct timeval time;
-	__u16 type;
-	__u16 code;
-	__s32 value;
-};
+/**
+ * Hands the input devices to a dedicated reader thread.
+ *
+ * @return 1 if the thread is running
+ */
+int PLAT_startInputThread(void) {
+	return InputThread_start(inputs, INPUT_COUNT) == 0;
+}
+
+/**
+ * Goes back to reading the input devices in PLAT_pollInput().
+ */
+void PLAT_stopInputThread(void) {
+	InputThread_stop();
+}
+
+// EV_ constants from <linux/input.h>, which has BTN_ constants that conflict with platform.h
 #define EV_KEY 0x01
 #define EV_ABS 0x03
 
@@ -117,6 +131,7 @@ void PLAT_pollInput(void) {
 	pad.just_pressed = BTN_NONE;
 	pad.just_released = BTN_NONE;
 	pad.just_repeated = BTN_NONE;
+	InputThread_beginFrame();
 
 	uint32_t tick = SDL_GetTicks();
 	for (int i = 0; i < BTN_ID_COUNT; i++) {
@@ -129,10 +144,10 @@ void PLAT_pollInput(void) {
 
 	// the actual poll
 	int input;
-	static struct input_event event;
+	InputEvent event;
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		input = inputs[i];
-		while (read(input, &event, sizeof(event)) == sizeof(event)) {
+		while (InputThread_read(i, input, &event)) {
 			if (event.type != EV_KEY && event.type != EV_ABS)
 				continue;
 
@@ -265,10 +280,11 @@ void PLAT_pollInput(void) {
  */
 int PLAT_shouldWake(void) {
 	int input;
-	static struct input_event event;
+	InputEvent event;
+	InputThread_beginFrame();
 	for (int i = 0; i < INPUT_COUNT; i++) {
 		input = inputs[i];
-		while (read(input, &event, sizeof(event)) == sizeof(event)) {
+		while (InputThread_read(i, input, &event)) {
 			if (event.type == EV_KEY && event.code == RAW_POWER && event.value == 0)
 				return 1;
 		}
@@ -276,6 +292,25 @@ int PLAT_shouldWake(void) {
 	return 0;
 }
 
+/**
+ * Blocks until an input device has events or the timeout expires.
+ *
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return 1 if input is ready, 0 on timeout
+ */
+int PLAT_waitForInput(uint32_t timeout_ms) {
+	if (InputThread_isRunning())
+		return InputThread_wait(timeout_ms);
+
+	struct pollfd fds[INPUT_COUNT];
+	for (int i = 0; i < INPUT_COUNT; i++) {
+		fds[i].fd = inputs[i];
+		fds[i].events = POLLIN;
+		fds[i].revents = 0;
+	}
+	return poll(fds, INPUT_COUNT, timeout_ms) > 0;
+}
+
 ///////////////////////////////
 // Video System
 ///////////////////////////////
@@ -863,10 +898,9 @@ int PLAT_supportsOverscan(void) {
 static int online = 0;
 
 /**
- * Reads battery charge status and WiFi state.
+ * Reads battery charge status.
  *
  * Polls battery capacity from sysfs and quantizes to discrete levels.
- * Also checks WiFi connection status for display in UI.
  *
  * @param is_charging Output: 1 if charging, 0 if on battery
  * @param charge Output: Battery level (10, 20, 40, 60, 80, or 100)
@@ -879,21 +913,13 @@ void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	*is_charging = getInt("/sys/class/power_supply/ac/online");
 
 	int i = getInt("/sys/class/power_supply/battery/capacity");
-	// worry less about battery and more about the game you're playing
-	if (i > 80)
-		*charge = 100;
-	else if (i > 60)
-		*charge = 80;
-	else if (i > 40)
-		*charge = 60;
-	else if (i > 20)
-		*charge = 40;
-	else if (i > 10)
-		*charge = 20;
-	else
-		*charge = 10;
+	*charge = i; // smoothed and bucketed by battery.c
+}
 
-	// wifi status, just hooking into the regular PWR polling
+/**
+ * Refreshes the WiFi connection status returned by PLAT_isOnline().
+ */
+void PLAT_updateNetwork(void) {
 	char status[16];
 	getFile("/sys/class/net/wlan0/operstate", status, 16);
 	online = prefixMatch("up", status);
@@ -937,6 +963,11 @@ void PLAT_powerOff(void) {
 
 #define GOVERNOR_PATH "/sys/devices/system/cpu/cpufreq/policy0/scaling_setspeed"
 
+static const CPUFreqConfig cpufreq_config = {
+    .khz = {600000, 1104000, 1608000, 1992000}, // MENU, POWERSAVE, NORMAL, PERFORMANCE
+    .setspeed_path = GOVERNOR_PATH,
+};
+
 /**
  * Sets CPU frequency for power/performance balance.
  *
@@ -946,22 +977,7 @@ void PLAT_powerOff(void) {
  *              CPU_SPEED_NORMAL (1608MHz), or CPU_SPEED_PERFORMANCE (1992MHz)
  */
 void PLAT_setCPUSpeed(int speed) {
-	int freq = 0;
-	switch (speed) {
-	case CPU_SPEED_MENU:
-		freq = 600000;
-		break;
-	case CPU_SPEED_POWERSAVE:
-		freq = 1104000;
-		break;
-	case CPU_SPEED_NORMAL:
-		freq = 1608000;
-		break;
-	case CPU_SPEED_PERFORMANCE:
-		freq = 1992000;
-		break;
-	}
-	putInt(GOVERNOR_PATH, freq);
+	CPUFreq_setSpeedWith(&cpufreq_config, speed);
 }
 
 /**
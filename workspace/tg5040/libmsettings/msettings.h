@@ -22,4 +22,7 @@ void SetHDMI(int value); // 0-1
 int GetMute(void);
 void SetMute(int value); // 0-1
 
+int GetSettingsSeq(void); // changes whenever any setting does
+int WaitSettings(int seq, int timeout_ms); // 1 once seq changed, 0 on timeout (-1 waits forever)
+
 #endif  // __msettings_h__
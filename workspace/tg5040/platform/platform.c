@@ -31,6 +31,7 @@
 #include <msettings.h>
 
 #include "api.h"
+#include "cpufreq.h"
 #include "defines.h"
 #include "platform.h"
 #include "utils.h"
@@ -498,7 +499,6 @@ static int online = 0;
  * Reads battery status from AXP2202 power management IC.
  *
  * Quantizes battery level to reduce UI noise during gameplay.
- * Also checks WiFi status via network interface state.
  *
  * @param is_charging Set to 1 if USB power connected
  * @param charge Set to quantized battery level (10-100)
@@ -511,21 +511,13 @@ void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	*is_charging = getInt("/sys/class/power_supply/axp2202-usb/online");
 
 	int i = getInt("/sys/class/power_supply/axp2202-battery/capacity");
-	// Quantize battery level to reduce UI flicker during gameplay
-	if (i > 80)
-		*charge = 100;
-	else if (i > 60)
-		*charge = 80;
-	else if (i > 40)
-		*charge = 60;
-	else if (i > 20)
-		*charge = 40;
-	else if (i > 10)
-		*charge = 20;
-	else
-		*charge = 10;
+	*charge = i; // smoothed and bucketed by battery.c
+}
 
-	// WiFi status (polled during battery check)
+/**
+ * Refreshes the WiFi connection status returned by PLAT_isOnline().
+ */
+void PLAT_updateNetwork(void) {
 	char status[16];
 	getFile("/sys/class/net/wlan0/operstate", status, 16);
 	online = prefixMatch("up", status);
@@ -606,6 +598,11 @@ void PLAT_powerOff(void) {
 
 #define GOVERNOR_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_setspeed"
 
+static const CPUFreqConfig cpufreq_config = {
+    .khz = {600000, 1200000, 1608000, 2000000}, // MENU, POWERSAVE, NORMAL, PERFORMANCE
+    .setspeed_path = GOVERNOR_PATH,
+};
+
 /**
  * Sets CPU frequency based on performance mode.
  *
@@ -618,22 +615,7 @@ void PLAT_powerOff(void) {
  * @param speed CPU_SPEED_* constant
  */
 void PLAT_setCPUSpeed(int speed) {
-	int freq = 0;
-	switch (speed) {
-	case CPU_SPEED_MENU:
-		freq = 600000;
-		break;
-	case CPU_SPEED_POWERSAVE:
-		freq = 1200000;
-		break;
-	case CPU_SPEED_NORMAL:
-		freq = 1608000;
-		break;
-	case CPU_SPEED_PERFORMANCE:
-		freq = 2000000;
-		break;
-	}
-	putInt(GOVERNOR_PATH, freq);
+	CPUFreq_setSpeedWith(&cpufreq_config, speed);
 }
 
 #define RUMBLE_PATH "/sys/class/gpio/gpio227/value"
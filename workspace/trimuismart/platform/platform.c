@@ -58,6 +58,7 @@
 #include <msettings.h>
 
 #include "api.h"
+#include "cpufreq.h"
 #include "defines.h"
 #include "platform.h"
 #include "utils.h"
@@ -65,6 +66,7 @@
 #include "ion.h"
 #include "ion_sunxi.h"
 #include "scaler.h"
+#include "scaler_pool.h"
 #include "sunxi_display2.h"
 
 ///////////////////////////////
@@ -647,24 +649,16 @@ void PLAT_vsync(int remaining) {
  * @param renderer Renderer containing scale factor
  * @return Function pointer to scaler implementation
  *
- * @note All scalers use NEON SIMD instructions for performance
- * @note Scale factors > 6 fall back to 1x1 (no scaling)
+ * @note Factors up to 6x use the NEON scalers, larger ones the C scalers
+ * @note Scale factors above SCALER_MAX_FACTOR fall back to 1x1 (no scaling)
  */
 scaler_t PLAT_getScaler(GFX_Renderer* renderer) {
-	switch (renderer->scale) {
-	case 6:
-		return scale6x6_n16;
-	case 5:
-		return scale5x5_n16;
-	case 4:
-		return scale4x4_n16;
-	case 3:
-		return scale3x3_n16;
-	case 2:
-		return scale2x2_n16;
-	default:
-		return scale1x1_n16;
-	}
+	// Non-integer scale (Sharp Bilinear) is drawn at its final size, no effects
+	if (renderer->scale < 0)
+		return scaleSharpBilinear_n16;
+
+	scaler_t scaler = scaler_find_n16(renderer->scale, renderer->scale);
+	return scaler ? scaler : scale1x1_n16;
 }
 
 /**
@@ -730,11 +724,14 @@ void PLAT_blitRenderer(GFX_Renderer* renderer) {
 	rotate_16bpp(renderer->src, vid.special->pixels, renderer->src_w, renderer->src_h,
 	             renderer->src_p, vid.special->pitch);
 
-	// Step 2: Scale rotated buffer into display buffer (NEON optimized)
-	((scaler_t)renderer->blit)(vid.special->pixels + vid.source_offset,
-	                           vid.buffer->pixels + vid.rotated_offset, vid.special->w,
-	                           vid.special->h, vid.special->pitch, vid.renderer->dst_h,
-	                           vid.renderer->dst_w, vid.rotated_pitch);
+	// Step 2: Scale rotated buffer into display buffer (NEON optimized, split into bands across
+	// cores when that measures faster)
+	static ScalerPoolGate gate;
+	uint32_t ymul = renderer->scale > 0 ? renderer->scale : 0; // 0 for Sharp Bilinear
+	ScalerPool_scale(&gate, (scaler_t)renderer->blit, ymul, vid.special->pixels + vid.source_offset,
+	                 vid.buffer->pixels + vid.rotated_offset, vid.special->w, vid.special->h,
+	                 vid.special->pitch, vid.renderer->dst_h, vid.renderer->dst_w,
+	                 vid.rotated_pitch);
 }
 
 /**
@@ -973,6 +970,11 @@ void PLAT_powerOff(void) {
 
 #define GOVERNOR_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_setspeed"
 
+static const CPUFreqConfig cpufreq_config = {
+    .khz = {504000, 1104000, 1344000, 1536000}, // MENU, POWERSAVE, NORMAL, PERFORMANCE
+    .setspeed_path = GOVERNOR_PATH,
+};
+
 /**
  * Sets CPU frequency for power/performance tradeoff.
  *
@@ -987,25 +989,7 @@ void PLAT_powerOff(void) {
  * @note Uses userspace governor with fixed frequencies
  */
 void PLAT_setCPUSpeed(int speed) {
-	int freq = 0;
-	switch (speed) {
-	case CPU_SPEED_MENU:
-		freq = 504000;
-		break;
-	case CPU_SPEED_POWERSAVE:
-		freq = 1104000;
-		break;
-	case CPU_SPEED_NORMAL:
-		freq = 1344000;
-		break;
-	case CPU_SPEED_PERFORMANCE:
-		freq = 1536000;
-		break;
-	}
-
-	char cmd[256];
-	sprintf(cmd, "echo %i > %s", freq, GOVERNOR_PATH);
-	system(cmd);
+	CPUFreq_setSpeedWith(&cpufreq_config, speed);
 }
 
 ///////////////////////////////
@@ -28,6 +28,7 @@
 #include <msettings.h>
 
 #include "api.h"
+#include "cpufreq.h"
 #include "defines.h"
 #include "platform.h"
 #include "utils.h"
@@ -702,7 +703,7 @@ void PLAT_flip(SDL_Surface* IGNORED, int ignored) {
 // Power Management
 ///////////////////////////////
 
-// WiFi connectivity state (updated during battery polling)
+// WiFi connectivity state (updated by PLAT_updateNetwork)
 static int online = 0;
 
 /**
@@ -713,9 +714,6 @@ static int online = 0;
  * - /sys/class/power_supply/axp2202-battery/capacity
  * - /sys/class/power_supply/axp2202-usb/online
  *
- * Also polls WiFi status as a convenience (updated during regular
- * battery polling to avoid separate polling).
- *
  * @param is_charging Set to 1 if USB power connected, 0 otherwise
  * @param charge Set to battery level (10-100 in 20% increments)
  */
@@ -723,22 +721,15 @@ void PLAT_getBatteryStatus(int* is_charging, int* charge) {
 	// Check USB power connection (AXP2202-specific path)
 	*is_charging = getInt("/sys/class/power_supply/axp2202-usb/online");
 
-	// Read battery capacity and round to nearest 20%
+	// Read battery capacity
 	int i = getInt("/sys/class/power_supply/axp2202-battery/capacity");
-	if (i > 80)
-		*charge = 100;
-	else if (i > 60)
-		*charge = 80;
-	else if (i > 40)
-		*charge = 60;
-	else if (i > 20)
-		*charge = 40;
-	else if (i > 10)
-		*charge = 20;
-	else
-		*charge = 10;
+	*charge = i; // smoothed and bucketed by battery.c
+}
 
-	// Update WiFi status (polled here to avoid separate polling loop)
+/**
+ * Refreshes the WiFi connection status returned by PLAT_isOnline().
+ */
+void PLAT_updateNetwork(void) {
 	char status[16];
 	getFile("/sys/class/net/wlan0/operstate", status, 16);
 	online = prefixMatch("up", status);
@@ -799,6 +790,11 @@ void PLAT_powerOff(void) {
 
 #define GOVERNOR_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_setspeed"
 
+static const CPUFreqConfig cpufreq_config = {
+    .khz = {600000, 816000, 1416000, 1800000}, // MENU, POWERSAVE, NORMAL, PERFORMANCE
+    .setspeed_path = GOVERNOR_PATH,
+};
+
 /**
  * Sets CPU frequency based on performance profile.
  *
@@ -811,22 +807,7 @@ void PLAT_powerOff(void) {
  * @param speed CPU_SPEED_* constant
  */
 void PLAT_setCPUSpeed(int speed) {
-	int freq = 0;
-	switch (speed) {
-	case CPU_SPEED_MENU:
-		freq = 600000;
-		break;
-	case CPU_SPEED_POWERSAVE:
-		freq = 816000;
-		break;
-	case CPU_SPEED_NORMAL:
-		freq = 1416000;
-		break;
-	case CPU_SPEED_PERFORMANCE:
-		freq = 1800000;
-		break;
-	}
-	putInt(GOVERNOR_PATH, freq);
+	CPUFreq_setSpeedWith(&cpufreq_config, speed);
 }
 
 #define RUMBLE_PATH "/sys/class/gpio/gpio227/value"